@@ -268,6 +268,62 @@ class SeparableFilterForward: public SeparableFilterBase {
 };
 using SeparableFilter = SeparableFilterForward;
 
+/**
+ * \brief fused preprocessing of uint8 images into network input
+ *
+ * It converts the color of an NHWC src, resizes it to (out_height,
+ * out_width), applies a per-channel affine transform and writes dst in NCHW,
+ * or in NCHW88 with zero padded channels:
+ *
+ *      dst[n, c, h, w] = resize(cvt_color(src))[n, h, w, c] * scale[c] +
+ *                        bias[c]
+ *
+ * The resized value is rounded to uint8 as Resize does, so the result equals
+ * the unfused chain of oprs. For YUV color modes src is {N, H * 3 / 2, W, 1}
+ * as in CvtColor. dst is Float32 or QuantizedS8.
+ */
+class ImagePreprocessBase : public OperatorBase {
+    DEF_OPR_IMPL_CTOR(ImagePreprocessBase, OperatorBase);
+    DEF_OPR_PARAM(ImagePreprocess);
+
+public:
+    using ColorMode = Param::ColorMode;
+    using InterpolationMode = Param::InterpolationMode;
+
+protected:
+    void deduce_layout_fwd(const TensorLayout& src, const TensorLayout& scale,
+                           const TensorLayout& bias, TensorLayout& dst);
+    void check_layout_fwd(const TensorLayout& src, const TensorLayout& scale,
+                          const TensorLayout& bias, const TensorLayout& dst);
+};
+
+class ImagePreprocessForward : public ImagePreprocessBase {
+    DEF_OPR_IMPL(ImagePreprocessForward, ImagePreprocessBase, 3, 1);
+
+public:
+    /**
+     * \param[in] src uint8 image in NHWC
+     * \param[in] scale float32 tensor of shape {C}
+     * \param[in] bias float32 tensor of shape {C}
+     * \param[out] dst normalized image in NCHW or NCHW88
+     */
+    virtual void exec(_megdnn_tensor_in src, _megdnn_tensor_in scale,
+                      _megdnn_tensor_in bias, _megdnn_tensor_out dst,
+                      _megdnn_workspace workspace) = 0;
+    void deduce_layout(const TensorLayout& src, const TensorLayout& scale,
+                       const TensorLayout& bias, TensorLayout& dst);
+    virtual size_t get_workspace_in_bytes(const TensorLayout& src,
+                                          const TensorLayout& scale,
+                                          const TensorLayout& bias,
+                                          const TensorLayout& dst) = 0;
+
+protected:
+    void check_exec(const TensorLayout& src, const TensorLayout& scale,
+                    const TensorLayout& bias, const TensorLayout& dst,
+                    size_t workspace_in_bytes);
+};
+using ImagePreprocess = ImagePreprocessForward;
+
 }  // namespace megdnn
 
 #include "megdnn/internal/opr_header_epilogue.h"
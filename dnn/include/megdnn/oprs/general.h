@@ -539,6 +539,43 @@ public:
                                           const TensorShapeArray& dsts) = 0;
 };
 
+/**
+ * \brief one optimizer step on parameters packed into a single tensor
+ *
+ * param, grad and the states are contiguous float32 tensors of the same
+ * shape, usually the packed buffers of ParamPackConcat; all the parameters are
+ * thus updated by one kernel. See param::FusedOptimizerUpdate::Mode for the
+ * formula. States not used by the mode (state1 for SGD, and state0 for SGD
+ * without momentum) may be empty tensors.
+ */
+class FusedOptimizerUpdate : public OperatorBase {
+    DEF_OPR_PARAM(FusedOptimizerUpdate);
+    DEF_OPR_IMPL(FusedOptimizerUpdate, OperatorBase, -1, 1);
+
+public:
+    using Mode = Param::Mode;
+
+    /**
+     * \param[in,out] param parameters to be updated
+     * \param[in] grad gradient of param
+     * \param[in,out] state0 momentum buffer of SGD, or first moment of ADAM
+     * \param[in,out] state1 second moment of ADAM
+     */
+    virtual void exec(_megdnn_tensor_inout param, _megdnn_tensor_in grad,
+                      _megdnn_tensor_inout state0, _megdnn_tensor_inout state1,
+                      _megdnn_workspace workspace) = 0;
+
+    virtual size_t get_workspace_in_bytes(const TensorLayout& param,
+                                          const TensorLayout& grad,
+                                          const TensorLayout& state0,
+                                          const TensorLayout& state1) = 0;
+
+protected:
+    void check_exec(const TensorLayout& param, const TensorLayout& grad,
+                    const TensorLayout& state0, const TensorLayout& state1,
+                    size_t workspace_in_bytes);
+};
+
 /**
  * \brief base class for Tile and Repeat
  */
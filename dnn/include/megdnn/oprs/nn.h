@@ -395,7 +395,7 @@ protected:
 };
 
 class ConvPoolingForward : public ConvPoolingBase {
-    DEF_OPR_IMPL(ConvPoolingForward, ConvPoolingBase, 2, 1);
+    DEF_OPR_IMPL(ConvPoolingForward, ConvPoolingBase, 3, 1);
 
 public:
     /**
@@ -698,6 +698,42 @@ pdef('UniformRNG').add_fields('uint64', 'seed', 0)
  .add_enum_alias('InterpolationMode', 'WarpPerspective', name_field='imode')
  .add_enum_alias('Format', 'ConvolutionV0', default=1))
 
+(pdef('ImagePreprocess')
+ .add_enum('ColorMode',
+           Doc('NONE', 'keep the channels of src'),
+           Doc('SWAP_RB', 'swap the first and the third channel of a 3-channel '
+               'src, i.e. RGB2BGR or BGR2RGB'),
+           'YUV2RGB_NV21', 'YUV2BGR_NV21', 'YUV2RGB_NV12', 'YUV2BGR_NV12',
+           'YUV2RGB_YV12', 'YUV2BGR_YV12', 'YUV2RGB_YU12', 'YUV2BGR_YU12',
+           name_field='color_mode')
+ .add_enum_alias('InterpolationMode', 'WarpPerspective', name_field='imode')
+ .add_fields('uint32',
+             Doc('out_height', 'height of dst; 0 to keep the height of src '
+                 'after color conversion'), 0,
+             Doc('out_width', 'width of dst; 0 to keep the width of src'), 0)
+ .add_enum_alias('Format', 'ConvolutionV0'))
+
+(pdef('FusedOptimizerUpdate')
+ .add_enum('Mode',
+           Doc('SGD', 'g = grad + weight_decay * param; if momentum is not '
+               'zero, state0 = momentum * state0 + g and g = state0; '
+               'param -= lr * g'),
+           Doc('ADAM', 'g = grad + weight_decay * param; '
+               'state0 = beta0 * state0 + (1 - beta0) * g; '
+               'state1 = beta1 * state1 + (1 - beta1) * g * g; '
+               'param -= lr * (state0 / (1 - beta0 ^ step)) / '
+               '(sqrt(state1 / (1 - beta1 ^ step)) + eps)'))
+ .add_fields('float32',
+             Doc('lr', 'learning rate'), 0,
+             Doc('weight_decay', 'L2 penalty coefficient'), 0,
+             Doc('momentum', 'momentum factor of SGD'), 0,
+             Doc('beta0', 'decay rate of the first moment of ADAM'), 0.9,
+             Doc('beta1', 'decay rate of the second moment of ADAM'), 0.999,
+             Doc('eps', 'term added to the denominator of ADAM'), 1e-8)
+ .add_fields('uint32',
+             Doc('step', 'number of steps including this one, used for the '
+                 'bias correction of ADAM'), 1))
+
 (pdef('Convolution3D').
  add_enum('Mode', 'CROSS_CORRELATION', 'CONVOLUTION').
  add_fields(
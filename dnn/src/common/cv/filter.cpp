@@ -185,19 +185,22 @@ void FilterEngine<ST, FT>::start(const Mat<ST>& src) {
 }
 
 template <typename ST, typename FT>
-int FilterEngine<ST, FT>::proceed(const uchar* src, int srcstep, int count,
-                                  uchar* dst, int dststep) {
+int FilterEngine<ST, FT>::proceed(const uchar* src, int srcstep, int src_y0,
+                                  int count, uchar* dst, int dststep,
+                                  int dst_y0, int dst_end) {
     const int* btab = &m_border_table[0];
     int src_elem_size = static_cast<int>(sizeof(ST) * m_ch);
     bool makeBorder = (m_left_width > 0 || m_right_width > 0) &&
                       m_bmode != BorderMode::BORDER_CONSTANT;
-    int dy = 0, i = 0;
+    int dy = dst_y0, i = 0;
 
+    //! rows in ring buffer are [start_y, start_y + row_count) of the image
     int row_count = 0;
-    int start_y = 0;
+    int start_y = src_y0;
     std::vector<uchar*> buf_rows(m_ksize.rows(), nullptr);
     for (;; dst += dststep * i, dy += i) {
-        int dcount = m_ksize.height() - m_anchor.y - start_y - row_count;
+        int dcount = dst_y0 + m_ksize.height() - m_anchor.y - start_y -
+                     row_count;
         dcount = dcount > 0 ? dcount : 1;
         dcount = std::min<int>(dcount, count);
         count -= dcount;
@@ -243,9 +246,8 @@ int FilterEngine<ST, FT>::proceed(const uchar* src, int srcstep, int count,
             (*m_row_filter)(row, brow, m_whole_size.width(), m_ch);
         }
 
-        int max_i = std::min<int>(
-                m_ksize.height(),
-                m_whole_size.height() - dy + (m_ksize.height() - 1));
+        int max_i = std::min<int>(m_ksize.height(),
+                                  dst_end - dy + (m_ksize.height() - 1));
         for (i = 0; i < max_i; i++) {
             int src_y = gaussian_blur::border_interpolate(dy + i - m_anchor.y,
                                            m_whole_size.rows(), m_bmode);
@@ -274,12 +276,23 @@ int FilterEngine<ST, FT>::proceed(const uchar* src, int srcstep, int count,
 
 template <typename ST, typename FT>
 void FilterEngine<ST, FT>::apply(const Mat<ST>& src, Mat<ST>& dst) {
+    apply(src, dst, 0, src.rows());
+}
+
+template <typename ST, typename FT>
+void FilterEngine<ST, FT>::apply(const Mat<ST>& src, Mat<ST>& dst,
+                                 int row_begin, int row_end) {
     int src_step = src.step() * sizeof(ST);
     int dst_step = dst.step() * sizeof(ST);
     start(src);
-    proceed(reinterpret_cast<const uchar*>(src.ptr()),
-            static_cast<int>(src_step), m_whole_size.height(),
-            reinterpret_cast<uchar*>(dst.ptr()), static_cast<int>(dst_step));
+    //! src rows covered by the kernel when computing the dst rows
+    int src_begin = std::max<int>(row_begin - m_anchor.y, 0),
+        src_end = std::min<int>(row_end + m_ksize.height() - m_anchor.y - 1,
+                                m_whole_size.height());
+    proceed(reinterpret_cast<const uchar*>(src.ptr(src_begin)),
+            static_cast<int>(src_step), src_begin, src_end - src_begin,
+            reinterpret_cast<uchar*>(dst.ptr(row_begin)),
+            static_cast<int>(dst_step), row_begin, row_end);
 }
 
 //! explicit instantiation template
@@ -294,6 +307,12 @@ template void FilterEngine<uchar, int>::apply(const Mat<uchar>& src,
                                               Mat<uchar>& dst);
 template void FilterEngine<float, float>::apply(const Mat<float>& src,
                                               Mat<float>& dst);
+template void FilterEngine<uchar, int>::apply(const Mat<uchar>& src,
+                                              Mat<uchar>& dst, int row_begin,
+                                              int row_end);
+template void FilterEngine<float, float>::apply(const Mat<float>& src,
+                                                Mat<float>& dst, int row_begin,
+                                                int row_end);
 
 template FilterEngine<unsigned char, int>::~FilterEngine();
 template FilterEngine<float, float>::~FilterEngine();
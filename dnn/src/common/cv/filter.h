@@ -496,12 +496,23 @@ public:
     //! applies filter to the the whole image.
     void apply(const Mat<ST>& src, Mat<ST>& dst);
 
+    /*!
+     * \brief applies filter to dst rows in [row_begin, row_end) of the image
+     *
+     * Rows outside the range are read from src instead of the border, so
+     * the result is the same as filtering the whole image.
+     */
+    void apply(const Mat<ST>& src, Mat<ST>& dst, int row_begin, int row_end);
+
 private:
     //! starts filtering of the src image.
     void start(const Mat<ST>& src);
-    //! processes the next srcCount rows of the image.
-    int proceed(const uchar* src, int srcStep, int srcCount, uchar* dst,
-                        int dstStep);
+    /*!
+     * \brief processes srcCount rows of the image from row src_y, and
+     *      writes dst rows from dst_y until dst_end
+     */
+    int proceed(const uchar* src, int srcStep, int src_y, int srcCount,
+                uchar* dst, int dstStep, int dst_y, int dst_end);
 
     //! row filter filter
     BaseRowFilter* m_row_filter;
@@ -0,0 +1,77 @@
+/**
+ * \file dnn/src/common/fused_optimizer_update.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "megdnn/oprs.h"
+
+#include "src/common/fused_optimizer_update_helper.h"
+#include "src/common/utils.h"
+
+namespace megdnn {
+
+fused_optimizer_update::KernParam fused_optimizer_update::make_kern_param(
+        const param::FusedOptimizerUpdate& param) {
+    KernParam ret;
+    ret.lr = param.lr;
+    ret.weight_decay = param.weight_decay;
+    ret.momentum = param.momentum;
+    ret.beta0 = param.beta0;
+    ret.beta1 = param.beta1;
+    ret.eps = param.eps;
+    double step = param.step;
+    ret.bias_correction0 = 1. / (1. - std::pow(double(param.beta0), step));
+    ret.rsqrt_bias_correction1 =
+            1. / std::sqrt(1. - std::pow(double(param.beta1), step));
+    return ret;
+}
+
+void FusedOptimizerUpdate::check_exec(const TensorLayout& param,
+                                      const TensorLayout& grad,
+                                      const TensorLayout& state0,
+                                      const TensorLayout& state1,
+                                      size_t workspace_in_bytes) {
+    auto errmsg = [&]() {
+        return megdnn_layout_msg(param) + ", " + megdnn_layout_msg(grad) +
+               ", " + megdnn_layout_msg(state0) + ", " +
+               megdnn_layout_msg(state1);
+    };
+    MEGDNN_MARK_USED_VAR(errmsg);
+    megdnn_assert(param.dtype == dtype::Float32() && param.is_contiguous() &&
+                          grad.eq_layout(param),
+                  "bad param or grad: %s", errmsg().c_str());
+
+    bool need_state0, need_state1;
+    switch (m_param.mode) {
+        case Mode::SGD:
+            need_state0 = m_param.momentum != 0.f;
+            need_state1 = false;
+            break;
+        case Mode::ADAM:
+            megdnn_assert(m_param.step >= 1 && m_param.beta0 < 1.f &&
+                                  m_param.beta1 < 1.f,
+                          "bad ADAM param: step=%u beta0=%g beta1=%g",
+                          m_param.step, m_param.beta0, m_param.beta1);
+            need_state0 = need_state1 = true;
+            break;
+        default:
+            megdnn_throw("bad FusedOptimizerUpdate mode");
+    }
+    megdnn_assert(!need_state0 || state0.eq_layout(param), "bad state0: %s",
+                  errmsg().c_str());
+    megdnn_assert(!need_state1 || state1.eq_layout(param), "bad state1: %s",
+                  errmsg().c_str());
+
+    auto required_workspace_in_bytes =
+            get_workspace_in_bytes(param, grad, state0, state1);
+    megdnn_assert(workspace_in_bytes >= required_workspace_in_bytes);
+}
+
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,60 @@
+/**
+ * \file dnn/src/common/fused_optimizer_update_helper.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#pragma once
+#include "megdnn/arch.h"
+
+#if MEGDNN_CC_HOST
+#include <cmath>
+#include "megdnn/opr_param_defs.h"
+#endif
+
+namespace megdnn {
+namespace fused_optimizer_update {
+
+//! coefficients used by the kernels, derived from param::FusedOptimizerUpdate
+struct KernParam {
+    float lr, weight_decay, momentum, beta0, beta1, eps;
+    //! 1 / (1 - beta0 ^ step) for ADAM
+    float bias_correction0;
+    //! 1 / sqrt(1 - beta1 ^ step) for ADAM
+    float rsqrt_bias_correction1;
+};
+
+#if MEGDNN_CC_HOST
+KernParam make_kern_param(const param::FusedOptimizerUpdate& param);
+#endif
+
+MEGDNN_HOST MEGDNN_DEVICE inline void sgd(const KernParam& p, float& param,
+                                          float grad) {
+    param -= p.lr * (grad + p.weight_decay * param);
+}
+
+MEGDNN_HOST MEGDNN_DEVICE inline void sgd_momentum(const KernParam& p,
+                                                   float& param, float grad,
+                                                   float& buf) {
+    buf = p.momentum * buf + grad + p.weight_decay * param;
+    param -= p.lr * buf;
+}
+
+MEGDNN_HOST MEGDNN_DEVICE inline void adam(const KernParam& p, float& param,
+                                           float grad, float& exp_avg,
+                                           float& exp_avg_sq) {
+    float g = grad + p.weight_decay * param;
+    exp_avg = p.beta0 * exp_avg + (1.f - p.beta0) * g;
+    exp_avg_sq = p.beta1 * exp_avg_sq + (1.f - p.beta1) * g * g;
+    param -= p.lr * (exp_avg * p.bias_correction0) /
+             (sqrtf(exp_avg_sq) * p.rsqrt_bias_correction1 + p.eps);
+}
+
+}  // namespace fused_optimizer_update
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
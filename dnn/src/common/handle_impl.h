@@ -189,6 +189,8 @@ private:
     cb(ROIAlignForward) \
     cb(ROIAlignBackward) \
     cb(BatchConvBiasForward) \
+    cb(ImagePreprocess) \
+    cb(FusedOptimizerUpdate) \
 
 /*!
  * \brief specialize HandleImpl::create_operator for a single opr type;
@@ -0,0 +1,147 @@
+/**
+ * \file dnn/src/common/image_preprocess.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "megdnn/oprs.h"
+
+#include "src/common/image_preprocess_helper.h"
+#include "src/common/utils.h"
+
+namespace megdnn {
+
+image_preprocess::SrcFormat image_preprocess::get_src_format(
+        const param::ImagePreprocess& param, const TensorLayout& src) {
+    using ColorMode = param::ImagePreprocess::ColorMode;
+    SrcFormat ret;
+    ret.ih = src.shape[1];
+    ret.iw = src.shape[2];
+    ret.ic = src.shape[3];
+    ret.is_yuv = ret.is_planar = ret.is_uv = ret.swap_rb = false;
+    switch (param.color_mode) {
+        case ColorMode::NONE:
+            break;
+        case ColorMode::SWAP_RB:
+            ret.swap_rb = true;
+            break;
+#define cb(_mode, _planar, _uv, _swap) \
+    case ColorMode::_mode:             \
+        ret.is_planar = _planar;       \
+        ret.is_uv = _uv;               \
+        ret.swap_rb = _swap;           \
+        break;
+            cb(YUV2RGB_NV21, false, false, false);
+            cb(YUV2BGR_NV21, false, false, true);
+            cb(YUV2RGB_NV12, false, true, false);
+            cb(YUV2BGR_NV12, false, true, true);
+            cb(YUV2RGB_YV12, true, false, false);
+            cb(YUV2BGR_YV12, true, false, true);
+            cb(YUV2RGB_YU12, true, true, false);
+            cb(YUV2BGR_YU12, true, true, true);
+#undef cb
+        default:
+            megdnn_throw("unknown color mode of ImagePreprocess");
+    }
+    if (param.color_mode != ColorMode::NONE &&
+        param.color_mode != ColorMode::SWAP_RB) {
+        ret.is_yuv = true;
+        ret.ih = ret.ih / 3 * 2;
+        ret.ic = 3;
+    }
+    return ret;
+}
+
+void ImagePreprocessBase::deduce_layout_fwd(const TensorLayout& src,
+                                            const TensorLayout& scale,
+                                            const TensorLayout& bias,
+                                            TensorLayout& dst) {
+    MEGDNN_MARK_USED_VAR(scale);
+    MEGDNN_MARK_USED_VAR(bias);
+    auto errmsg = [&]() { return megdnn_layout_msg(src); };
+    MEGDNN_MARK_USED_VAR(errmsg);
+    megdnn_assert(src.ndim == 4_z && src.dtype == dtype::Uint8(), "%s",
+                  errmsg().c_str());
+    auto mode = param().color_mode;
+    if (mode == ColorMode::NONE || mode == ColorMode::SWAP_RB) {
+        megdnn_assert(src.shape[3] <= image_preprocess::MAX_NR_CHANNELS &&
+                              (mode == ColorMode::NONE || src.shape[3] == 3),
+                      "%s", errmsg().c_str());
+    } else {
+        megdnn_assert(src.shape[3] == 1 && src.shape[1] % 3 == 0 &&
+                              src.shape[1] / 3 % 2 == 0 &&
+                              src.shape[2] % 2 == 0,
+                      "invalid yuv420 src: %s", errmsg().c_str());
+    }
+    auto fmt = image_preprocess::get_src_format(param(), src);
+    megdnn_assert((param().out_height == 0) == (param().out_width == 0),
+                  "out_height and out_width should be both set or both 0");
+    size_t oh = param().out_height ? param().out_height : fmt.ih,
+           ow = param().out_width ? param().out_width : fmt.iw;
+    size_t oc = fmt.ic;
+    DType dtype = dst.dtype.valid() ? dst.dtype : dtype::Float32();
+    if (param().format == Param::Format::NCHW) {
+        dst = TensorLayout{{src.shape[0], oc, oh, ow}, dtype};
+    } else {
+        megdnn_assert(param().format == Param::Format::NCHW88,
+                      "ImagePreprocess only supports NCHW and NCHW88 dst");
+        dst = TensorLayout{{src.shape[0], div_ceil<size_t>(oc, 8), oh, ow, 8},
+                           dtype};
+    }
+}
+
+void ImagePreprocessBase::check_layout_fwd(const TensorLayout& src,
+                                           const TensorLayout& scale,
+                                           const TensorLayout& bias,
+                                           const TensorLayout& dst) {
+    auto errmsg = [&]() {
+        return megdnn_layout_msg(src) + ", " + megdnn_layout_msg(scale) +
+               ", " + megdnn_layout_msg(bias) + ", " + megdnn_layout_msg(dst);
+    };
+    MEGDNN_MARK_USED_VAR(errmsg);
+    TensorLayout dst_expected{dst.dtype};
+    deduce_layout_fwd(src, scale, bias, dst_expected);
+    megdnn_assert_eq_shape(dst_expected, dst);
+    megdnn_assert(dst.dtype == dtype::Float32() ||
+                          dst.dtype.enumv() == DTypeEnum::QuantizedS8,
+                  "%s", errmsg().c_str());
+    megdnn_assert(param().imode == InterpolationMode::NEAREST ||
+                          param().imode == InterpolationMode::LINEAR,
+                  "ImagePreprocess only supports NEAREST and LINEAR resize");
+    size_t oc = image_preprocess::get_src_format(param(), src).ic;
+    for (auto&& ly : {scale, bias}) {
+        megdnn_assert(ly.ndim == 1 && ly.shape[0] == oc &&
+                              ly.dtype == dtype::Float32(),
+                      "%s", errmsg().c_str());
+    }
+    megdnn_assert_contiguous(src);
+    megdnn_assert_contiguous(scale);
+    megdnn_assert_contiguous(bias);
+    megdnn_assert_contiguous(dst);
+}
+
+void ImagePreprocess::deduce_layout(const TensorLayout& src,
+                                    const TensorLayout& scale,
+                                    const TensorLayout& bias,
+                                    TensorLayout& dst) {
+    deduce_layout_fwd(src, scale, bias, dst);
+}
+
+void ImagePreprocess::check_exec(const TensorLayout& src,
+                                 const TensorLayout& scale,
+                                 const TensorLayout& bias,
+                                 const TensorLayout& dst,
+                                 size_t workspace_in_bytes) {
+    check_layout_fwd(src, scale, bias, dst);
+    auto required_workspace_in_bytes =
+            get_workspace_in_bytes(src, scale, bias, dst);
+    megdnn_assert(workspace_in_bytes >= required_workspace_in_bytes);
+}
+
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
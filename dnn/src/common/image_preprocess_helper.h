@@ -0,0 +1,185 @@
+/**
+ * \file dnn/src/common/image_preprocess_helper.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#pragma once
+#include "megdnn/dtype.h"
+#include "src/common/rounding_converter.cuh"
+
+#if MEGDNN_CC_HOST
+#include <cmath>
+#include "megdnn/basic_types.h"
+#include "megdnn/opr_param_defs.h"
+#endif
+
+namespace megdnn {
+namespace image_preprocess {
+
+//! max number of channels of src after color conversion
+constexpr int MAX_NR_CHANNELS = 4;
+
+/*!
+ * \brief how to read a pixel of one src image, decoded from
+ *      param::ImagePreprocess::ColorMode
+ */
+struct SrcFormat {
+    //! size of src after color conversion
+    int ih, iw, ic;
+    //! src is yuv420 of {ih * 3 / 2, iw, 1}
+    bool is_yuv;
+    //! chroma is stored in two planes (YV12, YU12) rather than interleaved
+    bool is_planar;
+    //! U is before V
+    bool is_uv;
+    //! swap channel 0 and 2 of the converted pixel
+    bool swap_rb;
+};
+
+#if MEGDNN_CC_HOST
+//! decode the format of each image of \p src; src must have been checked
+SrcFormat get_src_format(const param::ImagePreprocess& param,
+                         const TensorLayout& src);
+#endif
+
+/*!
+ * \brief src coordinate of a dst index for bilinear interpolation; same as
+ *      ResizeBase::get_origin_coord, so the results match Resize
+ */
+MEGDNN_HOST MEGDNN_DEVICE inline void get_linear_coord(float scale, int size,
+                                                       int idx, int& i0,
+                                                       int& i1,
+                                                       float& alpha) {
+    if (size == 1) {
+        i0 = i1 = 0;
+        alpha = 0.f;
+        return;
+    }
+    alpha = (idx + 0.5f) / scale - 0.5f;
+    i0 = static_cast<int>(floorf(alpha));
+    alpha -= i0;
+    if (i0 < 0) {
+        i0 = 0;
+        alpha = 0.f;
+    } else if (i0 + 1 >= size) {
+        i0 = size - 2;
+        alpha = 1.f;
+    }
+    i1 = i0 + 1;
+}
+
+//! src coordinate of a dst index for nearest interpolation
+MEGDNN_HOST MEGDNN_DEVICE inline int get_nearest_coord(int dst_size,
+                                                       int src_size, int idx) {
+    double inv_scale = 1.0 / (static_cast<double>(dst_size) / src_size);
+    int ret = static_cast<int>(floor(idx * inv_scale));
+    return ret < src_size ? ret : src_size - 1;
+}
+
+MEGDNN_HOST MEGDNN_DEVICE inline int saturate_u8(int x) {
+    return x > 255 ? 255 : (x < 0 ? 0 : x);
+}
+
+//! chroma terms of the integer yuv to rgb conversion used by CvtColor
+MEGDNN_HOST MEGDNN_DEVICE inline void get_yuv_chroma(int U, int V, int& ruv,
+                                                     int& guv, int& buv) {
+    ruv = (359 * (V - 128)) >> 8;
+    guv = -1 * ((88 * (U - 128) + 183 * (V - 128)) >> 8);
+    buv = (454 * (U - 128)) >> 8;
+}
+
+/*!
+ * \brief load pixel (h, w) of image \p src and convert its color
+ *
+ * The yuv conversion is the integer one used by CvtColor.
+ */
+MEGDNN_HOST MEGDNN_DEVICE inline void load_pixel(const uint8_t* src,
+                                                 const SrcFormat& fmt, int h,
+                                                 int w, int* val) {
+    if (fmt.is_yuv) {
+        int Y = src[h * fmt.iw + w], U, V;
+        const uint8_t* chroma = src + fmt.ih * fmt.iw;
+        if (fmt.is_planar) {
+            int offset = (h / 2) * (fmt.iw / 2) + w / 2;
+            int plane = fmt.ih * fmt.iw / 4;
+            U = chroma[offset + (fmt.is_uv ? 0 : plane)];
+            V = chroma[offset + (fmt.is_uv ? plane : 0)];
+        } else {
+            const uint8_t* p = chroma + (h / 2) * fmt.iw + (w / 2) * 2;
+            U = p[fmt.is_uv ? 0 : 1];
+            V = p[fmt.is_uv ? 1 : 0];
+        }
+        int ruv, guv, buv;
+        get_yuv_chroma(U, V, ruv, guv, buv);
+        val[0] = saturate_u8(Y + ruv);
+        val[1] = saturate_u8(Y + guv);
+        val[2] = saturate_u8(Y + buv);
+    } else {
+        const uint8_t* p = src + (h * fmt.iw + w) * fmt.ic;
+        for (int c = 0; c < fmt.ic; ++c) {
+            val[c] = p[c];
+        }
+    }
+    if (fmt.swap_rb) {
+        int t = val[0];
+        val[0] = val[2];
+        val[2] = t;
+    }
+}
+
+/*!
+ * \brief bilinear interpolation of four converted pixels rounded to uint8,
+ *      with the same arithmetic as Resize
+ */
+MEGDNN_HOST MEGDNN_DEVICE inline float blend_linear(int v00, int v01, int v10,
+                                                    int v11, float alphah,
+                                                    float alphaw) {
+    float ret = v00 * (1.0f - alphaw) * (1.0f - alphah) +
+                v01 * alphaw * (1.0f - alphah) +
+                v10 * (1.0f - alphaw) * alphah + v11 * alphaw * alphah;
+    return rounding::RoundingConverter<uint8_t>()(ret);
+}
+
+/*!
+ * \brief compute pixel (oh, ow) of an image resized to (OH, OW) from the
+ *      converted \p src, before the affine transform
+ */
+MEGDNN_HOST MEGDNN_DEVICE inline void get_dst_pixel(const uint8_t* src,
+                                                    const SrcFormat& fmt,
+                                                    bool linear, int OH,
+                                                    int OW, int oh, int ow,
+                                                    float* val) {
+    int v[4][MAX_NR_CHANNELS];
+    if (!linear) {
+        load_pixel(src, fmt, get_nearest_coord(OH, fmt.ih, oh),
+                   get_nearest_coord(OW, fmt.iw, ow), v[0]);
+        for (int c = 0; c < fmt.ic; ++c) {
+            val[c] = v[0][c];
+        }
+        return;
+    }
+    int ih0, ih1, iw0, iw1;
+    float alphah, alphaw;
+    get_linear_coord(static_cast<float>(OH) / fmt.ih, fmt.ih, oh, ih0, ih1,
+                     alphah);
+    get_linear_coord(static_cast<float>(OW) / fmt.iw, fmt.iw, ow, iw0, iw1,
+                     alphaw);
+    load_pixel(src, fmt, ih0, iw0, v[0]);
+    load_pixel(src, fmt, ih0, iw1, v[1]);
+    load_pixel(src, fmt, ih1, iw0, v[2]);
+    load_pixel(src, fmt, ih1, iw1, v[3]);
+    for (int c = 0; c < fmt.ic; ++c) {
+        val[c] = blend_linear(v[0][c], v[1][c], v[2][c], v[3][c], alphah,
+                              alphaw);
+    }
+}
+
+}  // namespace image_preprocess
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,80 @@
+/**
+ * \file dnn/src/cuda/fused_optimizer_update/fused_optimizer_update.cu
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "src/cuda/fused_optimizer_update/fused_optimizer_update.cuh"
+
+#include "src/cuda/utils.cuh"
+
+namespace megdnn {
+namespace cuda {
+namespace fused_optimizer_update {
+
+namespace {
+
+__global__ void kern_sgd(KernParam p, float* param, const float* grad,
+                         size_t size) {
+    for (size_t i = blockIdx.x * blockDim.x + threadIdx.x; i < size;
+         i += gridDim.x * blockDim.x) {
+        megdnn::fused_optimizer_update::sgd(p, param[i], grad[i]);
+    }
+}
+
+__global__ void kern_sgd_momentum(KernParam p, float* param, const float* grad,
+                                  float* buf, size_t size) {
+    for (size_t i = blockIdx.x * blockDim.x + threadIdx.x; i < size;
+         i += gridDim.x * blockDim.x) {
+        megdnn::fused_optimizer_update::sgd_momentum(p, param[i], grad[i],
+                                                     buf[i]);
+    }
+}
+
+__global__ void kern_adam(KernParam p, float* param, const float* grad,
+                          float* exp_avg, float* exp_avg_sq, size_t size) {
+    for (size_t i = blockIdx.x * blockDim.x + threadIdx.x; i < size;
+         i += gridDim.x * blockDim.x) {
+        megdnn::fused_optimizer_update::adam(p, param[i], grad[i], exp_avg[i],
+                                             exp_avg_sq[i]);
+    }
+}
+
+//! grid size for a grid-stride loop over size elements
+unsigned get_nr_blocks(size_t size) {
+    return std::max<size_t>(
+            1, std::min<size_t>(DIVUP(size, NR_THREADS), 65535));
+}
+
+}  // anonymous namespace
+
+void sgd(const KernParam& p, float* param, const float* grad, size_t size,
+         cudaStream_t stream) {
+    kern_sgd<<<get_nr_blocks(size), NR_THREADS, 0, stream>>>(p, param, grad,
+                                                             size);
+    after_kernel_launch();
+}
+
+void sgd_momentum(const KernParam& p, float* param, const float* grad,
+                  float* buf, size_t size, cudaStream_t stream) {
+    kern_sgd_momentum<<<get_nr_blocks(size), NR_THREADS, 0, stream>>>(
+            p, param, grad, buf, size);
+    after_kernel_launch();
+}
+
+void adam(const KernParam& p, float* param, const float* grad, float* exp_avg,
+          float* exp_avg_sq, size_t size, cudaStream_t stream) {
+    kern_adam<<<get_nr_blocks(size), NR_THREADS, 0, stream>>>(
+            p, param, grad, exp_avg, exp_avg_sq, size);
+    after_kernel_launch();
+}
+
+}  // namespace fused_optimizer_update
+}  // namespace cuda
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,34 @@
+/**
+ * \file dnn/src/cuda/fused_optimizer_update/fused_optimizer_update.cuh
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#pragma once
+#include <cuda_runtime_api.h>
+#include "src/common/fused_optimizer_update_helper.h"
+
+namespace megdnn {
+namespace cuda {
+namespace fused_optimizer_update {
+
+using megdnn::fused_optimizer_update::KernParam;
+
+void sgd(const KernParam& p, float* param, const float* grad, size_t size,
+         cudaStream_t stream);
+
+void sgd_momentum(const KernParam& p, float* param, const float* grad,
+                  float* buf, size_t size, cudaStream_t stream);
+
+void adam(const KernParam& p, float* param, const float* grad, float* exp_avg,
+          float* exp_avg_sq, size_t size, cudaStream_t stream);
+
+}  // namespace fused_optimizer_update
+}  // namespace cuda
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
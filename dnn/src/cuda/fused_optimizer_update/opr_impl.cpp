@@ -0,0 +1,43 @@
+/**
+ * \file dnn/src/cuda/fused_optimizer_update/opr_impl.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "src/cuda/fused_optimizer_update/opr_impl.h"
+#include "src/cuda/fused_optimizer_update/fused_optimizer_update.cuh"
+
+#include "src/cuda/handle.h"
+#include "src/cuda/utils.h"
+
+using namespace megdnn;
+using namespace cuda;
+
+void FusedOptimizerUpdateImpl::exec(_megdnn_tensor_inout param,
+                                    _megdnn_tensor_in grad,
+                                    _megdnn_tensor_inout state0,
+                                    _megdnn_tensor_inout state1,
+                                    _megdnn_workspace workspace) {
+    check_exec(param.layout, grad.layout, state0.layout, state1.layout,
+               workspace.size);
+    auto stream = cuda_stream(handle());
+    auto kp = megdnn::fused_optimizer_update::make_kern_param(m_param);
+    size_t size = param.layout.total_nr_elems();
+    float* pptr = param.ptr<dt_float32>();
+    const float* gptr = grad.ptr<dt_float32>();
+    if (m_param.mode == Mode::ADAM) {
+        fused_optimizer_update::adam(kp, pptr, gptr, state0.ptr<dt_float32>(),
+                                     state1.ptr<dt_float32>(), size, stream);
+    } else if (m_param.momentum != 0.f) {
+        fused_optimizer_update::sgd_momentum(
+                kp, pptr, gptr, state0.ptr<dt_float32>(), size, stream);
+    } else {
+        fused_optimizer_update::sgd(kp, pptr, gptr, size, stream);
+    }
+}
+
+// vim: syntax=cpp.doxygen
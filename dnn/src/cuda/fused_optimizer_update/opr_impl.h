@@ -0,0 +1,37 @@
+/**
+ * \file dnn/src/cuda/fused_optimizer_update/opr_impl.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#pragma once
+#include "megdnn/oprs.h"
+
+namespace megdnn {
+namespace cuda {
+
+class FusedOptimizerUpdateImpl final : public FusedOptimizerUpdate {
+public:
+    using FusedOptimizerUpdate::FusedOptimizerUpdate;
+
+    void exec(_megdnn_tensor_inout param, _megdnn_tensor_in grad,
+              _megdnn_tensor_inout state0, _megdnn_tensor_inout state1,
+              _megdnn_workspace workspace) override;
+
+    size_t get_workspace_in_bytes(const TensorLayout&, const TensorLayout&,
+                                  const TensorLayout&,
+                                  const TensorLayout&) override {
+        return 0;
+    }
+
+    bool is_thread_safe() const override { return true; }
+};
+
+}  // namespace cuda
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
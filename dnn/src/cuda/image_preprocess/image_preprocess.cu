@@ -0,0 +1,106 @@
+/**
+ * \file dnn/src/cuda/image_preprocess/image_preprocess.cu
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "src/cuda/image_preprocess/image_preprocess.cuh"
+
+#include "src/cuda/utils.cuh"
+
+namespace megdnn {
+namespace cuda {
+namespace image_preprocess {
+
+using megdnn::image_preprocess::MAX_NR_CHANNELS;
+using megdnn::image_preprocess::SrcFormat;
+using megdnn::image_preprocess::get_dst_pixel;
+
+namespace {
+
+struct FloatConverter {
+    FloatConverter(float) {}
+    __device__ float operator()(float x) const { return x; }
+};
+
+struct QInt8Converter {
+    CudaDTypeParam<dtype::QuantizedS8> param;
+    QInt8Converter(float scale) : param{scale} {}
+    __device__ dt_qint8 operator()(float x) const { return param.quantize(x); }
+};
+
+template <typename ctype>
+struct ConverterTrait;
+template <>
+struct ConverterTrait<float> {
+    using type = FloatConverter;
+};
+template <>
+struct ConverterTrait<dt_qint8> {
+    using type = QInt8Converter;
+};
+
+template <typename ctype, typename Converter>
+__global__ void kern_forward(const uint8_t* __restrict src,
+                             ctype* __restrict dst,
+                             const float* __restrict scale,
+                             const float* __restrict bias, SrcFormat fmt,
+                             bool linear, bool nchw88, int OH, int OW,
+                             Converter converter) {
+    int ow = blockIdx.x * blockDim.x + threadIdx.x;
+    int oh = blockIdx.y * blockDim.y + threadIdx.y;
+    if (ow >= OW || oh >= OH) {
+        return;
+    }
+    int n = blockIdx.z, C = fmt.ic;
+    int src_image_size = fmt.is_yuv ? fmt.ih * fmt.iw * 3 / 2
+                                    : fmt.ih * fmt.iw * fmt.ic;
+    float val[MAX_NR_CHANNELS];
+    get_dst_pixel(src + n * src_image_size, fmt, linear, OH, OW, oh, ow, val);
+    if (nchw88) {
+        ctype* dptr = dst + ((n * OH + oh) * OW + ow) * 8;
+        for (int c = 0; c < 8; ++c) {
+            dptr[c] = c < C ? converter(val[c] * scale[c] + bias[c])
+                            : converter(0.f);
+        }
+    } else {
+        ctype* dptr = dst + n * C * OH * OW + oh * OW + ow;
+        for (int c = 0; c < C; ++c) {
+            dptr[c * OH * OW] = converter(val[c] * scale[c] + bias[c]);
+        }
+    }
+}
+
+}  // anonymous namespace
+
+template <typename ctype>
+void forward_proxy(const uint8_t* src, ctype* dst, const float* scale,
+                   const float* bias, const SrcFormat& fmt, bool linear,
+                   bool nchw88, int N, int OH, int OW, float dst_scale,
+                   cudaStream_t stream) {
+    using Converter = typename ConverterTrait<ctype>::type;
+    dim3 threads(32, 4);
+    dim3 blocks(DIVUP(OW, threads.x), DIVUP(OH, threads.y), N);
+    kern_forward<ctype, Converter><<<blocks, threads, 0, stream>>>(
+            src, dst, scale, bias, fmt, linear, nchw88, OH, OW,
+            Converter(dst_scale));
+    after_kernel_launch();
+}
+
+#define INST(_ctype)                                                       \
+    template void forward_proxy<_ctype>(                                   \
+            const uint8_t*, _ctype*, const float*, const float*,           \
+            const SrcFormat&, bool, bool, int, int, int, float, cudaStream_t);
+INST(float)
+INST(dt_qint8)
+#undef INST
+
+}  // namespace image_preprocess
+}  // namespace cuda
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,34 @@
+/**
+ * \file dnn/src/cuda/image_preprocess/image_preprocess.cuh
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#pragma once
+#include <cuda_runtime_api.h>
+#include "src/common/image_preprocess_helper.h"
+
+namespace megdnn {
+namespace cuda {
+namespace image_preprocess {
+
+/*!
+ * \brief compute ImagePreprocess with one thread per output pixel
+ * \param dst_scale scale of QuantizedS8 dst; unused for float dst
+ */
+template <typename ctype>
+void forward_proxy(const uint8_t* src, ctype* dst, const float* scale,
+                   const float* bias,
+                   const megdnn::image_preprocess::SrcFormat& fmt,
+                   bool linear, bool nchw88, int N, int OH, int OW,
+                   float dst_scale, cudaStream_t stream);
+
+}  // namespace image_preprocess
+}  // namespace cuda
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
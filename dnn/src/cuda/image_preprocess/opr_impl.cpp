@@ -0,0 +1,44 @@
+/**
+ * \file dnn/src/cuda/image_preprocess/opr_impl.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "src/cuda/image_preprocess/opr_impl.h"
+#include "src/cuda/image_preprocess/image_preprocess.cuh"
+
+#include "src/cuda/handle.h"
+#include "src/cuda/utils.h"
+
+using namespace megdnn;
+using namespace cuda;
+
+void ImagePreprocessImpl::exec(_megdnn_tensor_in src, _megdnn_tensor_in scale,
+                               _megdnn_tensor_in bias, _megdnn_tensor_out dst,
+                               _megdnn_workspace workspace) {
+    check_exec(src.layout, scale.layout, bias.layout, dst.layout,
+               workspace.size);
+    auto stream = cuda_stream(handle());
+    auto fmt = megdnn::image_preprocess::get_src_format(param(), src.layout);
+    bool linear = param().imode == InterpolationMode::LINEAR;
+    bool nchw88 = param().format == Param::Format::NCHW88;
+    int N = src.layout[0], OH = dst.layout[2], OW = dst.layout[3];
+    if (dst.layout.dtype == dtype::Float32()) {
+        cuda::image_preprocess::forward_proxy(
+                src.ptr<dt_uint8>(), dst.ptr<dt_float32>(),
+                scale.ptr<dt_float32>(), bias.ptr<dt_float32>(), fmt, linear,
+                nchw88, N, OH, OW, 1.f, stream);
+    } else {
+        cuda::image_preprocess::forward_proxy(
+                src.ptr<dt_uint8>(), dst.compatible_ptr<dt_qint8>(),
+                scale.ptr<dt_float32>(), bias.ptr<dt_float32>(), fmt, linear,
+                nchw88, N, OH, OW,
+                dst.layout.dtype.param<dtype::QuantizedS8>().scale, stream);
+    }
+}
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,96 @@
+/**
+ * \file dnn/src/fallback/checksum/opr_impl.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "src/fallback/checksum/opr_impl.h"
+
+#include "src/common/utils.h"
+#include "src/fallback/handle.h"
+
+#include <cstring>
+
+#include "midout.h"
+MIDOUT_DECL(megdnn_fallback_checksum)
+
+using namespace megdnn;
+using namespace fallback;
+
+namespace {
+
+//! inputs smaller than this are computed by a single task
+constexpr size_t MIN_BLOCK_SIZE = 65536;
+
+uint32_t checksum_block(const uint32_t* __restrict ptr, size_t size,
+                        uint32_t base) {
+    uint32_t sum = 0;
+    ++base;
+    for (size_t i = 0; i < size; ++i) {
+        sum += ptr[i] * (base + static_cast<uint32_t>(i));
+    }
+    return sum;
+}
+
+}  // anonymous namespace
+
+size_t ChecksumForwardImpl::get_block_size(size_t nr_ints) {
+    size_t nr_threads = static_cast<naive::HandleImpl*>(handle())
+                                ->megcore_dispatcher()
+                                ->nr_threads();
+    // blocks are aligned to 64 bytes
+    return std::max(MIN_BLOCK_SIZE,
+                    round_up(div_ceil(nr_ints, nr_threads), size_t(16)));
+}
+
+size_t ChecksumForwardImpl::get_workspace_in_bytes(const TensorLayout& data) {
+    size_t nr_ints = data.shape[0] / sizeof(uint32_t);
+    return div_ceil(nr_ints, get_block_size(nr_ints)) * sizeof(uint32_t);
+}
+
+ChecksumForward::Result ChecksumForwardImpl::exec(_megdnn_tensor_in data,
+                                                  _megdnn_workspace workspace) {
+    return exec_with_kern(data, workspace, checksum_block);
+}
+
+ChecksumForward::Result ChecksumForwardImpl::exec_with_kern(
+        _megdnn_tensor_in data, _megdnn_workspace workspace, BlockKern kern) {
+    check_exec(data.layout, workspace.size);
+
+    Result result;
+    auto ptr = static_cast<const uint8_t*>(data.raw_ptr);
+    size_t size_all = data.layout.shape[0],
+           nr_ints = size_all / sizeof(uint32_t);
+    size_t block_size = get_block_size(nr_ints),
+           nr_blocks = div_ceil(nr_ints, block_size);
+    auto iptr = static_cast<const uint32_t*>(data.raw_ptr);
+    auto partial = reinterpret_cast<uint32_t*>(workspace.raw_ptr);
+
+    MIDOUT_BEGIN(megdnn_fallback_checksum) {
+        auto task = [=](size_t index, size_t) {
+            size_t begin = index * block_size,
+                   len = std::min(block_size, nr_ints - begin);
+            partial[index] = kern(iptr + begin, len, begin);
+        };
+        if (nr_blocks) {
+            MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN_OPR(task, nr_blocks);
+        }
+    }
+    MIDOUT_END();
+    static_cast<naive::HandleImpl*>(handle())->megcore_dispatcher()->sync();
+
+    result.checksum = 0;
+    for (size_t i = 0; i < nr_blocks; ++i) {
+        result.checksum += partial[i];
+    }
+    result.last_val.iv = 0;
+    auto last_val_size = std::min<size_t>(size_all, 4);
+    memcpy(&result.last_val, ptr + size_all - last_val_size, last_val_size);
+    return result;
+}
+
+// vim: syntax=cpp.doxygen
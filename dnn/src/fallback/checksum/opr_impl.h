@@ -0,0 +1,53 @@
+/**
+ * \file dnn/src/fallback/checksum/opr_impl.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#pragma once
+
+#include "megdnn/oprs.h"
+
+namespace megdnn {
+namespace fallback {
+
+/*!
+ * \brief Checksum split into blocks over the CPU worker threads
+ *
+ * The checksum is a sum of products, so each block computes a partial sum
+ * into the workspace, and the partial sums are added at last.
+ */
+class ChecksumForwardImpl : public ChecksumForward {
+public:
+    using ChecksumForward::ChecksumForward;
+
+    bool is_thread_safe() const override { return true; }
+
+    size_t get_workspace_in_bytes(const TensorLayout& data) override;
+
+    Result exec(_megdnn_tensor_in data, _megdnn_workspace workspace) override;
+
+protected:
+    /*!
+     * \brief kernel to compute sum of ptr[i] * (i + base + 1) for i in
+     *      [0, size), in modular arithmetic of uint32
+     */
+    using BlockKern = uint32_t (*)(const uint32_t* ptr, size_t size,
+                                   uint32_t base);
+
+    Result exec_with_kern(_megdnn_tensor_in data, _megdnn_workspace workspace,
+                          BlockKern kern);
+
+private:
+    //! number of uint32 elements in each block
+    size_t get_block_size(size_t nr_ints);
+};
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,286 @@
+/**
+ * \file dnn/src/fallback/convpooling/opr_impl.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "src/fallback/convpooling/opr_impl.h"
+#include "src/naive/handle.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace megdnn;
+using namespace fallback;
+
+namespace {
+
+using Param = param::ConvPooling;
+
+size_t conv_out_size(size_t in, size_t filter, size_t stride, size_t pad) {
+    return (in + 2 * pad - filter) / stride + 1;
+}
+
+//! valid range [begin, end) of a window starting at \p start
+void get_valid_range(ptrdiff_t start, size_t window, size_t size,
+                     size_t& begin, size_t& end) {
+    ptrdiff_t b = std::max<ptrdiff_t>(start, 0),
+              e = std::min<ptrdiff_t>(start + window, size);
+    begin = b;
+    end = std::max(b, e);
+}
+
+/*!
+ * \brief pool the rows of a band of one output channel
+ *
+ * \param conv conv output rows [conv_begin, conv_end) of the channel
+ * \param dst pooled output of the channel
+ */
+void pool_band(const float* conv, size_t conv_begin, size_t conv_end,
+               size_t CW, size_t pool_begin, size_t pool_end, size_t OW,
+               const Param& param, float* dst) {
+    bool is_max = param.poolMode == Param::PoolMode::MAX;
+    float init = is_max ? std::numeric_limits<float>::lowest() : 0.f;
+    float scale =
+            1.f / static_cast<float>(param.pool_shape_h * param.pool_shape_w);
+    for (size_t oh = pool_begin; oh < pool_end; ++oh) {
+        size_t ch_beg, ch_end;
+        get_valid_range(static_cast<ptrdiff_t>(oh * param.pool_stride_h) -
+                                static_cast<ptrdiff_t>(param.pool_pad_h),
+                        param.pool_shape_h, conv_end, ch_beg, ch_end);
+        ch_beg = std::max(ch_beg, conv_begin);
+        float* dptr = dst + oh * OW;
+        for (size_t ow = 0; ow < OW; ++ow) {
+            size_t cw_beg, cw_end;
+            get_valid_range(static_cast<ptrdiff_t>(ow * param.pool_stride_w) -
+                                    static_cast<ptrdiff_t>(param.pool_pad_w),
+                            param.pool_shape_w, CW, cw_beg, cw_end);
+            float acc = init;
+            for (size_t ch = ch_beg; ch < ch_end; ++ch) {
+                const float* row = conv + (ch - conv_begin) * CW;
+                if (is_max) {
+                    for (size_t cw = cw_beg; cw < cw_end; ++cw) {
+                        acc = std::max(acc, row[cw]);
+                    }
+                } else {
+                    for (size_t cw = cw_beg; cw < cw_end; ++cw) {
+                        acc += row[cw];
+                    }
+                }
+            }
+            dptr[ow] = is_max ? acc : acc * scale;
+        }
+    }
+}
+
+}  // anonymous namespace
+
+constexpr size_t ConvPoolingForwardImpl::MAX_BAND_SIZE;
+
+bool ConvPoolingForwardImpl::is_banded_supported(const TensorLayout& src,
+                                                 const TensorLayout& filter,
+                                                 const TensorLayout& bias) {
+    return src.dtype == dtype::Float32() && filter.dtype == dtype::Float32() &&
+           bias.dtype == dtype::Float32() && src.ndim == 4 &&
+           filter.ndim == 4 && src.is_contiguous() &&
+           filter.is_contiguous() && bias.is_contiguous() &&
+           bias.total_nr_elems() == filter[0] && filter[1] == src[1];
+}
+
+SmallVector<ConvPoolingForwardImpl::Band> ConvPoolingForwardImpl::get_bands(
+        const TensorLayout& src, const TensorLayout& filter,
+        const TensorLayout& dst) {
+    auto&& p = param();
+    size_t OC = filter[0], FH = filter[2],
+           CH = conv_out_size(src[2], FH, p.conv_stride_h, p.conv_pad_h),
+           CW = conv_out_size(src[3], filter[3], p.conv_stride_w,
+                              p.conv_pad_w),
+           OH = dst[2];
+    // pooled rows per band so that the conv rows they need fit in
+    // MAX_BAND_SIZE; overlapping pooling windows recompute
+    // pool_shape_h - pool_stride_h conv rows at each band boundary
+    size_t max_conv_rows = std::max<size_t>(
+            MAX_BAND_SIZE / (OC * CW * sizeof(dt_float32)), p.pool_shape_h);
+    size_t pool_rows =
+            (max_conv_rows - p.pool_shape_h) / p.pool_stride_h + 1;
+
+    SmallVector<Band> bands;
+    for (size_t begin = 0; begin < OH; begin += pool_rows) {
+        Band band;
+        band.pool_begin = begin;
+        band.pool_end = std::min(begin + pool_rows, OH);
+        size_t unused;
+        get_valid_range(static_cast<ptrdiff_t>(begin * p.pool_stride_h) -
+                                static_cast<ptrdiff_t>(p.pool_pad_h),
+                        p.pool_shape_h, CH, band.conv_begin, unused);
+        get_valid_range(static_cast<ptrdiff_t>((band.pool_end - 1) *
+                                               p.pool_stride_h) -
+                                static_cast<ptrdiff_t>(p.pool_pad_h),
+                        p.pool_shape_h, CH, unused, band.conv_end);
+        // a band entirely in the pooling padding still computes a conv row,
+        // so ConvBias always gets a non-empty output
+        band.conv_begin = std::min(band.conv_begin, CH - 1);
+        band.conv_end = std::max(band.conv_end, band.conv_begin + 1);
+        band.src_begin = static_cast<ptrdiff_t>(band.conv_begin *
+                                                p.conv_stride_h) -
+                         static_cast<ptrdiff_t>(p.conv_pad_h);
+        band.src_rows =
+                (band.conv_end - band.conv_begin - 1) * p.conv_stride_h + FH;
+        bands.push_back(band);
+    }
+    return bands;
+}
+
+ConvBiasForward* ConvPoolingForwardImpl::get_conv_bias_opr() {
+    if (!m_conv_bias_opr) {
+        m_conv_bias_opr = handle()->create_operator<ConvBiasForward>();
+    }
+    auto&& p = param();
+    auto&& cb_param = m_conv_bias_opr->param();
+    cb_param = {};
+    cb_param.mode = p.convMode;
+    switch (p.nonlineMode) {
+        case Param::NonlineMode::RELU:
+            cb_param.nonlineMode = param::ConvBias::NonlineMode::RELU;
+            break;
+        case Param::NonlineMode::SIGMOID:
+            cb_param.nonlineMode = param::ConvBias::NonlineMode::SIGMOID;
+            break;
+        default:
+            cb_param.nonlineMode = param::ConvBias::NonlineMode::IDENTITY;
+            break;
+    }
+    // rows outside of the input are zero-filled in the band buffer
+    cb_param.pad_h = 0;
+    cb_param.pad_w = p.conv_pad_w;
+    cb_param.stride_h = p.conv_stride_h;
+    cb_param.stride_w = p.conv_stride_w;
+    return m_conv_bias_opr.get();
+}
+
+void ConvPoolingForwardImpl::get_band_layouts(
+        const Band& band, const TensorLayout& src, const TensorLayout& filter,
+        TensorLayout& band_src, TensorLayout& band_bias, TensorLayout& band_z,
+        TensorLayout& band_dst) {
+    auto&& p = param();
+    size_t OC = filter[0],
+           CW = conv_out_size(src[3], filter[3], p.conv_stride_w,
+                              p.conv_pad_w);
+    band_src = TensorLayout{{1, src[1], band.src_rows, src[3]}, src.dtype};
+    band_bias = TensorLayout{{1, OC, 1, 1}, src.dtype};
+    band_z = TensorLayout{src.dtype};
+    band_dst = TensorLayout{{1, OC, band.conv_end - band.conv_begin, CW},
+                            src.dtype};
+}
+
+WorkspaceBundle ConvPoolingForwardImpl::get_bundle(void* ptr,
+                                                   const TensorLayout& src,
+                                                   const TensorLayout& filter,
+                                                   const TensorLayout& dst) {
+    auto conv_bias = get_conv_bias_opr();
+    size_t src_size = 0, conv_size = 0, conv_bias_ws_size = 0;
+    SmallVector<size_t> queried_rows;
+    for (auto&& band : get_bands(src, filter, dst)) {
+        size_t rows = band.conv_end - band.conv_begin;
+        if (std::find(queried_rows.begin(), queried_rows.end(), rows) !=
+            queried_rows.end()) {
+            continue;
+        }
+        queried_rows.push_back(rows);
+        TensorLayout band_src, band_bias, band_z, band_dst;
+        get_band_layouts(band, src, filter, band_src, band_bias, band_z,
+                         band_dst);
+        src_size = std::max(src_size, band_src.span().dist_byte());
+        conv_size = std::max(conv_size, band_dst.span().dist_byte());
+        conv_bias_ws_size = std::max(
+                conv_bias_ws_size,
+                conv_bias->get_workspace_in_bytes(band_src, filter, band_bias,
+                                                  band_z, band_dst));
+    }
+    return {ptr, {src_size, conv_size, conv_bias_ws_size}};
+}
+
+size_t ConvPoolingForwardImpl::get_workspace_in_bytes(
+        const TensorLayout& src, const TensorLayout& filter,
+        const TensorLayout& bias, const TensorLayout& dst) {
+    if (!is_banded_supported(src, filter, bias)) {
+        return naive::ConvPoolingForwardImpl::get_workspace_in_bytes(
+                src, filter, bias, dst);
+    }
+    return get_bundle(nullptr, src, filter, dst).total_size_in_bytes();
+}
+
+void ConvPoolingForwardImpl::exec(const _megdnn_in TensorND src,
+                                  const _megdnn_in TensorND filter,
+                                  const _megdnn_in TensorND bias,
+                                  _megdnn_out TensorND dst,
+                                  _megdnn_out Workspace workspace) {
+    if (!is_banded_supported(src.layout, filter.layout, bias.layout)) {
+        naive::ConvPoolingForwardImpl::exec(src, filter, bias, dst, workspace);
+        return;
+    }
+    TensorLayout dst_expected;
+    deduce_layout(src.layout, filter.layout, bias.layout, dst_expected);
+    megdnn_assert_eq_layout(dst_expected, dst.layout);
+    auto bundle =
+            get_bundle(workspace.raw_ptr, src.layout, filter.layout, dst.layout);
+    megdnn_assert(workspace.size >= bundle.total_size_in_bytes());
+
+    auto conv_bias = get_conv_bias_opr();
+    auto param = this->param();
+    size_t N = src.layout[0], IC = src.layout[1], IH = src.layout[2],
+           IW = src.layout[3], OC = filter.layout[0], OH = dst.layout[2],
+           OW = dst.layout[3],
+           CW = conv_out_size(IW, filter.layout[3], param.conv_stride_w,
+                              param.conv_pad_w);
+    auto band_src_ptr = static_cast<dt_float32*>(bundle.get(0)),
+         band_conv_ptr = static_cast<dt_float32*>(bundle.get(1));
+    TensorND bias_nd{bias.raw_ptr, {{1, OC, 1, 1}, bias.layout.dtype}};
+    auto bands = get_bands(src.layout, filter.layout, dst.layout);
+
+    // the kernels of all the bands run in order on the dispatcher, so the
+    // band buffers are reused by the next band only after being pooled
+    for (size_t n = 0; n < N; ++n) {
+        const dt_float32* sptr = src.ptr<dt_float32>() + n * IC * IH * IW;
+        dt_float32* dptr = dst.ptr<dt_float32>() + n * OC * OH * OW;
+        for (auto&& band : bands) {
+            TensorLayout band_src, band_bias, band_z, band_dst;
+            get_band_layouts(band, src.layout, filter.layout, band_src,
+                             band_bias, band_z, band_dst);
+
+            auto copy_src = [=](size_t ic, size_t) {
+                for (size_t r = 0; r < band.src_rows; ++r) {
+                    ptrdiff_t ih = band.src_begin + static_cast<ptrdiff_t>(r);
+                    dt_float32* out =
+                            band_src_ptr + (ic * band.src_rows + r) * IW;
+                    if (ih >= 0 && ih < static_cast<ptrdiff_t>(IH)) {
+                        memcpy(out, sptr + (ic * IH + ih) * IW,
+                               IW * sizeof(dt_float32));
+                    } else {
+                        memset(out, 0, IW * sizeof(dt_float32));
+                    }
+                }
+            };
+            MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN_OPR(copy_src, IC);
+
+            conv_bias->exec({band_src_ptr, band_src}, filter, bias_nd,
+                            {nullptr, band_z}, {band_conv_ptr, band_dst},
+                            bundle.get_workspace(2));
+
+            size_t conv_rows = band.conv_end - band.conv_begin;
+            auto pool = [=](size_t oc, size_t) {
+                pool_band(band_conv_ptr + oc * conv_rows * CW, band.conv_begin,
+                          band.conv_end, CW, band.pool_begin, band.pool_end, OW,
+                          param, dptr + oc * OH * OW);
+            };
+            MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN_OPR(pool, OC);
+        }
+    }
+}
+
+// vim: syntax=cpp.doxygen
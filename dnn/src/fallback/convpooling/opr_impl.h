@@ -0,0 +1,74 @@
+/**
+ * \file dnn/src/fallback/convpooling/opr_impl.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#pragma once
+#include "src/common/utils.h"
+#include "src/naive/convpooling/opr_impl.h"
+
+namespace megdnn {
+namespace fallback {
+
+/*!
+ * \brief conv + bias + nonlinearity + pooling without materializing the conv
+ *      output
+ *
+ * The pooled output of each batch is split into bands of rows. For each band
+ * the conv rows it needs are computed by the ConvBias opr of this handle (so
+ * the im2col, winograd and direct algorithms of the arch are used) into a
+ * buffer of at most MAX_BAND_SIZE bytes, which is pooled while still in
+ * cache. Unsupported cases are forwarded to the naive implementation.
+ */
+class ConvPoolingForwardImpl final : public naive::ConvPoolingForwardImpl {
+public:
+    using naive::ConvPoolingForwardImpl::ConvPoolingForwardImpl;
+    void exec(const _megdnn_in TensorND src, const _megdnn_in TensorND filter,
+              const _megdnn_in TensorND bias, _megdnn_out TensorND dst,
+              _megdnn_out Workspace workspace) override;
+    size_t get_workspace_in_bytes(const TensorLayout& src,
+                                  const TensorLayout& filter,
+                                  const TensorLayout& bias,
+                                  const TensorLayout& dst) override;
+
+    //! max size of the conv output of a band
+    static constexpr size_t MAX_BAND_SIZE = 256 * 1024;
+
+private:
+    //! rows of a band in the pooled output, conv output and padded input
+    struct Band {
+        size_t pool_begin, pool_end, conv_begin, conv_end;
+        ptrdiff_t src_begin;
+        size_t src_rows;
+    };
+
+    bool is_banded_supported(const TensorLayout& src,
+                             const TensorLayout& filter,
+                             const TensorLayout& bias);
+    SmallVector<Band> get_bands(const TensorLayout& src,
+                                const TensorLayout& filter,
+                                const TensorLayout& dst);
+    //! ConvBias opr with params matching ConvPooling, without H padding
+    ConvBiasForward* get_conv_bias_opr();
+    //! layouts of src, bias, z and dst of ConvBias on a band
+    void get_band_layouts(const Band& band, const TensorLayout& src,
+                          const TensorLayout& filter, TensorLayout& band_src,
+                          TensorLayout& band_bias, TensorLayout& band_z,
+                          TensorLayout& band_dst);
+    //! workspace of padded src rows, conv output and ConvBias of a band
+    WorkspaceBundle get_bundle(void* ptr, const TensorLayout& src,
+                               const TensorLayout& filter,
+                               const TensorLayout& dst);
+
+    std::unique_ptr<ConvBiasForward> m_conv_bias_opr;
+};
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
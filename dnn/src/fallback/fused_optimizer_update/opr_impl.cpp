@@ -0,0 +1,106 @@
+/**
+ * \file dnn/src/fallback/fused_optimizer_update/opr_impl.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "src/fallback/fused_optimizer_update/opr_impl.h"
+
+#include "src/common/fused_optimizer_update_helper.h"
+#include "src/common/utils.h"
+#include "src/fallback/handle.h"
+
+#include "midout.h"
+MIDOUT_DECL(megdnn_fallback_fused_optimizer_update)
+
+using namespace megdnn;
+using namespace fallback;
+using namespace fused_optimizer_update;
+
+namespace {
+
+//! tensors smaller than this are updated by a single task
+constexpr size_t MIN_BLOCK_SIZE = 16384;
+
+void sgd_block(const KernParam& p, float* __restrict param,
+               const float* __restrict grad, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        sgd(p, param[i], grad[i]);
+    }
+}
+
+void sgd_momentum_block(const KernParam& p, float* __restrict param,
+                        const float* __restrict grad, float* __restrict buf,
+                        size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        sgd_momentum(p, param[i], grad[i], buf[i]);
+    }
+}
+
+void adam_block(const KernParam& p, float* __restrict param,
+                const float* __restrict grad, float* __restrict exp_avg,
+                float* __restrict exp_avg_sq, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        adam(p, param[i], grad[i], exp_avg[i], exp_avg_sq[i]);
+    }
+}
+
+}  // anonymous namespace
+
+FusedOptimizerUpdateImpl::AdamBlockFunc
+FusedOptimizerUpdateImpl::get_adam_block_func() {
+    return adam_block;
+}
+
+void FusedOptimizerUpdateImpl::exec(_megdnn_tensor_inout param,
+                                    _megdnn_tensor_in grad,
+                                    _megdnn_tensor_inout state0,
+                                    _megdnn_tensor_inout state1,
+                                    _megdnn_workspace workspace) {
+    check_exec(param.layout, grad.layout, state0.layout, state1.layout,
+               workspace.size);
+    size_t size = param.layout.total_nr_elems();
+    size_t nr_threads = static_cast<naive::HandleImpl*>(handle())
+                                ->megcore_dispatcher()
+                                ->nr_threads();
+    // blocks are aligned to 64 bytes, so no cache line is written by two
+    // threads
+    size_t block_size =
+            std::max(MIN_BLOCK_SIZE, round_up(div_ceil(size, nr_threads),
+                                              size_t(16)));
+    size_t nr_blocks = div_ceil(size, block_size);
+
+    auto kp = make_kern_param(m_param);
+    float* pptr = param.ptr<dt_float32>();
+    const float* gptr = grad.ptr<dt_float32>();
+    float* s0ptr = static_cast<float*>(state0.raw_ptr);
+    float* s1ptr = static_cast<float*>(state1.raw_ptr);
+
+#define DISPATCH(_midout_iv, _kern, ...)                                    \
+    MIDOUT_BEGIN(megdnn_fallback_fused_optimizer_update,                    \
+                 midout_iv(_midout_iv)) {                                   \
+        auto task = [=](size_t index, size_t) {                             \
+            size_t begin = index * block_size,                              \
+                   len = std::min(block_size, size - begin);                \
+            _kern(kp, pptr + begin, gptr + begin, ##__VA_ARGS__, len);      \
+        };                                                                  \
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN_OPR(task, nr_blocks);         \
+    }                                                                       \
+    MIDOUT_END();
+
+    if (m_param.mode == Mode::ADAM) {
+        auto adam_kern = get_adam_block_func();
+        DISPATCH(0, adam_kern, s0ptr + begin, s1ptr + begin);
+    } else if (m_param.momentum != 0.f) {
+        DISPATCH(1, sgd_momentum_block, s0ptr + begin);
+    } else {
+        DISPATCH(2, sgd_block);
+    }
+#undef DISPATCH
+}
+
+// vim: syntax=cpp.doxygen
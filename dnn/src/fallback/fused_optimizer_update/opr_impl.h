@@ -0,0 +1,47 @@
+/**
+ * \file dnn/src/fallback/fused_optimizer_update/opr_impl.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#pragma once
+
+#include "src/common/fused_optimizer_update_helper.h"
+#include "src/naive/fused_optimizer_update/opr_impl.h"
+
+namespace megdnn {
+namespace fallback {
+
+/*!
+ * \brief FusedOptimizerUpdate split into blocks over the CPU worker threads
+ *
+ * Each mode has its own loop without branches, so the compiler can vectorize
+ * it.
+ */
+class FusedOptimizerUpdateImpl : public naive::FusedOptimizerUpdateImpl {
+public:
+    using naive::FusedOptimizerUpdateImpl::FusedOptimizerUpdateImpl;
+
+    void exec(_megdnn_tensor_inout param, _megdnn_tensor_in grad,
+              _megdnn_tensor_inout state0, _megdnn_tensor_inout state1,
+              _megdnn_workspace workspace) override;
+
+protected:
+    using AdamBlockFunc = void (*)(const fused_optimizer_update::KernParam& p,
+                                   float* param, const float* grad,
+                                   float* exp_avg, float* exp_avg_sq,
+                                   size_t size);
+
+    //! kernel to update a block in ADAM mode, which can not be vectorized
+    //! by the compiler because of sqrtf; archs provide SIMD versions
+    virtual AdamBlockFunc get_adam_block_func();
+};
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
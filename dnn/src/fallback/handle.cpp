@@ -33,9 +33,13 @@
 #include "src/fallback/add_update/opr_impl.h"
 #include "src/fallback/mask_conv/opr_impl.h"
 #include "src/fallback/resize/opr_impl.h"
+#include "src/fallback/image_preprocess/opr_impl.h"
+#include "src/fallback/fused_optimizer_update/opr_impl.h"
 #include "src/fallback/batched_matrix_mul/opr_impl.h"
 #include "src/fallback/conv_bias/opr_impl.h"
+#include "src/fallback/convpooling/opr_impl.h"
 #include "src/fallback/powc/opr_impl.h"
+#include "src/fallback/checksum/opr_impl.h"
 
 namespace megdnn {
 namespace fallback {
@@ -67,9 +71,13 @@ MEGDNN_SPECIALIZE_CREATE_OPERATOR(ElemwiseMultiType)
 MEGDNN_SPECIALIZE_CREATE_OPERATOR(AddUpdate)
 MEGDNN_SPECIALIZE_CREATE_OPERATOR(MaskConvForward)
 MEGDNN_SPECIALIZE_CREATE_OPERATOR(Resize)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(ImagePreprocess)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(FusedOptimizerUpdate)
 MEGDNN_SPECIALIZE_CREATE_OPERATOR(BatchedMatrixMul)
 MEGDNN_SPECIALIZE_CREATE_OPERATOR(ConvBias)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(ConvPoolingForward)
 MEGDNN_SPECIALIZE_CREATE_OPERATOR(PowC)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(ChecksumForward)
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpragmas"
@@ -0,0 +1,298 @@
+/**
+ * \file dnn/src/fallback/image_preprocess/opr_impl.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "src/fallback/image_preprocess/opr_impl.h"
+
+#include "src/common/image_preprocess_helper.h"
+#include "src/common/utils.h"
+#include "src/naive/handle.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "midout.h"
+MIDOUT_DECL(megdnn_fallback_image_preprocess)
+
+using namespace megdnn;
+using namespace fallback;
+using namespace image_preprocess;
+
+namespace {
+
+//! minimal number of output rows handled by one task
+constexpr size_t MIN_ROWS_PER_BAND = 16;
+
+WorkspaceBundle get_thread_bundle(const SrcFormat& fmt, size_t OW) {
+    size_t row_size = fmt.iw * fmt.ic;
+    return {nullptr,
+            {
+                    // tabw0: offset of left src pixel in a converted row
+                    sizeof(int) * OW,
+                    // tabw1: offset of right src pixel in a converted row
+                    sizeof(int) * OW,
+                    // tabaw
+                    sizeof(float) * OW,
+                    // row caches
+                    row_size,
+                    row_size,
+            }};
+}
+
+//! color convert row \p ih of image \p src into \p dst of {IW, C}
+void convert_row(const uint8_t* src, const SrcFormat& fmt, int ih,
+                 uint8_t* dst) {
+    int IW = fmt.iw;
+    if (!fmt.is_yuv) {
+        // only SWAP_RB needs conversion for non-yuv src
+        const uint8_t* sptr = src + ih * IW * 3;
+        for (int iw = 0; iw < IW; ++iw, sptr += 3, dst += 3) {
+            dst[0] = sptr[2];
+            dst[1] = sptr[1];
+            dst[2] = sptr[0];
+        }
+        return;
+    }
+    const uint8_t* yptr = src + ih * IW;
+    const uint8_t* chroma = src + fmt.ih * IW;
+    const uint8_t *uptr, *vptr;
+    int cstep;
+    if (fmt.is_planar) {
+        int plane = fmt.ih * IW / 4;
+        const uint8_t* row = chroma + (ih / 2) * (IW / 2);
+        uptr = row + (fmt.is_uv ? 0 : plane);
+        vptr = row + (fmt.is_uv ? plane : 0);
+        cstep = 1;
+    } else {
+        const uint8_t* row = chroma + (ih / 2) * IW;
+        uptr = row + (fmt.is_uv ? 0 : 1);
+        vptr = row + (fmt.is_uv ? 1 : 0);
+        cstep = 2;
+    }
+    int r_idx = fmt.swap_rb ? 2 : 0, b_idx = 2 - r_idx;
+    for (int iw = 0; iw < IW; iw += 2, uptr += cstep, vptr += cstep) {
+        int ruv, guv, buv;
+        get_yuv_chroma(*uptr, *vptr, ruv, guv, buv);
+        for (int k = 0; k < 2; ++k, dst += 3) {
+            int Y = yptr[iw + k];
+            dst[r_idx] = saturate_u8(Y + ruv);
+            dst[1] = saturate_u8(Y + guv);
+            dst[b_idx] = saturate_u8(Y + buv);
+        }
+    }
+}
+
+/*!
+ * \brief cache of the two most recently converted src rows
+ *
+ * Consecutive output rows mostly read the same src rows, so each src row is
+ * converted once per band rather than once per output pixel.
+ */
+class RowCache {
+    const uint8_t* m_src;
+    const SrcFormat& m_fmt;
+    bool m_need_convert;
+    uint8_t* m_buf[2];
+    int m_tag[2] = {-1, -1};
+
+public:
+    RowCache(const uint8_t* src, const SrcFormat& fmt, uint8_t* buf0,
+             uint8_t* buf1)
+            : m_src{src},
+              m_fmt{fmt},
+              m_need_convert{fmt.is_yuv || fmt.swap_rb},
+              m_buf{buf0, buf1} {}
+
+    //! get converted row \p ih without evicting row \p keep
+    const uint8_t* get(int ih, int keep) {
+        if (!m_need_convert) {
+            return m_src + ih * m_fmt.iw * m_fmt.ic;
+        }
+        for (int i = 0; i < 2; ++i) {
+            if (m_tag[i] == ih) {
+                return m_buf[i];
+            }
+        }
+        int slot = m_tag[0] == keep ? 1 : 0;
+        convert_row(m_src, m_fmt, ih, m_buf[slot]);
+        m_tag[slot] = ih;
+        return m_buf[slot];
+    }
+};
+
+struct KernParam {
+    SrcFormat fmt;
+    bool linear, nchw88;
+    int OH, OW;
+    float scale[MAX_NR_CHANNELS], bias[MAX_NR_CHANNELS];
+};
+
+/*!
+ * \brief compute output rows [oh_begin, oh_end) of one image
+ * \param dst start of the output image
+ */
+template <typename T, typename Quantizer>
+void forward_rows(const uint8_t* src, T* dst, const KernParam& p, int oh_begin,
+                  int oh_end, const WorkspaceBundle& bundle,
+                  const Quantizer& quantizer) {
+    const SrcFormat& fmt = p.fmt;
+    int C = fmt.ic, OH = p.OH, OW = p.OW;
+    int* tabw0 = static_cast<int*>(bundle.get(0));
+    int* tabw1 = static_cast<int*>(bundle.get(1));
+    float* tabaw = static_cast<float*>(bundle.get(2));
+    for (int ow = 0; ow < OW; ++ow) {
+        if (p.linear) {
+            int iw0, iw1;
+            get_linear_coord(static_cast<float>(OW) / fmt.iw, fmt.iw, ow, iw0,
+                             iw1, tabaw[ow]);
+            tabw0[ow] = iw0 * C;
+            tabw1[ow] = iw1 * C;
+        } else {
+            tabw0[ow] = get_nearest_coord(OW, fmt.iw, ow) * C;
+        }
+    }
+    RowCache cache{src, fmt, static_cast<uint8_t*>(bundle.get(3)),
+                   static_cast<uint8_t*>(bundle.get(4))};
+    // the i-th value of channel c is at plane[c][i * step]
+    T* plane[8];
+    int step = p.nchw88 ? 8 : 1;
+    T zero = quantizer(0.f);
+    for (int oh = oh_begin; oh < oh_end; ++oh) {
+        if (p.nchw88) {
+            T* row = dst + oh * OW * 8;
+            for (int c = 0; c < 8; ++c) {
+                plane[c] = row + c;
+            }
+            for (int c = C; c < 8; ++c) {
+                for (int ow = 0; ow < OW; ++ow) {
+                    plane[c][ow * 8] = zero;
+                }
+            }
+        } else {
+            for (int c = 0; c < C; ++c) {
+                plane[c] = dst + (c * OH + oh) * OW;
+            }
+        }
+        if (p.linear) {
+            int ih0, ih1;
+            float ah;
+            get_linear_coord(static_cast<float>(OH) / fmt.ih, fmt.ih, oh, ih0,
+                             ih1, ah);
+            const uint8_t* r0 = cache.get(ih0, ih1);
+            const uint8_t* r1 = cache.get(ih1, ih0);
+            for (int ow = 0; ow < OW; ++ow) {
+                int o0 = tabw0[ow], o1 = tabw1[ow];
+                float aw = tabaw[ow];
+                for (int c = 0; c < C; ++c) {
+                    float v = blend_linear(r0[o0 + c], r0[o1 + c], r1[o0 + c],
+                                           r1[o1 + c], ah, aw);
+                    plane[c][ow * step] = quantizer(v * p.scale[c] + p.bias[c]);
+                }
+            }
+        } else {
+            const uint8_t* r0 =
+                    cache.get(get_nearest_coord(OH, fmt.ih, oh), -1);
+            for (int ow = 0; ow < OW; ++ow) {
+                int o0 = tabw0[ow];
+                for (int c = 0; c < C; ++c) {
+                    plane[c][ow * step] =
+                            quantizer(r0[o0 + c] * p.scale[c] + p.bias[c]);
+                }
+            }
+        }
+    }
+}
+
+}  // anonymous namespace
+
+size_t ImagePreprocessImpl::nr_threads() const {
+    return static_cast<naive::HandleImpl*>(handle())
+            ->megcore_dispatcher()
+            ->nr_threads();
+}
+
+size_t ImagePreprocessImpl::get_workspace_in_bytes(const TensorLayout& src,
+                                                   const TensorLayout&,
+                                                   const TensorLayout&,
+                                                   const TensorLayout& dst) {
+    auto fmt = get_src_format(param(), src);
+    return nr_threads() *
+           get_thread_bundle(fmt, dst.shape[3]).total_size_in_bytes();
+}
+
+void ImagePreprocessImpl::exec(_megdnn_tensor_in src, _megdnn_tensor_in scale,
+                               _megdnn_tensor_in bias, _megdnn_tensor_out dst,
+                               _megdnn_workspace workspace) {
+    check_exec(src.layout, scale.layout, bias.layout, dst.layout,
+               workspace.size);
+    KernParam p;
+    p.fmt = get_src_format(param(), src.layout);
+    p.linear = param().imode == InterpolationMode::LINEAR;
+    p.nchw88 = param().format == Param::Format::NCHW88;
+    p.OH = dst.layout[2];
+    p.OW = dst.layout[3];
+    size_t N = src.layout[0], OH = p.OH;
+    size_t src_image_size = src.layout.stride[0],
+           dst_image_size = dst.layout.stride[0];
+
+    // split rows of each image into bands when there are fewer images than
+    // threads
+    size_t threads = nr_threads(), nr_bands = 1;
+    if (N < threads) {
+        nr_bands = std::min(div_ceil(threads, N),
+                            div_ceil(OH, MIN_ROWS_PER_BAND));
+    }
+    size_t band_size = div_ceil(OH, nr_bands);
+    auto thread_bundle = get_thread_bundle(p.fmt, p.OW);
+    size_t thread_ws_size = thread_bundle.total_size_in_bytes();
+    dt_byte* ws_ptr = workspace.raw_ptr;
+    const uint8_t* sptr = src.ptr<dt_uint8>();
+    const float* scale_ptr = scale.ptr<dt_float32>();
+    const float* bias_ptr = bias.ptr<dt_float32>();
+
+#define DISPATCH(_T, _quantizer)                                              \
+    do {                                                                      \
+        auto dptr = dst.compatible_ptr<_T>();                                 \
+        auto quantizer = _quantizer;                                          \
+        auto task = [=](size_t index, size_t thread_id) {                     \
+            size_t n = index / nr_bands, band = index % nr_bands;             \
+            size_t oh_begin = band * band_size,                               \
+                   oh_end = std::min(oh_begin + band_size, OH);               \
+            if (oh_begin >= oh_end) {                                         \
+                return;                                                       \
+            }                                                                 \
+            KernParam kern_param = p;                                         \
+            memcpy(kern_param.scale, scale_ptr, sizeof(float) * p.fmt.ic);    \
+            memcpy(kern_param.bias, bias_ptr, sizeof(float) * p.fmt.ic);      \
+            WorkspaceBundle bundle = thread_bundle;                           \
+            bundle.set(ws_ptr + thread_id * thread_ws_size);                  \
+            forward_rows(sptr + n * src_image_size,                           \
+                         dptr + n * dst_image_size, kern_param, oh_begin,     \
+                         oh_end, bundle, quantizer);                          \
+        };                                                                    \
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN_OPR(task, N* nr_bands);         \
+    } while (0)
+
+    if (dst.layout.dtype == dtype::Float32()) {
+        MIDOUT_BEGIN(megdnn_fallback_image_preprocess, midout_iv(0)) {
+            DISPATCH(dt_float32, [](float x) { return x; });
+        }
+        MIDOUT_END();
+    } else {
+        MIDOUT_BEGIN(megdnn_fallback_image_preprocess, midout_iv(1)) {
+            auto dst_param = dst.layout.dtype.param<dtype::QuantizedS8>();
+            DISPATCH(dt_qint8,
+                     [dst_param](float x) { return dst_param.quantize(x); });
+        }
+        MIDOUT_END();
+    }
+#undef DISPATCH
+}
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,46 @@
+/**
+ * \file dnn/src/fallback/image_preprocess/opr_impl.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#pragma once
+
+#include "src/naive/image_preprocess/opr_impl.h"
+
+namespace megdnn {
+namespace fallback {
+
+/*!
+ * \brief ImagePreprocess computed row by row
+ *
+ * Each task handles a band of output rows of one image. Src rows are color
+ * converted once into a per-thread row cache and reused by all the output
+ * rows that read them, and the horizontal interpolation coefficients are
+ * precomputed for the whole output row.
+ */
+class ImagePreprocessImpl : public naive::ImagePreprocessImpl {
+public:
+    using naive::ImagePreprocessImpl::ImagePreprocessImpl;
+
+    void exec(_megdnn_tensor_in src, _megdnn_tensor_in scale,
+              _megdnn_tensor_in bias, _megdnn_tensor_out dst,
+              _megdnn_workspace workspace) override;
+
+    size_t get_workspace_in_bytes(const TensorLayout& src,
+                                  const TensorLayout& scale,
+                                  const TensorLayout& bias,
+                                  const TensorLayout& dst) override;
+
+private:
+    size_t nr_threads() const;
+};
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -17,7 +17,7 @@
 namespace megdnn {
 namespace naive {
     
-class ConvPoolingForwardImpl final: public ConvPoolingForward {
+class ConvPoolingForwardImpl: public ConvPoolingForward {
     public:
         ConvPoolingForwardImpl(Handle *handle);
         void exec( const _megdnn_in TensorND src,
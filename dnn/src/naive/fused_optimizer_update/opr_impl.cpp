@@ -0,0 +1,57 @@
+/**
+ * \file dnn/src/naive/fused_optimizer_update/opr_impl.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "src/naive/fused_optimizer_update/opr_impl.h"
+
+#include "src/common/fused_optimizer_update_helper.h"
+#include "src/common/utils.h"
+#include "src/naive/handle.h"
+
+using namespace megdnn;
+using namespace naive;
+using namespace fused_optimizer_update;
+
+namespace {
+
+void forward(float* param, const float* grad, float* state0, float* state1,
+             size_t size, const param::FusedOptimizerUpdate& opr_param) {
+    using Mode = param::FusedOptimizerUpdate::Mode;
+    auto p = make_kern_param(opr_param);
+    for (size_t i = 0; i < size; ++i) {
+        if (opr_param.mode == Mode::ADAM) {
+            adam(p, param[i], grad[i], state0[i], state1[i]);
+        } else if (opr_param.momentum != 0.f) {
+            sgd_momentum(p, param[i], grad[i], state0[i]);
+        } else {
+            sgd(p, param[i], grad[i]);
+        }
+    }
+}
+
+}  // anonymous namespace
+
+void FusedOptimizerUpdateImpl::exec(_megdnn_tensor_inout param,
+                                    _megdnn_tensor_in grad,
+                                    _megdnn_tensor_inout state0,
+                                    _megdnn_tensor_inout state1,
+                                    _megdnn_workspace workspace) {
+    check_exec(param.layout, grad.layout, state0.layout, state1.layout,
+               workspace.size);
+    auto pptr = param.ptr<dt_float32>();
+    auto gptr = grad.ptr<dt_float32>();
+    auto s0ptr = static_cast<float*>(state0.raw_ptr),
+         s1ptr = static_cast<float*>(state1.raw_ptr);
+    auto size = param.layout.total_nr_elems();
+    auto opr_param = m_param;
+    MEGDNN_DISPATCH_CPU_KERN_OPR(
+            forward(pptr, gptr, s0ptr, s1ptr, size, opr_param));
+}
+
+// vim: syntax=cpp.doxygen
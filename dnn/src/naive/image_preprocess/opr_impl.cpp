@@ -0,0 +1,81 @@
+/**
+ * \file dnn/src/naive/image_preprocess/opr_impl.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "src/naive/image_preprocess/opr_impl.h"
+
+#include "src/common/image_preprocess_helper.h"
+#include "src/common/utils.h"
+#include "src/naive/handle.h"
+
+using namespace megdnn;
+using namespace naive;
+using namespace image_preprocess;
+
+namespace {
+
+template <typename T, typename Quantizer>
+void forward(_megdnn_tensor_in src, _megdnn_tensor_in scale,
+             _megdnn_tensor_in bias, _megdnn_tensor_out dst,
+             const param::ImagePreprocess& param, const Quantizer& quantizer) {
+    auto fmt = get_src_format(param, src.layout);
+    bool linear =
+            param.imode == param::ImagePreprocess::InterpolationMode::LINEAR;
+    bool nchw88 = param.format == param::ImagePreprocess::Format::NCHW88;
+    int N = src.layout[0], C = fmt.ic, OH = dst.layout[2],
+        OW = dst.layout[3];
+    int dst_channels = nchw88 ? dst.layout[1] * 8 : C;
+    size_t src_image_size = src.layout.stride[0];
+    auto sptr = src.ptr<dt_uint8>();
+    auto scale_ptr = scale.ptr<dt_float32>(), bias_ptr = bias.ptr<dt_float32>();
+    auto dptr = dst.compatible_ptr<T>();
+    float val[MAX_NR_CHANNELS];
+    rep(n, N) rep(oh, OH) rep(ow, OW) {
+        get_dst_pixel(sptr + n * src_image_size, fmt, linear, OH, OW, oh, ow,
+                      val);
+        rep(c, dst_channels) {
+            size_t offset;
+            if (nchw88) {
+                offset = ((((n * dst_channels / 8 + c / 8) * OH + oh) * OW +
+                           ow) *
+                          8) +
+                         c % 8;
+            } else {
+                offset = ((n * C + c) * OH + oh) * OW + ow;
+            }
+            dptr[offset] =
+                    c < C ? quantizer(val[c] * scale_ptr[c] + bias_ptr[c])
+                          : quantizer(0.f);
+        }
+    }
+}
+
+}  // anonymous namespace
+
+void ImagePreprocessImpl::exec(_megdnn_tensor_in src, _megdnn_tensor_in scale,
+                               _megdnn_tensor_in bias, _megdnn_tensor_out dst,
+                               _megdnn_workspace workspace) {
+    check_exec(src.layout, scale.layout, bias.layout, dst.layout,
+               workspace.size);
+    auto param = this->param();
+    if (dst.layout.dtype == dtype::Float32()) {
+        auto quantizer = [](float x) { return x; };
+        MEGDNN_DISPATCH_CPU_KERN_OPR(forward<dt_float32>(src, scale, bias, dst,
+                                                         param, quantizer));
+    } else {
+        auto dst_param = dst.layout.dtype.param<dtype::QuantizedS8>();
+        auto quantizer = [dst_param](float x) {
+            return dst_param.quantize(x);
+        };
+        MEGDNN_DISPATCH_CPU_KERN_OPR(forward<dt_qint8>(src, scale, bias, dst,
+                                                       param, quantizer));
+    }
+}
+
+// vim: syntax=cpp.doxygen
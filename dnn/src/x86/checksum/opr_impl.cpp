@@ -0,0 +1,74 @@
+/**
+ * \file dnn/src/x86/checksum/opr_impl.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "src/x86/checksum/opr_impl.h"
+
+#include "src/common/utils.h"
+#include "src/x86/utils.h"
+
+#include <immintrin.h>
+#ifdef WIN32CMAKE
+#include <avx2intrin.h>
+#endif
+
+namespace {
+
+using namespace megdnn;
+using namespace x86;
+
+MEGDNN_ATTRIBUTE_TARGET("avx2")
+uint32_t checksum_block_avx2(const uint32_t* ptr, size_t size, uint32_t base) {
+    // two accumulators to hide the latency of mullo
+    __m256i idx0 = _mm256_add_epi32(_mm256_set1_epi32(base + 1),
+                                    _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)),
+            idx1 = _mm256_add_epi32(idx0, _mm256_set1_epi32(8)),
+            step = _mm256_set1_epi32(16), sum0 = _mm256_setzero_si256(),
+            sum1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m256i x0 = _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(ptr + i)),
+                x1 = _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(ptr + i + 8));
+        sum0 = _mm256_add_epi32(sum0, _mm256_mullo_epi32(x0, idx0));
+        sum1 = _mm256_add_epi32(sum1, _mm256_mullo_epi32(x1, idx1));
+        idx0 = _mm256_add_epi32(idx0, step);
+        idx1 = _mm256_add_epi32(idx1, step);
+    }
+    sum0 = _mm256_add_epi32(sum0, sum1);
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum0),
+                              _mm256_extracti128_si256(sum0, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    uint32_t ret = _mm_cvtsi128_si32(s);
+    for (; i < size; ++i) {
+        ret += ptr[i] * (base + 1 + static_cast<uint32_t>(i));
+    }
+    return ret;
+}
+
+}  // anonymous namespace
+
+namespace megdnn {
+namespace x86 {
+
+ChecksumForward::Result ChecksumForwardImpl::exec(
+        _megdnn_tensor_in data, _megdnn_workspace workspace) {
+    if (is_supported(SIMDType::AVX2)) {
+        return exec_with_kern(data, workspace, checksum_block_avx2);
+    }
+    return fallback::ChecksumForwardImpl::exec(data, workspace);
+}
+
+}  // namespace x86
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
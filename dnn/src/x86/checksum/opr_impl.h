@@ -0,0 +1,27 @@
+/**
+ * \file dnn/src/x86/checksum/opr_impl.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#pragma once
+#include "src/fallback/checksum/opr_impl.h"
+
+namespace megdnn {
+namespace x86 {
+
+class ChecksumForwardImpl : public fallback::ChecksumForwardImpl {
+public:
+    using fallback::ChecksumForwardImpl::ChecksumForwardImpl;
+
+    Result exec(_megdnn_tensor_in data, _megdnn_workspace workspace) override;
+};
+
+}  // namespace x86
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -69,6 +69,7 @@
 
 #include <cstring>
 
+#include <immintrin.h>
 #include <pmmintrin.h>
 #include <smmintrin.h>
 #include <tmmintrin.h>
@@ -82,6 +83,92 @@ GENERATE_UNSUPPORT_CVT_OPR_FOR_FLOAT(GENERATE_UNSUPPORT_CVT_OPR)
 
 using namespace megcv;
 namespace {
+//! dst rows of each task when an image is split into row bands
+constexpr size_t MIN_ROWS_PER_BAND = 16;
+
+//! convert columns [c, width) of two rows sharing one chroma row
+template <bool rgb, bool is_planar, bool is_uv>
+void cvt_yuv_transform_tail(const unsigned char* pY, int src_step,
+                            const unsigned char* pU, const unsigned char* pV,
+                            int c, int width, unsigned char* dst0,
+                            size_t index0, unsigned char* dst1,
+                            size_t index1) {
+#define SET_COLOR(out, index) \
+    if (rgb) {                \
+        out[index++] = R;     \
+        out[index++] = G;     \
+        out[index++] = B;     \
+    } else {                  \
+        out[index++] = B;     \
+        out[index++] = G;     \
+        out[index++] = R;     \
+    }
+    for (; c < width; c += 2) {
+        int Y00, Y01, Y10, Y11, U, V;
+        int R, G, B;
+        Y00 = *((pY) + c);
+        Y01 = *((pY) + c + 1);
+        Y10 = *((pY) + src_step + c);
+        Y11 = *((pY) + src_step + c + 1);
+        if (is_planar) {
+            V = *(pV + c / 2);
+            U = *(pU + c / 2);
+        } else {
+            if (is_uv) {
+                U = *(pU + c);
+                V = *(pU + c + 1);
+            } else {
+                V = *(pV + c);
+                U = *(pV + c + 1);
+            }
+        }
+        int ruv, guv, buv;
+        ruv = ((359 * (V - 128)) >> 8);
+        guv = -1 * ((88 * (U - 128) + 183 * (V - 128)) >> 8);
+        buv = ((454 * (U - 128)) >> 8);
+
+        R = Y00 + ruv;
+        G = Y00 + guv;
+        B = Y00 + buv;
+        R = (R > 255) ? 255 : ((R < 0) ? 0 : R);
+        G = (G > 255) ? 255 : ((G < 0) ? 0 : G);
+        B = (B > 255) ? 255 : ((B < 0) ? 0 : B);
+
+        SET_COLOR(dst0, index0);
+
+        R = Y01 + ruv;
+        G = Y01 + guv;
+        B = Y01 + buv;
+        R = (R > 255) ? 255 : ((R < 0) ? 0 : R);
+        G = (G > 255) ? 255 : ((G < 0) ? 0 : G);
+        B = (B > 255) ? 255 : ((B < 0) ? 0 : B);
+
+        SET_COLOR(dst0, index0);
+
+        ruv = ((359 * (V - 128)) >> 8);
+        guv = -1 * ((88 * (U - 128) + 183 * (V - 128)) >> 8);
+        buv = ((454 * (U - 128)) >> 8);
+        R = Y10 + ruv;
+        G = Y10 + guv;
+        B = Y10 + buv;
+        R = (R > 255) ? 255 : ((R < 0) ? 0 : R);
+        G = (G > 255) ? 255 : ((G < 0) ? 0 : G);
+        B = (B > 255) ? 255 : ((B < 0) ? 0 : B);
+
+        SET_COLOR(dst1, index1);
+
+        R = Y11 + ruv;
+        G = Y11 + guv;
+        B = Y11 + buv;
+        R = (R > 255) ? 255 : ((R < 0) ? 0 : R);
+        G = (G > 255) ? 255 : ((G < 0) ? 0 : G);
+        B = (B > 255) ? 255 : ((B < 0) ? 0 : B);
+
+        SET_COLOR(dst1, index1);
+    }
+#undef SET_COLOR
+}
+
 /**
  * \brief yuv to rgb or bgr.
  *
@@ -92,7 +179,8 @@ namespace {
  */
 template <bool rgb = true, bool is_planar = true, bool is_uv = true>
 MEGDNN_ATTRIBUTE_TARGET("sse4.2")
-void cvt_yuv_transform(const Mat8u& src, Mat8u& dst) {
+void cvt_yuv_transform(const Mat8u& src, Mat8u& dst, size_t row_begin,
+                       size_t row_end) {
     __m128i out0, out1, out2;
     __m128i Y0, Y1, VU, V0, V1, V3, U0, U1, U3;
     __m128i Y00, Y01, Y02, Y03;
@@ -145,7 +233,7 @@ void cvt_yuv_transform(const Mat8u& src, Mat8u& dst) {
     size_t height = dst.rows();
     size_t width = dst.cols();
     int src_step = src.step();
-    const unsigned char* pY = src.ptr();
+    const unsigned char* pY = src.ptr(row_begin);
     const unsigned char* pU;
     const unsigned char* pV;
     if (is_uv) {
@@ -157,19 +245,13 @@ void cvt_yuv_transform(const Mat8u& src, Mat8u& dst) {
         //! only used if is_planar is false
         pU = src.ptr(height + height / 4);
     }
+    //! every two rows share one row of chroma samples
+    size_t chroma_offset =
+            row_begin / 2 * (is_planar ? src_step / 2 : src_step);
+    pU += chroma_offset;
+    pV += chroma_offset;
 
-#define SET_COLOR(out, index) \
-    if (rgb) {                \
-        out[index++] = R;     \
-        out[index++] = G;     \
-        out[index++] = B;     \
-    } else {                  \
-        out[index++] = B;     \
-        out[index++] = G;     \
-        out[index++] = R;     \
-    }
-
-    for (size_t r = 0; r < height; r += 2, pY += (src_step << 1)) {
+    for (size_t r = row_begin; r < row_end; r += 2, pY += (src_step << 1)) {
         unsigned char* dst0 = dst.ptr(r);
         unsigned char* dst1 = dst.ptr(r + 1);
         size_t index0 = 0;
@@ -394,69 +476,9 @@ void cvt_yuv_transform(const Mat8u& src, Mat8u& dst) {
             index1 += 16;
         }
 
-        for (; c < (int)width; c += 2) {
-            int Y00, Y01, Y10, Y11, U, V;
-            int R, G, B;
-            Y00 = *((pY) + c);
-            Y01 = *((pY) + c + 1);
-            Y10 = *((pY) + src_step + c);
-            Y11 = *((pY) + src_step + c + 1);
-            if (is_planar) {
-                V = *(pV + c / 2);
-                U = *(pU + c / 2);
-            } else {
-                if (is_uv) {
-                    U = *(pU + c);
-                    V = *(pU + c + 1);
-                } else {
-                    V = *(pV + c);
-                    U = *(pV + c + 1);
-                }
-            }
-            int ruv, guv, buv;
-            ruv = ((359 * (V - 128)) >> 8);
-            guv = -1 * ((88 * (U - 128) + 183 * (V - 128)) >> 8);
-            buv = ((454 * (U - 128)) >> 8);
-
-            R = Y00 + ruv;
-            G = Y00 + guv;
-            B = Y00 + buv;
-            R = (R > 255) ? 255 : ((R < 0) ? 0 : R);
-            G = (G > 255) ? 255 : ((G < 0) ? 0 : G);
-            B = (B > 255) ? 255 : ((B < 0) ? 0 : B);
-
-            SET_COLOR(dst0, index0);
-
-            R = Y01 + ruv;
-            G = Y01 + guv;
-            B = Y01 + buv;
-            R = (R > 255) ? 255 : ((R < 0) ? 0 : R);
-            G = (G > 255) ? 255 : ((G < 0) ? 0 : G);
-            B = (B > 255) ? 255 : ((B < 0) ? 0 : B);
-
-            SET_COLOR(dst0, index0);
-
-            ruv = ((359 * (V - 128)) >> 8);
-            guv = -1 * ((88 * (U - 128) + 183 * (V - 128)) >> 8);
-            buv = ((454 * (U - 128)) >> 8);
-            R = Y10 + ruv;
-            G = Y10 + guv;
-            B = Y10 + buv;
-            R = (R > 255) ? 255 : ((R < 0) ? 0 : R);
-            G = (G > 255) ? 255 : ((G < 0) ? 0 : G);
-            B = (B > 255) ? 255 : ((B < 0) ? 0 : B);
-
-            SET_COLOR(dst1, index1);
-
-            R = Y11 + ruv;
-            G = Y11 + guv;
-            B = Y11 + buv;
-            R = (R > 255) ? 255 : ((R < 0) ? 0 : R);
-            G = (G > 255) ? 255 : ((G < 0) ? 0 : G);
-            B = (B > 255) ? 255 : ((B < 0) ? 0 : B);
-
-            SET_COLOR(dst1, index1);
-        }
+        cvt_yuv_transform_tail<rgb, is_planar, is_uv>(pY, src_step, pU, pV, c,
+                                                      width, dst0, index0,
+                                                      dst1, index1);
         if (is_planar) {
             pV += src_step / 2;
             pU += src_step / 2;
@@ -468,7 +490,6 @@ void cvt_yuv_transform(const Mat8u& src, Mat8u& dst) {
             }
         }
     }
-#undef SET_COLOR
 }
 
 /**
@@ -489,13 +510,14 @@ void cvt_yuv_transform(const Mat8u& src, Mat8u& dst) {
  */
 template <bool rgb = true, bool is_planar = true, bool is_uv = true>
 MEGDNN_ATTRIBUTE_TARGET("sse4.2")
-void cvt_BT601_yuv_transform(const Mat8u& src, Mat8u& dst) {
+void cvt_BT601_yuv_transform(const Mat8u& src, Mat8u& dst, size_t row_begin,
+                             size_t row_end) {
     typedef unsigned char uint8;
 
     size_t height = dst.rows();
     size_t width = dst.cols();
     size_t src_step = src.step();
-    const uint8* pY = src.ptr();
+    const uint8* pY = src.ptr(row_begin);
     const uint8* pU;
     const uint8* pV;
 
@@ -506,6 +528,11 @@ void cvt_BT601_yuv_transform(const Mat8u& src, Mat8u& dst) {
         pV = src.ptr(height);
         pU = src.ptr(height + height / 4);
     }
+    //! every two rows share one row of chroma samples
+    size_t chroma_offset =
+            row_begin / 2 * (is_planar ? src_step / 2 : src_step);
+    pU += chroma_offset;
+    pV += chroma_offset;
 
 #define YG 18997  /* round(1.164 * 64 * 256 * 256 / 257) */
 #define YGB -1160 /* 1.164 * 64 * -16 + 64 / 2 */
@@ -580,7 +607,7 @@ void cvt_BT601_yuv_transform(const Mat8u& src, Mat8u& dst) {
     __m128i RV2, GUV2, BU2;
     __m128i RV3, GUV3, BU3;
 
-    for (size_t r = 0; r < height; r += 2, pY += (src_step << 1)) {
+    for (size_t r = row_begin; r < row_end; r += 2, pY += (src_step << 1)) {
         unsigned char* dst0 = dst.ptr(r);
         unsigned char* dst1 = dst.ptr(r + 1);
         size_t index0 = 0;
@@ -907,6 +934,249 @@ void cvt_BT601_yuv_transform(const Mat8u& src, Mat8u& dst) {
 #undef YG
 }
 
+//! interleave three planes of 16 pixels into 48 bytes of packed pixels
+MEGDNN_ATTRIBUTE_TARGET("avx2")
+void store_interleave_u8x3(unsigned char* dst, __m128i c0, __m128i c1,
+                           __m128i c2) {
+    __m128i _shuff_1 =
+            _mm_set_epi8(10, 0, 9, 8, 0, 7, 6, 0, 5, 4, 0, 3, 2, 0, 1, 0);
+    __m128i _shuff_2 =
+            _mm_set_epi8(0, 4, 0, 0, 3, 0, 0, 2, 0, 0, 1, 0, 0, 0, 0, 0);
+    __m128i _shuff_3 =
+            _mm_set_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 15, 14, 0, 13, 12, 0, 11);
+    __m128i _shuff_4 =
+            _mm_set_epi8(5, 4, 0, 3, 2, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i _shuff_5 =
+            _mm_set_epi8(0, 0, 9, 0, 0, 8, 0, 0, 7, 0, 0, 6, 0, 0, 5, 0);
+    __m128i _shuff_6 =
+            _mm_set_epi8(0, 15, 14, 0, 13, 12, 0, 11, 10, 0, 9, 8, 0, 7, 6, 0);
+    __m128i _shuff_7 =
+            _mm_set_epi8(15, 0, 0, 14, 0, 0, 13, 0, 0, 12, 0, 0, 11, 0, 0, 10);
+    __m128i _blend_12 = _mm_set_epi8(0, -128, 0, 0, -128, 0, 0, -128, 0, 0,
+                                     -128, 0, 0, -128, 0, 0);
+    __m128i _blend_34 = _mm_set_epi8(-128, -128, -128, -128, -128, -128, -128,
+                                     -128, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i _blend_345 = _mm_set_epi8(0, 0, -128, 0, 0, -128, 0, 0, -128, 0, 0,
+                                      -128, 0, 0, -128, 0);
+    __m128i _blend_67 = _mm_set_epi8(-128, 0, 0, -128, 0, 0, -128, 0, 0, -128,
+                                     0, 0, -128, 0, 0, -128);
+
+    __m128i c01_0 = _mm_unpacklo_epi8(c0, c1);
+    __m128i c01_1 = _mm_unpackhi_epi8(c0, c1);
+    __m128i out0 = _mm_blendv_epi8(_mm_shuffle_epi8(c01_0, _shuff_1),
+                                   _mm_shuffle_epi8(c2, _shuff_2), _blend_12);
+    __m128i out1 = _mm_blendv_epi8(_mm_shuffle_epi8(c01_0, _shuff_3),
+                                   _mm_shuffle_epi8(c01_1, _shuff_4),
+                                   _blend_34);
+    out1 = _mm_blendv_epi8(out1, _mm_shuffle_epi8(c2, _shuff_5), _blend_345);
+    __m128i out2 = _mm_blendv_epi8(_mm_shuffle_epi8(c01_1, _shuff_6),
+                                   _mm_shuffle_epi8(c2, _shuff_7), _blend_67);
+    _mm_storeu_si128((__m128i*)(dst), out0);
+    _mm_storeu_si128((__m128i*)(dst + 16), out1);
+    _mm_storeu_si128((__m128i*)(dst + 32), out2);
+}
+
+//! saturate two vectors of 8 int32 into 16 uint8 keeping the order
+MEGDNN_ATTRIBUTE_TARGET("avx2")
+__m128i pack_u8x16(__m256i lo, __m256i hi) {
+    __m256i x = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+    return _mm_packus_epi16(_mm256_castsi256_si128(x),
+                            _mm256_extracti128_si256(x, 1));
+}
+
+/**
+ * \brief AVX2 version of cvt_yuv_transform, bit-exact with it
+ *
+ * The chroma terms of 8 chroma samples (16 pixels of two rows) are computed in
+ * one 256-bit register and duplicated to the pixels sharing them.
+ */
+template <bool rgb, bool is_planar, bool is_uv>
+MEGDNN_ATTRIBUTE_TARGET("avx2")
+void cvt_yuv_transform_avx2(const Mat8u& src, Mat8u& dst, size_t row_begin,
+                            size_t row_end) {
+    size_t height = dst.rows();
+    int width = dst.cols();
+    int src_step = src.step();
+    const unsigned char* pY = src.ptr(row_begin);
+    const unsigned char* pU;
+    const unsigned char* pV;
+    if (is_uv) {
+        pU = src.ptr(height);
+        pV = src.ptr(height + height / 4);
+    } else {
+        pV = src.ptr(height);
+        pU = src.ptr(height + height / 4);
+    }
+    size_t chroma_offset =
+            row_begin / 2 * (is_planar ? src_step / 2 : src_step);
+    pU += chroma_offset;
+    pV += chroma_offset;
+
+    __m256i v128 = _mm256_set1_epi32(128);
+    __m256i v359 = _mm256_set1_epi32(359);
+    __m256i v88 = _mm256_set1_epi32(88);
+    __m256i v183 = _mm256_set1_epi32(183);
+    __m256i v454 = _mm256_set1_epi32(454);
+    __m256i dup_lo = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    __m256i dup_hi = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+    __m128i _shuff_0 =
+            _mm_set_epi8(15, 13, 11, 9, 7, 5, 3, 1, 14, 12, 10, 8, 6, 4, 2, 0);
+
+    for (size_t r = row_begin; r < row_end; r += 2, pY += (src_step << 1)) {
+        unsigned char* dst0 = dst.ptr(r);
+        unsigned char* dst1 = dst.ptr(r + 1);
+        int c = 0;
+        for (; c <= width - 16; c += 16) {
+            __m256i U, V;
+            if (is_planar) {
+                U = _mm256_cvtepu8_epi32(
+                        _mm_loadl_epi64((const __m128i*)(pU + c / 2)));
+                V = _mm256_cvtepu8_epi32(
+                        _mm_loadl_epi64((const __m128i*)(pV + c / 2)));
+            } else {
+                //! even bytes to the low half and odd bytes to the high half
+                __m128i UV = _mm_shuffle_epi8(
+                        _mm_loadu_si128(
+                                (const __m128i*)((is_uv ? pU : pV) + c)),
+                        _shuff_0);
+                __m256i even = _mm256_cvtepu8_epi32(UV),
+                        odd = _mm256_cvtepu8_epi32(_mm_srli_si128(UV, 8));
+                U = is_uv ? even : odd;
+                V = is_uv ? odd : even;
+            }
+            U = _mm256_sub_epi32(U, v128);
+            V = _mm256_sub_epi32(V, v128);
+            __m256i RV = _mm256_srai_epi32(_mm256_mullo_epi32(V, v359), 8);
+            __m256i GUV = _mm256_srai_epi32(
+                    _mm256_add_epi32(_mm256_mullo_epi32(U, v88),
+                                     _mm256_mullo_epi32(V, v183)),
+                    8);
+            __m256i BU = _mm256_srai_epi32(_mm256_mullo_epi32(U, v454), 8);
+            __m256i RV0 = _mm256_permutevar8x32_epi32(RV, dup_lo),
+                    RV1 = _mm256_permutevar8x32_epi32(RV, dup_hi),
+                    GUV0 = _mm256_permutevar8x32_epi32(GUV, dup_lo),
+                    GUV1 = _mm256_permutevar8x32_epi32(GUV, dup_hi),
+                    BU0 = _mm256_permutevar8x32_epi32(BU, dup_lo),
+                    BU1 = _mm256_permutevar8x32_epi32(BU, dup_hi);
+
+            for (int i = 0; i < 2; ++i) {
+                __m128i Y = _mm_loadu_si128(
+                        (const __m128i*)(pY + i * src_step + c));
+                __m256i Y0 = _mm256_cvtepu8_epi32(Y),
+                        Y1 = _mm256_cvtepu8_epi32(_mm_srli_si128(Y, 8));
+                __m128i R = pack_u8x16(_mm256_add_epi32(Y0, RV0),
+                                       _mm256_add_epi32(Y1, RV1));
+                __m128i G = pack_u8x16(_mm256_sub_epi32(Y0, GUV0),
+                                       _mm256_sub_epi32(Y1, GUV1));
+                __m128i B = pack_u8x16(_mm256_add_epi32(Y0, BU0),
+                                       _mm256_add_epi32(Y1, BU1));
+                unsigned char* pdst = (i ? dst1 : dst0) + c * 3;
+                if (rgb) {
+                    store_interleave_u8x3(pdst, R, G, B);
+                } else {
+                    store_interleave_u8x3(pdst, B, G, R);
+                }
+            }
+        }
+        cvt_yuv_transform_tail<rgb, is_planar, is_uv>(
+                pY, src_step, pU, pV, c, width, dst0, c * 3, dst1, c * 3);
+        if (is_planar) {
+            pV += src_step / 2;
+            pU += src_step / 2;
+        } else {
+            if (is_uv) {
+                pU += src_step;
+            } else {
+                pV += src_step;
+            }
+        }
+    }
+}
+
+template <bool rgb, bool is_planar, bool is_uv>
+void cvt_yuv_rows_dispatch(const Mat8u& src, Mat8u& dst, size_t row_begin,
+                           size_t row_end) {
+    if (is_supported(SIMDType::AVX2)) {
+        cvt_yuv_transform_avx2<rgb, is_planar, is_uv>(src, dst, row_begin,
+                                                       row_end);
+    } else {
+        cvt_yuv_transform<rgb, is_planar, is_uv>(src, dst, row_begin,
+                                                  row_end);
+    }
+}
+
+/*!
+ * \brief convert dst rows [row_begin, row_end) of an image from yuv420,
+ *      whose src has 3/2 times as many rows as dst; row_begin must be even
+ */
+void cvt_yuv_rows(const Mat8u& src, Mat8u& dst, param::CvtColor::Mode mode,
+                  size_t row_begin, size_t row_end) {
+    using Mode = param::CvtColor::Mode;
+    megdnn_assert(row_begin % 2 == 0);
+    switch (mode) {
+        case Mode::YUV2GRAY_NV21:
+        case Mode::YUV2GRAY_NV12:
+        case Mode::YUV2GRAY_YV12:
+        case Mode::YUV2GRAY_YU12:
+            for (size_t r = row_begin; r < row_end; ++r) {
+                memcpy(dst.ptr(r), src.ptr(r), dst.cols());
+            }
+            return;
+        case Mode::YUV2RGB_NV21:
+        case Mode::YCrCb2RGB:
+            return cvt_yuv_rows_dispatch<true, false, false>(
+                    src, dst, row_begin, row_end);
+        case Mode::YUV2BGR_NV21:
+        case Mode::YCrCb2BGR:
+            return cvt_yuv_rows_dispatch<false, false, false>(
+                    src, dst, row_begin, row_end);
+        case Mode::YUV2RGB_NV12:
+            return cvt_yuv_rows_dispatch<true, false, true>(
+                    src, dst, row_begin, row_end);
+        case Mode::YUV2BGR_NV12:
+            return cvt_yuv_rows_dispatch<false, false, true>(
+                    src, dst, row_begin, row_end);
+        case Mode::YUV2RGB_YV12:
+            return cvt_yuv_rows_dispatch<true, true, false>(
+                    src, dst, row_begin, row_end);
+        case Mode::YUV2BGR_YV12:
+            return cvt_yuv_rows_dispatch<false, true, false>(
+                    src, dst, row_begin, row_end);
+        case Mode::YUV2RGB_YU12:
+            return cvt_yuv_rows_dispatch<true, true, true>(
+                    src, dst, row_begin, row_end);
+        case Mode::YUV2BGR_YU12:
+            return cvt_yuv_rows_dispatch<false, true, true>(
+                    src, dst, row_begin, row_end);
+        case Mode::BT601_YUV2RGB_NV21:
+            return cvt_BT601_yuv_transform<true, false, false>(
+                    src, dst, row_begin, row_end);
+        case Mode::BT601_YUV2BGR_NV21:
+            return cvt_BT601_yuv_transform<false, false, false>(
+                    src, dst, row_begin, row_end);
+        case Mode::BT601_YUV2RGB_NV12:
+            return cvt_BT601_yuv_transform<true, false, true>(
+                    src, dst, row_begin, row_end);
+        case Mode::BT601_YUV2BGR_NV12:
+            return cvt_BT601_yuv_transform<false, false, true>(
+                    src, dst, row_begin, row_end);
+        case Mode::BT601_YUV2RGB_YV12:
+            return cvt_BT601_yuv_transform<true, true, false>(
+                    src, dst, row_begin, row_end);
+        case Mode::BT601_YUV2BGR_YV12:
+            return cvt_BT601_yuv_transform<false, true, false>(
+                    src, dst, row_begin, row_end);
+        case Mode::BT601_YUV2RGB_YU12:
+            return cvt_BT601_yuv_transform<true, true, true>(
+                    src, dst, row_begin, row_end);
+        case Mode::BT601_YUV2BGR_YU12:
+            return cvt_BT601_yuv_transform<false, true, true>(
+                    src, dst, row_begin, row_end);
+        default:
+            megdnn_throw("unknown mode for yuv.");
+    }
+}
+
 }  // namespace
 
 MEGDNN_ATTRIBUTE_TARGET("sse4.2")
@@ -1729,42 +1999,42 @@ void cvt_yuv2gray_nv21<uchar>(const Mat8u& src, Mat8u& dst) {
 
 template <>
 void cvt_yuv2rgb_nv21<uchar>(const Mat8u& src, Mat8u& dst) {
-    return cvt_yuv_transform<true, false, false>(src, dst);
+    return cvt_yuv_transform<true, false, false>(src, dst, 0, dst.rows());
 }
 
 template <>
 void cvt_yuv2bgr_nv21<uchar>(const Mat8u& src, Mat8u& dst) {
-    return cvt_yuv_transform<false, false, false>(src, dst);
+    return cvt_yuv_transform<false, false, false>(src, dst, 0, dst.rows());
 }
 
 template <>
 void cvt_yuv2rgb_nv12<uchar>(const Mat8u& src, Mat8u& dst) {
-    return cvt_yuv_transform<true, false, true>(src, dst);
+    return cvt_yuv_transform<true, false, true>(src, dst, 0, dst.rows());
 }
 
 template <>
 void cvt_yuv2bgr_nv12<uchar>(const Mat8u& src, Mat8u& dst) {
-    return cvt_yuv_transform<false, false, true>(src, dst);
+    return cvt_yuv_transform<false, false, true>(src, dst, 0, dst.rows());
 }
 
 template <>
 void cvt_yuv2rgb_yv12<uchar>(const Mat8u& src, Mat8u& dst) {
-    return cvt_yuv_transform<true, true, false>(src, dst);
+    return cvt_yuv_transform<true, true, false>(src, dst, 0, dst.rows());
 }
 
 template <>
 void cvt_yuv2bgr_yv12<uchar>(const Mat8u& src, Mat8u& dst) {
-    return cvt_yuv_transform<false, true, false>(src, dst);
+    return cvt_yuv_transform<false, true, false>(src, dst, 0, dst.rows());
 }
 
 template <>
 void cvt_yuv2rgb_yu12<uchar>(const Mat8u& src, Mat8u& dst) {
-    return cvt_yuv_transform<true, true, true>(src, dst);
+    return cvt_yuv_transform<true, true, true>(src, dst, 0, dst.rows());
 }
 
 template <>
 void cvt_yuv2bgr_yu12<uchar>(const Mat8u& src, Mat8u& dst) {
-    return cvt_yuv_transform<false, true, true>(src, dst);
+    return cvt_yuv_transform<false, true, true>(src, dst, 0, dst.rows());
 }
 
 template <typename T>
@@ -1779,113 +2049,143 @@ void cvt_bt601_yuv(const megcv::Mat<T>& src, megcv::Mat<T>& dst,
 template <>
 void cvt_bt601_yuv<uchar>(const megcv::Mat<uchar>& src, megcv::Mat<uchar>& dst,
                           param::CvtColor::Mode mode) {
+    cvt_yuv_rows(src, dst, mode, 0, dst.rows());
+}
+
+namespace {
+
+template <typename T>
+void cvt_yuv_rows(const Mat<T>&, Mat<T>&, param::CvtColor::Mode, size_t,
+                  size_t) {
+    megdnn_throw("Unsupport dtype for yuv");
+}
+
+template <typename T>
+void cvt_color_mat(const Mat<T>& src, Mat<T>& dst,
+                   param::CvtColor::Mode mode) {
     using Mode = param::CvtColor::Mode;
     switch (mode) {
-        case Mode::BT601_YUV2RGB_NV21:
-            return cvt_BT601_yuv_transform<true, false, false>(src, dst);
-        case Mode::BT601_YUV2BGR_NV21:
-            return cvt_BT601_yuv_transform<false, false, false>(src, dst);
-        case Mode::BT601_YUV2RGB_NV12:
-            return cvt_BT601_yuv_transform<true, false, true>(src, dst);
+        case Mode::RGB2GRAY:
+            cvt_rgb2gray<T>(src, dst);
+            break;
+        case Mode::RGB2YUV:
+            cvt_rgb2yuv<T>(src, dst);
+            break;
+        case Mode::YUV2RGB:
+            cvt_yuv2rgb<T>(src, dst);
+            break;
+        case Mode::GRAY2RGB:
+            cvt_gray2rgb<T>(src, dst);
+            break;
+        case Mode::RGBA2RGB:
+            cvt_rgba2rgb<T>(src, dst);
+            break;
+        case Mode::RGBA2BGR:
+            cvt_rgba2bgr<T>(src, dst);
+            break;
+        case Mode::RGBA2GRAY:
+            cvt_rgba2gray<T>(src, dst);
+            break;
+        case Mode::RGB2BGR:
+            cvt_rgb2bgr<T>(src, dst);
+            break;
+        case Mode::BGR2GRAY:
+            cvt_bgr2gray<T>(src, dst);
+            break;
+        case Mode::BGR2RGB:
+            cvt_bgr2rgb<T>(src, dst);
+            break;
+        case Mode::YUV2GRAY_NV21:
+        case Mode::YUV2GRAY_NV12:
+        case Mode::YUV2GRAY_YV12:
+        case Mode::YUV2GRAY_YU12:
+            cvt_yuv2gray_nv21<T>(src, dst);
+            break;
+        case Mode::YUV2RGB_NV21:
+        case Mode::YCrCb2RGB:
+            cvt_yuv2rgb_nv21<T>(src, dst);
+            break;
+        case Mode::YUV2BGR_NV21:
+        case Mode::YCrCb2BGR:
+            cvt_yuv2bgr_nv21<T>(src, dst);
+            break;
+        case Mode::YUV2RGB_NV12:
+            cvt_yuv2rgb_nv12<T>(src, dst);
+            break;
+        case Mode::YUV2BGR_NV12:
+            cvt_yuv2bgr_nv12<T>(src, dst);
+            break;
+        case Mode::YUV2RGB_YV12:
+            cvt_yuv2rgb_yv12<T>(src, dst);
+            break;
+        case Mode::YUV2BGR_YV12:
+            cvt_yuv2bgr_yv12<T>(src, dst);
+            break;
+        case Mode::YUV2RGB_YU12:
+            cvt_yuv2rgb_yu12<T>(src, dst);
+            break;
+        case Mode::YUV2BGR_YU12:
+            cvt_yuv2bgr_yu12<T>(src, dst);
+            break;
         case Mode::BT601_YUV2BGR_NV12:
-            return cvt_BT601_yuv_transform<false, false, true>(src, dst);
-        case Mode::BT601_YUV2RGB_YV12:
-            return cvt_BT601_yuv_transform<true, true, false>(src, dst);
-        case Mode::BT601_YUV2BGR_YV12:
-            return cvt_BT601_yuv_transform<false, true, false>(src, dst);
+        case Mode::BT601_YUV2RGB_NV12:
+        case Mode::BT601_YUV2BGR_NV21:
+        case Mode::BT601_YUV2RGB_NV21:
         case Mode::BT601_YUV2RGB_YU12:
-            return cvt_BT601_yuv_transform<true, true, true>(src, dst);
         case Mode::BT601_YUV2BGR_YU12:
-            return cvt_BT601_yuv_transform<false, true, true>(src, dst);
+        case Mode::BT601_YUV2RGB_YV12:
+        case Mode::BT601_YUV2BGR_YV12:
+            cvt_bt601_yuv<T>(src, dst, mode);
+            break;
         default:
-            megdnn_throw("unknown mode for real yuv.");
+            megdnn_throw("Can not find property cvt_color operator.");
     }
 }
 
+}  // anonymous namespace
+
 template <typename T>
 void CvtColorImpl::cvt_color_exec(_megdnn_tensor_in src_tensor,
                                   _megdnn_tensor_out dst_tensor) {
     auto mode = param().mode;
-    for (size_t i = 0; i < src_tensor.layout.shape[0]; ++i) {
-        Mat<T> src = TensorND2Mat<T>(src_tensor, i);
-        Mat<T> dst = TensorND2Mat<T>(dst_tensor, i);
-        switch (param().mode) {
-            case Param::Mode::RGB2GRAY:
-                cvt_rgb2gray<T>(src, dst);
-                break;
-            case Param::Mode::RGB2YUV:
-                cvt_rgb2yuv<T>(src, dst);
-                break;
-            case Param::Mode::YUV2RGB:
-                cvt_yuv2rgb<T>(src, dst);
-                break;
-            case Param::Mode::GRAY2RGB:
-                cvt_gray2rgb<T>(src, dst);
-                break;
-            case Param::Mode::RGBA2RGB:
-                cvt_rgba2rgb<T>(src, dst);
-                break;
-            case Param::Mode::RGBA2BGR:
-                cvt_rgba2bgr<T>(src, dst);
-                break;
-            case Param::Mode::RGBA2GRAY:
-                cvt_rgba2gray<T>(src, dst);
-                break;
-            case Param::Mode::RGB2BGR:
-                cvt_rgb2bgr<T>(src, dst);
-                break;
-            case Param::Mode::BGR2GRAY:
-                cvt_bgr2gray<T>(src, dst);
-                break;
-            case Param::Mode::BGR2RGB:
-                cvt_bgr2rgb<T>(src, dst);
-                break;
-            case Param::Mode::YUV2GRAY_NV21:
-            case Param::Mode::YUV2GRAY_NV12:
-            case Param::Mode::YUV2GRAY_YV12:
-            case Param::Mode::YUV2GRAY_YU12:
-                cvt_yuv2gray_nv21<T>(src, dst);
-                break;
-            case Param::Mode::YUV2RGB_NV21:
-            case Param::Mode::YCrCb2RGB:
-                cvt_yuv2rgb_nv21<T>(src, dst);
-                break;
-            case Param::Mode::YUV2BGR_NV21:
-            case Param::Mode::YCrCb2BGR:
-                cvt_yuv2bgr_nv21<T>(src, dst);
-                break;
-            case Param::Mode::YUV2RGB_NV12:
-                cvt_yuv2rgb_nv12<T>(src, dst);
-                break;
-            case Param::Mode::YUV2BGR_NV12:
-                cvt_yuv2bgr_nv12<T>(src, dst);
-                break;
-            case Param::Mode::YUV2RGB_YV12:
-                cvt_yuv2rgb_yv12<T>(src, dst);
-                break;
-            case Param::Mode::YUV2BGR_YV12:
-                cvt_yuv2bgr_yv12<T>(src, dst);
-                break;
-            case Param::Mode::YUV2RGB_YU12:
-                cvt_yuv2rgb_yu12<T>(src, dst);
-                break;
-            case Param::Mode::YUV2BGR_YU12:
-                cvt_yuv2bgr_yu12<T>(src, dst);
-                break;
-            case Param::Mode::BT601_YUV2BGR_NV12:
-            case Param::Mode::BT601_YUV2RGB_NV12:
-            case Param::Mode::BT601_YUV2BGR_NV21:
-            case Param::Mode::BT601_YUV2RGB_NV21:
-            case Param::Mode::BT601_YUV2RGB_YU12:
-            case Param::Mode::BT601_YUV2BGR_YU12:
-            case Param::Mode::BT601_YUV2RGB_YV12:
-            case Param::Mode::BT601_YUV2BGR_YV12:
-                cvt_bt601_yuv<T>(src, dst, mode);
-                break;
-            default:
-                megdnn_throw("Can not find property cvt_color operator.");
-        }
+    size_t batch = dst_tensor.layout.shape[0],
+           rows = dst_tensor.layout.shape[1];
+    //! yuv420 src has 3/2 times as many rows as dst, and each row of chroma
+    //! samples is shared by two rows of dst
+    bool is_yuv = src_tensor.layout.shape[1] != rows;
+    size_t nr_threads = static_cast<naive::HandleImpl*>(handle())
+                                ->megcore_dispatcher()
+                                ->nr_threads();
+    size_t nr_bands = 1;
+    if (batch < nr_threads && (!is_yuv || std::is_same<T, uchar>::value)) {
+        nr_bands = std::min(div_ceil(nr_threads, batch),
+                            div_ceil(rows, MIN_ROWS_PER_BAND));
+    }
+    size_t band_rows = div_ceil(rows, nr_bands);
+    if (is_yuv) {
+        band_rows = round_up(band_rows, 2_z);
     }
+    nr_bands = div_ceil(rows, band_rows);
+
+    auto task = [=](size_t index, size_t) {
+        size_t batch_id = index / nr_bands, band_id = index % nr_bands;
+        Mat<T> src = TensorND2Mat<T>(src_tensor, batch_id);
+        Mat<T> dst = TensorND2Mat<T>(dst_tensor, batch_id);
+        size_t row_begin = band_id * band_rows,
+               row_end = std::min(row_begin + band_rows, rows);
+        if (nr_bands == 1) {
+            cvt_color_mat<T>(src, dst, mode);
+        } else if (is_yuv) {
+            cvt_yuv_rows(src, dst, mode, row_begin, row_end);
+        } else {
+            Mat<T> src_band(src, row_begin, row_end - row_begin, 0,
+                            src.cols());
+            Mat<T> dst_band(dst, row_begin, row_end - row_begin, 0,
+                            dst.cols());
+            cvt_color_mat<T>(src_band, dst_band, mode);
+        }
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN_OPR(task, batch * nr_bands);
 }
 
 void CvtColorImpl::exec(_megdnn_tensor_in src, _megdnn_tensor_out dst,
@@ -1897,11 +2197,13 @@ void CvtColorImpl::exec(_megdnn_tensor_in src, _megdnn_tensor_out dst,
         naive::CvtColorImpl::exec(src, dst, workspace);
         return;
     }
-    MEGDNN_DISPATCH_CPU_KERN_OPR(if (dst.layout.dtype == dtype::Float32()) {
+    if (dst.layout.dtype == dtype::Float32()) {
         cvt_color_exec<float>(src, dst);
     } else if (dst.layout.dtype == dtype::Uint8()) {
         cvt_color_exec<uchar>(src, dst);
-    } else { megdnn_throw("Unsupported datatype of CvtColor optr."); });
+    } else {
+        megdnn_throw("Unsupported datatype of CvtColor optr.");
+    }
 }
 
 }  // namespace x86
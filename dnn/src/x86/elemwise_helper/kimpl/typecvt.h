@@ -522,6 +522,415 @@ struct TypeCvtOp<SIMDType::SSE4_2, dt_qint32, dt_float32>
     }
 };
 
+////////////////////////////////////////avx2//////////////////////////////
+
+#define CONVERT_INT8_INT32_AVX                                            \
+    __m128i vsrc_lo = _mm256_extracti128_si256(vsrc, 0);                  \
+    __m128i vsrc_hi = _mm256_extracti128_si256(vsrc, 1);                  \
+    __m256i val_0 = _mm256_cvtepi8_epi32(vsrc_lo);                        \
+    __m256i val_1 = _mm256_cvtepi8_epi32(_mm_bsrli_si128(vsrc_lo, 8));   \
+    __m256i val_2 = _mm256_cvtepi8_epi32(vsrc_hi);                        \
+    __m256i val_3 = _mm256_cvtepi8_epi32(_mm_bsrli_si128(vsrc_hi, 8));
+
+#define CONVERT_UINT8_INT32_AVX                                           \
+    __m128i vsrc_lo = _mm256_extracti128_si256(vsrc, 0);                  \
+    __m128i vsrc_hi = _mm256_extracti128_si256(vsrc, 1);                  \
+    __m256i val_0 = _mm256_sub_epi32(_mm256_cvtepu8_epi32(vsrc_lo),       \
+                                     this->vszp);                         \
+    __m256i val_1 = _mm256_sub_epi32(                                     \
+            _mm256_cvtepu8_epi32(_mm_bsrli_si128(vsrc_lo, 8)), this->vszp); \
+    __m256i val_2 = _mm256_sub_epi32(_mm256_cvtepu8_epi32(vsrc_hi),       \
+                                     this->vszp);                         \
+    __m256i val_3 = _mm256_sub_epi32(                                     \
+            _mm256_cvtepu8_epi32(_mm_bsrli_si128(vsrc_hi, 8)), this->vszp);
+
+#define CONVERT_INT32_F32_SCALE_AVX                                      \
+    __m256 vitem0 = _mm256_mul_ps(_mm256_cvtepi32_ps(val_0), this->vscale); \
+    __m256 vitem1 = _mm256_mul_ps(_mm256_cvtepi32_ps(val_1), this->vscale); \
+    __m256 vitem2 = _mm256_mul_ps(_mm256_cvtepi32_ps(val_2), this->vscale); \
+    __m256 vitem3 = _mm256_mul_ps(_mm256_cvtepi32_ps(val_3), this->vscale);
+
+//! store 2 * 32 int8 results of an op whose vector result is __m256i
+#define STORE_8BIT_AVX(_dst)                                            \
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(_dst),                \
+                        operator()(vsrc.val[0]));                        \
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(_dst + SIMD_WIDTH),   \
+                        operator()(vsrc.val[1]));
+
+//! store 2 * 32 32-bit results of an op whose vector result has 4 parts
+#define STORE_32BIT_X4_AVX(_store, _ptr_type, _dst)                     \
+    for (size_t i = 0; i < 2; ++i) {                                     \
+        auto result = operator()(vsrc.val[i]);                           \
+        for (size_t j = 0; j < 4; ++j) {                                 \
+            _store(reinterpret_cast<_ptr_type*>(_dst + i * SIMD_WIDTH + \
+                                                j * 8),                  \
+                   result.val[j]);                                       \
+        }                                                                \
+    }
+
+template <>
+struct TypeCvtOp<SIMDType::AVX2, dt_quint8, dt_quint8>
+        : UnaryOpBase<SIMDType::AVX2, dt_quint8, dt_quint8> {
+    using UnaryOpBase::UnaryOpBase;
+    constexpr static size_t SIMD_WIDTH = 32;
+
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    void operator()(const __m256ix2& vsrc, dt_quint8* dst) const {
+        STORE_8BIT_AVX(dst)
+    }
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    __m256i operator()(const __m256i& vsrc) const {
+        CONVERT_UINT8_INT32_AVX
+        CONVERT_INT32_F32_SCALE_AVX
+        auto result0 = QConverter::convert<__m128i, __m256x2, __m256i>(
+                {{vitem0, vitem1}}, this->vdzp);
+        auto result1 = QConverter::convert<__m128i, __m256x2, __m256i>(
+                {{vitem2, vitem3}}, this->vdzp);
+        return _mm256_set_m128i(result1, result0);
+    }
+    void operator()(src_ctype src, dst_ctype* dst) {
+        *reinterpret_cast<uint8_t*>(dst) = saturate<uint8_t, float>(
+                std::round((src.as_uint8() - szp) * scale) + dzp, 0, 255);
+    }
+};
+
+template <>
+struct TypeCvtOp<SIMDType::AVX2, dt_qint8, dt_quint8>
+        : UnaryOpBase<SIMDType::AVX2, dt_qint8, dt_quint8> {
+    using UnaryOpBase::UnaryOpBase;
+    constexpr static size_t SIMD_WIDTH = 32;
+
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    void operator()(const __m256ix2& vsrc, dt_quint8* dst) const {
+        STORE_8BIT_AVX(dst)
+    }
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    __m256i operator()(const __m256i& vsrc) const {
+        CONVERT_INT8_INT32_AVX
+        CONVERT_INT32_F32_SCALE_AVX
+        auto result0 = QConverter::convert<__m128i, __m256x2, __m256i>(
+                {{vitem0, vitem1}}, this->vdzp);
+        auto result1 = QConverter::convert<__m128i, __m256x2, __m256i>(
+                {{vitem2, vitem3}}, this->vdzp);
+        return _mm256_set_m128i(result1, result0);
+    }
+    void operator()(src_ctype src, dst_ctype* dst) {
+        *reinterpret_cast<uint8_t*>(dst) = saturate<uint8_t, float>(
+                std::round(src.as_int8() * scale) + dzp, 0, 255);
+    }
+};
+
+template <>
+struct TypeCvtOp<SIMDType::AVX2, dt_qint32, dt_quint8>
+        : UnaryOpBase<SIMDType::AVX2, dt_qint32, dt_quint8> {
+    using UnaryOpBase::UnaryOpBase;
+    constexpr static size_t SIMD_WIDTH = 8;
+
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    void operator()(const __m256ix2& vsrc, dt_quint8* dst) const {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), operator()(vsrc));
+    }
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    __m128i operator()(const __m256ix2& vsrc) const {
+        auto vitem0 =
+                _mm256_mul_ps(_mm256_cvtepi32_ps(vsrc.val[0]), this->vscale);
+        auto vitem1 =
+                _mm256_mul_ps(_mm256_cvtepi32_ps(vsrc.val[1]), this->vscale);
+        return QConverter::convert<__m128i, __m256x2, __m256i>(
+                {{vitem0, vitem1}}, this->vdzp);
+    }
+    void operator()(src_ctype src, dst_ctype* dst) {
+        *reinterpret_cast<uint8_t*>(dst) = saturate<uint8_t, float>(
+                std::round(src.as_int32() * scale) + dzp, 0, 255);
+    }
+};
+
+template <>
+struct TypeCvtOp<SIMDType::AVX2, dt_float32, dt_quint8>
+        : UnaryOpBase<SIMDType::AVX2, dt_float32, dt_quint8> {
+    using UnaryOpBase::UnaryOpBase;
+    constexpr static size_t SIMD_WIDTH = 8;
+
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    void operator()(const __m256x2& vsrc, dt_quint8* dst) const {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), operator()(vsrc));
+    }
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    __m128i operator()(const __m256x2& vsrc) const {
+        auto vitem0 = _mm256_mul_ps(vsrc.val[0], this->vscale);
+        auto vitem1 = _mm256_mul_ps(vsrc.val[1], this->vscale);
+        return QConverter::convert<__m128i, __m256x2, __m256i>(
+                {{vitem0, vitem1}}, this->vdzp);
+    }
+    void operator()(src_ctype src, dst_ctype* dst) {
+        *reinterpret_cast<uint8_t*>(dst) =
+                saturate<uint8_t, float>(std::round(src * scale) + dzp, 0, 255);
+    }
+};
+
+template <>
+struct TypeCvtOp<SIMDType::AVX2, dt_qint8, dt_qint8>
+        : UnaryOpBase<SIMDType::AVX2, dt_qint8, dt_qint8> {
+    using UnaryOpBase::UnaryOpBase;
+    constexpr static size_t SIMD_WIDTH = 32;
+
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    void operator()(const __m256ix2& vsrc, dt_qint8* dst) const {
+        STORE_8BIT_AVX(dst)
+    }
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    __m256i operator()(const __m256i& vsrc) const {
+        CONVERT_INT8_INT32_AVX
+        CONVERT_INT32_F32_SCALE_AVX
+        auto result0 =
+                QConverter::convert<__m128i, __m256x2>({{vitem0, vitem1}});
+        auto result1 =
+                QConverter::convert<__m128i, __m256x2>({{vitem2, vitem3}});
+        return _mm256_set_m128i(result1, result0);
+    }
+    void operator()(src_ctype src, dst_ctype* dst) {
+        *reinterpret_cast<int8_t*>(dst) = saturate<int8_t, float>(
+                std::round(src.as_int8() * scale), -128, 127);
+    }
+};
+
+template <>
+struct TypeCvtOp<SIMDType::AVX2, dt_quint8, dt_qint8>
+        : UnaryOpBase<SIMDType::AVX2, dt_quint8, dt_qint8> {
+    using UnaryOpBase::UnaryOpBase;
+    constexpr static size_t SIMD_WIDTH = 32;
+
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    void operator()(const __m256ix2& vsrc, dt_qint8* dst) const {
+        STORE_8BIT_AVX(dst)
+    }
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    __m256i operator()(const __m256i& vsrc) const {
+        CONVERT_UINT8_INT32_AVX
+        CONVERT_INT32_F32_SCALE_AVX
+        auto result0 =
+                QConverter::convert<__m128i, __m256x2>({{vitem0, vitem1}});
+        auto result1 =
+                QConverter::convert<__m128i, __m256x2>({{vitem2, vitem3}});
+        return _mm256_set_m128i(result1, result0);
+    }
+    void operator()(src_ctype src, dst_ctype* dst) {
+        *reinterpret_cast<int8_t*>(dst) = saturate<int8_t, float>(
+                std::round((src.as_uint8() - szp) * scale), -128, 127);
+    }
+};
+
+template <>
+struct TypeCvtOp<SIMDType::AVX2, dt_qint32, dt_qint8>
+        : UnaryOpBase<SIMDType::AVX2, dt_qint32, dt_qint8> {
+    using UnaryOpBase::UnaryOpBase;
+    constexpr static size_t SIMD_WIDTH = 8;
+
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    void operator()(const __m256ix2& vsrc, dt_qint8* dst) const {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), operator()(vsrc));
+    }
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    __m128i operator()(const __m256ix2& vsrc) const {
+        auto vitem0 =
+                _mm256_mul_ps(_mm256_cvtepi32_ps(vsrc.val[0]), this->vscale);
+        auto vitem1 =
+                _mm256_mul_ps(_mm256_cvtepi32_ps(vsrc.val[1]), this->vscale);
+        return QConverter::convert<__m128i, __m256x2>({{vitem0, vitem1}});
+    }
+    void operator()(src_ctype src, dst_ctype* dst) {
+        *reinterpret_cast<int8_t*>(dst) = saturate<int8_t, float>(
+                std::round(src.as_int32() * scale), -128, 127);
+    }
+};
+
+template <>
+struct TypeCvtOp<SIMDType::AVX2, dt_float32, dt_qint8>
+        : UnaryOpBase<SIMDType::AVX2, dt_float32, dt_qint8> {
+    using UnaryOpBase::UnaryOpBase;
+    constexpr static size_t SIMD_WIDTH = 8;
+
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    void operator()(const __m256x2& vsrc, dt_qint8* dst) const {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), operator()(vsrc));
+    }
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    __m128i operator()(const __m256x2& vsrc) const {
+        auto vitem0 = _mm256_mul_ps(vsrc.val[0], this->vscale);
+        auto vitem1 = _mm256_mul_ps(vsrc.val[1], this->vscale);
+        return QConverter::convert<__m128i, __m256x2>({{vitem0, vitem1}});
+    }
+    void operator()(src_ctype src, dst_ctype* dst) {
+        *reinterpret_cast<int8_t*>(dst) =
+                saturate<int8_t, float>(std::round(src * scale), -128, 127);
+    }
+};
+
+template <>
+struct TypeCvtOp<SIMDType::AVX2, dt_quint8, dt_qint32>
+        : UnaryOpBase<SIMDType::AVX2, dt_quint8, dt_qint32> {
+    using UnaryOpBase::UnaryOpBase;
+    constexpr static size_t SIMD_WIDTH = 32;
+
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    void operator()(const __m256ix2& vsrc, dt_qint32* dst) const {
+        STORE_32BIT_X4_AVX(_mm256_storeu_si256, __m256i, dst)
+    }
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    __m256ix4 operator()(const __m256i& vsrc) const {
+        CONVERT_UINT8_INT32_AVX
+        CONVERT_INT32_F32_SCALE_AVX
+        return {{QConverter::convert<__m256i, __m256>(vitem0),
+                 QConverter::convert<__m256i, __m256>(vitem1),
+                 QConverter::convert<__m256i, __m256>(vitem2),
+                 QConverter::convert<__m256i, __m256>(vitem3)}};
+    }
+    void operator()(src_ctype src, dst_ctype* dst) {
+        *reinterpret_cast<int32_t*>(dst) =
+                std::round((src.as_uint8() - szp) * scale);
+    }
+};
+
+template <>
+struct TypeCvtOp<SIMDType::AVX2, dt_qint8, dt_qint32>
+        : UnaryOpBase<SIMDType::AVX2, dt_qint8, dt_qint32> {
+    using UnaryOpBase::UnaryOpBase;
+    constexpr static size_t SIMD_WIDTH = 32;
+
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    void operator()(const __m256ix2& vsrc, dt_qint32* dst) const {
+        STORE_32BIT_X4_AVX(_mm256_storeu_si256, __m256i, dst)
+    }
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    __m256ix4 operator()(const __m256i& vsrc) const {
+        CONVERT_INT8_INT32_AVX
+        CONVERT_INT32_F32_SCALE_AVX
+        return {{QConverter::convert<__m256i, __m256>(vitem0),
+                 QConverter::convert<__m256i, __m256>(vitem1),
+                 QConverter::convert<__m256i, __m256>(vitem2),
+                 QConverter::convert<__m256i, __m256>(vitem3)}};
+    }
+    void operator()(src_ctype src, dst_ctype* dst) {
+        *reinterpret_cast<int32_t*>(dst) = std::round(src.as_int8() * scale);
+    }
+};
+
+template <>
+struct TypeCvtOp<SIMDType::AVX2, dt_qint32, dt_qint32>
+        : UnaryOpBase<SIMDType::AVX2, dt_qint32, dt_qint32> {
+    using UnaryOpBase::UnaryOpBase;
+    constexpr static size_t SIMD_WIDTH = 8;
+
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    void operator()(const __m256ix2& vsrc, dt_qint32* dst) const {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+                            operator()(vsrc.val[0]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + SIMD_WIDTH),
+                            operator()(vsrc.val[1]));
+    }
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    __m256i operator()(const __m256i& vsrc) const {
+        auto vitem0 = _mm256_mul_ps(_mm256_cvtepi32_ps(vsrc), this->vscale);
+        return QConverter::convert<__m256i, __m256>(vitem0);
+    }
+    void operator()(src_ctype src, dst_ctype* dst) {
+        *reinterpret_cast<int32_t*>(dst) = std::round(src.as_int32() * scale);
+    }
+};
+
+template <>
+struct TypeCvtOp<SIMDType::AVX2, dt_float32, dt_qint32>
+        : UnaryOpBase<SIMDType::AVX2, dt_float32, dt_qint32> {
+    using UnaryOpBase::UnaryOpBase;
+    constexpr static size_t SIMD_WIDTH = 8;
+
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    void operator()(const __m256x2& vsrc, dt_qint32* dst) const {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+                            operator()(vsrc.val[0]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + SIMD_WIDTH),
+                            operator()(vsrc.val[1]));
+    }
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    __m256i operator()(const __m256& vsrc) const {
+        auto vitem0 = _mm256_mul_ps(vsrc, this->vscale);
+        return QConverter::convert<__m256i, __m256>(vitem0);
+    }
+    void operator()(src_ctype src, dst_ctype* dst) {
+        *reinterpret_cast<int32_t*>(dst) = std::round(src * scale);
+    }
+};
+
+template <>
+struct TypeCvtOp<SIMDType::AVX2, dt_quint8, dt_float32>
+        : UnaryOpBase<SIMDType::AVX2, dt_quint8, dt_float32> {
+    using UnaryOpBase::UnaryOpBase;
+    constexpr static size_t SIMD_WIDTH = 32;
+
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    void operator()(const __m256ix2& vsrc, dt_float32* dst) const {
+        STORE_32BIT_X4_AVX(_mm256_storeu_ps, float, dst)
+    }
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    __m256x4 operator()(const __m256i& vsrc) const {
+        CONVERT_UINT8_INT32_AVX
+        CONVERT_INT32_F32_SCALE_AVX
+        return {{vitem0, vitem1, vitem2, vitem3}};
+    }
+    void operator()(src_ctype src, dst_ctype* dst) {
+        *reinterpret_cast<float*>(dst) = (src.as_uint8() - szp) * scale;
+    }
+};
+
+template <>
+struct TypeCvtOp<SIMDType::AVX2, dt_qint8, dt_float32>
+        : UnaryOpBase<SIMDType::AVX2, dt_qint8, dt_float32> {
+    using UnaryOpBase::UnaryOpBase;
+    constexpr static size_t SIMD_WIDTH = 32;
+
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    void operator()(const __m256ix2& vsrc, dt_float32* dst) const {
+        STORE_32BIT_X4_AVX(_mm256_storeu_ps, float, dst)
+    }
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    __m256x4 operator()(const __m256i& vsrc) const {
+        CONVERT_INT8_INT32_AVX
+        CONVERT_INT32_F32_SCALE_AVX
+        return {{vitem0, vitem1, vitem2, vitem3}};
+    }
+    void operator()(src_ctype src, dst_ctype* dst) {
+        *reinterpret_cast<float*>(dst) = src.as_int8() * scale;
+    }
+};
+
+template <>
+struct TypeCvtOp<SIMDType::AVX2, dt_qint32, dt_float32>
+        : UnaryOpBase<SIMDType::AVX2, dt_qint32, dt_float32> {
+    using UnaryOpBase::UnaryOpBase;
+    constexpr static size_t SIMD_WIDTH = 8;
+
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    void operator()(const __m256ix2& vsrc, dt_float32* dst) const {
+        _mm256_storeu_ps(reinterpret_cast<float*>(dst),
+                         operator()(vsrc.val[0]));
+        _mm256_storeu_ps(reinterpret_cast<float*>(dst + SIMD_WIDTH),
+                         operator()(vsrc.val[1]));
+    }
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    __m256 operator()(const __m256i& vsrc) const {
+        return _mm256_mul_ps(_mm256_cvtepi32_ps(vsrc), this->vscale);
+    }
+    void operator()(src_ctype src, dst_ctype* dst) {
+        *reinterpret_cast<float*>(dst) = src.as_int32() * scale;
+    }
+};
+
+#undef CONVERT_INT8_INT32_AVX
+#undef CONVERT_UINT8_INT32_AVX
+#undef CONVERT_INT32_F32_SCALE_AVX
+#undef STORE_8BIT_AVX
+#undef STORE_32BIT_X4_AVX
+
 template <>
 struct TypeCvtOp<SIMDType::NONE, dt_float32, dt_float32>
         : UnaryOpBase<SIMDType::NONE, dt_float32, dt_float32> {
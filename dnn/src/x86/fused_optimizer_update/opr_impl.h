@@ -0,0 +1,30 @@
+/**
+ * \file dnn/src/x86/fused_optimizer_update/opr_impl.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#pragma once
+
+#include "src/fallback/fused_optimizer_update/opr_impl.h"
+
+namespace megdnn {
+namespace x86 {
+
+//! FusedOptimizerUpdate with AVX kernel for ADAM
+class FusedOptimizerUpdateImpl : public fallback::FusedOptimizerUpdateImpl {
+public:
+    using fallback::FusedOptimizerUpdateImpl::FusedOptimizerUpdateImpl;
+
+protected:
+    AdamBlockFunc get_adam_block_func() override;
+};
+
+}  // namespace x86
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -75,6 +75,32 @@ namespace x86 {
 using namespace megcv;
 using BorderMode = param::GaussianBlur::BorderMode;
 
+namespace {
+//! dst rows of each task when an image is split into row bands
+constexpr size_t MIN_ROWS_PER_BAND = 16;
+
+/*!
+ * \brief split images into row bands when the batch is smaller than the
+ *      number of threads
+ *
+ * \param[out] band_rows number of dst rows in each band
+ * \return number of bands of each image
+ */
+size_t get_row_bands(Handle* handle, const TensorLayout& dst,
+                     size_t& band_rows) {
+    size_t batch = dst.shape[0], rows = dst.shape[1], nr_bands = 1;
+    size_t nr_threads = static_cast<naive::HandleImpl*>(handle)
+                                ->megcore_dispatcher()
+                                ->nr_threads();
+    if (batch < nr_threads) {
+        nr_bands = std::min(div_ceil(nr_threads, batch),
+                            div_ceil(rows, MIN_ROWS_PER_BAND));
+    }
+    band_rows = div_ceil(rows, nr_bands);
+    return div_ceil(rows, band_rows);
+}
+}  // anonymous namespace
+
 template <typename T>
 void GaussianBlurImpl::gaussian_blur_exec(const TensorND& src_tensor,
                                           const TensorND& dst_tensor) {
@@ -89,22 +115,31 @@ void GaussianBlurImpl::gaussian_blur_exec(const TensorND& src_tensor,
 
     T border_value[4] = {0, 0, 0, 0};
 
-    using namespace gaussian_blur;
-
-    BaseRowFilter* row_filter = getLinearRowFilter<T, T>(kernel_column);
-    BaseColumnFilter* column_filter =
-            getLinearColumnFilter<T, T>(kernel_row, (int)0);
-
-    FilterEngine<T, T> filter(row_filter, column_filter, src_channels,
-                              border_value, param().border_mode);
-
     megdnn_assert(param().border_mode != BorderMode::BORDER_ISOLATED);
-    for (size_t i = 0; i < src_tensor.layout.shape[0]; ++i) {
+    auto border_mode = param().border_mode;
+    size_t band_rows,
+           nr_bands = get_row_bands(handle(), dst_tensor.layout, band_rows);
+    //! FilterEngine keeps per-image row buffers, so each task owns one
+    auto task = [=](size_t index, size_t) {
+        size_t i = index / nr_bands, band_id = index % nr_bands;
+        using namespace gaussian_blur;
+        Mat<T> kcol = kernel_column, krow = kernel_row;
+        BaseRowFilter* row_filter = getLinearRowFilter<T, T>(kcol);
+        BaseColumnFilter* column_filter =
+                getLinearColumnFilter<T, T>(krow, (int)0);
+
+        FilterEngine<T, T> filter(row_filter, column_filter, src_channels,
+                                  border_value, border_mode);
+
         Mat<T> src = TensorND2Mat<T>(src_tensor, i);
         Mat<T> dst = TensorND2Mat<T>(dst_tensor, i);
 
-        filter.apply(src, dst);
-    }
+        int row_begin = band_id * band_rows;
+        int row_end = std::min(row_begin + band_rows, dst.rows());
+        filter.apply(src, dst, row_begin, row_end);
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN_OPR(
+            task, src_tensor.layout.shape[0] * nr_bands);
 }
 
 void GaussianBlurImpl::gaussian_blur_exec_8u(const TensorND& src_tensor,
@@ -134,33 +169,43 @@ void GaussianBlurImpl::gaussian_blur_exec_8u(const TensorND& src_tensor,
 
     uchar border_value[4] = {0, 0, 0, 0};
 
-    using namespace gaussian_blur;
-    BaseRowFilter* rowFilter =
-            getLinearRowFilter<uchar, int>(kernel_column_int);
-    BaseColumnFilter* columnFilter =
-            getLinearColumnFilter<int, uchar>(kernel_row_int, bits * 2);
-
-    FilterEngine<uchar, int> filter(rowFilter, columnFilter, src_channels,
-                                    border_value, param().border_mode);
-
     megdnn_assert(param().border_mode != BorderMode::BORDER_ISOLATED);
-    for (size_t i = 0; i < src_tensor.layout.shape[0]; ++i) {
+    auto border_mode = param().border_mode;
+    size_t band_rows,
+           nr_bands = get_row_bands(handle(), dst_tensor.layout, band_rows);
+    auto task = [=](size_t index, size_t) {
+        size_t i = index / nr_bands, band_id = index % nr_bands;
+        using namespace gaussian_blur;
+        Mat<int> kcol = kernel_column_int, krow = kernel_row_int;
+        BaseRowFilter* rowFilter = getLinearRowFilter<uchar, int>(kcol);
+        BaseColumnFilter* columnFilter =
+                getLinearColumnFilter<int, uchar>(krow, bits * 2);
+
+        FilterEngine<uchar, int> filter(rowFilter, columnFilter, src_channels,
+                                        border_value, border_mode);
+
         Mat<uchar> src = TensorND2Mat<uchar>(src_tensor, i);
         Mat<uchar> dst = TensorND2Mat<uchar>(dst_tensor, i);
 
-        filter.apply(src, dst);
-    }
+        int row_begin = band_id * band_rows;
+        int row_end = std::min(row_begin + band_rows, dst.rows());
+        filter.apply(src, dst, row_begin, row_end);
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN_OPR(
+            task, src_tensor.layout.shape[0] * nr_bands);
 }
 
 void GaussianBlurImpl::exec(_megdnn_tensor_in src, _megdnn_tensor_in dst,
                             _megdnn_workspace workspace) {
     using namespace megcv;
     check_exec(src.layout, dst.layout, workspace.size);
-    MEGDNN_DISPATCH_CPU_KERN_OPR(if (dst.layout.dtype == dtype::Float32()) {
+    if (dst.layout.dtype == dtype::Float32()) {
         gaussian_blur_exec<float>(src, dst);
     } else if (dst.layout.dtype == dtype::Uint8()) {
         gaussian_blur_exec_8u(src, dst);
-    } else { megdnn_throw("Unsupported datatype of GaussianBlur optr."); });
+    } else {
+        megdnn_throw("Unsupported datatype of GaussianBlur optr.");
+    }
 }
 
 }  // namespace x86
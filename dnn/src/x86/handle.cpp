@@ -15,10 +15,12 @@
 #include "src/x86/handle.h"
 
 #include "src/x86/add_update/opr_impl.h"
+#include "src/x86/checksum/opr_impl.h"
 #include "src/x86/conv_bias/opr_impl.h"
 #include "src/x86/cvt_color/opr_impl.h"
 #include "src/x86/elemwise/opr_impl.h"
 #include "src/x86/elemwise_multi_type/opr_impl.h"
+#include "src/x86/fused_optimizer_update/opr_impl.h"
 #include "src/x86/gaussian_blur/opr_impl.h"
 #include "src/x86/local/opr_impl.h"
 #include "src/x86/lrn/opr_impl.h"
@@ -88,6 +90,8 @@ MEGDNN_SPECIALIZE_CREATE_OPERATOR(WarpPerspective)
 MEGDNN_SPECIALIZE_CREATE_OPERATOR(AddUpdate)
 MEGDNN_SPECIALIZE_CREATE_OPERATOR(TypeCvt)
 MEGDNN_SPECIALIZE_CREATE_OPERATOR(ConvBias)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(ChecksumForward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(FusedOptimizerUpdate)
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpragmas"
@@ -0,0 +1,82 @@
+/**
+ * \file dnn/src/x86/pooling/generic_pooling.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#pragma once
+#include "src/common/utils.h"
+
+#include "megdnn/arch.h"
+#include "megdnn/opr_param_defs.h"
+
+namespace megdnn {
+namespace x86 {
+
+//! shape of a single pooling plane, shared by the generic kernels
+struct GenericPoolingShape {
+    size_t IH, IW, OH, OW, FH, FW, SH, SW, PH, PW;
+};
+
+/*!
+ * \brief float pooling on a single NCHW channel with arbitrary window, stride
+ *      and padding
+ *
+ * The window is reduced separably: valid rows of each window are first
+ * reduced into \p row_buf (which must hold IW floats), and then the columns
+ * of \p row_buf are reduced to produce one output row.
+ */
+void pooling_generic_f32_avx2(const float* src, float* dst,
+                              const GenericPoolingShape& shape,
+                              param::Pooling::Mode mode, float* row_buf)
+        MEGDNN_ATTRIBUTE_TARGET("avx2");
+
+/*!
+ * \brief int8 max pooling on a single NCHW channel; the reduction is the
+ *      same as pooling_generic_f32_avx2 and \p row_buf must hold IW bytes
+ */
+void max_pooling_generic_s8_avx2(const int8_t* src, int8_t* dst,
+                                 const GenericPoolingShape& shape,
+                                 int8_t* row_buf)
+        MEGDNN_ATTRIBUTE_TARGET("avx2");
+
+/*!
+ * \brief int8 average pooling on a single NCHW channel; rows are summed into
+ *      \p row_buf, which must hold IW int32 values
+ *
+ * \param round_nearest whether to round the mean half away from zero (as
+ *      QuantizedS8 does in the naive implementation) instead of truncating
+ *      it (as Int8 does)
+ */
+void avg_pooling_generic_s8_avx2(const int8_t* src, int8_t* dst,
+                                 const GenericPoolingShape& shape,
+                                 param::Pooling::Mode mode, bool round_nearest,
+                                 int32_t* row_buf)
+        MEGDNN_ATTRIBUTE_TARGET("avx2");
+
+/*!
+ * \brief float pooling on a single 8-channel block of NCHW88 tensors, where
+ *      each spatial position is a vector of 8 channels
+ */
+void pooling_nchw88_f32_avx2(const float* src, float* dst,
+                             const GenericPoolingShape& shape,
+                             param::Pooling::Mode mode)
+        MEGDNN_ATTRIBUTE_TARGET("avx2");
+
+/*!
+ * \brief int8 pooling on a single 8-channel block of NCHW88 tensors; see
+ *      avg_pooling_generic_s8_avx2 for \p round_nearest
+ */
+void pooling_nchw88_s8_avx2(const int8_t* src, int8_t* dst,
+                            const GenericPoolingShape& shape,
+                            param::Pooling::Mode mode, bool round_nearest)
+        MEGDNN_ATTRIBUTE_TARGET("avx2");
+
+}  // namespace x86
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,473 @@
+/**
+ * \file dnn/src/x86/pooling/generic_pooling_avx2.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "src/x86/pooling/generic_pooling.h"
+
+#include <immintrin.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace megdnn;
+using namespace x86;
+
+namespace {
+
+using Mode = param::Pooling::Mode;
+
+struct MaxOpF32 {
+    static float init() { return std::numeric_limits<float>::lowest(); }
+    static float apply(float a, float b) { return a > b ? a : b; }
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    static __m256 vapply(__m256 a, __m256 b) { return _mm256_max_ps(a, b); }
+};
+
+struct SumOpF32 {
+    static float init() { return 0.f; }
+    static float apply(float a, float b) { return a + b; }
+    MEGDNN_ATTRIBUTE_TARGET("avx2")
+    static __m256 vapply(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+};
+
+//! valid input range [begin, end) of a window starting at \p start
+void get_valid_range(ptrdiff_t start, size_t window, size_t size,
+                     size_t& begin, size_t& end) {
+    ptrdiff_t b = std::max<ptrdiff_t>(start, 0),
+              e = std::min<ptrdiff_t>(start + window, size);
+    begin = b;
+    end = std::max(b, e);
+}
+
+//! range [begin, end) of output columns whose windows are fully inside input
+void get_interior_range(const GenericPoolingShape& s, size_t& begin,
+                        size_t& end) {
+    begin = std::min((s.PW + s.SW - 1) / s.SW, s.OW);
+    end = s.IW + s.PW >= s.FW ? (s.IW + s.PW - s.FW) / s.SW + 1 : 0;
+    end = std::max(std::min(end, s.OW), begin);
+}
+
+//! divisor to compute the mean of a window with given number of valid elems
+float get_divisor(Mode mode, const GenericPoolingShape& s, size_t count) {
+    return mode == Mode::AVERAGE ? static_cast<float>(s.FH * s.FW)
+                                 : static_cast<float>(count);
+}
+
+template <class Op>
+MEGDNN_ATTRIBUTE_TARGET("avx2")
+void reduce_rows_f32(const float* src, size_t IW, size_t ih0, size_t ih1,
+                     float* row_buf) {
+    if (ih0 == ih1) {
+        std::fill(row_buf, row_buf + IW, Op::init());
+        return;
+    }
+    const float* sptr = src + ih0 * IW;
+    size_t iw = 0;
+    for (; iw + 8 <= IW; iw += 8) {
+        __m256 acc = _mm256_loadu_ps(sptr + iw);
+        for (size_t ih = ih0 + 1; ih < ih1; ++ih) {
+            acc = Op::vapply(acc, _mm256_loadu_ps(src + ih * IW + iw));
+        }
+        _mm256_storeu_ps(row_buf + iw, acc);
+    }
+    for (; iw < IW; ++iw) {
+        float acc = sptr[iw];
+        for (size_t ih = ih0 + 1; ih < ih1; ++ih) {
+            acc = Op::apply(acc, src[ih * IW + iw]);
+        }
+        row_buf[iw] = acc;
+    }
+}
+
+template <class Op>
+float reduce_cols_f32(const float* row_buf, const GenericPoolingShape& s,
+                      size_t ow, Mode mode, size_t nr_rows) {
+    size_t iw0, iw1;
+    get_valid_range(static_cast<ptrdiff_t>(ow * s.SW) -
+                            static_cast<ptrdiff_t>(s.PW),
+                    s.FW, s.IW, iw0, iw1);
+    float acc = Op::init();
+    for (size_t iw = iw0; iw < iw1; ++iw) {
+        acc = Op::apply(acc, row_buf[iw]);
+    }
+    if (mode == Mode::MAX) {
+        return acc;
+    }
+    return acc / get_divisor(mode, s, nr_rows * (iw1 - iw0));
+}
+
+template <class Op>
+MEGDNN_ATTRIBUTE_TARGET("avx2")
+void do_pooling_f32(const float* src, float* dst, const GenericPoolingShape& s,
+                    Mode mode, float* row_buf) {
+    size_t ow_beg, ow_end;
+    get_interior_range(s, ow_beg, ow_end);
+    __m256i gather_idx = _mm256_setr_epi32(0, s.SW, 2 * s.SW, 3 * s.SW,
+                                           4 * s.SW, 5 * s.SW, 6 * s.SW,
+                                           7 * s.SW);
+    for (size_t oh = 0; oh < s.OH; ++oh) {
+        size_t ih0, ih1;
+        get_valid_range(static_cast<ptrdiff_t>(oh * s.SH) -
+                                static_cast<ptrdiff_t>(s.PH),
+                        s.FH, s.IH, ih0, ih1);
+        reduce_rows_f32<Op>(src, s.IW, ih0, ih1, row_buf);
+
+        float* dptr = dst + oh * s.OW;
+        size_t nr_rows = ih1 - ih0, ow = 0;
+        for (; ow < ow_beg; ++ow) {
+            dptr[ow] = reduce_cols_f32<Op>(row_buf, s, ow, mode, nr_rows);
+        }
+        __m256 vdivisor =
+                _mm256_set1_ps(get_divisor(mode, s, nr_rows * s.FW));
+        for (; ow + 8 <= ow_end; ow += 8) {
+            const float* p = row_buf + ow * s.SW - s.PW;
+            __m256 acc;
+            if (s.SW == 1) {
+                acc = _mm256_loadu_ps(p);
+                for (size_t fw = 1; fw < s.FW; ++fw) {
+                    acc = Op::vapply(acc, _mm256_loadu_ps(p + fw));
+                }
+            } else {
+                acc = _mm256_i32gather_ps(p, gather_idx, 4);
+                for (size_t fw = 1; fw < s.FW; ++fw) {
+                    acc = Op::vapply(acc,
+                                     _mm256_i32gather_ps(p + fw, gather_idx, 4));
+                }
+            }
+            if (mode != Mode::MAX) {
+                acc = _mm256_div_ps(acc, vdivisor);
+            }
+            _mm256_storeu_ps(dptr + ow, acc);
+        }
+        for (; ow < s.OW; ++ow) {
+            dptr[ow] = reduce_cols_f32<Op>(row_buf, s, ow, mode, nr_rows);
+        }
+    }
+}
+
+template <class Op>
+MEGDNN_ATTRIBUTE_TARGET("avx2")
+void do_pooling_nchw88_f32(const float* src, float* dst,
+                           const GenericPoolingShape& s, Mode mode) {
+    for (size_t oh = 0; oh < s.OH; ++oh) {
+        size_t ih0, ih1;
+        get_valid_range(static_cast<ptrdiff_t>(oh * s.SH) -
+                                static_cast<ptrdiff_t>(s.PH),
+                        s.FH, s.IH, ih0, ih1);
+        for (size_t ow = 0; ow < s.OW; ++ow) {
+            size_t iw0, iw1;
+            get_valid_range(static_cast<ptrdiff_t>(ow * s.SW) -
+                                    static_cast<ptrdiff_t>(s.PW),
+                            s.FW, s.IW, iw0, iw1);
+            __m256 acc = _mm256_set1_ps(Op::init());
+            for (size_t ih = ih0; ih < ih1; ++ih) {
+                const float* sptr = src + (ih * s.IW + iw0) * 8;
+                for (size_t iw = iw0; iw < iw1; ++iw, sptr += 8) {
+                    acc = Op::vapply(acc, _mm256_loadu_ps(sptr));
+                }
+            }
+            if (mode != Mode::MAX) {
+                acc = _mm256_div_ps(
+                        acc, _mm256_set1_ps(get_divisor(
+                                     mode, s, (ih1 - ih0) * (iw1 - iw0))));
+            }
+            _mm256_storeu_ps(dst + (oh * s.OW + ow) * 8, acc);
+        }
+    }
+}
+
+MEGDNN_ATTRIBUTE_TARGET("avx2")
+void reduce_rows_max_s8(const int8_t* src, size_t IW, size_t ih0, size_t ih1,
+                        int8_t* row_buf) {
+    if (ih0 == ih1) {
+        std::fill(row_buf, row_buf + IW, std::numeric_limits<int8_t>::min());
+        return;
+    }
+    const int8_t* sptr = src + ih0 * IW;
+    size_t iw = 0;
+    for (; iw + 32 <= IW; iw += 32) {
+        __m256i acc = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(sptr + iw));
+        for (size_t ih = ih0 + 1; ih < ih1; ++ih) {
+            acc = _mm256_max_epi8(acc,
+                                  _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+                                          src + ih * IW + iw)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(row_buf + iw), acc);
+    }
+    for (; iw < IW; ++iw) {
+        int8_t acc = sptr[iw];
+        for (size_t ih = ih0 + 1; ih < ih1; ++ih) {
+            acc = std::max(acc, src[ih * IW + iw]);
+        }
+        row_buf[iw] = acc;
+    }
+}
+
+int8_t reduce_cols_max_s8(const int8_t* row_buf, const GenericPoolingShape& s,
+                          size_t ow) {
+    size_t iw0, iw1;
+    get_valid_range(static_cast<ptrdiff_t>(ow * s.SW) -
+                            static_cast<ptrdiff_t>(s.PW),
+                    s.FW, s.IW, iw0, iw1);
+    int8_t acc = std::numeric_limits<int8_t>::min();
+    for (size_t iw = iw0; iw < iw1; ++iw) {
+        acc = std::max(acc, row_buf[iw]);
+    }
+    return acc;
+}
+
+//! mean of an int8 window with the rounding of the naive implementation
+int8_t get_mean_s8(int32_t sum, int32_t count, bool round_nearest) {
+    int32_t ans = round_nearest ? static_cast<int32_t>(std::round(
+                                          static_cast<float>(sum) / count))
+                                : sum / count;
+    return std::min<int32_t>(std::max<int32_t>(ans, INT8_MIN), INT8_MAX);
+}
+
+/*!
+ * \brief vectorized get_mean_s8 on 8 sums; the 8 means are returned in the
+ *      low 64 bits
+ *
+ * The quotient is computed in float, which gives the same truncation as the
+ * integer division since the sums of int8 windows are far below 2^24.
+ */
+MEGDNN_ATTRIBUTE_TARGET("avx2")
+__m128i get_mean_s8(__m256i sum, __m256 count, bool round_nearest) {
+    __m256 q = _mm256_div_ps(_mm256_cvtepi32_ps(sum), count);
+    __m256 t = _mm256_round_ps(q, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    if (round_nearest) {
+        __m256 sign_mask = _mm256_set1_ps(-0.f);
+        __m256 frac = _mm256_andnot_ps(sign_mask, _mm256_sub_ps(q, t));
+        __m256 away = _mm256_cmp_ps(frac, _mm256_set1_ps(0.5f), _CMP_GE_OQ);
+        __m256 one = _mm256_or_ps(_mm256_and_ps(q, sign_mask),
+                                  _mm256_set1_ps(1.f));
+        t = _mm256_add_ps(t, _mm256_and_ps(away, one));
+    }
+    __m256i v = _mm256_cvttps_epi32(t);
+    __m128i v16 = _mm_packs_epi32(_mm256_castsi256_si128(v),
+                                  _mm256_extracti128_si256(v, 1));
+    return _mm_packs_epi16(v16, v16);
+}
+
+MEGDNN_ATTRIBUTE_TARGET("avx2")
+__m256i load_s8_as_s32(const int8_t* ptr) {
+    return _mm256_cvtepi8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr)));
+}
+
+MEGDNN_ATTRIBUTE_TARGET("avx2")
+void reduce_rows_sum_s8(const int8_t* src, size_t IW, size_t ih0, size_t ih1,
+                        int32_t* row_buf) {
+    std::fill(row_buf, row_buf + IW, 0);
+    size_t iw = 0;
+    for (; iw + 8 <= IW; iw += 8) {
+        __m256i acc = _mm256_setzero_si256();
+        for (size_t ih = ih0; ih < ih1; ++ih) {
+            acc = _mm256_add_epi32(acc, load_s8_as_s32(src + ih * IW + iw));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(row_buf + iw), acc);
+    }
+    for (; iw < IW; ++iw) {
+        for (size_t ih = ih0; ih < ih1; ++ih) {
+            row_buf[iw] += src[ih * IW + iw];
+        }
+    }
+}
+
+int8_t reduce_cols_avg_s8(const int32_t* row_buf, const GenericPoolingShape& s,
+                          size_t ow, Mode mode, bool round_nearest,
+                          size_t nr_rows) {
+    size_t iw0, iw1;
+    get_valid_range(static_cast<ptrdiff_t>(ow * s.SW) -
+                            static_cast<ptrdiff_t>(s.PW),
+                    s.FW, s.IW, iw0, iw1);
+    int32_t sum = 0;
+    for (size_t iw = iw0; iw < iw1; ++iw) {
+        sum += row_buf[iw];
+    }
+    return get_mean_s8(
+            sum,
+            static_cast<int32_t>(get_divisor(mode, s, nr_rows * (iw1 - iw0))),
+            round_nearest);
+}
+
+MEGDNN_ATTRIBUTE_TARGET("avx2")
+void do_pooling_nchw88_s8_max(const int8_t* src, int8_t* dst,
+                              const GenericPoolingShape& s) {
+    for (size_t oh = 0; oh < s.OH; ++oh) {
+        size_t ih0, ih1;
+        get_valid_range(static_cast<ptrdiff_t>(oh * s.SH) -
+                                static_cast<ptrdiff_t>(s.PH),
+                        s.FH, s.IH, ih0, ih1);
+        for (size_t ow = 0; ow < s.OW; ++ow) {
+            size_t iw0, iw1;
+            get_valid_range(static_cast<ptrdiff_t>(ow * s.SW) -
+                                    static_cast<ptrdiff_t>(s.PW),
+                            s.FW, s.IW, iw0, iw1);
+            __m128i acc = _mm_set1_epi8(INT8_MIN);
+            for (size_t ih = ih0; ih < ih1; ++ih) {
+                const int8_t* sptr = src + (ih * s.IW + iw0) * 8;
+                for (size_t iw = iw0; iw < iw1; ++iw, sptr += 8) {
+                    acc = _mm_max_epi8(
+                            acc, _mm_loadl_epi64(
+                                         reinterpret_cast<const __m128i*>(sptr)));
+                }
+            }
+            _mm_storel_epi64(
+                    reinterpret_cast<__m128i*>(dst + (oh * s.OW + ow) * 8),
+                    acc);
+        }
+    }
+}
+
+}  // anonymous namespace
+
+void x86::pooling_generic_f32_avx2(const float* src, float* dst,
+                                   const GenericPoolingShape& shape, Mode mode,
+                                   float* row_buf) {
+    if (mode == Mode::MAX) {
+        do_pooling_f32<MaxOpF32>(src, dst, shape, mode, row_buf);
+    } else {
+        do_pooling_f32<SumOpF32>(src, dst, shape, mode, row_buf);
+    }
+}
+
+void x86::max_pooling_generic_s8_avx2(const int8_t* src, int8_t* dst,
+                                      const GenericPoolingShape& s,
+                                      int8_t* row_buf) {
+    size_t ow_beg, ow_end;
+    get_interior_range(s, ow_beg, ow_end);
+    for (size_t oh = 0; oh < s.OH; ++oh) {
+        size_t ih0, ih1;
+        get_valid_range(static_cast<ptrdiff_t>(oh * s.SH) -
+                                static_cast<ptrdiff_t>(s.PH),
+                        s.FH, s.IH, ih0, ih1);
+        reduce_rows_max_s8(src, s.IW, ih0, ih1, row_buf);
+
+        int8_t* dptr = dst + oh * s.OW;
+        size_t ow = 0;
+        for (; ow < ow_beg; ++ow) {
+            dptr[ow] = reduce_cols_max_s8(row_buf, s, ow);
+        }
+        if (s.SW == 1) {
+            for (; ow + 32 <= ow_end; ow += 32) {
+                const int8_t* p = row_buf + ow - s.PW;
+                __m256i acc = _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(p));
+                for (size_t fw = 1; fw < s.FW; ++fw) {
+                    acc = _mm256_max_epi8(
+                            acc, _mm256_loadu_si256(
+                                         reinterpret_cast<const __m256i*>(
+                                                 p + fw)));
+                }
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dptr + ow),
+                                    acc);
+            }
+        }
+        for (; ow < s.OW; ++ow) {
+            dptr[ow] = reduce_cols_max_s8(row_buf, s, ow);
+        }
+    }
+}
+
+void x86::avg_pooling_generic_s8_avx2(const int8_t* src, int8_t* dst,
+                                      const GenericPoolingShape& s, Mode mode,
+                                      bool round_nearest, int32_t* row_buf) {
+    size_t ow_beg, ow_end;
+    get_interior_range(s, ow_beg, ow_end);
+    __m256i gather_idx = _mm256_setr_epi32(0, s.SW, 2 * s.SW, 3 * s.SW,
+                                           4 * s.SW, 5 * s.SW, 6 * s.SW,
+                                           7 * s.SW);
+    for (size_t oh = 0; oh < s.OH; ++oh) {
+        size_t ih0, ih1;
+        get_valid_range(static_cast<ptrdiff_t>(oh * s.SH) -
+                                static_cast<ptrdiff_t>(s.PH),
+                        s.FH, s.IH, ih0, ih1);
+        reduce_rows_sum_s8(src, s.IW, ih0, ih1, row_buf);
+
+        int8_t* dptr = dst + oh * s.OW;
+        size_t nr_rows = ih1 - ih0, ow = 0;
+        for (; ow < ow_beg; ++ow) {
+            dptr[ow] = reduce_cols_avg_s8(row_buf, s, ow, mode, round_nearest,
+                                          nr_rows);
+        }
+        __m256 vcount = _mm256_set1_ps(get_divisor(mode, s, nr_rows * s.FW));
+        for (; ow + 8 <= ow_end; ow += 8) {
+            const int32_t* p = row_buf + ow * s.SW - s.PW;
+            __m256i acc = _mm256_setzero_si256();
+            if (s.SW == 1) {
+                for (size_t fw = 0; fw < s.FW; ++fw) {
+                    acc = _mm256_add_epi32(
+                            acc, _mm256_loadu_si256(
+                                         reinterpret_cast<const __m256i*>(
+                                                 p + fw)));
+                }
+            } else {
+                for (size_t fw = 0; fw < s.FW; ++fw) {
+                    acc = _mm256_add_epi32(
+                            acc, _mm256_i32gather_epi32(
+                                         reinterpret_cast<const int*>(p + fw),
+                                         gather_idx, 4));
+                }
+            }
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dptr + ow),
+                             get_mean_s8(acc, vcount, round_nearest));
+        }
+        for (; ow < s.OW; ++ow) {
+            dptr[ow] = reduce_cols_avg_s8(row_buf, s, ow, mode, round_nearest,
+                                          nr_rows);
+        }
+    }
+}
+
+void x86::pooling_nchw88_f32_avx2(const float* src, float* dst,
+                                  const GenericPoolingShape& shape,
+                                  Mode mode) {
+    if (mode == Mode::MAX) {
+        do_pooling_nchw88_f32<MaxOpF32>(src, dst, shape, mode);
+    } else {
+        do_pooling_nchw88_f32<SumOpF32>(src, dst, shape, mode);
+    }
+}
+
+void x86::pooling_nchw88_s8_avx2(const int8_t* src, int8_t* dst,
+                                 const GenericPoolingShape& s, Mode mode,
+                                 bool round_nearest) {
+    if (mode == Mode::MAX) {
+        do_pooling_nchw88_s8_max(src, dst, s);
+        return;
+    }
+    for (size_t oh = 0; oh < s.OH; ++oh) {
+        size_t ih0, ih1;
+        get_valid_range(static_cast<ptrdiff_t>(oh * s.SH) -
+                                static_cast<ptrdiff_t>(s.PH),
+                        s.FH, s.IH, ih0, ih1);
+        for (size_t ow = 0; ow < s.OW; ++ow) {
+            size_t iw0, iw1;
+            get_valid_range(static_cast<ptrdiff_t>(ow * s.SW) -
+                                    static_cast<ptrdiff_t>(s.PW),
+                            s.FW, s.IW, iw0, iw1);
+            __m256i acc = _mm256_setzero_si256();
+            for (size_t ih = ih0; ih < ih1; ++ih) {
+                const int8_t* sptr = src + (ih * s.IW + iw0) * 8;
+                for (size_t iw = iw0; iw < iw1; ++iw, sptr += 8) {
+                    acc = _mm256_add_epi32(acc, load_s8_as_s32(sptr));
+                }
+            }
+            __m256 count = _mm256_set1_ps(
+                    get_divisor(mode, s, (ih1 - ih0) * (iw1 - iw0)));
+            _mm_storel_epi64(
+                    reinterpret_cast<__m128i*>(dst + (oh * s.OW + ow) * 8),
+                    get_mean_s8(acc, count, round_nearest));
+        }
+    }
+}
+
+// vim: syntax=cpp.doxygen
@@ -14,6 +14,7 @@
 #include "src/naive/handle.h"
 #include "src/x86/handle.h"
 #include "src/x86/pooling/do_max_pooling_3x3_s2x2_float_sse.h"
+#include "src/x86/pooling/generic_pooling.h"
 #include "src/x86/pooling/pooling_special_cases.h"
 #include "src/x86/utils.h"
 
@@ -45,6 +46,38 @@ WorkspaceBundle get_bundle(const TensorLayout& src, const TensorLayout& dst,
     return ws;
 }
 
+size_t get_nr_threads(Handle* handle) {
+    return static_cast<naive::HandleImpl*>(handle)
+            ->megcore_dispatcher()
+            ->nr_threads();
+}
+
+//! whether the generic int8 kernels can be used; Int8 average pooling
+//! excluding padding is accumulated in int8 by the naive implementation and
+//! is left to it
+bool is_generic_s8(const TensorLayout& src, param::Pooling::Mode mode) {
+    if (src.dtype.enumv() == DTypeEnum::QuantizedS8) {
+        return true;
+    }
+    return src.dtype.enumv() == DTypeEnum::Int8 &&
+           mode != param::Pooling::Mode::AVERAGE_COUNT_EXCLUDE_PADDING;
+}
+
+//! whether the generic AVX2 kernels can be used for given format
+bool use_generic(const TensorLayout& src, const param::Pooling& param,
+                 param::Pooling::Format format) {
+    if (!is_supported(SIMDType::AVX2) || param.format != format) {
+        return false;
+    }
+    return src.dtype == dtype::Float32() || is_generic_s8(src, param.mode);
+}
+
+//! size of the row buffer used by each thread in the generic NCHW kernels,
+//! which holds float or int32 values
+size_t get_row_buf_size(const TensorLayout& src) {
+    return get_aligned_power2<size_t>(src.shape[3] * sizeof(dt_int32), 64);
+}
+
 #if defined(MEGDNN_X86_WITH_MKL_DNN)
 template <dnnl::memory::format_tag format_tag, bool use_mkl_mem>
 dnnl::memory tensor_to_mkl_memory(_megdnn_tensor_in src,
@@ -88,7 +121,9 @@ size_t PoolingImpl::get_workspace_in_bytes(const TensorLayout& src,
         param().stride_h == 2 && param().stride_w == 2) {
         WorkspaceBundle ws = get_bundle(src, dst, param());
 
-        return ws.total_size_in_bytes();
+        return get_nr_threads(handle()) * ws.total_size_in_bytes();
+    } else if (use_generic(src, param(), Param::Format::NCHW)) {
+        return get_nr_threads(handle()) * get_row_buf_size(src);
     } else {
         return 0;
     }
@@ -107,17 +142,19 @@ void PoolingImpl::exec(_megdnn_tensor_in src, _megdnn_tensor_out dst,
     auto PH = param().pad_h, PW = param().pad_w;
     bool is_average = (mode == Mode::AVERAGE);
     bool is_include = true;
+    // each thread pools whole planes of N x C
     if (is_supported(SIMDType::AVX) && is_average &&
         param().format == Param::Format::NCHW &&
         src.layout.dtype == dtype::Float32() && FH == 2 && FW == 2 && SH == 2 &&
         SW == 2) {
         auto sptr = src.ptr<dt_float32>();
         auto dptr = dst.ptr<dt_float32>();
-        MEGDNN_DISPATCH_CPU_KERN_OPR(rep(n, N) rep(c, C) {
-            mean_pooling_w2x2_s2x2_avx(sptr + n * C * IH * IW + c * IH * IW, IH,
-                                       IW, dptr + n * C * OH * OW + c * OH * OW,
-                                       OH, OW, PH, PW, is_include);
-        });
+        auto kern = [=](size_t index, size_t) {
+            mean_pooling_w2x2_s2x2_avx(sptr + index * IH * IW, IH, IW,
+                                       dptr + index * OH * OW, OH, OW, PH, PW,
+                                       is_include);
+        };
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN_OPR(kern, N * C);
         return;
     }
     if (is_supported(SIMDType::SSE3) && is_average &&
@@ -126,12 +163,12 @@ void PoolingImpl::exec(_megdnn_tensor_in src, _megdnn_tensor_out dst,
         SH == 2 && SW == 2) {
         auto sptr = src.ptr<dt_float32>();
         auto dptr = dst.ptr<dt_float32>();
-        MEGDNN_DISPATCH_CPU_KERN_OPR(rep(n, N) rep(c, C) {
-            mean_pooling_w2x2_s2x2_sse3(sptr + n * C * IH * IW + c * IH * IW,
-                                        IH, IW,
-                                        dptr + n * C * OH * OW + c * OH * OW,
-                                        OH, OW, PH, PW, is_include);
-        });
+        auto kern = [=](size_t index, size_t) {
+            mean_pooling_w2x2_s2x2_sse3(sptr + index * IH * IW, IH, IW,
+                                        dptr + index * OH * OW, OH, OW, PH, PW,
+                                        is_include);
+        };
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN_OPR(kern, N * C);
         return;
     }
     if (is_supported(SIMDType::SSE) && src.layout.dtype == dtype::Float32() &&
@@ -139,11 +176,11 @@ void PoolingImpl::exec(_megdnn_tensor_in src, _megdnn_tensor_out dst,
         FW == 2 && SH == 2 && SW == 2) {
         auto sptr = src.ptr<dt_float32>();
         auto dptr = dst.ptr<dt_float32>();
-        MEGDNN_DISPATCH_CPU_KERN_OPR(rep(n, N) rep(c, C) {
-            max_pooling_w2x2_s2x2_sse(sptr + n * C * IH * IW + c * IH * IW, IH,
-                                      IW, dptr + n * C * OH * OW + c * OH * OW,
-                                      OH, OW, PH, PW);
-        });
+        auto kern = [=](size_t index, size_t) {
+            max_pooling_w2x2_s2x2_sse(sptr + index * IH * IW, IH, IW,
+                                      dptr + index * OH * OW, OH, OW, PH, PW);
+        };
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN_OPR(kern, N * C);
         return;
     }
     if (is_supported(SIMDType::SSE) && src.layout.dtype == dtype::Float32() &&
@@ -151,16 +188,83 @@ void PoolingImpl::exec(_megdnn_tensor_in src, _megdnn_tensor_out dst,
         FW == 3 && SH == 2 && SW == 2) {
         auto sptr = src.ptr<dt_float32>();
         auto dptr = dst.ptr<dt_float32>();
-        MEGDNN_DISPATCH_CPU_KERN_OPR(
+        // each thread uses its own copy of the workspace bundle
+        WorkspaceBundle ws = get_bundle(src.layout, dst.layout, param());
+        auto ws_size = ws.total_size_in_bytes();
+        auto ws_ptr = workspace.raw_ptr;
+        auto kern = [=](size_t index, size_t thread_id) {
+            WorkspaceBundle thread_ws = ws;
+            thread_ws.set(ws_ptr + thread_id * ws_size);
+            do_max_pooling_3x3_s2x2_float_SSE(sptr + index * IH * IW,
+                                              dptr + index * OH * OW, IH, IW,
+                                              OH, OW, PH, PW, thread_ws);
+        };
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN_OPR(kern, N * C);
+        return;
+    }
 
-                WorkspaceBundle ws =
-                        get_bundle(src.layout, dst.layout, param());
-                ws.set(workspace.raw_ptr); rep(n, N) rep(c, C) {
-                    do_max_pooling_3x3_s2x2_float_SSE(
-                            sptr + n * C * IH * IW + c * IH * IW,
-                            dptr + n * C * OH * OW + c * OH * OW, IH, IW, OH,
-                            OW, PH, PW, ws);
-                });
+    GenericPoolingShape shape{IH, IW, OH, OW, FH, FW, SH, SW, PH, PW};
+    bool round_nearest = src.layout.dtype.enumv() == DTypeEnum::QuantizedS8;
+    if (use_generic(src.layout, param(), Param::Format::NCHW)) {
+        // parallelize over N x C planes, each thread with its own row buffer
+        auto row_buf_size = get_row_buf_size(src.layout);
+        auto ws_ptr = workspace.raw_ptr;
+        if (src.layout.dtype == dtype::Float32()) {
+            auto sptr = src.ptr<dt_float32>();
+            auto dptr = dst.ptr<dt_float32>();
+            auto kern = [=](size_t index, size_t thread_id) {
+                pooling_generic_f32_avx2(
+                        sptr + index * IH * IW, dptr + index * OH * OW, shape,
+                        mode,
+                        reinterpret_cast<float*>(ws_ptr +
+                                                 thread_id * row_buf_size));
+            };
+            MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN_OPR(kern, N * C);
+        } else if (mode == Mode::MAX) {
+            auto sptr = static_cast<const int8_t*>(src.raw_ptr);
+            auto dptr = static_cast<int8_t*>(dst.raw_ptr);
+            auto kern = [=](size_t index, size_t thread_id) {
+                max_pooling_generic_s8_avx2(
+                        sptr + index * IH * IW, dptr + index * OH * OW, shape,
+                        reinterpret_cast<int8_t*>(ws_ptr +
+                                                  thread_id * row_buf_size));
+            };
+            MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN_OPR(kern, N * C);
+        } else {
+            auto sptr = static_cast<const int8_t*>(src.raw_ptr);
+            auto dptr = static_cast<int8_t*>(dst.raw_ptr);
+            auto kern = [=](size_t index, size_t thread_id) {
+                avg_pooling_generic_s8_avx2(
+                        sptr + index * IH * IW, dptr + index * OH * OW, shape,
+                        mode, round_nearest,
+                        reinterpret_cast<int32_t*>(ws_ptr +
+                                                   thread_id * row_buf_size));
+            };
+            MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN_OPR(kern, N * C);
+        }
+        return;
+    }
+    if (use_generic(src.layout, param(), Param::Format::NCHW88)) {
+        // C is the number of 8-channel blocks here
+        if (src.layout.dtype == dtype::Float32()) {
+            auto sptr = src.ptr<dt_float32>();
+            auto dptr = dst.ptr<dt_float32>();
+            auto kern = [=](size_t index, size_t) {
+                pooling_nchw88_f32_avx2(sptr + index * IH * IW * 8,
+                                        dptr + index * OH * OW * 8, shape,
+                                        mode);
+            };
+            MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN_OPR(kern, N * C);
+        } else {
+            auto sptr = static_cast<const int8_t*>(src.raw_ptr);
+            auto dptr = static_cast<int8_t*>(dst.raw_ptr);
+            auto kern = [=](size_t index, size_t) {
+                pooling_nchw88_s8_avx2(sptr + index * IH * IW * 8,
+                                       dptr + index * OH * OW * 8, shape, mode,
+                                       round_nearest);
+            };
+            MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN_OPR(kern, N * C);
+        }
         return;
     }
 
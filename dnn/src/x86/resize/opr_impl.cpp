@@ -40,7 +40,7 @@ void ResizeImpl::exec(_megdnn_tensor_in src, _megdnn_tensor_in dst,
     } else {
         megdnn_assert(param().format == param::Resize::Format::NHWC,
                       "invalid resize format");
-        MEGDNN_DISPATCH_CPU_KERN_OPR(resize_cv_exec(src, dst, param().imode));
+        resize_cv_exec(src, dst, param().imode, handle());
     }
 }
 
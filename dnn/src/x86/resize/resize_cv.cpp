@@ -64,12 +64,14 @@
 #include "src/x86/resize/opr_impl.h"
 #include "src/x86/resize/resize_cv.h"
 #include "src/x86/handle.h"
+#include "src/x86/utils.h"
 #include "src/common/cv/common.h"
 #include "src/common/cv/helper.h"
 
 #include "src/common/utils.h"
 #include <cstring>
 
+#include <immintrin.h>
 #include <pmmintrin.h>
 #include <smmintrin.h>
 #include <xmmintrin.h>
@@ -82,13 +84,16 @@ using namespace megcv;
 namespace {
 
 const int SCALE = 11;
+//! dst rows of each task when an image is split into row bands
+constexpr size_t MIN_ROWS_PER_BAND = 16;
 
 using InterpolationMode = param::Resize::InterpolationMode;
 using IMode = InterpolationMode;
 
 // nearest neighbor
 
-void resize_nearest_8u(const Mat8u &src, Mat8u &dst) {
+void resize_nearest_8u(const Mat8u &src, Mat8u &dst, int row_begin,
+                       int row_end) {
     AlignedVector<int> tabx(dst.rows());
     AlignedVector<int> taby(dst.cols());
     const double fx = static_cast<double>(dst.rows()) / src.rows();
@@ -109,10 +114,9 @@ void resize_nearest_8u(const Mat8u &src, Mat8u &dst) {
         taby[dy] = sy;
     }
 
-    int tabxsize = tabx.size();
     int tabysize = taby.size();
     if (ch == 1) {
-        for (int dx = 0; dx < tabxsize; ++dx) {
+        for (int dx = row_begin; dx < row_end; ++dx) {
             uchar *pdst = dst.ptr(dx);
             const uchar *psrc = src.ptr(tabx[dx]);
             for (int dy = 0; dy < tabysize; ++dy) {
@@ -122,7 +126,7 @@ void resize_nearest_8u(const Mat8u &src, Mat8u &dst) {
             }
         }
     } else if (ch == 3) {
-        for (int dx = 0; dx < tabxsize; ++dx) {
+        for (int dx = row_begin; dx < row_end; ++dx) {
             uchar *pdst = dst.ptr(dx);
             const uchar *psrc = src.ptr(tabx[dx]);
             int dy3 = 0;
@@ -138,7 +142,8 @@ void resize_nearest_8u(const Mat8u &src, Mat8u &dst) {
 }
 
 MEGDNN_ATTRIBUTE_TARGET("sse4.2")
-void resize_nearest_32f_SSE_4_2(const Mat32f &src, Mat32f &dst) {
+void resize_nearest_32f_SSE_4_2(const Mat32f &src, Mat32f &dst,
+                                int row_begin, int row_end) {
     AlignedVector<int> tabx(dst.rows());
     AlignedVector<int> taby(dst.cols());
     const double fx = static_cast<double>(dst.rows()) / src.rows();
@@ -162,7 +167,7 @@ void resize_nearest_32f_SSE_4_2(const Mat32f &src, Mat32f &dst) {
     }
 
     if (ch == 1) {
-        for (int dx = 0; dx < tabxsize; ++dx) {
+        for (int dx = row_begin; dx < row_end; ++dx) {
             float *pdst = dst.ptr(dx);
             const float *psrc = src.ptr(tabx[dx]);
             int dy = 0;
@@ -178,7 +183,7 @@ void resize_nearest_32f_SSE_4_2(const Mat32f &src, Mat32f &dst) {
             }
         }
     } else if (ch == 3) {
-        for (int dx = 0; dx < tabxsize; ++dx) {
+        for (int dx = row_begin; dx < row_end; ++dx) {
             float *pdst = dst.ptr(dx);
             const float *psrc = src.ptr(tabx[dx]);
             int dy3 = 0, dy = 0;
@@ -208,8 +213,9 @@ void resize_nearest_32f_SSE_4_2(const Mat32f &src, Mat32f &dst) {
     }
 }
 
-void resize_nearest_32f(const Mat32f &src, Mat32f &dst) {
-    return resize_nearest_32f_SSE_4_2(src, dst);
+void resize_nearest_32f(const Mat32f &src, Mat32f &dst, int row_begin,
+                        int row_end) {
+    return resize_nearest_32f_SSE_4_2(src, dst, row_begin, row_end);
 }
 
 // linear 32f
@@ -442,7 +448,8 @@ void calc_cache_linear_32fc3_2(const Mat32f &src, const Mat32f &dst,
 
 // MegCV original version:
 MEGDNN_ATTRIBUTE_TARGET("sse4.2")
-void resize_linear_32f_SSE_4_2(const Mat32f &src, Mat32f &dst) {
+void resize_linear_32f_SSE_4_2(const Mat32f &src, Mat32f &dst, int row_begin,
+                               int row_end) {
     AlignedVector<int> tabsx(dst.rows());
     AlignedVector<int> tabsy(dst.cols());
     AlignedVector<float> tabrx(dst.rows());
@@ -450,15 +457,14 @@ void resize_linear_32f_SSE_4_2(const Mat32f &src, Mat32f &dst) {
     build_tabs_linear_32f(src, dst, tabsx, tabsy, tabrx, tabry);
 
     if (src.channels() == 1) {
-        int dstrows = dst.rows();
         int dstcols = dst.cols();
         int bufstep =
             (int)align_size(dstcols, 16);  // aligned on a 16B boundary
         AlignedVector<float> cache0(bufstep), cache1(bufstep);
 
-        for (int dx = 0; dx < dstrows; ++dx) {
-            if (dx == 0 || tabsx[dx] != tabsx[dx - 1]) {
-                if (dx > 0 && tabsx[dx] == tabsx[dx - 1] + 1) {
+        for (int dx = row_begin; dx < row_end; ++dx) {
+            if (dx == row_begin || tabsx[dx] != tabsx[dx - 1]) {
+                if (dx > row_begin && tabsx[dx] == tabsx[dx - 1] + 1) {
                     calc_cache_linear_32fc1_1(src, dst, tabsx, tabsy, tabrx,
                                               tabry, dx, cache0, cache1);
                 } else {
@@ -499,14 +505,13 @@ void resize_linear_32f_SSE_4_2(const Mat32f &src, Mat32f &dst) {
             }
         }
     } else if (src.channels() == 3) {
-        int dstrows = dst.rows();
         int dstcols = dst.cols() * 3;
         int bufstep =
             (int)align_size(dstcols, 16);  // aligned on a 16B boundary
         AlignedVector<float> cache0(bufstep), cache1(bufstep);
-        for (int dx = 0; dx < dstrows; ++dx) {
-            if (dx == 0 || tabsx[dx] != tabsx[dx - 1]) {
-                if (dx > 0 && tabsx[dx] == tabsx[dx - 1] + 1) {
+        for (int dx = row_begin; dx < row_end; ++dx) {
+            if (dx == row_begin || tabsx[dx] != tabsx[dx - 1]) {
+                if (dx > row_begin && tabsx[dx] == tabsx[dx - 1] + 1) {
                     calc_cache_linear_32fc3_1(src, dst, tabsx, tabsy, tabrx,
                                               tabry, dx, cache0, cache1);
                 } else {
@@ -549,8 +554,9 @@ void resize_linear_32f_SSE_4_2(const Mat32f &src, Mat32f &dst) {
     }
 }
 
-void resize_linear_32f(const Mat32f &src, Mat32f &dst) {
-    return resize_linear_32f_SSE_4_2(src, dst);
+void resize_linear_32f(const Mat32f &src, Mat32f &dst, int row_begin,
+                       int row_end) {
+    return resize_linear_32f_SSE_4_2(src, dst, row_begin, row_end);
 }
 
 // linear 8u
@@ -762,148 +768,123 @@ void calc_cache_8uc3_2(const Mat8u &src, const Mat8u &dst,
     }
 }
 
+//! blend two cached rows into \p n pixels of dst: (rx * c1 + irx * c0) >> 22
 MEGDNN_ATTRIBUTE_TARGET("sse4.2")
-void resize_linear_8u_SSE_4_2(const Mat8u &src, Mat8u &dst) {
+void blend_rows_linear_8u_SSE_4_2(const int *cache0_ptr, const int *cache1_ptr,
+                                  int rx, uchar *pdst, int n) {
+    int irx = (1 << SCALE) - rx;
+    const int one = SCALE + SCALE;
+    int dy = 0;
+    __m128i v_rx = _mm_set1_epi32(rx);
+    __m128i v_irx = _mm_set1_epi32(irx);
+    for (; dy + 16 <= n; dy += 16) {
+        __m128i x0, x1, x2, x3, y0, y1, y2, y3;
+        x0 = _mm_load_si128((const __m128i *)(cache0_ptr + dy));
+        y0 = _mm_load_si128((const __m128i *)(cache1_ptr + dy));
+        x1 = _mm_load_si128((const __m128i *)(cache0_ptr + dy + 4));
+        y1 = _mm_load_si128((const __m128i *)(cache1_ptr + dy + 4));
+        x2 = _mm_load_si128((const __m128i *)(cache0_ptr + dy + 8));
+        y2 = _mm_load_si128((const __m128i *)(cache1_ptr + dy + 8));
+        x3 = _mm_load_si128((const __m128i *)(cache0_ptr + dy + 12));
+        y3 = _mm_load_si128((const __m128i *)(cache1_ptr + dy + 12));
+
+        x0 = _mm_add_epi32(_mm_mullo_epi32(y0, v_rx),
+                           _mm_mullo_epi32(x0, v_irx));
+        x1 = _mm_add_epi32(_mm_mullo_epi32(y1, v_rx),
+                           _mm_mullo_epi32(x1, v_irx));
+        x2 = _mm_add_epi32(_mm_mullo_epi32(y2, v_rx),
+                           _mm_mullo_epi32(x2, v_irx));
+        x3 = _mm_add_epi32(_mm_mullo_epi32(y3, v_rx),
+                           _mm_mullo_epi32(x3, v_irx));
+        x0 = _mm_srai_epi32(x0, one);
+        x1 = _mm_srai_epi32(x1, one);
+        x2 = _mm_srai_epi32(x2, one);
+        x3 = _mm_srai_epi32(x3, one);
+
+        x0 = _mm_packs_epi32(x0, x1);
+        x2 = _mm_packs_epi32(x2, x3);
+
+        _mm_storeu_si128((__m128i *)(pdst + dy), _mm_packus_epi16(x0, x2));
+    }
+
+    for (; dy < n; ++dy) {
+        pdst[dy] = (rx * cache1_ptr[dy] + irx * cache0_ptr[dy]) >> (one);
+    }
+}
+
+MEGDNN_ATTRIBUTE_TARGET("avx2")
+void blend_rows_linear_8u_AVX2(const int *cache0_ptr, const int *cache1_ptr,
+                               int rx, uchar *pdst, int n) {
+    int irx = (1 << SCALE) - rx;
+    const int one = SCALE + SCALE;
+    int dy = 0;
+    __m256i v_rx = _mm256_set1_epi32(rx);
+    __m256i v_irx = _mm256_set1_epi32(irx);
+    //! packs/packus work within 128-bit lanes, this restores the dword order
+    __m256i v_perm = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    for (; dy + 32 <= n; dy += 32) {
+        __m256i x[4];
+        for (int i = 0; i < 4; ++i) {
+            __m256i c0 = _mm256_loadu_si256(
+                    (const __m256i *)(cache0_ptr + dy + i * 8));
+            __m256i c1 = _mm256_loadu_si256(
+                    (const __m256i *)(cache1_ptr + dy + i * 8));
+            x[i] = _mm256_srai_epi32(
+                    _mm256_add_epi32(_mm256_mullo_epi32(c1, v_rx),
+                                     _mm256_mullo_epi32(c0, v_irx)),
+                    one);
+        }
+        __m256i x01 = _mm256_packs_epi32(x[0], x[1]);
+        __m256i x23 = _mm256_packs_epi32(x[2], x[3]);
+        __m256i out = _mm256_permutevar8x32_epi32(
+                _mm256_packus_epi16(x01, x23), v_perm);
+        _mm256_storeu_si256((__m256i *)(pdst + dy), out);
+    }
+    blend_rows_linear_8u_SSE_4_2(cache0_ptr + dy, cache1_ptr + dy, rx,
+                                 pdst + dy, n - dy);
+}
+
+template <int CH>
+void resize_linear_8u_impl(const Mat8u &src, Mat8u &dst, int row_begin,
+                           int row_end) {
     AlignedVector<int> tabsx(dst.rows());
     AlignedVector<int> tabsy(dst.cols());
     AlignedVector<int> tabrx(dst.rows());
     AlignedVector<int> tabry((int)align_size(dst.cols(), 16));
     build_tabs_linear_8u(src, dst, tabsx, tabsy, tabrx, tabry);
 
-    if (src.channels() == 1) {
-        int dstrows = dst.rows();
-        int dstcols = dst.cols();
-        int bufstep =
-            (int)align_size(dstcols, 16);  // aligned on a 16B boundary
-        AlignedVector<int> cache0(bufstep), cache1(bufstep);
-
-        for (int dx = 0; dx < dstrows; ++dx) {
-            if (dx == 0 || tabsx[dx] != tabsx[dx - 1]) {
-                if (dx > 0 && tabsx[dx] == tabsx[dx - 1] + 1) {
-                    calc_cache_8uc1_1(src, dst, tabsx, tabsy, tabrx, tabry, dx,
-                                      cache0, cache1);
-                } else {
-                    calc_cache_8uc1_2(src, dst, tabsx, tabsy, tabrx, tabry, dx,
-                                      cache0, cache1);
-                }
-            }
-            int rx = tabrx[dx];
-            int irx = (1 << SCALE) - rx;
-            const int one = SCALE + SCALE;
-            uchar *pdst = dst.ptr(dx);
-            int dy = 0;
-
-            int *cache0_ptr = cache0.data();
-            int *cache1_ptr = cache1.data();
-            __m128i v_rx = _mm_set1_epi32(rx);
-            __m128i v_irx = _mm_set1_epi32(irx);
-            for (; dy + 16 <= dstcols; dy += 16) {
-                __m128i x0, x1, x2, x3, y0, y1, y2, y3;
-                x0 = _mm_load_si128((const __m128i *)(cache0_ptr + dy));
-                y0 = _mm_load_si128((const __m128i *)(cache1_ptr + dy));
-                x1 = _mm_load_si128((const __m128i *)(cache0_ptr + dy + 4));
-                y1 = _mm_load_si128((const __m128i *)(cache1_ptr + dy + 4));
-                x2 = _mm_load_si128((const __m128i *)(cache0_ptr + dy + 8));
-                y2 = _mm_load_si128((const __m128i *)(cache1_ptr + dy + 8));
-                x3 = _mm_load_si128((const __m128i *)(cache0_ptr + dy + 12));
-                y3 = _mm_load_si128((const __m128i *)(cache1_ptr + dy + 12));
-
-                x0 = _mm_add_epi32(_mm_mullo_epi32(y0, v_rx),
-                                   _mm_mullo_epi32(x0, v_irx));
-                x1 = _mm_add_epi32(_mm_mullo_epi32(y1, v_rx),
-                                   _mm_mullo_epi32(x1, v_irx));
-                x2 = _mm_add_epi32(_mm_mullo_epi32(y2, v_rx),
-                                   _mm_mullo_epi32(x2, v_irx));
-                x3 = _mm_add_epi32(_mm_mullo_epi32(y3, v_rx),
-                                   _mm_mullo_epi32(x3, v_irx));
-                x0 = _mm_srai_epi32(x0, one);
-                x1 = _mm_srai_epi32(x1, one);
-                x2 = _mm_srai_epi32(x2, one);
-                x3 = _mm_srai_epi32(x3, one);
-
-                x0 = _mm_packs_epi32(x0, x1);
-                x2 = _mm_packs_epi32(x2, x3);
-
-                _mm_storeu_si128((__m128i *)(pdst + dy),
-                                 _mm_packus_epi16(x0, x2));
-            }
-
-            for (; dy < dstcols; ++dy) {
-                uchar *pcdst = pdst + dy;
-                pcdst[0] = (rx * cache1[dy] + irx * cache0[dy]) >> (one);
+    auto calc_cache_1 = CH == 1 ? calc_cache_8uc1_1 : calc_cache_8uc3_1;
+    auto calc_cache_2 = CH == 1 ? calc_cache_8uc1_2 : calc_cache_8uc3_2;
+    auto blend = x86::is_supported(x86::SIMDType::AVX2) ? blend_rows_linear_8u_AVX2
+                                              : blend_rows_linear_8u_SSE_4_2;
+    int dstcols = dst.cols() * CH;
+    int bufstep = (int)align_size(dstcols, 16);  // aligned on a 16B boundary
+    AlignedVector<int> cache0(bufstep), cache1(bufstep);
+    for (int dx = row_begin; dx < row_end; ++dx) {
+        if (dx == row_begin || tabsx[dx] != tabsx[dx - 1]) {
+            if (dx > row_begin && tabsx[dx] == tabsx[dx - 1] + 1) {
+                calc_cache_1(src, dst, tabsx, tabsy, tabrx, tabry, dx, cache0,
+                             cache1);
+            } else {
+                calc_cache_2(src, dst, tabsx, tabsy, tabrx, tabry, dx, cache0,
+                             cache1);
             }
         }
-    } else if (src.channels() == 3) {
-        int dstrows = dst.rows();
-        int dstcols = dst.cols() * 3;
-        int bufstep =
-            (int)align_size(dstcols, 16);  // aligned on a 16B boundary
-        AlignedVector<int> cache0(bufstep), cache1(bufstep);
-        for (int dx = 0; dx < dstrows; ++dx) {
-            if (dx == 0 || tabsx[dx] != tabsx[dx - 1]) {
-                if (dx > 0 && tabsx[dx] == tabsx[dx - 1] + 1) {
-                    calc_cache_8uc3_1(src, dst, tabsx, tabsy, tabrx, tabry, dx,
-                                      cache0, cache1);
-                } else {
-                    calc_cache_8uc3_2(src, dst, tabsx, tabsy, tabrx, tabry, dx,
-                                      cache0, cache1);
-                }
-            }
-            int rx = tabrx[dx];
-            int irx = (1 << SCALE) - rx;
-            const int one = SCALE + SCALE;
-            uchar *pdst = dst.ptr(dx);
-            int dy = 0;
-
-            int *cache0_ptr = cache0.data();
-            int *cache1_ptr = cache1.data();
-            __m128i v_rx = _mm_set1_epi32(rx);
-            __m128i v_irx = _mm_set1_epi32(irx);
-            for (; dy + 16 <= dstcols; dy += 16) {
-                __m128i x0, x1, x2, x3, y0, y1, y2, y3;
-                x0 = _mm_load_si128((const __m128i *)(cache0_ptr + dy));
-                y0 = _mm_load_si128((const __m128i *)(cache1_ptr + dy));
-                x1 = _mm_load_si128((const __m128i *)(cache0_ptr + dy + 4));
-                y1 = _mm_load_si128((const __m128i *)(cache1_ptr + dy + 4));
-                x2 = _mm_load_si128((const __m128i *)(cache0_ptr + dy + 8));
-                y2 = _mm_load_si128((const __m128i *)(cache1_ptr + dy + 8));
-                x3 = _mm_load_si128((const __m128i *)(cache0_ptr + dy + 12));
-                y3 = _mm_load_si128((const __m128i *)(cache1_ptr + dy + 12));
-
-                x0 = _mm_add_epi32(_mm_mullo_epi32(y0, v_rx),
-                                   _mm_mullo_epi32(x0, v_irx));
-                x1 = _mm_add_epi32(_mm_mullo_epi32(y1, v_rx),
-                                   _mm_mullo_epi32(x1, v_irx));
-                x2 = _mm_add_epi32(_mm_mullo_epi32(y2, v_rx),
-                                   _mm_mullo_epi32(x2, v_irx));
-                x3 = _mm_add_epi32(_mm_mullo_epi32(y3, v_rx),
-                                   _mm_mullo_epi32(x3, v_irx));
-                x0 = _mm_srai_epi32(x0, one);
-                x1 = _mm_srai_epi32(x1, one);
-                x2 = _mm_srai_epi32(x2, one);
-                x3 = _mm_srai_epi32(x3, one);
-
-                x0 = _mm_packs_epi32(x0, x1);
-                x2 = _mm_packs_epi32(x2, x3);
-
-                _mm_storeu_si128((__m128i *)(pdst + dy),
-                                 _mm_packus_epi16(x0, x2));
-            }
+        blend(cache0.data(), cache1.data(), tabrx[dx], dst.ptr(dx), dstcols);
+    }
+}
 
-            for (; dy < dstcols; ++dy) {
-                uchar *pcdst = pdst + dy;
-                pcdst[0] = (rx * cache1[dy] + irx * cache0[dy]) >> (one);
-            }
-        }
+void resize_linear_8u(const Mat8u &src, Mat8u &dst, int row_begin,
+                      int row_end) {
+    if (src.channels() == 1) {
+        resize_linear_8u_impl<1>(src, dst, row_begin, row_end);
+    } else if (src.channels() == 3) {
+        resize_linear_8u_impl<3>(src, dst, row_begin, row_end);
     } else {
         megdnn_throw(("nr. of channels must be 1 or 3."));
     }
 }
 
-void resize_linear_8u(const Mat8u &src, Mat8u &dst) {
-    return resize_linear_8u_SSE_4_2(src, dst);
-}
-
 const int INTER_RESIZE_COEF_BITS = 11;
 const int INTER_RESIZE_COEF_SCALE = 1 << INTER_RESIZE_COEF_BITS;
 const float MEGCV_PI = acos(-1);
@@ -1424,16 +1405,18 @@ struct DecimateAlpha {
 template <typename T>
 using ResizeFunc = void (*)(const Mat<T> &src, Mat<T> &dst, const int *xofs,
                             const void *alpha, const int *yofs,
-                            const void *beta, int xmin, int xmax, int ksize);
+                            const void *beta, int xmin, int xmax, int ksize,
+                            int row_begin, int row_end);
 template <typename T>
 using ResizeAreaFastFunc = void (*)(const Mat<T> &src, Mat<T> &dst,
                                     const int *ofs, const int *xofs,
-                                    int scale_x, int scale_y);
+                                    int scale_x, int scale_y, int row_begin,
+                                    int row_end);
 template <typename T>
 using ResizeAreaFunc = void (*)(const Mat<T> &src, Mat<T> &dst,
                                 const DecimateAlpha *xtab, int xtab_size,
                                 const DecimateAlpha *ytab, int ytab_size,
-                                const int *yofs);
+                                const int *yofs, int row_begin, int row_end);
 
 static inline void interpolate_cubic(float x, float *coeffs) {
     const float A = -0.75f;
@@ -1782,17 +1765,17 @@ struct VResizeLinear<uchar, int, short,
 template <class HResize, class VResize, class MT>
 void resizeGeneric_(const Mat<MT> &src, Mat<MT> &dst, const int *xofs,
                     const void *_alpha, const int *yofs, const void *_beta,
-                    int xmin, int xmax, int ksize) {
+                    int xmin, int xmax, int ksize, int row_begin,
+                    int row_end) {
     typedef typename HResize::value_type T;
     typedef typename HResize::buf_type WT;
     typedef typename HResize::alpha_type AT;
 
-    const AT *beta = static_cast<const AT *>(_beta);
+    const AT *beta = static_cast<const AT *>(_beta) + row_begin * ksize;
     const AT *alpha = static_cast<const AT *>(_alpha);
     int swidth = src.width();
     int sheight = src.height();
     int dwidth = dst.width();
-    int dheight = dst.height();
     int cn = src.channels();
     swidth *= cn;
     dwidth *= cn;
@@ -1816,7 +1799,7 @@ void resizeGeneric_(const Mat<MT> &src, Mat<MT> &dst, const int *xofs,
         rows[k] = buffer + bufstep * k;
     }
 
-    for (dy = 0; dy < dheight; ++dy, beta += ksize) {
+    for (dy = row_begin; dy < row_end; ++dy, beta += ksize) {
         int sy0 = yofs[dy], k0 = ksize, k1 = 0, ksize2 = ksize / 2;
 
         for (int k = 0; k < ksize; ++k) {
@@ -1962,12 +1945,11 @@ int compute_resize_area_tab(int ssize, int dsize, int cn, double scale,
 // resize Area Fast
 template <typename T, typename WT, typename VecOp>
 void resizeAreaFast_(const Mat<T> &src, Mat<T> &dst, const int *ofs,
-                     const int *xofs, int scale_x, int scale_y) {
-    // Range range(0, dst.rows);
+                     const int *xofs, int scale_x, int scale_y, int row_begin,
+                     int row_end) {
     int swidth = src.width();
     int sheight = src.height();
     int dwidth = dst.width();
-    int dheight = dst.height();
     int cn = src.channels();
     int area = scale_x * scale_y;
     float scale = 1.f / (area);
@@ -1978,7 +1960,7 @@ void resizeAreaFast_(const Mat<T> &src, Mat<T> &dst, const int *ofs,
 
     VecOp vop(scale_x, scale_y, src.channels(), (int)src.step());
 
-    for (dy = 0; dy < dheight; dy++) {
+    for (dy = row_begin; dy < row_end; dy++) {
         T *D = (T *)(dst.ptr(dy));
         int sy0 = dy * scale_y;
         int w = sy0 + scale_y <= sheight ? dwidth1 : 0;
@@ -2112,18 +2094,16 @@ template <typename T, typename WT>
 static void resizeArea_(const Mat<T> &src, Mat<T> &dst,
                         const DecimateAlpha *xtab, int xtab_size,
                         const DecimateAlpha *ytab, int ytab_size,
-                        const int *tabofs) {
-    // parallel_for_(Range(0, dst.rows),
-    // ResizeArea_Invoker<T, WT>(src, dst, xtab, xtab_size, ytab, ytab_size,
-    // tabofs),
-    // dst.total()/((double)(1 << 16)));
+                        const int *tabofs, int row_begin, int row_end) {
+    //! ytab entries of dst row dy are in [tabofs[dy], tabofs[dy + 1]), so
+    //! the rows in [row_begin, row_end) can be computed independently
     (void)ytab_size;
-    int dwidth = dst.width(), dheight = dst.height();
+    int dwidth = dst.width();
     int cn = dst.channels();
     dwidth *= cn;
     AlignedVector<WT> _buffer(dwidth * 2);
     WT *buf = _buffer.data(), *sum = buf + dwidth;
-    int j_start = tabofs[0], j_end = tabofs[dheight], j, k, dx,
+    int j_start = tabofs[row_begin], j_end = tabofs[row_end], j, k, dx,
         prev_dy = ytab[j_start].di;
 
     for (dx = 0; dx < dwidth; dx++) sum[dx] = (WT)0;
@@ -2193,7 +2173,8 @@ ResizeAreaFunc<uchar> get_resize_area_func<uchar>() {
 }
 
 template <typename T>
-void resize_opencv(const Mat<T> &src, Mat<T> &dst, InterpolationMode ip) {
+void resize_opencv(const Mat<T> &src, Mat<T> &dst, InterpolationMode ip,
+                   int row_begin, int row_end) {
     // fake area mode missing here
     int dwidth = dst.width();
     int dheight = dst.height();
@@ -2234,7 +2215,8 @@ void resize_opencv(const Mat<T> &src, Mat<T> &dst, InterpolationMode ip) {
                     sx = iscale_x * j;
                     for (k = 0; k < cn; ++k) xofs[j + k] = sx + k;
                 }
-                func(src, dst, ofs, xofs, iscale_x, iscale_y);
+                func(src, dst, ofs, xofs, iscale_x, iscale_y, row_begin,
+                     row_end);
                 return;
             }
             ResizeAreaFunc<T> func = get_resize_area_func<T>();
@@ -2253,7 +2235,8 @@ void resize_opencv(const Mat<T> &src, Mat<T> &dst, InterpolationMode ip) {
                 }
             }
             tabofs[dy] = ytab_size;
-            func(src, dst, xtab, xtab_size, ytab, ytab_size, tabofs);
+            func(src, dst, xtab, xtab_size, ytab, ytab_size, tabofs,
+                 row_begin, row_end);
             return;
         }
     }
@@ -2363,59 +2346,65 @@ void resize_opencv(const Mat<T> &src, Mat<T> &dst, InterpolationMode ip) {
     func(src, dst, xofs,
          fixedpt ? static_cast<void *>(ialpha) : static_cast<void *>(alpha),
          yofs, fixedpt ? static_cast<void *>(ibeta) : static_cast<void *>(beta),
-         xmin, xmax, ksize);
+         xmin, xmax, ksize, row_begin, row_end);
 }
 
 }  // anonymous namespace
 
 void megdnn::x86::resize_cv_exec(_megdnn_tensor_in src,
                                    _megdnn_tensor_out dst,
-                                   param::Resize::InterpolationMode imode) {
+                                   param::Resize::InterpolationMode imode,
+                                   Handle* handle) {
     megdnn_assert(src.layout[3] == 1 || src.layout[3] == 3,
                   "unsupported src channel");
-    for (size_t i = 0; i < src.layout.shape[0]; ++i) {
-        if (dst.layout.dtype == dtype::Float32()) {
-            Mat<float> src_mat = TensorND2Mat<float>(src, i);
-            Mat<float> dst_mat = TensorND2Mat<float>(dst, i);
-            switch (imode) {
-                case IMode::INTER_NEAREST:
-                    resize_nearest_32f(src_mat, dst_mat);
-                    break;
-                case IMode::INTER_LINEAR:
-                    resize_linear_32f(src_mat, dst_mat);
-                    break;
-                case IMode::INTER_CUBIC:
-                case IMode::INTER_LANCZOS4:
-                case IMode::INTER_AREA:
-                    resize_opencv<float>(src_mat, dst_mat, imode);
-                    break;
-                default:
-                    megdnn_throw("unsupported interpolation mode");
-                    break;
-            }
-        } else if (dst.layout.dtype == dtype::Uint8()) {
-            Mat<uchar> src_mat = TensorND2Mat<uchar>(src, i);
-            Mat<uchar> dst_mat = TensorND2Mat<uchar>(dst, i);
-            switch (imode) {
-                case IMode::INTER_NEAREST:
-                    resize_nearest_8u(src_mat, dst_mat);
-                    break;
-                case IMode::INTER_LINEAR:
-                    resize_linear_8u(src_mat, dst_mat);
-                    break;
-                case IMode::INTER_CUBIC:
-                case IMode::INTER_LANCZOS4:
-                case IMode::INTER_AREA:
-                    resize_opencv<uchar>(src_mat, dst_mat, imode);
-                    break;
-                default:
-                    megdnn_throw("unsupported interpolation mode");
-                    break;
-            }
-        } else {
-            megdnn_throw(megdnn_mangle("Unsupported datatype of resize optr."));
-        }
+    const size_t batch = dst.layout.shape[0], dst_rows = dst.layout.shape[1];
+    size_t nr_bands = 1;
+    size_t nr_threads = static_cast<naive::HandleImpl*>(handle)
+                                ->megcore_dispatcher()
+                                ->nr_threads();
+    if (batch < nr_threads) {
+        nr_bands = std::min(div_ceil(nr_threads, batch),
+                            div_ceil(dst_rows, MIN_ROWS_PER_BAND));
+    }
+    size_t band_rows = div_ceil(dst_rows, nr_bands);
+    nr_bands = div_ceil(dst_rows, band_rows);
+
+#define cb(_T, _nearest, _linear)                                              \
+    auto task = [src, dst, imode, nr_bands, band_rows](size_t index, size_t) { \
+        size_t batch_id = index / nr_bands, band_id = index % nr_bands;       \
+        Mat<_T> src_mat = TensorND2Mat<_T>(src, batch_id);                    \
+        Mat<_T> dst_mat = TensorND2Mat<_T>(dst, batch_id);                    \
+        int row_begin = band_id * band_rows;                                  \
+        int row_end = std::min(row_begin + band_rows, dst_mat.rows());        \
+        switch (imode) {                                                      \
+            case IMode::INTER_NEAREST:                                        \
+                _nearest(src_mat, dst_mat, row_begin, row_end);               \
+                break;                                                        \
+            case IMode::INTER_LINEAR:                                         \
+                _linear(src_mat, dst_mat, row_begin, row_end);                \
+                break;                                                        \
+            case IMode::INTER_CUBIC:                                          \
+            case IMode::INTER_LANCZOS4:                                       \
+            case IMode::INTER_AREA:                                           \
+                resize_opencv<_T>(src_mat, dst_mat, imode, row_begin,         \
+                                  row_end);                                   \
+                break;                                                        \
+            default:                                                          \
+                megdnn_throw("unsupported interpolation mode");               \
+                break;                                                        \
+        }                                                                     \
+    };                                                                        \
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(                                    \
+            static_cast<naive::HandleImpl*>(handle), batch* nr_bands, task);
+
+    if (dst.layout.dtype == dtype::Float32()) {
+        cb(float, resize_nearest_32f, resize_linear_32f)
+    } else if (dst.layout.dtype == dtype::Uint8()) {
+        cb(uchar, resize_nearest_8u, resize_linear_8u)
+    } else {
+        megdnn_throw(megdnn_mangle("Unsupported datatype of resize optr."));
     }
+#undef cb
 }
 
 // vim: syntax=cpp.doxygen
@@ -19,9 +19,12 @@ namespace x86 {
 /**
  * \fn resize_cv_exec
  * \brief Used if the format is NHWC, transfer from megcv
+ *
+ * Images are split into row bands when the batch is smaller than the number
+ * of threads, and each band is a task of the CPU dispatcher.
  */
 void resize_cv_exec(_megdnn_tensor_in src, _megdnn_tensor_out dst,
-                    param::Resize::InterpolationMode imode);
+                    param::Resize::InterpolationMode imode, Handle* handle);
 
 }  // namespace naive
 }  // namespace megdnn
@@ -11,12 +11,96 @@
 
 #include "src/x86/type_cvt/opr_impl.h"
 #include <immintrin.h>
+#include "src/naive/handle.h"
 #include "src/x86/elemwise_helper/kimpl/typecvt.h"
 #include "src/x86/elemwise_op.h"
 #include "src/x86/utils.h"
 
 using namespace megdnn;
 using namespace x86;
+
+namespace {
+
+//! tensors smaller than this are converted in a single task
+constexpr size_t MIN_ELEMS_PER_TASK = 16384;
+
+/*!
+ * \brief view src and dst as nr_rows rows of row_len elements, where each
+ *      row is contiguous in both tensors
+ *
+ * Rows are addressed by decomposing the row index over the leading
+ * (non-collapsed) dims, so arbitrary strides on those dims are supported.
+ */
+struct RowBlocking {
+    size_t nr_rows = 1, row_len = 0, nr_outer_dims = 0;
+    size_t shape[TensorLayout::MAX_NDIM];
+    ptrdiff_t src_stride[TensorLayout::MAX_NDIM],
+            dst_stride[TensorLayout::MAX_NDIM];
+
+    //! return false if the innermost dim is not contiguous in both tensors
+    bool init(const TensorLayout& src, const TensorLayout& dst) {
+        megdnn_assert(src.ndim == dst.ndim);
+        size_t ndim = src.ndim;
+        row_len = 1;
+        while (ndim && src.stride[ndim - 1] ==
+                               static_cast<ptrdiff_t>(row_len) &&
+               dst.stride[ndim - 1] == static_cast<ptrdiff_t>(row_len)) {
+            row_len *= src.shape[ndim - 1];
+            --ndim;
+        }
+        // skip leading dims of size 1 whose stride may be arbitrary
+        while (ndim && src.shape[ndim - 1] == 1) {
+            --ndim;
+        }
+        if (row_len == 1 && ndim) {
+            return false;
+        }
+        nr_outer_dims = ndim;
+        nr_rows = 1;
+        for (size_t i = 0; i < ndim; ++i) {
+            shape[i] = src.shape[i];
+            src_stride[i] = src.stride[i];
+            dst_stride[i] = dst.stride[i];
+            nr_rows *= shape[i];
+        }
+        return true;
+    }
+
+    void get_offset(size_t row, ptrdiff_t& soff, ptrdiff_t& doff) const {
+        soff = doff = 0;
+        for (size_t i = nr_outer_dims; i; --i) {
+            size_t idx = row % shape[i - 1];
+            row /= shape[i - 1];
+            soff += idx * src_stride[i - 1];
+            doff += idx * dst_stride[i - 1];
+        }
+    }
+};
+
+/*!
+ * \brief convert elements in [begin, end) of the flattened tensor, calling
+ *      the vectorized \p run on each contiguous row segment
+ */
+template <typename stype, typename dtype, typename Run>
+void run_rows(const RowBlocking& blk, const stype* sptr, dtype* dptr,
+              size_t begin, size_t end, Run run) {
+    if (begin >= end) {
+        return;
+    }
+    size_t row = begin / blk.row_len, col = begin % blk.row_len;
+    while (begin < end) {
+        size_t len = std::min(blk.row_len - col, end - begin);
+        ptrdiff_t soff, doff;
+        blk.get_offset(row, soff, doff);
+        run(sptr + soff + col, dptr + doff + col, len);
+        begin += len;
+        ++row;
+        col = 0;
+    }
+}
+
+}  // anonymous namespace
+
 #define DISPATCH_CONVERT_TYPE                                                \
     DISPATCH_QUANTIZED(QuantizedS32, dt_qint32, Quantized8Asymm, dt_quint8); \
     DISPATCH_QUANTIZED(Quantized8Asymm, dt_quint8, Quantized8Asymm,          \
@@ -38,25 +122,52 @@ using namespace x86;
 void TypeCvtImpl::exec(_megdnn_tensor_in src, _megdnn_tensor_out dst) {
     DType src_dtype = src.layout.dtype;
     DType dst_dtype = dst.layout.dtype;
-    size_t nr_elems = src.layout.total_nr_elems();
+    RowBlocking blk;
     bool execed = false;
-    if (src.layout.is_contiguous() && dst.layout.is_contiguous()) {
-        if (is_supported(SIMDType::SSE4_2)) {
-            using namespace dtype;
-#define DISPATCH_QUANTIZED(_stype_enumv, _stype, _dtype_enumv, _dtype)     \
-    if (src_dtype.enumv() == DTypeTrait<_stype_enumv>::enumv &&            \
-        dst_dtype.enumv() == DTypeTrait<_dtype_enumv>::enumv) {            \
-        using op = TypeCvtOp<SIMDType::SSE4_2, _stype, _dtype>;            \
-        thin_function<void(const _stype*, _dtype*, DType, DType, size_t)>  \
-                run = OpCallerUnary<op, SIMDType::SSE4_2>::run;            \
-        MEGDNN_DISPATCH_CPU_KERN_OPR(run(src.compatible_ptr<_stype>(),     \
-                                         dst.compatible_ptr<_dtype>(),     \
-                                         src_dtype, dst_dtype, nr_elems)); \
-        execed = true;                                                     \
+    if (src.layout.eq_shape(dst.layout) && blk.init(src.layout, dst.layout) &&
+        is_supported(SIMDType::SSE4_2)) {
+        size_t nr_elems = blk.nr_rows * blk.row_len;
+        size_t nr_threads = static_cast<naive::HandleImpl*>(handle())
+                                    ->megcore_dispatcher()
+                                    ->nr_threads();
+        size_t nr_tasks = 1, task_size = nr_elems;
+        if (nr_threads > 1 && nr_elems >= MIN_ELEMS_PER_TASK) {
+            // keep blocks a multiple of the widest vector step
+            task_size = round_up<size_t>(div_ceil(nr_elems, nr_threads), 64);
+            nr_tasks = div_ceil(nr_elems, task_size);
+        }
+        bool use_avx2 = is_supported(SIMDType::AVX2);
+        using namespace dtype;
+#define DISPATCH_SIMD(_simd, _stype, _dtype)                                \
+    do {                                                                    \
+        using op = TypeCvtOp<_simd, _stype, _dtype>;                        \
+        auto sptr = src.compatible_ptr<_stype>();                           \
+        auto dptr = dst.compatible_ptr<_dtype>();                           \
+        auto kern = [=](size_t index, size_t) {                             \
+            size_t begin = index * task_size,                               \
+                   end = std::min(begin + task_size, nr_elems);             \
+            run_rows(blk, sptr, dptr, begin, end,                           \
+                     [=](const _stype* s, _dtype* d, size_t len) {          \
+                         OpCallerUnary<op, _simd>::run(s, d, src_dtype,     \
+                                                       dst_dtype, len);     \
+                     });                                                    \
+        };                                                                  \
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN_OPR(kern, nr_tasks);          \
+    } while (0)
+
+#define DISPATCH_QUANTIZED(_stype_enumv, _stype, _dtype_enumv, _dtype) \
+    if (src_dtype.enumv() == DTypeTrait<_stype_enumv>::enumv &&       \
+        dst_dtype.enumv() == DTypeTrait<_dtype_enumv>::enumv) {       \
+        if (use_avx2) {                                               \
+            DISPATCH_SIMD(SIMDType::AVX2, _stype, _dtype);            \
+        } else {                                                      \
+            DISPATCH_SIMD(SIMDType::SSE4_2, _stype, _dtype);          \
+        }                                                             \
+        execed = true;                                                \
     }
-            DISPATCH_CONVERT_TYPE
+        DISPATCH_CONVERT_TYPE
 #undef DISPATCH_QUANTIZED
-        }
+#undef DISPATCH_SIMD
     }
     if (!execed) {
         fallback::TypeCvtImpl::exec(src, dst);
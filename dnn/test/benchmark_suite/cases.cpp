@@ -0,0 +1,392 @@
+/**
+ * \file dnn/test/benchmark_suite/cases.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "test/benchmark_suite/suite.h"
+
+#include "megdnn/oprs.h"
+#include "test/common/benchmarker.h"
+#include "test/common/checker.h"
+#include "test/common/opr_algo_proxy.h"
+#include "test/common/rng.h"
+
+using namespace megdnn;
+using namespace test;
+using namespace bench;
+
+namespace {
+
+size_t parse_uint(const std::string& str) {
+    size_t pos;
+    auto ret = std::stoul(str, &pos);
+    megdnn_assert(pos == str.size(), "bad integer: %s", str.c_str());
+    return ret;
+}
+
+//! parse a shape like 1x64x56x56
+TensorShape parse_shape(const std::string& str) {
+    TensorShape ret;
+    size_t begin = 0;
+    while (begin <= str.size()) {
+        auto end = str.find('x', begin);
+        if (end == std::string::npos) {
+            end = str.size();
+        }
+        megdnn_assert(ret.ndim < TensorShape::MAX_NDIM, "bad shape: %s",
+                      str.c_str());
+        ret[ret.ndim++] = parse_uint(str.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return ret;
+}
+
+void check_nr_arg(const RunContext& ctx, size_t min, size_t max) {
+    auto nr = ctx.cs.args.size();
+    megdnn_assert(nr >= min && nr <= max, "bad number of args in case: %s",
+                  ctx.cs.spec().c_str());
+}
+
+double nr_bytes(const TensorLayoutArray& layouts) {
+    double ret = 0;
+    for (auto&& i : layouts) {
+        if (i.ndim) {
+            ret += i.span().dist_byte();
+        }
+    }
+    return ret;
+}
+
+/*!
+ * \brief measure each algorithm of a multi-algo opr
+ *
+ * The benchmarker should have been configured with param, dtype and rng.
+ */
+template <typename Opr>
+void run_algos(RunContext& ctx, Benchmarker<Opr>& benchmarker,
+               TensorLayoutArray layouts, double computation) {
+    auto opr = benchmarker.opr();
+    opr->param() = benchmarker.param();
+    OprProxy<Opr>::deduce_layout(opr, layouts);
+    auto memory = nr_bytes(layouts);
+    for (auto algo : OprAlgoProxy<Opr>::get_all_algorithms(opr, layouts)) {
+        if (!ctx.algo_accepted(algo->name())) {
+            continue;
+        }
+        benchmarker.set_before_exec_callback(AlgoChecker<Opr>(algo));
+        ctx.measure(algo->name(),
+                    [&]() { return benchmarker.execl(layouts); }, computation,
+                    memory);
+    }
+}
+
+//! measure an opr that only has its default implementation
+template <typename Opr>
+void run_default(RunContext& ctx, Benchmarker<Opr>& benchmarker,
+                 TensorLayoutArray layouts, double computation) {
+    if (!ctx.algo_accepted("default")) {
+        return;
+    }
+    auto opr = benchmarker.opr();
+    opr->param() = benchmarker.param();
+    OprProxy<Opr>::deduce_layout(opr, layouts);
+    auto memory = nr_bytes(layouts);
+    ctx.measure("default", [&]() { return benchmarker.execl(layouts); },
+                computation, memory);
+}
+
+template <typename Opr>
+std::unique_ptr<Benchmarker<Opr>> make_benchmarker(const RunContext& ctx) {
+    auto ret = std::make_unique<Benchmarker<Opr>>(ctx.handle);
+    ret->set_display(false).set_adaptive_benchmark(ctx.options.sample_secs);
+    return ret;
+}
+
+/* ======================= conv ======================= */
+
+// conv N IC H W OC FH FW [stride [pad [group]]]
+void run_conv(RunContext& ctx) {
+    check_nr_arg(ctx, 7, 10);
+    auto&& args = ctx.cs.args;
+    size_t N = parse_uint(args[0]), IC = parse_uint(args[1]),
+           H = parse_uint(args[2]), W = parse_uint(args[3]),
+           OC = parse_uint(args[4]), FH = parse_uint(args[5]),
+           FW = parse_uint(args[6]),
+           stride = args.size() > 7 ? parse_uint(args[7]) : 1,
+           pad = args.size() > 8 ? parse_uint(args[8]) : FH / 2,
+           group = args.size() > 9 ? parse_uint(args[9]) : 1;
+    megdnn_assert(IC % group == 0 && OC % group == 0);
+
+    param::ConvBias param;
+    param.stride_h = param.stride_w = stride;
+    param.pad_h = param.pad_w = pad;
+    param.nonlineMode = param::ConvBias::NonlineMode::IDENTITY;
+    TensorShape filter{OC, IC, FH, FW};
+    if (group > 1) {
+        param.sparse = param::ConvBias::Sparse::GROUP;
+        filter = {group, OC / group, IC / group, FH, FW};
+    }
+    size_t OH = (H + 2 * pad - FH) / stride + 1,
+           OW = (W + 2 * pad - FW) / stride + 1;
+    double computation = 2.0 * N * OC * OH * OW * IC / group * FH * FW;
+
+    auto benchmarker = make_benchmarker<ConvBias>(ctx);
+    benchmarker->set_param(param);
+    UniformIntRNG int_rng{-50, 50};
+    if (ctx.dtype == "qint8") {
+        benchmarker->set_dtype(0, dtype::QuantizedS8(2.5f))
+                .set_dtype(1, dtype::QuantizedS8(2.5f))
+                .set_dtype(2, dtype::QuantizedS32(6.25f))
+                .set_dtype(4, dtype::QuantizedS8(60.25f))
+                .set_rng(0, &int_rng)
+                .set_rng(1, &int_rng)
+                .set_rng(2, &int_rng);
+    }
+    auto layouts = benchmarker->make_layouts(
+            {{N, IC, H, W}, filter, {1, OC, 1, 1}, {}, {}});
+    run_algos(ctx, *benchmarker, layouts, computation);
+}
+
+/* ======================= matmul ======================= */
+
+// matmul M N K [transA transB]
+void run_matmul(RunContext& ctx) {
+    check_nr_arg(ctx, 3, 5);
+    auto&& args = ctx.cs.args;
+    size_t M = parse_uint(args[0]), N = parse_uint(args[1]),
+           K = parse_uint(args[2]);
+    param::MatrixMul param;
+    param.transposeA = args.size() > 3 && parse_uint(args[3]);
+    param.transposeB = args.size() > 4 && parse_uint(args[4]);
+
+    auto benchmarker = make_benchmarker<MatrixMul>(ctx);
+    benchmarker->set_param(param);
+    UniformIntRNG int_rng{-127, 127};
+    if (ctx.dtype == "int8") {
+        benchmarker->set_dtype(0, dtype::Int8())
+                .set_dtype(1, dtype::Int8())
+                .set_dtype(2, dtype::Int32())
+                .set_rng(0, &int_rng)
+                .set_rng(1, &int_rng);
+    }
+    TensorShape A = param.transposeA ? TensorShape{K, M} : TensorShape{M, K},
+                B = param.transposeB ? TensorShape{N, K} : TensorShape{K, N};
+    auto layouts = benchmarker->make_layouts({A, B, {}});
+    run_algos(ctx, *benchmarker, layouts, 2.0 * M * N * K);
+}
+
+/* ======================= elemwise ======================= */
+
+param::Elemwise::Mode parse_elemwise_mode(const std::string& name) {
+    using Mode = param::Elemwise::Mode;
+#define cb(_m)           \
+    if (name == #_m) {   \
+        return Mode::_m; \
+    }
+    cb(RELU) cb(ABS) cb(EXP) cb(TANH) cb(SIGMOID) cb(H_SWISH) cb(ADD) cb(MUL)
+    cb(MAX) cb(FUSE_ADD_RELU) cb(FUSE_ADD_SIGMOID) cb(FUSE_ADD_H_SWISH)
+    cb(FUSE_MUL_ADD3)
+#undef cb
+    megdnn_throw(ssprintf("unsupported elemwise mode: %s", name.c_str()));
+}
+
+// elemwise MODE shape0 [shape1 [shape2]]
+void run_elemwise(RunContext& ctx) {
+    check_nr_arg(ctx, 2, 4);
+    auto&& args = ctx.cs.args;
+    param::Elemwise param;
+    param.mode = parse_elemwise_mode(args[0]);
+    auto arity = ElemwiseForward::ModeTrait::from_mode(param.mode).arity;
+    megdnn_assert(args.size() == arity + 1,
+                  "elemwise %s requires %u inputs, got %zu", args[0].c_str(),
+                  arity, args.size() - 1);
+
+    auto benchmarker = make_benchmarker<ElemwiseForward>(ctx);
+    benchmarker->set_param(param);
+    TensorShapeArray shapes;
+    for (size_t i = 1; i < args.size(); ++i) {
+        shapes.push_back(parse_shape(args[i]));
+    }
+    shapes.emplace_back();
+    if (ctx.dtype == "int8") {
+        if (!ElemwiseForward::ModeTrait::from_mode(param.mode).allow_int) {
+            return;
+        }
+        UniformIntRNG int_rng{-10, 10};
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            benchmarker->set_dtype(i, dtype::Int8()).set_rng(i, &int_rng);
+        }
+        auto layouts = benchmarker->make_layouts(shapes);
+        return run_default(ctx, *benchmarker, layouts, 0);
+    }
+    auto layouts = benchmarker->make_layouts(shapes);
+    TensorLayout dst;
+    benchmarker->opr()->param() = param;
+    benchmarker->opr()->deduce_layout({layouts.begin(), layouts.end() - 1},
+                                      dst);
+    run_default(ctx, *benchmarker, layouts,
+                static_cast<double>(dst.total_nr_elems()) *
+                        std::max<size_t>(arity - 1, 1));
+}
+
+/* ======================= reduce ======================= */
+
+// reduce MODE shape axis
+void run_reduce(RunContext& ctx) {
+    check_nr_arg(ctx, 3, 3);
+    auto&& args = ctx.cs.args;
+    using Mode = param::Reduce::Mode;
+    param::Reduce param;
+    if (args[0] == "SUM") {
+        param.mode = Mode::SUM;
+    } else if (args[0] == "SUM_SQR") {
+        param.mode = Mode::SUM_SQR;
+    } else if (args[0] == "MEAN") {
+        param.mode = Mode::MEAN;
+    } else if (args[0] == "MAX") {
+        param.mode = Mode::MAX;
+    } else if (args[0] == "MIN") {
+        param.mode = Mode::MIN;
+    } else {
+        megdnn_throw(ssprintf("unsupported reduce mode: %s", args[0].c_str()));
+    }
+    auto shape = parse_shape(args[1]);
+    param.axis = parse_uint(args[2]);
+
+    auto benchmarker = make_benchmarker<ReduceForward>(ctx);
+    benchmarker->set_param(param);
+    auto layouts = benchmarker->make_layouts({shape, {}});
+    run_default(ctx, *benchmarker, layouts,
+                static_cast<double>(shape.total_nr_elems()));
+}
+
+/* ======================= relayout ======================= */
+
+// relayout shape perm, where perm is like 0,2,3,1
+void run_relayout(RunContext& ctx) {
+    check_nr_arg(ctx, 2, 2);
+    auto&& args = ctx.cs.args;
+    auto shape = parse_shape(args[0]);
+    std::vector<size_t> perm;
+    size_t begin = 0;
+    while (begin <= args[1].size()) {
+        auto end = std::min(args[1].find(',', begin), args[1].size());
+        perm.push_back(parse_uint(args[1].substr(begin, end - begin)));
+        begin = end + 1;
+    }
+    megdnn_assert(perm.size() == shape.ndim, "bad perm in case: %s",
+                  ctx.cs.spec().c_str());
+
+    auto benchmarker = make_benchmarker<RelayoutForward>(ctx);
+    DType dtype = ctx.dtype == "int8" ? DType{dtype::Int8()}
+                                      : DType{dtype::Float32()};
+    benchmarker->set_dtype(0, dtype).set_dtype(1, dtype);
+    UniformIntRNG int_rng{-127, 127};
+    if (ctx.dtype == "int8") {
+        benchmarker->set_rng(0, &int_rng);
+    }
+    auto src = TensorLayout{shape, dtype}.dimshuffle(perm);
+    TensorLayout dst{src, dtype};
+    run_default(ctx, *benchmarker, {src, dst}, 0);
+}
+
+/* ======================= pooling ======================= */
+
+// pooling MODE N C H W window [stride [pad]]
+void run_pooling(RunContext& ctx) {
+    check_nr_arg(ctx, 6, 8);
+    auto&& args = ctx.cs.args;
+    param::Pooling param;
+    if (args[0] == "MAX") {
+        param.mode = param::Pooling::Mode::MAX;
+    } else if (args[0] == "AVERAGE") {
+        param.mode = param::Pooling::Mode::AVERAGE;
+    } else {
+        megdnn_throw(ssprintf("unsupported pooling mode: %s", args[0].c_str()));
+    }
+    size_t N = parse_uint(args[1]), C = parse_uint(args[2]),
+           H = parse_uint(args[3]), W = parse_uint(args[4]),
+           window = parse_uint(args[5]);
+    param.window_h = param.window_w = window;
+    param.stride_h = param.stride_w =
+            args.size() > 6 ? parse_uint(args[6]) : window;
+    param.pad_h = param.pad_w = args.size() > 7 ? parse_uint(args[7]) : 0;
+
+    auto benchmarker = make_benchmarker<PoolingForward>(ctx);
+    benchmarker->set_param(param);
+    UniformIntRNG int_rng{-127, 127};
+    if (ctx.dtype == "qint8") {
+        benchmarker->set_dtype(0, dtype::QuantizedS8(1.f))
+                .set_dtype(1, dtype::QuantizedS8(1.f))
+                .set_rng(0, &int_rng);
+    }
+    size_t OH = (H + 2 * param.pad_h - window) / param.stride_h + 1,
+           OW = (W + 2 * param.pad_w - window) / param.stride_w + 1;
+    auto layouts = benchmarker->make_layouts({{N, C, H, W}, {}});
+    run_default(ctx, *benchmarker, layouts,
+                static_cast<double>(N) * C * OH * OW * window * window);
+}
+
+}  // anonymous namespace
+
+const std::map<std::string, OprBenchmark>& bench::opr_benchmarks() {
+    static const std::map<std::string, OprBenchmark> ret{
+            {"conv",
+             {"conv N IC H W OC FH FW [stride [pad [group]]]",
+              {"f32", "qint8"},
+              {"conv 1 3 224 224 32 3 3 2 1", "conv 1 32 112 112 64 3 3",
+               "conv 1 64 56 56 64 1 1 1 0", "conv 1 64 56 56 64 3 3",
+               "conv 1 128 28 28 128 3 3", "conv 1 256 14 14 256 3 3",
+               "conv 1 512 7 7 512 3 3", "conv 1 128 28 28 128 3 3 1 1 128",
+               "conv 8 64 56 56 256 1 1 1 0"},
+              run_conv}},
+            {"matmul",
+             {"matmul M N K [transA transB]",
+              {"f32", "int8"},
+              {"matmul 64 64 64", "matmul 256 256 256",
+               "matmul 1024 1024 1024", "matmul 1 1024 1024",
+               "matmul 3136 64 576", "matmul 49 512 4608",
+               "matmul 256 256 256 1 0", "matmul 256 256 256 0 1"},
+              run_matmul}},
+            {"elemwise",
+             {"elemwise MODE shape0 [shape1 [shape2]]",
+              {"f32", "int8"},
+              {"elemwise RELU 1x64x56x56",
+               "elemwise SIGMOID 1x64x56x56",
+               "elemwise H_SWISH 1x64x56x56",
+               "elemwise ADD 1x64x56x56 1x64x56x56",
+               "elemwise ADD 1x64x56x56 1x64x1x1",
+               "elemwise FUSE_ADD_RELU 1x64x56x56 1x64x56x56",
+               "elemwise FUSE_MUL_ADD3 1x64x56x56 1x64x1x1 1x64x1x1",
+               "elemwise MUL 4096x4096 4096x4096"},
+              run_elemwise}},
+            {"reduce",
+             {"reduce MODE shape axis",
+              {"f32"},
+              {"reduce SUM 1x64x56x56 1", "reduce SUM 1x64x3136 2",
+               "reduce MAX 1x1000 1", "reduce MEAN 64x512x49 2",
+               "reduce SUM_SQR 1024x1024 0"},
+              run_reduce}},
+            {"relayout",
+             {"relayout shape perm",
+              {"f32", "int8"},
+              {"relayout 1x64x56x56 0,2,3,1", "relayout 1x56x56x64 0,3,1,2",
+               "relayout 1024x1024 1,0",
+               "relayout 1x8x8x56x56 0,2,1,3,4"},
+              run_relayout}},
+            {"pooling",
+             {"pooling MODE N C H W window [stride [pad]]",
+              {"f32", "qint8"},
+              {"pooling MAX 1 64 112 112 3 2 1", "pooling MAX 1 64 56 56 2",
+               "pooling AVERAGE 1 512 7 7 7", "pooling AVERAGE 1 64 56 56 2"},
+              run_pooling}},
+    };
+    return ret;
+}
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,202 @@
+/**
+ * \file dnn/test/benchmark_suite/main.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "test/benchmark_suite/suite.h"
+#include "test/common/utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+using namespace megdnn;
+using namespace test;
+using namespace bench;
+
+namespace {
+
+const char* usage = R"__usage__(
+Usage: megdnn_benchmark [options]
+
+Benchmark megdnn kernels on CPU over a set of cases, with all algorithms of
+each opr. Each case is measured by several samples, and the median time is
+reported.
+
+Options:
+  --opr <name,...>
+    Oprs to benchmark; all the oprs are benchmarked by default.
+  --shapes <file>
+    Read cases from given file instead of the built-in default ones. Each line
+    is a case like `matmul 256 256 256`; lines starting with # are ignored.
+    Use --list to see the format of each opr.
+  --dtype <name,...>
+    Dtypes to benchmark, such as f32,qint8,int8; unsupported dtypes of an
+    opr are skipped. Default: f32
+  --threads <n,...>
+    Numbers of threads to benchmark with. Default: 1
+  --algo <regex>
+    Only run algorithms whose names match given regex.
+  --samples <n>
+    Number of samples taken for each kernel. Default: 5
+  --sample-time <seconds>
+    Duration of each sample. Default: 0.05
+  --json <file>
+    Write results with machine info to given file in JSON format.
+  --csv <file>
+    Write results to given file in CSV format, which can be used as baseline.
+  --baseline <file>
+    Compare results against a CSV file written by --csv. The process exits
+    with status 1 if any kernel regresses.
+  --threshold <ratio>
+    Minimal relative slowdown to be considered as regression. Default: 0.05
+  --noise-k <k>
+    A slowdown within k times the relative standard deviation of the
+    difference is considered as noise. Default: 3
+  --list
+    Print the format and default cases of each opr and exit.
+)__usage__";
+
+std::vector<std::string> split(const std::string& str) {
+    std::vector<std::string> ret;
+    size_t begin = 0;
+    while (begin <= str.size()) {
+        auto end = std::min(str.find(',', begin), str.size());
+        if (end > begin) {
+            ret.push_back(str.substr(begin, end - begin));
+        }
+        begin = end + 1;
+    }
+    return ret;
+}
+
+template <typename T>
+bool contains(const std::vector<T>& vec, const T& val) {
+    return std::find(vec.begin(), vec.end(), val) != vec.end();
+}
+
+}  // anonymous namespace
+
+int main(int argc, char** argv) {
+    RunOptions options;
+    std::vector<std::string> oprs;
+    std::string shapes_path, json_path, csv_path, baseline_path;
+    double threshold = 0.05, noise_k = 3;
+
+    for (int i = 1; i < argc; ++i) {
+        auto next = [&]() -> const char* {
+            megdnn_assert(i + 1 < argc, "value not given for %s", argv[i]);
+            return argv[++i];
+        };
+        if (!strcmp(argv[i], "--opr")) {
+            oprs = split(next());
+        } else if (!strcmp(argv[i], "--shapes")) {
+            shapes_path = next();
+        } else if (!strcmp(argv[i], "--dtype")) {
+            options.dtypes = split(next());
+        } else if (!strcmp(argv[i], "--threads")) {
+            options.threads.clear();
+            for (auto&& t : split(next())) {
+                options.threads.push_back(std::stoul(t));
+            }
+        } else if (!strcmp(argv[i], "--algo")) {
+            options.algo_filter = next();
+        } else if (!strcmp(argv[i], "--samples")) {
+            options.nr_sample = std::stoul(next());
+        } else if (!strcmp(argv[i], "--sample-time")) {
+            options.sample_secs = std::stof(next());
+        } else if (!strcmp(argv[i], "--json")) {
+            json_path = next();
+        } else if (!strcmp(argv[i], "--csv")) {
+            csv_path = next();
+        } else if (!strcmp(argv[i], "--baseline")) {
+            baseline_path = next();
+        } else if (!strcmp(argv[i], "--threshold")) {
+            threshold = std::stod(next());
+        } else if (!strcmp(argv[i], "--noise-k")) {
+            noise_k = std::stod(next());
+        } else if (!strcmp(argv[i], "--list")) {
+            for (auto&& i : opr_benchmarks()) {
+                printf("%s\n  dtypes:", i.second.usage);
+                for (auto&& dt : i.second.dtypes) {
+                    printf(" %s", dt.c_str());
+                }
+                printf("\n");
+                for (auto&& cs : i.second.default_cases) {
+                    printf("  %s\n", cs.c_str());
+                }
+            }
+            return 0;
+        } else {
+            fprintf(stderr, "%s", usage);
+            return !!strcmp(argv[i], "--help");
+        }
+    }
+    for (auto&& i : oprs) {
+        megdnn_assert(opr_benchmarks().count(i), "unknown opr: %s", i.c_str());
+    }
+
+    std::vector<Case> cases;
+    auto add_case = [&](const std::string& line) {
+        Case cs;
+        if (Case::parse(line, cs) && (oprs.empty() || contains(oprs, cs.opr))) {
+            megdnn_assert(opr_benchmarks().count(cs.opr),
+                          "unknown opr in case: %s", line.c_str());
+            cases.emplace_back(std::move(cs));
+        }
+    };
+    if (!shapes_path.empty()) {
+        std::ifstream fin{shapes_path};
+        megdnn_assert(fin.good(), "failed to open %s", shapes_path.c_str());
+        std::string line;
+        while (std::getline(fin, line)) {
+            add_case(line);
+        }
+    } else {
+        for (auto&& i : opr_benchmarks()) {
+            for (auto&& line : i.second.default_cases) {
+                add_case(line);
+            }
+        }
+    }
+
+    printf("machine: %s\n", machine_info_json().c_str());
+    std::vector<Result> results;
+    for (auto nr_thread : options.threads) {
+        megdnn_assert(nr_thread);
+        TaskExecutorConfig config{nr_thread, {}};
+        auto handle = create_cpu_handle(0, true,
+                                        nr_thread > 1 ? &config : nullptr);
+        for (auto&& dtype : options.dtypes) {
+            for (auto&& cs : cases) {
+                auto&& opr = opr_benchmarks().at(cs.opr);
+                if (!contains(opr.dtypes, dtype)) {
+                    continue;
+                }
+                RunContext ctx{cs,      dtype,   nr_thread, handle.get(),
+                               options, results};
+                opr.run(ctx);
+            }
+        }
+    }
+
+    if (!json_path.empty()) {
+        write_json(json_path, results);
+    }
+    if (!csv_path.empty()) {
+        write_csv(csv_path, results);
+    }
+    if (!baseline_path.empty()) {
+        auto nr_regress = compare_baseline(results, read_csv(baseline_path),
+                                           threshold, noise_k);
+        return nr_regress ? 1 : 0;
+    }
+    return 0;
+}
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,355 @@
+/**
+ * \file dnn/test/benchmark_suite/suite.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "test/benchmark_suite/suite.h"
+
+#include "megdnn/version.h"
+#include "src/common/utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+using namespace megdnn;
+using namespace test;
+using namespace bench;
+
+namespace {
+
+std::string json_str(const std::string& str) {
+    std::string ret = "\"";
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            ret += '\\';
+        }
+        ret += c;
+    }
+    ret += '"';
+    return ret;
+}
+
+std::string csv_field(const std::string& str) {
+    if (str.find_first_of(",\"") == std::string::npos) {
+        return str;
+    }
+    std::string ret = "\"";
+    for (char c : str) {
+        if (c == '"') {
+            ret += '"';
+        }
+        ret += c;
+    }
+    ret += '"';
+    return ret;
+}
+
+std::vector<std::string> split_csv_line(const std::string& line) {
+    std::vector<std::string> ret(1);
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (quoted) {
+            if (c == '"') {
+                if (i + 1 < line.size() && line[i + 1] == '"') {
+                    ret.back() += '"';
+                    ++i;
+                } else {
+                    quoted = false;
+                }
+            } else {
+                ret.back() += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            ret.emplace_back();
+        } else if (c != '\r') {
+            ret.back() += c;
+        }
+    }
+    return ret;
+}
+
+double gflops(const Result& r) {
+    return r.computation && r.median_ms ? r.computation / r.median_ms * 1e-6
+                                        : 0;
+}
+
+double gbps(const Result& r) {
+    return r.memory && r.median_ms ? r.memory / r.median_ms * 1e-6 : 0;
+}
+
+const char* CSV_HEADER =
+        "opr,spec,dtype,threads,algo,nr_sample,median_ms,min_ms,stddev_ms,"
+        "computation,memory,gflops,gbps";
+
+}  // anonymous namespace
+
+/* ======================= Case ======================= */
+
+std::string Case::spec() const {
+    std::string ret = opr;
+    for (auto&& i : args) {
+        ret += ' ';
+        ret += i;
+    }
+    return ret;
+}
+
+bool Case::parse(const std::string& line, Case& ret) {
+    std::istringstream iss{line.substr(0, line.find('#'))};
+    ret.opr.clear();
+    ret.args.clear();
+    if (!(iss >> ret.opr)) {
+        return false;
+    }
+    std::string arg;
+    while (iss >> arg) {
+        ret.args.push_back(arg);
+    }
+    return true;
+}
+
+/* ======================= Result ======================= */
+
+std::string Result::key() const {
+    return ssprintf("%s|%s|%s|%zu|%s", opr.c_str(), spec.c_str(),
+                    dtype.c_str(), threads, algo.c_str());
+}
+
+/* ======================= RunContext ======================= */
+
+bool RunContext::algo_accepted(const std::string& algo) const {
+    return options.algo_filter.empty() ||
+           std::regex_search(algo, std::regex(options.algo_filter));
+}
+
+void RunContext::measure(const std::string& algo,
+                         const std::function<float()>& sampler,
+                         double computation, double memory) {
+    megdnn_assert(options.nr_sample);
+    std::vector<double> samples;
+    for (size_t i = 0; i < options.nr_sample; ++i) {
+        samples.push_back(sampler());
+    }
+    std::sort(samples.begin(), samples.end());
+
+    Result ret;
+    ret.opr = cs.opr;
+    ret.spec = cs.spec();
+    ret.dtype = dtype;
+    ret.algo = algo;
+    ret.threads = threads;
+    ret.nr_sample = samples.size();
+    auto mid = samples.size() / 2;
+    ret.median_ms = samples.size() % 2
+                            ? samples[mid]
+                            : (samples[mid - 1] + samples[mid]) / 2;
+    ret.min_ms = samples[0];
+    double mean = 0, var = 0;
+    for (auto i : samples) {
+        mean += i;
+    }
+    mean /= samples.size();
+    for (auto i : samples) {
+        var += (i - mean) * (i - mean);
+    }
+    if (samples.size() > 1) {
+        var /= samples.size() - 1;
+    }
+    ret.stddev_ms = std::sqrt(var);
+    ret.computation = computation;
+    ret.memory = memory;
+    printf("%-40s %-6s t=%-2zu %-36s %10.4fms +-%5.1f%% %8.2fGFLOPS "
+           "%8.2fGB/s\n",
+           ret.spec.c_str(), dtype.c_str(), threads, algo.c_str(),
+           ret.median_ms,
+           ret.median_ms ? ret.stddev_ms / ret.median_ms * 100 : 0.0,
+           gflops(ret), gbps(ret));
+    fflush(stdout);
+    results.emplace_back(std::move(ret));
+}
+
+/* ======================= output ======================= */
+
+std::string bench::machine_info_json() {
+    std::string model = "unknown", flags;
+    std::ifstream fin{"/proc/cpuinfo"};
+    std::string line;
+    while (std::getline(fin, line)) {
+        auto pos = line.find(':');
+        if (pos == std::string::npos) {
+            continue;
+        }
+        auto key = line.substr(0, line.find_last_not_of(" \t", pos - 1) + 1);
+        auto val = line.substr(std::min(pos + 2, line.size()));
+        if (key == "model name" && model == "unknown") {
+            model = val;
+        } else if ((key == "flags" || key == "Features") && flags.empty()) {
+            // only keep flags relevant to kernel selection
+            static const std::set<std::string> interested{
+                    "sse4_1", "sse4_2",   "avx",      "avx2",
+                    "fma",    "avx512f",  "avx512bw", "avx512_vnni",
+                    "f16c",   "asimd",    "asimddp",  "fphp"};
+            std::istringstream iss{val};
+            std::string flag;
+            while (iss >> flag) {
+                if (interested.count(flag)) {
+                    flags += flags.empty() ? flag : " " + flag;
+                }
+            }
+        }
+    }
+    auto version = get_version();
+    return ssprintf(
+            "{\"cpu_model\": %s, \"cpu_flags\": %s, \"nr_cpu\": %u, "
+            "\"megdnn_version\": \"%d.%d.%d\"}",
+            json_str(model).c_str(), json_str(flags).c_str(),
+            std::thread::hardware_concurrency(), version.major, version.minor,
+            version.patch);
+}
+
+void bench::write_json(const std::string& fpath,
+                       const std::vector<Result>& results) {
+    FILE* fout = fopen(fpath.c_str(), "w");
+    megdnn_assert(fout, "failed to open %s", fpath.c_str());
+    fprintf(fout, "{\"machine\": %s,\n\"results\": [",
+            machine_info_json().c_str());
+    for (size_t i = 0; i < results.size(); ++i) {
+        auto&& r = results[i];
+        fprintf(fout,
+                "%s\n{\"opr\": %s, \"spec\": %s, \"dtype\": %s, "
+                "\"threads\": %zu, \"algo\": %s, \"nr_sample\": %zu, "
+                "\"median_ms\": %g, \"min_ms\": %g, \"stddev_ms\": %g, "
+                "\"computation\": %g, \"memory\": %g, \"gflops\": %g, "
+                "\"gbps\": %g}",
+                i ? "," : "", json_str(r.opr).c_str(),
+                json_str(r.spec).c_str(), json_str(r.dtype).c_str(),
+                r.threads, json_str(r.algo).c_str(), r.nr_sample, r.median_ms,
+                r.min_ms, r.stddev_ms, r.computation, r.memory, gflops(r),
+                gbps(r));
+    }
+    fprintf(fout, "\n]}\n");
+    fclose(fout);
+}
+
+void bench::write_csv(const std::string& fpath,
+                      const std::vector<Result>& results) {
+    FILE* fout = fopen(fpath.c_str(), "w");
+    megdnn_assert(fout, "failed to open %s", fpath.c_str());
+    fprintf(fout, "# machine: %s\n%s\n", machine_info_json().c_str(),
+            CSV_HEADER);
+    for (auto&& r : results) {
+        fprintf(fout, "%s,%s,%s,%zu,%s,%zu,%g,%g,%g,%g,%g,%g,%g\n",
+                csv_field(r.opr).c_str(), csv_field(r.spec).c_str(),
+                csv_field(r.dtype).c_str(), r.threads,
+                csv_field(r.algo).c_str(), r.nr_sample, r.median_ms, r.min_ms,
+                r.stddev_ms, r.computation, r.memory, gflops(r), gbps(r));
+    }
+    fclose(fout);
+}
+
+std::vector<Result> bench::read_csv(const std::string& fpath) {
+    std::ifstream fin{fpath};
+    megdnn_assert(fin.good(), "failed to open %s", fpath.c_str());
+    std::vector<Result> ret;
+    std::string line;
+    bool header_found = false;
+    while (std::getline(fin, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        if (!header_found) {
+            megdnn_assert(line.compare(0, strlen(CSV_HEADER), CSV_HEADER) == 0,
+                          "bad csv header in %s: %s", fpath.c_str(),
+                          line.c_str());
+            header_found = true;
+            continue;
+        }
+        auto fields = split_csv_line(line);
+        megdnn_assert(fields.size() >= 11, "bad line in %s: %s",
+                      fpath.c_str(), line.c_str());
+        Result r;
+        r.opr = fields[0];
+        r.spec = fields[1];
+        r.dtype = fields[2];
+        r.threads = std::stoul(fields[3]);
+        r.algo = fields[4];
+        r.nr_sample = std::stoul(fields[5]);
+        r.median_ms = std::stod(fields[6]);
+        r.min_ms = std::stod(fields[7]);
+        r.stddev_ms = std::stod(fields[8]);
+        r.computation = std::stod(fields[9]);
+        r.memory = std::stod(fields[10]);
+        ret.emplace_back(std::move(r));
+    }
+    return ret;
+}
+
+/* ======================= baseline ======================= */
+
+size_t bench::compare_baseline(const std::vector<Result>& results,
+                               const std::vector<Result>& baseline,
+                               double threshold, double noise_k) {
+    std::map<std::string, const Result*> base_map;
+    for (auto&& i : baseline) {
+        base_map[i.key()] = &i;
+    }
+    size_t nr_regress = 0, nr_improve = 0, nr_new = 0;
+    printf("\n%-10s %-40s %-6s %-3s %-36s %10s %10s %8s %8s\n", "status",
+           "case", "dtype", "thr", "algo", "base(ms)", "cur(ms)", "diff",
+           "tol");
+    for (auto&& cur : results) {
+        auto iter = base_map.find(cur.key());
+        if (iter == base_map.end()) {
+            ++nr_new;
+            printf("%-10s %-40s %-6s %-3zu %-36s %10s %10.4f\n", "NEW",
+                   cur.spec.c_str(), cur.dtype.c_str(), cur.threads,
+                   cur.algo.c_str(), "-", cur.median_ms);
+            continue;
+        }
+        auto&& base = *iter->second;
+        base_map.erase(iter);
+        double diff = cur.median_ms / base.median_ms - 1,
+               noise = std::sqrt(cur.stddev_ms * cur.stddev_ms +
+                                 base.stddev_ms * base.stddev_ms) /
+                       base.median_ms,
+               tol = std::max(threshold, noise_k * noise);
+        const char* status = "ok";
+        if (diff > tol) {
+            status = "REGRESSION";
+            ++nr_regress;
+        } else if (diff < -tol) {
+            status = "improved";
+            ++nr_improve;
+        }
+        printf("%-10s %-40s %-6s %-3zu %-36s %10.4f %10.4f %+7.1f%% %7.1f%%\n",
+               status, cur.spec.c_str(), cur.dtype.c_str(), cur.threads,
+               cur.algo.c_str(), base.median_ms, cur.median_ms, diff * 100,
+               tol * 100);
+    }
+    for (auto&& i : base_map) {
+        auto&& base = *i.second;
+        printf("%-10s %-40s %-6s %-3zu %-36s %10.4f %10s\n", "MISSING",
+               base.spec.c_str(), base.dtype.c_str(), base.threads,
+               base.algo.c_str(), base.median_ms, "-");
+    }
+    printf("\n%zu regressed, %zu improved, %zu new, %zu missing\n", nr_regress,
+           nr_improve, nr_new, base_map.size());
+    return nr_regress;
+}
+
+// vim: syntax=cpp.doxygen
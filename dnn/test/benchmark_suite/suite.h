@@ -0,0 +1,124 @@
+/**
+ * \file dnn/test/benchmark_suite/suite.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#pragma once
+
+#include "megdnn/handle.h"
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace megdnn {
+namespace test {
+namespace bench {
+
+/*!
+ * \brief a benchmark case, parsed from a line in a shape set
+ *
+ * A line is the opr kind followed by space separated arguments, such as
+ * `matmul 256 256 256`; see opr_benchmarks() for the arguments of each opr.
+ */
+struct Case {
+    std::string opr;
+    std::vector<std::string> args;
+
+    //! the normalized line, used to identify the case
+    std::string spec() const;
+
+    //! parse a line; return false if it is empty or a comment
+    static bool parse(const std::string& line, Case& ret);
+};
+
+//! options controlling which kernels are run and how they are measured
+struct RunOptions {
+    std::vector<std::string> dtypes{"f32"};
+    std::vector<size_t> threads{1};
+    //! regex of algorithm names to run; empty for all
+    std::string algo_filter;
+    //! number of samples taken for each kernel
+    size_t nr_sample = 5;
+    //! duration of each sample in seconds
+    float sample_secs = 0.05f;
+};
+
+//! measurement result of a kernel
+struct Result {
+    std::string opr, spec, dtype, algo;
+    size_t threads = 0, nr_sample = 0;
+    double median_ms = 0, min_ms = 0, stddev_ms = 0;
+    //! number of arithmetic operations and bytes accessed by one run; 0 if
+    //! not applicable
+    double computation = 0, memory = 0;
+
+    //! key to match results against baseline
+    std::string key() const;
+};
+
+//! context for running a case with given dtype and thread number
+struct RunContext {
+    const Case& cs;
+    const std::string& dtype;
+    size_t threads;
+    Handle* handle;
+    const RunOptions& options;
+    std::vector<Result>& results;
+
+    //! whether the algorithm name is accepted by options.algo_filter
+    bool algo_accepted(const std::string& algo) const;
+
+    /*!
+     * \brief take samples of a kernel and append the result
+     * \param sampler returns average time of a run in milliseconds
+     */
+    void measure(const std::string& algo, const std::function<float()>& sampler,
+                 double computation, double memory);
+};
+
+struct OprBenchmark {
+    //! description of the arguments in a shape set line
+    const char* usage;
+    //! supported dtypes
+    std::vector<std::string> dtypes;
+    //! cases used when no shape set is given
+    std::vector<std::string> default_cases;
+    //! run a case; it should call RunContext::measure() for each kernel
+    std::function<void(RunContext&)> run;
+};
+
+//! all the registered oprs
+const std::map<std::string, OprBenchmark>& opr_benchmarks();
+
+//! information of the host machine as a json object
+std::string machine_info_json();
+
+void write_json(const std::string& fpath, const std::vector<Result>& results);
+void write_csv(const std::string& fpath, const std::vector<Result>& results);
+std::vector<Result> read_csv(const std::string& fpath);
+
+/*!
+ * \brief compare results against baseline and print the difference
+ *
+ * A kernel is considered regressed if its median time is slower than the
+ * baseline by more than max(threshold, noise_k * relative standard deviation
+ * of the difference), so that noisy kernels are not reported spuriously.
+ *
+ * \return number of regressed kernels
+ */
+size_t compare_baseline(const std::vector<Result>& results,
+                        const std::vector<Result>& baseline, double threshold,
+                        double noise_k);
+
+}  // namespace bench
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,56 @@
+/**
+ * \file dnn/test/common/checksum.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "test/common/checksum.h"
+#include "megdnn/oprs.h"
+#include "test/common/utils.h"
+#include "test/common/workspace_wrapper.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace megdnn;
+using namespace test;
+
+void test::run_checksum_test(Handle* handle) {
+    auto naive_handle = create_cpu_handle(2);
+    auto opr = handle->create_operator<Checksum>(),
+         naive_opr = naive_handle->create_operator<Checksum>();
+    std::mt19937 rng(std::random_device{}());
+    auto run = [](Checksum* opr, void* ptr, size_t size) {
+        TensorND tensor;
+        tensor.raw_ptr = ptr;
+        tensor.layout.init_contiguous_stride({size});
+        tensor.layout.dtype = dtype::Byte();
+        WorkspaceWrapper workspace(opr->handle(),
+                                   opr->get_workspace_in_bytes(tensor.layout));
+        return opr->exec(tensor, workspace.workspace());
+    };
+    for (size_t size : {3, 8, 12345, 1024 * 1024 + 7, 1024 * 1024 * 10}) {
+        // extra bytes for testing unaligned input
+        std::vector<uint8_t> buf(size + 4);
+        for (auto&& i : buf)
+            i = rng();
+        for (size_t offset : {0, 1, 4}) {
+            auto ptr = buf.data() + offset;
+            auto res = run(opr.get(), ptr, size),
+                 res_naive = run(naive_opr.get(), ptr, size);
+            ASSERT_EQ(res_naive, res)
+                    << "failed for size " << size << " offset " << offset;
+        }
+        ++buf[size / 2];
+        auto res = run(opr.get(), buf.data(), size),
+             res_naive = run(naive_opr.get(), buf.data(), size);
+        ASSERT_EQ(res_naive, res);
+    }
+}
+
+// vim: syntax=cpp.doxygen
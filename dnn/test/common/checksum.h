@@ -0,0 +1,24 @@
+/**
+ * \file dnn/test/common/checksum.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#pragma once
+
+#include "megdnn/handle.h"
+
+namespace megdnn {
+namespace test {
+
+//! compare Checksum on a CPU handle with the naive implementation
+void run_checksum_test(Handle* handle);
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
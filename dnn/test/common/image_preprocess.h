@@ -0,0 +1,76 @@
+/**
+ * \file dnn/test/common/image_preprocess.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#pragma once
+#include "megdnn/basic_types.h"
+#include "megdnn/opr_param_defs.h"
+
+#include <vector>
+
+namespace megdnn {
+namespace test {
+namespace image_preprocess {
+
+struct TestArg {
+    param::ImagePreprocess param;
+    TensorShape src;
+    TestArg(param::ImagePreprocess param_, TensorShape src_)
+            : param(param_), src(src_) {}
+
+    //! number of channels of scale, bias and dst
+    size_t nr_channels() const {
+        using ColorMode = param::ImagePreprocess::ColorMode;
+        return param.color_mode == ColorMode::NONE ||
+                               param.color_mode == ColorMode::SWAP_RB
+                       ? src[3]
+                       : 3;
+    }
+};
+
+static inline std::vector<TestArg> get_args() {
+    using Param = param::ImagePreprocess;
+    using ColorMode = Param::ColorMode;
+    std::vector<TestArg> args;
+    auto add = [&](ColorMode mode, TensorShape src) {
+        for (auto imode : {Param::InterpolationMode::LINEAR,
+                           Param::InterpolationMode::NEAREST}) {
+            for (auto format : {Param::Format::NCHW, Param::Format::NCHW88}) {
+                // (0, 0) keeps the size of src
+                for (auto size : std::vector<std::pair<uint32_t, uint32_t>>{
+                             {0, 0}, {5, 7}, {23, 31}, {1, 1}}) {
+                    Param param;
+                    param.color_mode = mode;
+                    param.imode = imode;
+                    param.format = format;
+                    param.out_height = size.first;
+                    param.out_width = size.second;
+                    args.emplace_back(param, src);
+                }
+            }
+        }
+    };
+    add(ColorMode::NONE, {2, 12, 14, 1});
+    add(ColorMode::NONE, {1, 17, 9, 3});
+    add(ColorMode::NONE, {3, 8, 8, 4});
+    add(ColorMode::SWAP_RB, {2, 12, 14, 3});
+    for (auto mode : {ColorMode::YUV2RGB_NV21, ColorMode::YUV2BGR_NV21,
+                      ColorMode::YUV2RGB_NV12, ColorMode::YUV2BGR_NV12,
+                      ColorMode::YUV2RGB_YV12, ColorMode::YUV2BGR_YV12,
+                      ColorMode::YUV2RGB_YU12, ColorMode::YUV2BGR_YU12}) {
+        add(mode, {2, 18, 8, 1});
+    }
+    return args;
+}
+
+}  // namespace image_preprocess
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -87,6 +87,8 @@ DEF(WarpAffine, 3, true, false);
 DEF(GaussianBlur, 2, true, true);
 DEF(Resize, 2, true, false);
 DEF(ResizeBackward, 2, true, false);
+DEF(ImagePreprocess, 4, true, true);
+DEF(FusedOptimizerUpdate, 4, true, false);
 DEF(IndexingOneHot, 3, true, true);
 DEF(IndexingSetOneHot, 3, true, false);
 DEF(MaskConvolution, 4, true, true);
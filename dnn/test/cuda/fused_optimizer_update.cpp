@@ -0,0 +1,38 @@
+/**
+ * \file dnn/test/cuda/fused_optimizer_update.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "test/cuda/fixture.h"
+#include "test/common/checker.h"
+
+namespace megdnn {
+namespace test {
+
+TEST_F(CUDA, FUSED_OPTIMIZER_UPDATE) {
+    using Param = FusedOptimizerUpdate::Param;
+    Checker<FusedOptimizerUpdate> checker(handle_cuda());
+    UniformFloatRNG rng_sq{0.f, 1.f};
+    checker.set_rng(3, &rng_sq).set_epsilon(1e-4);
+    Param param;
+    param.lr = 0.1f;
+    param.weight_decay = 1e-4f;
+    param.momentum = 0.9f;
+    for (auto mode : {Param::Mode::SGD, Param::Mode::ADAM}) {
+        param.mode = mode;
+        param.step = 3;
+        for (size_t size : {1, 1000, 100003}) {
+            checker.set_param(param).execs({{size}, {size}, {size}, {size}});
+        }
+    }
+}
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,39 @@
+/**
+ * \file dnn/test/cuda/image_preprocess.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "test/cuda/fixture.h"
+#include "test/common/checker.h"
+#include "test/common/image_preprocess.h"
+
+namespace megdnn {
+namespace test {
+
+TEST_F(CUDA, IMAGE_PREPROCESS) {
+    Checker<ImagePreprocess> checker(handle_cuda());
+    UniformIntRNG src_rng{0, 255};
+    UniformFloatRNG scale_rng{0.f, 1.f};
+    checker.set_rng(0, &src_rng).set_rng(1, &scale_rng);
+    for (auto&& arg : image_preprocess::get_args()) {
+        TensorShape channel{arg.nr_channels()};
+        // the blended value may be rounded differently by one
+        checker.set_param(arg.param)
+                .set_dtype(0, dtype::Uint8())
+                .set_dtype(3, dtype::Float32())
+                .set_epsilon(1 + 1e-3)
+                .execs({arg.src, channel, channel, {}});
+        checker.set_dtype(3, dtype::QuantizedS8(1.f))
+                .execs({arg.src, channel, channel, {}});
+    }
+}
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,28 @@
+/**
+ * \file dnn/test/fallback/checksum.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "test/fallback/fixture.h"
+#include "test/common/checksum.h"
+
+namespace megdnn {
+namespace test {
+
+TEST_F(FALLBACK, CHECKSUM_FORWARD) {
+    run_checksum_test(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, CHECKSUM_FORWARD) {
+    run_checksum_test(handle());
+}
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
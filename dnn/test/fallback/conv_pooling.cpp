@@ -0,0 +1,146 @@
+/**
+ * \file dnn/test/fallback/conv_pooling.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "test/common/conv_pooling.h"
+#include "test/common/benchmarker.h"
+#include "test/common/checker.h"
+#include "test/common/rng.h"
+#include "test/fallback/fixture.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+void run_conv_pooling(Handle* handle) {
+    using Param = param::ConvPooling;
+    auto args = conv_pooling::get_args();
+    // padded conv and pooling, overlapping and average pooling windows
+    for (auto pool_mode : {Param::PoolMode::MAX, Param::PoolMode::AVERAGE})
+        for (uint32_t pool_stride : {1, 2})
+            for (uint32_t conv_stride : {1, 2}) {
+                Param param{Param::Method::WITH_TEXTURE_OBJ,
+                            Param::ConvMode::CROSS_CORRELATION,
+                            pool_mode,
+                            Param::NonlineMode::RELU,
+                            3,
+                            3,
+                            pool_stride,
+                            pool_stride,
+                            1,
+                            1,
+                            conv_stride,
+                            conv_stride,
+                            1,
+                            1};
+                args.emplace_back(param, TensorShape{2, 5, 17, 23},
+                                  TensorShape{7, 5, 3, 3},
+                                  TensorShape{1, 7, 1, 1});
+                // conv output split into several bands, down to a single
+                // pooled row per band
+                args.emplace_back(param, TensorShape{1, 3, 64, 64},
+                                  TensorShape{64, 3, 3, 3},
+                                  TensorShape{1, 64, 1, 1});
+                args.emplace_back(param, TensorShape{1, 2, 12, 300},
+                                  TensorShape{256, 2, 3, 3},
+                                  TensorShape{1, 256, 1, 1});
+            }
+
+    Checker<ConvPoolingForward> checker(handle);
+    NormalRNG rng;
+    for (auto&& arg : args) {
+        checker.set_rng(0, &rng)
+                .set_rng(1, &rng)
+                .set_rng(2, &rng)
+                .set_epsilon(1e-3)
+                .set_param(arg.param)
+                .execs({arg.src, arg.filter, arg.bias, {}});
+    }
+}
+}  // namespace
+
+TEST_F(FALLBACK, CONV_POOLING_FORWARD) {
+    run_conv_pooling(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, CONV_POOLING_FORWARD) {
+    run_conv_pooling(handle());
+}
+
+#if MEGDNN_WITH_BENCHMARK
+//! compare fused conv-pooling with conv_bias followed by pooling
+TEST_F(FALLBACK, BENCHMARK_CONV_POOLING_FORWARD) {
+    constexpr size_t RUNS = 30;
+    using Param = param::ConvPooling;
+    Benchmarker<ConvPoolingForward> benchmarker_fused(handle());
+    Benchmarker<ConvBias> benchmarker_conv(handle());
+    Benchmarker<Pooling> benchmarker_pool(handle());
+    benchmarker_fused.set_display(false).set_times(RUNS);
+    benchmarker_conv.set_display(false).set_times(RUNS);
+    benchmarker_pool.set_display(false).set_times(RUNS);
+
+    auto run = [&](size_t N, size_t IC, size_t OC, size_t H, size_t W,
+                   size_t FS) {
+        Param param{Param::Method::WITH_TEXTURE_OBJ,
+                    Param::ConvMode::CROSS_CORRELATION,
+                    Param::PoolMode::MAX,
+                    Param::NonlineMode::RELU,
+                    2,
+                    2,
+                    2,
+                    2,
+                    0,
+                    0,
+                    1,
+                    1,
+                    static_cast<uint32_t>(FS / 2),
+                    static_cast<uint32_t>(FS / 2)};
+        TensorShape src{N, IC, H, W}, filter{OC, IC, FS, FS},
+                bias{1, OC, 1, 1}, conv_dst{N, OC, H, W};
+
+        param::ConvBias conv_param;
+        conv_param.nonlineMode = param::ConvBias::NonlineMode::RELU;
+        conv_param.pad_h = conv_param.pad_w = FS / 2;
+        param::Pooling pool_param{param::Pooling::Mode::MAX, 0, 0, 2, 2, 2, 2};
+
+        auto fused_used =
+                benchmarker_fused.set_param(param).exec(
+                        {src, filter, bias, {}}) /
+                RUNS;
+        auto separate_used =
+                (benchmarker_conv.set_param(conv_param)
+                         .exec({src, filter, bias, {}, conv_dst}) +
+                 benchmarker_pool.set_param(pool_param).exec({conv_dst, {}})) /
+                RUNS;
+        printf("src=%s filter=%s: fused %.3fms, conv_bias+pooling %.3fms, "
+               "speedup %.2f\n",
+               src.to_string().c_str(), filter.to_string().c_str(),
+               fused_used, separate_used, separate_used / fused_used);
+    };
+
+    // few input channels, as in the first layer of most networks
+    run(1, 1, 32, 224, 224, 3);
+    run(1, 3, 32, 224, 224, 3);
+    run(1, 3, 64, 112, 112, 3);
+    run(1, 1, 16, 128, 128, 5);
+    run(1, 3, 16, 128, 128, 5);
+    // more channels
+    run(1, 8, 32, 56, 56, 3);
+    run(1, 16, 32, 56, 56, 3);
+    run(1, 64, 64, 56, 56, 3);
+    // large activations, where writing and reading back the conv output
+    // costs the most
+    run(1, 32, 64, 112, 112, 3);
+}
+#endif
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
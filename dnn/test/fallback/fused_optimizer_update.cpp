@@ -0,0 +1,56 @@
+/**
+ * \file dnn/test/fallback/fused_optimizer_update.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "test/fallback/fixture.h"
+#include "test/common/checker.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+void run_fused_optimizer_update(Handle* handle) {
+    using Param = FusedOptimizerUpdate::Param;
+    Checker<FusedOptimizerUpdate> checker(handle);
+    // second moment of ADAM must be non-negative
+    UniformFloatRNG rng_sq{0.f, 1.f};
+    checker.set_rng(3, &rng_sq).set_epsilon(1e-4);
+
+    Param param;
+    param.lr = 0.1f;
+    param.weight_decay = 1e-4f;
+    for (float momentum : {0.f, 0.9f}) {
+        param.mode = Param::Mode::SGD;
+        param.momentum = momentum;
+        for (size_t size : {1, 17, 100003}) {
+            checker.set_param(param).execs({{size}, {size}, {size}, {size}});
+        }
+    }
+    param.mode = Param::Mode::ADAM;
+    for (uint32_t step : {1, 10}) {
+        param.step = step;
+        for (size_t size : {1, 17, 100003}) {
+            checker.set_param(param).execs({{size}, {size}, {size}, {size}});
+        }
+    }
+}
+}  // anonymous namespace
+
+TEST_F(FALLBACK, FUSED_OPTIMIZER_UPDATE) {
+    run_fused_optimizer_update(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, FUSED_OPTIMIZER_UPDATE) {
+    run_fused_optimizer_update(handle());
+}
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,60 @@
+/**
+ * \file dnn/test/fallback/image_preprocess.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "test/fallback/fixture.h"
+#include "test/common/checker.h"
+#include "test/common/image_preprocess.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+void run_image_preprocess(Handle* handle) {
+    Checker<ImagePreprocess> checker(handle);
+    UniformIntRNG rng{0, 255};
+    checker.set_rng(0, &rng);
+    for (auto&& arg : image_preprocess::get_args()) {
+        TensorShape channel{arg.nr_channels()};
+        checker.set_param(arg.param)
+                .set_dtype(0, dtype::Uint8())
+                .set_dtype(3, dtype::Float32())
+                .set_epsilon(1e-3)
+                .execs({arg.src, channel, channel, {}});
+        checker.set_dtype(3, dtype::QuantizedS8(0.05f))
+                .set_epsilon(1 + 1e-3)
+                .execs({arg.src, channel, channel, {}});
+    }
+}
+}  // anonymous namespace
+
+TEST_F(FALLBACK, IMAGE_PREPROCESS) {
+    run_image_preprocess(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, IMAGE_PREPROCESS) {
+    run_image_preprocess(handle());
+    // a single image whose rows are split into bands across threads
+    Checker<ImagePreprocess> checker(handle());
+    UniformIntRNG rng{0, 255};
+    checker.set_rng(0, &rng);
+    param::ImagePreprocess param;
+    param.color_mode = param::ImagePreprocess::ColorMode::YUV2BGR_NV21;
+    param.out_height = 97;
+    param.out_width = 61;
+    checker.set_param(param).set_dtype(0, dtype::Uint8()).set_epsilon(1e-3);
+    checker.execs({{1, 150, 64, 1}, {3}, {3}, {}});
+    param.imode = param::ImagePreprocess::InterpolationMode::NEAREST;
+    checker.set_param(param).execs({{1, 150, 64, 1}, {3}, {3}, {}});
+}
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
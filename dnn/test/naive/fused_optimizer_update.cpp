@@ -0,0 +1,85 @@
+/**
+ * \file dnn/test/naive/fused_optimizer_update.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "test/naive/fixture.h"
+#include "test/common/checker.h"
+
+using namespace megdnn;
+using namespace test;
+
+TEST_F(NAIVE, FUSED_OPTIMIZER_UPDATE_SGD) {
+    Checker<FusedOptimizerUpdate> checker(handle(), false);
+    using Param = FusedOptimizerUpdate::Param;
+    Param param;
+    param.mode = Param::Mode::SGD;
+    param.lr = 0.1f;
+    param.weight_decay = 0.01f;
+    param.momentum = 0.9f;
+    // state1 is not used by SGD, and is kept unchanged
+    checker.set_param(param).exect(
+            Testcase{TensorValue({2}, dtype::Float32(), {1.f, -2.f}),
+                     TensorValue({2}, dtype::Float32(), {0.5f, 1.f}),
+                     TensorValue({2}, dtype::Float32(), {0.2f, -0.1f}),
+                     TensorValue({2}, dtype::Float32(), {3.f, 4.f})},
+            Testcase{TensorValue({2}, dtype::Float32(), {0.931f, -2.089f}),
+                     {},
+                     TensorValue({2}, dtype::Float32(), {0.69f, 0.89f}),
+                     TensorValue({2}, dtype::Float32(), {3.f, 4.f})});
+
+    param.momentum = 0.f;
+    checker.set_param(param).exect(
+            Testcase{TensorValue({2}, dtype::Float32(), {1.f, -2.f}),
+                     TensorValue({2}, dtype::Float32(), {0.5f, 1.f}),
+                     TensorValue({2}, dtype::Float32(), {0.2f, -0.1f}),
+                     TensorValue({2}, dtype::Float32(), {3.f, 4.f})},
+            Testcase{TensorValue({2}, dtype::Float32(), {0.949f, -2.098f}),
+                     {},
+                     TensorValue({2}, dtype::Float32(), {0.2f, -0.1f}),
+                     TensorValue({2}, dtype::Float32(), {3.f, 4.f})});
+}
+
+TEST_F(NAIVE, FUSED_OPTIMIZER_UPDATE_ADAM) {
+    Checker<FusedOptimizerUpdate> checker(handle(), false);
+    using Param = FusedOptimizerUpdate::Param;
+    Param param;
+    param.mode = Param::Mode::ADAM;
+    param.lr = 0.1f;
+    param.beta0 = 0.9f;
+    param.beta1 = 0.999f;
+    param.eps = 1e-8f;
+    param.step = 1;
+    // the bias corrected moments of the first step are g and g * g
+    checker.set_param(param).exect(
+            Testcase{TensorValue({2}, dtype::Float32(), {1.f, 2.f}),
+                     TensorValue({2}, dtype::Float32(), {0.5f, -1.f}),
+                     TensorValue({2}, dtype::Float32(), {0.f, 0.f}),
+                     TensorValue({2}, dtype::Float32(), {0.f, 0.f})},
+            Testcase{TensorValue({2}, dtype::Float32(), {0.9f, 2.1f}),
+                     {},
+                     TensorValue({2}, dtype::Float32(), {0.05f, -0.1f}),
+                     TensorValue({2}, dtype::Float32(), {0.00025f, 0.001f})});
+
+    // step 2 with weight decay: g = 0.5 + 0.5 * 1 = 1, m = 0.09 + 0.1 = 0.19,
+    // v = 0.000999 + 0.001 = 0.001999, m_hat = 0.19 / 0.19 = 1,
+    // v_hat = 0.001999 / 0.001999 = 1
+    param.step = 2;
+    param.weight_decay = 0.5f;
+    checker.set_param(param).exect(
+            Testcase{TensorValue({1}, dtype::Float32(), {1.f}),
+                     TensorValue({1}, dtype::Float32(), {0.5f}),
+                     TensorValue({1}, dtype::Float32(), {0.1f}),
+                     TensorValue({1}, dtype::Float32(), {0.001f})},
+            Testcase{TensorValue({1}, dtype::Float32(), {0.9f}),
+                     {},
+                     TensorValue({1}, dtype::Float32(), {0.19f}),
+                     TensorValue({1}, dtype::Float32(), {0.001999f})});
+}
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,149 @@
+/**
+ * \file dnn/test/naive/image_preprocess.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "test/naive/fixture.h"
+#include "test/common/checker.h"
+#include "test/common/image_preprocess.h"
+#include "megdnn/oprs/cv.h"
+
+using namespace megdnn;
+using namespace test;
+
+namespace {
+
+//! compute ImagePreprocess by CvtColor, Resize and an explicit affine loop
+void run_unfused(Handle* handle, const param::ImagePreprocess& param,
+                 const TensorNDArray& tensors) {
+    using ColorMode = param::ImagePreprocess::ColorMode;
+    auto exec = [](OperatorBase* opr, const TensorND& src,
+                   const TensorND& dst, size_t workspace_size) {
+        std::vector<dt_byte> workspace(workspace_size);
+        Workspace ws{workspace.data(), workspace_size};
+        if (auto cvt = dynamic_cast<CvtColor*>(opr)) {
+            cvt->exec(src, dst, ws);
+        } else {
+            static_cast<Resize*>(opr)->exec(src, dst, ws);
+        }
+    };
+
+    TensorND cur = tensors[0];
+    std::vector<dt_uint8> cvt_buf, resize_buf;
+    if (param.color_mode != ColorMode::NONE) {
+        auto cvt = handle->create_operator<CvtColor>();
+        switch (param.color_mode) {
+#define cb(_mode)                                      \
+    case ColorMode::_mode:                             \
+        cvt->param().mode = CvtColor::Param::Mode::_mode; \
+        break;
+            cb(YUV2RGB_NV21);
+            cb(YUV2BGR_NV21);
+            cb(YUV2RGB_NV12);
+            cb(YUV2BGR_NV12);
+            cb(YUV2RGB_YV12);
+            cb(YUV2BGR_YV12);
+            cb(YUV2RGB_YU12);
+            cb(YUV2BGR_YU12);
+#undef cb
+            default:
+                cvt->param().mode = CvtColor::Param::Mode::RGB2BGR;
+        }
+        TensorLayout layout;
+        cvt->deduce_layout(cur.layout, layout);
+        cvt_buf.resize(layout.total_nr_elems());
+        TensorND dst{cvt_buf.data(), layout};
+        exec(cvt.get(), cur, dst,
+             cvt->get_workspace_in_bytes(cur.layout, layout));
+        cur = dst;
+    }
+    if (param.out_height) {
+        auto resize = handle->create_operator<Resize>();
+        resize->param().imode = param.imode;
+        resize->param().format = Resize::Param::Format::NHWC;
+        TensorLayout layout{{cur.layout[0], param.out_height, param.out_width,
+                             cur.layout[3]},
+                            dtype::Uint8()};
+        resize_buf.resize(layout.total_nr_elems());
+        TensorND dst{resize_buf.data(), layout};
+        exec(resize.get(), cur, dst,
+             resize->get_workspace_in_bytes(cur.layout, layout));
+        cur = dst;
+    }
+
+    auto&& dst = tensors[3];
+    bool nchw88 = param.format == param::ImagePreprocess::Format::NCHW88;
+    size_t N = cur.layout[0], H = cur.layout[1], W = cur.layout[2],
+           C = cur.layout[3];
+    size_t dst_c = nchw88 ? 8 : C;
+    auto scale = tensors[1].ptr<dt_float32>(),
+         bias = tensors[2].ptr<dt_float32>();
+    auto sptr = cur.ptr<dt_uint8>();
+    bool is_float = dst.layout.dtype == dtype::Float32();
+    for (size_t n = 0; n < N; ++n)
+        for (size_t c = 0; c < dst_c; ++c)
+            for (size_t h = 0; h < H; ++h)
+                for (size_t w = 0; w < W; ++w) {
+                    float val = 0.f;
+                    if (c < C) {
+                        val = sptr[((n * H + h) * W + w) * C + c] * scale[c] +
+                              bias[c];
+                    }
+                    size_t offset = nchw88 ? ((n * H + h) * W + w) * 8 + c
+                                           : ((n * C + c) * H + h) * W + w;
+                    if (is_float) {
+                        dst.ptr<dt_float32>()[offset] = val;
+                    } else {
+                        dst.compatible_ptr<dt_qint8>()[offset] =
+                                dst.layout.dtype.param<dtype::QuantizedS8>()
+                                        .quantize(val);
+                    }
+                }
+}
+
+}  // anonymous namespace
+
+TEST_F(NAIVE, IMAGE_PREPROCESS_SIMPLE) {
+    Checker<ImagePreprocess> checker(handle(), false);
+    param::ImagePreprocess param;
+    param.color_mode = param::ImagePreprocess::ColorMode::SWAP_RB;
+    checker.set_param(param).exect(
+            Testcase{TensorValue({1, 1, 2, 3}, dtype::Uint8(),
+                                 {1, 2, 3, 4, 5, 6}),
+                     TensorValue({3}, dtype::Float32(), {1.f, 2.f, 0.5f}),
+                     TensorValue({3}, dtype::Float32(), {0.f, -1.f, 1.f}),
+                     {}},
+            Testcase{{},
+                     {},
+                     {},
+                     TensorValue({1, 3, 1, 2}, dtype::Float32(),
+                                 {3.f, 6.f, 3.f, 9.f, 1.5f, 3.f})});
+}
+
+TEST_F(NAIVE, IMAGE_PREPROCESS) {
+    Checker<ImagePreprocess> checker(handle());
+    UniformIntRNG rng{0, 255};
+    checker.set_rng(0, &rng);
+    for (auto&& arg : image_preprocess::get_args()) {
+        TensorShape channel{arg.nr_channels()};
+        checker.set_extra_opr_impl(
+                [this, param = arg.param](const TensorNDArray& tensors) {
+                    run_unfused(handle(), param, tensors);
+                });
+        checker.set_param(arg.param)
+                .set_dtype(0, dtype::Uint8())
+                .set_dtype(3, dtype::Float32())
+                .set_epsilon(1e-3)
+                .execs({arg.src, channel, channel, {}});
+        checker.set_dtype(3, dtype::QuantizedS8(0.05f))
+                .set_epsilon(1 + 1e-3)
+                .execs({arg.src, channel, channel, {}});
+    }
+}
+
+// vim: syntax=cpp.doxygen
@@ -34,6 +34,40 @@ TEST_F(X86, CVTCOLOR)
     }
 }
 
+TEST_F(X86_MULTI_THREADS, CVTCOLOR)
+{
+    using namespace cvt_color;
+    std::vector<TestArg> args = get_args();
+    //! single images tall enough to be split into row bands
+    param::CvtColor cur_param;
+    for (auto mode : {Mode::RGB2GRAY, Mode::RGB2YUV, Mode::YUV2RGB,
+                      Mode::BGR2RGB}) {
+        cur_param.mode = mode;
+        args.emplace_back(cur_param, TensorShape{1, 97, 70, 3},
+                          dtype::Uint8());
+        args.emplace_back(cur_param, TensorShape{1, 97, 70, 3},
+                          dtype::Float32());
+    }
+    for (auto mode : {Mode::YUV2RGB_NV21, Mode::YUV2BGR_NV12,
+                      Mode::YUV2RGB_YV12, Mode::YUV2BGR_YU12,
+                      Mode::YUV2GRAY_NV21, Mode::BT601_YUV2RGB_NV21,
+                      Mode::BT601_YUV2BGR_YU12}) {
+        cur_param.mode = mode;
+        args.emplace_back(cur_param, TensorShape{1, 150, 70, 1},
+                          dtype::Uint8());
+        args.emplace_back(cur_param, TensorShape{2, 93, 134, 1},
+                          dtype::Uint8());
+    }
+    Checker<CvtColor> checker(handle());
+
+    for (auto &&arg: args) {
+        checker.set_param(arg.param)
+            .set_dtype(0, arg.dtype)
+            .set_dtype(1, arg.dtype)
+            .execs({arg.src, {}});
+    }
+}
+
 #ifdef MEGDNN_WITH_BENCHMARK
 TEST_F(X86, BENCHMARK_CVTCOLOR_RGB2GRAY)
 {
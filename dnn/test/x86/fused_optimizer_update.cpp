@@ -0,0 +1,98 @@
+/**
+ * \file dnn/test/x86/fused_optimizer_update.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "test/x86/fixture.h"
+
+#include "test/common/benchmarker.h"
+#include "test/common/checker.h"
+#include "test/common/rng.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+void run_fused_adam(Handle* handle) {
+    using Param = FusedOptimizerUpdate::Param;
+    Checker<FusedOptimizerUpdate> checker(handle);
+    // second moment of ADAM must be non-negative
+    UniformFloatRNG rng_sq{0.f, 1.f};
+    checker.set_rng(3, &rng_sq).set_epsilon(1e-4);
+
+    Param param;
+    param.mode = Param::Mode::ADAM;
+    param.lr = 0.1f;
+    param.weight_decay = 1e-4f;
+    for (uint32_t step : {1, 10}) {
+        param.step = step;
+        // sizes not divisible by the SIMD width
+        for (size_t size : {1, 8, 23, 100003}) {
+            checker.set_param(param).execs({{size}, {size}, {size}, {size}});
+        }
+    }
+}
+}  // anonymous namespace
+
+TEST_F(X86, FUSED_OPTIMIZER_UPDATE_ADAM) {
+    run_fused_adam(handle());
+}
+
+TEST_F(X86_MULTI_THREADS, FUSED_OPTIMIZER_UPDATE_ADAM) {
+    run_fused_adam(handle());
+}
+
+#if MEGDNN_WITH_BENCHMARK
+TEST_F(X86, BENCHMARK_FUSED_OPTIMIZER_UPDATE_ADAM) {
+    using Mode = Elemwise::Param::Mode;
+    constexpr size_t RUN = 20;
+    UniformFloatRNG rng_sq{0.f, 1.f};
+
+    Benchmarker<FusedOptimizerUpdate> fused(handle());
+    FusedOptimizerUpdate::Param param;
+    param.mode = FusedOptimizerUpdate::Param::Mode::ADAM;
+    param.step = 10;
+    fused.set_param(param).set_rng(3, &rng_sq).set_times(RUN).set_display(
+            false);
+
+    Benchmarker<Elemwise> elemwise(handle());
+    elemwise.set_rng(0, &rng_sq).set_times(RUN).set_display(false);
+
+    for (size_t size : {1000, 100000, 10000000}) {
+        TensorShape x{size}, s{1};
+        float time_fused = fused.execs({x, x, x, x}) / RUN;
+
+        // the elemwise oprs of an unfused update:
+        // g = param * weight_decay + grad
+        // exp_avg = exp_avg * beta0 + g * (1 - beta0)
+        // exp_avg_sq = exp_avg_sq * beta1 + g * g * (1 - beta1)
+        // param -= exp_avg * c0 / (pow(exp_avg_sq, 0.5) * c1 + eps)
+        float time_unfused = 0;
+        auto run = [&](Mode mode, const TensorShapeArray& shapes) {
+            time_unfused += elemwise.set_param(mode).execs(shapes) / RUN;
+        };
+        run(Mode::FUSE_MUL_ADD3, {x, s, x, {}});
+        run(Mode::FUSE_MUL_ADD4, {x, s, x, s, {}});
+        run(Mode::MUL, {x, x, {}});
+        run(Mode::FUSE_MUL_ADD4, {x, s, x, s, {}});
+        run(Mode::POW, {x, s, {}});
+        run(Mode::FUSE_MUL_ADD3, {x, s, s, {}});
+        run(Mode::MUL, {x, s, {}});
+        run(Mode::TRUE_DIV, {x, x, {}});
+        run(Mode::SUB, {x, x, {}});
+
+        printf("adam size=%zu: fused=%.3fms unfused=%.3fms speedup=%.2f\n",
+               size, time_fused, time_unfused, time_unfused / time_fused);
+    }
+}
+#endif
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -37,6 +37,42 @@ TEST_F(X86, GAUSSIAN_BLUR)
     }
 }
 
+TEST_F(X86_MULTI_THREADS, GAUSSIAN_BLUR)
+{
+    using namespace gaussian_blur;
+    std::vector<TestArg> args = get_args();
+    //! single images tall enough to be split into row bands
+    param::GaussianBlur cur_param;
+    cur_param.kernel_height = 9;
+    cur_param.kernel_width = 5;
+    for (auto bmode : {param::GaussianBlur::BorderMode::BORDER_REPLICATE,
+                       param::GaussianBlur::BorderMode::BORDER_REFLECT,
+                       param::GaussianBlur::BorderMode::BORDER_REFLECT_101,
+                       param::GaussianBlur::BorderMode::BORDER_CONSTANT}) {
+        cur_param.border_mode = bmode;
+        for (size_t c : {1, 3}) {
+            args.emplace_back(cur_param, TensorShape{1, 97, 31, c});
+            args.emplace_back(cur_param, TensorShape{2, 40, 17, c});
+        }
+    }
+    Checker<GaussianBlur> checker(handle());
+
+    for (auto &&arg: args) {
+        checker.set_param(arg.param)
+            .set_dtype(0, dtype::Float32())
+            .set_dtype(1, dtype::Float32())
+            .execs({arg.src, {}});
+    }
+
+    for (auto &&arg: args) {
+        checker.set_param(arg.param)
+            .set_epsilon(1+1e-3)
+            .set_dtype(0, dtype::Uint8())
+            .set_dtype(1, dtype::Uint8())
+            .execs({arg.src, {}});
+    }
+}
+
 } // namespace test
 } // namespace megdnn
 // vim: syntax=cpp.doxygen
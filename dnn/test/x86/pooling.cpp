@@ -16,6 +16,65 @@
 namespace megdnn {
 namespace test {
 
+namespace {
+//! args with arbitrary window, stride and padding for the generic kernels
+std::vector<pooling::TestArg> get_generic_args() {
+    std::vector<pooling::TestArg> args;
+    using Param = param::Pooling;
+    using Mode = param::Pooling::Mode;
+    for (auto mode :
+         {Mode::MAX, Mode::AVERAGE, Mode::AVERAGE_COUNT_EXCLUDE_PADDING})
+        for (uint32_t window : {1, 3, 5})
+            for (uint32_t stride : {1, 2, 3})
+                for (uint32_t pad = 0; pad < window && pad <= 2; ++pad) {
+                    args.emplace_back(Param{mode, pad, pad, stride, stride,
+                                            window, window},
+                                      TensorShape{2, 3, 19, 37});
+                }
+    // global pooling
+    args.emplace_back(Param{Mode::AVERAGE, 0, 0, 1, 1, 7, 7},
+                      TensorShape{2, 16, 7, 7});
+    args.emplace_back(Param{Mode::MAX, 0, 0, 1, 1, 7, 9},
+                      TensorShape{1, 5, 7, 9});
+    return args;
+}
+
+void run_generic_pooling(Handle* handle) {
+    UniformIntRNG rng{-127, 127};
+    for (auto&& arg : get_generic_args()) {
+        Checker<Pooling> checker(handle);
+        checker.set_param(arg.param).exec(TensorShapeArray{arg.ishape, {}});
+
+        arg.ishape.ndim = 5;
+        arg.ishape[1] = (arg.ishape[1] + 7) / 8;
+        arg.ishape[4] = 8;
+        arg.param.format = param::Pooling::Format::NCHW88;
+        checker.set_param(arg.param).exec(TensorShapeArray{arg.ishape, {}});
+    }
+    for (auto&& arg : get_generic_args()) {
+        Checker<Pooling> checker(handle);
+        checker.set_rng(0, &rng);
+        for (DType dtype : std::vector<DType>{dtype::Int8(),
+                                              dtype::QuantizedS8(0.3f)}) {
+            checker.set_dtype(0, dtype)
+                    .set_param(arg.param)
+                    .exec(TensorShapeArray{arg.ishape, {}});
+        }
+
+        arg.ishape.ndim = 5;
+        arg.ishape[1] = (arg.ishape[1] + 7) / 8;
+        arg.ishape[4] = 8;
+        arg.param.format = param::Pooling::Format::NCHW88;
+        for (DType dtype : std::vector<DType>{dtype::Int8(),
+                                              dtype::QuantizedS8(0.3f)}) {
+            checker.set_dtype(0, dtype)
+                    .set_param(arg.param)
+                    .exec(TensorShapeArray{arg.ishape, {}});
+        }
+    }
+}
+}  // namespace
+
 TEST_F(X86, POOLING) {
     auto args = pooling::get_args();
     for (auto&& arg : args) {
@@ -24,7 +83,22 @@ TEST_F(X86, POOLING) {
     }
 }
 
-#if defined(MEGDNN_X86_WITH_MKL_DNN)
+TEST_F(X86_MULTI_THREADS, POOLING) {
+    auto args = pooling::get_args();
+    for (auto&& arg : args) {
+        Checker<Pooling> checker(handle());
+        checker.set_param(arg.param).exec(TensorShapeArray{arg.ishape, {}});
+    }
+}
+
+TEST_F(X86, POOLING_GENERIC) {
+    run_generic_pooling(handle());
+}
+
+TEST_F(X86_MULTI_THREADS, POOLING_GENERIC) {
+    run_generic_pooling(handle());
+}
+
 TEST_F(X86, POOLING88) {
     Checker<Pooling> checker(handle());
     auto args = pooling::get_args();
@@ -47,7 +121,6 @@ TEST_F(X86_MULTI_THREADS, POOLING88) {
         checker.set_param(arg.param).exec(TensorShapeArray{arg.ishape, {}});
     }
 }
-#endif
 #if MEGDNN_WITH_BENCHMARK
 static void test_x86_megdnn_pooling(Handle* handle) {
     constexpr size_t RUNS = 50;
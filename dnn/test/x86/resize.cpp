@@ -38,6 +38,48 @@ TEST_F(X86, RESIZE_CV)
 
 }
 
+TEST_F(X86_MULTI_THREADS, RESIZE_CV)
+{
+    using namespace resize;
+    std::vector<TestArg> args = get_cv_args();
+    param::Resize cur_param;
+    cur_param.format = param::Resize::Format::NHWC;
+    //! single images tall enough to be split into row bands
+    for (auto imode : {param::Resize::InterpolationMode::INTER_NEAREST,
+                       param::Resize::InterpolationMode::INTER_LINEAR,
+                       param::Resize::InterpolationMode::INTER_CUBIC,
+                       param::Resize::InterpolationMode::INTER_AREA}) {
+        cur_param.imode = imode;
+        for (size_t c : {1, 3}) {
+            args.emplace_back(cur_param, TensorShape{1, 97, 131, c},
+                              TensorShape{1, 130, 67, c});
+            args.emplace_back(cur_param, TensorShape{2, 200, 75, c},
+                              TensorShape{2, 61, 150, c});
+            //! integer scale, handled by the fast area path
+            args.emplace_back(cur_param, TensorShape{1, 128, 90, c},
+                              TensorShape{1, 64, 45, c});
+            args.emplace_back(cur_param, TensorShape{1, 200, 131, c},
+                              TensorShape{1, 61, 67, c});
+        }
+    }
+    Checker<Resize> checker(handle());
+
+    for (auto &&arg: args) {
+        checker.set_param(arg.param)
+            .set_dtype(0, dtype::Uint8())
+            .set_dtype(1, dtype::Uint8())
+            .set_epsilon(1+1e-3)
+            .execs({arg.src, arg.dst});
+    }
+
+    for (auto &&arg: args) {
+        checker.set_param(arg.param)
+            .set_dtype(0, dtype::Float32())
+            .set_dtype(1, dtype::Float32())
+            .execs({arg.src, arg.dst});
+    }
+}
+
 } // namespace test
 } // namespace megdnn
 // vim: syntax=cpp.doxygen
@@ -137,6 +137,44 @@ TEST_F(X86, TYPE_CVT_2) {
                                                  static_cast<uint8_t>(144)))
             .execs({{1, 32, 24, 128}, {1, 32, 24, 128}});
 }
+namespace {
+void run_quantized_type_cvt(Handle* handle) {
+    Checker<TypeCvt> checker(handle);
+    UniformIntRNG rng8{INT8_MIN >> 1, INT8_MAX >> 1};
+    checker.set_rng(0, &rng8);
+    std::vector<DType> dtypes = {
+            dtype::Float32(), dtype::QuantizedS8(0.245121f),
+            dtype::QuantizedS32(0.0003f),
+            dtype::Quantized8Asymm(0.3f, static_cast<uint8_t>(8))};
+    for (auto sdtype : dtypes)
+        for (auto ddtype : dtypes) {
+            if (sdtype == dtype::Float32() && ddtype == dtype::Float32())
+                continue;
+            checker.set_dtype(0, sdtype).set_dtype(1, ddtype);
+            //! contiguous, large enough to be split among threads
+            for (size_t size : {63, 65, 16384, 100003}) {
+                checker.execs({{size}, {size}});
+            }
+            //! rows contiguous in both tensors but strided outer dims
+            checker.execl({TensorLayout({4, 9, 67}, {1000, 100, 1}, sdtype),
+                           TensorLayout({4, 9, 67}, {603, 67, 1}, ddtype)});
+            checker.execl({TensorLayout({2, 3, 300}, {900, 300, 1}, sdtype),
+                           TensorLayout({2, 3, 300}, {2000, 600, 1}, ddtype)});
+            checker.execl(
+                    {TensorLayout({8, 1, 2048}, {4096, 7, 1}, sdtype),
+                     TensorLayout({8, 1, 2048}, {2048, 2048, 1}, ddtype)});
+        }
+}
+}  // anonymous namespace
+
+TEST_F(X86, TYPE_CVT_QUANTIZED) {
+    run_quantized_type_cvt(handle());
+}
+
+TEST_F(X86_MULTI_THREADS, TYPE_CVT_QUANTIZED) {
+    run_quantized_type_cvt(handle());
+}
+
 #if MEGDNN_WITH_BENCHMARK
 TEST_F(X86, BENCHMARK_TYPE_CVT) {
     auto handle_naive = create_cpu_handle(2);
@@ -541,7 +541,11 @@ def optimize_for_inference(
     fuse_conv_bias_nonlinearity=False,
     use_tensor_core=False,
     fuse_conv_bias_with_z=False,
-    use_nchw88=False
+    use_nchw88=False,
+    select_nchw88_by_cost=False,
+    fuse_conv_bias_epilogue=False,
+    propagate_quantized_dtype=False,
+    fuse_image_preprocess=False
 ):
     """optimize computing graph for inference
 
@@ -561,6 +565,18 @@ def optimize_for_inference(
         into one opr. This is supported only in NHWCD4 format.
     :param use_nchw88: whether to use NCHW4 tensor format. This maybe faster some
         times.
+    :param select_nchw88_by_cost: when use_nchw88 is set, only convert the
+        oprs that are estimated to be faster in NCHW88 after counting the
+        relayouts between formats, instead of the whole graph.
+    :param fuse_conv_bias_epilogue: whether to fold per-channel scale/shift
+        into conv_bias and fuse following pooling on CPU. Requires
+        fuse_conv_bias_nonlinearity.
+    :param propagate_quantized_dtype: whether to keep quantized tensors
+        quantized through reshape, dimshuffle, concat, max pooling and relu,
+        removing the dequantize/requantize pairs around them.
+    :param fuse_image_preprocess: whether to fuse color conversion, resize,
+        astype, transpose to NCHW and normalization of uint8 NHWC input
+        images into one opr.
 
 
     :return: list of transformed vars corresponding to given output vars
@@ -577,6 +593,10 @@ def optimize_for_inference(
         "use_tensor_core",
         "fuse_conv_bias_with_z",
         "use_nchw88",
+        "select_nchw88_by_cost",
+        "fuse_conv_bias_epilogue",
+        "propagate_quantized_dtype",
+        "fuse_image_preprocess",
     ]:
         if settings[i]:
             getattr(opt, "enable_{}".format(i))()
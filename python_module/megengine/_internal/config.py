@@ -138,9 +138,14 @@ def set_comp_graph_option(comp_graph, name, val):
             * "seq_opt.enable_seq_comp_node_opt": bool
             * "force_dynamic_alloc": bool
             * "var_sanity_check_first_run": bool
+            * "var_sanity_check_mem_fwd_only": bool; only check vars whose
+              memory is forwarded from or to other vars in var sanity check
             * "enable_sublinear_memory_opt": bool
             * "enable_memory_swap": bool; whether to enable memory swap; it
                 usually performs worse than sublinear memory
+            * "enable_memory_offload": bool; whether to offload long-lived
+              vars to host memory and prefetch them back asynchronously
+              before they are used again; it also works on CPU comp nodes
             * "enable_var_mem_defragment": bool
             * "allocate_static_mem_after_graph_compile": bool
             * "enable_grad_var_static_reshape": bool:
@@ -175,6 +180,10 @@ def set_comp_graph_option(comp_graph, name, val):
                  * ``2``: (default) level-2: level-1, plus global optimization
                    before graph compiling
                  * ``3``: also enable JIT
+            * "compile_cache_size": int; number of compiling results to be
+              cached, so compiling recurring outputs again (e.g. switching
+              between training and evaluation) can reuse the optimized graph
+              and operator sequence; ``0`` (default) to disable
     :param val: new option value
     :return: old option value
     """
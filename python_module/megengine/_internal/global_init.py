@@ -32,8 +32,12 @@ mgb._timed_func_set_fork_exec_path(
     os.path.join(os.path.dirname(__file__), "_timed_func_fork_exec_entry.py"),
 )
 
-persistent_cache_impl_ins = PersistentCacheOnServer()
-mgb._PersistentCache.reg(persistent_cache_impl_ins)
+if os.getenv("MGB_PERSISTENT_CACHE_FILE"):
+    # a memory-mapped file shared by all the processes on this host
+    mgb._PersistentCache.reg_mmap_file(os.getenv("MGB_PERSISTENT_CACHE_FILE"))
+else:
+    persistent_cache_impl_ins = PersistentCacheOnServer()
+    mgb._PersistentCache.reg(persistent_cache_impl_ins)
 
 PyStackExtracterImplIns = PyStackExtracterImpl()
 PyStackExtracterImpl.reg(PyStackExtracterImplIns)
@@ -254,3 +254,88 @@ def load_tensor_binary(fobj):
         shape.pop(-1)
     name = fobj.read(name_len).decode("ascii")
     return np.fromfile(fobj, dtype=DTYPE_LIST[dtype]).reshape(shape), name
+
+
+AsyncIODumpRecord = collections.namedtuple(
+    "AsyncIODumpRecord",
+    ["exec_id", "var_id", "opr_id", "var_name", "opr_name", "value"],
+)
+
+
+def load_async_io_dump(fobj):
+    """load all the values dumped by the :class:`AsyncOprIODump` plugin into a
+    single file; quantized values are loaded as their storage type like
+    :func:`load_tensor_binary`
+
+    :param fobj: file object, or a string that contains the file name
+    :return: list of :class:`AsyncIODumpRecord`
+    """
+    if isinstance(fobj, str):
+        with open(fobj, "rb") as fin:
+            return load_async_io_dump(fin)
+
+    DTYPE_LIST = {
+        0: np.float32,
+        1: np.uint8,
+        2: np.int8,
+        3: np.int16,
+        4: np.int32,
+        9: np.float16,
+        100000: np.uint8,
+        100001: np.int32,
+        100002: np.int8,
+    }
+    MAGIC = 0x31444F494142474D
+
+    buf = fobj.read()
+    file_header_fmt = struct.Struct("<QII")
+    magic, _, max_ndim = file_header_fmt.unpack_from(buf)
+    assert magic == MAGIC, "not an async io dump file"
+    rec_header_fmt = struct.Struct("<4Q2If3I{}Q".format(max_ndim))
+    footer_fmt = struct.Struct("<3Q")
+
+    offsets = None
+    if len(buf) >= file_header_fmt.size + footer_fmt.size:
+        index_offset, nr_record, magic = footer_fmt.unpack_from(
+            buf, len(buf) - footer_fmt.size
+        )
+        if (
+            magic == MAGIC
+            and index_offset + nr_record * 8 + footer_fmt.size == len(buf)
+        ):
+            offsets = struct.unpack_from(
+                "<{}Q".format(nr_record), buf, index_offset
+            )
+    if offsets is None:
+        # the writer did not finish; scan the complete records
+        offsets = []
+        offset = file_header_fmt.size
+        while offset + rec_header_fmt.size <= len(buf):
+            hdr = rec_header_fmt.unpack_from(buf, offset)
+            end = offset + rec_header_fmt.size + hdr[8] + hdr[9] + hdr[3]
+            if end > len(buf):
+                break
+            offsets.append(offset)
+            offset = end
+
+    ret = []
+    for offset in offsets:
+        hdr = rec_header_fmt.unpack_from(buf, offset)
+        exec_id, var_id, opr_id, nr_bytes, dtype, ndim = hdr[:6]
+        var_name_len, opr_name_len = hdr[8:10]
+        shape = hdr[10 : 10 + ndim]
+        assert dtype in DTYPE_LIST, "Cannot load dtype {}".format(dtype)
+        ptr = offset + rec_header_fmt.size
+        var_name = buf[ptr : ptr + var_name_len].decode("ascii")
+        ptr += var_name_len
+        opr_name = buf[ptr : ptr + opr_name_len].decode("ascii")
+        ptr += opr_name_len
+        np_dtype = np.dtype(DTYPE_LIST[dtype])
+        value = np.frombuffer(
+            buf, dtype=np_dtype, count=nr_bytes // np_dtype.itemsize, offset=ptr
+        )
+        value = value.reshape(shape).copy()
+        ret.append(
+            AsyncIODumpRecord(exec_id, var_id, opr_id, var_name, opr_name, value)
+        )
+    return ret
@@ -8,98 +8,224 @@
 # "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 import binascii
 import os
+import pickle
 import queue
-import subprocess
-from multiprocessing import Queue
+import struct
 
-import pyarrow.plasma as plasma
+import numpy as np
 
-MGE_PLASMA_MEMORY = int(os.environ.get("MGE_PLASMA_MEMORY", 4000000000))  # 4GB
+from .._internal.mgb import _ShmBatchQueue
 
+_DEFAULT_SLOT_SIZE = 256 * 1024 * 1024
+
+# alignment of arrays in a slot
+_ALIGN = 64
+
+_META_HEADER = struct.Struct("<Q")
+
+
+def _align(size):
+    return (size + _ALIGN - 1) // _ALIGN * _ALIGN
+
+
+class _ArrayRef(int):
+    """placeholder of an array in the pickled batch structure, whose value is
+    the index of the array"""
+
+
+def _is_shm_array(obj):
+    return isinstance(obj, np.ndarray) and not obj.dtype.hasobject
 
-class _PlasmaStoreManager:
-    def __init__(self):
-        self.socket_name = "/tmp/mge_plasma_{}".format(
-            binascii.hexlify(os.urandom(8)).decode()
-        )
-        debug_flag = bool(os.environ.get("MGE_DATALOADER_PLASMA_DEBUG", 0))
-        self.plasma_store = subprocess.Popen(
-            ["plasma_store", "-s", self.socket_name, "-m", str(MGE_PLASMA_MEMORY),],
-            stdout=None if debug_flag else subprocess.DEVNULL,
-            stderr=None if debug_flag else subprocess.DEVNULL,
-        )
 
-    def __del__(self):
-        if self.plasma_store and self.plasma_store.returncode is None:
-            self.plasma_store.kill()
+def _extract_arrays(obj, arrays):
+    """replace arrays in ``obj`` by :class:`_ArrayRef` and append them to
+    ``arrays``"""
+    if _is_shm_array(obj):
+        arrays.append(obj)
+        return _ArrayRef(len(arrays) - 1)
+    if isinstance(obj, tuple) and hasattr(obj, "_fields"):  # namedtuple
+        return type(obj)(*(_extract_arrays(i, arrays) for i in obj))
+    if isinstance(obj, (tuple, list)):
+        return type(obj)(_extract_arrays(i, arrays) for i in obj)
+    if isinstance(obj, dict):
+        return type(obj)((k, _extract_arrays(v, arrays)) for k, v in obj.items())
+    return obj
 
 
-# Each process only need to start one plasma store, so we set it as a global variable.
-# TODO: how to share between different processes?
-MGE_PLASMA_STORE_MANAGER = _PlasmaStoreManager()
+def _fill_arrays(obj, arrays):
+    """inverse of :func:`_extract_arrays`"""
+    if isinstance(obj, _ArrayRef):
+        return arrays[obj]
+    if isinstance(obj, tuple) and hasattr(obj, "_fields"):
+        return type(obj)(*(_fill_arrays(i, arrays) for i in obj))
+    if isinstance(obj, (tuple, list)):
+        return type(obj)(_fill_arrays(i, arrays) for i in obj)
+    if isinstance(obj, dict):
+        return type(obj)((k, _fill_arrays(v, arrays)) for k, v in obj.items())
+    return obj
 
 
-class PlasmaShmQueue:
-    def __init__(self, maxsize: int = 0):
-        r"""Use pyarrow in-memory plasma store to implement shared memory queue.
+class ShmBatchQueue:
+    #: max number of batches returned by :meth:`get` viewing shared memory
+    MAX_BORROWED = 2
 
-        Compared to native `multiprocess.Queue`, `PlasmaShmQueue` avoid pickle/unpickle
-        and communication overhead, leading to better performance in multi-process
-        application.
+    def __init__(self, maxsize: int = 2, slot_size: int = None):
+        r"""A queue backed by a shared memory ring buffer implemented in C++,
+        for passing batches between processes on the same host.
+
+        Numpy arrays in a batch are copied into shared memory once by
+        :meth:`put`, and :meth:`get` returns arrays viewing the shared memory
+        directly, so they can be borrowed by ``HostTensorND`` without copy. The
+        remaining structure of the batch is pickled.
+
+        A slot is reused after all arrays of the batch returned by :meth:`get`
+        are garbage collected. At most :attr:`MAX_BORROWED` batches are
+        returned without copy at the same time; further batches are copied out
+        so the producers would never be blocked by the consumer.
+
+        The queue object must be created before worker processes are started,
+        and can be passed to them either by fork or pickle.
 
         :type maxsize: int
-        :param maxsize: maximum size of the queue, `None` means no limit. (default: ``None``)
+        :param maxsize: number of slots that can be filled by producers while
+            the consumer holds :attr:`MAX_BORROWED` batches. (default: ``2``)
+        :type slot_size: int
+        :param slot_size: max size of a batch in bytes. Default is given by the
+            ``MGE_DATALOADER_SHM_SLOT_SIZE`` environment variable, or 256MB.
+            Shared memory is only allocated when it is written.
         """
+        assert maxsize > 0, "maxsize must be positive, got {}".format(maxsize)
+        if slot_size is None:
+            slot_size = int(
+                os.environ.get("MGE_DATALOADER_SHM_SLOT_SIZE", _DEFAULT_SLOT_SIZE)
+            )
+        name = "/mge_batch_queue_{}_{}".format(
+            os.getpid(), binascii.hexlify(os.urandom(8)).decode()
+        )
+        self._queue = _ShmBatchQueue(
+            name, maxsize + self.MAX_BORROWED, slot_size, True
+        )
 
-        self.socket_name = MGE_PLASMA_STORE_MANAGER.socket_name
+    def __getstate__(self):
+        return self._queue._name()
 
-        # TODO: how to catch the exception happened in `plasma.connect`?
-        self.client = None
+    def __setstate__(self, state):
+        self._queue = _ShmBatchQueue(state, 0, 0, False)
 
-        # Used to store the header for the data.(ObjectIDs)
-        self.queue = Queue(maxsize)  # type: Queue
+    @staticmethod
+    def _get_timeout(block, timeout):
+        if not block:
+            return 0
+        if timeout is None:
+            return -1
+        return max(timeout, 0)
 
-    def put(self, data, block=True, timeout=None):
-        if self.client is None:
-            self.client = plasma.connect(self.socket_name)
-        try:
-            object_id = self.client.put(data)
-        except plasma.PlasmaStoreFull:
-            raise RuntimeError("plasma store out of memory!")
-        try:
-            self.queue.put(object_id, block, timeout)
-        except queue.Full:
-            self.client.delete([object_id])
+    def _write(self, meta, arrays, write_array, block, timeout):
+        """write a batch into a slot
+
+        :param meta: pickled structure of the batch
+        :param arrays: list of ``(dtype, shape)`` of arrays to be written
+        :param write_array: callable ``(index, dest)`` to fill an array
+        """
+        offsets = []
+        size = _align(_META_HEADER.size + len(meta))
+        for dtype, shape in arrays:
+            offsets.append(size)
+            size = _align(size + dtype.itemsize * int(np.prod(shape)))
+
+        slot = self._queue._reserve(size, self._get_timeout(block, timeout))
+        if slot < 0:
             raise queue.Full
+        try:
+            buf = self._queue._slot_buffer(slot)
+            _META_HEADER.pack_into(buf, 0, len(meta))
+            buf[_META_HEADER.size : _META_HEADER.size + len(meta)] = np.frombuffer(
+                meta, dtype=np.uint8
+            )
+            for i, ((dtype, shape), offset) in enumerate(zip(arrays, offsets)):
+                nbytes = dtype.itemsize * int(np.prod(shape))
+                dest = buf[offset : offset + nbytes].view(dtype).reshape(shape)
+                write_array(i, dest)
+            del buf
+        except BaseException:
+            self._queue._cancel(slot)
+            raise
+        self._queue._commit(slot, size)
+
+    def put(self, data, block=True, timeout=None):
+        arrays = []
+        struct_ = _extract_arrays(data, arrays)
+        meta = pickle.dumps(
+            (struct_, [(i.dtype.str, i.shape) for i in arrays]),
+            protocol=pickle.HIGHEST_PROTOCOL,
+        )
+
+        def write_array(idx, dest):
+            np.copyto(dest, arrays[idx], casting="no")
+
+        self._write(
+            meta, [(i.dtype, i.shape) for i in arrays], write_array, block, timeout
+        )
+
+    def put_concat(self, parts, block=True, timeout=None):
+        r"""Concatenate corresponding arrays of several parts along the first
+        axis, and put the result as a tuple. Arrays are concatenated directly
+        into shared memory.
+
+        :param parts: list of sequences of arrays with the same length
+        """
+        fields = list(zip(*parts))
+        arrays = []
+        for field in fields:
+            dtype = np.result_type(*field)
+            shape = list(field[0].shape)
+            shape[0] = sum(i.shape[0] for i in field)
+            arrays.append((dtype, tuple(shape)))
+        meta = pickle.dumps(
+            (
+                tuple(_ArrayRef(i) for i in range(len(arrays))),
+                [(dtype.str, shape) for dtype, shape in arrays],
+            ),
+            protocol=pickle.HIGHEST_PROTOCOL,
+        )
+
+        def write_array(idx, dest):
+            np.concatenate(fields[idx], axis=0, out=dest)
+
+        self._write(meta, arrays, write_array, block, timeout)
 
     def get(self, block=True, timeout=None):
-        if self.client is None:
-            self.client = plasma.connect(self.socket_name)
-        object_id = self.queue.get(block, timeout)
-        if not self.client.contains(object_id):
-            raise RuntimeError(
-                "ObjectID: {} not found in plasma store".format(object_id)
-            )
-        data = self.client.get(object_id)
-        self.client.delete([object_id])
-        return data
+        buf = self._queue._acquire(self._get_timeout(block, timeout))
+        if buf is None:
+            raise queue.Empty
+        copy = self._queue._nr_acquired() > self.MAX_BORROWED
+
+        (meta_size,) = _META_HEADER.unpack_from(buf, 0)
+        struct_, array_descs = pickle.loads(
+            buf[_META_HEADER.size : _META_HEADER.size + meta_size].tobytes()
+        )
+        offset = _align(_META_HEADER.size + meta_size)
+        arrays = []
+        for dtype, shape in array_descs:
+            dtype = np.dtype(dtype)
+            nbytes = dtype.itemsize * int(np.prod(shape))
+            arr = buf[offset : offset + nbytes].view(dtype).reshape(shape)
+            if copy:
+                arr = arr.copy()
+            arrays.append(arr)
+            offset = _align(offset + nbytes)
+        # if copied, the slot is released when buf is deleted
+        del buf
+        return _fill_arrays(struct_, arrays)
 
     def qsize(self):
-        return self.queue.qsize()
+        return self._queue._nr_ready()
 
     def empty(self):
-        return self.queue.empty()
-
-    def join(self):
-        self.queue.join()
-
-    def disconnect_client(self):
-        if self.client is not None:
-            self.client.disconnect()
+        return self.qsize() == 0
 
     def close(self):
-        self.queue.close()
-        self.disconnect_client()
-
-    def cancel_join_thread(self):
-        self.queue.cancel_join_thread()
+        """wake up all blocked callers and remove the shared memory name;
+        further calls to :meth:`put` and :meth:`get` would fail"""
+        self._queue._close()
+        self._queue._unlink()
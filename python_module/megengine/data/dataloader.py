@@ -188,10 +188,11 @@ class _ParallelDataLoaderIter(_BaseDataLoaderIter):
             multiprocessing.Queue(maxsize=1) for _ in range(self.num_workers)
         ]
 
-        # use shared-memory queue implemented by pyarrow plasma store.
-        from ._queue import PlasmaShmQueue
+        # batches are passed to the main process through shared memory, and
+        # can be fed to tensors without copy.
+        from ._queue import ShmBatchQueue
 
-        self.batch_queue = PlasmaShmQueue(maxsize=2)
+        self.batch_queue = ShmBatchQueue(maxsize=2)
 
         self.task_feeding_worker = multiprocessing.Process(
             target=self._task_feeding_loop,
@@ -342,16 +343,15 @@ class _ParallelDataLoaderIter(_BaseDataLoaderIter):
                     self.target_batch_idx.value += 1
                 continue
 
-            # Merge different parts.
-            full_batch = [[] for _ in range(len(gathered_data[target_batch_idx][0]))]
-            for idx in range(self.num_workers):
-                for i, field in enumerate(gathered_data[target_batch_idx][idx]):
-                    full_batch[i].append(field)
-            full_batch = tuple([np.concatenate(field, axis=0) for field in full_batch])
+            # Merge different parts directly into the shared memory.
+            parts = [
+                gathered_data[target_batch_idx][idx]
+                for idx in range(self.num_workers)
+            ]
 
             while True:
                 try:
-                    batch_queue.put(full_batch, timeout=1)
+                    batch_queue.put_concat(parts, timeout=1)
                     break
                 except queue.Full:
                     if self.shutdown_flag.value == 1:
@@ -364,8 +364,6 @@ class _ParallelDataLoaderIter(_BaseDataLoaderIter):
             with self.target_batch_idx.get_lock():
                 self.target_batch_idx.value += 1
 
-        batch_queue.disconnect_client()
-
     def _data_selecting_loop(self, batch_part_queues, batch_queue):
         r"""Make sure that batch is generated exactly with the same order as generated indices."""
         buffer_batches = {}
@@ -431,8 +429,6 @@ class _ParallelDataLoaderIter(_BaseDataLoaderIter):
             with self.target_batch_idx.get_lock():
                 self.target_batch_idx.value += 1
 
-        batch_queue.disconnect_client()
-
     def _check_workers(self):
         """Check the status of each worker and restart if necessary."""
         if not self.data_collecting_worker.is_alive():
@@ -537,7 +533,6 @@ class _ParallelDataLoaderIter(_BaseDataLoaderIter):
             q.cancel_join_thread()
             q.close()
 
-        self.batch_queue.cancel_join_thread()
         self.batch_queue.close()
 
     def __del__(self):
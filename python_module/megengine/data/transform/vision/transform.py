@@ -8,11 +8,13 @@
 # "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 import collections.abc
 import math
+import os
 from typing import Sequence, Tuple
 
 import cv2
 import numpy as np
 
+from megengine._internal.mgb import _BatchAugmenter
 from megengine.data.transform import Transform
 from megengine.data.transform.vision import functional as F
 
@@ -38,6 +40,7 @@ __all__ = [
     "HueTransform",
     "ColorJitter",
     "Lighting",
+    "BatchAugment",
 ]
 
 
@@ -1027,3 +1030,166 @@ class Lighting(VisionTransform):
 
     def _apply_mask(self, mask):
         return mask
+
+
+class BatchAugment(VisionTransform):
+    r"""Apply a pipeline of augmentations to a whole batch in C++, using
+    megdnn CPU kernels on a thread pool without holding the GIL, and collate
+    the augmented images into one array.
+
+    Each step is either an instance of :class:`Resize`, :class:`RandomResizedCrop`,
+    :class:`CenterCrop`, :class:`RandomHorizontalFlip` or :class:`RandomVerticalFlip`,
+    or a ``(name, params)`` tuple for steps without a python counterpart:
+
+        * ``("rotation", dict(max_degree, prob=1, interpolation=cv2.INTER_LINEAR, border_value=0))``
+          – rotate about the center by a random angle in ``[-max_degree, max_degree]``.
+        * ``("rotate90", dict(clockwise=True, prob=1))``
+        * ``("gaussian_blur", dict(kernel_size, sigma_range, prob=1))``
+          – ``kernel_size`` must be odd; sigma is uniformly sampled from ``sigma_range``.
+        * ``("cvt_color", dict(mode))`` – ``mode`` is the name of a megdnn
+          CvtColor mode, such as ``"BGR2GRAY"``.
+
+    :class:`Normalize` and :class:`ToMode` are only allowed at the end of the
+    pipeline, and are fused into collation.
+
+    Images must be uint8 arrays in HWC layout with 1 or 3 channels, and all
+    steps together must produce images of the same shape. The image of each
+    output sample is a view of the collated batch.
+
+    :param transforms: List of augmentation steps.
+    :param nr_threads: Number of threads. Default: number of CPUs.
+    :param order: The same with ``VisionTransform``. Only images are
+        transformed; "category" and "info" data are passed through.
+
+    Example:
+
+    ..testcode::
+
+        from megengine.data.transform import BatchAugment, RandomResizedCrop, RandomHorizontalFlip, Normalize, ToMode
+
+        transform_func = BatchAugment([
+            RandomResizedCrop(224),
+            RandomHorizontalFlip(),
+            ("rotation", dict(max_degree=10, prob=0.5)),
+            Normalize(mean=[103.530, 116.280, 123.675], std=[57.375, 57.120, 58.395]),
+            ToMode("CHW"),
+        ])
+    """
+
+    # cv2 interpolation flags to megdnn InterpolationMode
+    _IMODE = {
+        cv2.INTER_NEAREST: 0,
+        cv2.INTER_LINEAR: 1,
+        cv2.INTER_AREA: 2,
+        cv2.INTER_CUBIC: 3,
+        cv2.INTER_LANCZOS4: 4,
+    }
+
+    def __init__(self, transforms, nr_threads=None, *, order=None):
+        super().__init__(order)
+        for k in self.order[1:]:
+            if not (k.endswith("category") or k.endswith("info")):
+                raise ValueError("{} is unsupported data type".format(k))
+        if self.order[0] != "image":
+            raise ValueError("the first data type must be image")
+        if nr_threads is None:
+            nr_threads = os.cpu_count()
+        self.nr_threads = nr_threads
+        self._ops, self._output = self._convert(transforms)
+        self._augmenter = None
+
+    def _imode(self, interpolation):
+        if interpolation not in self._IMODE:
+            raise ValueError("unsupported interpolation: {}".format(interpolation))
+        return self._IMODE[interpolation]
+
+    def _convert(self, transforms):
+        """convert transforms into a list of ``(name, prob, params, mode)``
+        and output options"""
+        ops = []
+        chw, mean, std = False, None, None
+        for t in transforms:
+            if mean is not None and not isinstance(t, ToMode) or chw:
+                raise ValueError(
+                    "Normalize and ToMode must be at the end of the pipeline"
+                )
+            if isinstance(t, Resize):
+                size = t.output_size
+                if isinstance(size, int):
+                    size = (size, 0)
+                ops.append(("resize", 1, [*size, self._imode(t.interpolation)], ""))
+            elif isinstance(t, RandomResizedCrop):
+                params = [*t.output_size, *t.scale_range, *t.ratio_range]
+                params.append(self._imode(t.interpolation))
+                ops.append(("random_resized_crop", 1, params, ""))
+            elif isinstance(t, CenterCrop):
+                ops.append(("center_crop", 1, list(t.output_size), ""))
+            elif isinstance(t, RandomHorizontalFlip):
+                ops.append(("flip", t.prob, [1, 0], ""))
+            elif isinstance(t, RandomVerticalFlip):
+                ops.append(("flip", t.prob, [0, 1], ""))
+            elif isinstance(t, Normalize):
+                mean = t.mean.flatten().tolist()
+                std = t.std.flatten().tolist()
+            elif isinstance(t, ToMode):
+                chw = t.mode == "CHW"
+            elif isinstance(t, tuple) and len(t) == 2:
+                ops.append(self._convert_spec(*t))
+            else:
+                raise ValueError("unsupported transform: {}".format(t))
+        return ops, (chw, mean is not None, mean or [], std or [])
+
+    def _convert_spec(self, name, params):
+        params = dict(params)
+        prob = params.pop("prob", 1)
+        mode = ""
+        if name == "rotation":
+            values = [
+                params.pop("max_degree"),
+                self._imode(params.pop("interpolation", cv2.INTER_LINEAR)),
+                params.pop("border_value", 0),
+            ]
+        elif name == "rotate90":
+            values = [int(params.pop("clockwise", True))]
+        elif name == "gaussian_blur":
+            values = [params.pop("kernel_size"), *params.pop("sigma_range")]
+        elif name == "cvt_color":
+            values = []
+            mode = params.pop("mode")
+        else:
+            raise ValueError("unsupported augmentation: {}".format(name))
+        if params:
+            raise ValueError(
+                "unknown params for {}: {}".format(name, ", ".join(params))
+            )
+        return name, prob, values, mode
+
+    def _get_augmenter(self):
+        if self._augmenter is None:
+            aug = _BatchAugmenter(self.nr_threads)
+            for name, prob, params, mode in self._ops:
+                aug._add_op(name, prob, params, mode)
+            aug._set_output(*self._output)
+            self._augmenter = aug
+        return self._augmenter
+
+    def __getstate__(self):
+        # the C++ object is rebuilt in each worker process
+        state = self.__dict__.copy()
+        state["_augmenter"] = None
+        return state
+
+    def apply_batch(self, inputs: Sequence[Tuple]):
+        images = [self._get_image(input) for input in inputs]
+        seed = int(np.random.randint(np.iinfo(np.int64).max, dtype=np.int64))
+        batch = self._get_augmenter()._apply(images, seed)
+        outputs = []
+        for input, image in zip(inputs, batch):
+            if isinstance(input, tuple):
+                outputs.append((image,) + input[1:])
+            else:
+                outputs.append(image)
+        return tuple(outputs)
+
+    def apply(self, input: Tuple):
+        return self.apply_batch([input])[0]
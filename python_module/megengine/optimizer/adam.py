@@ -8,8 +8,11 @@
 # "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 from typing import Iterable, Tuple, Union
 
+import megengine._internal as mgb
+
 from ..core import Buffer, Parameter
 from .internal import add_update_fastpath as add_update
+from .internal import fused_optimizer_update_fastpath as fused_update
 from .optimizer import Optimizer
 
 
@@ -24,6 +27,11 @@ class Adam(Optimizer):
     :param eps: term added to the denominator to improve numerical stability
         Default: 1e-8
     :param weight_decay: weight decay (L2 penalty). Default: 0
+    :param fused: whether to update all the parameters of a group by one fused
+        kernel. The parameters, gradients and states are packed into contiguous
+        buffers at the first step, and the gradients are not modified by weight
+        decay. All the parameters of a group must be float32 on the same
+        device. Default: False
     """
 
     def __init__(
@@ -33,6 +41,7 @@ class Adam(Optimizer):
         betas: Tuple[float, float] = (0.9, 0.999),
         eps: float = 1e-8,
         weight_decay: float = 0.0,
+        fused: bool = False,
     ):
         if lr < 0.0:
             raise ValueError("Invalid learning rate: {}".format(lr))
@@ -44,6 +53,9 @@ class Adam(Optimizer):
             raise ValueError("Invalid beta parameter at index 1: {}".format(betas[1]))
 
         defaults = dict(lr=lr, weight_decay=weight_decay, betas=betas, eps=eps)
+        self._fused = fused
+        # step of each fused param group
+        self._fused_step = dict()
         super().__init__(params, defaults)
 
     def _create_state(self, param_group):
@@ -58,6 +70,32 @@ class Adam(Optimizer):
         eps = param_group["eps"]
         beta0, beta1 = param_group["betas"]
 
+        if self._fused:
+            key = id(param_group)
+            if key not in self._packed:
+                # continue from the step of the (possibly loaded) states
+                first_param = param_group["params"][0]
+                self._fused_step[key] = int(self._state[first_param]["step"].numpy())
+            param, grad, exp_avg, exp_avg_sq, step = self._get_packed(
+                param_group, ["exp_avg", "exp_avg_sq", "step"]
+            )
+            self._fused_step[key] += 1
+            # keep the step of each param, which is saved in state_dict()
+            mgb.mgb._add_update_fastpath(step, step, 1.0, 0.0, 1.0)
+            fused_update(
+                param,
+                grad,
+                exp_avg,
+                exp_avg_sq,
+                mode="adam",
+                lr=lr,
+                weight_decay=weight_decay,
+                betas=(beta0, beta1),
+                eps=eps,
+                step=self._fused_step[key],
+            )
+            return
+
         for param in param_group["params"]:
             if not param.requires_grad:
                 continue
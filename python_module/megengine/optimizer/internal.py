@@ -6,7 +6,9 @@
 # Unless required by applicable law or agreed to in writing,
 # software distributed under the License is distributed on an
 # "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-from typing import Union
+from typing import List, Optional, Tuple, Union
+
+import numpy as np
 
 import megengine._internal as mgb
 
@@ -49,3 +51,66 @@ def add_update_fastpath(
 
     mgb.mgb._add_update_fastpath(get_v(dest), get_v(delta), alpha, beta, bias)
     return dest
+
+
+def pack_tensors(tensors: List[Tensor]) -> mgb.SharedND:
+    """make the values of ``tensors`` views of a new packed 1-dim buffer, so
+    they can be updated by one kernel. Each tensor starts at an offset aligned
+    to 16 elements, like the table generated for ParamPackConcat, and the gaps
+    are filled with zeros.
+    """
+    assert tensors, "no tensor to be packed"
+    comp_node = tensors[0].device
+    offsets = []
+    size = 0
+    for t in tensors:
+        assert (
+            t.device == comp_node and t.dtype == np.float32
+        ), "packed tensors must be float32 on the same device"
+        offsets.append(size)
+        size += (int(np.prod(t.shape)) + 15) // 16 * 16
+    value = np.zeros(size, dtype=np.float32)
+    for t, offset in zip(tensors, offsets):
+        v = t.numpy().ravel()
+        value[offset : offset + v.size] = v
+    packed = mgb.make_shared(comp_node, value=value)
+    for t, offset in zip(tensors, offsets):
+        t._Tensor__val.share_memory_from(packed, offset)
+    return packed
+
+
+def fused_optimizer_update_fastpath(
+    param: mgb.SharedND,
+    grad: mgb.SharedND,
+    state0: Optional[mgb.SharedND] = None,
+    state1: Optional[mgb.SharedND] = None,
+    *,
+    mode: str,
+    lr: float,
+    weight_decay: float = 0.0,
+    momentum: float = 0.0,
+    betas: Tuple[float, float] = (0.9, 0.999),
+    eps: float = 1e-8,
+    step: int = 1
+):
+    """update packed parameters by one dnn/fused_optimizer_update kernel,
+    bypassing the computing graph like :func:`add_update_fastpath`.
+
+    :param mode: "sgd" or "adam"; see :class:`.SGD` and :class:`.Adam` for the
+        meaning of the states
+    """
+    mode_id = {"sgd": 0, "adam": 1}[mode]
+    mgb.mgb._fused_optimizer_update_fastpath(
+        param,
+        grad,
+        state0,
+        state1,
+        mode_id,
+        lr,
+        weight_decay,
+        momentum,
+        betas[0],
+        betas[1],
+        eps,
+        step,
+    )
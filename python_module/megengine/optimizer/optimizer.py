@@ -21,6 +21,7 @@ from ..distributed import all_reduce_sum, bcast_param, get_world_size, is_distri
 from ..functional import add_update
 from ..functional import grad as grad_func
 from ..jit import sideeffect
+from .internal import pack_tensors
 
 
 class _RequiredParameter:
@@ -49,6 +50,8 @@ class Optimizer(metaclass=ABCMeta):
         self._defaults = defaults
         self._bcast_iter = 0
         self._bcast_period = bcast_period
+        # packed buffers of param groups updated by fused kernels
+        self._packed = dict()
 
         if isinstance(params, (Parameter, dict)):
             params = [params]
@@ -139,6 +142,29 @@ class Optimizer(metaclass=ABCMeta):
         state = Buffer(value=initializer)
         state_dict[state_name] = state
 
+    def _get_packed(self, param_group, state_names):
+        r"""Get the params, grads and the given states of a param group packed
+        into contiguous buffers, to be updated by a fused kernel. They are
+        packed on the first call, and the tensors become views of the buffers.
+
+        :return: list of :class:`.SharedND`, in the order of params, grads and
+            the states in ``state_names``
+        """
+        key = id(param_group)
+        packed = self._packed.get(key)
+        if packed is None:
+            params = param_group["params"]
+            for param in params:
+                if not isinstance(param.grad, Buffer):
+                    raise TypeError(
+                        "grad must be a Buffer, maybe you forget to call backward()?"
+                    )
+            packed = [pack_tensors(params), pack_tensors([p.grad for p in params])]
+            for name in state_names:
+                packed.append(pack_tensors([self._state[p][name] for p in params]))
+            self._packed[key] = packed
+        return packed
+
     @abstractmethod
     def _create_state(self, param_group):
         pass
@@ -287,3 +313,6 @@ class Optimizer(metaclass=ABCMeta):
                 "loaded state dict contains a state that doesn't match "
                 "the size of optimizer's state"
             )
+
+        # states are replaced, so they would be packed again
+        self._packed = dict()
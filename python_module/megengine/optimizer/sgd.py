@@ -10,6 +10,7 @@ from typing import Iterable, Union
 
 from ..core import Buffer, Parameter
 from .internal import add_update_fastpath as add_update
+from .internal import fused_optimizer_update_fastpath as fused_update
 from .optimizer import Optimizer
 
 
@@ -24,6 +25,11 @@ class SGD(Optimizer):
     :param lr: learning rate.
     :param momentum: momentum factor. Default: 0.0
     :param weight_decay: weight decay (L2 penalty). Default: 0.0
+    :param fused: whether to update all the parameters of a group by one fused
+        kernel. The parameters, gradients and momentum buffers are packed into
+        contiguous buffers at the first step, and the gradients are not
+        modified by weight decay. All the parameters of a group must be float32
+        on the same device. Default: False
     """
 
     def __init__(
@@ -32,6 +38,7 @@ class SGD(Optimizer):
         lr: float,
         momentum: float = 0.0,
         weight_decay: float = 0.0,
+        fused: bool = False,
     ):
         assert lr >= 0.0, "Invalid learning rate: {}".format(lr)
         assert momentum >= 0.0, "Invalid momentum value: {}".format(momentum)
@@ -40,6 +47,7 @@ class SGD(Optimizer):
         )
 
         defaults = dict(lr=lr, momentum=momentum, weight_decay=weight_decay)
+        self._fused = fused
         super().__init__(params, defaults)
 
     def _create_state(self, param_group):
@@ -52,6 +60,19 @@ class SGD(Optimizer):
         weight_decay = param_group["weight_decay"]
         momentum = param_group["momentum"]
 
+        if self._fused:
+            packed = self._get_packed(
+                param_group, ["momentum_buffer"] if momentum else []
+            )
+            fused_update(
+                *packed,
+                mode="sgd",
+                lr=lr,
+                weight_decay=weight_decay,
+                momentum=momentum
+            )
+            return
+
         for param in param_group["params"]:
             if not isinstance(param.grad, Buffer):
                 raise TypeError(
@@ -70,7 +70,6 @@ setup_kwargs = dict(
     install_requires=[
         'numpy>=1.17',
         'opencv-python',
-        'pyarrow',
         'requests',
         'tabulate',
         'tqdm',
@@ -0,0 +1,585 @@
+/**
+ * \file python_module/src/cpp/batch_augment.cpp
+ *
+ * This file is part of MegBrain, a deep learning framework developed by Megvii.
+ *
+ * \brief batched image augmentation using megdnn CV kernels
+ *
+ * \copyright Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ */
+
+#include "./batch_augment.h"
+#include "./python_helper.h"
+
+#define NO_IMPORT_ARRAY 1
+#include "./numpy_incl.h"
+
+#include "megbrain/utils/thread_pool.h"
+#include "megcore.h"
+#include "megdnn/handle.h"
+#include "megdnn/oprs.h"
+
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <random>
+
+using namespace mgb;
+
+namespace {
+using InterpolationMode = megdnn::param::WarpPerspective::InterpolationMode;
+
+InterpolationMode get_imode(float v) {
+    auto i = static_cast<int>(v);
+    mgb_throw_if(i < 0 || i >= static_cast<int>(
+                                      megdnn::param::WarpPerspective::
+                                              INTERPOLATIONMODE_NR_MEMBER),
+                 MegBrainError, "bad interpolation mode %d", i);
+    return static_cast<InterpolationMode>(i);
+}
+
+megdnn::param::CvtColor::Mode get_cvt_mode(const std::string& name) {
+    using Mode = megdnn::param::CvtColor::Mode;
+#define cb(_m)         \
+    if (name == #_m) { \
+        return Mode::_m; \
+    }
+    cb(RGB2GRAY) cb(GRAY2RGB) cb(RGB2BGR) cb(BGR2GRAY) cb(BGR2RGB)
+    cb(RGB2YUV) cb(YUV2RGB)
+#undef cb
+    mgb_throw(MegBrainError, "unsupported cvt_color mode for augmentation: %s",
+              name.c_str());
+}
+}  // anonymous namespace
+
+/* ================= _BatchAugmenter::Op ================= */
+
+struct _BatchAugmenter::Op {
+    enum class Type {
+        RESIZE,
+        RANDOM_RESIZED_CROP,
+        CENTER_CROP,
+        FLIP,
+        ROTATE90,
+        ROTATION,
+        GAUSSIAN_BLUR,
+        CVT_COLOR
+    };
+    Type type;
+    float prob;
+    std::vector<float> params;
+    megdnn::param::CvtColor::Mode cvt_mode;
+};
+
+/* ================= _BatchAugmenter::Image ================= */
+
+//! an HWC uint8 image, either owning its storage or viewing an input array
+struct _BatchAugmenter::Image {
+    const uint8_t* ptr = nullptr;
+    size_t height = 0, width = 0, channels = 0;
+    std::vector<uint8_t> storage;
+
+    static Image make(size_t height, size_t width, size_t channels) {
+        Image ret;
+        ret.height = height;
+        ret.width = width;
+        ret.channels = channels;
+        ret.storage.resize(height * width * channels);
+        ret.ptr = ret.storage.data();
+        return ret;
+    }
+
+    megdnn::TensorND tensor() const {
+        return {const_cast<uint8_t*>(ptr),
+                megdnn::TensorLayout{{1, height, width, channels},
+                                     megdnn::dtype::Uint8()}};
+    }
+
+    size_t size() const { return height * width * channels; }
+};
+
+/* ================= _BatchAugmenter::Worker ================= */
+
+/*!
+ * \brief per-thread state: a megdnn handle with inplace dispatcher, so each
+ *      kernel runs in the calling thread, and operators created on it
+ */
+class _BatchAugmenter::Worker : public NonCopyableObj {
+    megcoreDeviceHandle_t m_dev_hdl = nullptr;
+    megcoreComputingHandle_t m_comp_hdl = nullptr;
+    std::unique_ptr<megdnn::Handle> m_handle;
+    std::vector<uint8_t> m_workspace;
+
+    std::unique_ptr<megdnn::Resize> m_resize;
+    std::unique_ptr<megdnn::WarpAffine> m_warp_affine;
+    std::unique_ptr<megdnn::Rotate> m_rotate;
+    std::unique_ptr<megdnn::Flip> m_flip;
+    std::unique_ptr<megdnn::CvtColor> m_cvt_color;
+    std::unique_ptr<megdnn::GaussianBlur> m_gaussian_blur;
+    std::unique_ptr<megdnn::ROICopy> m_roi_copy;
+
+    template <typename Opr>
+    Opr* get_opr(std::unique_ptr<Opr>& opr) {
+        if (!opr) {
+            opr = m_handle->create_operator<Opr>();
+        }
+        return opr.get();
+    }
+
+    megdnn::Workspace workspace(size_t size) {
+        if (m_workspace.size() < size) {
+            m_workspace.resize(size);
+        }
+        return {reinterpret_cast<megdnn::dt_byte*>(m_workspace.data()), size};
+    }
+
+    void resize(Image& img, size_t height, size_t width,
+                InterpolationMode imode);
+    void random_resized_crop(Image& img, const Op& op, std::mt19937& rng);
+    void roi_copy(Image& img, size_t x, size_t y, size_t width,
+                  size_t height);
+    void rotation(Image& img, const Op& op, std::mt19937& rng);
+
+public:
+    Worker();
+    ~Worker();
+
+    //! apply an op to an image; the op has been selected by its probability
+    void apply(Image& img, const Op& op, std::mt19937& rng);
+};
+
+_BatchAugmenter::Worker::Worker() {
+    megcoreCreateDeviceHandle(&m_dev_hdl, megcorePlatformCPU);
+    megcoreCreateComputingHandle(&m_comp_hdl, m_dev_hdl);
+    m_handle = megdnn::Handle::make(m_comp_hdl);
+}
+
+_BatchAugmenter::Worker::~Worker() {
+    m_resize.reset();
+    m_warp_affine.reset();
+    m_rotate.reset();
+    m_flip.reset();
+    m_cvt_color.reset();
+    m_gaussian_blur.reset();
+    m_roi_copy.reset();
+    m_handle.reset();
+    megcoreDestroyComputingHandle(m_comp_hdl);
+    megcoreDestroyDeviceHandle(m_dev_hdl);
+}
+
+void _BatchAugmenter::Worker::resize(Image& img, size_t height, size_t width,
+                                     InterpolationMode imode) {
+    if (img.height == height && img.width == width)
+        return;
+    auto dst = Image::make(height, width, img.channels);
+    auto opr = get_opr(m_resize);
+    opr->param().imode = imode;
+    opr->param().format = megdnn::param::Resize::Format::NHWC;
+    auto src_t = img.tensor(), dst_t = dst.tensor();
+    opr->exec(src_t, dst_t,
+              workspace(opr->get_workspace_in_bytes(src_t.layout,
+                                                    dst_t.layout)));
+    img = std::move(dst);
+}
+
+void _BatchAugmenter::Worker::roi_copy(Image& img, size_t x, size_t y,
+                                       size_t width, size_t height) {
+    mgb_assert(x + width <= img.width && y + height <= img.height);
+    if (width == img.width && height == img.height)
+        return;
+    auto dst = Image::make(height, width, img.channels);
+    auto opr = get_opr(m_roi_copy);
+    opr->param().row_from = y;
+    opr->param().row_to = y + height;
+    opr->param().col_from = x;
+    opr->param().col_to = x + width;
+    auto src_t = img.tensor(), dst_t = dst.tensor();
+    opr->exec(src_t, dst_t,
+              workspace(opr->get_workspace_in_bytes(src_t.layout,
+                                                    dst_t.layout)));
+    img = std::move(dst);
+}
+
+void _BatchAugmenter::Worker::random_resized_crop(Image& img, const Op& op,
+                                                  std::mt19937& rng) {
+    // follows RandomResizedCrop in transform.py
+    auto&& p = op.params;
+    size_t out_h = p[0], out_w = p[1];
+    float scale_min = p[2], scale_max = p[3];
+    float log_ratio_min = std::log(p[4]), log_ratio_max = std::log(p[5]);
+    double height = img.height, width = img.width, area = height * width;
+
+    std::uniform_real_distribution<double> scale_dist{scale_min, scale_max},
+            log_ratio_dist{log_ratio_min, log_ratio_max};
+    for (int attempt = 0; attempt < 10; ++attempt) {
+        double target_area = scale_dist(rng) * area;
+        double aspect_ratio = std::exp(log_ratio_dist(rng));
+        auto w = std::lround(std::sqrt(target_area * aspect_ratio)),
+             h = std::lround(std::sqrt(target_area / aspect_ratio));
+        if (0 < w && w <= width && 0 < h && h <= height) {
+            auto x = std::uniform_int_distribution<long>{
+                    0, static_cast<long>(width) - w}(rng);
+            auto y = std::uniform_int_distribution<long>{
+                    0, static_cast<long>(height) - h}(rng);
+            roi_copy(img, x, y, w, h);
+            resize(img, out_h, out_w, get_imode(p[6]));
+            return;
+        }
+    }
+
+    // fallback to central crop
+    double in_ratio = width / height, ratio_min = p[4], ratio_max = p[5];
+    long w = img.width, h = img.height;
+    if (in_ratio < ratio_min) {
+        h = std::lround(w / ratio_min);
+    } else if (in_ratio > ratio_max) {
+        w = std::lround(h * ratio_max);
+    }
+    roi_copy(img, (img.width - w) / 2, (img.height - h) / 2, w, h);
+    resize(img, out_h, out_w, get_imode(p[6]));
+}
+
+void _BatchAugmenter::Worker::rotation(Image& img, const Op& op,
+                                       std::mt19937& rng) {
+    auto&& p = op.params;
+    double max_degree = p[0];
+    double angle = std::uniform_real_distribution<double>{
+            -max_degree, max_degree}(rng) * M_PI / 180;
+    // the matrix maps dst coordinates (x, y) to src coordinates, i.e. rotate
+    // dst by -angle about the center
+    double cx = (img.width - 1) * 0.5, cy = (img.height - 1) * 0.5,
+           cos_a = std::cos(angle), sin_a = std::sin(angle);
+    float mat[6] = {static_cast<float>(cos_a), static_cast<float>(sin_a),
+                    static_cast<float>(cx - cos_a * cx - sin_a * cy),
+                    static_cast<float>(-sin_a), static_cast<float>(cos_a),
+                    static_cast<float>(cy + sin_a * cx - cos_a * cy)};
+
+    auto dst = Image::make(img.height, img.width, img.channels);
+    auto opr = get_opr(m_warp_affine);
+    opr->param().imode = get_imode(p[1]);
+    opr->param().border_mode = megdnn::param::WarpAffine::BorderMode::CONSTANT;
+    opr->param().border_val = p[2];
+    opr->param().format = megdnn::param::WarpAffine::Format::NHWC;
+    auto src_t = img.tensor(), dst_t = dst.tensor();
+    megdnn::TensorND mat_t{mat, megdnn::TensorLayout{
+                                        {1, 2, 3}, megdnn::dtype::Float32()}};
+    opr->exec(src_t, mat_t, dst_t,
+              workspace(opr->get_workspace_in_bytes(src_t.layout, mat_t.layout,
+                                                    dst_t.layout)));
+    img = std::move(dst);
+}
+
+void _BatchAugmenter::Worker::apply(Image& img, const Op& op,
+                                    std::mt19937& rng) {
+    auto&& p = op.params;
+    // exec an opr with given param whose output has given shape
+    auto exec_simple = [&](auto opr, size_t height, size_t width,
+                           size_t channels) {
+        auto dst = Image::make(height, width, channels);
+        auto src_t = img.tensor(), dst_t = dst.tensor();
+        opr->exec(src_t, dst_t,
+                  workspace(opr->get_workspace_in_bytes(src_t.layout,
+                                                        dst_t.layout)));
+        img = std::move(dst);
+    };
+    switch (op.type) {
+        case Op::Type::RESIZE: {
+            size_t height = p[0], width = p[1];
+            if (!width) {
+                // follows Resize in transform.py with int output_size
+                if (img.height < img.width) {
+                    width = height * img.width / img.height;
+                } else {
+                    width = height;
+                    height = width * img.height / img.width;
+                }
+            }
+            resize(img, height, width, get_imode(p[2]));
+            break;
+        }
+        case Op::Type::RANDOM_RESIZED_CROP:
+            random_resized_crop(img, op, rng);
+            break;
+        case Op::Type::CENTER_CROP: {
+            size_t height = p[0], width = p[1];
+            mgb_throw_if(height > img.height || width > img.width,
+                         MegBrainError,
+                         "center crop size (%zu, %zu) is bigger than image "
+                         "size (%zu, %zu)",
+                         height, width, img.height, img.width);
+            roi_copy(img, std::lround((img.width - width) / 2.0),
+                     std::lround((img.height - height) / 2.0), width, height);
+            break;
+        }
+        case Op::Type::FLIP: {
+            auto opr = get_opr(m_flip);
+            opr->param().horizontal = p[0] != 0;
+            opr->param().vertical = p[1] != 0;
+            exec_simple(opr, img.height, img.width, img.channels);
+            break;
+        }
+        case Op::Type::ROTATE90: {
+            auto opr = get_opr(m_rotate);
+            opr->param().clockwise = p[0] != 0;
+            exec_simple(opr, img.width, img.height, img.channels);
+            break;
+        }
+        case Op::Type::ROTATION:
+            rotation(img, op, rng);
+            break;
+        case Op::Type::GAUSSIAN_BLUR: {
+            auto opr = get_opr(m_gaussian_blur);
+            float sigma = std::uniform_real_distribution<float>{p[1],
+                                                                p[2]}(rng);
+            opr->param().kernel_height = opr->param().kernel_width = p[0];
+            opr->param().sigma_x = opr->param().sigma_y = sigma;
+            opr->param().border_mode =
+                    megdnn::param::GaussianBlur::BorderMode::REFLECT_101;
+            exec_simple(opr, img.height, img.width, img.channels);
+            break;
+        }
+        case Op::Type::CVT_COLOR: {
+            auto opr = get_opr(m_cvt_color);
+            opr->param().mode = op.cvt_mode;
+            megdnn::TensorLayout dst_layout;
+            opr->deduce_layout(img.tensor().layout, dst_layout);
+            exec_simple(opr, dst_layout[1], dst_layout[2], dst_layout[3]);
+            break;
+        }
+    }
+}
+
+/* ================= _BatchAugmenter ================= */
+
+_BatchAugmenter::_BatchAugmenter(size_t nr_threads) {
+    mgb_throw_if(!nr_threads, MegBrainError,
+                 "number of threads must be positive");
+    m_thread_pool = std::make_unique<ThreadPool>(nr_threads);
+    m_workers.resize(m_thread_pool->nr_threads());
+}
+
+_BatchAugmenter::~_BatchAugmenter() = default;
+
+void _BatchAugmenter::_add_op(const std::string& name, float prob,
+                              const std::vector<float>& params,
+                              const std::string& mode) {
+    Op op;
+    size_t nr_param;
+    if (name == "resize") {
+        op.type = Op::Type::RESIZE;
+        nr_param = 3;
+    } else if (name == "random_resized_crop") {
+        op.type = Op::Type::RANDOM_RESIZED_CROP;
+        nr_param = 7;
+    } else if (name == "center_crop") {
+        op.type = Op::Type::CENTER_CROP;
+        nr_param = 2;
+    } else if (name == "flip") {
+        op.type = Op::Type::FLIP;
+        nr_param = 2;
+    } else if (name == "rotate90") {
+        op.type = Op::Type::ROTATE90;
+        nr_param = 1;
+    } else if (name == "rotation") {
+        op.type = Op::Type::ROTATION;
+        nr_param = 3;
+    } else if (name == "gaussian_blur") {
+        op.type = Op::Type::GAUSSIAN_BLUR;
+        nr_param = 3;
+    } else if (name == "cvt_color") {
+        op.type = Op::Type::CVT_COLOR;
+        op.cvt_mode = get_cvt_mode(mode);
+        nr_param = 0;
+    } else {
+        mgb_throw(MegBrainError, "unknown augmentation op: %s", name.c_str());
+    }
+    mgb_throw_if(params.size() != nr_param, MegBrainError,
+                 "augmentation op %s expects %zu params, got %zu",
+                 name.c_str(), nr_param, params.size());
+    if (op.type == Op::Type::RESIZE || op.type == Op::Type::ROTATION) {
+        get_imode(params[op.type == Op::Type::RESIZE ? 2 : 1]);
+    } else if (op.type == Op::Type::RANDOM_RESIZED_CROP) {
+        get_imode(params[6]);
+        mgb_throw_if(!(params[2] > 0 && params[2] <= params[3] &&
+                       params[4] > 0 && params[4] <= params[5]),
+                     MegBrainError, "bad scale or ratio range");
+    } else if (op.type == Op::Type::GAUSSIAN_BLUR) {
+        auto ksize = static_cast<int>(params[0]);
+        mgb_throw_if(ksize <= 0 || ksize % 2 == 0 || params[1] <= 0 ||
+                             params[1] > params[2],
+                     MegBrainError, "bad gaussian blur params");
+    }
+    op.prob = prob;
+    op.params = params;
+    m_ops.emplace_back(std::move(op));
+}
+
+void _BatchAugmenter::_set_output(bool chw, bool to_float,
+                                  const std::vector<float>& mean,
+                                  const std::vector<float>& std) {
+    mgb_throw_if(!to_float && (!mean.empty() || !std.empty()), MegBrainError,
+                 "normalization requires float output");
+    m_output_chw = chw;
+    m_output_float = to_float;
+    m_mean = mean;
+    m_std = std;
+}
+
+void _BatchAugmenter::run_parallel(
+        size_t nr, const std::function<void(size_t, Worker&)>& task) {
+    std::mutex exc_mtx;
+    std::exception_ptr exc;
+    auto worker_task = [&](size_t idx, size_t thread_id) {
+        MGB_TRY {
+            auto&& worker = m_workers[thread_id];
+            if (!worker) {
+                worker = std::make_unique<Worker>();
+            }
+            task(idx, *worker);
+        }
+        MGB_CATCH(..., {
+            MGB_LOCK_GUARD(exc_mtx);
+            if (!exc) {
+                exc = std::current_exception();
+            }
+        });
+    };
+    m_thread_pool->add_task({worker_task, nr});
+    // let the threads sleep until next batch
+    m_thread_pool->deactive();
+    if (exc) {
+        std::rethrow_exception(exc);
+    }
+}
+
+PyObject* _BatchAugmenter::_apply(PyObject* images, uint64_t seed) {
+    // keep references to input arrays while the GIL is released
+    std::vector<PyObjRefKeeper> inputs;
+    std::vector<Image> samples;
+    {
+        PYTHON_GIL;
+        PyObjRefKeeper seq{PySequence_Fast(images, "images must be a sequence")};
+        mgb_throw_if(!seq.get(), MegBrainError, "images must be a sequence");
+        auto nr = PySequence_Fast_GET_SIZE(seq.get());
+        mgb_throw_if(!nr, MegBrainError, "empty batch");
+        for (Py_ssize_t i = 0; i < nr; ++i) {
+            auto item = PySequence_Fast_GET_ITEM(seq.get(), i);
+            auto arr = PyArray_FROMANY(item, NPY_UINT8, 2, 3,
+                                       NPY_ARRAY_C_CONTIGUOUS);
+            if (!arr) {
+                PyErr_Clear();
+                mgb_throw(MegBrainError,
+                          "image %zd can not be converted to a uint8 array "
+                          "with 2 or 3 dims",
+                          i);
+            }
+            inputs.emplace_back(arr);
+            auto npy = reinterpret_cast<PyArrayObject*>(arr);
+            Image img;
+            img.ptr = static_cast<const uint8_t*>(PyArray_DATA(npy));
+            img.height = PyArray_DIM(npy, 0);
+            img.width = PyArray_DIM(npy, 1);
+            img.channels = PyArray_NDIM(npy) == 3 ? PyArray_DIM(npy, 2) : 1;
+            mgb_throw_if(img.channels != 1 && img.channels != 3,
+                         MegBrainError,
+                         "image %zd has %zu channels; only 1 or 3 channels "
+                         "are supported",
+                         i, img.channels);
+            samples.emplace_back(std::move(img));
+        }
+    }
+
+    auto nr = samples.size();
+    run_parallel(nr, [&](size_t idx, Worker& worker) {
+        std::seed_seq seed_seq{static_cast<uint32_t>(seed),
+                               static_cast<uint32_t>(seed >> 32),
+                               static_cast<uint32_t>(idx)};
+        std::mt19937 rng{seed_seq};
+        std::uniform_real_distribution<float> prob_dist;
+        auto&& img = samples[idx];
+        for (auto&& op : m_ops) {
+            if (op.prob >= 1 || prob_dist(rng) < op.prob) {
+                worker.apply(img, op, rng);
+            }
+        }
+    });
+    inputs.clear();
+
+    auto&& first = samples[0];
+    size_t height = first.height, width = first.width, chl = first.channels;
+    for (size_t i = 1; i < nr; ++i) {
+        auto&& s = samples[i];
+        mgb_throw_if(s.height != height || s.width != width ||
+                             s.channels != chl,
+                     MegBrainError,
+                     "augmented images have different shapes: (%zu, %zu, "
+                     "%zu) vs (%zu, %zu, %zu) at %zu",
+                     height, width, chl, s.height, s.width, s.channels, i);
+    }
+    for (auto v : {&m_mean, &m_std}) {
+        mgb_throw_if(v->size() > 1 && v->size() != chl, MegBrainError,
+                     "expect 1 or %zu values for normalization, got %zu", chl,
+                     v->size());
+    }
+
+    PyObject* ret;
+    {
+        PYTHON_GIL;
+        npy_intp dims[4] = {static_cast<npy_intp>(nr),
+                            static_cast<npy_intp>(height),
+                            static_cast<npy_intp>(width),
+                            static_cast<npy_intp>(chl)};
+        if (m_output_chw) {
+            dims[1] = chl;
+            dims[2] = height;
+            dims[3] = width;
+        }
+        ret = PyArray_SimpleNew(4, dims,
+                                m_output_float ? NPY_FLOAT32 : NPY_UINT8);
+        mgb_throw_if(!ret, MegBrainError, "failed to allocate output array");
+    }
+    PyObjRefKeeper ret_keeper{ret};
+    auto dest = static_cast<uint8_t*>(
+            PyArray_DATA(reinterpret_cast<PyArrayObject*>(ret)));
+
+    std::vector<float> scale(chl, 1.f), bias(chl, 0.f);
+    for (size_t c = 0; c < chl; ++c) {
+        float mean = m_mean.empty() ? 0.f : m_mean[m_mean.size() > 1 ? c : 0],
+              std = m_std.empty() ? 1.f : m_std[m_std.size() > 1 ? c : 0];
+        scale[c] = 1.f / std;
+        bias[c] = -mean / std;
+    }
+    size_t hw = height * width, sample_size = hw * chl;
+    run_parallel(nr, [&](size_t idx, Worker&) {
+        auto src = samples[idx].ptr;
+        if (!m_output_float) {
+            auto dst = dest + idx * sample_size;
+            if (!m_output_chw || chl == 1) {
+                memcpy(dst, src, sample_size);
+            } else {
+                for (size_t i = 0; i < hw; ++i)
+                    for (size_t c = 0; c < chl; ++c)
+                        dst[c * hw + i] = src[i * chl + c];
+            }
+        } else {
+            auto dst = reinterpret_cast<float*>(dest) + idx * sample_size;
+            for (size_t i = 0; i < hw; ++i) {
+                for (size_t c = 0; c < chl; ++c) {
+                    float v = src[i * chl + c] * scale[c] + bias[c];
+                    dst[m_output_chw ? c * hw + i : i * chl + c] = v;
+                }
+            }
+        }
+        // free intermediate storage early
+        samples[idx] = {};
+    });
+
+    {
+        PYTHON_GIL;
+        Py_INCREF(ret);
+    }
+    return ret;
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -0,0 +1,108 @@
+/**
+ * \file python_module/src/cpp/batch_augment.h
+ *
+ * This file is part of MegBrain, a deep learning framework developed by Megvii.
+ *
+ * \brief batched image augmentation using megdnn CV kernels
+ *
+ * \copyright Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ */
+
+#ifndef SWIG
+
+#pragma once
+
+#include "megbrain/common.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mgb {
+class ThreadPool;
+}
+
+#endif // SWIG
+
+#include <Python.h>
+
+/*!
+ * \brief apply a pipeline of per-sample random augmentations to a batch of
+ *      images and collate the results
+ *
+ * Each sample is processed by megdnn CPU kernels (Resize, WarpAffine, Rotate,
+ * Flip, CvtColor, GaussianBlur and ROICopy) on a thread pool, while the GIL is
+ * released. Random parameters of each sample are drawn from a generator
+ * seeded by the seed passed to _apply() and the sample index, so the result
+ * is deterministic.
+ *
+ * Input images must be uint8 arrays in HWC layout with 1 or 3 channels; the
+ * pipeline must produce images of the same shape for all samples.
+ */
+class _BatchAugmenter {
+#ifndef SWIG
+    struct Op;
+    struct Image;
+    class Worker;
+
+    std::vector<Op> m_ops;
+    std::unique_ptr<mgb::ThreadPool> m_thread_pool;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    bool m_output_chw = false, m_output_float = false;
+    std::vector<float> m_mean, m_std;
+
+    //! run \p task(idx) for idx in [0, nr) on the thread pool, and rethrow
+    //! the first exception
+    void run_parallel(size_t nr,
+                      const std::function<void(size_t, Worker&)>& task);
+#endif
+
+    public:
+        explicit _BatchAugmenter(size_t nr_threads);
+        ~_BatchAugmenter();
+
+        /*!
+         * \brief append an augmentation step, which is applied to each sample
+         *      with probability \p prob
+         *
+         * Supported steps and their params:
+         *
+         * - resize: (height, width, imode); if width is 0, resize the shorter
+         *   edge to height and keep the aspect ratio
+         * - random_resized_crop: (height, width, scale_min, scale_max,
+         *   ratio_min, ratio_max, imode)
+         * - center_crop: (height, width)
+         * - flip: (horizontal, vertical)
+         * - rotate90: (clockwise)
+         * - rotation: (max_degree, imode, border_val); rotate about the center
+         *   by a random angle in [-max_degree, max_degree]
+         * - gaussian_blur: (kernel_size, sigma_min, sigma_max)
+         * - cvt_color: no params; \p mode is the name of CvtColor mode
+         *
+         * imode is the value of megdnn InterpolationMode.
+         */
+        void _add_op(const std::string &name, float prob,
+                const std::vector<float> &params, const std::string &mode);
+
+        /*!
+         * \brief set how the augmented images are collated
+         * \param chw whether to output in NCHW layout rather than NHWC
+         * \param to_float whether to output float32 rather than uint8
+         * \param mean per-channel mean (or a single value) to be subtracted;
+         *      must be empty if \p to_float is false
+         * \param std per-channel std (or a single value) to divide by
+         */
+        void _set_output(bool chw, bool to_float,
+                const std::vector<float> &mean, const std::vector<float> &std);
+
+        /*!
+         * \brief augment a sequence of images
+         * \return the collated batch as a numpy array; new ref
+         */
+        PyObject* _apply(PyObject *images, uint64_t seed);
+};
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
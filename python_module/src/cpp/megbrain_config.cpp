@@ -61,7 +61,9 @@ bool _config::set_comp_graph_option(
     SET_CG_OPTION(graph_opt.jit);
     SET_CG_OPTION(graph_opt.tensorrt);
     SET_CG_OPTION(graph_opt_level);
+    SET_CG_OPTION(compile_cache_size);
     SET_CG_OPTION(var_sanity_check_first_run);
+    SET_CG_OPTION(var_sanity_check_mem_fwd_only);
     SET_CG_OPTION(no_profiling_on_shape_change);
     SET_CG_OPTION(allocate_static_mem_after_graph_compile);
     SET_CG_OPTION(log_level);
@@ -69,6 +71,7 @@ bool _config::set_comp_graph_option(
     SET_CG_OPTION(enable_var_mem_defragment);
     SET_CG_OPTION(eager_evaluation);
     SET_CG_OPTION(enable_memory_swap);
+    SET_CG_OPTION(enable_memory_offload);
     throw MegBrainError(ssprintf(
                 "invalid computing graph option name: %s", name.c_str()));
 #undef SET_CG_OPTION
@@ -1035,4 +1035,39 @@ void _add_update_fastpath(SharedND& dest_, CompGraphCallbackValueProxy& delta_,
     add_update_impl(*dest, delta, alpha, beta, bias);
 }
 
+void _fused_optimizer_update_fastpath(SharedND& param_, SharedND& grad_,
+        SharedND* state0_, SharedND* state1_, int mode, float lr,
+        float weight_decay, float momentum, float beta0, float beta1,
+        float eps, int step) {
+    auto&& param = *param_.dev_tensor();
+    auto&& grad = *grad_.dev_tensor();
+    auto&& cn = param.comp_node();
+    using DT = CompNode::DeviceType;
+    mgb_assert(cn == grad.comp_node() &&
+        (cn.device_type() == DT::CUDA || cn.device_type() == DT::CPU));
+    auto get_state = [&](SharedND* state) {
+        if (!state)
+            return megdnn::TensorND{};
+        auto&& dv = *state->dev_tensor();
+        mgb_assert(dv.comp_node() == cn);
+        return dv.as_megdnn();
+    };
+    cn.activate();
+    auto&& handle = MegDNNHandle::get(
+            CompNodeEnv::from_comp_node(cn)).handle();
+    auto&& op = handle->create_operator<megdnn::FusedOptimizerUpdate>();
+    using Mode = megdnn::FusedOptimizerUpdate::Mode;
+    op->param() = {static_cast<Mode>(mode), lr, weight_decay, momentum,
+        beta0, beta1, eps, static_cast<uint32_t>(step)};
+    mgb_assert(!op->get_workspace_in_bytes(param.layout(), grad.layout(),
+                {}, {}));
+    op->exec(param.as_megdnn(), grad.as_megdnn(), get_state(state0_),
+            get_state(state1_), {});
+    if (cn.device_type() == DT::CPU && cn != CompNode::default_cpu()) {
+        CompNodeEnv::from_comp_node(cn).cpu_env().dispatch(
+            [p = op.release()] { delete p; }
+        );
+    }
+}
+
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
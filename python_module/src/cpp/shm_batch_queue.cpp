@@ -0,0 +1,550 @@
+/**
+ * \file python_module/src/cpp/shm_batch_queue.cpp
+ *
+ * This file is part of MegBrain, a deep learning framework developed by Megvii.
+ *
+ * \brief shared memory ring buffer for transferring batches between processes
+ *
+ * \copyright Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ */
+
+#include "./shm_batch_queue.h"
+#include "./python_helper.h"
+
+#define NO_IMPORT_ARRAY 1
+#include "./numpy_incl.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace mgb;
+
+namespace {
+constexpr uint64_t MAGIC = 0x4d47455348514555ull;
+constexpr size_t PAGE_SIZE_ALIGN = 4096;
+
+//! max time to wait on a condition variable before checking the predicate
+//! again, so a wake-up lost due to a killed process only causes a short delay
+constexpr double MAX_WAIT_SLICE = 0.1;
+
+enum SlotState : uint32_t { FREE = 0, WRITING, READY, ACQUIRED };
+
+size_t align_up(size_t v, size_t align) {
+    return (v + align - 1) / align * align;
+}
+
+double now_monotonic() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void check_pthread(int ret, const char* what) {
+    mgb_throw_if(ret, SystemError, "%s failed: %s", what, strerror(ret));
+}
+
+struct SlotInfo {
+    uint32_t state;
+    //! pid of the process writing the slot, so the slot can be reclaimed if
+    //! the process dies before commit or cancel
+    int32_t writer_pid;
+    uint64_t size;
+};
+
+//! whether the process has exited; a reused pid is considered alive
+bool is_process_dead(pid_t pid) {
+    return kill(pid, 0) && errno == ESRCH;
+}
+
+//! header at the beginning of the shared memory, followed by SlotInfo array,
+//! a FIFO of ready slot ids and page-aligned slot data
+struct Header {
+    uint64_t magic;
+    uint32_t nr_slot, closed;
+    uint64_t slot_size, data_begin, total_size;
+    //! FIFO position of committed slots; slot ids are stored at
+    //! fifo[pos % nr_slot]
+    uint64_t fifo_head, fifo_tail;
+    uint64_t nr_acquired;
+    pthread_mutex_t mutex;
+    //! signaled when a slot becomes free / ready, or the queue is closed
+    pthread_cond_t cond_free, cond_ready;
+};
+
+size_t data_begin_offset(size_t nr_slot) {
+    return align_up(sizeof(Header) + nr_slot * (sizeof(SlotInfo) + 4),
+                    PAGE_SIZE_ALIGN);
+}
+}  // anonymous namespace
+
+/* ================= _ShmBatchQueue::Mapping ================= */
+
+class _ShmBatchQueue::Mapping : public NonCopyableObj {
+    std::string m_name;
+    //! pid of the process that created the shm object, which is responsible
+    //! for unlinking it; forked children inherit the object but must not
+    //! unlink it
+    pid_t m_creator_pid = 0;
+    uint8_t* m_ptr = nullptr;
+    size_t m_size = 0;
+
+    Header& header() const { return *reinterpret_cast<Header*>(m_ptr); }
+
+    SlotInfo* slots() const {
+        return reinterpret_cast<SlotInfo*>(m_ptr + sizeof(Header));
+    }
+
+    uint32_t* fifo() const {
+        return reinterpret_cast<uint32_t*>(slots() + header().nr_slot);
+    }
+
+    void map(int fd, size_t size);
+    void init_header(size_t nr_slot, size_t slot_size);
+
+    class Lock;
+
+    /*!
+     * \brief wait on a condition variable until pred() returns true
+     * \return whether pred() is satisfied; false on timeout
+     */
+    template <typename Pred>
+    bool wait(Lock& lock, pthread_cond_t& cond, double timeout, Pred pred);
+
+public:
+    Mapping(const std::string& name, size_t nr_slot, size_t slot_size,
+            bool create);
+    ~Mapping();
+
+    int reserve(size_t size, double timeout);
+    void commit(int slot, size_t size);
+    void cancel(int slot);
+    //! return slot id and set size, or -1 on timeout
+    int acquire(double timeout, size_t& size);
+    void release(int slot);
+    void close();
+    void unlink();
+
+    size_t nr_ready();
+    size_t nr_acquired();
+
+    uint8_t* slot_ptr(int slot) const {
+        auto&& hdr = header();
+        mgb_assert(slot >= 0 && static_cast<uint32_t>(slot) < hdr.nr_slot,
+                   "bad slot id %d", slot);
+        return m_ptr + hdr.data_begin + hdr.slot_size * slot;
+    }
+
+    size_t nr_slot() const { return header().nr_slot; }
+    size_t slot_size() const { return header().slot_size; }
+    const std::string& name() const { return m_name; }
+};
+
+//! lock the robust mutex in the header, recovering from dead owners
+class _ShmBatchQueue::Mapping::Lock : public NonCopyableObj {
+    pthread_mutex_t* m_mutex;
+
+public:
+    static void check_lock_ret(pthread_mutex_t* mutex, int ret) {
+        if (ret == EOWNERDEAD) {
+            // the state is only modified by short critical sections that
+            // keep it consistent, so it is safe to recover
+            ret = pthread_mutex_consistent(mutex);
+        }
+        check_pthread(ret, "pthread_mutex_lock");
+    }
+
+    explicit Lock(pthread_mutex_t* mutex) : m_mutex{mutex} {
+        check_lock_ret(m_mutex, pthread_mutex_lock(m_mutex));
+    }
+
+    ~Lock() { pthread_mutex_unlock(m_mutex); }
+
+    pthread_mutex_t* mutex() const { return m_mutex; }
+};
+
+_ShmBatchQueue::Mapping::Mapping(const std::string& name, size_t nr_slot,
+                                 size_t slot_size, bool create)
+        : m_name{name} {
+    int fd;
+    if (create) {
+        mgb_assert(nr_slot && slot_size);
+        fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        mgb_throw_if(fd < 0, SystemError,
+                     "failed to create shared memory %s: %s", name.c_str(),
+                     strerror(errno));
+        m_creator_pid = getpid();
+    } else {
+        fd = shm_open(name.c_str(), O_RDWR, 0600);
+        mgb_throw_if(fd < 0, SystemError,
+                     "failed to open shared memory %s: %s", name.c_str(),
+                     strerror(errno));
+    }
+    MGB_TRY {
+        if (create) {
+            slot_size = align_up(slot_size, PAGE_SIZE_ALIGN);
+            size_t size = data_begin_offset(nr_slot) + nr_slot * slot_size;
+            // the memory is allocated on first write
+            mgb_throw_if(ftruncate(fd, size), SystemError,
+                         "failed to resize shared memory: %s",
+                         strerror(errno));
+            map(fd, size);
+            init_header(nr_slot, slot_size);
+        } else {
+            struct stat st;
+            mgb_throw_if(fstat(fd, &st), SystemError, "fstat failed: %s",
+                         strerror(errno));
+            mgb_throw_if(static_cast<size_t>(st.st_size) < sizeof(Header),
+                         MegBrainError, "bad shared memory batch queue %s",
+                         name.c_str());
+            map(fd, st.st_size);
+            auto&& hdr = header();
+            mgb_throw_if(hdr.magic != MAGIC || hdr.total_size != m_size,
+                         MegBrainError,
+                         "bad shared memory batch queue %s: magic=%llx "
+                         "size=%zu",
+                         name.c_str(),
+                         static_cast<unsigned long long>(hdr.magic), m_size);
+        }
+    }
+    MGB_CATCH(..., {
+        if (m_ptr) {
+            munmap(m_ptr, m_size);
+        }
+        ::close(fd);
+        if (create) {
+            shm_unlink(name.c_str());
+        }
+        throw;
+    });
+    // the mapping stays valid after the fd is closed
+    ::close(fd);
+}
+
+_ShmBatchQueue::Mapping::~Mapping() {
+    unlink();
+    munmap(m_ptr, m_size);
+}
+
+void _ShmBatchQueue::Mapping::map(int fd, size_t size) {
+    auto ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    mgb_throw_if(ptr == MAP_FAILED, SystemError, "mmap failed: %s",
+                 strerror(errno));
+    m_ptr = static_cast<uint8_t*>(ptr);
+    m_size = size;
+}
+
+void _ShmBatchQueue::Mapping::init_header(size_t nr_slot, size_t slot_size) {
+    mgb_assert(nr_slot <= std::numeric_limits<uint32_t>::max());
+    // the object is filled with zeros by ftruncate, so all slots are FREE
+    auto&& hdr = header();
+    hdr.nr_slot = nr_slot;
+    hdr.closed = 0;
+    hdr.slot_size = slot_size;
+    hdr.data_begin = data_begin_offset(nr_slot);
+    hdr.total_size = m_size;
+    hdr.fifo_head = hdr.fifo_tail = 0;
+    hdr.nr_acquired = 0;
+
+    pthread_mutexattr_t mattr;
+    check_pthread(pthread_mutexattr_init(&mattr), "pthread_mutexattr_init");
+    check_pthread(pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED),
+                  "pthread_mutexattr_setpshared");
+    check_pthread(pthread_mutexattr_setrobust(&mattr, PTHREAD_MUTEX_ROBUST),
+                  "pthread_mutexattr_setrobust");
+    check_pthread(pthread_mutex_init(&hdr.mutex, &mattr),
+                  "pthread_mutex_init");
+    pthread_mutexattr_destroy(&mattr);
+
+    pthread_condattr_t cattr;
+    check_pthread(pthread_condattr_init(&cattr), "pthread_condattr_init");
+    check_pthread(pthread_condattr_setpshared(&cattr, PTHREAD_PROCESS_SHARED),
+                  "pthread_condattr_setpshared");
+    check_pthread(pthread_condattr_setclock(&cattr, CLOCK_MONOTONIC),
+                  "pthread_condattr_setclock");
+    check_pthread(pthread_cond_init(&hdr.cond_free, &cattr),
+                  "pthread_cond_init");
+    check_pthread(pthread_cond_init(&hdr.cond_ready, &cattr),
+                  "pthread_cond_init");
+    pthread_condattr_destroy(&cattr);
+
+    // no other process can see the object before the creator returns, but
+    // the magic is still written last for clarity
+    __atomic_store_n(&hdr.magic, MAGIC, __ATOMIC_RELEASE);
+}
+
+template <typename Pred>
+bool _ShmBatchQueue::Mapping::wait(Lock& lock, pthread_cond_t& cond,
+                                   double timeout, Pred pred) {
+    double deadline = timeout < 0 ? 0 : now_monotonic() + timeout;
+    for (;;) {
+        // check before pred(), so a closed queue is not drained
+        mgb_throw_if(header().closed, MegBrainError,
+                     "shared memory batch queue %s has been closed",
+                     m_name.c_str());
+        if (pred())
+            return true;
+        double slice = MAX_WAIT_SLICE;
+        if (timeout >= 0) {
+            double remain = deadline - now_monotonic();
+            if (remain <= 0)
+                return false;
+            slice = std::min(slice, remain);
+        }
+        double abs_time = now_monotonic() + slice;
+        timespec ts;
+        ts.tv_sec = static_cast<time_t>(abs_time);
+        ts.tv_nsec = static_cast<long>((abs_time - ts.tv_sec) * 1e9);
+        int ret = pthread_cond_timedwait(&cond, lock.mutex(), &ts);
+        if (ret != ETIMEDOUT) {
+            Lock::check_lock_ret(lock.mutex(), ret);
+        }
+    }
+}
+
+int _ShmBatchQueue::Mapping::reserve(size_t size, double timeout) {
+    auto&& hdr = header();
+    mgb_throw_if(size > hdr.slot_size, MegBrainError,
+                 "batch of %zu bytes exceeds slot size %zu of shared memory "
+                 "batch queue",
+                 size, static_cast<size_t>(hdr.slot_size));
+    Lock lock{&hdr.mutex};
+    int found = -1;
+    auto pred = [&]() {
+        for (uint32_t i = 0; i < hdr.nr_slot; ++i) {
+            if (slots()[i].state == FREE) {
+                found = i;
+                return true;
+            }
+        }
+        // reclaim slots whose writers were killed
+        for (uint32_t i = 0; i < hdr.nr_slot; ++i) {
+            auto&& info = slots()[i];
+            if (info.state == WRITING && is_process_dead(info.writer_pid)) {
+                mgb_log_warn(
+                        "reclaim slot %u of shared memory batch queue %s "
+                        "from dead writer %d",
+                        i, m_name.c_str(), info.writer_pid);
+                found = i;
+                return true;
+            }
+        }
+        return false;
+    };
+    if (!wait(lock, hdr.cond_free, timeout, pred))
+        return -1;
+    slots()[found].state = WRITING;
+    slots()[found].writer_pid = getpid();
+    return found;
+}
+
+void _ShmBatchQueue::Mapping::commit(int slot, size_t size) {
+    auto&& hdr = header();
+    mgb_assert(size <= hdr.slot_size);
+    slot_ptr(slot);  // check slot id
+    Lock lock{&hdr.mutex};
+    auto&& info = slots()[slot];
+    mgb_assert(info.state == WRITING, "slot %d is not reserved", slot);
+    info.state = READY;
+    info.size = size;
+    mgb_assert(hdr.fifo_tail - hdr.fifo_head < hdr.nr_slot);
+    fifo()[hdr.fifo_tail++ % hdr.nr_slot] = slot;
+    pthread_cond_broadcast(&hdr.cond_ready);
+}
+
+void _ShmBatchQueue::Mapping::cancel(int slot) {
+    auto&& hdr = header();
+    slot_ptr(slot);
+    Lock lock{&hdr.mutex};
+    auto&& info = slots()[slot];
+    mgb_assert(info.state == WRITING, "slot %d is not reserved", slot);
+    info.state = FREE;
+    pthread_cond_broadcast(&hdr.cond_free);
+}
+
+int _ShmBatchQueue::Mapping::acquire(double timeout, size_t& size) {
+    auto&& hdr = header();
+    Lock lock{&hdr.mutex};
+    if (!wait(lock, hdr.cond_ready, timeout,
+              [&]() { return hdr.fifo_head != hdr.fifo_tail; }))
+        return -1;
+    int slot = fifo()[hdr.fifo_head++ % hdr.nr_slot];
+    auto&& info = slots()[slot];
+    mgb_assert(info.state == READY);
+    info.state = ACQUIRED;
+    ++hdr.nr_acquired;
+    size = info.size;
+    return slot;
+}
+
+void _ShmBatchQueue::Mapping::release(int slot) {
+    auto&& hdr = header();
+    Lock lock{&hdr.mutex};
+    auto&& info = slots()[slot];
+    mgb_assert(info.state == ACQUIRED, "slot %d is not acquired", slot);
+    info.state = FREE;
+    --hdr.nr_acquired;
+    pthread_cond_broadcast(&hdr.cond_free);
+}
+
+void _ShmBatchQueue::Mapping::close() {
+    auto&& hdr = header();
+    Lock lock{&hdr.mutex};
+    hdr.closed = 1;
+    pthread_cond_broadcast(&hdr.cond_free);
+    pthread_cond_broadcast(&hdr.cond_ready);
+}
+
+void _ShmBatchQueue::Mapping::unlink() {
+    if (m_creator_pid == getpid()) {
+        // ignore error because it may have been unlinked by others
+        shm_unlink(m_name.c_str());
+        m_creator_pid = 0;
+    }
+}
+
+size_t _ShmBatchQueue::Mapping::nr_ready() {
+    auto&& hdr = header();
+    Lock lock{&hdr.mutex};
+    return hdr.fifo_tail - hdr.fifo_head;
+}
+
+size_t _ShmBatchQueue::Mapping::nr_acquired() {
+    auto&& hdr = header();
+    Lock lock{&hdr.mutex};
+    return hdr.nr_acquired;
+}
+
+/* ================= _ShmBatchQueue ================= */
+
+namespace {
+//! owner of a numpy array viewing a slot, stored in a PyCapsule
+struct SlotRef {
+    std::shared_ptr<void> mapping;
+    //! called when the array is destructed, or when it fails to be created
+    std::function<void()> on_release;
+
+    static constexpr const char* CAPSULE_NAME = "mgb._ShmBatchQueue.SlotRef";
+
+    ~SlotRef() {
+        if (on_release) {
+            MGB_TRY { on_release(); }
+            MGB_CATCH(std::exception & exc, {
+                mgb_log_error("failed to release shared memory slot: %s",
+                              exc.what());
+            });
+        }
+    }
+
+    static void capsule_destructor(PyObject* capsule) {
+        delete static_cast<SlotRef*>(
+                PyCapsule_GetPointer(capsule, CAPSULE_NAME));
+    }
+
+    //! make a uint8 numpy array viewing given memory; return new ref
+    static PyObject* make_array(void* ptr, size_t size,
+                                std::unique_ptr<SlotRef> ref) {
+        PYTHON_GIL;
+        npy_intp dims[1] = {static_cast<npy_intp>(size)};
+        auto arr = PyArray_SimpleNewFromData(1, dims, NPY_UINT8, ptr);
+        mgb_throw_if(!arr, MegBrainError,
+                     "failed to create numpy array for shared memory");
+        auto capsule =
+                PyCapsule_New(ref.get(), CAPSULE_NAME, capsule_destructor);
+        if (!capsule) {
+            Py_DECREF(arr);
+            mgb_throw(MegBrainError, "failed to create capsule");
+        }
+        ref.release();
+        // the reference to capsule is stolen, even on failure
+        if (PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(arr),
+                                  capsule)) {
+            Py_DECREF(arr);
+            mgb_throw(MegBrainError, "failed to set base of numpy array");
+        }
+        return arr;
+    }
+};
+}  // anonymous namespace
+
+_ShmBatchQueue::_ShmBatchQueue(const std::string& name, size_t nr_slot,
+                               size_t slot_size, bool create)
+        : m_mapping{std::make_shared<Mapping>(name, nr_slot, slot_size,
+                                              create)} {}
+
+_ShmBatchQueue::~_ShmBatchQueue() = default;
+
+int _ShmBatchQueue::_reserve(size_t size, double timeout) {
+    return m_mapping->reserve(size, timeout);
+}
+
+PyObject* _ShmBatchQueue::_slot_buffer(int slot) {
+    std::unique_ptr<SlotRef> ref{new SlotRef};
+    ref->mapping = m_mapping;
+    return SlotRef::make_array(m_mapping->slot_ptr(slot),
+                               m_mapping->slot_size(), std::move(ref));
+}
+
+void _ShmBatchQueue::_commit(int slot, size_t size) {
+    m_mapping->commit(slot, size);
+}
+
+void _ShmBatchQueue::_cancel(int slot) {
+    m_mapping->cancel(slot);
+}
+
+PyObject* _ShmBatchQueue::_acquire(double timeout) {
+    size_t size;
+    int slot = m_mapping->acquire(timeout, size);
+    if (slot < 0) {
+        PYTHON_GIL;
+        Py_RETURN_NONE;
+    }
+    std::unique_ptr<SlotRef> ref{new SlotRef};
+    ref->mapping = m_mapping;
+    auto mapping = m_mapping.get();
+    ref->on_release = [mapping, slot]() { mapping->release(slot); };
+    return SlotRef::make_array(m_mapping->slot_ptr(slot), size,
+                               std::move(ref));
+}
+
+size_t _ShmBatchQueue::_nr_ready() {
+    return m_mapping->nr_ready();
+}
+
+size_t _ShmBatchQueue::_nr_acquired() {
+    return m_mapping->nr_acquired();
+}
+
+size_t _ShmBatchQueue::_nr_slot() {
+    return m_mapping->nr_slot();
+}
+
+size_t _ShmBatchQueue::_slot_size() {
+    return m_mapping->slot_size();
+}
+
+std::string _ShmBatchQueue::_name() {
+    return m_mapping->name();
+}
+
+void _ShmBatchQueue::_close() {
+    m_mapping->close();
+}
+
+void _ShmBatchQueue::_unlink() {
+    m_mapping->unlink();
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
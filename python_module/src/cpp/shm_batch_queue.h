@@ -0,0 +1,101 @@
+/**
+ * \file python_module/src/cpp/shm_batch_queue.h
+ *
+ * This file is part of MegBrain, a deep learning framework developed by Megvii.
+ *
+ * \brief shared memory ring buffer for transferring batches between processes
+ *
+ * \copyright Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ */
+
+#ifndef SWIG
+
+#pragma once
+
+#include "megbrain/common.h"
+
+#include <memory>
+#include <string>
+
+#endif // SWIG
+
+#include <Python.h>
+
+/*!
+ * \brief a fixed number of fixed-size slots in a named POSIX shared memory
+ *      object, which can be attached by any process on the same host
+ *
+ * A producer reserves a free slot, writes into the buffer returned by
+ * _slot_buffer() and commits it; the consumer acquires committed slots in
+ * commit order as numpy arrays viewing the shared memory, and a slot is
+ * released when the returned array (and all views derived from it) is garbage
+ * collected. Therefore a batch can be written by one copy in the producer and
+ * passed to HostTensorND without any further copy in the consumer.
+ *
+ * The state is protected by a process-shared robust mutex, so a producer
+ * killed while holding the lock would not block others. A slot reserved by a
+ * producer that is killed before commit or cancel is reclaimed by _reserve()
+ * when no other slot is free.
+ */
+class _ShmBatchQueue {
+#ifndef SWIG
+    class Mapping;
+    std::shared_ptr<Mapping> m_mapping;
+#endif
+
+    public:
+        /*!
+         * \brief create a new shared memory object if \p create is true, or
+         *      attach to an existing one with given name
+         * \param nr_slot number of slots; only used when creating
+         * \param slot_size size of each slot in bytes, which would be rounded
+         *      up to page size; only used when creating
+         */
+        _ShmBatchQueue(const std::string &name, size_t nr_slot,
+                size_t slot_size, bool create);
+        ~_ShmBatchQueue();
+
+        /*!
+         * \brief reserve a free slot to write \p size bytes
+         * \param timeout timeout in seconds; negative value for waiting
+         *      forever
+         * \return slot id, or -1 on timeout
+         */
+        int _reserve(size_t size, double timeout);
+
+        //! writable numpy uint8 array of the whole slot; return new ref
+        PyObject* _slot_buffer(int slot);
+
+        //! publish a reserved slot containing \p size bytes
+        void _commit(int slot, size_t size);
+
+        //! give up a reserved slot without publishing it
+        void _cancel(int slot);
+
+        /*!
+         * \brief acquire the earliest committed slot
+         * \return numpy uint8 array of the committed bytes, which releases
+         *      the slot when destructed; None on timeout. Return new ref.
+         */
+        PyObject* _acquire(double timeout);
+
+        //! number of committed slots that have not been acquired
+        size_t _nr_ready();
+
+        //! number of acquired slots that have not been released
+        size_t _nr_acquired();
+
+        size_t _nr_slot();
+        size_t _slot_size();
+        std::string _name();
+
+        //! wake up all waiters; further reserve/acquire calls would throw
+        void _close();
+
+        //! remove the name of the shared memory object; the memory is freed
+        //! after all processes detach
+        void _unlink();
+};
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
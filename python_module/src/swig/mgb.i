@@ -26,6 +26,7 @@ void _init_intbx_types(PyObject *m); // implemented in intbx.cpp
 %include "stdint.i"
 %template(_VectorSizeT) std::vector<size_t>;
 %template(_VectorInt) std::vector<int>;
+%template(_VectorFloat) std::vector<float>;
 %template(_VectorString) std::vector<std::string>;
 %template(_PairStringSizeT) std::pair<std::string, size_t>;
 %template(_VectorPairUint64String) std::vector<std::pair<uint64_t, std::string>>;
@@ -47,6 +48,8 @@ intb4 = _mgb.intb4
 #include "megbrain_config.h"
 #include "megbrain_serialize.h"
 #include "plugin.h"
+#include "shm_batch_queue.h"
+#include "batch_augment.h"
 %}
 
 %include "comp_node.i"
@@ -61,5 +64,7 @@ intb4 = _mgb.intb4
 %include "loop.i"
 %include "../cpp/megbrain_serialize.h"
 %include "../cpp/plugin.h"
+%include "../cpp/shm_batch_queue.h"
+%include "../cpp/batch_augment.h"
 
 // vim: ft=swig
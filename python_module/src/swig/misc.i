@@ -9,6 +9,7 @@
 
 %{
 #include "megbrain/utils/persistent_cache.h"
+#include "megbrain/utils/mmap_persistent_cache.h"
 #include "megbrain/serialization/helper.h"
 #include "megbrain/gopt/inference.h"
 #include "megbrain/plugin/opr_footprint.h"
@@ -67,6 +68,11 @@ class _PersistentCache {
             static void reg(_PersistentCache *p) {
                 _PersistentCache::set_impl({p, [](_PersistentCache*){}});
             }
+
+            static void reg_mmap_file(const std::string &path) {
+                _PersistentCache::set_impl(
+                        std::make_shared<mgb::MmapPersistentCache>(path));
+            }
         }
 };
 
@@ -79,6 +85,10 @@ struct _OptimizeForInferenceOptions {
     SET(use_tensor_core);
     SET(fuse_conv_bias_with_z);
     SET(use_nchw88);
+    SET(select_nchw88_by_cost);
+    SET(fuse_conv_bias_epilogue);
+    SET(propagate_quantized_dtype);
+    SET(fuse_image_preprocess);
 #undef SET
 };
 
@@ -108,6 +118,10 @@ struct _OptimizeForInferenceOptions {
     void _add_update_fastpath(SharedND& dest,
             CompGraphCallbackValueProxy& delta,
             float alpha, float beta, float bias);
+    void _fused_optimizer_update_fastpath(SharedND& param, SharedND& grad,
+            SharedND* state0, SharedND* state1, int mode, float lr,
+            float weight_decay, float momentum, float beta0, float beta1,
+            float eps, int step);
 
     static SymbolVar _current_grad_target(CompGraph &graph) {
         return mgb::cg::current_grad_target(graph.get());
@@ -64,8 +64,8 @@ def test_dataloader_serial():
 
 
 def test_dataloader_parallel():
-    # set max shared memory to 100M
-    os.environ["MGE_PLASMA_MEMORY"] = "100000000"
+    # set max batch size in shared memory to 1M
+    os.environ["MGE_DATALOADER_SHM_SLOT_SIZE"] = "1000000"
 
     dataset = init_dataset()
     dataloader = DataLoader(
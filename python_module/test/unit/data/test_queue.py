@@ -0,0 +1,112 @@
+# -*- coding: utf-8 -*-
+# MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+#
+# Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+import collections
+import multiprocessing as mp
+import os
+import queue
+
+import numpy as np
+import pytest
+
+from megengine.data._queue import ShmBatchQueue
+
+Pair = collections.namedtuple("Pair", ["first", "second"])
+
+
+def _make_batch(idx):
+    return (
+        np.full((4, 3), idx, dtype=np.float32),
+        {"label": np.arange(idx, idx + 5), "name": "batch{}".format(idx)},
+        Pair(np.array(idx), [1, 2]),
+    )
+
+
+def _check_batch(batch, idx):
+    data, info, pair = batch
+    assert data.dtype == np.float32 and data.shape == (4, 3)
+    np.testing.assert_equal(data, idx)
+    np.testing.assert_equal(info["label"], np.arange(idx, idx + 5))
+    assert info["name"] == "batch{}".format(idx)
+    assert isinstance(pair, Pair) and pair.first == idx and pair.second == [1, 2]
+
+
+def _producer(batch_queue, nr_batch):
+    for i in range(nr_batch):
+        batch_queue.put(_make_batch(i))
+
+
+def test_shm_batch_queue_basic():
+    batch_queue = ShmBatchQueue(maxsize=2, slot_size=1 << 16)
+    assert batch_queue.empty()
+    batch_queue.put(_make_batch(0))
+    batch_queue.put_concat(
+        [
+            (np.zeros((2, 3), dtype=np.int32), np.ones(2)),
+            (np.ones((1, 3), dtype=np.int32), np.ones(1)),
+        ]
+    )
+    assert batch_queue.qsize() == 2
+    _check_batch(batch_queue.get(), 0)
+    x, y = batch_queue.get()
+    np.testing.assert_equal(x, [[0, 0, 0], [0, 0, 0], [1, 1, 1]])
+    np.testing.assert_equal(y, np.ones(3))
+
+    with pytest.raises(queue.Empty):
+        batch_queue.get(timeout=0.01)
+    with pytest.raises(RuntimeError):
+        batch_queue.put(np.zeros(1 << 17, dtype=np.uint8))
+    batch_queue.close()
+
+
+@pytest.mark.parametrize("start_method", ["fork", "spawn"])
+def test_shm_batch_queue_multiprocess(start_method):
+    nr_batch = 20
+    batch_queue = ShmBatchQueue(maxsize=2, slot_size=1 << 16)
+    ctx = mp.get_context(start_method)
+    worker = ctx.Process(target=_producer, args=(batch_queue, nr_batch))
+    worker.start()
+    # keep all batches alive: the producer must not be blocked
+    batches = []
+    for i in range(nr_batch):
+        batches.append(batch_queue.get(timeout=10))
+        _check_batch(batches[-1], i)
+    worker.join()
+    assert worker.exitcode == 0
+    batch_queue.close()
+
+
+def test_shm_batch_queue_close():
+    batch_queue = ShmBatchQueue(maxsize=2, slot_size=1 << 16)
+    batch_queue.put(_make_batch(0))
+    batch_queue.close()
+    # the queue is not drained after close
+    with pytest.raises(RuntimeError):
+        batch_queue.put(_make_batch(1))
+    with pytest.raises(RuntimeError):
+        batch_queue.get(timeout=1)
+
+
+def _reserve_all_and_die(batch_queue):
+    while batch_queue._queue._reserve(1, 0) >= 0:
+        pass
+    os._exit(0)
+
+
+def test_shm_batch_queue_dead_writer():
+    batch_queue = ShmBatchQueue(maxsize=1, slot_size=1 << 16)
+    worker = mp.get_context("fork").Process(
+        target=_reserve_all_and_die, args=(batch_queue,)
+    )
+    worker.start()
+    worker.join()
+    # slots left in writing state by the dead worker are reclaimed
+    for i in range(batch_queue._queue._nr_slot()):
+        batch_queue.put(_make_batch(i), timeout=10)
+        _check_batch(batch_queue.get(timeout=10), i)
+    batch_queue.close()
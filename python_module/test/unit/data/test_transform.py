@@ -106,3 +106,31 @@ def test_Compose():
     print(aug_data_shape)
     target_shape = [((3, 90, 70), label_shape)] * 4
     assert aug_data_shape == target_shape
+
+
+def test_BatchAugment():
+    data = generate_data()
+    transforms = [
+        CenterCrop(output_size=CenterCrop_size),
+        RandomHorizontalFlip(prob=1),
+        ToMode(mode="CHW"),
+    ]
+    aug_data = BatchAugment(transforms, nr_threads=2).apply_batch(data)
+    target = Compose(transforms).apply_batch(data)
+    for (a, b), (ta, tb) in zip(aug_data, target):
+        np.testing.assert_equal(a, ta)
+        np.testing.assert_equal(b, tb)
+
+    t = BatchAugment(
+        [
+            RandomResizedCrop(output_size=RandomResizedCrop_size),
+            ("rotation", dict(max_degree=30, prob=0.5)),
+            ("gaussian_blur", dict(kernel_size=3, sigma_range=(0.1, 2.0))),
+            ("cvt_color", dict(mode="BGR2GRAY")),
+            Normalize(mean=127, std=64),
+        ]
+    )
+    aug_data = t.apply_batch(data)
+    aug_data_shape = [(a.shape, a.dtype, b.shape) for a, b in aug_data]
+    target_shape = [(RandomResizedCrop_size + (1,), np.float32, label_shape)] * 4
+    assert aug_data_shape == target_shape
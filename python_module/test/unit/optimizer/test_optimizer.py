@@ -258,3 +258,41 @@ def test_optimizer_serialization():
             slot *= 0.9
             slot -= param.grad.numpy() * 0.01
             assertTensorClose(param.numpy(), orig_param + slot)
+
+
+def _check_fused_optimizer(opt_cls, **kwargs):
+    data, data_shape, label, label_shape = get_input()
+    mlp = MLP()
+    mlp_fused = MLP()
+    mlp_fused.load_state_dict(mlp.state_dict())
+    opt = opt_cls(mlp.parameters(), **kwargs)
+    opt_fused = opt_cls(mlp_fused.parameters(), fused=True, **kwargs)
+    for _ in range(3):
+        data.set_value(np.random.random(data_shape).astype(np.float32))
+        label.set_value(np.random.randint(0, 10, label_shape))
+        for net, optimizer in ((mlp, opt), (mlp_fused, opt_fused)):
+            pred = net(data)
+            loss = F.square_loss(pred, label.reshape(-1, 1))
+            optimizer.zero_grad()
+            optimizer.backward(loss)
+            optimizer.step()
+        for param, param_fused in zip(mlp.parameters(), mlp_fused.parameters()):
+            assertTensorClose(param.numpy(), param_fused.numpy())
+
+    # states are kept in the per-param tensors
+    state = opt.state_dict()["state"]
+    state_fused = opt_fused.state_dict()["state"]
+    for k, v in state.items():
+        for name, value in v.items():
+            assertTensorClose(value.numpy(), state_fused[k][name].numpy())
+
+
+def test_sgd_fused():
+    _check_fused_optimizer(SGD, lr=0.01, weight_decay=0.1)
+    _check_fused_optimizer(SGD, lr=0.01, momentum=0.9, weight_decay=0.1)
+
+
+def test_adam_fused():
+    _check_fused_optimizer(
+        Adam, lr=0.01, betas=(0.8, 0.9), eps=1e-4, weight_decay=0.1
+    )
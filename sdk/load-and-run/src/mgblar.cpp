@@ -13,10 +13,13 @@
 #include "./infile_persistent_cache.h"
 
 #include "megbrain/utils/debug.h"
+#include "megbrain/utils/mmap_persistent_cache.h"
 #include "megbrain/serialization/serializer.h"
 #include "megbrain/serialization/extern_c_opr.h"
+#include "megbrain/serialization/numa_replica.h"
 #include "megbrain/plugin/opr_io_dump.h"
 #include "megbrain/plugin/profiler.h"
+#include "megbrain/plugin/trace_profiler.h"
 #include "megbrain/plugin/num_range_checker.h"
 #include "megbrain/plugin/cpu_dispatch_checker.h"
 #include "megbrain/plugin/var_value_checker.h"
@@ -78,10 +81,26 @@ R"__usage__(
         profiling device time, which may cause additional overhead and make it
         hard to profile host time. Use --profile-host to focus on host time
         profiling.
+  --profile-roofline <output>
+    Enable profiling, and write a report to given file in JSON format that
+    evaluates each opr against the roofline of its comp node measured by
+    microbenchmarks, including the achieved GFLOPS and GB/s. Oprs are ranked by
+    time lost compared to the roofline bound.
+  --trace-profile <output>[:<exec_interval>]
+    Record opr execution, kernels, thread pool tasks and memory allocation with
+    low overhead, and write them to given file in chrome trace format, which
+    can be viewed in chrome://tracing or perfetto. Only one in every
+    exec_interval iterations is recorded.
   --io-dump <output> | --bin-io-dump <output dir>
     Dump input/output values of all internal variables to output file or
     directory, in text or binary format. The binary file can be parsed by
     `megbrain.plugin.load_tensor_binary`.
+  --async-io-dump <output>[:<exec_interval>[:<opr_regex>]]
+    Dump output values of internal variables to a single binary file in a
+    background thread, which is much faster than --bin-io-dump. Only one in
+    every exec_interval iterations is dumped, and only oprs whose names match
+    opr_regex if given. The file can be parsed by
+    `megbrain.plugin.load_async_io_dump`.
   --bin-out-dump <output dir>
     Dump output tensor values in binary format to given directory.
   --iter <num>
@@ -117,6 +136,10 @@ R"__usage__(
   --share-param-mem
     Share the memory used by model params with model storage. This can be used
     to reduce memory usage when computing on CPU.
+  --load-worker <num>
+    Number of worker threads to copy model params to devices concurrently with
+    operator construction. See `GraphLoadConfig::nr_load_worker` for more
+    details.
   --record-comp-seq | --record-comp-seq2
     Record the computing sequence, in level 1 or 2. It reduces overhead of API
     calls of some asynchronous computing devices, especially for OpenCL. In
@@ -135,6 +158,11 @@ R"__usage__(
 R"__usage__(
   --fast-run-algo-policy <path>
     It will read the cache file before profile, and save new fastrun in cache file.
+  --fast-run-shared-cache <path>
+    Use a memory-mapped file as the fast-run cache, which is created if it does
+    not exist. Profiling results are written to the file immediately, and are
+    shared by all the processes using the same file on this host. Can not be
+    used with --fast-run-algo-policy.
   --wait-gdb
     Print PID and wait for a line from stdin before starting execution. Useful
     for waiting for gdb attach.
@@ -145,6 +173,12 @@ R"__usage__(
     Number of threads to run concurrently. All threads perform the same work of
     loading and executing models. This is used for test thread safety, not for
     speed up on multiple cores.
+  --numa-replica <nr_thread>
+    Load a replica of the model on each NUMA node, computing with given number
+    of threads bound to the CPUs of the node, or all the CPUs of the node if 0
+    is given. Parameters and memory of each replica are placed on its node.
+    The runs are distributed to idle replicas, and the throughput is reported.
+    Device options like --cpu and --multithread are ignored in this mode.
   --disable-assert-throw
     Do not throw exception in case AssertEqual fails. Note that the exit code
     would also be zero if this option is enabled. This should only be used for
@@ -176,6 +210,19 @@ R"__usage__(
     Execute opr replace, replace weights by winograd transform. Currently support on conv bias opr.
 )__usage__"
 R"__usage__(
+  --cpu-huge-page <threshold>
+    Map CPU memory allocations not smaller than given size in MB directly, and
+    back them by 2MB transparent huge pages. This covers the static memory
+    chunk and large parameters, and reduces TLB misses.
+  --cpu-hugetlb
+    Use explicit huge pages reserved in /proc/sys/vm/nr_hugepages for large
+    CPU allocations. Transparent huge pages are used when the reservation is
+    exhausted.
+  --cpu-numa-node <node|auto>
+    Bind large CPU allocations to given NUMA node. If auto is given, the node
+    of the first core in --multi-thread-core-ids is used, or otherwise the
+    node of the CPU running the allocating thread. Allocations not smaller
+    than 2MB are affected if --cpu-huge-page is not given.
   --enable-chwn4
     Execute operators with kernels implemented in MegDNN with CHWN4 tensor format. Can only be used
     on Nvidia GPUs, whose compute capability is above 6.1.
@@ -194,17 +241,23 @@ struct Args {
     bool use_fast_run = false;
 #endif
     std::string fast_run_cache_path;
+    std::string fast_run_shared_cache_path;
     bool copy_to_host = false;
     int nr_run = 10;
     int nr_warmup = 1;
     int nr_thread = 1;
     int multithread_number = 1;
+    //! number of threads of each replica in numa replica mode; -1 to disable
+    int numa_replica_thread = -1;
     size_t workspace_limit = SIZE_MAX;
     serialization::GraphLoader::LoadResult load_ret;
 #if MGB_ENABLE_JSON
     std::unique_ptr<GraphProfiler> profiler;
 #endif
     std::string profiler_output;
+    std::string roofline_output;
+    std::unique_ptr<TraceProfiler> trace_profiler;
+    std::string trace_profiler_output;
     std::string bin_out_dump;
 
     std::unique_ptr<OprIODumpBase> iodump;
@@ -295,6 +348,111 @@ public:
     }
 };
 
+#if MGB_HAVE_THREAD
+void run_numa_replica(Args& env) {
+    using Runner = serialization::NumaReplicaRunner;
+    FILE* fin = fopen(env.model_path.c_str(), "rb");
+    mgb_assert(fin, "failed to open %s: %s", env.model_path.c_str(),
+               strerror(errno));
+    auto size = get_file_size(fin);
+    std::shared_ptr<void> buf{malloc(size), free};
+    auto nr = fread(buf.get(), 1, size, fin);
+    mgb_assert(nr == size);
+    fclose(fin);
+
+    uint32_t nr_test = 0;
+    auto file_maker = [buf, size, &nr_test]() {
+        // tensor values are copied, so each replica owns its params
+        auto file = serialization::InputFile::make_mem_proxy(buf.get(), size);
+        nr_test = read_nr_test(*file);
+        return file;
+    };
+
+    auto setup = [&env, &nr_test](Runner::Replica& replica) {
+        auto&& load_ret = replica.load_result;
+        if (nr_test) {
+            // use inputs of the first testcase
+            std::vector<std::pair<std::string, HostTensorND*>> inp_tensors;
+            for (auto&& i : load_ret.tensor_map) {
+                inp_tensors.emplace_back(i.first, i.second.get());
+            }
+            std::sort(inp_tensors.begin(), inp_tensors.end());
+            auto config = replica.load_config;
+            config.comp_graph.reset();
+            auto loader = serialization::GraphLoader::make(
+                    replica.loader->reset_file(), replica.loader->format());
+            auto testcase = loader->load(config, false);
+            mgb_assert(testcase.output_var_list.size() == inp_tensors.size());
+            for (size_t i = 0; i < inp_tensors.size(); ++i) {
+                auto&& opr = testcase.output_var_list[i]
+                                     .node()
+                                     ->owner_opr()
+                                     ->cast_final_safe<opr::SharedDeviceTensor>();
+                inp_tensors[i].second->copy_from(
+                        HostTensorND::make_proxy(*opr.dev_data()));
+            }
+            replica.loader = std::move(loader);
+        } else {
+            mgb_assert(load_ret.tensor_map.empty(),
+                       "model should not require input values");
+        }
+
+        ComputingGraph::OutputSpec out_spec;
+        for (auto&& i : load_ret.output_var_list) {
+            ComputingGraph::Callback cb;
+            if (env.copy_to_host) {
+                HostTensorND val;
+                cb = [val](const DeviceTensorND& dv) mutable {
+                    val.copy_from(dv);
+                };
+            }
+            out_spec.emplace_back(i, std::move(cb));
+        }
+        SymbolVarArray vars;
+        for (auto&& i : out_spec) {
+            vars.push_back(i.first);
+        }
+        mgb::gopt::set_opr_algo_workspace_limit_inplace(vars,
+                                                         env.workspace_limit);
+        replica.func = load_ret.graph_compile(out_spec);
+        for (int i = 0; i < env.nr_warmup; ++i) {
+            replica.func->execute().wait();
+        }
+    };
+
+    RealTimer timer;
+    Runner::Options options;
+    options.nr_thread = env.numa_replica_thread;
+    Runner runner{file_maker, setup, options};
+    printf("=== load %zu replicas and warmup: %.3fms\n", runner.nr_replica(),
+           timer.get_msecs_reset());
+    for (size_t i = 0; i < runner.nr_replica(); ++i) {
+        auto&& replica = runner.replica(i);
+        printf("replica %zu: numa node %d, %zu cpus, comp node %s\n", i,
+               replica.numa_node, replica.cpus.size(),
+               replica.comp_node.to_string().c_str());
+    }
+
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < env.nr_run; ++i) {
+        futures.emplace_back(runner.submit(
+                [](Runner::Replica& replica) {
+                    replica.func->execute().wait();
+                }));
+    }
+    for (auto&& i : futures) {
+        i.get();
+    }
+    auto tot_time = timer.get_msecs();
+    printf("=== finished %d runs: time=%.3fms throughput=%.3f/s\n",
+           env.nr_run, tot_time, env.nr_run / tot_time * 1e3);
+    auto nr_finished = runner.nr_finished_tasks();
+    for (size_t i = 0; i < nr_finished.size(); ++i) {
+        printf("replica %zu: %zu runs\n", i, nr_finished[i]);
+    }
+}
+#endif
+
 void run_test_st(Args &env) {
     std::unique_ptr<serialization::InputFile> inp_file;
 
@@ -331,6 +489,13 @@ void run_test_st(Args &env) {
     env.load_config.comp_graph.reset();
 
     printf("load model: %.3fms\n", timer.get_msecs_reset());
+    {
+        auto&& prof = env.load_ret.time_profile;
+        printf("load model breakdown: read_graph=%.3fms load_opr=%.3fms "
+               "copy_device_value=%.3fms\n",
+               prof.read_graph * 1e3, prof.load_opr * 1e3,
+               prof.copy_device_value * 1e3);
+    }
 
     // compile function to compute all outputs
     ComputingGraph::OutputSpec out_spec;
@@ -403,6 +568,14 @@ void run_test_st(Args &env) {
 #endif
             mgb::gopt::enable_opr_use_profiling_cache_inplace(vars);
     }
+    if (!env.fast_run_shared_cache_path.empty()) {
+        PersistentCache::set_impl(std::make_shared<MmapPersistentCache>(
+                env.fast_run_shared_cache_path));
+#if MGB_ENABLE_FASTRUN
+        if (!env.use_fast_run)
+#endif
+            mgb::gopt::enable_opr_use_profiling_cache_inplace(vars);
+    }
 
     auto func = env.load_ret.graph_compile(out_spec);
     auto warmup = [&]() {
@@ -505,12 +678,42 @@ void run_test_st(Args &env) {
     }
 
 #if MGB_ENABLE_JSON
-    if (env.profiler) {
+    if (env.profiler && !env.profiler_output.empty()) {
         env.profiler->to_json_full(func.get())->writeto_fpath(
                 env.profiler_output);
         mgb_log("profiling result written to %s", env.profiler_output.c_str());
     }
+    if (!env.roofline_output.empty()) {
+        auto report = env.profiler->roofline_report();
+        report->writeto_fpath(env.roofline_output);
+        auto num = [](const std::shared_ptr<json::Value>& v) {
+            return static_cast<json::Number*>(v.get())->get_impl();
+        };
+        auto str = [](const std::shared_ptr<json::Value>& v) {
+            return static_cast<json::String*>(v.get())->get_impl().c_str();
+        };
+        printf("roofline: total time %.3fms, lost time %.3fms\n",
+               num((*report)["total_time"]) * 1e3,
+               num((*report)["total_lost_time"]) * 1e3);
+        auto&& oprs =
+                static_cast<json::Array*>((*report)["oprs"].get())->get_impl();
+        for (size_t i = 0; i < std::min<size_t>(oprs.size(), 10); ++i) {
+            auto&& opr = *static_cast<json::Object*>(oprs[i].get());
+            printf("  %s{%s}: %.3fms lost %.3fms, %s bound, "
+                   "efficiency %.2f%%\n",
+                   str(opr["name"]), str(opr["type"]), num(opr["time"]) * 1e3,
+                   num(opr["lost_time"]) * 1e3, str(opr["bound"]),
+                   num(opr["efficiency"]) * 1e2);
+        }
+        mgb_log("roofline report written to %s", env.roofline_output.c_str());
+    }
 #endif
+    if (env.trace_profiler) {
+        env.trace_profiler->write_chrome_trace(
+                env.trace_profiler_output.c_str());
+        mgb_log("trace profiling result written to %s",
+                env.trace_profiler_output.c_str());
+    }
 #if MGB_ENABLE_FASTRUN
     if (!env.fast_run_cache_path.empty()) {
         static_cast<InFilePersistentCache&>(PersistentCache::inst())
@@ -541,7 +744,13 @@ int mgb_load_and_run_main(int argc, char** argv) {
         return env.args_parse_ret;
     }
 
-    if (env.nr_thread == 1) {
+    if (env.numa_replica_thread >= 0) {
+#if MGB_HAVE_THREAD
+        run_numa_replica(env);
+#else
+        mgb_log_error("--numa-replica requires thread support");
+#endif
+    } else if (env.nr_thread == 1) {
         run_test_st(env);
     } else {
 #if MGB_HAVE_THREAD
@@ -581,6 +790,9 @@ Args Args::from_argv(int argc, char **argv) {
     ret.load_config.comp_graph = ComputingGraph::make();
     auto &&graph_opt = ret.load_config.comp_graph->options();
     graph_opt.graph_opt_level = 0;
+    CompNode::CpuMemPolicy cpu_mem_policy;
+    bool cpu_mem_policy_set = false;
+    int first_core_id = -1;
 
     for (int i = 2; i < argc; ++ i) {
         if (!strcmp(argv[i], "--cpu")) {
@@ -641,6 +853,7 @@ Args Args::from_argv(int argc, char **argv) {
             mgb_assert(static_cast<size_t>(ret.multithread_number) ==
                                core_ids.size(),
                        "the core id should equal to the multi thread number");
+            first_core_id = core_ids.at(0);
             auto affinity_cb = [core_ids](int thread_id) {
                 mgb::sys::set_cpu_affinity({core_ids[thread_id]});
             };
@@ -670,6 +883,31 @@ Args Args::from_argv(int argc, char **argv) {
             continue;
         }
 #endif
+        if (!strcmp(argv[i], "--cpu-huge-page")) {
+            ++i;
+            mgb_assert(i < argc, "value not given for --cpu-huge-page");
+            cpu_mem_policy.huge_page_threshold =
+                    std::max<size_t>(std::stoul(argv[i]), 1) << 20;
+            cpu_mem_policy_set = true;
+            continue;
+        }
+        if (!strcmp(argv[i], "--cpu-hugetlb")) {
+            cpu_mem_policy.explicit_huge_page = true;
+            cpu_mem_policy_set = true;
+            continue;
+        }
+        if (!strcmp(argv[i], "--cpu-numa-node")) {
+            ++i;
+            mgb_assert(i < argc, "value not given for --cpu-numa-node");
+            if (!strcmp(argv[i], "auto")) {
+                cpu_mem_policy.numa_node =
+                        CompNode::CpuMemPolicy::NUMA_NODE_AUTO;
+            } else {
+                cpu_mem_policy.numa_node = std::stoi(argv[i]);
+            }
+            cpu_mem_policy_set = true;
+            continue;
+        }
         if (!strcmp(argv[i], "--enable-chwn4")) {
             mgb_log_warn("enable chwn4 optimization");
             graph_opt.graph_opt.enable_chwn4 = true;
@@ -690,7 +928,35 @@ Args Args::from_argv(int argc, char **argv) {
             ret.profiler_output = argv[i];
             continue;
         }
+        if (!strcmp(argv[i], "--profile-roofline")) {
+            mgb_log_warn("enable profiling with roofline report");
+            ++i;
+            mgb_assert(i < argc,
+                       "output file not given for --profile-roofline");
+            if (!ret.profiler) {
+                ret.profiler = std::make_unique<GraphProfiler>(
+                        ret.load_config.comp_graph.get());
+            }
+            ret.roofline_output = argv[i];
+            continue;
+        }
 #endif
+        if (!strcmp(argv[i], "--trace-profile")) {
+            mgb_log_warn("enable trace profiling");
+            ++i;
+            mgb_assert(i < argc, "output file not given for --trace-profile");
+            std::string arg = argv[i];
+            size_t exec_interval = 1;
+            auto sep = arg.find(':');
+            if (sep != std::string::npos) {
+                exec_interval = std::stoul(arg.substr(sep + 1));
+                arg.resize(sep);
+            }
+            ret.trace_profiler = std::make_unique<TraceProfiler>(
+                    ret.load_config.comp_graph.get(), exec_interval);
+            ret.trace_profiler_output = arg;
+            continue;
+        }
         if (!strcmp(argv[i], "--io-dump")) {
             mgb_log_warn("enable opr io dump");
             ++ i;
@@ -710,6 +976,28 @@ Args Args::from_argv(int argc, char **argv) {
                     ret.load_config.comp_graph.get(), argv[i]);
             continue;
         }
+        if (!strcmp(argv[i], "--async-io-dump")) {
+            mgb_log_warn("enable async opr io dump");
+            ++ i;
+            mgb_assert(i < argc,
+                    "output file not given for --async-io-dump");
+            std::string arg = argv[i];
+            AsyncOprIODump::Options options;
+            auto sep = arg.find(':');
+            if (sep != std::string::npos) {
+                auto opt = arg.substr(sep + 1);
+                arg.resize(sep);
+                sep = opt.find(':');
+                if (sep != std::string::npos) {
+                    options.opr_filter = opt.substr(sep + 1);
+                    opt.resize(sep);
+                }
+                options.exec_interval = std::stoul(opt);
+            }
+            ret.iodump = std::make_unique<AsyncOprIODump>(
+                    ret.load_config.comp_graph.get(), arg.c_str(), options);
+            continue;
+        }
         if (!strcmp(argv[i], "--bin-out-dump")) {
             ++i;
             mgb_assert(i < argc,
@@ -803,6 +1091,12 @@ Args Args::from_argv(int argc, char **argv) {
             ret.fast_run_cache_path = argv[i];
             continue;
         }
+        if (!strcmp(argv[i], "--fast-run-shared-cache")) {
+            ++i;
+            mgb_assert(i < argc, "value not given for --fast-run-shared-cache");
+            ret.fast_run_shared_cache_path = argv[i];
+            continue;
+        }
         if (!strcmp(argv[i], "--const-shape")) {
             ret.load_config.const_var_shape = true;
             continue;
@@ -811,6 +1105,14 @@ Args Args::from_argv(int argc, char **argv) {
             ret.share_param_mem = true;
             continue;
         }
+        if (!strcmp(argv[i], "--load-worker")) {
+            ++i;
+            mgb_assert(i < argc, "value not given for --load-worker");
+            auto nr_worker = std::stoi(argv[i]);
+            mgb_assert(nr_worker >= 0);
+            ret.load_config.nr_load_worker = nr_worker;
+            continue;
+        }
         if (!strcmp(argv[i], "--disable-assert-throw")) {
             ret.disable_assert_throw = true;
             continue;
@@ -843,6 +1145,13 @@ Args Args::from_argv(int argc, char **argv) {
             continue;
         }
 #endif
+        if (!strcmp(argv[i], "--numa-replica")) {
+            ++i;
+            mgb_assert(i < argc, "value not given for --numa-replica");
+            ret.numa_replica_thread = std::stoi(argv[i]);
+            mgb_assert(ret.numa_replica_thread >= 0);
+            continue;
+        }
         if (!strcmp(argv[i], "--thread")) {
             ++ i;
             mgb_assert(i < argc, "value not given for --thread");
@@ -864,6 +1173,29 @@ Args Args::from_argv(int argc, char **argv) {
         return ret;
     }
 
+    mgb_assert(ret.fast_run_cache_path.empty() ||
+                       ret.fast_run_shared_cache_path.empty(),
+               "--fast-run-algo-policy and --fast-run-shared-cache can not be "
+               "used together");
+
+    if (cpu_mem_policy_set) {
+        if (!cpu_mem_policy.huge_page_threshold) {
+            cpu_mem_policy.huge_page_threshold = 2_z << 20;
+        }
+        if (cpu_mem_policy.numa_node ==
+                    CompNode::CpuMemPolicy::NUMA_NODE_AUTO &&
+            first_core_id >= 0) {
+            cpu_mem_policy.numa_node = sys::get_numa_node_of_cpu(first_core_id);
+        }
+        mgb_log_warn("cpu memory policy: huge page threshold %zuMB, %s huge "
+                     "page, numa node %d",
+                     cpu_mem_policy.huge_page_threshold >> 20,
+                     cpu_mem_policy.explicit_huge_page ? "explicit"
+                                                       : "transparent",
+                     cpu_mem_policy.numa_node);
+        CompNode::set_cpu_mem_policy(cpu_mem_policy);
+    }
+
     return ret;
 }
 
@@ -12,6 +12,7 @@
 #include "megbrain/comp_node.h"
 #include "megbrain/comp_node_env.h"
 #include "megbrain/graph/exc_extra_info.h"
+#include "megbrain/utils/trace_recorder.h"
 
 #include "./cuda/comp_node.h"
 #include "./cpu/comp_node.h"
@@ -374,11 +375,17 @@ void CompNode::activate() const {
 void* CompNode::alloc_device(size_t size) const {
     auto ret = m_impl->alloc_device(size);
     static_cast<Impl*>(m_impl)->env().on_mem_event(size, true, ret);
+    TraceRecorder::record(TraceRecorder::Type::ALLOC,
+                          TraceRecorder::Phase::INSTANT,
+                          reinterpret_cast<uintptr_t>(ret), size);
     return ret;
 }
 
 void CompNode::free_device(void* ptr) const {
     static_cast<Impl*>(m_impl)->env().on_mem_event(0, true, ptr);
+    TraceRecorder::record(TraceRecorder::Type::FREE,
+                          TraceRecorder::Phase::INSTANT,
+                          reinterpret_cast<uintptr_t>(ptr));
     return m_impl->free_device(m_impl, ptr);
 }
 
@@ -29,10 +29,18 @@
 #include <malloc.h>
 #endif
 
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 using namespace mgb;
 
 namespace {
 bool enable_affinity = false;
+CompNode::CpuMemPolicy mem_policy;
 using Task = CompNodeEnv::CpuEnv::Task;
 using MultiThreadingTask = megcore::CPUDispatcher::MultiThreadingTask;
 
@@ -44,6 +52,138 @@ struct TaskElem {
 };
 }  // anonymous namespace
 
+/*!
+ * \brief allocate large chunks by mmap according to CpuMemPolicy
+ *
+ * Mapped chunks are recorded so they can be recognized on free.
+ */
+class MappedMemAllocator {
+    static constexpr size_t HUGE_PAGE_SIZE = 2_z << 20;
+
+    std::mutex m_mtx;
+    ThinHashMap<void*, size_t> m_chunks;
+    std::atomic_size_t m_nr_chunk{0};
+    bool m_hugetlb_warned = false, m_mbind_warned = false;
+
+public:
+    static MappedMemAllocator& inst() {
+        static MappedMemAllocator ret;
+        return ret;
+    }
+
+    /*!
+     * \brief map a chunk according to mem_policy
+     * \param bound_cpu the CPU that the comp node is bound to, or -1
+     * \return the chunk, or nullptr if it can not be mapped
+     */
+    void* alloc(size_t size, int bound_cpu);
+
+    //! free the chunk if it is allocated by alloc(); return whether freed
+    bool free(void* ptr);
+};
+
+#if defined(__linux__)
+void* MappedMemAllocator::alloc(size_t size, int bound_cpu) {
+    size = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    void* ptr = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (mem_policy.explicit_huge_page) {
+        ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ptr == MAP_FAILED) {
+            MGB_LOCK_GUARD(m_mtx);
+            if (!m_hugetlb_warned) {
+                m_hugetlb_warned = true;
+                mgb_log_warn(
+                        "failed to map %zu bytes of explicit huge pages: %s; "
+                        "fall back to transparent huge pages",
+                        size, strerror(errno));
+            }
+        }
+    }
+#endif
+    if (ptr == MAP_FAILED) {
+        // over-allocate so the chunk can be aligned to huge page boundary
+        auto raw = mmap(nullptr, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            return nullptr;
+        }
+        auto begin = reinterpret_cast<uintptr_t>(raw),
+             aligned = (begin + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE *
+                       HUGE_PAGE_SIZE;
+        if (aligned > begin) {
+            munmap(raw, aligned - begin);
+        }
+        if (begin + HUGE_PAGE_SIZE > aligned) {
+            munmap(reinterpret_cast<void*>(aligned + size),
+                   begin + HUGE_PAGE_SIZE - aligned);
+        }
+        ptr = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+        // error ignored: transparent huge page may be disabled by the system
+        madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+    }
+
+    int numa_node = mem_policy.numa_node;
+    if (numa_node == CompNode::CpuMemPolicy::NUMA_NODE_AUTO) {
+        int cpu = bound_cpu >= 0 ? bound_cpu : sched_getcpu();
+        numa_node = cpu >= 0 ? sys::get_numa_node_of_cpu(cpu) : -1;
+    }
+#ifdef SYS_mbind
+    if (numa_node >= 0) {
+        // pages are not touched yet, so they would be placed on the node
+        constexpr int MPOL_BIND = 2;
+        constexpr size_t NR_BITS = sizeof(unsigned long) * 8;
+        unsigned long nodemask[1024 / NR_BITS] = {0};
+        mgb_assert(numa_node < 1024, "bad numa node: %d", numa_node);
+        nodemask[numa_node / NR_BITS] = 1ul << (numa_node % NR_BITS);
+        if (syscall(SYS_mbind, ptr, size, MPOL_BIND, nodemask, 1024ul, 0u)) {
+            MGB_LOCK_GUARD(m_mtx);
+            if (!m_mbind_warned) {
+                m_mbind_warned = true;
+                mgb_log_warn("failed to bind memory to numa node %d: %s",
+                             numa_node, strerror(errno));
+            }
+        }
+    }
+#endif
+
+    MGB_LOCK_GUARD(m_mtx);
+    m_chunks[ptr] = size;
+    m_nr_chunk.fetch_add(1, std::memory_order_relaxed);
+    return ptr;
+}
+
+bool MappedMemAllocator::free(void* ptr) {
+    if (!m_nr_chunk.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    size_t size;
+    {
+        MGB_LOCK_GUARD(m_mtx);
+        auto iter = m_chunks.find(ptr);
+        if (iter == m_chunks.end()) {
+            return false;
+        }
+        size = iter->second;
+        m_chunks.erase(iter);
+        m_nr_chunk.fetch_sub(1, std::memory_order_relaxed);
+    }
+    munmap(ptr, size);
+    return true;
+}
+#else
+void* MappedMemAllocator::alloc(size_t, int) {
+    return nullptr;
+}
+
+bool MappedMemAllocator::free(void*) {
+    return false;
+}
+#endif
+
 using CpuCompNodeImpl = CpuCompNode::CompNodeImpl;
 
 void CpuCompNode::CpuDispatchableBase::add_callback(Task&& task) {
@@ -451,6 +591,9 @@ class CpuCompNode::CompNodeImpl final: public CpuDispatchableBase {
         }
 
         static void mgb_aligned_free(void* ptr) {
+            if (MappedMemAllocator::inst().free(ptr)) {
+                return;
+            }
 #ifdef WIN32
                 _aligned_free(ptr);
 #else
@@ -462,6 +605,17 @@ class CpuCompNode::CompNodeImpl final: public CpuDispatchableBase {
             if (m_cur_recorder) {
                 m_cur_recorder->on_alloc();
             }
+            if (mem_policy.huge_page_threshold &&
+                size >= mem_policy.huge_page_threshold) {
+                int bound_cpu = -1;
+                if (enable_affinity && m_locator.type == DeviceType::CPU) {
+                    bound_cpu = m_locator.device;
+                }
+                auto ptr = MappedMemAllocator::inst().alloc(size, bound_cpu);
+                if (ptr) {
+                    return ptr;
+                }
+            }
             return mgb_aligned_alloc(size);
         }
 
@@ -808,6 +962,13 @@ bool CompNode::enable_affinity_for_cpu(bool flag) {
     return old;
 }
 
+CompNode::CpuMemPolicy CompNode::set_cpu_mem_policy(
+        const CpuMemPolicy& policy) {
+    auto old = mem_policy;
+    mem_policy = policy;
+    return old;
+}
+
 
 /* ======================== EventImpl ========================  */
 
@@ -16,20 +16,38 @@
 #include "megbrain/common.h"
 #include "megbrain/comp_node_env.h"
 
+#include <cstring>
+
 using namespace mgb;
 using namespace mem_alloc;
 
+DevMemAlloc::FreeListAlgo DevMemAlloc::default_free_list_algo() {
+    static FreeListAlgo algo = []() {
+        auto env = MGB_GETENV("MGB_MEM_ALLOC_FREE_LIST");
+        if (!env || !strcmp(env, "best_fit"))
+            return FreeListAlgo::BEST_FIT;
+        if (!strcmp(env, "tlsf"))
+            return FreeListAlgo::TLSF;
+        mgb_throw(MegBrainError,
+                "bad MGB_MEM_ALLOC_FREE_LIST: %s; expect best_fit or tlsf",
+                env);
+    }();
+    return algo;
+}
+
 std::unique_ptr<DevMemAlloc> DevMemAlloc::make(
         int device, size_t reserve_size,
         const std::shared_ptr<mem_alloc::RawAllocator>& raw_allocator,
         const std::shared_ptr<mem_alloc::DeviceRuntimePolicy>&
-                runtime_policy) {
+                runtime_policy,
+        FreeListAlgo free_list_algo) {
     mgb_throw_if(!raw_allocator || !runtime_policy, MegBrainError,
                  "raw_alloctor or runtime_policy of device mem allocator is "
                  "not provided, got(raw_allocator:%p, runtime_policy:%p)",
                  raw_allocator.get(), runtime_policy.get());
     return std::make_unique<DevMemAllocImpl>(device, reserve_size,
-                                             raw_allocator, runtime_policy);
+                                             raw_allocator, runtime_policy,
+                                             free_list_algo);
 }
 
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
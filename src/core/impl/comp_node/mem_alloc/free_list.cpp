@@ -0,0 +1,379 @@
+/**
+ * \file src/core/impl/comp_node/mem_alloc/free_list.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "./free_list.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace mgb;
+using namespace mem_alloc;
+
+namespace {
+
+//! index of highest set bit; x must not be zero
+inline size_t highest_bit(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(x);
+#else
+    size_t ret = 0;
+    while (x >>= 1)
+        ++ ret;
+    return ret;
+#endif
+}
+
+//! index of lowest set bit; x must not be zero
+inline size_t lowest_bit(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    size_t ret = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        ++ ret;
+    }
+    return ret;
+#endif
+}
+
+FreeMemStat init_stat() {
+    return {0, std::numeric_limits<size_t>::max(), 0, 0};
+}
+
+void update_stat(FreeMemStat &stat, size_t size) {
+    stat.tot += size;
+    stat.min = std::min(stat.min, size);
+    stat.max = std::max(stat.max, size);
+    ++ stat.nr_blk;
+}
+
+} // anonymous namespace
+
+std::unique_ptr<FreeBlockList> FreeBlockList::make(Algo algo) {
+    switch (algo) {
+        case Algo::BEST_FIT:
+            return std::make_unique<BestFitFreeBlockList>();
+        case Algo::TLSF:
+            return std::make_unique<TLSFFreeBlockList>();
+    }
+    mgb_throw(MegBrainError, "unknown free list algo: %d",
+            static_cast<int>(algo));
+}
+
+/* ===================== BestFitFreeBlockList ===================== */
+
+bool BestFitFreeBlockList::take(size_t size, FreeBlock &block) {
+    auto iter = m_free_blk_size.lower_bound(FreeBlock{MemAddr{0, 0}, size});
+    if (iter == m_free_blk_size.end())
+        return false;
+    block = iter->first;
+    m_free_blk_addr.erase(iter->second.aiter);
+    m_free_blk_size.erase(iter);
+    return true;
+}
+
+void BestFitFreeBlockList::merge(FreeBlock block) {
+    auto iter = m_free_blk_addr.lower_bound(block.addr.addr);
+
+    // merge with previous
+    if (!block.addr.is_head && iter != m_free_blk_addr.begin()) {
+        auto iprev = iter;
+        -- iprev;
+        if (iprev->first + iprev->second.size == block.addr.addr) {
+            block.addr.addr = iprev->first;
+            block.addr.is_head = iprev->second.is_head;
+            block.size += iprev->second.size;
+            m_free_blk_size.erase(iprev->second.siter);
+            m_free_blk_addr.erase(iprev);
+        }
+    }
+
+    // merge with next
+    if (iter != m_free_blk_addr.end()) {
+        mgb_assert(iter->first >= block.end());
+        if (!iter->second.is_head && block.end() == iter->first) {
+            block.size += iter->second.size;
+            m_free_blk_size.erase(iter->second.siter);
+            m_free_blk_addr.erase(iter);
+        }
+    }
+
+    insert(block);
+}
+
+void BestFitFreeBlockList::insert(const FreeBlock &block) {
+    auto rst0 = m_free_blk_size.insert({block, {}});
+    auto rst1 = m_free_blk_addr.insert({block.addr.addr, {}});
+    mgb_assert(rst0.second & rst1.second);
+    rst0.first->second.aiter = rst1.first;
+    rst1.first->second.is_head = block.addr.is_head;
+    rst1.first->second.size = block.size;
+    rst1.first->second.siter = rst0.first;
+}
+
+void BestFitFreeBlockList::remove(const FreeBlock &block) {
+    auto iter = m_free_blk_size.find(block);
+    mgb_assert(iter != m_free_blk_size.end());
+    m_free_blk_addr.erase(iter->second.aiter);
+    m_free_blk_size.erase(iter);
+}
+
+void BestFitFreeBlockList::foreach(
+        thin_function<void(const FreeBlock&)> callback) const {
+    for (auto &&i: m_free_blk_size)
+        callback(i.first);
+}
+
+void BestFitFreeBlockList::clear() {
+    m_free_blk_addr.clear();
+    m_free_blk_size.clear();
+}
+
+FreeMemStat BestFitFreeBlockList::stat() const {
+    auto stat = init_stat();
+    for (auto &&i: m_free_blk_size)
+        update_stat(stat, i.first.size);
+    return stat;
+}
+
+/* ===================== TLSFFreeBlockList ===================== */
+constexpr uint32_t TLSFFreeBlockList::INVALID;
+
+TLSFFreeBlockList::TLSFFreeBlockList() {
+    clear();
+}
+
+void TLSFFreeBlockList::mapping_insert(size_t size, size_t &fl, size_t &sl) {
+    if (size < SMALL_SIZE) {
+        fl = 0;
+        sl = size;
+    } else {
+        auto msb = highest_bit(size);
+        fl = msb - SL_LOG2 + 1;
+        sl = (size >> (msb - SL_LOG2)) - SL_COUNT;
+    }
+}
+
+uint32_t TLSFFreeBlockList::search_suitable(size_t size) const {
+    if (size >= SMALL_SIZE) {
+        // round up to the next class, so any block in it fits
+        size_t round = (size_t(1) << (highest_bit(size) - SL_LOG2)) - 1;
+        if (size + round < size)
+            return INVALID;
+        size += round;
+    }
+    size_t fl, sl;
+    mapping_insert(size, fl, sl);
+    uint32_t sl_map = m_sl_bitmap[fl] & (~uint32_t(0) << sl);
+    if (!sl_map) {
+        if (fl + 1 >= FL_COUNT)
+            return INVALID;
+        uint64_t fl_map = m_fl_bitmap & (~uint64_t(0) << (fl + 1));
+        if (!fl_map)
+            return INVALID;
+        fl = lowest_bit(fl_map);
+        sl_map = m_sl_bitmap[fl];
+    }
+    return m_heads[fl][lowest_bit(sl_map)];
+}
+
+void TLSFFreeBlockList::link(uint32_t idx) {
+    size_t fl, sl;
+    auto &&node = m_nodes[idx];
+    mapping_insert(node.block.size, fl, sl);
+    auto &&head = m_heads[fl][sl];
+    // put in the front, so recently freed (hotter) blocks are reused first
+    node.prev = INVALID;
+    node.next = head;
+    if (head != INVALID)
+        m_nodes[head].prev = idx;
+    head = idx;
+    m_fl_bitmap |= uint64_t(1) << fl;
+    m_sl_bitmap[fl] |= uint32_t(1) << sl;
+}
+
+void TLSFFreeBlockList::unlink(uint32_t idx) {
+    auto &&node = m_nodes[idx];
+    if (node.next != INVALID)
+        m_nodes[node.next].prev = node.prev;
+    if (node.prev != INVALID) {
+        m_nodes[node.prev].next = node.next;
+        return;
+    }
+    size_t fl, sl;
+    mapping_insert(node.block.size, fl, sl);
+    auto &&head = m_heads[fl][sl];
+    mgb_assert(head == idx);
+    head = node.next;
+    if (head == INVALID) {
+        m_sl_bitmap[fl] &= ~(uint32_t(1) << sl);
+        if (!m_sl_bitmap[fl])
+            m_fl_bitmap &= ~(uint64_t(1) << fl);
+    }
+}
+
+uint32_t TLSFFreeBlockList::find_by_begin(size_t addr) const {
+    auto idx = m_begin_buckets[hash_addr(addr)];
+    while (idx != INVALID && m_nodes[idx].block.addr.addr != addr)
+        idx = m_nodes[idx].begin_next;
+    return idx;
+}
+
+uint32_t TLSFFreeBlockList::find_by_end(size_t addr) const {
+    auto idx = m_end_buckets[hash_addr(addr)];
+    while (idx != INVALID && m_nodes[idx].block.end() != addr)
+        idx = m_nodes[idx].end_next;
+    return idx;
+}
+
+void TLSFFreeBlockList::hash_insert(uint32_t idx) {
+    auto &&node = m_nodes[idx];
+    auto &&begin_head = m_begin_buckets[hash_addr(node.block.addr.addr)];
+    node.begin_next = begin_head;
+    begin_head = idx;
+    auto &&end_head = m_end_buckets[hash_addr(node.block.end())];
+    node.end_next = end_head;
+    end_head = idx;
+}
+
+void TLSFFreeBlockList::hash_erase(uint32_t idx) {
+    auto &&node = m_nodes[idx];
+    uint32_t *ptr = &m_begin_buckets[hash_addr(node.block.addr.addr)];
+    while (*ptr != idx)
+        ptr = &m_nodes[*ptr].begin_next;
+    *ptr = node.begin_next;
+    ptr = &m_end_buckets[hash_addr(node.block.end())];
+    while (*ptr != idx)
+        ptr = &m_nodes[*ptr].end_next;
+    *ptr = node.end_next;
+}
+
+void TLSFFreeBlockList::rehash(size_t nr_bucket) {
+    mgb_assert(nr_bucket && !(nr_bucket & (nr_bucket - 1)));
+    m_hash_shift = 64 - highest_bit(nr_bucket);
+    m_begin_buckets.assign(nr_bucket, INVALID);
+    m_end_buckets.assign(nr_bucket, INVALID);
+    for (uint32_t i = 0; i < m_nodes.size(); ++i) {
+        if (m_nodes[i].block.size)
+            hash_insert(i);
+    }
+}
+
+void TLSFFreeBlockList::erase_node(uint32_t idx) {
+    unlink(idx);
+    hash_erase(idx);
+    // zero size marks unused nodes
+    m_nodes[idx].block.size = 0;
+    m_unused_nodes.push_back(idx);
+    --m_nr_block;
+}
+
+bool TLSFFreeBlockList::take(size_t size, FreeBlock &block) {
+    if (!m_nr_block)
+        return false;
+    auto idx = search_suitable(size);
+    if (idx == INVALID) {
+        // blocks in the class of the requested size may still fit
+        size_t fl, sl;
+        mapping_insert(size, fl, sl);
+        for (idx = m_heads[fl][sl];
+                idx != INVALID && m_nodes[idx].block.size < size;
+                idx = m_nodes[idx].next);
+        if (idx == INVALID)
+            return false;
+    }
+    block = m_nodes[idx].block;
+    erase_node(idx);
+    return true;
+}
+
+void TLSFFreeBlockList::insert(const FreeBlock &block) {
+    mgb_assert(block.size);
+    uint32_t idx;
+    if (!m_unused_nodes.empty()) {
+        idx = m_unused_nodes.back();
+        m_unused_nodes.pop_back();
+    } else {
+        mgb_assert(m_nodes.size() < INVALID);
+        idx = m_nodes.size();
+        m_nodes.emplace_back();
+        m_nodes.back().block.size = 0;
+        if (m_nodes.size() > m_begin_buckets.size())
+            rehash(m_begin_buckets.size() * 2);
+    }
+    mgb_assert(find_by_begin(block.addr.addr) == INVALID &&
+               find_by_end(block.end()) == INVALID);
+    m_nodes[idx].block = block;
+    link(idx);
+    hash_insert(idx);
+    ++m_nr_block;
+}
+
+void TLSFFreeBlockList::merge(FreeBlock block) {
+    // merge with previous
+    if (!block.addr.is_head) {
+        auto idx = find_by_end(block.addr.addr);
+        if (idx != INVALID) {
+            auto prev = m_nodes[idx].block;
+            block.addr = prev.addr;
+            block.size += prev.size;
+            erase_node(idx);
+        }
+    }
+
+    // merge with next
+    auto idx = find_by_begin(block.end());
+    if (idx != INVALID) {
+        auto &&next = m_nodes[idx].block;
+        if (!next.addr.is_head) {
+            block.size += next.size;
+            erase_node(idx);
+        }
+    }
+
+    insert(block);
+}
+
+void TLSFFreeBlockList::remove(const FreeBlock &block) {
+    auto idx = find_by_begin(block.addr.addr);
+    mgb_assert(idx != INVALID && m_nodes[idx].block.size == block.size);
+    erase_node(idx);
+}
+
+void TLSFFreeBlockList::foreach(
+        thin_function<void(const FreeBlock&)> callback) const {
+    for (auto &&i: m_nodes) {
+        if (i.block.size)
+            callback(i.block);
+    }
+}
+
+void TLSFFreeBlockList::clear() {
+    m_nodes.clear();
+    m_unused_nodes.clear();
+    m_nr_block = 0;
+    rehash(INIT_NR_BUCKET);
+    m_fl_bitmap = 0;
+    memset(m_sl_bitmap, 0, sizeof(m_sl_bitmap));
+    memset(m_heads, -1, sizeof(m_heads));
+}
+
+FreeMemStat TLSFFreeBlockList::stat() const {
+    auto stat = init_stat();
+    for (auto &&i: m_nodes) {
+        if (i.block.size)
+            update_stat(stat, i.block.size);
+    }
+    return stat;
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
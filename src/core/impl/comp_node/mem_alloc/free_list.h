@@ -0,0 +1,221 @@
+/**
+ * \file src/core/impl/comp_node/mem_alloc/free_list.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include "megbrain/comp_node/alloc.h"
+
+#include <map>
+#include <vector>
+
+namespace mgb {
+namespace mem_alloc {
+
+struct MemAddr {
+    //! whether it is head of a chunk from raw allocator; if true, it
+    //! could not be merged with chunks with lower address
+    bool is_head = false;
+    size_t addr = -1;
+
+    void* addr_ptr() const {
+        return reinterpret_cast<void*>(addr);
+    }
+
+    bool operator < (const MemAddr &rhs) const {
+        return addr < rhs.addr;
+    }
+
+    MemAddr operator + (size_t delta) const {
+        return {false, addr + delta};
+    }
+};
+
+struct FreeBlock {
+    MemAddr addr;
+    size_t size = -1;
+
+    size_t end() const {
+        return addr.addr + size;
+    }
+};
+
+/*!
+ * \brief container of free blocks of an allocator
+ *
+ * Note that methods of this class are not thread safe; the owner must hold its
+ * own lock.
+ */
+class FreeBlockList: public NonCopyableObj {
+    public:
+        using Algo = DevMemAlloc::FreeListAlgo;
+
+        static std::unique_ptr<FreeBlockList> make(Algo algo);
+
+        virtual ~FreeBlockList() = default;
+
+        /*!
+         * \brief remove a block whose size is at least \p size
+         * \param[out] block the removed block
+         * \return whether such block is found
+         */
+        virtual bool take(size_t size, FreeBlock &block) = 0;
+
+        //! insert a block without merging with its neighbours
+        virtual void insert(const FreeBlock &block) = 0;
+
+        /*!
+         * \brief insert a block and merge it with adjacent free blocks; a
+         *      head block is never merged with the block before it
+         */
+        virtual void merge(FreeBlock block) = 0;
+
+        //! remove a block that exists in this list
+        virtual void remove(const FreeBlock &block) = 0;
+
+        //! call \p callback on each block; the list must not be modified
+        virtual void foreach(
+                thin_function<void(const FreeBlock&)> callback) const = 0;
+
+        virtual void clear() = 0;
+
+        virtual FreeMemStat stat() const = 0;
+};
+
+/*!
+ * \brief best fit by free blocks sorted by size and address; all operations
+ *      take O(log n) time
+ */
+class BestFitFreeBlockList final: public FreeBlockList {
+    struct FreeCmpBySize{
+        bool operator() (const FreeBlock &a, const FreeBlock &b) const {
+            // prefer more recent (hotter) block
+            return a.size < b.size || (a.size == b.size && a.addr < b.addr);
+        }
+    };
+
+    struct BlkByAddrIter;
+    struct FreeBlockAddrInfo;
+
+    //! free blocks sorted by size, and map to corresponding iterator in
+    //! m_free_blk_addr
+    std::map<FreeBlock, BlkByAddrIter, FreeCmpBySize> m_free_blk_size;
+
+    //! map from address to size and size iter
+    std::map<size_t, FreeBlockAddrInfo> m_free_blk_addr;
+
+    struct BlkByAddrIter {
+        decltype(m_free_blk_addr.begin()) aiter;
+    };
+
+    struct FreeBlockAddrInfo {
+        bool is_head;   //! always equals to siter->first.addr.is_head
+        size_t size;
+        decltype(m_free_blk_size.begin()) siter;
+    };
+
+    public:
+        bool take(size_t size, FreeBlock &block) override;
+        void insert(const FreeBlock &block) override;
+        void merge(FreeBlock block) override;
+        void remove(const FreeBlock &block) override;
+        void foreach(
+                thin_function<void(const FreeBlock&)> callback) const override;
+        void clear() override;
+        FreeMemStat stat() const override;
+};
+
+/*!
+ * \brief two-level segregated fit (TLSF) free lists
+ *
+ * Blocks are put into size classes by the position of their highest set bit
+ * (first level) and the following SL_LOG2 bits (second level). Non-empty
+ * classes are recorded in bitmaps, so a class that must fit the request can be
+ * found by two bit scans. Adjacent free blocks are found by hash tables keyed
+ * by begin and end addresses, since blocks live in device memory and can not
+ * carry boundary tags. The hash chains are linked through the nodes, and
+ * nodes are recycled from a pool, so alloc, free and merge take O(1) expected
+ * time; the system heap is only touched when the node pool grows beyond its
+ * previous peak size.
+ *
+ * Blocks found by bitmap search are good fit rather than best fit; if the
+ * search fails, the size class of the request is scanned linearly so that no
+ * fitting block is missed.
+ */
+class TLSFFreeBlockList final: public FreeBlockList {
+    static constexpr size_t SL_LOG2 = 5, SL_COUNT = 1 << SL_LOG2,
+                            SMALL_SIZE = SL_COUNT,
+                            FL_COUNT = sizeof(size_t) * 8 - SL_LOG2 + 1;
+    static constexpr uint32_t INVALID = ~uint32_t(0);
+    static constexpr size_t INIT_NR_BUCKET = 64;
+
+    struct Node {
+        FreeBlock block;
+        //! links in the size class list
+        uint32_t prev, next;
+        //! links in the hash chains of begin and end addresses
+        uint32_t begin_next, end_next;
+    };
+
+    //! node pool; indices of unused nodes are kept in m_unused_nodes
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_unused_nodes;
+    size_t m_nr_block = 0;
+
+    uint64_t m_fl_bitmap = 0;
+    uint32_t m_sl_bitmap[FL_COUNT];
+    uint32_t m_heads[FL_COUNT][SL_COUNT];
+
+    //! heads of hash chains of begin/end addresses of free blocks; the
+    //! number of buckets is a power of two no less than m_nodes.size()
+    std::vector<uint32_t> m_begin_buckets, m_end_buckets;
+    size_t m_hash_shift;
+
+    static void mapping_insert(size_t size, size_t &fl, size_t &sl);
+
+    size_t hash_addr(size_t addr) const {
+        // fibonacci hashing; low bits of addresses are mostly zero
+        return static_cast<size_t>(
+                (static_cast<uint64_t>(addr) * 11400714819323198485ull) >>
+                m_hash_shift);
+    }
+
+    //! find node by begin or end address of its block; return INVALID if
+    //! not found
+    uint32_t find_by_begin(size_t addr) const;
+    uint32_t find_by_end(size_t addr) const;
+
+    void hash_insert(uint32_t idx);
+    void hash_erase(uint32_t idx);
+    void rehash(size_t nr_bucket);
+
+    //! find a non-empty class whose blocks are all no smaller than size
+    uint32_t search_suitable(size_t size) const;
+
+    void link(uint32_t idx);
+    void unlink(uint32_t idx);
+    void erase_node(uint32_t idx);
+
+    public:
+        TLSFFreeBlockList();
+
+        bool take(size_t size, FreeBlock &block) override;
+        void insert(const FreeBlock &block) override;
+        void merge(FreeBlock block) override;
+        void remove(const FreeBlock &block) override;
+        void foreach(
+                thin_function<void(const FreeBlock&)> callback) const override;
+        void clear() override;
+        FreeMemStat stat() const override;
+};
+
+}
+}
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -27,8 +27,8 @@ MemAllocImplHelper::MemAddr MemAllocImplHelper::do_alloc(
     mgb_assert(size);
     m_mutex.lock();
 
-    auto iter = m_free_blk_size.lower_bound(FreeBlock{MemAddr{0, 0}, size});
-    if (iter == m_free_blk_size.end()) {
+    FreeBlock blk;
+    if (!m_free_list->take(size, blk)) {
         m_mutex.unlock();
         if (!allow_from_parent) {
             if (log_stat_on_error) {
@@ -45,10 +45,8 @@ MemAllocImplHelper::MemAddr MemAllocImplHelper::do_alloc(
         return alloc_from_parent(size);
     }
 
-    size_t remain = iter->first.size - size;
-    auto alloc_addr = iter->first.addr;
-    m_free_blk_addr.erase(iter->second.aiter);
-    m_free_blk_size.erase(iter);
+    size_t remain = blk.size - size;
+    auto alloc_addr = blk.addr;
 
     if (remain)
         insert_free_unsafe({alloc_addr + size, remain});
@@ -57,45 +55,6 @@ MemAllocImplHelper::MemAddr MemAllocImplHelper::do_alloc(
     return alloc_addr;
 }
 
-void MemAllocImplHelper::merge_free_unsafe(FreeBlock block) {
-    auto iter = m_free_blk_addr.lower_bound(block.addr.addr);
-
-    // merge with previous
-    if (!block.addr.is_head && iter != m_free_blk_addr.begin()) {
-        auto iprev = iter;
-        -- iprev;
-        if (iprev->first + iprev->second.size == block.addr.addr) {
-            block.addr.addr = iprev->first;
-            block.addr.is_head = iprev->second.is_head;
-            block.size += iprev->second.size;
-            m_free_blk_size.erase(iprev->second.siter);
-            m_free_blk_addr.erase(iprev);
-        }
-    }
-
-    // merge with next
-    if (iter != m_free_blk_addr.end()) {
-        mgb_assert(iter->first >= block.end());
-        if (!iter->second.is_head && block.end() == iter->first) {
-            block.size += iter->second.size;
-            m_free_blk_size.erase(iter->second.siter);
-            m_free_blk_addr.erase(iter);
-        }
-    }
-
-    insert_free_unsafe(block);
-}
-
-void MemAllocImplHelper::insert_free_unsafe(const FreeBlock &block) {
-    auto rst0 = m_free_blk_size.insert({block, {}});
-    auto rst1 = m_free_blk_addr.insert({block.addr.addr, {}});
-    mgb_assert(rst0.second & rst1.second);
-    rst0.first->second.aiter = rst1.first;
-    rst1.first->second.is_head = block.addr.is_head;
-    rst1.first->second.size = block.size;
-    rst1.first->second.siter = rst0.first;
-}
-
 void MemAllocImplHelper::print_memory_state() {
     auto stat = get_free_memory();
     MGB_MARK_USED_VAR(stat);
@@ -106,15 +65,7 @@ void MemAllocImplHelper::print_memory_state() {
 }
 
 FreeMemStat MemAllocImplHelper::get_free_memory_self_unsafe() {
-    FreeMemStat stat{0, std::numeric_limits<size_t>::max(), 0, 0};
-    for (auto &&i: m_free_blk_size) {
-        auto size = i.first.size;
-        stat.tot += size;
-        stat.min = std::min(stat.min, size);
-        stat.max = std::max(stat.max, size);
-        ++ stat.nr_blk;
-    }
-    return stat;
+    return m_free_list->stat();
 }
 
 FreeMemStat MemAllocImplHelper::get_free_memory() {
@@ -123,6 +74,12 @@ FreeMemStat MemAllocImplHelper::get_free_memory() {
 }
 
 /* ===================== StreamMemAllocImpl ===================== */
+StreamMemAllocImpl::StreamMemAllocImpl(DevMemAllocImpl* dev_alloc,
+                                       int stream_id)
+        : MemAllocImplHelper(dev_alloc->m_free_list_algo),
+          m_dev_alloc(dev_alloc),
+          m_stream_id(stream_id) {}
+
 std::string StreamMemAllocImpl::get_name() const {
     return ssprintf("stream allocator %d@%d",
             m_stream_id, m_dev_alloc->device());
@@ -274,37 +231,32 @@ size_t DevMemAllocImpl::gather_stream_free_blk_and_release_full() {
         auto &&chmtx = ch->m_mutex;
 
         MGB_LOCK_GUARD(chmtx);
-        for (auto &&i: ch->m_free_blk_size) {
-            merge_free_unsafe(i.first);
-            gathered_size += i.first.size;
-        }
-        ch->m_free_blk_addr.clear();
-        ch->m_free_blk_size.clear();
+        ch->m_free_list->foreach([&](const FreeBlock& blk) {
+            merge_free_unsafe(blk);
+            gathered_size += blk.size;
+        });
+        ch->m_free_list->clear();
     }
     mgb_assert(gathered_size <= m_used_size.load());
     m_used_size -= gathered_size;
 
     size_t free_size = 0;
-    using Iter = decltype(m_free_blk_size.begin());
-    std::vector<void*> to_free_by_raw;
-    for (Iter i = m_free_blk_size.begin(), inext; i != m_free_blk_size.end();
-            i = inext) {
-        inext = i;
-        ++ inext;
-        auto &&blk = i->first;
+    std::vector<FreeBlock> full_chunks;
+    m_free_list->foreach([&](const FreeBlock& blk) {
         if (blk.addr.is_head) {
             auto riter = m_alloc_from_raw.find(blk.addr.addr_ptr());
             mgb_assert(riter != m_alloc_from_raw.end() &&
                     blk.size <= riter->second);
-            if (blk.size == riter->second) {
-                to_free_by_raw.push_back(blk.addr.addr_ptr());
-                free_size += blk.size;
-                auto j = i->second.aiter;
-                m_free_blk_size.erase(i);
-                m_free_blk_addr.erase(j);
-                m_alloc_from_raw.erase(riter);
-            }
+            if (blk.size == riter->second)
+                full_chunks.push_back(blk);
         }
+    });
+    std::vector<void*> to_free_by_raw;
+    for (auto &&blk: full_chunks) {
+        m_free_list->remove(blk);
+        m_alloc_from_raw.erase(blk.addr.addr_ptr());
+        to_free_by_raw.push_back(blk.addr.addr_ptr());
+        free_size += blk.size;
     }
     m_tot_allocated_from_raw -= free_size;
 
@@ -322,8 +274,11 @@ DevMemAllocImpl::DevMemAllocImpl(
         int device, size_t reserve_size,
         const std::shared_ptr<mem_alloc::RawAllocator>& raw_allocator,
         const std::shared_ptr<mem_alloc::DeviceRuntimePolicy>&
-                runtime_policy)
-        : m_device(device),
+                runtime_policy,
+        FreeListAlgo free_list_algo)
+        : MemAllocImplHelper(free_list_algo),
+          m_device(device),
+          m_free_list_algo(free_list_algo),
           m_raw_allocator(raw_allocator),
           m_runtime_policy(runtime_policy) {
     if (reserve_size) {
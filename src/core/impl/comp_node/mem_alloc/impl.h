@@ -11,10 +11,8 @@
 
 #pragma once
 
-#include "megbrain/comp_node/alloc.h"
+#include "./free_list.h"
 
-#include <set>
-#include <map>
 #include <unordered_map>
 #include <atomic>
 #include <vector>
@@ -28,79 +26,37 @@ class MemAllocImplHelper: virtual public MemAllocBase {
     friend class DevMemAllocImpl;
 
     protected:
-        struct MemAddr {
-            //! whether it is head of a chunk from raw allocator; if true, it
-            //! could not be merged with chunks with lower address
-            bool is_head = false;
-            size_t addr = -1;
-
-            void* addr_ptr() const {
-                return reinterpret_cast<void*>(addr);
-            }
-
-            bool operator < (const MemAddr &rhs) const {
-                return addr < rhs.addr;
-            }
-
-            MemAddr operator + (size_t delta) const {
-                return {false, addr + delta};
-            }
-        };
-
-        struct FreeBlock {
-            MemAddr addr;
-            size_t size = -1;
-
-            size_t end() const {
-                return addr.addr + size;
-            }
-        };
-
-        struct FreeCmpBySize{
-            bool operator() (const FreeBlock &a, const FreeBlock &b) const {
-                // prefer more recent (hotter) block
-                return a.size < b.size || (a.size == b.size && a.addr < b.addr);
-            }
-        };
-
-        struct BlkByAddrIter;
-        struct FreeBlockAddrInfo;
-
-        //! free blocks sorted by size, and map to corresponding iterator in
-        //! m_free_blk_addr
-        std::map<FreeBlock, BlkByAddrIter, FreeCmpBySize> m_free_blk_size;
-
-        //! map from address to size and size iter
-        std::map<size_t, FreeBlockAddrInfo> m_free_blk_addr;
+        using MemAddr = mem_alloc::MemAddr;
+        using FreeBlock = mem_alloc::FreeBlock;
 
-        std::mutex m_mutex;
+        std::unique_ptr<FreeBlockList> m_free_list;
 
-        struct BlkByAddrIter {
-            decltype(m_free_blk_addr.begin()) aiter;
-        };
+        std::mutex m_mutex;
 
-        struct FreeBlockAddrInfo {
-            bool is_head;   //! always equals to siter->first.addr.is_head
-            size_t size;
-            decltype(m_free_blk_size.begin()) siter;
-        };
+        explicit MemAllocImplHelper(DevMemAlloc::FreeListAlgo free_list_algo):
+            m_free_list(FreeBlockList::make(free_list_algo))
+        {}
 
         /*!
          * \brief merge a block into free list, without locking
          */
-        void merge_free_unsafe(FreeBlock block);
+        void merge_free_unsafe(FreeBlock block) {
+            m_free_list->merge(block);
+        }
 
         /*!
-         * \brief directly insert a free block into m_free_blk_size and
-         *      m_free_blk_addr, without merging
+         * \brief directly insert a free block into m_free_list, without
+         *      merging
          */
-        inline void insert_free_unsafe(const FreeBlock &block);
+        void insert_free_unsafe(const FreeBlock &block) {
+            m_free_list->insert(block);
+        }
 
         /*!
          * \brief allocate from parent allocator; this method must either return
          *      a valid address or throw an exception
          *
-         * m_free_blk_addr and m_free_blk_size must be maintained if necessary
+         * m_free_list must be maintained if necessary
          */
         virtual MemAddr alloc_from_parent(size_t size) = 0;
 
@@ -148,15 +104,14 @@ class StreamMemAllocImpl final: public StreamMemAlloc,
     FreeMemStat get_free_memory_dev() override;
 
     public:
-        StreamMemAllocImpl(DevMemAllocImpl *dev_alloc, int stream_id):
-            m_dev_alloc(dev_alloc), m_stream_id(stream_id)
-        {}
+        StreamMemAllocImpl(DevMemAllocImpl *dev_alloc, int stream_id);
 };
 
 class DevMemAllocImpl final: public DevMemAlloc,
                              public MemAllocImplHelper {
     friend class StreamMemAllocImpl;
     int m_device;
+    FreeListAlgo m_free_list_algo;
     std::shared_ptr<RawAllocator> m_raw_allocator;
     std::shared_ptr<DeviceRuntimePolicy> m_runtime_policy;
     ThinHashMap<StreamKey, std::unique_ptr<StreamMemAllocImpl>> m_stream_alloc;
@@ -198,7 +153,8 @@ public:
             int device, size_t reserve_size,
             const std::shared_ptr<mem_alloc::RawAllocator>& raw_allocator,
             const std::shared_ptr<mem_alloc::DeviceRuntimePolicy>&
-                    runtime_policy);
+                    runtime_policy,
+            FreeListAlgo free_list_algo);
 
     ~DevMemAllocImpl();
 
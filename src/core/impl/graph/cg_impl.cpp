@@ -221,6 +221,9 @@ ComputingGraphImpl::Components::Components(ComputingGraphImpl* owner)
 #endif
 #if MGB_ENABLE_MEMORY_SWAP
           memory_swap_support{owner},
+#endif
+#if MGB_ENABLE_MEMORY_OFFLOAD
+          memory_offload_support{owner},
 #endif
           eager_eval_manager{owner}
 
@@ -415,6 +418,14 @@ ComputingGraphImpl::CompileState ComputingGraphImpl::compile_prepare(
     SpecialOprStat sopr_stat;
     auto dest_vars = get_dest_vars_from_out_spec(out_spec, sopr_stat);
 
+    // sublinear memory, memory swap and memory offload modify the graph on
+    // each compiling, so their results are not cached
+    size_t cache_size = options().compile_cache_size;
+    if (options().enable_sublinear_memory_opt ||
+        options().enable_memory_swap || options().enable_memory_offload) {
+        cache_size = 0;
+    }
+
 #if MGB_ENABLE_SUBLINEAR
     if (options().enable_sublinear_memory_opt) {
         if (!sopr_stat.has_virtual_grad) {
@@ -433,20 +444,7 @@ ComputingGraphImpl::CompileState ComputingGraphImpl::compile_prepare(
     mgb_assert(!options().eager_evaluation,
                "attempt to compile eager_evaluation graph");
 
-    {
-        bool need_opt = std::abs(options().graph_opt_level) >= 2;
-        gopt::GraphOptimizer optimizer;
-        optimizer.verbosity(options().log_level);
-        optimizer.enable_check_result(options().graph_opt_level < 0);
-        if (sopr_stat.has_virtual_grad) {
-            if (need_opt)
-                optimizer.add_preset_passes(false, nullptr, &options());
-            optimizer.add_pass<gopt::ExpandVirtualGradPass>();
-        }
-        if (need_opt)
-            optimizer.add_preset_passes(true, nullptr, &options());
-        optimizer.apply_inplace(dest_vars);
-    }
+    optimize_dest_vars(dest_vars, sopr_stat, cache_size);
 #endif
 
 #if MGB_ENABLE_TENSOR_RT
@@ -499,7 +497,8 @@ ComputingGraphImpl::CompileState ComputingGraphImpl::compile_prepare(
                 dest_vars[i] = cb_caller->output(0);
             }
         }
-        opr_seq = topo_sorter().get_comp_seq(extra_info, dest_vars);
+        opr_seq = topo_sorter().get_comp_seq_cached(extra_info, dest_vars,
+                                                    cache_size);
     };
 
 #if MGB_ENABLE_MEMORY_SWAP
@@ -518,6 +517,18 @@ ComputingGraphImpl::CompileState ComputingGraphImpl::compile_prepare(
     mgb_assert(!options().enable_memory_swap);
 #endif
 
+    // memory offload is applied after all other graph modifications, so
+    // the offloaded vars are chosen from the final opr seq
+    auto apply_memory_offload = [&]() {
+#if MGB_ENABLE_MEMORY_OFFLOAD
+        if (options().enable_memory_offload) {
+            cmpnt.memory_offload_support.modify_dest_var_inplace(dest_vars);
+        }
+#else
+        mgb_assert(!options().enable_memory_offload);
+#endif
+    };
+
 #if MGB_ENABLE_SUBLINEAR
     if (options().enable_sublinear_memory_opt) {
         MGB_TRY {
@@ -528,6 +539,7 @@ ComputingGraphImpl::CompileState ComputingGraphImpl::compile_prepare(
                 cmpnt.memory_swap_support.modify_dest_var_inplace(dest_vars);
             }
 #endif
+            apply_memory_offload();
 
             init_opr_seq();
         }
@@ -540,15 +552,79 @@ ComputingGraphImpl::CompileState ComputingGraphImpl::compile_prepare(
                 seq_modifier_for_sublinear_memory().restore_graph_option());
         seq_modifier_for_sublinear_memory().sanity_check(*opr_seq);
     } else {
+        apply_memory_offload();
         init_opr_seq();
     }
 #else
+    apply_memory_offload();
     init_opr_seq();
 #endif  //  MGB_ENABLE_SUBLINEAR
 
     return {std::move(extra_info), opr_seq};
 }
 
+#if !MGB_BUILD_SLIM_SERVING
+void ComputingGraphImpl::optimize_dest_vars(VarNodeArray& dest_vars,
+                                            const SpecialOprStat& sopr_stat,
+                                            size_t cache_size) {
+    bool need_opt = std::abs(options().graph_opt_level) >= 2;
+    if (!need_opt && !sopr_stat.has_virtual_grad) {
+        return;
+    }
+
+    auto&& cache = m_optimized_dest_vars_cache;
+    auto&& var_replace_map = const_cast<ThinHashMap<VarNode*, VarNode*>&>(
+            gopt::GraphOptimizer::var_replace_map(*this));
+    if (cache_size) {
+        for (auto iter = cache.begin(); iter != cache.end(); ++iter) {
+            if (iter->src == dest_vars &&
+                iter->graph_opt_level == options().graph_opt_level &&
+                iter->jit == options().graph_opt.jit) {
+                ++m_optimized_dest_vars_cache_nr_hit;
+                cache.splice(cache.begin(), cache, iter);
+                dest_vars = iter->dest;
+                var_replace_map.clear();
+                for (auto&& i : iter->var_replace_map)
+                    var_replace_map[i.first] = i.second;
+                if (options().log_level >= 2) {
+                    mgb_log_debug("graph optimization: reuse cached result");
+                }
+                return;
+            }
+        }
+    }
+
+    OptimizedDestVars cached;
+    if (cache_size) {
+        ++m_optimized_dest_vars_cache_nr_miss;
+        cached.src = dest_vars;
+    }
+
+    gopt::GraphOptimizer optimizer;
+    optimizer.verbosity(options().log_level);
+    optimizer.enable_check_result(options().graph_opt_level < 0);
+    if (sopr_stat.has_virtual_grad) {
+        if (need_opt)
+            optimizer.add_preset_passes(false, nullptr, &options());
+        optimizer.add_pass<gopt::ExpandVirtualGradPass>();
+    }
+    if (need_opt)
+        optimizer.add_preset_passes(true, nullptr, &options());
+    optimizer.apply_inplace(dest_vars);
+
+    if (cache_size) {
+        cached.dest = dest_vars;
+        cached.graph_opt_level = options().graph_opt_level;
+        cached.jit = options().graph_opt.jit;
+        for (auto&& i : var_replace_map)
+            cached.var_replace_map[i.first] = i.second;
+        cache.emplace_front(std::move(cached));
+        while (cache.size() > cache_size)
+            cache.pop_back();
+    }
+}
+#endif
+
 std::unique_ptr<AsyncExecutable> ComputingGraphImpl::compile_commit(
         CompileState state) {
     auto comp_seq = std::make_unique<ComputingSequence>(shared_from_this());
@@ -681,6 +757,8 @@ void ComputingGraphImpl::set_as_subgraph(ComputingGraph& par_graph) {
     m_node_id_counter = m_parent_graph->m_node_id_counter;
     options().var_sanity_check_first_run =
             par_graph.options().var_sanity_check_first_run;
+    options().var_sanity_check_mem_fwd_only =
+            par_graph.options().var_sanity_check_mem_fwd_only;
     par_graph.event().signal_inplace<event::SubgraphAssociated>(&par_graph,
                                                                 this);
 }
@@ -710,6 +788,29 @@ GraphExecutable::ExecEnv* ComputingGraphImpl::current_exec_env() {
     return nullptr;
 }
 
+#if !MGB_BUILD_SLIM_SERVING
+size_t ComputingGraphImpl::optimized_dest_vars_cache_nr_hit() const {
+    return m_optimized_dest_vars_cache_nr_hit;
+}
+
+size_t ComputingGraphImpl::optimized_dest_vars_cache_nr_miss() const {
+    return m_optimized_dest_vars_cache_nr_miss;
+}
+
+size_t ComputingGraphImpl::comp_seq_cache_nr_hit() {
+    return topo_sorter().seq_cache_nr_hit();
+}
+
+size_t ComputingGraphImpl::comp_seq_cache_nr_miss() {
+    return topo_sorter().seq_cache_nr_miss();
+}
+#endif
+
+const StaticMemPlanCache* ComputingGraphImpl::static_mem_plan_cache(
+        CompNode cn) {
+    return var_node_mem_manager().static_mem_plan_cache(cn);
+}
+
 Maybe<size_t> ComputingGraphImpl::opr_step_num_in_cur_comp_seq(
         OperatorNodeBase* opr) {
     mgb_assert(m_current_comp_seq && opr->owner_graph() == this);
@@ -17,6 +17,7 @@
 #include "./seq_comp_node_opt_impl.h"
 #include "./seq_sublinear_memory.h"
 #include "./static_infer_impl.h"
+#include "./swap/memory_offload.h"
 #include "./swap/memory_swap.h"
 #include "./topo_sort.h"
 #include "./var_node_mem_mgr.h"
@@ -59,6 +60,9 @@ class ComputingGraphImpl final : public ComputingGraph {
 #endif
 #if MGB_ENABLE_MEMORY_SWAP
         swap::MemorySwap memory_swap_support;
+#endif
+#if MGB_ENABLE_MEMORY_OFFLOAD
+        swap::MemoryOffload memory_offload_support;
 #endif
         EagerEvalManager eager_eval_manager;
 
@@ -90,6 +94,29 @@ class ComputingGraphImpl final : public ComputingGraph {
     std::aligned_storage_t<sizeof(Components), alignof(Components)>
             m_components_storage;
 
+#if !MGB_BUILD_SLIM_SERVING
+    //! a result of global graph optimization cached for
+    //! Options::compile_cache_size
+    struct OptimizedDestVars {
+        VarNodeArray src, dest;
+        int16_t graph_opt_level;
+        uint8_t jit;
+        //! gopt::GraphOptimizer::var_replace_map() after the optimization
+        ThinHashMap<VarNode*, VarNode*> var_replace_map;
+    };
+    std::list<OptimizedDestVars> m_optimized_dest_vars_cache;
+    size_t m_optimized_dest_vars_cache_nr_hit = 0,
+           m_optimized_dest_vars_cache_nr_miss = 0;
+
+    /*!
+     * \brief apply global graph optimization on dest vars inplace, or reuse
+     *      a cached result if \p cache_size is nonzero
+     */
+    void optimize_dest_vars(VarNodeArray& dest_vars,
+                            const SpecialOprStat& sopr_stat,
+                            size_t cache_size);
+#endif
+
     /*!
      * \brief get dest vars and add extra_vardeps from OutputSpec
      * \param[out] has_virtual_grad whether there are VirtualGrad oprs that
@@ -215,6 +242,23 @@ public:
      */
     GraphExecutable::ExecEnv* current_exec_env();
 
+#if !MGB_BUILD_SLIM_SERVING
+    /*!
+     * \brief numbers of hits and misses of the caches enabled by
+     *      Options::compile_cache_size, for global graph optimization and
+     *      for topo sort
+     *
+     * Only compilings with nonzero cache size are counted.
+     */
+    size_t optimized_dest_vars_cache_nr_hit() const;
+    size_t optimized_dest_vars_cache_nr_miss() const;
+    size_t comp_seq_cache_nr_hit();
+    size_t comp_seq_cache_nr_miss();
+#endif
+
+    //! see VarNodeMemManager::static_mem_plan_cache()
+    const StaticMemPlanCache* static_mem_plan_cache(CompNode cn);
+
     /*!
      * \brief get step number of an operator in current computing sequence
      * \return step number; None if opr not in seq
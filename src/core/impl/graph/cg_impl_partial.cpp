@@ -738,6 +738,7 @@ void ComputingGraphImpl::MultiPartCompiler::assign_graph_opt(
     S(async_exec_level);
     S(force_dynamic_alloc);
     S(var_sanity_check_first_run);
+    S(var_sanity_check_mem_fwd_only);
     S(allocate_static_mem_after_graph_compile);
     S(enable_var_mem_defragment);
 #undef S
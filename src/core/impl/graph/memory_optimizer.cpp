@@ -128,6 +128,41 @@ void MemoryOptimizerHelper::restore_graph_option() {
 MemoryOptimizerHelper::MemoryOptimizerHelper(ComputingGraphImpl* owner)
         : m_owner_graph(owner) {}
 
+constexpr double MemoryOptimizerHelper::COMPUTATION_PER_BYTE;
+
+double MemoryOptimizerHelper::estimate_opr_cost(OperatorNodeBase* opr) {
+    if (!m_footprint) {
+        m_footprint = std::make_unique<OprFootprint>();
+    }
+    auto&& infer_mgr = m_owner_graph->static_infer_manager();
+    bool shape_valid = true;
+    size_t memory = 0;
+    auto add_var = [&](VarNode* var, TensorShapeArray& shapes) {
+        auto shp = infer_mgr.infer_shape_fallible(var);
+        if (!shp) {
+            shape_valid = false;
+            shapes.emplace_back();
+            return;
+        }
+        shapes.push_back(*shp);
+        if (!var->contain_flag(VarNode::Flag::VOLATILE_CONTENT)) {
+            memory += var->dtype().size(shp->total_nr_elems());
+        }
+    };
+    TensorShapeArray inp_shapes, out_shapes;
+    for (auto i : opr->input()) {
+        add_var(i, inp_shapes);
+    }
+    for (auto i : opr->output()) {
+        add_var(i, out_shapes);
+    }
+    double cost = memory * COMPUTATION_PER_BYTE;
+    if (shape_valid) {
+        cost += m_footprint->get_computation(opr, inp_shapes, out_shapes);
+    }
+    return cost;
+}
+
 }  // namespace cg
 }  // namespace mgb
 
@@ -11,6 +11,7 @@
 
 #pragma once
 #include "./impl_common.h"
+#include "megbrain/plugin/opr_footprint.h"
 
 namespace mgb {
 namespace cg {
@@ -29,7 +30,13 @@ class MemoryOptimizerHelper {
 
     CompNode::UnorderedMap<OprNodeArray> m_cn2oprseq;
 
+    std::unique_ptr<OprFootprint> m_footprint;
+
 public:
+    //! number of arithmetic operations that take about the same time as
+    //! accessing one byte of memory, so memory-bound oprs are not free
+    static constexpr double COMPUTATION_PER_BYTE = 16;
+
     //! get operator sequence in computing(topological) order.
     struct CompSeq {
         const OprNodeArray* m_seq;
@@ -72,6 +79,17 @@ public:
     //! restore graph options to the version before modified by
     //! modify_endpoint_vars()
     void restore_graph_option();
+
+    /*!
+     * \brief estimate computing cost of an opr in number of arithmetic
+     *      operations, including its memory access
+     *
+     * Shapes are statically inferred, so it can be used while the graph is
+     * compiled. Vars whose shapes can not be inferred are ignored, and the
+     * arithmetic operations are only counted if all shapes are inferred.
+     * Static inference is not thread safe, so neither is this.
+     */
+    double estimate_opr_cost(OperatorNodeBase* opr);
 };
 
 }  // namespace cg
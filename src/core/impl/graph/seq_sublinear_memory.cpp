@@ -10,6 +10,7 @@
  */
 
 #include "./seq_sublinear_memory.h"
+#include "./cg_impl.h"
 
 #if MGB_ENABLE_SUBLINEAR
 
@@ -25,6 +26,7 @@ using namespace cg;
 #include "megbrain/utils/timer.h"
 
 #include <cmath>
+#include <deque>
 #include <random>
 
 namespace {
@@ -194,6 +196,21 @@ public:
 
     //! generate split point set from thresh
     SplitPointSet get_split_point_set(size_t block_size_thresh);
+
+    /*!
+     * \brief generate split point set that minimizes recomputing cost in a
+     *      chain model of the opr sequence
+     *
+     * In the chain model, outputs of the last opr in each block are kept and
+     * other oprs in the block are recomputed once. The objective is
+     * recomputing cost plus \p mem_weight times total size of kept vars,
+     * under the constraint that total output size of each block does not
+     * exceed \p block_size_thresh (unless the block has only one opr).
+     */
+    SplitPointSet get_split_point_set_chain(const OprCostMap& opr_cost,
+                                            size_t block_size_thresh,
+                                            double mem_weight);
+
     /*!
      * \brief get memory bottleneck after imposing a block size threshold
      *
@@ -203,6 +220,9 @@ public:
 
     //! get action for previous get_memory_bottleneck() call
     void get_prev_action(SeqModifyAction& action);
+
+    //! get recomputing cost for previous get_memory_bottleneck() call
+    double get_prev_recompute_cost(const OprCostMap& opr_cost) const;
 };
 
 void SeqModifierForSublinearMemory::ModifyActionPlanner::get_prev_action(
@@ -219,6 +239,19 @@ void SeqModifierForSublinearMemory::ModifyActionPlanner::get_prev_action(
     }
 }
 
+double SeqModifierForSublinearMemory::ModifyActionPlanner::
+        get_prev_recompute_cost(const OprCostMap& opr_cost) const {
+    double cost = 0;
+    for (auto&& opr : m_seq) {
+        for (auto&& i : opr->oprs_insert_before) {
+            auto iter = opr_cost.find(i->orig_opr);
+            if (iter != opr_cost.end())
+                cost += iter->second;
+        }
+    }
+    return cost;
+}
+
 size_t
 SeqModifierForSublinearMemory::ModifyActionPlanner::get_memory_bottleneck(
         const SplitPointSet& split_point_set) {
@@ -276,6 +309,75 @@ SeqModifierForSublinearMemory::ModifyActionPlanner::get_split_point_set(
     return split_point_set;
 }
 
+SeqModifierForSublinearMemory::SplitPointSet
+SeqModifierForSublinearMemory::ModifyActionPlanner::get_split_point_set_chain(
+        const OprCostMap& opr_cost, size_t block_size_thresh,
+        double mem_weight) {
+    /*
+     * Let f[j] be the min objective for the first j oprs, and block [a, j]
+     * be the last block. Since only the last opr in a block is not
+     * recomputed, we have
+     *
+     *   f[j + 1] = min(f[a] - cost_sum[a]) + cost_sum[j] + mem_weight * size[j]
+     *
+     * for a in [lo, j], where lo is the first opr that makes block [lo, j]
+     * fit in block_size_thresh. lo is non-decreasing in j, so the min can be
+     * maintained by a monotonic queue and the total time is linear.
+     */
+    constexpr double INF = std::numeric_limits<double>::infinity();
+    size_t nr_opr = m_seq.size();
+    std::vector<double> cost_sum(nr_opr + 1), f(nr_opr + 1, INF);
+    std::vector<size_t> size_sum(nr_opr + 1), out_size(nr_opr),
+            block_begin(nr_opr + 1);
+    for (size_t i = 0; i < nr_opr; ++i) {
+        auto opr = m_seq[i].get();
+        auto iter = opr_cost.find(opr->orig_opr);
+        cost_sum[i + 1] =
+                cost_sum[i] + (iter == opr_cost.end() ? 0. : iter->second);
+        for (auto var : opr->output)
+            out_size[i] += var->size;
+        size_sum[i + 1] = size_sum[i] + out_size[i];
+    }
+
+    // blocks must end at endpoint oprs if they are given, in which case the
+    // block size is not limited
+    bool endpoint_only = m_nr_endpoint_oprs;
+    auto get_val = [&](size_t begin) { return f[begin] - cost_sum[begin]; };
+    std::deque<size_t> begin_queue;
+    size_t lo = 0;
+    f[0] = 0;
+    for (size_t j = 0; j < nr_opr; ++j) {
+        if (f[j] < INF) {
+            while (!begin_queue.empty() &&
+                   get_val(begin_queue.back()) >= get_val(j)) {
+                begin_queue.pop_back();
+            }
+            begin_queue.push_back(j);
+        }
+        if (!endpoint_only) {
+            while (lo < j && size_sum[j + 1] - size_sum[lo] > block_size_thresh)
+                ++lo;
+        }
+        while (!begin_queue.empty() && begin_queue.front() < lo)
+            begin_queue.pop_front();
+
+        if (begin_queue.empty() ||
+            (endpoint_only && !m_seq[j]->is_endpoint && j + 1 < nr_opr)) {
+            continue;
+        }
+        auto begin = begin_queue.front();
+        f[j + 1] = get_val(begin) + cost_sum[j] + mem_weight * out_size[j];
+        block_begin[j + 1] = begin;
+    }
+    mgb_assert(f[nr_opr] < INF);
+
+    auto split_point_set = make_split_point_set();
+    for (size_t j = nr_opr; j; j = block_begin[j])
+        split_point_set->push_back(j - 1);
+    std::reverse(split_point_set->begin(), split_point_set->end());
+    return split_point_set;
+}
+
 void SeqModifierForSublinearMemory::ModifyActionPlanner::init_seq(
         const OprNodeArray& opr_seq) {
     m_orig_opr_seq = &opr_seq;
@@ -681,13 +783,25 @@ class SeqModifierForSublinearMemory::ActionSearcherSingleCN {
     std::vector<std::future<void>> m_futures;
     std::mutex m_mtx;
 
-    struct Config {
-        size_t thresh_nr_try = 10;
-        size_t genetic_nr_iter = 0;
-        size_t genetic_pool_size = 20;
-        double lb_memory = 0;
-    };
-    Config m_config;
+    //! recomputing cost of the plan corresponding to m_min_bottleneck
+    double m_min_cost;
+
+    //! estimated computing cost of each opr in m_cur_opr_seq
+    OprCostMap m_opr_cost;
+    //! total cost of oprs and total size of vars in m_cur_opr_seq
+    double m_seq_cost, m_seq_size;
+
+    ComputingGraph::Options::SublinearMemConfig m_config;
+
+    //! initialize m_opr_cost, m_seq_cost and m_seq_size
+    void init_opr_cost();
+
+    /*!
+     * \brief whether a plan is better than the current best plan; m_mtx must
+     *      be held
+     * \param tie_break whether to prefer this plan if they are equally good
+     */
+    bool is_better_plan(size_t bottleneck, double cost, bool tie_break) const;
 
     /*!
      * \brief check given thresh, and update states
@@ -695,16 +809,24 @@ class SeqModifierForSublinearMemory::ActionSearcherSingleCN {
      */
     void do_search_update_thresh(size_t thresh);
     void do_search_update_split_point_set(SplitPointSet& split_point_set);
+    void do_search_update_chain(size_t block_size_thresh, double mem_weight);
+
+    //! check split point set on a planner whose seq has been initialized
+    void update_split_point_set(ModifyActionPlanner* planner,
+                                SplitPointSet& split_point_set);
 
     //! invoke search asynchronously in m_planner_thread_pool
     void invoke_search(size_t thresh);
     void invoke_search(SplitPointSet&& split_point_set);
+    void invoke_search_chain(size_t block_size_thresh, double mem_weight);
 
     //! wait for all unfinished asynchronous invoke_search() calls
     void wait_all();
 
     //! search for initial solutions
     void search_preset();
+    //! search for solutions of the chain model with memory budget
+    void search_chain();
     //! genetic algorithm
     void search_genetic();
     void search_refine();
@@ -724,7 +846,8 @@ class SeqModifierForSublinearMemory::ActionSearcherSingleCN {
 
 public:
     ActionSearcherSingleCN(SeqModifierForSublinearMemory* par)
-            : m_par_modifier{par} {
+            : m_par_modifier{par},
+              m_config{par->m_owner_graph->options().sublinear_mem_config} {
         if (auto env = MGB_GETENV("MGB_SUBLINEAR_MEMORY_THRESH_NR_TRY")) {
             m_config.thresh_nr_try = std::stoi(env);
         }
@@ -732,14 +855,18 @@ public:
             m_config.genetic_nr_iter = std::stoi(env);
         }
         if (auto env = MGB_GETENV("MGB_SUBLINEAR_MEMORY_GENETIC_POOL_SIZE")) {
-            auto psize = static_cast<size_t>(std::stoi(env));
-            mgb_assert(psize > 0 || m_config.genetic_nr_iter == 0,
-                       "invalid pool size %zu in genetic algorithm,", psize);
-            m_config.genetic_pool_size = psize;
+            m_config.genetic_pool_size = std::stoi(env);
         }
+        mgb_assert(m_config.genetic_pool_size > 0 ||
+                           m_config.genetic_nr_iter == 0,
+                   "invalid pool size %zu in genetic algorithm,",
+                   m_config.genetic_pool_size);
         if (auto env = MGB_GETENV("MGB_SUBLINEAR_MEMORY_LOWER_BOUND_MB")) {
             m_config.lb_memory = std::stod(env) * 1024 * 1024;
         }
+        if (auto env = MGB_GETENV("MGB_SUBLINEAR_MEMORY_BUDGET_MB")) {
+            m_config.memory_budget = std::stod(env) * 1024 * 1024;
+        }
     }
 
     const SeqModifyAction& search(CompNode comp_node, const OprNodeArray* seq);
@@ -754,11 +881,13 @@ void SeqModifierForSublinearMemory::ActionSearcherSingleCN::
     planner->init_seq(*m_cur_opr_seq);
     SplitPointSet split_point_set = planner->get_split_point_set(thresh);
     auto cur = planner->get_memory_bottleneck(split_point_set);
+    auto cost = planner->get_prev_recompute_cost(m_opr_cost);
 
     MGB_LOCK_GUARD(m_mtx);
-    if (cur < m_min_bottleneck || (cur == m_min_bottleneck && m_best_thresh < thresh)) {
+    if (is_better_plan(cur, cost, m_best_thresh < thresh)) {
         m_best_thresh = thresh;
         m_min_bottleneck = cur;
+        m_min_cost = cost;
         m_best_sps = split_point_set;
         planner->get_prev_action(m_action);
     }
@@ -773,18 +902,69 @@ void SeqModifierForSublinearMemory::ActionSearcherSingleCN::
                     .get();
 
     planner->init_seq(*m_cur_opr_seq);
+    update_split_point_set(planner, split_point_set);
+}
+
+void SeqModifierForSublinearMemory::ActionSearcherSingleCN::
+        do_search_update_chain(size_t block_size_thresh, double mem_weight) {
+    ModifyActionPlanner* planner =
+            m_par_modifier->m_thread2planner.at(std::this_thread::get_id())
+                    .get();
+
+    planner->init_seq(*m_cur_opr_seq);
+    auto split_point_set = planner->get_split_point_set_chain(
+            m_opr_cost, block_size_thresh, mem_weight);
+    update_split_point_set(planner, split_point_set);
+}
+
+void SeqModifierForSublinearMemory::ActionSearcherSingleCN::
+        update_split_point_set(ModifyActionPlanner* planner,
+                               SplitPointSet& split_point_set) {
     auto cur = planner->get_memory_bottleneck(split_point_set);
+    auto cost = planner->get_prev_recompute_cost(m_opr_cost);
 
     MGB_LOCK_GUARD(m_mtx);
-    if (cur < m_min_bottleneck || (cur == m_min_bottleneck &&
-                cmp_sps(split_point_set, m_best_sps))) {
+    if (is_better_plan(cur, cost, cmp_sps(split_point_set, m_best_sps))) {
         m_min_bottleneck = cur;
+        m_min_cost = cost;
         m_best_sps = split_point_set;
         planner->get_prev_action(m_action);
     }
     m_cur_records.emplace_back(std::move(split_point_set), cur);
 }
 
+bool SeqModifierForSublinearMemory::ActionSearcherSingleCN::is_better_plan(
+        size_t bottleneck, double cost, bool tie_break) const {
+    if (auto budget = m_config.memory_budget) {
+        // prefer plans within budget, and then the ones with less recomputing
+        bool fit = bottleneck <= budget, best_fit = m_min_bottleneck <= budget;
+        if (fit != best_fit)
+            return fit;
+        if (fit && cost != m_min_cost)
+            return cost < m_min_cost;
+    }
+    return bottleneck < m_min_bottleneck ||
+           (bottleneck == m_min_bottleneck && tie_break);
+}
+
+void SeqModifierForSublinearMemory::ActionSearcherSingleCN::init_opr_cost() {
+    auto&& var2memsize = *m_par_modifier->m_mem_opt.var2memsize();
+    auto&& all_opr_cost = m_par_modifier->m_opr_cost;
+    m_opr_cost.clear();
+    m_seq_cost = m_seq_size = 0;
+    for (auto opr : *m_cur_opr_seq) {
+        for (auto i : opr->output()) {
+            auto iter = var2memsize.find(i);
+            if (iter != var2memsize.end()) {
+                m_seq_size += iter->second;
+            }
+        }
+        double cost = all_opr_cost.at(opr);
+        m_opr_cost[opr] = cost;
+        m_seq_cost += cost;
+    }
+}
+
 void SeqModifierForSublinearMemory::ActionSearcherSingleCN::invoke_search(
         size_t thresh) {
     m_futures.emplace_back(m_par_modifier->m_planner_thread_pool.launch(
@@ -798,6 +978,13 @@ void SeqModifierForSublinearMemory::ActionSearcherSingleCN::invoke_search(
             split_point_set));
 }
 
+void SeqModifierForSublinearMemory::ActionSearcherSingleCN::invoke_search_chain(
+        size_t block_size_thresh, double mem_weight) {
+    m_futures.emplace_back(m_par_modifier->m_planner_thread_pool.launch(
+            &ActionSearcherSingleCN::do_search_update_chain, this,
+            block_size_thresh, mem_weight));
+}
+
 void SeqModifierForSublinearMemory::ActionSearcherSingleCN::wait_all() {
     for (auto&& i : m_futures)
         i.get();
@@ -831,6 +1018,26 @@ void SeqModifierForSublinearMemory::ActionSearcherSingleCN::search_preset() {
     wait_all();
 }
 
+void SeqModifierForSublinearMemory::ActionSearcherSingleCN::search_chain() {
+    auto budget = m_config.memory_budget;
+    if (!budget)
+        return;
+
+    // the memory weight is relative to the average cost per byte, and block
+    // sizes are fractions of the budget; all the solutions of the chain model
+    // are then checked by the planner for actual bottleneck and cost
+    double base_weight = m_seq_cost / std::max(m_seq_size, 1.);
+    for (int i = -3; i <= 3; ++i) {
+        double weight = base_weight * std::pow(4., i);
+        invoke_search_chain(std::numeric_limits<size_t>::max(), weight);
+        for (size_t thresh = budget / 2; thresh && thresh >= budget / 32;
+             thresh /= 2) {
+            invoke_search_chain(thresh, weight);
+        }
+    }
+    wait_all();
+}
+
 void SeqModifierForSublinearMemory::ActionSearcherSingleCN::search_genetic() {
     RNGxorshf rng(2333);
     size_t POOL_SIZE = m_config.genetic_pool_size;
@@ -954,12 +1161,11 @@ void SeqModifierForSublinearMemory::ActionSearcherSingleCN::search_genetic() {
 
 void SeqModifierForSublinearMemory::ActionSearcherSingleCN::search_refine() {
     size_t lower_bound = m_config.lb_memory;
-    if (m_min_bottleneck >= lower_bound)
+    if (m_config.memory_budget || m_min_bottleneck >= lower_bound)
         return;
-    OprFootprint footprint;
     ThinHashSet<OperatorNodeBase*> dup_oprs_set;
     auto get_computation = [&](OperatorNodeBase* opr) {
-        return footprint.get_computation(opr);
+        return m_opr_cost.at(opr);
     };
     auto cmp = [&](size_t idx_a, size_t idx_b) {
         auto a = m_cur_opr_seq->at(idx_a);
@@ -1017,6 +1223,8 @@ SeqModifierForSublinearMemory::ActionSearcherSingleCN::search(
 
     RealTimer timer;
     m_best_thresh = m_min_bottleneck = std::numeric_limits<size_t>::max();
+    m_min_cost = std::numeric_limits<double>::infinity();
+    init_opr_cost();
 
     //! init search
     invoke_search(m_best_thresh);
@@ -1024,23 +1232,54 @@ SeqModifierForSublinearMemory::ActionSearcherSingleCN::search(
 
     search_preset();
     auto t0 = timer.get_msecs_reset();
-    search_genetic();
+    search_chain();
     auto t1 = timer.get_msecs_reset();
-    search_refine();
+    search_genetic();
     auto t2 = timer.get_msecs_reset();
+    search_refine();
+    auto t3 = timer.get_msecs_reset();
+
+    // recomputing cost of final action, which may be modified by refine
+    double recompute_cost = 0;
+    size_t nr_recompute_opr = 0;
+    for (auto&& i : m_action) {
+        for (auto opr : i.second) {
+            recompute_cost += m_opr_cost.at(opr);
+        }
+        nr_recompute_opr += i.second.size();
+    }
+    double recompute_ratio = m_seq_cost ? recompute_cost / m_seq_cost : 0.;
 
     std::sort(m_history.begin(), m_history.end());
     m_par_modifier->m_prev_min_bottleneck.at(comp_node) = m_min_bottleneck;
+    m_par_modifier->m_prev_recompute_ratio.at(comp_node) = recompute_ratio;
 
 #if MGB_ENABLE_LOGGING
     constexpr double SIZE2MB = 1.0 / 1024 / 1024;
+    if (auto budget = m_config.memory_budget) {
+        auto msg = ssprintf(
+                "sublinear memory plan: comp_node=%s budget=%.2fMiB "
+                "bottleneck=%.2fMiB nr_recompute_opr=%zu/%zu "
+                "recompute_cost=%.2f%%",
+                comp_node.to_string().c_str(), budget * SIZE2MB,
+                m_min_bottleneck * SIZE2MB, nr_recompute_opr, seq->size(),
+                recompute_ratio * 100);
+        if (m_min_bottleneck > budget) {
+            mgb_log_warn("%s; memory budget can not be satisfied",
+                         msg.c_str());
+        } else {
+            mgb_log("%s", msg.c_str());
+        }
+    }
     std::string msg{
             ssprintf("finished searching for sublinear memory: "
                      "comp_node=%s seq_len=%zu nr_search=%zu "
-                     "time=%.1fms(init%.2f genetic%.2f refine%.2f)\n"
+                     "time=%.1fms(init%.2f chain%.2f genetic%.2f "
+                     "refine%.2f) recompute_cost=%.2f%%\n"
                      "thresh     bottleneck",
                      comp_node.to_string().c_str(), seq->size(),
-                     m_history.size(), t0 + t1 + t2, t0, t1, t2)};
+                     m_history.size(), t0 + t1 + t2 + t3, t0, t1, t2, t3,
+                     recompute_ratio * 100)};
     for (auto&& i : m_history) {
         msg.push_back('\n');
         msg.append(ssprintf("%-10.2f %-10.2f", i.first * SIZE2MB,
@@ -1061,7 +1300,8 @@ SeqModifierForSublinearMemory::ActionSearcherSingleCN::search(
     }
     mgb_log_debug("%s", msg.c_str());
 #else
-    MGB_MARK_USED_VAR(t0 + t1 + t2);
+    MGB_MARK_USED_VAR(t0 + t1 + t2 + t3);
+    MGB_MARK_USED_VAR(nr_recompute_opr);
 #endif
     return m_action;
 }
@@ -1117,18 +1357,23 @@ SeqModifierForSublinearMemory::search_action(
         const CompNode::UnorderedMap<OprNodeArray>* cn2oprseq) {
     m_thread2planner.clear();
 
-    size_t planner_concur;
+    size_t planner_concur =
+            m_owner_graph->options().sublinear_mem_config.num_worker;
     if (auto env = MGB_GETENV("MGB_SUBLINEAR_MEMORY_WORKERS")) {
-        auto set = static_cast<size_t>(std::stoi(env));
-        mgb_assert(set && set <= static_cast<size_t>(sys::get_cpu_count()) * 4,
-                   "invalid planner concurrency: %zu", set);
-        planner_concur = set;
+        planner_concur = std::stoi(env);
+        mgb_assert(planner_concur, "invalid planner concurrency: 0");
+    }
+    if (planner_concur) {
+        mgb_assert(planner_concur <=
+                           static_cast<size_t>(sys::get_cpu_count()) * 4,
+                   "invalid planner concurrency: %zu", planner_concur);
     } else {
         planner_concur = sys::get_cpu_count() / 2;
     }
 
     mgb_log_debug("use %zu threads to search for sublinear memory plan; "
-            "this can be changed via MGB_SUBLINEAR_MEMORY_WORKERS env var",
+            "this can be changed via sublinear_mem_config.num_worker or "
+            "MGB_SUBLINEAR_MEMORY_WORKERS env var",
             planner_concur);
     for (auto&& i : m_planner_thread_pool.start(planner_concur))
         m_thread2planner[i].reset(new ModifyActionPlanner{this});
@@ -1141,8 +1386,16 @@ SeqModifierForSublinearMemory::search_action(
     workers.start(cn2oprseq->size());
 
     m_prev_min_bottleneck.clear();
+    m_prev_recompute_ratio.clear();
+    m_opr_cost.clear();
     for (auto&& i : *cn2oprseq) {
         m_prev_min_bottleneck[i.first] = 0;
+        m_prev_recompute_ratio[i.first] = 0;
+        // static inference is not thread safe, so costs are estimated here
+        // before the searchers run
+        for (auto opr : i.second) {
+            m_opr_cost[opr] = m_mem_opt.estimate_opr_cost(opr);
+        }
     }
 
     std::vector<WorkerPool::Future> futures;
@@ -1346,6 +1599,11 @@ SeqModifierForSublinearMemory::prev_min_bottleneck() {
     return m_prev_min_bottleneck;
 }
 
+const CompNode::UnorderedMap<double>&
+SeqModifierForSublinearMemory::prev_recompute_ratio() {
+    return m_prev_recompute_ratio;
+}
+
 SeqModifierForSublinearMemory::SeqModifierForSublinearMemory(
         ComputingGraphImpl* owner)
         : m_mem_opt(owner), m_owner_graph(owner) {}
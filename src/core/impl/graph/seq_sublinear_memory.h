@@ -31,6 +31,9 @@ class SeqModifierForSublinearMemory {
     using SeqModifyAction = std::unordered_map<OperatorNodeBase*, OprNodeArray>;
     using SplitPointSet = std::shared_ptr<std::vector<size_t>>;
 
+    //! map from operator to its estimated computing cost
+    using OprCostMap = ThinHashMap<OperatorNodeBase*, double>;
+
     //! get modifications to be taken under some specific constraints
     class ModifyActionPlanner;
 
@@ -73,6 +76,12 @@ class SeqModifierForSublinearMemory {
 
     CompNode::UnorderedMap<size_t> m_prev_min_bottleneck;
 
+    //! recomputing cost relative to the cost of the original sequence
+    CompNode::UnorderedMap<double> m_prev_recompute_ratio;
+
+    //! estimated computing cost of all the oprs to be searched
+    OprCostMap m_opr_cost;
+
     /*!
      * \brief replace input vars according to m_var_map, and store results in
      *      m_new_inputs;
@@ -122,7 +131,12 @@ public:
     //! check whether actual opr_seq is what we expect; throw InternalError
     void sanity_check(const OprNodeArray& opr_seq);
 
+    //! memory bottleneck of the plan found in previous modification
     const CompNode::UnorderedMap<size_t>& prev_min_bottleneck();
+
+    //! estimated recomputing cost of the plan found in previous modification,
+    //! relative to the computing cost of the original opr sequence
+    const CompNode::UnorderedMap<double>& prev_recompute_ratio();
 };
 
 }  // namespace cg
@@ -0,0 +1,344 @@
+/**
+ * \file src/core/impl/graph/swap/memory_offload.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "./memory_offload.h"
+#include "./offload_opr.h"
+
+#include "../cg_impl.h"
+#include "../memory_optimizer.h"
+
+#include "megbrain/gopt/framework.h"
+#include "megbrain/serialization/opr_shallow_copy.h"
+
+#if MGB_ENABLE_MEMORY_OFFLOAD
+using namespace mgb;
+using namespace swap;
+
+struct MemoryOffload::Plan {
+    VarNode* var;
+    //! positions in opr seq after which the copy to host is waited and the
+    //! copy back is started; readers from reuse_pos use the prefetched var
+    size_t out_end, in_start, reuse_pos;
+    size_t size;
+    //! estimated time of copies not overlapped with computing
+    double stall;
+    //! product of size and estimated time in which the memory is freed
+    double benefit;
+};
+
+MemoryOffload::MemoryOffload(ComputingGraph* graph) : m_owner_graph{graph} {}
+
+MemoryOffload::~MemoryOffload() = default;
+
+void MemoryOffload::init_config() {
+    m_config = m_owner_graph->options().memory_offload_config;
+    if (auto env = MGB_GETENV("MGB_MEMORY_OFFLOAD_MIN_VAR_SIZE")) {
+        m_config.min_var_size = std::stoull(env);
+    }
+    if (auto env = MGB_GETENV("MGB_MEMORY_OFFLOAD_MAX_OVERLAP_OPRS")) {
+        m_config.max_overlap_oprs = std::stoull(env);
+    }
+    if (auto env = MGB_GETENV("MGB_MEMORY_OFFLOAD_BANDWIDTH")) {
+        m_config.copy_bandwidth = std::stod(env);
+    }
+    if (auto env = MGB_GETENV("MGB_MEMORY_OFFLOAD_COMPUTE_THROUGHPUT")) {
+        m_config.compute_throughput = std::stod(env);
+    }
+    if (auto env = MGB_GETENV("MGB_MEMORY_OFFLOAD_MAX_STALL_RATIO")) {
+        m_config.max_stall_ratio = std::stod(env);
+    }
+    if (auto env = MGB_GETENV("MGB_MEMORY_OFFLOAD_COMPRESS")) {
+        m_config.compress = std::stoi(env);
+    }
+    mgb_assert(m_config.max_overlap_oprs > 0 && m_config.copy_bandwidth > 0 &&
+                       m_config.compute_throughput > 0,
+               "invalid memory offload config: max_overlap_oprs=%zu "
+               "copy_bandwidth=%g compute_throughput=%g",
+               m_config.max_overlap_oprs, m_config.copy_bandwidth,
+               m_config.compute_throughput);
+}
+
+std::vector<double> MemoryOffload::estimate_opr_time(
+        const cg::OprNodeArray& opr_seq) {
+    cg::MemoryOptimizerHelper mem_opt{
+            static_cast<cg::ComputingGraphImpl*>(m_owner_graph)};
+    std::vector<double> ret;
+    ret.reserve(opr_seq.size());
+    for (auto opr : opr_seq) {
+        ret.push_back(mem_opt.estimate_opr_cost(opr) /
+                      m_config.compute_throughput);
+    }
+    return ret;
+}
+
+std::vector<MemoryOffload::Plan> MemoryOffload::make_plan(
+        const cg::OprNodeArray& opr_seq, const VarNodeArray& dest_vars) {
+    using DepType = OperatorNodeBase::NodeProp::DepType;
+    auto&& infer_mgr = m_owner_graph->static_infer_manager();
+    size_t nr_opr = opr_seq.size();
+
+    auto opr_time = estimate_opr_time(opr_seq);
+    std::vector<double> time_prefix(nr_opr + 1);
+    for (size_t i = 0; i < nr_opr; ++i) {
+        time_prefix[i + 1] = time_prefix[i] + opr_time[i];
+    }
+    //! estimated time of oprs in [begin, end]
+    auto time_between = [&](size_t begin, size_t end) {
+        return time_prefix[end + 1] - time_prefix[begin];
+    };
+
+    //! positions of oprs that read the device value of each var
+    struct VarUse {
+        std::vector<size_t> pos;
+        bool valid = true;
+    };
+    ThinHashMap<VarNode*, VarUse> var2use;
+    for (size_t i = 0; i < nr_opr; ++i) {
+        auto opr = opr_seq[i];
+        for (auto&& dep : opr->node_prop().dep_map()) {
+            auto&& use = var2use[dep.first];
+            if (static_cast<bool>(dep.second & (DepType::HOST_VALUE |
+                                                DepType::HOST_VALUE_DYNOUT))) {
+                use.valid = false;
+            }
+            if (OperatorNodeBase::NodeProp::is_device_value_dep(dep.second)) {
+                use.pos.push_back(i);
+                for (auto j : opr->output()) {
+                    if (j->comp_node() != dep.first->comp_node()) {
+                        use.valid = false;
+                    }
+                }
+            }
+        }
+    }
+
+    ThinHashSet<VarNode*> dest_var_set(dest_vars.begin(), dest_vars.end());
+    std::vector<Plan> candidates;
+    for (size_t producer = 0; producer < nr_opr; ++producer) {
+        for (auto var : opr_seq[producer]->output()) {
+            using F = VarNode::Flag;
+            if (dest_var_set.count(var) ||
+                var->contain_flag(F::PERSISTENT_DEVICE_VALUE |
+                                  F::NO_SYS_MEM_ALLOC | F::VOLATILE_CONTENT)) {
+                continue;
+            }
+            auto iter = var2use.find(var);
+            if (iter == var2use.end() || !iter->second.valid) {
+                continue;
+            }
+            auto shp = infer_mgr.infer_shape_fallible(var);
+            if (!shp) {
+                continue;
+            }
+            size_t size = var->dtype().size(shp->total_nr_elems());
+            if (!size || size < m_config.min_var_size) {
+                continue;
+            }
+
+            // find the longest interval between adjacent uses
+            size_t last_use = 0, reuse_pos = 0, prev = producer;
+            for (auto i : iter->second.pos) {
+                if (i - prev > reuse_pos - last_use) {
+                    last_use = prev;
+                    reuse_pos = i;
+                }
+                prev = i;
+            }
+            if (reuse_pos < last_use + 4) {
+                continue;
+            }
+
+            double copy_time = size / m_config.copy_bandwidth;
+            size_t max_overlap = m_config.max_overlap_oprs;
+
+            // the copy to host starts right after the var is produced
+            size_t out_end = last_use + 1;
+            while (out_end + 2 < reuse_pos && out_end - last_use < max_overlap &&
+                   time_between(producer + 1, out_end) < copy_time) {
+                ++out_end;
+            }
+            size_t in_start = reuse_pos - 2;
+            while (in_start > out_end + 1 &&
+                   reuse_pos - 1 - in_start < max_overlap &&
+                   time_between(in_start + 1, reuse_pos - 1) < copy_time) {
+                --in_start;
+            }
+            if (in_start <= out_end) {
+                continue;
+            }
+
+            Plan plan;
+            plan.var = var;
+            plan.out_end = out_end;
+            plan.in_start = in_start;
+            plan.reuse_pos = reuse_pos;
+            plan.size = size;
+            plan.stall =
+                    std::max(copy_time - time_between(producer + 1, out_end),
+                             0.0) +
+                    std::max(copy_time -
+                                     time_between(in_start + 1, reuse_pos - 1),
+                             0.0);
+            plan.benefit = size * time_between(out_end + 1, in_start);
+            candidates.push_back(plan);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Plan& a, const Plan& b) {
+                  if (a.benefit != b.benefit)
+                      return a.benefit > b.benefit;
+                  return a.size > b.size;
+              });
+
+    // the copy worker is busy for at most the whole execution time plus the
+    // allowed stall time
+    double seq_time = time_prefix.back(),
+           stall_limit = seq_time * m_config.max_stall_ratio;
+    double tot_stall = 0, tot_copy_time = 0;
+    size_t tot_size = 0;
+    std::vector<Plan> ret;
+    for (auto&& i : candidates) {
+        double copy_time = i.size * 2 / m_config.copy_bandwidth;
+        if (tot_stall + i.stall > stall_limit ||
+            tot_copy_time + copy_time > seq_time + stall_limit) {
+            continue;
+        }
+        tot_stall += i.stall;
+        tot_copy_time += copy_time;
+        tot_size += i.size;
+        ret.push_back(i);
+    }
+
+    if (!ret.empty()) {
+        mgb_log_debug(
+                "memory offload: %zu of %zu candidate vars chosen, "
+                "total size %.2fMiB, estimated stall %.3fms in %.3fms",
+                ret.size(), candidates.size(), tot_size / 1024.0 / 1024,
+                tot_stall * 1e3, seq_time * 1e3);
+    }
+    return ret;
+}
+
+void MemoryOffload::apply_plan(const cg::OprNodeArray& opr_seq,
+                               const std::vector<Plan>& plans,
+                               VarNodeArray& vars) {
+    ThinHashMap<size_t, std::vector<const Plan*>> reuse_pos2plan;
+    for (auto&& i : plans) {
+        reuse_pos2plan[i.reuse_pos].push_back(&i);
+    }
+
+    gopt::SubGraph subgraph{cg::to_symbol_var_array(vars)};
+    auto rewriter = subgraph.make_rewriter();
+
+    //! comp order dep to run after the opr at given position
+    auto trigger = [&](size_t pos) -> SymbolVar {
+        return rewriter.get_var(opr_seq[pos]->output(0));
+    };
+
+    //! original var -> prefetched var
+    ThinHashMap<VarNode*, VarNode*> prefetched;
+    for (size_t i = 0; i < opr_seq.size(); ++i) {
+        auto opr = opr_seq[i];
+        auto iter = reuse_pos2plan.find(i);
+        if (iter != reuse_pos2plan.end()) {
+            for (auto plan : iter->second) {
+                SymbolVar var = rewriter.get_var(plan->var);
+                auto&& recorder = m_var2recorder[plan->var];
+                if (recorder && recorder->compress() != m_config.compress) {
+                    recorder->release_host_buf();
+                    recorder.reset();
+                }
+                if (!recorder) {
+                    recorder = std::make_shared<OffloadVarRecorder>(
+                            var.node()->comp_node(), m_config.compress);
+                }
+                auto out = opr::OffloadOut::make(var, recorder);
+                auto out_done = opr::WaitOffloadOut::make(
+                        {var, out, trigger(plan->out_end)}, recorder);
+                auto in = opr::OffloadIn::make(
+                        {var, out_done, trigger(plan->in_start)}, recorder);
+                auto in_done = opr::WaitOffloadIn::make({in, trigger(i - 1)},
+                                                        recorder);
+                // run as soon as their deps are ready
+                for (auto j : {out, out_done, in, in_done}) {
+                    j.node()->owner_opr()->node_prop().attribute().priority =
+                            std::numeric_limits<int>::min();
+                }
+                prefetched[plan->var] = in_done.node();
+            }
+        }
+
+        bool replaced = false;
+        VarNodeArray new_inp;
+        for (auto inp : opr->input()) {
+            auto pf = prefetched.find(inp);
+            if (pf != prefetched.end()) {
+                new_inp.push_back(pf->second);
+                replaced = true;
+            } else {
+                new_inp.push_back(rewriter.get_var(inp));
+            }
+        }
+        if (replaced) {
+            auto new_opr = serialization::copy_opr_shallow(*opr, new_inp,
+                                                           opr->config());
+            for (size_t j = 0; j < opr->output().size(); ++j) {
+                rewriter.replace_var(opr->output(j), new_opr->output(j),
+                                     nullptr);
+            }
+        } else {
+            rewriter.auto_replace_outputs(opr);
+        }
+    }
+
+    for (auto&& i : vars) {
+        i = rewriter.get_var(i);
+    }
+    rewriter.apply_inplace();
+}
+
+void MemoryOffload::modify_dest_var_inplace(VarNodeArray& vars) {
+    mgb_throw_if(m_owner_graph->options().comp_node_seq_record_level,
+                 GraphError,
+                 "memory offload can not be used with "
+                 "comp_node_seq_record_level");
+    init_config();
+
+    // recorders are only used by the latest compiled function, which must
+    // finish before its host buffers can be released
+    if (auto seq = m_owner_graph->current_comp_seq()) {
+        seq->wait();
+    }
+
+    auto graph = static_cast<cg::ComputingGraphImpl*>(m_owner_graph);
+    cg::CompSeqExtraInfo extra_info;
+    auto opr_seq = *graph->topo_sorter().get_comp_seq(extra_info, vars);
+    graph->topo_sorter().restore_opr_prop();
+
+    auto plans = make_plan(opr_seq, vars);
+    ThinHashSet<VarNode*> planned_vars;
+    for (auto&& i : plans) {
+        planned_vars.insert(i.var);
+    }
+    for (auto&& i : m_var2recorder) {
+        if (!planned_vars.count(i.first)) {
+            i.second->release_host_buf();
+        }
+    }
+    if (!plans.empty()) {
+        apply_plan(opr_seq, plans, vars);
+    }
+}
+
+#endif  // MGB_ENABLE_MEMORY_OFFLOAD
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -0,0 +1,72 @@
+/**
+ * \file src/core/impl/graph/swap/memory_offload.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#pragma once
+
+#include "megbrain/graph.h"
+
+#if MGB_ENABLE_MEMORY_OFFLOAD
+namespace mgb {
+namespace swap {
+
+class OffloadVarRecorder;
+
+/*!
+ * \brief offload vars with long idle intervals to host memory asynchronously
+ *
+ * For each var, the longest interval between two adjacent uses in the opr
+ * seq is considered (for activations, it is usually the interval between
+ * forward and backward). The copy to host overlaps with the oprs after the
+ * var is produced, and the copy back starts several oprs before the next
+ * use, so memory of the var can be reused in between.
+ *
+ * Execution time of oprs is estimated from their computation and memory
+ * access; vars are chosen greedily by the product of size and the estimated
+ * duration in which their memory is freed, as long as the estimated time of
+ * copies that could not be overlapped with computing is within the limit.
+ *
+ * Recorders (and thus the offloading oprs) are kept for each var, so they are
+ * reused when the graph is compiled again; host buffers of vars that are not
+ * offloaded by the new opr seq are returned to the pool.
+ */
+class MemoryOffload {
+    using OperatorNodeBase = cg::OperatorNodeBase;
+    using Config = cg::ComputingGraph::Options::MemoryOffloadConfig;
+
+    struct Plan;
+
+    ComputingGraph* const m_owner_graph;
+    Config m_config;
+    ThinHashMap<VarNode*, std::shared_ptr<OffloadVarRecorder>> m_var2recorder;
+
+    void init_config();
+
+    //! estimated execution time of oprs in seconds
+    std::vector<double> estimate_opr_time(const cg::OprNodeArray& opr_seq);
+
+    std::vector<Plan> make_plan(const cg::OprNodeArray& opr_seq,
+                                const VarNodeArray& dest_vars);
+
+    void apply_plan(const cg::OprNodeArray& opr_seq,
+                    const std::vector<Plan>& plans, VarNodeArray& vars);
+
+public:
+    MemoryOffload(ComputingGraph* graph);
+    ~MemoryOffload();
+
+    //! Entrance
+    void modify_dest_var_inplace(VarNodeArray& vars);
+};
+
+}  // namespace swap
+}  // namespace mgb
+#endif  // MGB_ENABLE_MEMORY_OFFLOAD
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
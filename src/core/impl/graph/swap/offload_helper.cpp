@@ -0,0 +1,304 @@
+/**
+ * \file src/core/impl/graph/swap/offload_helper.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "./offload_helper.h"
+#include "megbrain/comp_node_env.h"
+#include "megbrain/utils/arith_helper.h"
+
+#include <cstring>
+
+#if MGB_ENABLE_MEMORY_OFFLOAD
+
+using namespace mgb;
+using namespace swap;
+
+namespace {
+
+/*!
+ * Zero-value compression: activations (especially after ReLU) usually contain
+ * many zeros, so a value is stored as a bitmask of its nonzero 32-bit words,
+ * followed by the nonzero words and the trailing bytes.
+ */
+size_t zvc_bound(size_t size) {
+    return size + divup<size_t>(size / 4, 8);
+}
+
+//! \p dest must have zvc_bound(size) bytes; return compressed size
+size_t zvc_compress(const dt_byte* src, size_t size, dt_byte* dest) {
+    size_t nr_word = size / 4, mask_size = divup<size_t>(nr_word, 8);
+    auto mask = reinterpret_cast<uint8_t*>(dest);
+    dt_byte* data = dest + mask_size;
+    memset(mask, 0, mask_size);
+    for (size_t i = 0; i < nr_word; ++i) {
+        uint32_t word;
+        memcpy(&word, src + i * 4, 4);
+        if (word) {
+            mask[i / 8] |= 1 << (i % 8);
+            memcpy(data, &word, 4);
+            data += 4;
+        }
+    }
+    size_t tail = size - nr_word * 4;
+    memcpy(data, src + nr_word * 4, tail);
+    return data + tail - dest;
+}
+
+void zvc_decompress(const dt_byte* src, size_t size, dt_byte* dest) {
+    size_t nr_word = size / 4, mask_size = divup<size_t>(nr_word, 8);
+    auto mask = reinterpret_cast<const uint8_t*>(src);
+    const dt_byte* data = src + mask_size;
+    for (size_t i = 0; i < nr_word; ++i) {
+        if (mask[i / 8] & (1 << (i % 8))) {
+            memcpy(dest + i * 4, data, 4);
+            data += 4;
+        } else {
+            memset(dest + i * 4, 0, 4);
+        }
+    }
+    memcpy(dest + nr_word * 4, data, size - nr_word * 4);
+}
+
+}  // anonymous namespace
+
+/* ===================== OffloadCopyWorker ===================== */
+
+MGB_TYPEINFO_OBJ_IMPL(OffloadCopyWorker);
+
+OffloadCopyWorker& OffloadCopyWorker::inst(CompNode cn) {
+    auto maker = [cn]() { return std::make_shared<OffloadCopyWorker>(cn); };
+    return CompNodeEnv::from_comp_node(cn).get_user_data<OffloadCopyWorker>(
+            maker);
+}
+
+void OffloadCopyWorker::start() {
+    MGB_LOCK_GUARD(m_mtx);
+    if ((++m_nr_start) == 1) {
+        m_pool.start(1);
+    }
+}
+
+void OffloadCopyWorker::stop() {
+    MGB_LOCK_GUARD(m_mtx);
+    mgb_assert(m_nr_start);
+    if ((--m_nr_start) == 0) {
+        m_pool.stop();
+    }
+}
+
+HostTensorStorage OffloadCopyWorker::alloc_host(size_t size) {
+    {
+        MGB_LOCK_GUARD(m_mtx);
+        auto iter = m_free_bufs.lower_bound(size);
+        // do not occupy a buffer much larger than needed
+        if (iter != m_free_bufs.end() && iter->first <= size * 2) {
+            auto ret = std::move(iter->second);
+            m_free_bufs.erase(iter);
+            return ret;
+        }
+    }
+    {
+        MGB_LOCK_GUARD(m_mtx);
+        ++m_nr_host_alloc;
+    }
+    HostTensorStorage ret{m_comp_node};
+    ret.ensure_size(size);
+    // apply lazy allocation here rather than on the worker thread
+    ret.ptr();
+    return ret;
+}
+
+void OffloadCopyWorker::free_host(HostTensorStorage buf) {
+    MGB_LOCK_GUARD(m_mtx);
+    auto size = buf.size();
+    m_free_bufs.emplace(size, std::move(buf));
+}
+
+/* ===================== OffloadVarRecorder ===================== */
+
+OffloadVarRecorder::OffloadVarRecorder(CompNode comp_node, bool compress)
+        : m_worker{OffloadCopyWorker::inst(comp_node)},
+          m_comp_node{comp_node},
+          m_compress{compress} {
+    auto type = comp_node.device_type();
+    m_host_accessible = type == CompNode::DeviceType::CPU ||
+                        type == CompNode::DeviceType::MULTITHREAD;
+    if (m_host_accessible) {
+        m_worker.start();
+    } else {
+        m_copy_cn = comp_node.change_stream(CompNode::Stream::LOOP_SWAP);
+        m_ev_offload = comp_node.create_event();
+        m_ev_prefetch = comp_node.create_event();
+        m_ev_offload_done = m_copy_cn.create_event();
+        m_ev_prefetch_done = m_copy_cn.create_event();
+    }
+}
+
+OffloadVarRecorder::~OffloadVarRecorder() {
+    release_host_buf();
+    if (m_host_accessible) {
+        m_worker.stop();
+    }
+}
+
+void OffloadVarRecorder::release_host_buf() {
+    if (m_host_accessible) {
+        m_comp_node.sync();
+        // tasks may be unfinished if execution is aborted, so their
+        // exceptions are not rethrown here
+        for (auto task : {&m_offload_task, &m_prefetch_task}) {
+            if (task->valid()) {
+                task->wait();
+                *task = {};
+            }
+        }
+    } else {
+        m_copy_cn.sync();
+    }
+    m_contig_val = DeviceTensorND{};
+    if (m_host_buf.size()) {
+        m_worker.free_host(std::move(m_host_buf));
+        m_host_buf = {};
+    }
+    m_size = m_stored_size = 0;
+    m_compressed = false;
+}
+
+void OffloadVarRecorder::ensure_host_buf(size_t size) {
+    if (m_host_buf.size() < size) {
+        if (m_host_buf.size()) {
+            m_worker.free_host(std::move(m_host_buf));
+        }
+        m_host_buf = m_worker.alloc_host(size);
+    }
+}
+
+void OffloadVarRecorder::wait_tasks() {
+    for (auto task : {&m_offload_task, &m_prefetch_task}) {
+        if (task->valid()) {
+            task->get();
+        }
+    }
+}
+
+void OffloadVarRecorder::do_offload(const dt_byte* src, size_t size) {
+    auto dest = m_host_buf.ptr();
+    if (m_compress) {
+        auto stored = zvc_compress(src, size, dest);
+        if (stored < size) {
+            m_compressed = true;
+            m_stored_size = stored;
+            return;
+        }
+    }
+    m_compressed = false;
+    m_stored_size = size;
+    memcpy(dest, src, size);
+}
+
+void OffloadVarRecorder::do_prefetch(dt_byte* dest, size_t size) {
+    const dt_byte* src = m_host_buf.ptr();
+    if (m_compressed) {
+        zvc_decompress(src, size, dest);
+    } else {
+        memcpy(dest, src, size);
+    }
+}
+
+void OffloadVarRecorder::offload(const DeviceTensorND& val) {
+    const DeviceTensorND* src = &val;
+    if (!val.layout().is_contiguous()) {
+        m_contig_val.copy_from(val);
+        src = &m_contig_val;
+    }
+    size_t size = src->dtype().size(src->shape().total_nr_elems());
+    const dt_byte* ptr = src->raw_ptr();
+    m_size = size;
+
+    if (!m_host_accessible) {
+        // the host buffer is only accessed by the copy stream, so it can be
+        // replaced without waiting for previous copies
+        ensure_host_buf(size);
+        m_ev_offload->record();
+        m_copy_cn.device_wait_event(*m_ev_offload);
+        m_copy_cn.copy_to_host(m_host_buf.ptr(), ptr, size);
+        m_ev_offload_done->record();
+        m_compressed = false;
+        m_stored_size = size;
+        return;
+    }
+
+    // the task is launched after all previously dispatched computing on the
+    // comp node finishes, so it does not have to wait for the value
+    m_comp_node.add_callback([this, ptr, size]() {
+        wait_tasks();
+        ensure_host_buf(m_compress ? zvc_bound(size) : size);
+        m_offload_task =
+                m_worker.launch([this, ptr, size]() { do_offload(ptr, size); });
+    });
+}
+
+void OffloadVarRecorder::wait_offload() {
+    if (!m_host_accessible) {
+        m_comp_node.device_wait_event(*m_ev_offload_done);
+        m_contig_val = DeviceTensorND{};
+        return;
+    }
+    // the contiguous copy is released after the copy task finishes
+    auto contig_val = std::move(m_contig_val);
+    m_contig_val = DeviceTensorND{};
+    m_comp_node.add_callback([this, contig_val]() mutable {
+        if (m_offload_task.valid()) {
+            m_offload_task.get();
+        }
+        contig_val = DeviceTensorND{};
+    });
+}
+
+void OffloadVarRecorder::prefetch(const DeviceTensorND& dest) {
+    size_t size = m_size;
+    mgb_assert(dest.layout().is_contiguous() &&
+                       dest.dtype().size(dest.shape().total_nr_elems()) ==
+                               size,
+               "invalid prefetch dest: %s, expected %zu bytes",
+               dest.layout().to_string().c_str(), size);
+    dt_byte* ptr = dest.raw_ptr();
+
+    if (!m_host_accessible) {
+        // wait for previous readers of the memory of dest
+        m_ev_prefetch->record();
+        m_copy_cn.device_wait_event(*m_ev_prefetch);
+        m_copy_cn.copy_to_device(ptr, m_host_buf.ptr(), size);
+        m_ev_prefetch_done->record();
+        return;
+    }
+
+    m_comp_node.add_callback([this, ptr, size]() {
+        wait_tasks();
+        m_prefetch_task = m_worker.launch(
+                [this, ptr, size]() { do_prefetch(ptr, size); });
+    });
+}
+
+void OffloadVarRecorder::wait_prefetch() {
+    if (!m_host_accessible) {
+        m_comp_node.device_wait_event(*m_ev_prefetch_done);
+        return;
+    }
+    m_comp_node.add_callback([this]() {
+        if (m_prefetch_task.valid()) {
+            m_prefetch_task.get();
+        }
+    });
+}
+
+#endif  // MGB_ENABLE_MEMORY_OFFLOAD
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
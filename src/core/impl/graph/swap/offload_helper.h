@@ -0,0 +1,165 @@
+/**
+ * \file src/core/impl/graph/swap/offload_helper.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include "megbrain/comp_node.h"
+#include "megbrain/graph.h"
+#include "megbrain/utils/async_worker.h"
+
+#include <map>
+
+#if MGB_ENABLE_MEMORY_OFFLOAD
+namespace mgb {
+namespace swap {
+
+/* ===================== OffloadCopyWorker ===================== */
+/*!
+ * \brief the thread to copy offloaded values of a host-accessible comp node,
+ *      and the pool of host buffers holding offloaded values of a comp node
+ *
+ * Host buffers are allocated by the comp node (so they are page-locked if
+ * supported), and are kept in the pool after being released by their
+ * recorders, so they can be reused by other recorders.
+ */
+class OffloadCopyWorker final : public UserDataContainer::UserData {
+    MGB_TYPEINFO_OBJ_DECL;
+
+    const CompNode m_comp_node;
+    size_t m_nr_start = 0;
+    FutureThreadPool<void> m_pool;
+
+    std::mutex m_mtx;
+    std::multimap<size_t, HostTensorStorage> m_free_bufs;
+    size_t m_nr_host_alloc = 0;
+
+public:
+    using Future = FutureThreadPool<void>::Future;
+
+    OffloadCopyWorker(CompNode cn)
+            : m_comp_node{cn}, m_pool{"Offload" + cn.to_string()} {}
+
+    static OffloadCopyWorker& inst(CompNode cn);
+
+    void start();
+
+    void stop();
+
+    template <typename Func>
+    Future launch(Func&& func) {
+        return m_pool.launch(std::forward<Func>(func));
+    }
+
+    //! get a host buffer with at least given size from the pool
+    HostTensorStorage alloc_host(size_t size);
+
+    //! return a buffer obtained from alloc_host() to the pool
+    void free_host(HostTensorStorage buf);
+
+    //! number of host buffers allocated from the comp node, for testing
+    size_t nr_host_alloc() {
+        MGB_LOCK_GUARD(m_mtx);
+        return m_nr_host_alloc;
+    }
+};
+
+/* ===================== OffloadVarRecorder ===================== */
+/*!
+ * \brief hold the offloaded value of a var in host memory
+ *
+ * All the waits are device-side dependencies, so the dispatch thread is never
+ * blocked by the copies:
+ *
+ *  - if device memory is host accessible (CPU), offload() and prefetch()
+ *    dispatch into the comp node queue the launching of copy tasks on the
+ *    OffloadCopyWorker, and wait_offload() and wait_prefetch() dispatch the
+ *    waiting for these tasks;
+ *  - otherwise the values are copied by the copy stream of the comp node, and
+ *    the streams wait for each other by events. Compression is not applied in
+ *    this case, because the copy stream can not wait for the host.
+ */
+class OffloadVarRecorder final : public NonCopyableObj {
+    OffloadCopyWorker& m_worker;
+    CompNode m_comp_node;
+    const bool m_compress;
+
+    //! whether device memory can be directly accessed by the host
+    bool m_host_accessible;
+
+    //! comp node for copying if device memory is not host accessible
+    CompNode m_copy_cn;
+
+    //! events on m_comp_node to start copies, and on m_copy_cn to finish
+    //! copies; only used if device memory is not host accessible
+    std::unique_ptr<CompNode::Event> m_ev_offload, m_ev_prefetch,
+            m_ev_offload_done, m_ev_prefetch_done;
+
+    //! copy tasks; only accessed in the comp node queue if device memory is
+    //! host accessible
+    OffloadCopyWorker::Future m_offload_task, m_prefetch_task;
+
+    //! contiguous copy of the value if its layout is not contiguous
+    DeviceTensorND m_contig_val;
+
+    //! buffer holding the value; if device memory is host accessible, it is
+    //! only accessed in the comp node queue and on the worker thread
+    HostTensorStorage m_host_buf;
+    //! size of the value, and size of the data stored in m_host_buf
+    size_t m_size = 0, m_stored_size = 0;
+    bool m_compressed = false;
+
+    //! get a host buffer with at least given size for the next offload
+    void ensure_host_buf(size_t size);
+
+    //! wait for the copy tasks; called in the comp node queue
+    void wait_tasks();
+
+    //! copy size bytes from device to m_host_buf; run on worker thread
+    void do_offload(const dt_byte* src, size_t size);
+
+    //! copy size bytes from m_host_buf to device; run on worker thread
+    void do_prefetch(dt_byte* dest, size_t size);
+
+public:
+    OffloadVarRecorder(CompNode comp_node, bool compress);
+
+    ~OffloadVarRecorder();
+
+    void offload(const DeviceTensorND& val);
+
+    void wait_offload();
+
+    void prefetch(const DeviceTensorND& dest);
+
+    void wait_prefetch();
+
+    /*!
+     * \brief wait for unfinished copies and return the host buffer to the
+     *      pool
+     *
+     * The recorder can still be used afterwards, and the buffer would be
+     * allocated again by the next offload().
+     */
+    void release_host_buf();
+
+    bool compress() const { return m_compress; }
+
+    //! number of bytes of the last offloaded value in host memory; only
+    //! valid after the computing finishes
+    size_t stored_size() const { return m_stored_size; }
+};
+
+}  // namespace swap
+}  // namespace mgb
+
+#endif  // MGB_ENABLE_MEMORY_OFFLOAD
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -0,0 +1,164 @@
+/**
+ * \file src/core/impl/graph/swap/offload_opr.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "./offload_opr.h"
+
+#if MGB_ENABLE_MEMORY_OFFLOAD
+using namespace mgb;
+using namespace swap::opr;
+
+/* ===================== OffloadOut ===================== */
+
+MGB_DYN_TYPE_OBJ_FINAL_IMPL(OffloadOut);
+OffloadOut::OffloadOut(VarNode* inp, const RecorderPtr& recorder,
+                       const OperatorNodeConfig& config)
+        : Super{inp->owner_graph(), config, "offload-out", {inp}},
+          m_recorder{recorder} {
+    add_input({inp});
+    add_output(None);
+    add_equivalence_component<ScalarHash<void*>>(m_recorder.get());
+}
+
+void OffloadOut::scn_do_execute() {
+    m_recorder->offload(input(0)->dev_tensor());
+}
+
+void OffloadOut::init_output_static_infer_desc() {
+    using namespace cg::static_infer;
+    owner_graph()->static_infer_manager().register_shape_infer(
+            output(0), ShapeInferDesc::make_const({1}));
+}
+
+SymbolVar OffloadOut::make(SymbolVar inp, const RecorderPtr& recorder,
+                           const OperatorNodeConfig& config) {
+    return inp.insert_single_output_opr<OffloadOut>(inp.node(), recorder,
+                                                    config);
+}
+
+/* ===================== WaitOffloadOut ===================== */
+
+MGB_DYN_TYPE_OBJ_FINAL_IMPL(WaitOffloadOut);
+WaitOffloadOut::WaitOffloadOut(const VarNodeArray& inputs,
+                               const RecorderPtr& recorder,
+                               const OperatorNodeConfig& config)
+        : Super{inputs[0]->owner_graph(), config, "wait-offload-out", inputs},
+          m_recorder{recorder} {
+    mgb_assert(inputs.size() == 3);
+    for (auto x : inputs)
+        add_input({x});
+    add_output(None);
+    add_equivalence_component<ScalarHash<void*>>(m_recorder.get());
+}
+
+void WaitOffloadOut::scn_do_execute() {
+    m_recorder->wait_offload();
+}
+
+void WaitOffloadOut::init_output_static_infer_desc() {
+    using namespace cg::static_infer;
+    owner_graph()->static_infer_manager().register_shape_infer(
+            output(0), ShapeInferDesc::make_const({1}));
+}
+
+cg::OperatorNodeBase::NodeProp* WaitOffloadOut::do_make_node_prop() const {
+    auto prop = Super::do_make_node_prop();
+    // the offloaded var must be kept until the copy finishes
+    using DT = NodeProp::DepType;
+    prop->reset_dep_type(input(), {DT::DEV_VALUE, DT::DEV_COMP_ORDER,
+                                   DT::DEV_COMP_ORDER});
+    return prop;
+}
+
+SymbolVar WaitOffloadOut::make(const SymbolVarArray& inputs,
+                               const RecorderPtr& recorder,
+                               const OperatorNodeConfig& config) {
+    return inputs[0].insert_single_output_opr<WaitOffloadOut>(
+            to_var_node_array(inputs), recorder, config);
+}
+
+/* ===================== OffloadIn ===================== */
+
+MGB_DYN_TYPE_OBJ_FINAL_IMPL(OffloadIn);
+OffloadIn::OffloadIn(const VarNodeArray& inputs, const RecorderPtr& recorder,
+                     const OperatorNodeConfig& config)
+        : Super{inputs[0]->owner_graph(), config, "offload-in", inputs},
+          m_recorder{recorder} {
+    mgb_assert(inputs.size() == 3);
+    for (auto x : inputs)
+        add_input({x});
+    add_output(None)->dtype(inputs[0]->dtype());
+    add_equivalence_component<ScalarHash<void*>>(m_recorder.get());
+}
+
+void OffloadIn::scn_do_execute() {
+    m_recorder->prefetch(output(0)->dev_tensor());
+}
+
+void OffloadIn::init_output_static_infer_desc() {
+    using namespace cg::static_infer;
+    owner_graph()->static_infer_manager().register_shape_infer(
+            output(0), ShapeInferDesc::make_identity(input(0)));
+}
+
+cg::OperatorNodeBase::NodeProp* OffloadIn::do_make_node_prop() const {
+    auto prop = Super::do_make_node_prop();
+    // the value of the offloaded var is not needed, so its memory can be
+    // reused before this opr
+    using DT = NodeProp::DepType;
+    prop->reset_dep_type(input(),
+                         {DT::SHAPE, DT::DEV_COMP_ORDER, DT::DEV_COMP_ORDER});
+    return prop;
+}
+
+SymbolVar OffloadIn::make(const SymbolVarArray& inputs,
+                          const RecorderPtr& recorder,
+                          const OperatorNodeConfig& config) {
+    return inputs[0].insert_single_output_opr<OffloadIn>(
+            to_var_node_array(inputs), recorder, config);
+}
+
+/* ===================== WaitOffloadIn ===================== */
+
+MGB_DYN_TYPE_OBJ_FINAL_IMPL(WaitOffloadIn);
+WaitOffloadIn::WaitOffloadIn(const VarNodeArray& inputs,
+                             const RecorderPtr& recorder,
+                             const OperatorNodeConfig& config)
+        : Super{inputs[0]->owner_graph(), config, "wait-offload-in", inputs},
+          m_recorder{recorder} {
+    mgb_assert(inputs.size() == 2);
+    for (auto x : inputs)
+        add_input({x});
+    add_output(None)->dtype(inputs[0]->dtype());
+    add_equivalence_component<ScalarHash<void*>>(m_recorder.get());
+}
+
+void WaitOffloadIn::mixin_scn_do_execute(OperatorNodeBase& opr) {
+    m_recorder->wait_prefetch();
+    Super::mixin_scn_do_execute(opr);
+}
+
+cg::OperatorNodeBase::NodeProp* WaitOffloadIn::do_make_node_prop() const {
+    auto prop = Super::do_make_node_prop();
+    using DT = NodeProp::DepType;
+    prop->reset_dep_type(input(), {DT::DEV_VALUE, DT::DEV_COMP_ORDER});
+    return prop;
+}
+
+SymbolVar WaitOffloadIn::make(const SymbolVarArray& inputs,
+                              const RecorderPtr& recorder,
+                              const OperatorNodeConfig& config) {
+    return inputs[0].insert_single_output_opr<WaitOffloadIn>(
+            to_var_node_array(inputs), recorder, config);
+}
+
+#endif  // MGB_ENABLE_MEMORY_OFFLOAD
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
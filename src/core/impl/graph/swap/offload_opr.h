@@ -0,0 +1,114 @@
+/**
+ * \file src/core/impl/graph/swap/offload_opr.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include "./offload_helper.h"
+
+#include "megbrain/graph.h"
+#include "megbrain/opr/internal/identical_fwd.h"
+
+#if MGB_ENABLE_MEMORY_OFFLOAD
+
+namespace mgb {
+namespace swap {
+namespace opr {
+
+/*!
+ * The offloaded var x is replaced by the following oprs for its readers after
+ * a long interval:
+ *
+ *      x --> OffloadOut --> WaitOffloadOut --> OffloadIn --> WaitOffloadIn
+ *      |                        ^   ^              ^             ^
+ *      +------------------------+   |              |             |
+ *                       trigger ----+    trigger --+   trigger --+
+ *
+ * OffloadOut starts copying x to host after x is produced, and WaitOffloadOut
+ * (the last reader of x) waits for the copy, so the memory of x can be reused
+ * afterwards. OffloadIn allocates memory and starts copying the value back,
+ * and WaitOffloadIn waits for the copy before the original readers. Positions
+ * of the waiting oprs and OffloadIn in the opr seq are controlled by the
+ * trigger vars, which are comp order deps. The waits are dependencies of the
+ * comp node (see OffloadVarRecorder), so they do not block the dispatch
+ * thread.
+ */
+
+using RecorderPtr = std::shared_ptr<OffloadVarRecorder>;
+
+MGB_DEFINE_OPR_CLASS(OffloadOut, cg::SingleCNOperatorNodeBase) // {
+public:
+    OffloadOut(VarNode* inp, const RecorderPtr& recorder,
+               const OperatorNodeConfig& config);
+    static SymbolVar make(SymbolVar inp, const RecorderPtr& recorder,
+                          const OperatorNodeConfig& config = {});
+
+    const RecorderPtr& recorder() const { return m_recorder; }
+
+private:
+    RecorderPtr m_recorder;
+    void scn_do_execute() override;
+    void init_output_static_infer_desc() override;
+};
+
+//! inputs: offloaded var, OffloadOut output, trigger
+MGB_DEFINE_OPR_CLASS(WaitOffloadOut, cg::SingleCNOperatorNodeBase) // {
+public:
+    WaitOffloadOut(const VarNodeArray& inputs, const RecorderPtr& recorder,
+                   const OperatorNodeConfig& config);
+    static SymbolVar make(const SymbolVarArray& inputs,
+                          const RecorderPtr& recorder,
+                          const OperatorNodeConfig& config = {});
+
+private:
+    RecorderPtr m_recorder;
+    void scn_do_execute() override;
+    void init_output_static_infer_desc() override;
+    NodeProp* do_make_node_prop() const override;
+};
+
+//! inputs: offloaded var (for its shape), WaitOffloadOut output, trigger
+MGB_DEFINE_OPR_CLASS(OffloadIn, cg::SingleCNOperatorNodeBase) // {
+public:
+    OffloadIn(const VarNodeArray& inputs, const RecorderPtr& recorder,
+              const OperatorNodeConfig& config);
+    static SymbolVar make(const SymbolVarArray& inputs,
+                          const RecorderPtr& recorder,
+                          const OperatorNodeConfig& config = {});
+
+private:
+    RecorderPtr m_recorder;
+    void scn_do_execute() override;
+    void init_output_static_infer_desc() override;
+    NodeProp* do_make_node_prop() const override;
+};
+
+//! inputs: OffloadIn output, trigger; input(0) is forwarded to output
+MGB_DEFINE_OPR_CLASS(WaitOffloadIn, mgb::opr::intl::ForwardInputToOutput) // {
+public:
+    WaitOffloadIn(const VarNodeArray& inputs, const RecorderPtr& recorder,
+                  const OperatorNodeConfig& config);
+    static SymbolVar make(const SymbolVarArray& inputs,
+                          const RecorderPtr& recorder,
+                          const OperatorNodeConfig& config = {});
+
+private:
+    RecorderPtr m_recorder;
+    void mixin_scn_do_execute(OperatorNodeBase& opr) override;
+    NodeProp* do_make_node_prop() const override;
+};
+
+}  // namespace opr
+}  // namespace swap
+}  // namespace mgb
+
+#endif  // MGB_ENABLE_MEMORY_OFFLOAD
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
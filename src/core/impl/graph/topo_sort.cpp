@@ -454,6 +454,71 @@ const OprNodeArray* TopoSorter::get_comp_seq(CompSeqExtraInfo& extra_info,
     return &m_seq;
 }
 
+namespace {
+void copy_var2recvinfo(CompSeqExtraInfo& dst, const CompSeqExtraInfo& src) {
+    // ThinHashMap is not copyable
+    dst.var2recvinfo.clear();
+    for (auto&& i : src.var2recvinfo)
+        dst.var2recvinfo[i.first] = i.second;
+}
+}  // anonymous namespace
+
+const OprNodeArray* TopoSorter::get_comp_seq_cached(
+        CompSeqExtraInfo& extra_info, const VarNodeArray& dest,
+        size_t cache_size) {
+    if (!cache_size || m_priority_remapper) {
+        return get_comp_seq(extra_info, dest);
+    }
+    mgb_assert(m_modified_dep_map_log.empty(), "restore_opr_prop() not called");
+
+    auto priority_unchanged = [](const CachedSeq& cached) {
+        for (size_t i = 0; i < cached.seq.size(); ++i) {
+            if (cached.seq[i]->node_prop().attribute().priority !=
+                cached.priority[i]) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    for (auto iter = m_seq_cache.begin(); iter != m_seq_cache.end(); ++iter) {
+        if (iter->dest != dest)
+            continue;
+        if (!priority_unchanged(*iter)) {
+            m_seq_cache.erase(iter);
+            break;
+        }
+        ++m_seq_cache_nr_hit;
+        m_seq_cache.splice(m_seq_cache.begin(), m_seq_cache, iter);
+        auto&& cached = m_seq_cache.front();
+        m_seq = cached.seq;
+        copy_var2recvinfo(extra_info, cached.extra_info);
+        extra_info.infer_dest = cached.extra_info.infer_dest;
+        for (auto&& i : cached.extra_dep)
+            add_extra_comp_order_dep(i.first, i.second);
+        return &m_seq;
+    }
+
+    ++m_seq_cache_nr_miss;
+    get_comp_seq(extra_info, dest);
+
+    CachedSeq cached;
+    cached.dest = dest;
+    cached.seq = m_seq;
+    cached.priority.reserve(m_seq.size());
+    for (auto i : m_seq)
+        cached.priority.push_back(i->node_prop().attribute().priority);
+    copy_var2recvinfo(cached.extra_info, extra_info);
+    cached.extra_info.infer_dest = extra_info.infer_dest;
+    cached.extra_dep.reserve(m_modified_dep_map_log.size());
+    for (auto&& i : m_modified_dep_map_log)
+        cached.extra_dep.emplace_back(std::get<0>(i), std::get<1>(i));
+    m_seq_cache.emplace_front(std::move(cached));
+    while (m_seq_cache.size() > cache_size)
+        m_seq_cache.pop_back();
+    return &m_seq;
+}
+
 class TopoSorter::BFSQueueElem {
     using OprTraitIter = State::OprTraitIter;
 
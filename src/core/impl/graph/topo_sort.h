@@ -15,6 +15,8 @@
 #include "megbrain/graph/cg.h"
 #include "megbrain/utils/shared_set.h"
 
+#include <list>
+
 namespace mgb {
 namespace cg {
 
@@ -35,6 +37,28 @@ public:
     const OprNodeArray* get_comp_seq(CompSeqExtraInfo& extra_info,
                                      const VarNodeArray& dest);
 
+    /*!
+     * \brief like get_comp_seq(), but reuse the result of a previous call
+     *      with the same dest vars
+     *
+     * A cached result is only reused if there is no priority remapper and
+     * opr priorities are unchanged. At most \p cache_size results are kept,
+     * and the least recently used one is dropped first.
+     *
+     * \param extra_info same as get_comp_seq(); its initial content must be
+     *      determined by \p dest, because it is overwritten on cache hit
+     */
+    const OprNodeArray* get_comp_seq_cached(CompSeqExtraInfo& extra_info,
+                                            const VarNodeArray& dest,
+                                            size_t cache_size);
+
+    //! number of get_comp_seq_cached() calls that reused a cached result
+    size_t seq_cache_nr_hit() const { return m_seq_cache_nr_hit; }
+
+    //! number of get_comp_seq_cached() calls with nonzero cache size that
+    //! computed a new result
+    size_t seq_cache_nr_miss() const { return m_seq_cache_nr_miss; }
+
     //! undo modifications on opr node props
     void restore_opr_prop();
 
@@ -73,6 +97,19 @@ private:
 
     PriorityRemapper m_priority_remapper;
 
+    //! a result of get_comp_seq() cached by get_comp_seq_cached()
+    struct CachedSeq {
+        VarNodeArray dest;
+        OprNodeArray seq;
+        //! priorities of oprs in seq when it is computed
+        std::vector<int> priority;
+        CompSeqExtraInfo extra_info;
+        //! (opr, var) pairs passed to add_extra_comp_order_dep()
+        std::vector<std::pair<OperatorNodeBase*, VarNode*>> extra_dep;
+    };
+    std::list<CachedSeq> m_seq_cache;
+    size_t m_seq_cache_nr_hit = 0, m_seq_cache_nr_miss = 0;
+
     /*!
      * \brief make final sequence satisfying topological order and
      *      used-defined priority; result is written to m_seq
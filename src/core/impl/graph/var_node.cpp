@@ -234,6 +234,12 @@ bool VarNode::set_fwd_in2out_readonly(
         ->var_node_mem_manager().fwd_in2out_readonly(input, sub, this);
 }
 
+bool VarNode::set_fwd_out2in_subtensor(
+        VarNode *input, const SubTensorSpec &sub) {
+    return static_cast<ComputingGraphImpl*>(owner_graph())
+        ->var_node_mem_manager().fwd_out2in_subtensor(this, sub, input);
+}
+
 VarNode& VarNode::set_fwd_in2out_writable(VarNode *input) {
     static_cast<ComputingGraphImpl*>(owner_graph())
         ->var_node_mem_manager().fwd_in2out_writable(input, this);
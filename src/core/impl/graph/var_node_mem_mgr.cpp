@@ -300,6 +300,7 @@ VarNodeMemManager::~VarNodeMemManager() noexcept = default;
 
 void VarNodeMemManager::VarNodeMemTrait::clear_opt_status() {
     readonly_src = nullptr;
+    out2in_owner = nullptr;
 }
 
 bool VarNodeMemManager::DynamicAllocOprInfo::check_if_mem_status_change() {
@@ -1065,6 +1066,57 @@ bool VarNodeMemManager::fwd_in2out_readonly(
     return true;
 }
 
+bool VarNodeMemManager::fwd_out2in_subtensor(
+        VarNode *src, const SubTensorSpec &sub, VarNode *dest) {
+    /*
+     * implemented like readonly forward in the reverse direction: dest (an
+     * input of src's owner opr) shares the chunk of src, and the chunk life
+     * begins when the first var in it is computed
+     */
+    assert_in_mem_opt_phase(
+            SeqMemOptimizer::Status::ALLOW_FWD_IN2OUT_READONLY);
+    mgb_assert(src != dest && dest->m_mem_plan.layout().eq_shape(sub.layout()));
+
+    if (!m_owner_graph->options().seq_opt.enable_mem_plan_opt)
+        return false;
+
+    if (src->comp_node() != dest->comp_node() ||
+        !m_sys_alloc_static_vars.count(src) ||
+        !m_sys_alloc_static_vars.count(dest) ||
+        !sub.layout().is_contiguous() ||
+        sub.offset_byte() % src->comp_node().get_mem_addr_alignment()) {
+        // kernels may assume aligned output, so unaligned slices are copied
+        return false;
+    }
+
+    auto &&src_spec = m_node_mem_trait.at(src),
+         &&dest_spec = m_node_mem_trait.at(dest);
+    if (src_spec.out2in_owner || src_spec.readonly_src ||
+        src_spec.seq_force_update_dest ||
+        dest_spec.out2in_owner || dest_spec.readonly_src ||
+        dest_spec.seq_force_update_dest || dest_spec.force_update_src ||
+        !dest_spec.check_layout(sub.layout())) {
+        return false;
+    }
+
+    auto &&dest_plan = dest->m_mem_plan, &&src_plan = src->m_mem_plan;
+    // dest must exclusively own a chunk to be allocated by the system; vars
+    // readonly forwarded from it earlier in the sequence would still refer to
+    // the old chunk
+    if (dest_plan.chunk().owner_var != dest ||
+        !dest_plan.chunk().mem_alloc_status.is_invalid() ||
+        dest_plan.next_readonly_fwd_reader() ||
+        src_plan.chunk().owner_var != src ||
+        !src_plan.chunk().mem_alloc_status.is_invalid() ||
+        dest->contain_flag(VarNode::Flag::NO_MEM_RECLAIM)) {
+        return false;
+    }
+
+    dest_spec.out2in_owner = src;
+    dest_plan.assign_for_forward(src_plan, sub);
+    return true;
+}
+
 void VarNodeMemManager::assert_in_mem_opt_phase(size_t status) {
     mgb_assert(m_seq_mem_opt.status() & status,
             "call mem opt function outside of mem opt phase; "
@@ -1107,6 +1159,12 @@ void VarNodeMemManager::fwd_in2out_writable(VarNode *src, VarNode *dest) {
     if (m_node_mem_trait.at(src).seq_force_update_dest)
         return;
 
+    // chunks shared by a sub tensor outlive the var, and the memory of a var
+    // computed into a sub tensor is already determined
+    if (m_node_mem_trait.at(src).out2in_owner ||
+        m_node_mem_trait.at(dest).out2in_owner)
+        return;
+
     mgb_assert(dest->m_mem_plan.layout().eq_shape(src->m_mem_plan.layout()));
     if (!m_owner_graph->options().seq_opt.enable_mem_plan_opt)
         return;
@@ -134,6 +134,13 @@ class VarNodeMemManager {
             VarNode *force_update_src = nullptr,
                     *seq_force_update_dest = nullptr;
 
+            /*!
+             * if non-null, memory of this var is a sub tensor of
+             * out2in_owner, set by VarNode::set_fwd_out2in_subtensor(); the
+             * memory chunk outlives this var, so it can not be overwritten
+             */
+            VarNode *out2in_owner = nullptr;
+
             LayoutConstraint layout_constraint;
 
             bool check_layout(const TensorLayout &layout) const;
@@ -192,6 +199,11 @@ class VarNodeMemManager {
             return m_seq_mem_opt.static_mem_usage();
         }
 
+        //! static memory plan cache on given comp node, for testing
+        const StaticMemPlanCache* static_mem_plan_cache(CompNode cn) const {
+            return m_seq_mem_opt.static_mem_plan_cache(cn);
+        }
+
         /*!
          * \brief allocate dynamic output var node memory for operator; should
          * be called before operator execution
@@ -278,6 +290,12 @@ class VarNodeMemManager {
         bool fwd_in2out_readonly(
                 VarNode *src, const SubTensorSpec &sub, VarNode *dest);
 
+        /*!
+         * \brief see VarNode::set_fwd_out2in_subtensor
+         */
+        bool fwd_out2in_subtensor(
+                VarNode *src, const SubTensorSpec &sub, VarNode *dest);
+
         /*!
          * \brief see VarNode::set_fwd_in2out_writable
          */
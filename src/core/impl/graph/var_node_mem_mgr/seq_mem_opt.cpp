@@ -192,15 +192,20 @@ bool SeqMemOptimizer::run_static_mem_alloc() {
                 auto insert_rst = chk2interval.insert({cur_chk, {}});
 
                 auto &&dest = insert_rst.first->second;
+                // vars computed into a sub tensor of a later var use the
+                // chunk of that var before its owner is computed
+                bool is_out2in = m_graph->var_node_mem_manager()
+                                         .get_var_node_mem_trait_at(i)
+                                         .out2in_owner;
                 if (insert_rst.second) {
                     dest.begin = idx;
                     dest.chunk = cur_chk;
                     dest.comp_node = i->comp_node();
-                    mgb_assert(cur_chk->owner_var == i);
+                    mgb_assert(cur_chk->owner_var == i || is_out2in);
                 } else {
-                    // forwarded from another var
-                    mgb_assert(i->comp_node() == dest.comp_node &&
-                               cur_chk->owner_var != i);
+                    // forwarded from another var, or the owner of a chunk
+                    // first used by its sub tensors
+                    mgb_assert(i->comp_node() == dest.comp_node);
                 }
 
                 if (i->contain_flag(VarNode::Flag::NO_MEM_RECLAIM)) {
@@ -296,19 +301,16 @@ bool SeqMemOptimizer::run_static_mem_alloc_on_comp_node(
 
     size_t size_ub = 0;
 
-    auto allocator = StaticMemAlloc::make(
-            StaticMemAlloc::AllocatorAlgo::PUSHDOWN);
-    allocator->alignment(comp_node.get_mem_addr_alignment());
-#if MGB_ENABLE_DEBUG_UTIL
-    allocator->dbg_key2varnode = [](StaticMemAlloc::UserKeyType key) {
-        return static_cast<const MemChunkLifeInterval*>(key)->chunk->owner_var;
-    };
-#endif
+    auto&& seq_opt = m_graph->options().seq_opt;
+    auto alignment = comp_node.get_mem_addr_alignment();
     ThinHashMap<MemAllocPlan::Chunk*, size_t> chunk2allocatorid;
+    struct OverwriteSpec {
+        size_t iid_src, iid_dest, offset;
+    };
+    std::vector<OverwriteSpec> overwrite_specs;
     for (auto &&chk: chunks) {
-        auto id = allocator->add(
-                chk.begin, chk.end, chk.chunk->size(), &chk);
-        auto ins_rst = chunk2allocatorid.emplace(chk.chunk, id);
+        auto ins_rst = chunk2allocatorid.emplace(chk.chunk,
+                                                 chunk2allocatorid.size());
         mgb_assert(ins_rst.second);
         size_ub += chk.chunk->size();
     }
@@ -320,9 +322,8 @@ bool SeqMemOptimizer::run_static_mem_alloc_on_comp_node(
         // ignore mem fwd specs that involve other chunks
         if (from_iter != chunk2allocatorid.end() &&
                 to_iter != chunk2allocatorid.end()) {
-
-            allocator->add_overwrite_spec(to_iter->second, from_iter->second,
-                    i.first->offset_in_chunk_byte());
+            overwrite_specs.push_back({to_iter->second, from_iter->second,
+                                       i.first->offset_in_chunk_byte()});
         }
     }
     {
@@ -330,9 +331,91 @@ bool SeqMemOptimizer::run_static_mem_alloc_on_comp_node(
         chunk2allocatorid.swap(v);
     }
 
-    allocator->solve();
-    size_t size = allocator->tot_alloc(),
-           size_lb = allocator->tot_alloc_lower_bound();
+    // round up chunk sizes to share plans between similar shapes
+    std::vector<size_t> plan_sizes(chunks.size());
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        auto size = chunks[i].chunk->size();
+        if (auto bucket = seq_opt.static_mem_plan_bucket) {
+            size = (size + bucket - 1) / bucket * bucket;
+        }
+        plan_sizes[i] = size;
+    }
+    if (seq_opt.static_mem_plan_bucket) {
+        // shrink overwriters until they fit in their dests again; sizes
+        // never go below the real sizes, which satisfy the constraints
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (auto&& i : overwrite_specs) {
+                auto limit = plan_sizes[i.iid_dest] - i.offset;
+                if (plan_sizes[i.iid_src] > limit) {
+                    plan_sizes[i.iid_src] = limit;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    StaticMemPlanCache* cache = nullptr;
+    if (seq_opt.static_mem_plan_cache_size) {
+        auto&& ptr = m_plan_cache[comp_node];
+        if (!ptr || ptr->capacity() != seq_opt.static_mem_plan_cache_size) {
+            ptr = std::make_unique<StaticMemPlanCache>(
+                    seq_opt.static_mem_plan_cache_size);
+        }
+        cache = ptr.get();
+    } else {
+        m_plan_cache.erase(comp_node);
+    }
+
+    StaticMemPlanCache::Key key{alignment};
+    const StaticMemPlanCache::Plan* cached_plan = nullptr;
+    if (cache) {
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            key.add_interval(chunks[i].begin, chunks[i].end, plan_sizes[i]);
+        }
+        for (auto&& i : overwrite_specs) {
+            key.add_overwrite_spec(i.iid_src, i.iid_dest, i.offset);
+        }
+        cached_plan = cache->get(key);
+    }
+
+    StaticMemPlanCache::Plan new_plan;
+    size_t size_lb = 0;
+    if (!cached_plan) {
+        auto allocator = StaticMemAlloc::make(
+                StaticMemAlloc::AllocatorAlgo::PUSHDOWN);
+        allocator->alignment(alignment);
+#if MGB_ENABLE_DEBUG_UTIL
+        allocator->dbg_key2varnode = [](StaticMemAlloc::UserKeyType key) {
+            return static_cast<const MemChunkLifeInterval*>(key)
+                    ->chunk->owner_var;
+        };
+#endif
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            auto id = allocator->add(chunks[i].begin, chunks[i].end,
+                                     plan_sizes[i], &chunks[i]);
+            mgb_assert(id == i);
+        }
+        for (auto&& i : overwrite_specs) {
+            allocator->add_overwrite_spec(i.iid_src, i.iid_dest, i.offset);
+        }
+        allocator->solve();
+        new_plan.tot_alloc = allocator->tot_alloc();
+        new_plan.offsets.resize(chunks.size());
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            new_plan.offsets[i] = allocator->get_start_addr(&chunks[i]);
+        }
+        size_lb = allocator->tot_alloc_lower_bound();
+        if (cache) {
+            cache->put(std::move(key), new_plan);
+        }
+    }
+    auto&& plan = cached_plan ? *cached_plan : new_plan;
+    size_t size = plan.tot_alloc;
+    if (cached_plan) {
+        // lower bound is not computed for cached plans
+        size_lb = size;
+    }
 
     static_mem_alloc_logger.push(comp_node, size, size_lb, size_ub);
 
@@ -342,9 +425,9 @@ bool SeqMemOptimizer::run_static_mem_alloc_on_comp_node(
 
     if (!should_realloc) {
         m_static_mem_usage.val()[comp_node] = size;
-        for (auto&& chk : chunks) {
-            chk.chunk->mem_alloc_status.set_static_offset(
-                    allocator->get_start_addr(&chk));
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            chunks[i].chunk->mem_alloc_status.set_static_offset(
+                    plan.offsets[i]);
         }
     }
 
@@ -12,6 +12,7 @@
 #pragma once
 
 #include "../impl_common.h"
+#include "./static_mem_plan_cache.h"
 
 namespace mgb {
 namespace cg {
@@ -48,6 +49,10 @@ class SeqMemOptimizer {
     std::vector<std::pair<MemAllocPlan*, MemAllocPlan*>>
         m_writable_fwd_mem_plans;
 
+    //! cached static allocation results on each comp node; they are kept
+    //! across reset_opr_seq() since the keys do not depend on the oprs
+    CompNode::UnorderedMap<std::unique_ptr<StaticMemPlanCache>> m_plan_cache;
+
     bool should_static_alloc_var(VarNode *var);
 
     bool in_sys_alloc(OperatorNodeBase *opr) const {
@@ -115,6 +120,17 @@ class SeqMemOptimizer {
             return m_static_mem_usage.val();
         }
 
+        /*!
+         * \brief get the static memory plan cache on given comp node
+         *
+         * \return the cache, or nullptr if static_mem_plan_cache_size is 0
+         *      or no static memory has been planned on the comp node
+         */
+        const StaticMemPlanCache* static_mem_plan_cache(CompNode cn) const {
+            auto iter = m_plan_cache.find(cn);
+            return iter == m_plan_cache.end() ? nullptr : iter->second.get();
+        }
+
         void optimize_mem_plan_dynamic(OperatorNodeBase *opr);
 
         /*!
@@ -0,0 +1,70 @@
+/**
+ * \file src/core/impl/graph/var_node_mem_mgr/static_mem_plan_cache.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "./static_mem_plan_cache.h"
+#include "megbrain/utils/hash.h"
+
+using namespace mgb;
+using namespace cg;
+
+/* ===================== StaticMemPlanCache::Key ===================== */
+
+StaticMemPlanCache::Key::Key(size_t alignment) {
+    update(alignment);
+}
+
+void StaticMemPlanCache::Key::update(size_t v) {
+    m_data.push_back(v);
+    m_hash = hash_pair_combine(m_hash, v);
+}
+
+void StaticMemPlanCache::Key::add_interval(size_t begin, size_t end,
+                                           size_t size) {
+    update(begin);
+    update(end);
+    update(size);
+}
+
+void StaticMemPlanCache::Key::add_overwrite_spec(size_t iid_src,
+                                                 size_t iid_dest,
+                                                 size_t offset) {
+    // use an impossible interval begin as separator
+    update(std::numeric_limits<size_t>::max());
+    update(iid_src);
+    update(iid_dest);
+    update(offset);
+}
+
+/* ===================== StaticMemPlanCache ===================== */
+
+const StaticMemPlanCache::Plan* StaticMemPlanCache::get(const Key& key) {
+    for (auto iter = m_entries.begin(); iter != m_entries.end(); ++iter) {
+        if (iter->first == key) {
+            m_entries.splice(m_entries.begin(), m_entries, iter);
+            ++m_nr_hit;
+            return &m_entries.front().second;
+        }
+    }
+    ++m_nr_miss;
+    return nullptr;
+}
+
+void StaticMemPlanCache::put(Key key, Plan plan) {
+    if (!m_capacity) {
+        return;
+    }
+    if (m_entries.size() == m_capacity) {
+        m_entries.pop_back();
+    }
+    m_entries.emplace_front(std::move(key), std::move(plan));
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
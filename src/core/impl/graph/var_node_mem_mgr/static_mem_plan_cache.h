@@ -0,0 +1,90 @@
+/**
+ * \file src/core/impl/graph/var_node_mem_mgr/static_mem_plan_cache.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include "megbrain/utils/metahelper.h"
+
+#include <list>
+#include <vector>
+
+namespace mgb {
+namespace cg {
+
+/*!
+ * \brief LRU cache of static memory allocation results
+ *
+ * The key consists of all the inputs to StaticMemAlloc (intervals, overwrite
+ * specs and alignment), so a cached result is exactly what the allocator would
+ * compute. Intervals are identified by their order of insertion.
+ */
+class StaticMemPlanCache final : public NonCopyableObj {
+public:
+    class Key {
+        std::vector<size_t> m_data;
+        size_t m_hash = 0;
+
+        void update(size_t v);
+
+    public:
+        explicit Key(size_t alignment);
+
+        //! add an interval; must be called in the same order as
+        //! StaticMemAlloc::add()
+        void add_interval(size_t begin, size_t end, size_t size);
+
+        void add_overwrite_spec(size_t iid_src, size_t iid_dest,
+                                size_t offset);
+
+        size_t hash() const { return m_hash; }
+
+        bool operator==(const Key& rhs) const {
+            return m_hash == rhs.m_hash && m_data == rhs.m_data;
+        }
+    };
+
+    struct Plan {
+        size_t tot_alloc;
+        //! start address of each interval, in the order of insertion
+        std::vector<size_t> offsets;
+    };
+
+    explicit StaticMemPlanCache(size_t capacity) : m_capacity{capacity} {}
+
+    /*!
+     * \brief get the plan for given key and mark it as most recently used
+     * \return the plan, or nullptr if not cached
+     */
+    const Plan* get(const Key& key);
+
+    //! insert a plan, and evict the least recently used one if full
+    void put(Key key, Plan plan);
+
+    size_t capacity() const { return m_capacity; }
+
+    size_t size() const { return m_entries.size(); }
+
+    size_t nr_hit() const { return m_nr_hit; }
+
+    size_t nr_miss() const { return m_nr_miss; }
+
+private:
+    const size_t m_capacity;
+    size_t m_nr_hit = 0, m_nr_miss = 0;
+    //! entries with the most recently used one at front; the capacity is
+    //! usually small, so linear search is sufficient
+    std::list<std::pair<Key, Plan>> m_entries;
+};
+
+}  // namespace cg
+}  // namespace mgb
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -39,6 +39,18 @@ void sys::set_cpu_affinity(const std::vector<int> &cpuset) {
     }
 }
 
+int sys::get_numa_node_of_cpu(int) {
+    return -1;
+}
+
+std::vector<std::vector<int>> sys::get_numa_node_cpus() {
+    std::vector<int> cpus(get_cpu_count());
+    for (size_t i = 0; i < cpus.size(); ++i) {
+        cpus[i] = i;
+    }
+    return {cpus};
+}
+
 std::pair<size_t, size_t> sys::get_ram_status_bytes() {
     MEMORYSTATUSEX statex;
     statex.dwLength = sizeof(statex);
@@ -59,6 +71,7 @@ std::pair<size_t, size_t> sys::get_ram_status_bytes() {
 #else
 #include <sys/sysinfo.h>
 #include <sched.h>
+#include <unistd.h>
 #endif
 
 void sys::set_cpu_affinity(const std::vector<int> &cpuset) {
@@ -81,6 +94,65 @@ void sys::set_cpu_affinity(const std::vector<int> &cpuset) {
 #endif
 }
 
+int sys::get_numa_node_of_cpu(int cpu) {
+#if defined(__linux__)
+    // the cpu directory in sysfs contains a link named nodeX for its node
+    for (int node = 0; node < 1024; ++node) {
+        auto path = ssprintf("/sys/devices/system/cpu/cpu%d/node%d", cpu, node);
+        if (!access(path.c_str(), F_OK)) {
+            return node;
+        }
+        if (access(ssprintf("/sys/devices/system/node/node%d", node).c_str(),
+                   F_OK)) {
+            break;
+        }
+    }
+#endif
+    return -1;
+}
+
+std::vector<std::vector<int>> sys::get_numa_node_cpus() {
+    std::vector<std::vector<int>> ret;
+#if defined(__linux__)
+    for (int node = 0;; ++node) {
+        FILE* fin = fopen(
+                ssprintf("/sys/devices/system/node/node%d/cpulist", node)
+                        .c_str(),
+                "r");
+        if (!fin) {
+            break;
+        }
+        // cpulist is like 0-15,32-47
+        ret.emplace_back();
+        int begin, end;
+        while (fscanf(fin, "%d", &begin) == 1) {
+            end = begin;
+            int c = fgetc(fin);
+            if (c == '-') {
+                if (fscanf(fin, "%d", &end) != 1) {
+                    break;
+                }
+                c = fgetc(fin);
+            }
+            for (int i = begin; i <= end; ++i) {
+                ret.back().push_back(i);
+            }
+            if (c != ',') {
+                break;
+            }
+        }
+        fclose(fin);
+    }
+#endif
+    if (ret.empty()) {
+        ret.emplace_back();
+        for (int i = 0; i < get_cpu_count(); ++i) {
+            ret.back().push_back(i);
+        }
+    }
+    return ret;
+}
+
 #ifdef MGB_EXTERN_API_MEMSTAT
 extern "C" {
     void mgb_extern_api_memstat(size_t *tot, size_t *free);
@@ -0,0 +1,298 @@
+/**
+ * \file src/core/impl/utils/mmap_persistent_cache.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "megbrain/utils/mmap_persistent_cache.h"
+#include "megbrain/utils/hash.h"
+
+#include <atomic>
+#include <cstring>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace mgb;
+
+namespace {
+constexpr uint64_t MAGIC = 0x4d47425043414348ull;
+constexpr uint32_t VERSION = 1;
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+              "atomic must be address-free to be put in shared memory");
+
+std::atomic<uint64_t>& as_atomic(uint64_t& v) {
+    return reinterpret_cast<std::atomic<uint64_t>&>(v);
+}
+
+constexpr uint64_t align8(uint64_t v) {
+    return (v + 7) & ~uint64_t(7);
+}
+}  // anonymous namespace
+
+//! file header; all fields except data_end and nr_entry are immutable after
+//! the file is initialized
+struct MmapPersistentCache::Header {
+    uint64_t magic;
+    uint32_t version, nr_bucket;
+    uint64_t data_begin, file_size;
+    uint64_t data_end, nr_entry;
+};
+
+/*!
+ * entry layout: EntryHeader, category, key, value, padding to 8 bytes; an
+ * entry is never modified after it is published to a bucket
+ */
+struct MmapPersistentCache::EntryHeader {
+    uint64_t next;  //!< offset of next entry in the bucket; 0 for end
+    uint64_t hash;
+    uint32_t category_size, key_size, value_size, reserved;
+
+    const uint8_t* category() const {
+        return reinterpret_cast<const uint8_t*>(this + 1);
+    }
+    const uint8_t* key() const { return category() + category_size; }
+    const uint8_t* value() const { return key() + key_size; }
+    uint64_t size() const {
+        return align8(sizeof(EntryHeader) + category_size + key_size +
+                      value_size);
+    }
+};
+
+#ifndef WIN32
+
+//! lock the whole file exclusively, to serialize writers across processes
+class MmapPersistentCache::FileLock : public NonCopyableObj {
+    int m_fd;
+
+public:
+    explicit FileLock(int fd) : m_fd{fd} {
+        int ret;
+        while ((ret = flock(m_fd, LOCK_EX)) && errno == EINTR)
+            ;
+        mgb_throw_if(ret, SystemError, "failed to lock cache file: %s",
+                     strerror(errno));
+    }
+    ~FileLock() { flock(m_fd, LOCK_UN); }
+};
+
+MmapPersistentCache::MmapPersistentCache(const std::string& path,
+                                         size_t capacity, size_t nr_bucket) {
+    m_fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    mgb_throw_if(m_fd < 0, SystemError, "failed to open cache file %s: %s",
+                 path.c_str(), strerror(errno));
+    MGB_TRY {
+        FileLock lock{m_fd};
+        struct stat st;
+        mgb_throw_if(fstat(m_fd, &st), SystemError, "fstat failed: %s",
+                     strerror(errno));
+        if (!st.st_size) {
+            init_file(capacity, nr_bucket);
+        } else {
+            m_size = st.st_size;
+            mgb_throw_if(m_size < sizeof(Header), MegBrainError,
+                         "bad persistent cache file %s", path.c_str());
+            auto ptr = mmap(nullptr, m_size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED, m_fd, 0);
+            mgb_throw_if(ptr == MAP_FAILED, SystemError, "mmap failed: %s",
+                         strerror(errno));
+            m_ptr = static_cast<uint8_t*>(ptr);
+        }
+        auto&& hdr = header();
+        mgb_throw_if(hdr.magic != MAGIC || hdr.version != VERSION ||
+                             hdr.file_size != m_size,
+                     MegBrainError,
+                     "bad persistent cache file %s: magic=%llx version=%u "
+                     "size=%zu",
+                     path.c_str(), static_cast<unsigned long long>(hdr.magic),
+                     hdr.version, m_size);
+    }
+    MGB_CATCH(..., {
+        if (m_ptr) {
+            munmap(m_ptr, m_size);
+        }
+        close(m_fd);
+        throw;
+    });
+}
+
+MmapPersistentCache::~MmapPersistentCache() {
+    munmap(m_ptr, m_size);
+    close(m_fd);
+}
+
+void MmapPersistentCache::init_file(size_t capacity, size_t nr_bucket) {
+    size_t nr_bucket_pow2 = 1;
+    while (nr_bucket_pow2 < nr_bucket)
+        nr_bucket_pow2 *= 2;
+    mgb_assert(nr_bucket_pow2 <= std::numeric_limits<uint32_t>::max());
+    auto data_begin = align8(sizeof(Header) + nr_bucket_pow2 * 8);
+    m_size = data_begin + align8(capacity);
+    // the file is sparse, and filled with zeros
+    mgb_throw_if(ftruncate(m_fd, m_size), SystemError,
+                 "failed to resize cache file: %s", strerror(errno));
+    auto ptr = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd,
+                    0);
+    mgb_throw_if(ptr == MAP_FAILED, SystemError, "mmap failed: %s",
+                 strerror(errno));
+    m_ptr = static_cast<uint8_t*>(ptr);
+    auto&& hdr = header();
+    hdr.version = VERSION;
+    hdr.nr_bucket = nr_bucket_pow2;
+    hdr.data_begin = data_begin;
+    hdr.file_size = m_size;
+    hdr.data_end = data_begin;
+    hdr.nr_entry = 0;
+    // magic is written last, so a file interrupted during initialization
+    // would be rejected
+    as_atomic(hdr.magic).store(MAGIC, std::memory_order_release);
+}
+
+#else  // WIN32
+
+class MmapPersistentCache::FileLock {
+public:
+    explicit FileLock(int) {}
+};
+
+MmapPersistentCache::MmapPersistentCache(const std::string&, size_t, size_t) {
+    mgb_throw(MegBrainError, "MmapPersistentCache is not supported on windows");
+}
+
+MmapPersistentCache::~MmapPersistentCache() = default;
+
+void MmapPersistentCache::init_file(size_t, size_t) {}
+
+#endif  // WIN32
+
+MmapPersistentCache::Header& MmapPersistentCache::header() const {
+    return *reinterpret_cast<Header*>(m_ptr);
+}
+
+uint64_t* MmapPersistentCache::buckets() const {
+    return reinterpret_cast<uint64_t*>(m_ptr + sizeof(Header));
+}
+
+uint64_t MmapPersistentCache::lookup(uint64_t hash,
+                                     const std::string& category,
+                                     const Blob& key) const {
+    auto&& hdr = header();
+    auto off = as_atomic(buckets()[hash & (hdr.nr_bucket - 1)])
+                       .load(std::memory_order_acquire);
+    while (off) {
+        mgb_assert(off >= hdr.data_begin &&
+                           off + sizeof(EntryHeader) <= hdr.file_size,
+                   "corrupted persistent cache file: bad offset %llu",
+                   static_cast<unsigned long long>(off));
+        auto entry = reinterpret_cast<const EntryHeader*>(m_ptr + off);
+        mgb_assert(off + entry->size() <= hdr.file_size,
+                   "corrupted persistent cache file: bad entry size");
+        if (entry->hash == hash && entry->category_size == category.size() &&
+            entry->key_size == key.size &&
+            !memcmp(entry->category(), category.data(), category.size()) &&
+            !memcmp(entry->key(), key.ptr, key.size)) {
+            return off;
+        }
+        off = entry->next;
+    }
+    return 0;
+}
+
+Maybe<PersistentCache::Blob> MmapPersistentCache::get(
+        const std::string& category, const Blob& key) {
+    auto hash = XXHash{}
+                        .update(category.data(), category.size())
+                        .update(key.ptr, key.size)
+                        .digest();
+    auto off = lookup(hash, category, key);
+    if (!off)
+        return None;
+    auto entry = reinterpret_cast<const EntryHeader*>(m_ptr + off);
+    return Blob{entry->value(), entry->value_size};
+}
+
+void MmapPersistentCache::put(const std::string& category, const Blob& key,
+                              const Blob& value) {
+    mgb_assert(category.size() <= std::numeric_limits<uint32_t>::max() &&
+               key.size <= std::numeric_limits<uint32_t>::max() &&
+               value.size <= std::numeric_limits<uint32_t>::max());
+    auto hash = XXHash{}
+                        .update(category.data(), category.size())
+                        .update(key.ptr, key.size)
+                        .digest();
+
+    MGB_LOCK_GUARD(m_mtx);
+    FileLock lock{m_fd};
+    auto&& hdr = header();
+
+    if (auto off = lookup(hash, category, key)) {
+        auto entry = reinterpret_cast<const EntryHeader*>(m_ptr + off);
+        if (entry->value_size == value.size &&
+            !memcmp(entry->value(), value.ptr, value.size)) {
+            // put by another process
+            return;
+        }
+    }
+
+    auto&& data_end = as_atomic(hdr.data_end);
+    auto begin = data_end.load(std::memory_order_relaxed);
+    auto size = align8(sizeof(EntryHeader) + category.size() + key.size +
+                       value.size);
+    if (begin + size > hdr.file_size) {
+        if (!m_full_warned) {
+            m_full_warned = true;
+            mgb_log_warn(
+                    "persistent cache file is full (%zu bytes used); new "
+                    "entries are dropped",
+                    static_cast<size_t>(begin - hdr.data_begin));
+        }
+        return;
+    }
+
+    auto&& bucket = as_atomic(buckets()[hash & (hdr.nr_bucket - 1)]);
+    auto entry = reinterpret_cast<EntryHeader*>(m_ptr + begin);
+    entry->next = bucket.load(std::memory_order_relaxed);
+    entry->hash = hash;
+    entry->category_size = category.size();
+    entry->key_size = key.size;
+    entry->value_size = value.size;
+    entry->reserved = 0;
+    auto dest = m_ptr + begin + sizeof(EntryHeader);
+    memcpy(dest, category.data(), category.size());
+    memcpy(dest += category.size(), key.ptr, key.size);
+    memcpy(dest += key.size, value.ptr, value.size);
+
+    // an entry is published only after it is completely written, so an
+    // interrupted put would never leave a partial entry reachable
+    data_end.store(begin + size, std::memory_order_release);
+    bucket.store(begin, std::memory_order_release);
+    as_atomic(hdr.nr_entry).fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t MmapPersistentCache::nr_entry() const {
+    return as_atomic(header().nr_entry).load(std::memory_order_relaxed);
+}
+
+size_t MmapPersistentCache::used_size() const {
+    auto&& hdr = header();
+    return as_atomic(hdr.data_end).load(std::memory_order_relaxed) -
+           hdr.data_begin;
+}
+
+size_t MmapPersistentCache::capacity() const {
+    auto&& hdr = header();
+    return hdr.file_size - hdr.data_begin;
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
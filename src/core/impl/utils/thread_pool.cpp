@@ -10,6 +10,7 @@
  */
 
 #include "megbrain/utils/thread_pool.h"
+#include "megbrain/utils/trace_recorder.h"
 #include <chrono>
 
 using namespace mgb;
@@ -93,7 +94,12 @@ void ThreadPool::add_task(const TaskElem& task_elem) {
         m_nr_parallelism = parallelism;
         m_task_iter.exchange(parallelism, std::memory_order_relaxed);
         m_task = [&task_elem](size_t index, size_t thread_id) {
+            using T = TraceRecorder;
+            T::record(T::Type::THREAD_POOL_TASK, T::Phase::BEGIN, index,
+                      thread_id);
             task_elem.task(index, thread_id);
+            T::record(T::Type::THREAD_POOL_TASK, T::Phase::END, index,
+                      thread_id);
         };
         //! Set flag to start thread working
         for (uint32_t i = 0; i < m_nr_threads - 1; i++) {
@@ -0,0 +1,193 @@
+/**
+ * \file src/core/impl/utils/trace_recorder.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "megbrain/utils/trace_recorder.h"
+#include "megbrain/utils/thread.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace mgb;
+
+class TraceRecorder::ThreadBuffer {
+    std::vector<Record> m_records;
+    const uint64_t m_mask;
+    //! total number of records written; only modified by the owner thread
+    std::atomic<uint64_t> m_nr_written{0};
+    //! value of m_nr_written at last clear; only accessed by collector
+    uint64_t m_nr_cleared = 0;
+
+public:
+    const size_t tid;
+
+    ThreadBuffer(size_t tid, size_t size)
+            : m_records(size), m_mask{size - 1}, tid{tid} {
+        mgb_assert(size && !(size & (size - 1)),
+                   "trace buffer size must be power of 2, got %zu", size);
+    }
+
+    //! move records not collected yet to the recorder
+    ~ThreadBuffer();
+
+    void append(Type type, Phase phase, uint64_t id, uint64_t arg) {
+        auto nr = m_nr_written.load(std::memory_order_relaxed);
+        auto&& rec = m_records[nr & m_mask];
+        rec.tsc = TraceRecorder::now();
+        rec.id = id;
+        rec.arg = arg;
+        rec.type = type;
+        rec.phase = phase;
+        m_nr_written.store(nr + 1, std::memory_order_release);
+    }
+
+    ThreadRecords collect(bool clear) {
+        ThreadRecords ret;
+        ret.tid = tid;
+        auto end = m_nr_written.load(std::memory_order_acquire),
+             begin = std::max<uint64_t>(m_nr_cleared,
+                                        end > m_records.size()
+                                                ? end - m_records.size()
+                                                : 0);
+        ret.nr_dropped = begin - m_nr_cleared;
+        ret.records.reserve(end - begin);
+        for (auto i = begin; i < end; ++i) {
+            ret.records.push_back(m_records[i & m_mask]);
+        }
+        if (clear) {
+            m_nr_cleared = end;
+        }
+        return ret;
+    }
+};
+
+struct TraceRecorder::Impl {
+    std::mutex mtx;
+    //! buffers of living threads, each owned by its thread
+    std::vector<ThreadBuffer*> buffers;
+    //! records of exited threads that have not been cleared
+    std::vector<ThreadRecords> exited_records;
+    size_t nr_thread = 0, buffer_size = 1 << 16;
+
+    bool time_init = false;
+    uint64_t tsc_start = 0;
+    std::chrono::steady_clock::time_point time_start;
+
+    std::unique_ptr<ThreadBuffer> add_thread() {
+        MGB_LOCK_GUARD(mtx);
+        auto buf = std::make_unique<ThreadBuffer>(nr_thread++, buffer_size);
+        buffers.push_back(buf.get());
+        return buf;
+    }
+
+    void remove_thread(ThreadBuffer* buf) {
+        MGB_LOCK_GUARD(mtx);
+        auto iter = std::find(buffers.begin(), buffers.end(), buf);
+        mgb_assert(iter != buffers.end());
+        buffers.erase(iter);
+        auto rec = buf->collect(true);
+        if (!rec.records.empty() || rec.nr_dropped) {
+            exited_records.emplace_back(std::move(rec));
+        }
+    }
+};
+
+TraceRecorder::ThreadBuffer::~ThreadBuffer() {
+    TraceRecorder::inst().m_impl->remove_thread(this);
+}
+
+std::atomic_int TraceRecorder::sm_nr_active{0};
+
+TraceRecorder::TraceRecorder() : m_impl{std::make_unique<Impl>()} {}
+
+TraceRecorder::~TraceRecorder() = default;
+
+TraceRecorder& TraceRecorder::inst() {
+    // never destructed, so threads exiting after static destruction can
+    // still record safely
+    static TraceRecorder* ret = new TraceRecorder;
+    return *ret;
+}
+
+void TraceRecorder::record_unchecked(Type type, Phase phase, uint64_t id,
+                                     uint64_t arg) {
+    // released on thread exit, so the memory of exited threads is not kept
+    // by the recorder
+    static thread_local std::unique_ptr<ThreadBuffer> buf;
+    if (!buf) {
+        buf = inst().m_impl->add_thread();
+    }
+    buf->append(type, phase, id, arg);
+}
+
+uint64_t TraceRecorder::now_fallback() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+}
+
+void TraceRecorder::activate() {
+    {
+        MGB_LOCK_GUARD(m_impl->mtx);
+        if (!m_impl->time_init) {
+            m_impl->time_init = true;
+            m_impl->tsc_start = now();
+            m_impl->time_start = std::chrono::steady_clock::now();
+        }
+    }
+    sm_nr_active.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TraceRecorder::deactivate() {
+    auto prev = sm_nr_active.fetch_sub(1, std::memory_order_relaxed);
+    mgb_assert(prev > 0, "TraceRecorder::deactivate() without activate()");
+}
+
+void TraceRecorder::buffer_size(size_t size) {
+    MGB_LOCK_GUARD(m_impl->mtx);
+    m_impl->buffer_size = size;
+}
+
+std::vector<TraceRecorder::ThreadRecords> TraceRecorder::collect(bool clear) {
+    MGB_LOCK_GUARD(m_impl->mtx);
+    std::vector<ThreadRecords> ret;
+    if (clear) {
+        ret.swap(m_impl->exited_records);
+    } else {
+        ret = m_impl->exited_records;
+    }
+    for (auto&& i : m_impl->buffers) {
+        ret.emplace_back(i->collect(clear));
+    }
+    return ret;
+}
+
+TraceRecorder::TimeBase TraceRecorder::time_base() {
+    using namespace std::chrono;
+    TimeBase ret;
+    steady_clock::time_point time_start, time_now;
+    uint64_t tsc_now;
+    {
+        MGB_LOCK_GUARD(m_impl->mtx);
+        mgb_assert(m_impl->time_init, "TraceRecorder has not been activated");
+        ret.tsc_start = m_impl->tsc_start;
+        time_start = m_impl->time_start;
+    }
+    do {
+        tsc_now = now();
+        time_now = steady_clock::now();
+    } while (time_now - time_start < milliseconds(1));
+    ret.nsec_per_tick =
+            duration_cast<nanoseconds>(time_now - time_start).count() /
+            static_cast<double>(tsc_now - ret.tsc_start);
+    return ret;
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
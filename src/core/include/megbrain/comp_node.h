@@ -477,6 +477,46 @@ class CompNode {
          */
         static bool enable_affinity_for_cpu(bool flag);
 
+        //! memory allocation policy for CPU comp nodes
+        struct CpuMemPolicy {
+            //! numa_node value to bind to the node of the bound CPU
+            static constexpr int NUMA_NODE_AUTO = -2;
+
+            /*!
+             * allocations not smaller than this size are mapped directly
+             * and backed by 2MB huge pages; 0 to disable
+             */
+            size_t huge_page_threshold = 0;
+
+            /*!
+             * whether to use explicit huge pages (MAP_HUGETLB) reserved by
+             * the system administrator; transparent huge pages would be used
+             * if this is false or the reservation is exhausted
+             */
+            bool explicit_huge_page = false;
+
+            /*!
+             * NUMA node to bind the mapped memory to; -1 for no binding.
+             * NUMA_NODE_AUTO uses the node of the CPU a comp node is bound
+             * to if affinity is enabled, or otherwise the node of the CPU
+             * where the allocating thread runs
+             */
+            int numa_node = -1;
+        };
+
+        /*!
+         * \brief set memory allocation policy for CPU comp nodes
+         *
+         * Only large allocations, like the static memory chunk and
+         * parameters, are affected. If huge pages or NUMA binding are not
+         * supported, the policy silently falls back to normal allocation.
+         *
+         * (implemented in comp_node/cpu/comp_node.cpp)
+         *
+         * \return original setting
+         */
+        static CpuMemPolicy set_cpu_mem_policy(const CpuMemPolicy& policy);
+
 
     protected:
         //! ImplBase with env(); defined in CompNodeEnv
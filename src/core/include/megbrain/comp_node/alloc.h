@@ -178,18 +178,39 @@ class DevMemAlloc: virtual public MemAllocBase {
                 alignment = 1024;           //! alignment
         };
 
+        /*!
+         * \brief algorithm to manage free blocks in device and stream
+         *      allocators
+         */
+        enum class FreeListAlgo {
+            //! O(log n) best fit by blocks sorted by size and address
+            BEST_FIT,
+
+            //! O(1) two-level segregated fit; better for frequent
+            //! allocations of dynamic shapes
+            TLSF,
+        };
+
+        /*!
+         * \brief get the default free list algo, which can be set by env var
+         *      MGB_MEM_ALLOC_FREE_LIST (best_fit or tlsf)
+         */
+        static FreeListAlgo default_free_list_algo();
+
         /*!
          * \brief create a new allocator for a device
          * \param[in] device device id
          * \param[in] reserve_size memory to be pre-allocated on this device
          * \param[in] raw_allocator the raw allocator to be used
          * \param[in] runtime_policy the runtime policy to be used
+         * \param[in] free_list_algo algorithm to manage free blocks
          */
         static std::unique_ptr<DevMemAlloc> make(
                 int device, size_t reserve_size,
                 const std::shared_ptr<mem_alloc::RawAllocator>& raw_allocator,
                 const std::shared_ptr<mem_alloc::DeviceRuntimePolicy>&
-                        runtime_policy);
+                        runtime_policy,
+                FreeListAlgo free_list_algo = default_free_list_algo());
 
 #if MGB_CUDA
         /*!
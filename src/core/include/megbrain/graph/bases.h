@@ -27,6 +27,11 @@
     ((!MGB_BUILD_SLIM_SERVING) && (!!MGB_HAVE_THREAD) && (MGB_CUDA))
 #endif
 
+#ifndef MGB_ENABLE_MEMORY_OFFLOAD
+#define MGB_ENABLE_MEMORY_OFFLOAD \
+    ((!MGB_BUILD_SLIM_SERVING) && (!!MGB_HAVE_THREAD))
+#endif
+
 #ifndef MGB_ENABLE_PARTIAL_EXECUTION
 #define MGB_ENABLE_PARTIAL_EXECUTION (!MGB_BUILD_SLIM_SERVING)
 #endif  //  MGB_ENABLE_PARTIAL_EXECUTION
@@ -222,6 +222,17 @@ class ComputingGraph : public std::enable_shared_from_this<ComputingGraph>,
                 //! whether to enable comp node optimization (e.g. using copy
                 //! stream for I/O operators)
                 bool enable_seq_comp_node_opt = true;
+
+                //! number of static memory allocation results to be cached on
+                //! each comp node, so switching between recurring var shapes
+                //! does not need to rerun the allocator; 0 to disable
+                size_t static_mem_plan_cache_size = 0;
+
+                //! if nonzero, sizes of statically allocated chunks are
+                //! rounded up to multiples of this value (in bytes) for
+                //! planning, so that similar shapes share a cached plan at
+                //! the cost of more memory
+                size_t static_mem_plan_bucket = 0;
             } seq_opt;
 
             //! graph optimization options
@@ -254,6 +265,15 @@ class ComputingGraph : public std::enable_shared_from_this<ComputingGraph>,
              */
             int16_t graph_opt_level = 2;
 
+            /*!
+             * number of compiling results to be cached, so recompiling with
+             * recurring output vars (e.g. switching between training and
+             * evaluation) can reuse the optimized graph and the operator
+             * sequence; 0 to disable. It is ignored if sublinear memory or
+             * memory swap is enabled.
+             */
+            uint16_t compile_cache_size = 0;
+
             /*!
              * set logging level, larger number means more verbose
              * 0: no log info
@@ -281,6 +301,14 @@ class ComputingGraph : public std::enable_shared_from_this<ComputingGraph>,
             //! whether to perform var sanity check on first run
             bool var_sanity_check_first_run = true;
 
+            /*!
+             * whether var sanity check only checks vars whose memory is
+             * forwarded from or to other vars, which are the vars most
+             * likely to be corrupted, so the check is cheap enough to be
+             * kept on in production
+             */
+            bool var_sanity_check_mem_fwd_only = false;
+
             //! whether to allocate static memory just after compiling graph
             bool allocate_static_mem_after_graph_compile = false;
 
@@ -294,6 +322,42 @@ class ComputingGraph : public std::enable_shared_from_this<ComputingGraph>,
             //! whether to enable sublinear memory optimization
             bool enable_sublinear_memory_opt = false;
 
+            /*!
+             * parameters for searching the sublinear memory plan; each of
+             * them is overridden by the corresponding MGB_SUBLINEAR_MEMORY_*
+             * env var if it is set
+             */
+            struct SublinearMemConfig {
+                //! number of thresholds to try in preset search
+                //! (MGB_SUBLINEAR_MEMORY_THRESH_NR_TRY)
+                size_t thresh_nr_try = 10;
+
+                //! number of iterations of genetic search; 0 to disable
+                //! (MGB_SUBLINEAR_MEMORY_GENETIC_NR_ITER)
+                size_t genetic_nr_iter = 0;
+
+                //! MGB_SUBLINEAR_MEMORY_GENETIC_POOL_SIZE
+                size_t genetic_pool_size = 20;
+
+                //! if nonzero, the plan is refined to reduce recomputing
+                //! as long as memory usage does not exceed this value in
+                //! bytes (MGB_SUBLINEAR_MEMORY_LOWER_BOUND_MB)
+                size_t lb_memory = 0;
+
+                /*!
+                 * memory budget in bytes on each comp node
+                 * (MGB_SUBLINEAR_MEMORY_BUDGET_MB); if nonzero, the plan
+                 * with least estimated recomputing cost whose memory
+                 * bottleneck does not exceed the budget is chosen, rather
+                 * than the one with minimal memory bottleneck
+                 */
+                size_t memory_budget = 0;
+
+                //! number of planner threads; 0 for half of CPU count
+                //! (MGB_SUBLINEAR_MEMORY_WORKERS)
+                size_t num_worker = 0;
+            } sublinear_mem_config;
+
             //! do not re-profile to select best impl algo when input shape
             //! changes (use previous algo)
             bool no_profiling_on_shape_change = false;
@@ -313,6 +377,56 @@ class ComputingGraph : public std::enable_shared_from_this<ComputingGraph>,
              */
             bool enable_memory_swap = false;
 
+            /*!
+             * whether to offload long-lived vars (usually activations used by
+             * backward) to host memory after they are produced, and prefetch
+             * them back before their next readers; copies are performed by a
+             * dedicated thread (or the copy stream) of each comp node to
+             * overlap with computing.
+             * Unlike memory swap, it also works on CPU comp nodes, and can be
+             * combined with sublinear memory. It can not be used with
+             * comp_node_seq_record_level.
+             */
+            bool enable_memory_offload = false;
+
+            /*!
+             * parameters for choosing vars to be offloaded; each of them is
+             * overridden by the corresponding MGB_MEMORY_OFFLOAD_* env var if
+             * it is set
+             */
+            struct MemoryOffloadConfig {
+                //! min size in bytes of a var to be offloaded
+                //! (MGB_MEMORY_OFFLOAD_MIN_VAR_SIZE)
+                size_t min_var_size = 1024 * 1024;
+
+                //! max number of oprs to overlap with a copy in each
+                //! direction (MGB_MEMORY_OFFLOAD_MAX_OVERLAP_OPRS)
+                size_t max_overlap_oprs = 16;
+
+                //! estimated copy bandwidth between comp node and host
+                //! memory in bytes per second (MGB_MEMORY_OFFLOAD_BANDWIDTH)
+                double copy_bandwidth = 8e9;
+
+                //! estimated number of arithmetic operations per second,
+                //! used to estimate execution time of oprs
+                //! (MGB_MEMORY_OFFLOAD_COMPUTE_THROUGHPUT)
+                double compute_throughput = 4e12;
+
+                /*!
+                 * max ratio between the total estimated time of copies that
+                 * could not be overlapped with computing and the estimated
+                 * execution time of the whole opr seq
+                 * (MGB_MEMORY_OFFLOAD_MAX_STALL_RATIO)
+                 */
+                double max_stall_ratio = 0.05;
+
+                //! whether to compress offloaded values in host memory by
+                //! omitting zero words; only applied on comp nodes whose
+                //! memory is accessible by the host, such as CPU
+                //! (MGB_MEMORY_OFFLOAD_COMPRESS)
+                bool compress = false;
+            } memory_offload_config;
+
             /*!
              * whether to use CompNodeSeqRecorder to record the execution
              * sequence and directly replay it for later executions.
@@ -304,6 +304,24 @@ class VarNode final: public GraphNodeBase {
         MGB_WARN_UNUSED_RESULT bool set_fwd_in2out_readonly(
                 VarNode* input, const SubTensorSpec& sub);
 
+        /*!
+         * \brief request that \p input be computed directly into a sub tensor
+         *      of this var
+         *
+         * This is the reverse of set_fwd_in2out_readonly(): the memory chunk
+         * of this var is shared with \p input, so the owner opr of this var
+         * does not need to copy the value of \p input. It only succeeds if
+         * \p sub is contiguous and \p input exclusively owns a statically
+         * allocated chunk.
+         *
+         * Note that this function must be called from
+         *      OperatorNodeBase::mem_plan_fwd_in2out_readonly.
+         *
+         * \return whether this request could be satisfied
+         */
+        MGB_WARN_UNUSED_RESULT bool set_fwd_out2in_subtensor(
+                VarNode* input, const SubTensorSpec& sub);
+
         /*!
          * \brief request that this var share memory with another var, whose
          *      content would also be modified
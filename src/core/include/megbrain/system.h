@@ -39,6 +39,20 @@ namespace sys {
     //! set cpu affinity for caller thread
     void set_cpu_affinity(const std::vector<int>& cpuset);
 
+    /*!
+     * \brief get the NUMA node that a CPU belongs to
+     * \return node id, or -1 if NUMA info is unavailable on this platform
+     */
+    int get_numa_node_of_cpu(int cpu);
+
+    /*!
+     * \brief get the CPUs of each NUMA node on this system
+     *
+     * A single node containing all the CPUs is returned if NUMA info is
+     * unavailable. Nodes without CPUs are included as empty lists.
+     */
+    std::vector<std::vector<int>> get_numa_node_cpus();
+
     //! whether stderr supports ansi color code
     bool stderr_ansi_color();
 
@@ -0,0 +1,94 @@
+/**
+ * \file src/core/include/megbrain/utils/mmap_persistent_cache.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include "megbrain/utils/persistent_cache.h"
+
+namespace mgb {
+
+/*!
+ * \brief PersistentCache backed by a memory-mapped file that can be shared by
+ *      multiple processes on the same host
+ *
+ * The file contains a fixed number of hash buckets and an append-only data
+ * region. Each entry is immutable after being published, so get() traverses
+ * bucket chains in the mapping without any lock. put() appends an entry while
+ * holding an exclusive file lock (and a mutex for threads in this process),
+ * and publishes it by atomically updating the bucket head; therefore a result
+ * put by one process is immediately visible to all the others.
+ *
+ * The file never grows: if the data region is full, new entries are dropped
+ * with a warning. Putting an existing key with a different value appends a new
+ * entry that shadows the old one.
+ *
+ * This is only supported on POSIX systems; the constructor throws on others.
+ */
+class MmapPersistentCache final : public PersistentCache {
+    struct Header;
+    struct EntryHeader;
+    class FileLock;
+
+    int m_fd = -1;
+    uint8_t* m_ptr = nullptr;
+    size_t m_size = 0;
+    std::mutex m_mtx;
+    bool m_full_warned = false;
+
+    Header& header() const;
+    uint64_t* buckets() const;
+
+    //! find entry offset for given hash and key; return 0 if not found
+    uint64_t lookup(uint64_t hash, const std::string& category,
+                    const Blob& key) const;
+
+    void init_file(size_t capacity, size_t nr_bucket);
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024 * 1024,
+                            DEFAULT_NR_BUCKET = 1 << 16;
+
+    /*!
+     * \brief open a cache file, creating it if it does not exist
+     * \param capacity size of data region in bytes; only used when the file
+     *      is created
+     * \param nr_bucket number of hash buckets, which would be rounded up to a
+     *      power of 2; only used when the file is created
+     */
+    explicit MmapPersistentCache(const std::string& path,
+                                 size_t capacity = DEFAULT_CAPACITY,
+                                 size_t nr_bucket = DEFAULT_NR_BUCKET);
+    ~MmapPersistentCache();
+
+    /*!
+     * \brief get a cached value
+     *
+     * The returned blob points into the mapped file, and is valid during the
+     * lifetime of this object.
+     */
+    Maybe<Blob> get(const std::string& category, const Blob& key) override;
+
+    void put(const std::string& category, const Blob& key,
+             const Blob& value) override;
+
+    //! number of entries in the file, including shadowed ones
+    size_t nr_entry() const;
+
+    //! number of bytes used in the data region
+    size_t used_size() const;
+
+    //! total size of the data region
+    size_t capacity() const;
+};
+
+}  // namespace mgb
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
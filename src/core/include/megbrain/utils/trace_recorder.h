@@ -0,0 +1,150 @@
+/**
+ * \file src/core/include/megbrain/utils/trace_recorder.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include "megbrain/common.h"
+#include "megbrain/utils/metahelper.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <x86intrin.h>
+#endif
+
+namespace mgb {
+
+/*!
+ * \brief process-wide recorder of timed events with very low overhead
+ *
+ * Each thread appends fixed-size records to its own ring buffer without any
+ * locking, and timestamps are read from the CPU time stamp counter. When the
+ * buffer of a thread is full, its oldest records are overwritten. The buffer
+ * is freed when its thread exits, and the records not cleared yet are kept
+ * by the recorder until next collect() with clear.
+ *
+ * Recording is enabled while there is at least one activate() not matched
+ * by deactivate(); when disabled, record() costs one relaxed atomic load.
+ */
+class TraceRecorder : public NonCopyableObj {
+public:
+    enum class Type : uint32_t {
+        OPR,              //!< host side execution of an opr; id is opr id
+        KERN_DISPATCH,    //!< kernel dispatching; id is opr id
+        KERN,             //!< kernel execution on a CPU worker; id is opr id
+        THREAD_POOL_TASK, //!< a task chunk; id is index, arg is thread id
+        ALLOC,            //!< device memory alloc; id is ptr, arg is size
+        FREE,             //!< device memory free; id is ptr
+    };
+
+    enum class Phase : uint32_t { BEGIN, END, INSTANT };
+
+    struct Record {
+        uint64_t tsc;
+        uint64_t id, arg;
+        Type type;
+        Phase phase;
+    };
+
+    //! records collected from a thread
+    struct ThreadRecords {
+        //! sequential id of the thread assigned by the recorder
+        size_t tid;
+        //! number of records lost due to buffer overflow
+        size_t nr_dropped;
+        std::vector<Record> records;
+    };
+
+    static TraceRecorder& inst();
+
+    //! whether recording is enabled
+    static bool enabled() {
+        return sm_nr_active.load(std::memory_order_relaxed) > 0;
+    }
+
+    //! record an event on current thread if recording is enabled
+    static void record(Type type, Phase phase, uint64_t id,
+                       uint64_t arg = 0) {
+        if (enabled()) {
+            record_unchecked(type, phase, id, arg);
+        }
+    }
+
+    //! read the timestamp used by the records
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t ret;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(ret));
+        return ret;
+#else
+        return now_fallback();
+#endif
+    }
+
+    void activate();
+    void deactivate();
+
+    /*!
+     * \brief set the number of records in the ring buffer of each thread
+     *
+     * Only affects threads that record their first event after this call.
+     */
+    void buffer_size(size_t size);
+
+    /*!
+     * \brief get records of all the threads since last clear
+     *
+     * Records overwritten during this call may be corrupted, so it should
+     * be called when no event is being recorded if possible.
+     */
+    std::vector<ThreadRecords> collect(bool clear = true);
+
+    //! converter from timestamps to nanoseconds since first activate()
+    struct TimeBase {
+        uint64_t tsc_start;
+        double nsec_per_tick;
+
+        double to_nsec(uint64_t tsc) const {
+            return (static_cast<double>(tsc) -
+                    static_cast<double>(tsc_start)) *
+                   nsec_per_tick;
+        }
+    };
+
+    /*!
+     * \brief get the time base, with counter frequency calibrated over the
+     *      time since first activate()
+     */
+    TimeBase time_base();
+
+private:
+    class ThreadBuffer;
+    struct Impl;
+
+    static std::atomic_int sm_nr_active;
+
+    std::unique_ptr<Impl> m_impl;
+
+    TraceRecorder();
+    ~TraceRecorder();
+
+    static void record_unchecked(Type type, Phase phase, uint64_t id,
+                                 uint64_t arg);
+    static uint64_t now_fallback();
+};
+
+}  // namespace mgb
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -217,6 +217,29 @@ TEST(TestCompNodeCPU, CoreAffinity) {
     ASSERT_EQ(data_v[1], static_cast<size_t>(30));
 }
 
+TEST(TestCompNodeCPU, MemPolicy) {
+    CompNode::CpuMemPolicy policy;
+    policy.huge_page_threshold = 1 << 20;
+    policy.numa_node = CompNode::CpuMemPolicy::NUMA_NODE_AUTO;
+    auto old_policy = CompNode::set_cpu_mem_policy(policy);
+    MGB_TRY {
+        auto cn = CompNode::load("cpu0");
+        HostTensorGenerator<> gen;
+        for (size_t size : {1_z << 10, 3_z << 18, 5_z << 20}) {
+            auto host_x = gen({size}, cn);
+            DeviceTensorND dev_x{cn};
+            dev_x.copy_from(*host_x);
+            auto ptr = reinterpret_cast<uintptr_t>(dev_x.raw_ptr());
+            ASSERT_EQ(0u, ptr % cn.get_mem_addr_alignment());
+            HostTensorND host_y;
+            host_y.copy_from(dev_x).sync();
+            MGB_ASSERT_TENSOR_EQ(*host_x, host_y);
+        }
+        cn.sync();
+    }
+    MGB_FINALLY(CompNode::set_cpu_mem_policy(old_policy));
+}
+
 TEST(TestCompNode, CPU_MULTI_THREAD) {
     REQUIRE_THREAD();
     std::vector<int> source(100), dst0(100), dst1(100);
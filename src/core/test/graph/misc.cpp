@@ -37,6 +37,10 @@ namespace cg {
 class ComputingGraphImpl : public ComputingGraph {
 public:
     GraphExecutable::ExecEnv* current_exec_env();
+    size_t optimized_dest_vars_cache_nr_hit() const;
+    size_t optimized_dest_vars_cache_nr_miss() const;
+    size_t comp_seq_cache_nr_hit();
+    size_t comp_seq_cache_nr_miss();
 };
 }  // namespace cg
 }  // namespace mgb
@@ -1726,6 +1730,100 @@ TEST(TestGraph, UpdateStaticAllocPlan) {
     func->execute();
 }
 
+TEST(TestGraph, CompileCache) {
+    HostTensorGenerator<> gen;
+    auto host_x = gen({23}), host_z = gen({23});
+    auto graph = ComputingGraph::make();
+    graph->options().compile_cache_size = 2;
+    auto x = opr::Host2DeviceCopy::make(*graph, host_x),
+         z = opr::Host2DeviceCopy::make(*graph, host_z), a = x + 1.f,
+         b = z * 2.f, c = a + b;
+
+    auto get_seq = [](cg::AsyncExecutable& func) {
+        cg::OprNodeArray seq;
+        func.iter_opr_seq([&](cg::OperatorNodeBase* opr) {
+            seq.push_back(opr);
+            return true;
+        });
+        return seq;
+    };
+    auto check = [&](const HostTensorND& ha, const HostTensorND& hb) {
+        auto px = host_x->ptr<float>(), pz = host_z->ptr<float>(),
+             pa = ha.ptr<float>(), pb = hb.ptr<float>();
+        for (size_t i = 0; i < 23; ++i) {
+            ASSERT_EQ(px[i] + 1.f, pa[i]);
+            ASSERT_EQ(pz[i] * 2.f, pb[i]);
+        }
+    };
+
+    auto graph_impl = static_cast<cg::ComputingGraphImpl*>(graph.get());
+    size_t nr_opt_hit = 0, nr_opt_miss = 0, nr_seq_hit = 0, nr_seq_miss = 0;
+    // check whether the last compiling reused the cached results of graph
+    // optimization and topo sort
+    auto check_cache = [&](bool opt_hit, bool seq_hit) {
+        auto check_counter = [](bool hit, size_t cur_hit, size_t cur_miss,
+                                size_t& nr_hit, size_t& nr_miss) {
+            ASSERT_EQ(nr_hit + hit, cur_hit);
+            ASSERT_EQ(nr_miss + !hit, cur_miss);
+            nr_hit = cur_hit;
+            nr_miss = cur_miss;
+        };
+        check_counter(opt_hit, graph_impl->optimized_dest_vars_cache_nr_hit(),
+                      graph_impl->optimized_dest_vars_cache_nr_miss(),
+                      nr_opt_hit, nr_opt_miss);
+        check_counter(seq_hit, graph_impl->comp_seq_cache_nr_hit(),
+                      graph_impl->comp_seq_cache_nr_miss(), nr_seq_hit,
+                      nr_seq_miss);
+    };
+
+    HostTensorND host_a, host_b, host_c;
+    auto func = graph->compile({make_callback_copy(a, host_a),
+                                make_callback_copy(b, host_b)});
+    check_cache(false, false);
+    func->execute();
+    check(host_a, host_b);
+    auto seq0 = get_seq(*func);
+
+    func = graph->compile({make_callback_copy(c, host_c)});
+    check_cache(false, false);
+    func->execute();
+    for (size_t i = 0; i < 23; ++i) {
+        ASSERT_EQ(host_a.ptr<float>()[i] + host_b.ptr<float>()[i],
+                  host_c.ptr<float>()[i]);
+    }
+
+    // recompile with new callbacks, which should reuse the cached result
+    HostTensorND host_a1, host_b1;
+    *host_x = *gen({23});
+    func = graph->compile({make_callback_copy(a, host_a1),
+                           make_callback_copy(b, host_b1)});
+    check_cache(true, true);
+    func->execute();
+    check(host_a1, host_b1);
+    ASSERT_EQ(seq0, get_seq(*func));
+
+    // changing priority should invalidate the cache
+    auto pos = [](const cg::OprNodeArray& seq, SymbolVar var) {
+        return std::find(seq.begin(), seq.end(), var.node()->owner_opr()) -
+               seq.begin();
+    };
+    auto&& prio_a = a.node()->owner_opr()->node_prop().attribute().priority;
+    auto&& prio_b = b.node()->owner_opr()->node_prop().attribute().priority;
+    if (pos(seq0, a) < pos(seq0, b)) {
+        prio_a = 1;
+    } else {
+        prio_b = 1;
+    }
+    func = graph->compile({make_callback_copy(a, host_a1),
+                           make_callback_copy(b, host_b1)});
+    // graph optimization does not depend on priorities
+    check_cache(true, false);
+    func->execute();
+    check(host_a1, host_b1);
+    auto seq1 = get_seq(*func);
+    ASSERT_EQ(pos(seq0, a) < pos(seq0, b), pos(seq1, a) > pos(seq1, b));
+}
+
 TEST(TestGraph, CPUGPUHybrid) {
     REQUIRE_GPU(1);
     auto cn_cpu = CompNode::load("cpu:default"),
@@ -16,6 +16,7 @@
 #include "megbrain/opr/io.h"
 #include "megbrain/opr/utility.h"
 #include "megbrain/test/helper.h"
+#include "megbrain/utils/timer.h"
 
 #include <thread>
 #include <map>
@@ -301,7 +302,57 @@ TEST(TestMemAlloc, GrowByGather) {
     salloc->alloc_shared(10);
 }
 
-TEST(TestMemAlloc, RandomOprs) {
+TEST(TestMemAlloc, TLSFMerge) {
+    using StreamKey = DevMemAlloc::StreamKey;
+    auto raw_alloc = std::make_shared<DummyAllocator>(4096);
+    auto runtime_policy = std::make_shared<DummyRuntimePolicy>(0);
+    auto dev_alloc = DevMemAlloc::make(0, 0, raw_alloc, runtime_policy,
+                                       DevMemAlloc::FreeListAlgo::TLSF);
+    auto conf = dev_alloc->prealloc_config();
+    conf.min_req = 1024;
+    conf.max_overhead = 1024;
+    conf.alignment = 1;
+    dev_alloc->prealloc_config(conf);
+
+    StreamKey stream_key = nullptr;
+    auto salloc = dev_alloc->add_stream(static_cast<StreamKey>(&stream_key));
+    void* ptrs[4];
+    for (auto&& i : ptrs) {
+        i = salloc->alloc(100);
+    }
+    // make two free blocks of 100 with an allocated one between
+    salloc->free(ptrs[0]);
+    salloc->free(ptrs[2]);
+    EXPECT_EQ(2u, salloc->get_free_memory().nr_blk);
+    EXPECT_EQ(200u, salloc->get_free_memory().tot);
+
+    // merge with both neighbours
+    salloc->free(ptrs[1]);
+    auto stat = salloc->get_free_memory();
+    EXPECT_EQ(1u, stat.nr_blk);
+    EXPECT_EQ(300u, stat.max);
+    EXPECT_EQ(ptrs[0], salloc->alloc(300));
+    EXPECT_EQ(0u, salloc->get_free_memory().tot);
+
+    // size classes are rounded up when searching, but a fitting block in
+    // the same class must still be found
+    salloc->free(ptrs[0]);
+    auto p = salloc->alloc(299);
+    EXPECT_EQ(ptrs[0], p);
+    salloc->free(p);
+    salloc->free(ptrs[3]);
+
+    // a head block must not be merged with the chunk before it
+    auto p0 = salloc->alloc(1000);
+    EXPECT_NE(raw_alloc->get_chunk_end(ptrs[0]), raw_alloc->get_chunk_end(p0));
+    salloc->free(p0);
+    dev_alloc->gather_stream_free_blk_and_release_full();
+    EXPECT_EQ(0u, salloc->get_free_memory().nr_blk);
+    EXPECT_EQ(raw_alloc->nr_alloc(), raw_alloc->nr_free());
+}
+
+namespace {
+void run_random_oprs(DevMemAlloc::FreeListAlgo free_list_algo) {
     const size_t DEALLOC_PROB = std::mt19937::max() * 0.4;
     constexpr size_t NR_THREAD = 4, NR_RUN = 2000, MIN_REQ = 1, MAX_REQ = 513,
 
@@ -315,8 +366,8 @@ TEST(TestMemAlloc, RandomOprs) {
     auto runtime_policy = std::make_shared<DummyRuntimePolicy>(0);
 
     AllocChecker checker(dummy_alloc);
-    auto dev_alloc =
-            DevMemAlloc::make(0, RESERVE_MEMORY, dummy_alloc, runtime_policy);
+    auto dev_alloc = DevMemAlloc::make(0, RESERVE_MEMORY, dummy_alloc,
+                                       runtime_policy, free_list_algo);
     {
         DevMemAlloc::PreAllocConfig prconf;
         prconf.alignment = 512;
@@ -439,6 +490,60 @@ TEST(TestMemAlloc, RandomOprs) {
 
     ASSERT_EQ(dummy_alloc->nr_alloc(), dummy_alloc->nr_free());
 }
+}  // anonymous namespace
+
+TEST(TestMemAlloc, RandomOprs) {
+    run_random_oprs(DevMemAlloc::FreeListAlgo::BEST_FIT);
+}
+
+TEST(TestMemAlloc, RandomOprsTLSF) {
+    run_random_oprs(DevMemAlloc::FreeListAlgo::TLSF);
+}
+
+TEST(TestMemAlloc, BenchmarkFreeList) {
+    // allocations of dynamic shapes: many live blocks of random sizes
+    constexpr size_t NR_LIVE = 4096, NR_RUN = 200000, MAX_REQ = 1 << 18;
+    using Algo = DevMemAlloc::FreeListAlgo;
+    std::vector<size_t> sizes(NR_RUN);
+    std::vector<size_t> free_idx(NR_RUN);
+    {
+        std::mt19937 rng(next_rand_seed());
+        for (size_t i = 0; i < NR_RUN; ++i) {
+            sizes[i] = rng() % MAX_REQ + 1;
+            free_idx[i] = rng() % NR_LIVE;
+        }
+    }
+    for (auto algo : {Algo::BEST_FIT, Algo::TLSF}) {
+        auto raw_alloc = std::make_shared<DummyAllocator>(NR_LIVE * MAX_REQ * 2);
+        auto runtime_policy = std::make_shared<DummyRuntimePolicy>(0);
+        auto dev_alloc = DevMemAlloc::make(0, 0, raw_alloc, runtime_policy,
+                                           algo);
+        dev_alloc->alignment(256);
+        DevMemAlloc::StreamKey stream_key = nullptr;
+        auto salloc = dev_alloc->add_stream(&stream_key);
+
+        std::vector<void*> live(NR_LIVE, nullptr);
+        RealTimer timer;
+        for (size_t i = 0; i < NR_RUN; ++i) {
+            auto&& ptr = live[free_idx[i]];
+            if (ptr) {
+                salloc->free(ptr);
+            }
+            ptr = salloc->alloc(sizes[i]);
+        }
+        auto time = timer.get_secs();
+        auto stat = salloc->get_free_memory();
+        mgb_log("free list %s: %.3fns per alloc/free; raw alloc: %zu; "
+                "free blocks: nr=%zu tot=%.2fMiB",
+                algo == Algo::TLSF ? "tlsf" : "best_fit", time * 1e9 / NR_RUN,
+                raw_alloc->nr_alloc(), stat.nr_blk, stat.tot / 1024.0 / 1024);
+        for (auto i : live) {
+            if (i) {
+                salloc->free(i);
+            }
+        }
+    }
+}
 
 namespace {
 class DevicePolicy {
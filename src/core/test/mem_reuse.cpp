@@ -18,8 +18,20 @@
 
 #include "megbrain/test/helper.h"
 
+#include "../impl/graph/var_node_mem_mgr/static_mem_plan_cache.h"
+
 using namespace mgb;
 
+namespace mgb {
+namespace cg {
+// declaration of impl class to access its methods
+class ComputingGraphImpl : public ComputingGraph {
+public:
+    const StaticMemPlanCache* static_mem_plan_cache(CompNode cn);
+};
+}  // namespace cg
+}  // namespace mgb
+
 namespace {
 
 SymbolVar make_conv(SymbolVar inp, SymbolVar kern) {
@@ -337,5 +349,78 @@ TEST(TestMemReuse, FwdNoSysMemAlloc) {
     }
 }
 
+TEST(TestMemReuse, StaticMemPlanCache) {
+    HostTensorGenerator<> gen;
+    auto host_x = gen({23, 5});
+    auto graph = ComputingGraph::make();
+    graph->options().seq_opt.static_mem_plan_cache_size = 2;
+    graph->options().seq_opt.static_mem_plan_bucket = 4096;
+    auto x = opr::Host2DeviceCopy::make_no_fwd(*graph, host_x),
+         a = x * 2 + 1, b = a * a, y = b - x;
+    size_t alloc_size = 0;
+    auto hdl = graph->event().register_receiver<cg::event::StaticMemAlloc>(
+            [&](const cg::event::StaticMemAlloc& s) {
+                if (s.comp_node.valid()) {
+                    alloc_size = s.alloc_size;
+                }
+            });
+    HostTensorND host_y;
+    auto func = graph->compile({make_callback_copy(y, host_y)});
+    auto run = [&](const TensorShape& shape) {
+        *host_x = *gen(shape);
+        func->execute();
+        HostTensorND expect;
+        expect.copy_from(*host_x);
+        auto px = host_x->ptr<float>(), pe = expect.ptr<float>();
+        for (size_t i = 0, it = shape.total_nr_elems(); i < it; ++i) {
+            auto a = px[i] * 2 + 1;
+            pe[i] = a * a - px[i];
+        }
+        return expect;
+    };
+    auto cache = [&]() {
+        return static_cast<cg::ComputingGraphImpl*>(graph.get())
+                ->static_mem_plan_cache(host_x->comp_node());
+    };
+    size_t nr_hit = 0, nr_miss = 0;
+    // check whether the plan for the last run was cached
+    auto check_cache = [&](bool hit) {
+        ASSERT_NE(nullptr, cache());
+        if (hit) {
+            ASSERT_GT(cache()->nr_hit(), nr_hit);
+            ASSERT_EQ(nr_miss, cache()->nr_miss());
+        } else {
+            ASSERT_EQ(nr_hit, cache()->nr_hit());
+            ASSERT_GT(cache()->nr_miss(), nr_miss);
+        }
+        nr_hit = cache()->nr_hit();
+        nr_miss = cache()->nr_miss();
+    };
+
+    MGB_ASSERT_TENSOR_EQ(run({23, 5}), host_y);
+    check_cache(false);
+    auto size0 = alloc_size;
+    MGB_ASSERT_TENSOR_EQ(run({400, 5}), host_y);
+    check_cache(false);
+    auto size1 = alloc_size;
+    ASSERT_GT(size1, size0);
+
+    // cached plans, with a shape in the same bucket as the first one
+    for (auto&& shp : {TensorShape{23, 5}, TensorShape{24, 5},
+                       TensorShape{400, 5}}) {
+        MGB_ASSERT_TENSOR_EQ(run(shp), host_y);
+        check_cache(true);
+        ASSERT_EQ(shp[0] == 400 ? size1 : size0, alloc_size);
+    }
+
+    // evict {23, 5} and replan
+    MGB_ASSERT_TENSOR_EQ(run({1000, 5}), host_y);
+    check_cache(false);
+    ASSERT_GT(alloc_size, size1);
+    MGB_ASSERT_TENSOR_EQ(run({23, 5}), host_y);
+    check_cache(false);
+    ASSERT_EQ(size0, alloc_size);
+}
+
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
 
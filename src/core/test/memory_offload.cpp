@@ -0,0 +1,186 @@
+/**
+ * \file src/core/test/memory_offload.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "megbrain/test/helper.h"
+
+#include "megbrain/opr/basic_arith_wrapper.h"
+#include "megbrain/opr/blas.h"
+#include "megbrain/opr/io.h"
+
+#include "../impl/graph/swap/offload_helper.h"
+#include "../impl/graph/swap/offload_opr.h"
+
+using namespace mgb;
+
+#if MGB_ENABLE_MEMORY_OFFLOAD
+namespace {
+
+void run_mlp(bool compress) {
+    HostTensorGenerator<> gen;
+    constexpr size_t BATCH = 32, CHL = 64, NR_LAYER = 12;
+    auto cn = CompNode::load("cpu0");
+    auto graph = ComputingGraph::make();
+    auto x = opr::Host2DeviceCopy::make(*graph, gen({BATCH, CHL}, cn));
+    SymbolVarArray params;
+    auto y = x;
+    for (size_t i = 0; i < NR_LAYER; ++i) {
+        params.push_back(
+                opr::SharedDeviceTensor::make(*graph, *gen({CHL, CHL}, cn)));
+        y = opr::relu(opr::MatrixMul::make(y, params.back()));
+    }
+    auto loss = opr::reduce_sum_sqr(y, y.make_scalar(1));
+
+    std::vector<HostTensorND> grad_expect(NR_LAYER), grad_get(NR_LAYER);
+    size_t static_size[2];
+    for (bool offload : {false, true}) {
+        auto&& opt = graph->options();
+        opt.enable_memory_offload = offload;
+        // offload every activation regardless of estimated stall
+        opt.memory_offload_config.min_var_size = 1;
+        opt.memory_offload_config.max_overlap_oprs = 2;
+        opt.memory_offload_config.max_stall_ratio = 1e9;
+        opt.memory_offload_config.compress = compress;
+
+        auto&& grad_dest = offload ? grad_get : grad_expect;
+        ComputingGraph::OutputSpec out_spec;
+        for (size_t i = 0; i < NR_LAYER; ++i) {
+            out_spec.push_back(make_callback_copy(cg::grad(loss, params[i]),
+                                                  grad_dest[i]));
+        }
+        auto func = graph->compile(out_spec);
+
+        size_t nr_offload_in = 0;
+        // recorders of offloaded relu outputs, and sizes of the values
+        std::vector<std::pair<swap::opr::RecorderPtr, size_t>> relu_recorders;
+        func->iter_opr_seq([&](cg::OperatorNodeBase* opr) {
+            if (opr->same_type<swap::opr::OffloadOut>()) {
+                auto inp = opr->input(0);
+                auto src = inp->owner_opr();
+                if (src->same_type<opr::Elemwise>() &&
+                    src->cast_final<opr::Elemwise>().param().mode ==
+                            opr::Elemwise::Mode::RELU) {
+                    relu_recorders.emplace_back(
+                            opr->cast_final<swap::opr::OffloadOut>()
+                                    .recorder(),
+                            inp->dtype().size(inp->shape().total_nr_elems()));
+                }
+            }
+            if (opr->same_type<swap::opr::OffloadIn>()) {
+                ++nr_offload_in;
+            }
+            return true;
+        });
+        if (offload) {
+            ASSERT_GT(nr_offload_in, 0u);
+            ASSERT_FALSE(relu_recorders.empty());
+        } else {
+            ASSERT_EQ(0u, nr_offload_in);
+        }
+        static_size[offload] =
+                func->update_static_alloc_plan_and_get_size().at(cn);
+
+        // run twice to check that recorders can be reused
+        for (int i = 0; i < 2; ++i) {
+            func->execute().wait();
+        }
+
+        // about half of the relu outputs are zeros
+        for (auto&& i : relu_recorders) {
+            if (compress) {
+                ASSERT_LT(i.first->stored_size(), i.second);
+            } else {
+                ASSERT_EQ(i.second, i.first->stored_size());
+            }
+        }
+    }
+
+    // offloaded activations do not occupy memory during the long interval
+    ASSERT_LT(static_size[1], static_size[0]);
+
+    for (size_t i = 0; i < NR_LAYER; ++i) {
+        MGB_ASSERT_TENSOR_NEAR(grad_expect[i], grad_get[i], 1e-5);
+    }
+}
+
+}  // anonymous namespace
+
+TEST(TestMemoryOffload, MLPGrad) {
+    run_mlp(false);
+}
+
+TEST(TestMemoryOffload, MLPGradCompress) {
+    run_mlp(true);
+}
+
+TEST(TestMemoryOffload, MinVarSize) {
+    HostTensorGenerator<> gen;
+    auto graph = ComputingGraph::make();
+    auto x = opr::Host2DeviceCopy::make(*graph, gen({8, 8}, "cpu0"));
+    auto w = opr::SharedDeviceTensor::make(*graph, *gen({8, 8}, "cpu0"));
+    auto y = x;
+    for (int i = 0; i < 8; ++i) {
+        y = opr::relu(opr::MatrixMul::make(y, w));
+    }
+    auto loss = opr::reduce_sum_sqr(y, y.make_scalar(1));
+    graph->options().enable_memory_offload = true;
+    graph->options().memory_offload_config.max_stall_ratio = 1e9;
+
+    // all vars are smaller than default min_var_size
+    HostTensorND grad;
+    auto func = graph->compile({make_callback_copy(cg::grad(loss, w), grad)});
+    func->iter_opr_seq([&](cg::OperatorNodeBase* opr) {
+        EXPECT_STRNE("OffloadOut", opr->dyn_typeinfo()->name);
+        return true;
+    });
+    func->execute();
+}
+
+TEST(TestMemoryOffload, Recompile) {
+    HostTensorGenerator<> gen;
+    auto cn = CompNode::load("cpu0");
+    constexpr size_t NR_LAYER = 8;
+    auto graph = ComputingGraph::make();
+    auto x = opr::Host2DeviceCopy::make(*graph, gen({32, 64}, cn));
+    auto w = opr::SharedDeviceTensor::make(*graph, *gen({64, 64}, cn));
+    auto y = x;
+    for (size_t i = 0; i < NR_LAYER; ++i) {
+        y = opr::relu(opr::MatrixMul::make(y, w));
+    }
+    auto loss = opr::reduce_sum_sqr(y, y.make_scalar(1));
+    auto&& opt = graph->options();
+    opt.enable_memory_offload = true;
+    opt.memory_offload_config.max_overlap_oprs = 2;
+    opt.memory_offload_config.max_stall_ratio = 1e9;
+
+    HostTensorND grad;
+    auto grad_w = cg::grad(loss, w);
+    auto run = [&](size_t min_var_size) {
+        opt.memory_offload_config.min_var_size = min_var_size;
+        auto func = graph->compile({make_callback_copy(grad_w, grad)});
+        func->execute().wait();
+    };
+
+    auto&& worker = swap::OffloadCopyWorker::inst(cn);
+    run(1);
+    auto nr_alloc = worker.nr_host_alloc();
+    // recorders and their host buffers are reused by the same vars
+    run(1);
+    ASSERT_EQ(nr_alloc, worker.nr_host_alloc());
+    // nothing is offloaded, and all host buffers are returned to the pool
+    run(std::numeric_limits<size_t>::max());
+    // buffers are taken from the pool again
+    run(1);
+    ASSERT_EQ(nr_alloc, worker.nr_host_alloc());
+}
+
+#endif  // MGB_ENABLE_MEMORY_OFFLOAD
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -13,6 +13,7 @@
 #include "megbrain/utils/arith_helper.h"
 #include "megbrain/utils/timer.h"
 #include "../impl/graph/var_node_mem_mgr/static_mem_alloc.h"
+#include "../impl/graph/var_node_mem_mgr/static_mem_plan_cache.h"
 
 #include <random>
 
@@ -234,6 +235,32 @@ TEST(TestStaticMemAllocAlgo, PushdownChain) {
     ASSERT_EQ(NR + NR - 1, allocator->tot_alloc());
 }
 
+TEST(TestStaticMemAllocAlgo, PlanCacheLRU) {
+    using Key = StaticMemPlanCache::Key;
+    auto make_key = [](size_t size, size_t offset) {
+        Key key{64};
+        key.add_interval(0, 2, size);
+        key.add_interval(1, 3, size);
+        key.add_overwrite_spec(1, 0, offset);
+        return key;
+    };
+    StaticMemPlanCache cache{2};
+    ASSERT_EQ(nullptr, cache.get(make_key(1, 0)));
+    cache.put(make_key(1, 0), {1, {0, 0}});
+    cache.put(make_key(2, 0), {2, {0, 0}});
+    ASSERT_EQ(nullptr, cache.get(make_key(1, 1)));
+    ASSERT_EQ(1u, cache.get(make_key(1, 0))->tot_alloc);
+
+    // {2, 0} is least recently used
+    cache.put(make_key(3, 0), {3, {0, 0}});
+    ASSERT_EQ(2u, cache.size());
+    ASSERT_EQ(nullptr, cache.get(make_key(2, 0)));
+    ASSERT_EQ(1u, cache.get(make_key(1, 0))->tot_alloc);
+    ASSERT_EQ(3u, cache.get(make_key(3, 0))->tot_alloc);
+    ASSERT_EQ(3u, cache.nr_hit());
+    ASSERT_EQ(3u, cache.nr_miss());
+}
+
 #endif // WIN32
 
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
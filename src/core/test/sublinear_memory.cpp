@@ -30,6 +30,7 @@ namespace cg {
 class SeqModifierForSublinearMemory {
 public:
     const CompNode::UnorderedMap<size_t>& prev_min_bottleneck();
+    const CompNode::UnorderedMap<double>& prev_recompute_ratio();
 };
 
 class ComputingGraphImpl : public ComputingGraph {
@@ -557,6 +558,129 @@ TEST(TestSublinearMemory, BadOpr) {
     );
 }
 
+TEST(TestSublinearMemory, MemoryBudget) {
+    HostTensorGenerator<> gen;
+    auto cn = CompNode::load("xpu0");
+    constexpr size_t N = 4096, NR_LAYER = 32;
+    auto host_x = gen({N}, cn);
+
+    HostTensorND host_gx, host_gx_expect;
+    // return (bottleneck, recompute ratio)
+    auto run = [&](bool sublinear,
+                   size_t budget) -> std::pair<size_t, double> {
+        auto graph = ComputingGraph::make();
+        graph->options().graph_opt_level = 0;
+        graph->options().enable_sublinear_memory_opt = sublinear;
+        graph->options().sublinear_mem_config.memory_budget = budget;
+        auto x = opr::Host2DeviceCopy::make_no_fwd(*graph, host_x), y = x;
+        for (size_t i = 0; i < NR_LAYER; ++i) {
+            y = opr::sin(y);
+        }
+        auto loss = opr::reduce_sum(y, y.make_scalar(1));
+        auto func = graph->compile(
+                {make_callback_copy(cg::grad(loss, x), host_gx)});
+        func->execute();
+        if (!sublinear) {
+            return {0, 0.};
+        }
+        auto&& modifier = static_cast<cg::ComputingGraphImpl*>(graph.get())
+                                  ->seq_modifier_for_sublinear_memory();
+        return {modifier.prev_min_bottleneck().at(cn),
+                modifier.prev_recompute_ratio().at(cn)};
+    };
+
+    run(false, 0);
+    host_gx_expect.copy_from(host_gx);
+
+    auto min_rst = run(true, 0);
+    MGB_ASSERT_TENSOR_EQ(host_gx_expect, host_gx);
+
+    // no recomputing is needed if the budget is large enough
+    auto full_rst = run(true, std::numeric_limits<size_t>::max());
+    MGB_ASSERT_TENSOR_EQ(host_gx_expect, host_gx);
+    ASSERT_EQ(0., full_rst.second);
+    ASSERT_GT(full_rst.first, min_rst.first);
+
+    size_t budget = (min_rst.first + full_rst.first) / 2;
+    auto rst = run(true, budget);
+    MGB_ASSERT_TENSOR_EQ(host_gx_expect, host_gx);
+    ASSERT_LE(rst.first, budget);
+    ASSERT_GT(rst.second, 0.);
+}
+
+TEST(TestSublinearMemory, RecomputeCheapOpr) {
+    HostTensorGenerator<> gen{0.f, 0.1f};
+    auto cn = CompNode::load("xpu0");
+    constexpr size_t NR_LAYER = 16, C = 8, H = 32, W = 32;
+    auto host_x = gen({1, C, H, W}, cn);
+    std::vector<std::shared_ptr<HostTensorND>> host_ws;
+    for (size_t i = 0; i < NR_LAYER; ++i) {
+        host_ws.push_back(gen({C, C, 3, 3}, cn));
+    }
+
+    // each layer is a conv and a square of the same output size; the square
+    // reads more memory, but the conv does far more arithmetic, so the
+    // square should be recomputed instead of the conv
+    // return (bottleneck, number of recomputed convs, number of recomputed
+    // squares)
+    auto run = [&](size_t budget) -> std::tuple<size_t, size_t, size_t> {
+        auto graph = ComputingGraph::make();
+        graph->options().graph_opt_level = 0;
+        graph->options().enable_sublinear_memory_opt = true;
+        graph->options().sublinear_mem_config.memory_budget = budget;
+        opr::Convolution::Param param;
+        param.pad_h = param.pad_w = 1;
+        auto x = opr::Host2DeviceCopy::make_no_fwd(*graph, host_x), y = x;
+        SymbolVarArray ws;
+        for (size_t i = 0; i < NR_LAYER; ++i) {
+            ws.push_back(opr::SharedDeviceTensor::make(*graph, *host_ws[i]));
+            y = opr::Convolution::make(y, ws.back(), param);
+            y = y * y;
+        }
+        auto loss = opr::reduce_sum(y, y.make_scalar(1));
+        ComputingGraph::OutputSpec out_spec;
+        std::vector<HostTensorND> host_grads(NR_LAYER + 1);
+        // filter grads need the conv inputs, so both the conv outputs and the
+        // squares are used in backward
+        out_spec.emplace_back(
+                make_callback_copy(cg::grad(loss, x), host_grads[0]));
+        for (size_t i = 0; i < NR_LAYER; ++i) {
+            out_spec.emplace_back(make_callback_copy(cg::grad(loss, ws[i]),
+                                                     host_grads[i + 1]));
+        }
+        auto func = graph->compile(out_spec);
+        size_t nr_conv = 0, nr_square = 0;
+        func->iter_opr_seq([&](cg::OperatorNodeBase* opr) {
+            if (opr->same_type<opr::Convolution>()) {
+                ++nr_conv;
+            } else if (opr->same_type<opr::Elemwise>() &&
+                       opr->cast_final<opr::Elemwise>().param().mode ==
+                               opr::Elemwise::Mode::MUL &&
+                       opr->input(0) == opr->input(1)) {
+                ++nr_square;
+            }
+            return true;
+        });
+        func->execute();
+        auto&& modifier = static_cast<cg::ComputingGraphImpl*>(graph.get())
+                                  ->seq_modifier_for_sublinear_memory();
+        return std::make_tuple(modifier.prev_min_bottleneck().at(cn),
+                               nr_conv - NR_LAYER, nr_square - NR_LAYER);
+    };
+
+    auto min_rst = run(0);
+    auto full_rst = run(std::numeric_limits<size_t>::max());
+    ASSERT_EQ(0u, std::get<1>(full_rst));
+    ASSERT_EQ(0u, std::get<2>(full_rst));
+    ASSERT_GT(std::get<0>(full_rst), std::get<0>(min_rst));
+
+    size_t budget = (std::get<0>(min_rst) + std::get<0>(full_rst)) / 2;
+    auto rst = run(budget);
+    ASSERT_LE(std::get<0>(rst), budget);
+    ASSERT_GT(std::get<2>(rst), 0u);
+    ASSERT_LT(std::get<1>(rst), std::get<2>(rst));
+}
+
 #else
 #pragma message "tests are disabled as Sublinear is not enabled."
 #endif  // MGB_ENABLE_SUBLINEAR
@@ -0,0 +1,134 @@
+/**
+ * \file src/core/test/utils/mmap_persistent_cache.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "megbrain/utils/mmap_persistent_cache.h"
+#include "megbrain/test/helper.h"
+
+#ifndef WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace mgb;
+
+namespace {
+using Blob = PersistentCache::Blob;
+
+Blob make_blob(const std::string& s) {
+    return {s.data(), s.size()};
+}
+
+std::string get_str(PersistentCache& cache, const std::string& category,
+                    const std::string& key) {
+    auto val = cache.get(category, make_blob(key));
+    if (!val.valid())
+        return "<none>";
+    return {static_cast<const char*>(val->ptr), val->size};
+}
+
+std::string make_cache_file(const char* name) {
+    auto fpath = output_file(name);
+    unlink(fpath.c_str());
+    return fpath;
+}
+}  // anonymous namespace
+
+TEST(TestMmapPersistentCache, Basic) {
+    auto fpath = make_cache_file("mmap_persistent_cache_basic.bin");
+    {
+        MmapPersistentCache cache{fpath, 4096, 4};
+        ASSERT_EQ("<none>", get_str(cache, "c0", "k0"));
+        cache.put("c0", make_blob("k0"), make_blob("v0"));
+        cache.put("c1", make_blob("k0"), make_blob("v1"));
+        cache.put("c0", make_blob("k1"), make_blob(""));
+        ASSERT_EQ("v0", get_str(cache, "c0", "k0"));
+        ASSERT_EQ("v1", get_str(cache, "c1", "k0"));
+        ASSERT_EQ("", get_str(cache, "c0", "k1"));
+        ASSERT_EQ("<none>", get_str(cache, "c1", "k1"));
+        ASSERT_EQ(3u, cache.nr_entry());
+
+        // putting the same value again is a no-op
+        cache.put("c0", make_blob("k0"), make_blob("v0"));
+        ASSERT_EQ(3u, cache.nr_entry());
+
+        // a new value shadows the old one
+        cache.put("c0", make_blob("k0"), make_blob("v2"));
+        ASSERT_EQ("v2", get_str(cache, "c0", "k0"));
+        ASSERT_EQ(4u, cache.nr_entry());
+    }
+
+    // capacity and bucket number are ignored for existing files
+    MmapPersistentCache cache{fpath, 1, 1};
+    ASSERT_EQ(4096u, cache.capacity());
+    ASSERT_EQ("v2", get_str(cache, "c0", "k0"));
+    ASSERT_EQ("v1", get_str(cache, "c1", "k0"));
+    ASSERT_EQ(4u, cache.nr_entry());
+}
+
+TEST(TestMmapPersistentCache, Full) {
+    auto fpath = make_cache_file("mmap_persistent_cache_full.bin");
+    MmapPersistentCache cache{fpath, 256, 16};
+    std::string val(64, 'x');
+    size_t nr_put = 0;
+    while (cache.used_size() + 128 <= cache.capacity()) {
+        cache.put("c", make_blob(std::to_string(nr_put++)), make_blob(val));
+    }
+    auto used = cache.used_size();
+    cache.put("c", make_blob("overflow"), make_blob(val));
+    ASSERT_EQ(used, cache.used_size());
+    ASSERT_EQ("<none>", get_str(cache, "c", "overflow"));
+    for (size_t i = 0; i < nr_put; ++i) {
+        ASSERT_EQ(val, get_str(cache, "c", std::to_string(i)));
+    }
+}
+
+TEST(TestMmapPersistentCache, MultiProcess) {
+    auto fpath = make_cache_file("mmap_persistent_cache_mp.bin");
+    constexpr int NR_PROC = 4, NR_KEY = 100;
+    MmapPersistentCache cache{fpath, 1 << 20, 64};
+
+    std::vector<pid_t> children;
+    for (int proc = 0; proc < NR_PROC; ++proc) {
+        auto pid = fork();
+        ASSERT_GE(pid, 0);
+        if (!pid) {
+            MmapPersistentCache child_cache{fpath};
+            for (int i = 0; i < NR_KEY; ++i) {
+                auto key = std::to_string(i);
+                child_cache.put(std::to_string(proc), make_blob(key),
+                                make_blob(key + "@" + std::to_string(proc)));
+                // keys put by all processes are the same
+                child_cache.put("shared", make_blob(key), make_blob(key));
+            }
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    for (auto pid : children) {
+        int status;
+        ASSERT_EQ(pid, waitpid(pid, &status, 0));
+        ASSERT_TRUE(WIFEXITED(status) && !WEXITSTATUS(status));
+    }
+
+    // results put by other processes are visible without reopening
+    for (int proc = 0; proc < NR_PROC; ++proc) {
+        for (int i = 0; i < NR_KEY; ++i) {
+            auto key = std::to_string(i);
+            ASSERT_EQ(key + "@" + std::to_string(proc),
+                      get_str(cache, std::to_string(proc), key));
+            ASSERT_EQ(key, get_str(cache, "shared", key));
+        }
+    }
+    ASSERT_EQ(size_t(NR_PROC * NR_KEY + NR_KEY), cache.nr_entry());
+}
+
+#endif  // WIN32
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -0,0 +1,128 @@
+/**
+ * \file src/core/test/utils/trace_recorder.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+#include "megbrain/utils/trace_recorder.h"
+#include "megbrain/utils/thread_pool.h"
+#include "megbrain/test/helper.h"
+
+#include <algorithm>
+#include <thread>
+
+#if MGB_HAVE_THREAD
+using namespace mgb;
+
+TEST(TestTraceRecorder, ThreadPoolTask) {
+    using TR = TraceRecorder;
+    auto&& recorder = TR::inst();
+    ThreadPool thread_pool{4};
+    constexpr size_t NR_TASK = 20;
+    recorder.collect(true);
+
+    recorder.activate();
+    thread_pool.active();
+    thread_pool.add_task({[](size_t, size_t) {}, NR_TASK});
+    thread_pool.deactive();
+    recorder.deactivate();
+    // not recorded after deactivate
+    TR::record(TR::Type::THREAD_POOL_TASK, TR::Phase::BEGIN, NR_TASK);
+
+    std::vector<int> nr_begin(NR_TASK), nr_end(NR_TASK);
+    auto time_base = recorder.time_base();
+    for (auto&& thread : recorder.collect(true)) {
+        ASSERT_EQ(0u, thread.nr_dropped);
+        double prev_time = -1e100;
+        for (auto&& rec : thread.records) {
+            if (rec.type != TR::Type::THREAD_POOL_TASK) {
+                continue;
+            }
+            ASSERT_LT(rec.id, NR_TASK);
+            if (rec.phase == TR::Phase::BEGIN) {
+                ++nr_begin[rec.id];
+            } else {
+                ASSERT_EQ(TR::Phase::END, rec.phase);
+                ++nr_end[rec.id];
+            }
+            auto time = time_base.to_nsec(rec.tsc);
+            ASSERT_GE(time, prev_time);
+            prev_time = time;
+        }
+    }
+    for (size_t i = 0; i < NR_TASK; ++i) {
+        ASSERT_EQ(1, nr_begin[i]);
+        ASSERT_EQ(1, nr_end[i]);
+    }
+}
+
+TEST(TestTraceRecorder, Overflow) {
+    using TR = TraceRecorder;
+    auto&& recorder = TR::inst();
+    recorder.collect(true);
+    recorder.buffer_size(16);
+    recorder.activate();
+    std::thread worker{[]() {
+        for (size_t i = 0; i < 100; ++i) {
+            TR::record(TR::Type::ALLOC, TR::Phase::INSTANT, i, i * 2);
+        }
+    }};
+    worker.join();
+    recorder.deactivate();
+    recorder.buffer_size(1 << 16);
+
+    bool found = false;
+    for (auto&& thread : recorder.collect(true)) {
+        if (thread.nr_dropped) {
+            ASSERT_FALSE(found);
+            found = true;
+            ASSERT_EQ(84u, thread.nr_dropped);
+            ASSERT_EQ(16u, thread.records.size());
+            for (size_t i = 0; i < 16; ++i) {
+                ASSERT_EQ(84 + i, thread.records[i].id);
+                ASSERT_EQ((84 + i) * 2, thread.records[i].arg);
+            }
+        }
+    }
+    ASSERT_TRUE(found);
+}
+
+TEST(TestTraceRecorder, ThreadExit) {
+    using TR = TraceRecorder;
+    auto&& recorder = TR::inst();
+    recorder.collect(true);
+    recorder.activate();
+    constexpr size_t NR_THREAD = 4;
+    for (size_t i = 0; i < NR_THREAD; ++i) {
+        std::thread worker{[i]() {
+            TR::record(TR::Type::ALLOC, TR::Phase::INSTANT, i, 0);
+        }};
+        worker.join();
+    }
+    recorder.deactivate();
+
+    auto get_ids = [&](bool clear) {
+        std::vector<uint64_t> ret;
+        for (auto&& thread : recorder.collect(clear)) {
+            for (auto&& rec : thread.records) {
+                if (rec.type == TR::Type::ALLOC) {
+                    ret.push_back(rec.id);
+                }
+            }
+        }
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    };
+    // records of exited threads are kept until cleared
+    std::vector<uint64_t> expect{0, 1, 2, 3};
+    ASSERT_EQ(expect, get_ids(false));
+    ASSERT_EQ(expect, get_ids(true));
+    ASSERT_TRUE(get_ids(true).empty());
+}
+#endif
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
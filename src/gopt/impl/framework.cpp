@@ -688,6 +688,9 @@ GraphOptimizer& GraphOptimizer::add_preset_passes(
 #endif
 
     if (inference_opt) {
+        if (inference_opt->fuse_image_preprocess) {
+            add_pass<FuseImagePreprocessPass>();
+        }
         if (inference_opt->fuse_conv_bias_nonlinearity)
             add_pass<FuseConvBiasNonlinPass>();
         if (inference_opt->fuse_conv_bias_with_z) {
@@ -697,8 +700,21 @@ GraphOptimizer& GraphOptimizer::add_preset_passes(
                        "first");
             add_pass<FuseConvBiasZPass>();
         }
+        if (inference_opt->fuse_conv_bias_epilogue) {
+            mgb_assert(inference_opt->fuse_conv_bias_nonlinearity,
+                       "fuse conv bias epilogue should fuse conv bias "
+                       "activation first");
+            add_pass<FuseConvBiasScaleShiftPass>();
+            // fuse the activation exposed by folding scale/shift
+            add_pass<FuseConvBiasNonlinPass>();
+            add_pass<FuseConvBiasPoolingPass>();
+        }
+        if (inference_opt->propagate_quantized_dtype) {
+            add_pass<QuantizedDTypePropagatePass>();
+        }
         if (inference_opt->use_nchw88) {
-            add_pass(EnableNchwxxPass::make_nchwxx_converter(8));
+            add_pass(EnableNchwxxPass::make_nchwxx_converter(
+                    8, inference_opt->select_nchw88_by_cost));
         }
         if (inference_opt->use_tensor_core) {
             mgb_assert(inference_opt->fuse_conv_bias_nonlinearity,
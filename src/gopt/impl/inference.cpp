@@ -1850,6 +1850,556 @@ void FuseConvBiasZPass::apply(OptState& state) const {
     rewriter.apply_inplace();
 }
 
+/* ================ FuseConvBiasScaleShiftPass ================ */
+const char* FuseConvBiasScaleShiftPass::name() const {
+    return "fold_scale_shift_into_conv_bias";
+}
+
+void FuseConvBiasScaleShiftPass::apply(OptState& state) const {
+    UniqReaderCheck uniq_reader_check{state.graph()};
+    ConstVarPropogate cvprop{ConstVarType::IMMUTABLE_AND_PARAM};
+
+    auto rewriter = state.graph().make_rewriter();
+    using Mode = opr::Elemwise::Param::Mode;
+    using NonlineMode = opr::ConvBias::Param::NonlineMode;
+    using Sparse = opr::ConvBias::Param::Sparse;
+
+    //! get the conv_bias producing inp if it can absorb an epilogue
+    auto get_conv_bias = [&](VarNode* inp) -> opr::ConvBias* {
+        auto cb = try_cast_as_op<opr::ConvBias>(
+                rewriter.get_var(inp)->owner_opr());
+        if (!cb || cb->input().size() > 3 || !uniq_reader_check(inp) ||
+            cb->param().nonlineMode != NonlineMode::IDENTITY ||
+            cb->param().format != opr::ConvBias::Param::Format::NCHW ||
+            cb->output(0)->dtype() != dtype::Float32()) {
+            return nullptr;
+        }
+        return cb;
+    };
+
+    //! whether var is a const per-channel (or scalar) float32 tensor
+    auto check_per_channel = [&](opr::ConvBias* cb, VarNode* var) -> bool {
+        if (!cvprop.is_const(var) || var->dtype() != dtype::Float32()) {
+            return false;
+        }
+        auto&& shp = var->shape();
+        if (shp.is_scalar()) {
+            return true;
+        }
+        size_t OC = cb->output(0)->shape()[1];
+        return shp.ndim == 4 && shp[0] == 1 && shp[1] == OC && shp[2] == 1 &&
+               shp[3] == 1;
+    };
+
+    //! scale the filter by a per-output-channel factor
+    auto scale_filter = [&](opr::ConvBias* cb, SymbolVar scale) -> SymbolVar {
+        SymbolVar filter = cb->input(1);
+        if (scale.shape().is_scalar()) {
+            return filter * scale;
+        }
+        auto&& fshp = filter.shape();
+        if (cb->param().sparse == Sparse::GROUP) {
+            return filter * scale.reshape({fshp[0], fshp[1], 1, 1, 1});
+        }
+        return filter * scale.reshape({fshp[0], 1, 1, 1});
+    };
+
+    auto get_nonline_mode = [](Mode mode) {
+        switch (mode) {
+            case Mode::FUSE_ADD_RELU:
+                return NonlineMode::RELU;
+            case Mode::FUSE_ADD_SIGMOID:
+                return NonlineMode::SIGMOID;
+            default:
+                return NonlineMode::IDENTITY;
+        }
+    };
+
+    /*!
+     * replace elem by conv_bias(x, w * scale, b * scale + shift); scale or
+     * shift may be null
+     */
+    auto replace = [&](opr::Elemwise* elem, opr::ConvBias* cb, VarNode* scale,
+                       VarNode* shift) {
+        SymbolVar filter = cb->input(1), bias;
+        if (cb->input().size() == 3) {
+            bias = cb->input(2);
+        }
+        if (scale) {
+            filter = scale_filter(cb, scale);
+            if (bias.node()) {
+                bias = bias * SymbolVar{scale};
+            }
+        }
+        if (shift) {
+            bias = bias.node() ? bias + SymbolVar{shift} : SymbolVar{shift};
+        }
+        auto param = cb->param();
+        param.nonlineMode = get_nonline_mode(elem->param().mode);
+        VarNode* new_var;
+        if (bias.node()) {
+            size_t OC = cb->output(0)->shape()[1];
+            if (bias.shape().is_scalar()) {
+                bias = bias.broadcast({1, OC, 1, 1});
+            }
+            new_var = opr::ConvBias::make(cb->input(0), filter, bias, param,
+                                          cb->execution_policy(), cb->config())
+                              .node();
+        } else {
+            new_var = opr::ConvBias::make(cb->input(0), filter, param,
+                                          cb->execution_policy(), cb->config())
+                              .node();
+        }
+        rewriter.replace_var(
+                elem->output(0), new_var,
+                mgb_cstr_log("replace conv_bias(x, w, b) * scale + shift -> "
+                             "conv_bias(x, w * scale, b * scale + shift)"));
+        uniq_reader_check.update_on_opr_auto_replace(elem,
+                                                     new_var->owner_opr());
+    };
+
+    auto try_fuse = [&](OperatorNodeBase* opr) -> bool {
+        auto elem = try_cast_as_op<opr::Elemwise>(opr);
+        if (!elem) {
+            return false;
+        }
+        auto mode = elem->param().mode;
+        auto&& inp = elem->input();
+        if (inp.size() == 2 &&
+            (mode == Mode::MUL || mode == Mode::ADD ||
+             mode == Mode::FUSE_ADD_RELU || mode == Mode::FUSE_ADD_SIGMOID)) {
+            for (size_t i = 0; i < 2; ++i) {
+                auto cb = get_conv_bias(inp[i]);
+                if (cb && check_per_channel(cb, inp[1 - i])) {
+                    auto other = rewriter.get_var(inp[1 - i]);
+                    if (mode == Mode::MUL) {
+                        replace(elem, cb, other, nullptr);
+                    } else {
+                        replace(elem, cb, nullptr, other);
+                    }
+                    return true;
+                }
+            }
+        } else if (inp.size() == 3 && mode == Mode::FUSE_MUL_ADD3) {
+            for (size_t i = 0; i < 2; ++i) {
+                auto cb = get_conv_bias(inp[i]);
+                if (cb && check_per_channel(cb, inp[1 - i]) &&
+                    check_per_channel(cb, inp[2])) {
+                    replace(elem, cb, rewriter.get_var(inp[1 - i]),
+                            rewriter.get_var(inp[2]));
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+
+    auto on_opr = [&](OperatorNodeBase* opr) {
+        cvprop.add_opr(opr);
+        if (try_fuse(opr))
+            return;
+        auto new_opr = rewriter.auto_replace_outputs(opr);
+        uniq_reader_check.update_on_opr_auto_replace(opr, new_opr);
+    };
+    state.graph().iter(on_opr);
+
+    rewriter.apply_inplace();
+}
+
+/* ================ FuseConvBiasPoolingPass ================ */
+const char* FuseConvBiasPoolingPass::name() const {
+    return "combine_conv_bias_and_pooling";
+}
+
+void FuseConvBiasPoolingPass::apply(OptState& state) const {
+    UniqReaderCheck uniq_reader_check{state.graph()};
+
+    auto rewriter = state.graph().make_rewriter();
+    using CBParam = opr::ConvBias::Param;
+    using PoolMode = opr::Pooling::Param::Mode;
+    using CPParam = opr::ConvPooling::Param;
+
+    auto check_conv_bias = [&](opr::ConvBias* cb) -> bool {
+        auto&& param = cb->param();
+        if (param.format != CBParam::Format::NCHW ||
+            param.sparse != CBParam::Sparse::DENSE || param.dilate_h != 1 ||
+            param.dilate_w != 1 || cb->input().size() > 3 ||
+            param.nonlineMode == CBParam::NonlineMode::H_SWISH) {
+            return false;
+        }
+        for (auto i : cb->input()) {
+            if (i->dtype() != dtype::Float32())
+                return false;
+        }
+        if (cb->output(0)->dtype() != dtype::Float32() ||
+            cb->output(0)->comp_node().device_type() !=
+                    CompNode::DeviceType::CPU) {
+            return false;
+        }
+        if (cb->input().size() == 3) {
+            auto&& bshp = cb->input(2)->shape();
+            size_t OC = cb->output(0)->shape()[1];
+            return bshp.ndim == 4 && bshp[0] == 1 && bshp[1] == OC &&
+                   bshp[2] == 1 && bshp[3] == 1;
+        }
+        return true;
+    };
+
+    auto check_pooling = [](opr::Pooling* pool) -> bool {
+        auto&& param = pool->param();
+        return param.format == opr::Pooling::Param::Format::NCHW &&
+               (param.mode == PoolMode::MAX || param.mode == PoolMode::AVERAGE);
+    };
+
+    auto make_param = [](const CBParam& cb, const opr::Pooling::Param& pool) {
+        CPParam param;
+        param.convMode = cb.mode == CBParam::Mode::CONVOLUTION
+                                 ? CPParam::ConvMode::CONVOLUTION
+                                 : CPParam::ConvMode::CROSS_CORRELATION;
+        param.poolMode = pool.mode == PoolMode::MAX ? CPParam::PoolMode::MAX
+                                                    : CPParam::PoolMode::AVERAGE;
+        param.nonlineMode =
+                cb.nonlineMode == CBParam::NonlineMode::RELU
+                        ? CPParam::NonlineMode::RELU
+                        : cb.nonlineMode == CBParam::NonlineMode::SIGMOID
+                                  ? CPParam::NonlineMode::SIGMOID
+                                  : CPParam::NonlineMode::IDENTITY;
+        param.pool_shape_h = pool.window_h;
+        param.pool_shape_w = pool.window_w;
+        param.pool_stride_h = pool.stride_h;
+        param.pool_stride_w = pool.stride_w;
+        param.pool_pad_h = pool.pad_h;
+        param.pool_pad_w = pool.pad_w;
+        param.conv_stride_h = cb.stride_h;
+        param.conv_stride_w = cb.stride_w;
+        param.conv_pad_h = cb.pad_h;
+        param.conv_pad_w = cb.pad_w;
+        return param;
+    };
+
+    auto on_opr = [&](OperatorNodeBase* opr) {
+        if (auto pool = try_cast_as_op<opr::Pooling>(opr)) {
+            auto cb = try_cast_as_op<opr::ConvBias>(
+                    rewriter.get_var(pool->input(0))->owner_opr());
+            if (cb && uniq_reader_check(pool->input(0)) &&
+                check_conv_bias(cb) && check_pooling(pool)) {
+                SymbolVar bias;
+                if (cb->input().size() == 3) {
+                    bias = cb->input(2);
+                } else {
+                    size_t OC = cb->output(0)->shape()[1];
+                    bias = SymbolVar{cb->output(0)}
+                                   .make_scalar(0.f)
+                                   .broadcast({1, OC, 1, 1});
+                }
+                auto new_var =
+                        opr::ConvPooling::make(
+                                cb->input(0), cb->input(1), bias,
+                                make_param(cb->param(), pool->param()),
+                                cb->config())
+                                .node();
+                rewriter.replace_var(
+                        opr->output(0), new_var,
+                        mgb_cstr_log("replace pooling(conv_bias(x, w, b)) -> "
+                                     "conv_pooling(x, w, b)"));
+                uniq_reader_check.update_on_opr_auto_replace(
+                        opr, new_var->owner_opr());
+                return;
+            }
+        }
+        auto new_opr = rewriter.auto_replace_outputs(opr);
+        uniq_reader_check.update_on_opr_auto_replace(opr, new_opr);
+    };
+    state.graph().iter(on_opr);
+
+    rewriter.apply_inplace();
+}
+
+/* ================ FuseImagePreprocessPass ================ */
+const char* FuseImagePreprocessPass::name() const {
+    return "fuse_image_preprocess";
+}
+
+void FuseImagePreprocessPass::apply(OptState& state) const {
+    UniqReaderCheck uniq_reader_check{state.graph()};
+    ConstVarPropogate cvprop{ConstVarType::IMMUTABLE_AND_PARAM};
+
+    auto rewriter = state.graph().make_rewriter();
+    using Param = opr::ImagePreprocess::Param;
+    using ColorMode = Param::ColorMode;
+    using CvtMode = opr::CvtColor::Param::Mode;
+    using Mode = opr::Elemwise::Param::Mode;
+
+    /*!
+     * a var of the original graph that equals
+     * affine(resize(cvt_color(src))) in NHWC or NCHW layout, i.e. the
+     * output of an ImagePreprocess opr when in NCHW
+     */
+    struct Chain {
+        //! uint8 NHWC src in the new graph
+        VarNode* src;
+        Param param;
+        size_t nr_channels;
+        bool nhwc;
+        //! Uint8 if the chain is not converted to float yet
+        DType dtype;
+        //! per-channel scale and bias in the new graph, of shape (C,)
+        SymbolVar scale, bias;
+    };
+    ThinHashMap<VarNode*, Chain> chains;
+
+    auto get_color_mode = [](CvtMode mode, ColorMode& ret) {
+        switch (mode) {
+            case CvtMode::RGB2BGR:
+            case CvtMode::BGR2RGB:
+                ret = ColorMode::SWAP_RB;
+                return true;
+#define cb(_mode)               \
+    case CvtMode::_mode:        \
+        ret = ColorMode::_mode; \
+        return true;
+            cb(YUV2RGB_NV21);
+            cb(YUV2BGR_NV21);
+            cb(YUV2RGB_NV12);
+            cb(YUV2BGR_NV12);
+            cb(YUV2RGB_YV12);
+            cb(YUV2BGR_YV12);
+            cb(YUV2RGB_YU12);
+            cb(YUV2BGR_YU12);
+#undef cb
+            default:
+                return false;
+        }
+    };
+
+    //! whether shape of a uint8 NHWC image is supported by the color mode
+    auto check_src_shape = [](const TensorShape& shp, ColorMode mode) {
+        if (shp.ndim != 4) {
+            return false;
+        }
+        if (mode == ColorMode::NONE) {
+            return shp[3] <= 4;
+        }
+        if (mode == ColorMode::SWAP_RB) {
+            return shp[3] == 3;
+        }
+        return shp[3] == 1 && shp[1] % 3 == 0 && shp[1] / 3 % 2 == 0 &&
+               shp[2] % 2 == 0;
+    };
+
+    /*!
+     * walk back from a uint8 NHWC var through Resize and CvtColor that are
+     * only read by the chain, and make a chain with identity affine transform
+     */
+    auto make_base_chain = [&](VarNode* var, Chain& chain) -> bool {
+        auto&& shp = var->shape();
+        if (var->dtype() != dtype::Uint8() || shp.ndim != 4) {
+            return false;
+        }
+        chain.param = {};
+        chain.nr_channels = shp[3];
+        VarNode* src = var;
+        if (auto resize = try_cast_as_op<opr::Resize>(src->owner_opr())) {
+            auto&& rp = resize->param();
+            if (uniq_reader_check(src) &&
+                rp.format == opr::Resize::Param::Format::NHWC &&
+                (rp.imode == Param::InterpolationMode::LINEAR ||
+                 rp.imode == Param::InterpolationMode::NEAREST) &&
+                cvprop.is_const(resize->input(1))) {
+                chain.param.imode = rp.imode;
+                chain.param.out_height = shp[1];
+                chain.param.out_width = shp[2];
+                src = resize->input(0);
+            }
+        }
+        if (auto cvt = try_cast_as_op<opr::CvtColor>(src->owner_opr())) {
+            ColorMode mode;
+            if (uniq_reader_check(src) &&
+                get_color_mode(cvt->param().mode, mode) &&
+                check_src_shape(cvt->input(0)->shape(), mode)) {
+                chain.param.color_mode = mode;
+                src = cvt->input(0);
+            }
+        }
+        if (!check_src_shape(src->shape(), chain.param.color_mode)) {
+            return false;
+        }
+        size_t C = chain.nr_channels;
+        SymbolVar new_src = rewriter.get_var(src);
+        chain.src = new_src.node();
+        chain.nhwc = true;
+        chain.dtype = dtype::Uint8();
+        chain.scale = new_src.make_scalar(1.f).broadcast({C});
+        chain.bias = new_src.make_scalar(0.f).broadcast({C});
+        return true;
+    };
+
+    auto get_chain = [&](VarNode* var) -> Chain* {
+        auto iter = chains.find(var);
+        if (iter == chains.end() || !uniq_reader_check(var)) {
+            return nullptr;
+        }
+        return &iter->second;
+    };
+
+    //! convert a const scalar or per-channel operand to shape (C,)
+    auto get_channel_vec = [&](const Chain& chain, VarNode* var) -> SymbolVar {
+        if (!cvprop.is_const(var) || var->dtype() != dtype::Float32()) {
+            return {};
+        }
+        auto&& shp = var->shape();
+        size_t C = chain.nr_channels;
+        SymbolVar new_var = rewriter.get_var(var);
+        if (shp.total_nr_elems() == 1 && shp.ndim <= 4) {
+            return new_var.reshape({1}).broadcast({C});
+        }
+        bool ok;
+        if (chain.nhwc) {
+            ok = (shp.ndim == 1 && shp[0] == C) ||
+                 (shp.ndim == 4 && shp[0] == 1 && shp[1] == 1 &&
+                  shp[2] == 1 && shp[3] == C);
+        } else {
+            ok = shp.ndim == 4 && shp[0] == 1 && shp[1] == C && shp[2] == 1 &&
+                 shp[3] == 1;
+        }
+        return ok ? new_var.reshape({C}) : SymbolVar{};
+    };
+
+    //! compute the chain of an opr output from the chains of its inputs
+    auto try_extend = [&](OperatorNodeBase* opr, Chain& chain) -> bool {
+        if (auto tc = try_cast_as_op<opr::TypeCvt>(opr)) {
+            auto inp = opr->input(0);
+            DType dst_dtype = tc->output(0)->dtype();
+            if (inp->dtype() == dtype::Uint8() &&
+                dst_dtype == dtype::Float32()) {
+                if (auto prev = get_chain(inp)) {
+                    chain = *prev;
+                } else if (!make_base_chain(inp, chain)) {
+                    return false;
+                }
+                chain.dtype = dst_dtype;
+                return true;
+            }
+            auto prev = get_chain(inp);
+            if (prev && prev->dtype == dtype::Float32() &&
+                dst_dtype.enumv() == DTypeEnum::QuantizedS8) {
+                chain = *prev;
+                chain.dtype = dst_dtype;
+                return true;
+            }
+            return false;
+        }
+        if (auto shuffle = try_cast_as_op<opr::Dimshuffle>(opr)) {
+            auto&& param = shuffle->param();
+            if (param.pattern_len != 4 || param.pattern[0] != 0 ||
+                param.pattern[1] != 3 || param.pattern[2] != 1 ||
+                param.pattern[3] != 2) {
+                return false;
+            }
+            auto inp = opr->input(0);
+            if (auto prev = get_chain(inp)) {
+                if (!prev->nhwc) {
+                    return false;
+                }
+                chain = *prev;
+            } else if (!make_base_chain(inp, chain)) {
+                return false;
+            }
+            chain.nhwc = false;
+            return true;
+        }
+        auto elem = try_cast_as_op<opr::Elemwise>(opr);
+        if (!elem || elem->input().size() < 2) {
+            return false;
+        }
+        auto mode = elem->param().mode;
+        auto&& inp = elem->input();
+        for (size_t i = 0; i < 2; ++i) {
+            auto prev = get_chain(inp[i]);
+            if (!prev || prev->dtype != dtype::Float32()) {
+                continue;
+            }
+            SymbolVar k = get_channel_vec(*prev, inp[1 - i]);
+            if (!k.node()) {
+                continue;
+            }
+            chain = *prev;
+            if (inp.size() == 2) {
+                switch (mode) {
+                    case Mode::ADD:
+                        chain.bias = chain.bias + k;
+                        return true;
+                    case Mode::SUB:
+                        if (i == 0) {
+                            chain.bias = chain.bias - k;
+                        } else {
+                            chain.scale = -chain.scale;
+                            chain.bias = k - chain.bias;
+                        }
+                        return true;
+                    case Mode::MUL:
+                        chain.scale = chain.scale * k;
+                        chain.bias = chain.bias * k;
+                        return true;
+                    case Mode::TRUE_DIV:
+                        if (i != 0) {
+                            return false;
+                        }
+                        chain.scale = chain.scale / k;
+                        chain.bias = chain.bias / k;
+                        return true;
+                    default:
+                        return false;
+                }
+            }
+            if (inp.size() == 3 && mode == Mode::FUSE_MUL_ADD3) {
+                SymbolVar b = get_channel_vec(*prev, inp[2]);
+                if (!b.node()) {
+                    return false;
+                }
+                chain.scale = chain.scale * k;
+                chain.bias = chain.bias * k + b;
+                return true;
+            }
+            return false;
+        }
+        return false;
+    };
+
+    auto on_opr = [&](OperatorNodeBase* opr) {
+        cvprop.add_opr(opr);
+        Chain chain;
+        if (opr->output().size() == 1 && try_extend(opr, chain)) {
+            auto out = opr->output(0);
+            if (!chain.nhwc && chain.dtype != dtype::Uint8()) {
+                OperatorNodeConfig config;
+                if (chain.dtype != dtype::Float32()) {
+                    config.output_dtype(chain.dtype);
+                }
+                auto new_var = opr::ImagePreprocess::make(
+                                       chain.src, chain.scale, chain.bias,
+                                       chain.param, config)
+                                       .node();
+                mgb_assert(new_var->dtype() == out->dtype());
+                rewriter.replace_var(
+                        out, new_var,
+                        mgb_cstr_log("replace image preprocessing chain -> "
+                                     "image_preprocess"));
+                uniq_reader_check.update_on_opr_auto_replace(
+                        opr, new_var->owner_opr());
+                chains[out] = chain;
+                return;
+            }
+            chains[out] = chain;
+        }
+        auto new_opr = rewriter.auto_replace_outputs(opr);
+        uniq_reader_check.update_on_opr_auto_replace(opr, new_opr);
+    };
+    state.graph().iter(on_opr);
+
+    rewriter.apply_inplace();
+}
+
 /* ================ FuseDeconvCvtPass ================ */
 const char* FuseDeconvCvtPass::name() const {
     return "combine_deconv_and_typecvt";
@@ -1969,6 +2519,10 @@ public:
 
     LayoutType layout_type() const { return m_layout_type; }
 
+    //! shape of the output for given layout type and input shape
+    static TensorShape infer_shape(LayoutType layout_type,
+                                   const TensorShape& inp_shape);
+
 private:
     void init_output_static_infer_desc() override;
     void scn_do_execute() override;
@@ -1995,6 +2549,106 @@ void TensorReformatPass::RelayoutPlaceholder::init_output_comp_node() {
     output(0)->comp_node(input(0)->comp_node());
 }
 
+TensorShape TensorReformatPass::RelayoutPlaceholder::infer_shape(
+        LayoutType layout_type, const TensorShape& inp_shape) {
+    TensorShape dst = inp_shape;
+    if (layout_type == RelayoutPlaceholder::LayoutType::NCHW4_TO_NCHW32) {
+        mgb_assert(inp_shape.ndim == 5 && inp_shape[4] == 4);
+        dst[0] = inp_shape[0];
+        dst[1] = inp_shape[1] / 8;
+        dst[2] = inp_shape[2];
+        dst[3] = inp_shape[3];
+        dst[4] = inp_shape[4] * 8;
+    } else if (layout_type ==
+               RelayoutPlaceholder::LayoutType::NCHW32_TO_NCHW4) {
+        mgb_assert(inp_shape.ndim == 5 && inp_shape[4] == 32);
+        dst[0] = inp_shape[0];
+        dst[1] = inp_shape[1] * 8;
+        dst[2] = inp_shape[2];
+        dst[3] = inp_shape[3];
+        dst[4] = inp_shape[4] / 8;
+    } else if (layout_type ==
+               RelayoutPlaceholder::LayoutType::NCHW4_TO_CHWN4) {
+        mgb_assert(inp_shape.ndim == 5 && inp_shape[4] == 4);
+        dst[0] = inp_shape[1];
+        dst[1] = inp_shape[2];
+        dst[2] = inp_shape[3];
+        dst[3] = inp_shape[0];
+        dst[4] = inp_shape[4];
+    } else if (layout_type ==
+               RelayoutPlaceholder::LayoutType::CHWN4_TO_NCHW4) {
+        mgb_assert(inp_shape.ndim == 5 && inp_shape[4] == 4);
+        dst[0] = inp_shape[3];
+        dst[1] = inp_shape[0];
+        dst[2] = inp_shape[1];
+        dst[3] = inp_shape[2];
+        dst[4] = inp_shape[4];
+    } else if (layout_type ==
+               RelayoutPlaceholder::LayoutType::NCHW_TO_NCHW88) {
+        mgb_assert(inp_shape.ndim == 4 && inp_shape[1] % 8 == 0);
+        dst.ndim = 5;
+        dst[0] = inp_shape[0];
+        dst[1] = inp_shape[1] / 8;
+        dst[2] = inp_shape[2];
+        dst[3] = inp_shape[3];
+        dst[4] = 8;
+    } else if (layout_type ==
+               RelayoutPlaceholder::LayoutType::NCHW88_TO_NCHW) {
+        mgb_assert(inp_shape.ndim == 5 && inp_shape[4] == 8);
+        dst.ndim = 4;
+        dst[0] = inp_shape[0];
+        dst[1] = inp_shape[1] * 8;
+        dst[2] = inp_shape[2];
+        dst[3] = inp_shape[3];
+    } else if (layout_type == RelayoutPlaceholder::LayoutType::
+                                        WEIGHT_NCHW_TO_NCHW88_DENSE) {
+        mgb_assert(inp_shape.ndim == 4 && inp_shape[0] % 8 == 0 &&
+                   inp_shape[1] % 8 == 0);
+        dst.ndim = 6;
+        dst[0] = inp_shape[0] / 8;
+        dst[1] = inp_shape[1] / 8;
+        dst[2] = inp_shape[2];
+        dst[3] = inp_shape[3];
+        dst[4] = 8;
+        dst[5] = 8;
+    } else if (layout_type == RelayoutPlaceholder::LayoutType::
+                                        WEIGHT_NCHW_TO_NCHW88_GROUP) {
+        mgb_assert(inp_shape.ndim == 5 && inp_shape[1] % 8 == 0 &&
+                   inp_shape[2] % 8 == 0);
+        dst.ndim = 7;
+        dst[0] = inp_shape[0];
+        dst[1] = inp_shape[1] / 8;
+        dst[2] = inp_shape[2] / 8;
+        dst[3] = inp_shape[3];
+        dst[4] = inp_shape[4];
+        dst[5] = 8;
+        dst[6] = 8;
+    } else if (layout_type == RelayoutPlaceholder::LayoutType::
+                                        WEIGHT_NCHW_TO_NCHW88_CHAN) {
+        mgb_assert(inp_shape.ndim == 5 && inp_shape[1] == 1 &&
+                   inp_shape[2] == 1 && inp_shape[0] % 8 == 0);
+        dst.ndim = 6;
+        dst[0] = inp_shape[0] / 8;
+        dst[1] = inp_shape[1];
+        dst[2] = inp_shape[2];
+        dst[3] = inp_shape[3];
+        dst[4] = inp_shape[4];
+        dst[5] = 8;
+    } else {
+        mgb_assert(
+                layout_type ==
+                RelayoutPlaceholder::LayoutType::WEIGHT_HYBIRD_NCHW_NCHW88);
+        mgb_assert(inp_shape.ndim == 4 && inp_shape[0] % 8 == 0);
+        dst.ndim = 5;
+        dst[0] = inp_shape[0] / 8;
+        dst[1] = inp_shape[2];
+        dst[2] = inp_shape[3];
+        dst[3] = inp_shape[1];
+        dst[4] = 8;
+    }
+    return dst;
+}
+
 void TensorReformatPass::RelayoutPlaceholder::init_output_static_infer_desc() {
     using namespace cg::static_infer;
     auto&& mgr = owner_graph()->static_infer_manager();
@@ -2002,102 +2656,8 @@ void TensorReformatPass::RelayoutPlaceholder::init_output_static_infer_desc() {
     for (auto i : input())
         deps.push_back({i, DepType::SHAPE});
     auto infer_shape = [this](TensorShape& dst, const InpVal& inp) {
-        TensorShape inp_shape = inp.val[0].shape();
-        dst = inp_shape;
-        if (layout_type() == RelayoutPlaceholder::LayoutType::NCHW4_TO_NCHW32) {
-            mgb_assert(inp_shape.ndim == 5 && inp_shape[4] == 4);
-            dst[0] = inp_shape[0];
-            dst[1] = inp_shape[1] / 8;
-            dst[2] = inp_shape[2];
-            dst[3] = inp_shape[3];
-            dst[4] = inp_shape[4] * 8;
-        } else if (layout_type() ==
-                   RelayoutPlaceholder::LayoutType::NCHW32_TO_NCHW4) {
-            mgb_assert(inp_shape.ndim == 5 && inp_shape[4] == 32);
-            dst[0] = inp_shape[0];
-            dst[1] = inp_shape[1] * 8;
-            dst[2] = inp_shape[2];
-            dst[3] = inp_shape[3];
-            dst[4] = inp_shape[4] / 8;
-        } else if (layout_type() ==
-                   RelayoutPlaceholder::LayoutType::NCHW4_TO_CHWN4) {
-            mgb_assert(inp_shape.ndim == 5 && inp_shape[4] == 4);
-            dst[0] = inp_shape[1];
-            dst[1] = inp_shape[2];
-            dst[2] = inp_shape[3];
-            dst[3] = inp_shape[0];
-            dst[4] = inp_shape[4];
-        } else if (layout_type() ==
-                   RelayoutPlaceholder::LayoutType::CHWN4_TO_NCHW4) {
-            mgb_assert(inp_shape.ndim == 5 && inp_shape[4] == 4);
-            dst[0] = inp_shape[3];
-            dst[1] = inp_shape[0];
-            dst[2] = inp_shape[1];
-            dst[3] = inp_shape[2];
-            dst[4] = inp_shape[4];
-        } else if (layout_type() ==
-                   RelayoutPlaceholder::LayoutType::NCHW_TO_NCHW88) {
-            mgb_assert(inp_shape.ndim == 4 && inp_shape[1] % 8 == 0);
-            dst.ndim = 5;
-            dst[0] = inp_shape[0];
-            dst[1] = inp_shape[1] / 8;
-            dst[2] = inp_shape[2];
-            dst[3] = inp_shape[3];
-            dst[4] = 8;
-        } else if (layout_type() ==
-                   RelayoutPlaceholder::LayoutType::NCHW88_TO_NCHW) {
-            mgb_assert(inp_shape.ndim == 5 && inp_shape[4] == 8);
-            dst.ndim = 4;
-            dst[0] = inp_shape[0];
-            dst[1] = inp_shape[1] * 8;
-            dst[2] = inp_shape[2];
-            dst[3] = inp_shape[3];
-        } else if (layout_type() == RelayoutPlaceholder::LayoutType::
-                                            WEIGHT_NCHW_TO_NCHW88_DENSE) {
-            mgb_assert(inp_shape.ndim == 4 && inp_shape[0] % 8 == 0 &&
-                       inp_shape[1] % 8 == 0);
-            dst.ndim = 6;
-            dst[0] = inp_shape[0] / 8;
-            dst[1] = inp_shape[1] / 8;
-            dst[2] = inp_shape[2];
-            dst[3] = inp_shape[3];
-            dst[4] = 8;
-            dst[5] = 8;
-        } else if (layout_type() == RelayoutPlaceholder::LayoutType::
-                                            WEIGHT_NCHW_TO_NCHW88_GROUP) {
-            mgb_assert(inp_shape.ndim == 5 && inp_shape[1] % 8 == 0 &&
-                       inp_shape[2] % 8 == 0);
-            dst.ndim = 7;
-            dst[0] = inp_shape[0];
-            dst[1] = inp_shape[1] / 8;
-            dst[2] = inp_shape[2] / 8;
-            dst[3] = inp_shape[3];
-            dst[4] = inp_shape[4];
-            dst[5] = 8;
-            dst[6] = 8;
-        } else if (layout_type() == RelayoutPlaceholder::LayoutType::
-                                            WEIGHT_NCHW_TO_NCHW88_CHAN) {
-            mgb_assert(inp_shape.ndim == 5 && inp_shape[1] == 1 &&
-                       inp_shape[2] == 1 && inp_shape[0] % 8 == 0);
-            dst.ndim = 6;
-            dst[0] = inp_shape[0] / 8;
-            dst[1] = inp_shape[1];
-            dst[2] = inp_shape[2];
-            dst[3] = inp_shape[3];
-            dst[4] = inp_shape[4];
-            dst[5] = 8;
-        } else {
-            mgb_assert(
-                    layout_type() ==
-                    RelayoutPlaceholder::LayoutType::WEIGHT_HYBIRD_NCHW_NCHW88);
-            mgb_assert(inp_shape.ndim == 4 && inp_shape[0] % 8 == 0);
-            dst.ndim = 5;
-            dst[0] = inp_shape[0] / 8;
-            dst[1] = inp_shape[2];
-            dst[2] = inp_shape[3];
-            dst[3] = inp_shape[1];
-            dst[4] = 8;
-        }
+        dst = RelayoutPlaceholder::infer_shape(layout_type(),
+                                               inp.val[0].shape());
         return true;
     };
     mgr.register_shape_infer(output(0), {SourceType::DEP, deps, infer_shape});
@@ -2951,6 +3511,367 @@ std::unique_ptr<EnableCHWN4Pass> EnableCHWN4Pass::make_chwn4_converter() {
 }
 
 /* ================ EnableNchwxxPass =============== */
+namespace {
+//! s-t min cut solved by Dinic's algorithm, with node 0 as source
+class MinCutSolver {
+    struct Edge {
+        size_t to;
+        double cap;
+    };
+    std::vector<Edge> m_edges;
+    std::vector<std::vector<size_t>> m_adj;
+    std::vector<size_t> m_level, m_iter;
+
+    bool bfs(size_t sink) {
+        m_level.assign(m_adj.size(), SIZE_MAX);
+        std::vector<size_t> queue{0};
+        m_level[0] = 0;
+        for (size_t i = 0; i < queue.size(); ++i) {
+            size_t u = queue[i];
+            for (size_t e : m_adj[u]) {
+                auto&& edge = m_edges[e];
+                if (edge.cap > EPS && m_level[edge.to] == SIZE_MAX) {
+                    m_level[edge.to] = m_level[u] + 1;
+                    queue.push_back(edge.to);
+                }
+            }
+        }
+        return m_level[sink] != SIZE_MAX;
+    }
+
+    double dfs(size_t u, size_t sink, double flow) {
+        if (u == sink)
+            return flow;
+        for (size_t& i = m_iter[u]; i < m_adj[u].size(); ++i) {
+            size_t e = m_adj[u][i];
+            auto&& edge = m_edges[e];
+            if (edge.cap > EPS && m_level[edge.to] == m_level[u] + 1) {
+                double f = dfs(edge.to, sink, std::min(flow, edge.cap));
+                if (f > EPS) {
+                    m_edges[e].cap -= f;
+                    m_edges[e ^ 1].cap += f;
+                    return f;
+                }
+            }
+        }
+        return 0;
+    }
+
+public:
+    static constexpr double INF = 1e30, EPS = 1e-6;
+
+    size_t add_node() {
+        m_adj.emplace_back();
+        return m_adj.size() - 1;
+    }
+
+    void add_edge(size_t from, size_t to, double cap) {
+        m_adj[from].push_back(m_edges.size());
+        m_edges.push_back({to, cap});
+        m_adj[to].push_back(m_edges.size());
+        m_edges.push_back({from, 0});
+    }
+
+    //! compute the min cut and return whether each node is on the source side
+    std::vector<bool> solve(size_t sink) {
+        while (bfs(sink)) {
+            m_iter.assign(m_adj.size(), 0);
+            while (dfs(0, sink, INF) > EPS)
+                ;
+        }
+        bfs(sink);
+        std::vector<bool> ret(m_adj.size());
+        for (size_t i = 0; i < m_adj.size(); ++i) {
+            ret[i] = m_level[i] != SIZE_MAX;
+        }
+        return ret;
+    }
+};
+constexpr double MinCutSolver::INF, MinCutSolver::EPS;
+
+/*!
+ * Rough cost model of conv kernels on CPU, in units of the time to compute a
+ * flop at peak. A conv is bounded either by computation or by memory
+ * traffic; dense convs in nchw go through im2col + matmul whose efficiency
+ * drops for a small reduction size or few output channels, while nchwxx
+ * kernels vectorize over the packed channels directly.
+ *
+ * The constants are hand-picked estimates rather than measurements of any
+ * particular CPU: they only need to rank the two layouts of a conv and the
+ * relayouts between them, and are used only for the convs that have no
+ * profiled time in the AlgoChooser cache (see profiled_time()).
+ */
+namespace nchwxx_cost {
+//! peak flops per byte of memory bandwidth, typical of a core with 128-bit
+//! FMA units streaming from L2
+constexpr double BYTE_COST = 8;
+//! a relayout reads and writes the tensor with strided access
+constexpr double RELAYOUT_BYTE_COST = 4 * BYTE_COST;
+//! fraction of the peak reached by each kind of kernel; the nchwxx ones are
+//! the direct kernels on packed channels, the hybrid one reads unpacked src
+//! and the chanwise ones are bounded by the lack of reduction
+constexpr double EFF_NCHWXX_DENSE = 0.9, EFF_NCHWXX_HYBRID = 0.35,
+                 EFF_NCHWXX_CHAN = 0.5, EFF_NCHW_MATMUL = 0.7,
+                 EFF_NCHW_MIN = 0.15, EFF_NCHW_CHAN = 0.25;
+
+double tensor_bytes(const VarNode* var) {
+    return var->dtype().size(var->shape().total_nr_elems());
+}
+
+double relayout(const VarNode* var) {
+    return tensor_bytes(var) * RELAYOUT_BYTE_COST;
+}
+
+double conv(OperatorNodeBase* opr, bool chanwise, bool hybrid, bool nchwxx) {
+    auto&& dst = opr->output(0)->shape();
+    auto&& filter = opr->input(1)->shape();
+    bool group = filter.ndim == 5;
+    size_t ocpg = filter[group], icpg = filter[group + 1],
+           fh = filter[group + 2], fw = filter[group + 3];
+    double flops = 2.0 * dst.total_nr_elems() * icpg * fh * fw;
+    double eff;
+    if (chanwise) {
+        eff = nchwxx ? EFF_NCHWXX_CHAN : EFF_NCHW_CHAN;
+    } else if (nchwxx) {
+        eff = hybrid ? EFF_NCHWXX_HYBRID : EFF_NCHWXX_DENSE;
+    } else {
+        eff = EFF_NCHW_MATMUL * std::min(icpg * fh * fw / 128.0, 1.0) *
+              std::min(ocpg / 64.0, 1.0);
+        eff = std::max(eff, EFF_NCHW_MIN);
+    }
+    double bytes = tensor_bytes(opr->input(0)) + tensor_bytes(opr->input(1)) +
+                   tensor_bytes(opr->output(0));
+    return std::max(flops / eff, bytes * BYTE_COST);
+}
+
+/*!
+ * \brief fastest profiled time of a conv opr on given layouts, in nchw or
+ *      nchw88 format
+ *
+ * \return time in seconds, or a negative value if it has not been profiled
+ */
+template <class Opr>
+double profiled_time(const Opr& opr, const TensorLayoutArray& layouts,
+                     bool nchwxx) {
+    auto param = opr.param();
+    if (nchwxx) {
+        param.format = Opr::Param::Format::NCHW88;
+    }
+    AlgoChooserProfileCache::Key key{layouts.data(), layouts.size(), &param,
+                                     sizeof(param)};
+    auto&& rst = opr.profile_cache().get(key);
+    if (!rst.valid() || rst.val().empty()) {
+        return -1;
+    }
+    return rst.val()[0].time;
+}
+}  // namespace nchwxx_cost
+}  // anonymous namespace
+
+void EnableNchwxxPass::select_layout_by_cost(OptState& opt) const {
+    m_nchwxx_oprs.clear();
+    constexpr double INF = MinCutSolver::INF;
+    //! node 0 (source side) means nchw and node 1 (sink side) means nchwxx
+    MinCutSolver solver;
+    size_t src_node = solver.add_node(), sink_node = solver.add_node();
+    ThinHashMap<OperatorNodeBase*, size_t> opr2node;
+    std::vector<OperatorNodeBase*> oprs;
+    //! readers of each var that may run in nchwxx, and whether the var has a
+    //! reader requiring nchw
+    ThinHashMap<VarNode*, std::pair<std::vector<size_t>, bool>> var_readers;
+    std::vector<VarNode*> vars;
+    auto add_reader = [&](VarNode* var, size_t node, bool fixed_nchw) {
+        auto ins = var_readers.insert({var, {}});
+        if (ins.second) {
+            vars.push_back(var);
+        }
+        if (fixed_nchw) {
+            ins.first->second.second = true;
+        } else {
+            ins.first->second.first.push_back(node);
+        }
+    };
+    auto is_nchwxx_shape = [this](const VarNode* var) {
+        auto&& shp = var->shape();
+        return shp.ndim == 4 && shp[1] % m_pack_c_size == 0;
+    };
+
+    using LayoutType = RelayoutPlaceholder::LayoutType;
+    //! replace the modeled costs of a conv by its profiled times if both
+    //! layouts are in the AlgoChooser cache; the times are scaled to keep the
+    //! sum of the two costs, so that they stay comparable with the modeled
+    //! relayout costs
+    auto use_profiled_time = [](OperatorNodeBase* opr, LayoutType weight_mode,
+                                bool hybrid, double& cost_nchw,
+                                double& cost_nchwxx) {
+        TensorLayoutArray layouts;
+        for (auto i : opr->input()) {
+            //! the cache only indexes layouts of the default format
+            if (!i->format().is_default()) {
+                return;
+            }
+            layouts.emplace_back(i->shape(), i->dtype(), i->format());
+        }
+        auto conv_bias = try_cast_as_op<opr::ConvBiasForward>(opr);
+        if (conv_bias) {
+            if (layouts.size() < 3) {
+                DType dtype;
+                conv_bias->megdnn_opr()->deduce_dtype(
+                        layouts[0].dtype, layouts[1].dtype, DType{}, DType{},
+                        dtype);
+                layouts.emplace_back(TensorShape{}, dtype);
+            }
+            if (layouts.size() < 4) {
+                layouts.emplace_back(TensorShape{}, opr->output(0)->dtype(),
+                                     opr->output(0)->format());
+            }
+        }
+        layouts.emplace_back(opr->output(0)->shape(), opr->output(0)->dtype(),
+                             opr->output(0)->format());
+        TensorLayoutArray layouts_nchwxx = layouts;
+        for (size_t i = 0; i < layouts.size(); ++i) {
+            LayoutType mode = LayoutType::NCHW_TO_NCHW88;
+            if (i == 1) {
+                mode = weight_mode;
+            } else if (layouts[i].ndim != 4 || (i == 0 && hybrid)) {
+                continue;
+            }
+            layouts_nchwxx[i] = {
+                    RelayoutPlaceholder::infer_shape(mode, layouts[i]),
+                    layouts[i].dtype, layouts[i].format};
+        }
+        double t_nchw, t_nchwxx;
+        if (conv_bias) {
+            t_nchw = nchwxx_cost::profiled_time(*conv_bias, layouts, false);
+            t_nchwxx = nchwxx_cost::profiled_time(*conv_bias, layouts_nchwxx,
+                                                  true);
+        } else {
+            auto&& conv = opr->cast_final_safe<opr::ConvolutionForward>();
+            t_nchw = nchwxx_cost::profiled_time(conv, layouts, false);
+            t_nchwxx = nchwxx_cost::profiled_time(conv, layouts_nchwxx, true);
+        }
+        if (t_nchw > 0 && t_nchwxx > 0) {
+            double scale = (cost_nchw + cost_nchwxx) / (t_nchw + t_nchwxx);
+            cost_nchw = t_nchw * scale;
+            cost_nchwxx = t_nchwxx * scale;
+        }
+    };
+
+    //! relayouts of const vars are folded by ParamFusePass, so they cost
+    //! nothing at runtime
+    ConstVarPropogate cvprop{ConstVarType::IMMUTABLE_AND_PARAM};
+
+    opt.graph().iter([&](OperatorNodeBase* opr) {
+        cvprop.add_opr(opr);
+        size_t node = solver.add_node();
+        opr2node[opr] = node;
+        oprs.push_back(opr);
+
+        double cost_nchw = 0, cost_nchwxx = INF;
+        bool hybrid = false;
+        auto typeinfo = opr->dyn_typeinfo();
+        if (typeinfo == opr::ConvolutionForward::typeinfo() ||
+            typeinfo == opr::ConvBiasForward::typeinfo()) {
+            auto trans = m_conv_trans_type(opr);
+            if (trans != TransType::TRANS_NONE) {
+                hybrid = trans == TransType::TRANS_HYBIRD_NCHWXX;
+                auto&& filter = opr->input(1)->shape();
+                bool chanwise = filter.ndim == 5 && filter[1] == 1 &&
+                                filter[2] == 1;
+                cost_nchw = nchwxx_cost::conv(opr, chanwise, hybrid, false);
+                cost_nchwxx = nchwxx_cost::conv(opr, chanwise, hybrid, true);
+                auto weight_mode = LayoutType::WEIGHT_NCHW_TO_NCHW88_GROUP;
+                if (hybrid) {
+                    weight_mode = LayoutType::WEIGHT_HYBIRD_NCHW_NCHW88;
+                } else if (filter.ndim == 4) {
+                    weight_mode = LayoutType::WEIGHT_NCHW_TO_NCHW88_DENSE;
+                } else if (chanwise) {
+                    weight_mode = LayoutType::WEIGHT_NCHW_TO_NCHW88_CHAN;
+                }
+                use_profiled_time(opr, weight_mode, hybrid, cost_nchw,
+                                  cost_nchwxx);
+            }
+        } else if (typeinfo == opr::PoolingForward::typeinfo()) {
+            if (is_nchwxx_shape(opr->input(0))) {
+                cost_nchwxx = 0;
+            }
+        } else if (typeinfo == opr::Elemwise::typeinfo() ||
+                   typeinfo == opr::TypeCvt::typeinfo() ||
+                   typeinfo == opr::ElemwiseMultiType::typeinfo() ||
+                   typeinfo == opr::PowC::typeinfo()) {
+            bool ok = is_nchwxx_shape(opr->output(0));
+            for (auto i : opr->input()) {
+                ok &= is_nchwxx_shape(i) || i->shape().is_scalar();
+            }
+            if (ok) {
+                cost_nchwxx = 0;
+            }
+        }
+        solver.add_edge(src_node, node, cost_nchwxx);
+        solver.add_edge(node, sink_node, cost_nchw);
+
+        bool can_nchwxx = cost_nchwxx < INF;
+        bool is_conv = typeinfo == opr::ConvolutionForward::typeinfo() ||
+                       typeinfo == opr::ConvBiasForward::typeinfo();
+        for (size_t i = 0; i < opr->input().size(); ++i) {
+            auto inp = opr->input(i);
+            //! only the feature maps of conv (src and bias) change layout
+            if (inp->shape().ndim != 4 || (is_conv && i == 1) ||
+                cvprop.is_const(inp)) {
+                continue;
+            }
+            add_reader(inp, node, !can_nchwxx || (is_conv && i == 0 && hybrid));
+        }
+    });
+    for (auto&& var : opt.graph().endpoint_vars()) {
+        if (var.shape().ndim == 4 && !cvprop.is_const(var.node())) {
+            add_reader(var.node(), 0, true);
+        }
+    }
+
+    for (auto var : vars) {
+        auto iter = opr2node.find(var->owner_opr());
+        if (iter == opr2node.end()) {
+            continue;
+        }
+        size_t producer = iter->second;
+        double cost = nchwxx_cost::relayout(var);
+        auto&& readers = var_readers.at(var);
+        //! pay the relayout if producer is nchw and any reader is nchwxx
+        if (!readers.first.empty()) {
+            size_t aux = solver.add_node();
+            solver.add_edge(producer, aux, cost);
+            for (auto reader : readers.first) {
+                solver.add_edge(aux, reader, INF);
+            }
+        }
+        //! pay the relayout if producer is nchwxx and any reader is nchw
+        if (readers.second) {
+            solver.add_edge(src_node, producer, cost);
+        } else if (!readers.first.empty()) {
+            size_t aux = solver.add_node();
+            solver.add_edge(aux, producer, cost);
+            for (auto reader : readers.first) {
+                solver.add_edge(reader, aux, INF);
+            }
+        }
+    }
+
+    auto is_nchw = solver.solve(sink_node);
+    for (auto opr : oprs) {
+        if (!is_nchw[opr2node.at(opr)]) {
+            m_nchwxx_oprs.insert(opr);
+        }
+    }
+}
+
+void EnableNchwxxPass::apply(OptState& opt) const {
+    if (m_select_by_cost) {
+        select_layout_by_cost(opt);
+    }
+    TensorReformatPass::apply(opt);
+}
+
 VarNode* EnableNchwxxPass::on_graph_endpoint_var(VarNode* new_var,
                                                  VarNode* orig_var) const {
     if (!orig_var->shape().eq_shape(new_var->shape())) {
@@ -2962,9 +3883,11 @@ VarNode* EnableNchwxxPass::on_graph_endpoint_var(VarNode* new_var,
 }
 
 std::unique_ptr<EnableNchwxxPass> EnableNchwxxPass::make_nchwxx_converter(
-        size_t pack_c_size) {
+        size_t pack_c_size, bool select_by_cost) {
     auto ret = std::make_unique<EnableNchwxxPass>();
     ret->set_var_replace_check_flag(VarReplaceCheckFlag::NOCHECK);
+    ret->m_pack_c_size = pack_c_size;
+    ret->m_select_by_cost = select_by_cost;
     //! First is whether the conv can trans to nchwxx, second is the filter
     //! trans mode
     using RelayoutMode = RelayoutPlaceholder::LayoutType;
@@ -3019,6 +3942,18 @@ std::unique_ptr<EnableNchwxxPass> EnableNchwxxPass::make_nchwxx_converter(
         }
         return ret;
     };
+    ret->m_conv_trans_type = [test_trans_nchwxx](OperatorNodeBase* opr) {
+        if (auto conv = try_cast_as_op<opr::ConvolutionForward>(opr)) {
+            return test_trans_nchwxx(conv->param().sparse, opr->input(1))
+                    .first;
+        }
+        return test_trans_nchwxx(
+                       opr->cast_final_safe<opr::ConvBiasForward>()
+                               .param()
+                               .sparse,
+                       opr->input(1))
+                .first;
+    };
     auto replace_conv_opr = [test_trans_nchwxx, conv_format, src_to_nchwxx_mode,
                              src_to_nchw_mode](OperatorNodeBase* opr,
                                                const VarNodeArray& new_inp) {
@@ -3285,6 +4220,40 @@ std::unique_ptr<EnableNchwxxPass> EnableNchwxxPass::make_nchwxx_converter(
     replace_func[opr::WarpPerspectiveForward::typeinfo()] =
             relayout_inp_to_nchw;
     replace_func[opr::WarpAffineForward::typeinfo()] = relayout_inp_to_nchw;
+
+    if (select_by_cost) {
+        //! oprs not selected run in nchw; selected elemwise and pooling oprs
+        //! would follow their inputs by the rules above, so their inputs are
+        //! converted here to make them run in nchwxx
+        auto&& nchwxx_oprs = ret->m_nchwxx_oprs;
+        for (auto typeinfo :
+             {opr::Convolution::typeinfo(), opr::ConvBias::typeinfo(),
+              opr::PoolingForward::typeinfo(), opr::Elemwise::typeinfo(),
+              opr::TypeCvt::typeinfo(), opr::ElemwiseMultiType::typeinfo(),
+              opr::PowC::typeinfo()}) {
+            auto&& func = replace_func[typeinfo];
+            bool is_conv = typeinfo == opr::Convolution::typeinfo() ||
+                           typeinfo == opr::ConvBias::typeinfo();
+            func = [&nchwxx_oprs, func, is_conv, relayout_inp_to_nchw,
+                    src_to_nchwxx_mode](OperatorNodeBase* opr,
+                                        const VarNodeArray& new_inp) {
+                if (!nchwxx_oprs.count(opr)) {
+                    return relayout_inp_to_nchw(opr, new_inp);
+                }
+                if (is_conv) {
+                    return func(opr, new_inp);
+                }
+                VarNodeArray temp_inp = new_inp;
+                for (auto&& i : temp_inp) {
+                    if (i->shape().ndim == 4) {
+                        i = RelayoutPlaceholder::make(i, src_to_nchwxx_mode)
+                                    .node();
+                    }
+                }
+                return func(opr, temp_inp);
+            };
+        }
+    }
     return ret;
 }
 
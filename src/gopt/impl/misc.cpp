@@ -11,8 +11,11 @@
 
 #include "megbrain/gopt/misc.h"
 #include "megbrain/graph/grad_impl.h"
+#include "megbrain/opr/basic_arith.h"
 #include "megbrain/opr/cond.h"
+#include "megbrain/opr/dnn/pooling.h"
 #include "megbrain/opr/io.h"
+#include "megbrain/opr/nn_int.h"
 #include "megbrain/opr/tensor_manip.h"
 #include "megbrain/opr/utility.h"
 #include "megbrain/serialization/serializer.h"
@@ -653,4 +656,143 @@ void RemoveRedundantTypeCvtPass::apply(OptState& opt) const {
     rewriter.apply_inplace();
 }
 
+/* ====================== QuantizedDTypePropagatePass ====================== */
+
+namespace {
+bool is_dequantize(OperatorNodeBase* opr) {
+    return opr->same_type<opr::TypeCvt>() &&
+           opr->input(0)->dtype().category() == DTypeCategory::QUANTIZED &&
+           opr->output(0)->dtype().enumv() == DTypeEnum::Float32;
+}
+
+//! number of leading inputs carrying tensor values if the opr commutes with
+//! dequantization, or 0 otherwise; remaining inputs are shapes or indices
+size_t get_nr_quantizable_inputs(OperatorNodeBase* opr) {
+    if (opr->same_type<opr::Reshape>() || opr->same_type<opr::Dimshuffle>() ||
+        opr->same_type<opr::AxisAddRemove>() ||
+        opr->same_type<opr::Subtensor>()) {
+        return 1;
+    }
+    if (opr->same_type<opr::Concat>()) {
+        return opr->input().size();
+    }
+    if (auto pooling = try_cast_as_op<opr::PoolingForward>(opr)) {
+        // quantized pooling is only guaranteed on CPU
+        if (pooling->param().mode == opr::PoolingForward::Param::Mode::MAX &&
+            opr->output(0)->comp_node().device_type() ==
+                    CompNode::DeviceType::CPU) {
+            return 1;
+        }
+        return 0;
+    }
+    if (auto elem = try_cast_as_op<opr::Elemwise>(opr)) {
+        if (elem->param().mode == opr::Elemwise::Mode::RELU) {
+            return 1;
+        }
+    }
+    return 0;
+}
+}  // anonymous namespace
+
+const char* QuantizedDTypePropagatePass::name() const {
+    return "propagate_quantized_dtype";
+}
+
+void QuantizedDTypePropagatePass::apply(OptState& opt) const {
+    auto rewriter = opt.graph().make_rewriter();
+    UniqReaderCheck uniq_reader_check{opt.graph()};
+    //! map from a float var in the original graph to the quantized var in
+    //! the new graph whose dequantization it is
+    ThinHashMap<VarNode*, VarNode*> var2quantized;
+    auto get_quantized = [&](VarNode* var) -> VarNode* {
+        auto iter = var2quantized.find(var);
+        return iter == var2quantized.end() ? nullptr : iter->second;
+    };
+
+    auto try_propagate = [&](OperatorNodeBase* opr) {
+        size_t nr_inps = get_nr_quantizable_inputs(opr);
+        if (!nr_inps || opr->output().size() != 1 ||
+            opr->output(0)->dtype().enumv() != DTypeEnum::Float32) {
+            return false;
+        }
+        VarNodeArray new_inps;
+        DType qtype;
+        for (size_t i = 0; i < opr->input().size(); ++i) {
+            auto inp = opr->input(i);
+            if (i >= nr_inps) {
+                new_inps.push_back(rewriter.get_var(inp));
+                continue;
+            }
+            // moving the dequantize is only free if this opr is its sole
+            // reader; otherwise the float var is still needed elsewhere
+            auto qvar = get_quantized(inp);
+            if (!qvar || !uniq_reader_check(inp) ||
+                (qtype.valid() && qvar->dtype() != qtype)) {
+                return false;
+            }
+            qtype = qvar->dtype();
+            new_inps.push_back(qvar);
+        }
+        VarNode* qout;
+        if (opr->same_type<opr::Elemwise>()) {
+            qout = opr::ElemwiseMultiType::make(
+                           {new_inps[0]},
+                           {opr::ElemwiseMultiType::Param::Mode::QRELU},
+                           OperatorNodeConfig{qtype})
+                           .node();
+        } else {
+            qout = serialization::copy_opr_shallow(*opr, new_inps,
+                                                   opr->config())
+                           ->output(0);
+        }
+        mgb_assert(qout->dtype() == qtype);
+        auto out = opr::TypeCvt::make(qout, dtype::Float32()).node();
+        rewriter.replace_var(
+                opr->output(0), out,
+                mgb_cstr_log("f(dequantize(x)) -> dequantize(f(x))"));
+        var2quantized[opr->output(0)] = qout;
+        return true;
+    };
+
+    auto on_opr = [&](OperatorNodeBase* opr) {
+        if (is_dequantize(opr)) {
+            rewriter.auto_replace_outputs(opr);
+            var2quantized[opr->output(0)] = rewriter.get_var(opr->input(0));
+            return;
+        }
+        if (auto tc = try_cast_as_op<opr::TypeCvt>(opr)) {
+            auto qvar = get_quantized(opr->input(0));
+            if (qvar && tc->param().category() == DTypeCategory::QUANTIZED) {
+                // requantize directly from the source scale; TypeCvt returns
+                // qvar itself if the dtypes are equal
+                auto fold = opr::TypeCvt::make(qvar, tc->param());
+                rewriter.replace_var(
+                        opr->output(0), fold.node(),
+                        mgb_cstr_log("quantize(dequantize(x)) -> "
+                                     "requantize(x)"));
+                return;
+            }
+        }
+        if (!try_propagate(opr)) {
+            rewriter.auto_replace_outputs(opr);
+        }
+    };
+
+    opt.graph().iter(on_opr);
+    rewriter.apply_inplace();
+
+    size_t nr_islands = 0;
+    std::string islands;
+    opt.graph().iter([&](OperatorNodeBase* opr) {
+        if (is_dequantize(opr)) {
+            ++nr_islands;
+            islands.append(ssprintf("\n  %s", opr->cname()));
+        }
+    });
+    if (nr_islands) {
+        mgb_log_debug("%s: %zu float islands remain, starting at:%s", name(),
+                      nr_islands, islands.c_str());
+    }
+}
+
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -150,6 +150,48 @@ namespace gopt {
         void apply(OptState& opt) const override;
     };
 
+    /*!
+     * \brief fold per-channel scale/shift (and an optional relu/sigmoid fused
+     *      with the shift) following a float32 NCHW ConvBias into its filter
+     *      and bias
+     *
+     * The scale and shift must be const; ParamFusePass would then compute the
+     * new filter and bias at compile time.
+     */
+    class FuseConvBiasScaleShiftPass : public Pass {
+    public:
+        const char* name() const override;
+        void apply(OptState& opt) const override;
+    };
+
+    /*!
+     * \brief fuse a Pooling following a float32 NCHW ConvBias on CPU into a
+     *      ConvPooling opr, so the conv output is consumed band by band
+     *      instead of being written to memory and read back
+     */
+    class FuseConvBiasPoolingPass : public Pass {
+    public:
+        const char* name() const override;
+        void apply(OptState& opt) const override;
+    };
+
+    /*!
+     * \brief fuse image preprocessing of uint8 NHWC images into an
+     *      ImagePreprocess opr
+     *
+     * The fused chain is an optional CvtColor (channel swap or yuv420 to
+     * rgb/bgr), an optional NHWC Resize with constant output shape, a
+     * TypeCvt to float32, a dimshuffle to NCHW, elemwise affine transforms
+     * with const scalar or per-channel operands and an optional TypeCvt to
+     * QuantizedS8, with the dimshuffle and the affine transforms in any
+     * order. The composed scale and bias are left to ParamFusePass.
+     */
+    class FuseImagePreprocessPass final : public Pass {
+    public:
+        const char* name() const override;
+        void apply(OptState& opt) const override;
+    };
+
     /*!
      * \brief fuse deconv and typecvt to a deconv opr
      */
@@ -242,16 +284,37 @@ namespace gopt {
             TRANS_HYBIRD_NCHWXX,  //!< input is nchw, output is nchw88
             TRANS_NONE,           //!< no need trans
         };
+        //! get how a conv/conv_bias opr would be converted
+        thin_function<TransType(OperatorNodeBase*)> m_conv_trans_type;
+        size_t m_pack_c_size = 8;
+        //! whether to choose the layout of each opr by estimated cost
+        bool m_select_by_cost = false;
+        //! oprs chosen to run in nchwxx, valid only if m_select_by_cost
+        mutable ThinHashSet<OperatorNodeBase*> m_nchwxx_oprs;
+
+        /*!
+         * \brief choose nchw or nchwxx for each opr to minimize the estimated
+         *      conv time plus the time of the relayouts between them
+         *
+         * Each opr is labeled nchw or nchwxx, and oprs that can not run in
+         * nchwxx are fixed to nchw. A var has to be relayouted once if any of
+         * its readers wants the other layout. All terms of this binary
+         * labeling problem are submodular, so it is solved exactly by a
+         * s-t min cut on the opr graph.
+         */
+        void select_layout_by_cost(OptState& opt) const;
 
     public:
         const char* name() const override {
             return mgb_cstr_log(m_name.c_str());
         }
         void set_name(std::string in_name) { m_name = in_name; }
+        void apply(OptState& opt) const override;
         //! make nchw -> nchwxx converter opt pass, pack_c_size is the x, like
-        //! 4,8,16
+        //! 4,8,16; if select_by_cost is true, only the oprs that are estimated
+        //! to be faster in nchwxx (including relayout cost) are converted
         static std::unique_ptr<EnableNchwxxPass> make_nchwxx_converter(
-                size_t pack_c_size);
+                size_t pack_c_size, bool select_by_cost = false);
     };
 
     struct OptimizeForInferenceOptions {
@@ -265,11 +328,23 @@ namespace gopt {
         bool use_nhwcd4 = false;
         //! whether to compute using NCHW88 tensor format
         bool use_nchw88 = false;
+        //! when use_nchw88 is set, convert only the oprs that are estimated
+        //! to be faster in NCHW88 instead of the whole graph
+        bool select_nchw88_by_cost = false;
         //! whether to enable tensor core
         bool use_tensor_core = false;
         //! fuse pattern like ReLU(conv_bias(x, w, b) + z) or conv_bias(x, w, b)
         //! + z -> conv_bias(x, w, b, z)
         bool fuse_conv_bias_with_z = false;
+        //! fold per-channel scale/shift following conv_bias into its params
+        //! and fuse pooling after conv_bias into a ConvPooling opr on CPU
+        bool fuse_conv_bias_epilogue = false;
+        //! move dequantizing TypeCvts past shape-only and monotone oprs and
+        //! fold requantize chains, keeping quantized tensors quantized
+        bool propagate_quantized_dtype = false;
+        //! fuse color conversion, resize, typecvt, transpose to NCHW and
+        //! normalization of input images into an ImagePreprocess opr
+        bool fuse_image_preprocess = false;
 
 #define SET(n)                                  \
     OptimizeForInferenceOptions& enable_##n() { \
@@ -283,6 +358,10 @@ namespace gopt {
         SET(use_tensor_core);
         SET(fuse_conv_bias_with_z);
         SET(use_nchw88);
+        SET(select_nchw88_by_cost);
+        SET(fuse_conv_bias_epilogue);
+        SET(propagate_quantized_dtype);
+        SET(fuse_image_preprocess);
 #undef SET
     };
 
@@ -83,6 +83,23 @@ namespace gopt {
         void apply(OptState &opt) const override;
     };
 
+    /*!
+     * \brief keep quantized tensors quantized across shape-only and monotone
+     *      oprs
+     *
+     * Dequantizing TypeCvts are moved past Reshape, Dimshuffle,
+     * AxisAddRemove, Subtensor, Concat, max Pooling and Relu, and a
+     * requantize of a dequantized var is folded into a single TypeCvt, so
+     * int8 activations are not converted to float32 and back between
+     * quantized oprs. The remaining float islands are reported in the debug
+     * log.
+     */
+    class QuantizedDTypePropagatePass final : public Pass {
+    public:
+        const char* name() const override;
+        void apply(OptState& opt) const override;
+    };
+
     //! remove execution mask for const PPVs in conditional execution
     class CondExecConstPredicateFolding final : public Pass {
     public:
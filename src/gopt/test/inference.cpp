@@ -1311,6 +1311,107 @@ TEST_PASS(FuseConvBiasNonlinPass, Basic) {
     }
 }
 
+TEST(TestGoptInference, FuseConvBiasScaleShift) {
+    HostTensorGenerator<> gen;
+    auto cn = CompNode::load("cpu0");
+    auto graph = ComputingGraph::make();
+    graph->options().graph_opt_level = 0;
+    auto mkvar = [&](const char* name, const TensorShape& shp) {
+        return opr::Host2DeviceCopy::make(*graph, gen(shp, cn)).rename(name);
+    };
+    auto mkcvar = [&](const char* name, const TensorShape& shp) {
+        return opr::SharedDeviceTensor::make(*graph, *gen(shp, cn))
+                .rename(name);
+    };
+
+    auto x = mkvar("x", {2, 4, 12, 12}), w = mkcvar("w", {8, 4, 3, 3}),
+         b = mkcvar("b", {1, 8, 1, 1}), scale = mkcvar("scale", {1, 8, 1, 1}),
+         shift = mkcvar("shift", {1, 8, 1, 1});
+    opr::ConvBias::Param param;
+    param.pad_h = param.pad_w = 1;
+    auto y = opr::ConvBias::make(x, w, b, param);
+    y = opr::relu(y * scale + shift);
+
+    SymbolVar y_opt;
+    unpack_vector(gopt::GraphOptimizer{}
+                          .add_pass<gopt::FuseConvBiasScaleShiftPass>()
+                          .add_pass<gopt::FuseConvBiasNonlinPass>()
+                          .add_pass<gopt::ParamFusePass>()
+                          .apply({{y}})
+                          .endpoint_vars(),
+                  y_opt);
+    ASSERT_EQ(opr::ConvBias::Param::NonlineMode::RELU,
+              find_opr<opr::ConvBias>(y_opt).param().nonlineMode);
+    ASSERT_EQ(0u, find_opr_num<opr::Elemwise>(y_opt));
+
+    HostTensorND host_y, host_y_opt;
+    auto func = graph->compile({make_callback_copy(y, host_y),
+                                make_callback_copy(y_opt, host_y_opt)});
+    func->execute();
+    MGB_ASSERT_TENSOR_NEAR(host_y, host_y_opt, 1e-4);
+}
+
+TEST(TestGoptInference, FuseConvBiasPooling) {
+    HostTensorGenerator<> gen;
+    auto cn = CompNode::load("cpu0");
+    auto graph = ComputingGraph::make();
+    graph->options().graph_opt_level = 0;
+    auto mkvar = [&](const char* name, const TensorShape& shp) {
+        return opr::Host2DeviceCopy::make(*graph, gen(shp, cn)).rename(name);
+    };
+    auto mkcvar = [&](const char* name, const TensorShape& shp) {
+        return opr::SharedDeviceTensor::make(*graph, *gen(shp, cn))
+                .rename(name);
+    };
+
+    auto x = mkvar("x", {2, 4, 13, 15}), w = mkcvar("w", {8, 4, 3, 3}),
+         b = mkcvar("b", {1, 8, 1, 1});
+    opr::ConvBias::Param conv_param;
+    conv_param.pad_h = conv_param.pad_w = 1;
+    conv_param.nonlineMode = opr::ConvBias::Param::NonlineMode::RELU;
+    opr::Pooling::Param pool_param;
+    pool_param.mode = opr::Pooling::Param::Mode::MAX;
+    pool_param.window_h = pool_param.window_w = 3;
+    pool_param.stride_h = pool_param.stride_w = 2;
+    pool_param.pad_h = pool_param.pad_w = 1;
+    auto y0 = opr::Pooling::make(opr::ConvBias::make(x, w, b, conv_param),
+                                 pool_param);
+    pool_param.mode = opr::Pooling::Param::Mode::AVERAGE;
+    auto y1 = opr::Pooling::make(opr::ConvBias::make(x, w, conv_param),
+                                 pool_param);
+    // conv output read by two oprs should not be fused
+    auto z = opr::ConvBias::make(x, w, b, conv_param);
+    auto y2 = opr::Pooling::make(z, pool_param), y3 = opr::relu(z);
+    // conv with more input channels is also fused
+    auto x4 = mkvar("x4", {2, 16, 13, 15}), w4 = mkcvar("w4", {8, 16, 3, 3});
+    auto y4 = opr::Pooling::make(opr::ConvBias::make(x4, w4, b, conv_param),
+                                 pool_param);
+
+    SymbolVar y0_opt, y1_opt, y2_opt, y3_opt, y4_opt;
+    unpack_vector(gopt::GraphOptimizer{}
+                          .add_pass<gopt::FuseConvBiasPoolingPass>()
+                          .apply({{y0, y1, y2, y3, y4}})
+                          .endpoint_vars(),
+                  y0_opt, y1_opt, y2_opt, y3_opt, y4_opt);
+    ASSERT_EQ(1u, find_opr_num<opr::ConvPooling>(y0_opt));
+    ASSERT_EQ(1u, find_opr_num<opr::ConvPooling>(y1_opt));
+    ASSERT_EQ(0u, find_opr_num<opr::ConvPooling>(y2_opt));
+    ASSERT_EQ(1u, find_opr_num<opr::ConvPooling>(y4_opt));
+
+    HostTensorND host_y0, host_y0_opt, host_y1, host_y1_opt, host_y4,
+            host_y4_opt;
+    auto func = graph->compile({make_callback_copy(y0, host_y0),
+                                make_callback_copy(y0_opt, host_y0_opt),
+                                make_callback_copy(y1, host_y1),
+                                make_callback_copy(y1_opt, host_y1_opt),
+                                make_callback_copy(y4, host_y4),
+                                make_callback_copy(y4_opt, host_y4_opt)});
+    func->execute();
+    MGB_ASSERT_TENSOR_NEAR(host_y0, host_y0_opt, 1e-4);
+    MGB_ASSERT_TENSOR_NEAR(host_y1, host_y1_opt, 1e-4);
+    MGB_ASSERT_TENSOR_NEAR(host_y4, host_y4_opt, 1e-4);
+}
+
 
 #if MGB_CUDA
 TEST(TestEnableTensorCore, SmallInputShape) {
@@ -1441,6 +1542,103 @@ TEST(TestEnableTensorCore, ConvBiasWithZ) {
     MGB_ASSERT_TENSOR_EQ(host_y, host_y_opt);
 }
 
+TEST(TestGoptInference, FuseImagePreprocess) {
+    HostTensorGenerator<dtype::Uint8> gen_uint8;
+    HostTensorGenerator<dtype::Float32, RandomDistribution::UNIFORM> gen{0.5f,
+                                                                        1.f};
+    auto cn = CompNode::load("cpu0");
+    auto graph = ComputingGraph::make();
+    graph->options().graph_opt_level = 0;
+    auto mkvar = [&](const char* name, const TensorShape& shp) {
+        return opr::Host2DeviceCopy::make(*graph, gen_uint8(shp, cn))
+                .rename(name);
+    };
+    auto mkcvar = [&](const char* name, const TensorShape& shp) {
+        return opr::SharedDeviceTensor::make(*graph, *gen(shp, cn))
+                .rename(name);
+    };
+    auto cvt_color = [](SymbolVar x, opr::CvtColor::Param::Mode mode) {
+        opr::CvtColor::Param param;
+        param.mode = mode;
+        return opr::CvtColor::make(x, param);
+    };
+    auto resize = [](SymbolVar x, const TensorShape& shp,
+                     opr::Resize::Param::InterpolationMode imode) {
+        opr::Resize::Param param;
+        param.format = opr::Resize::Param::Format::NHWC;
+        param.imode = imode;
+        return opr::Resize::make(x, shp, param);
+    };
+    using CvtMode = opr::CvtColor::Param::Mode;
+    using IMode = opr::Resize::Param::InterpolationMode;
+
+    // yuv to bgr, resize, astype, normalize in NHWC and transpose
+    auto y0 = resize(cvt_color(mkvar("x0", {2, 24, 16, 1}),
+                               CvtMode::YUV2BGR_NV21),
+                     {11, 9}, IMode::NEAREST);
+    y0 = opr::TypeCvt::make(y0, dtype::Float32());
+    y0 = (y0 - mkcvar("mean", {3})) / mkcvar("std", {1, 1, 1, 3});
+    y0 = opr::Dimshuffle::make(y0, {0, 3, 1, 2});
+
+    // swap rb, transpose before astype, normalize in NCHW and quantize
+    auto y1 = opr::Dimshuffle::make(
+            cvt_color(mkvar("x1", {2, 10, 12, 3}), CvtMode::RGB2BGR),
+            {0, 3, 1, 2});
+    y1 = opr::TypeCvt::make(y1, dtype::Float32()) *
+                 mkcvar("scale", {1, 3, 1, 1}) +
+         1.f;
+    y1 = opr::TypeCvt::make(y1, dtype::QuantizedS8(0.1f));
+
+    // bilinear resize without color conversion
+    auto y2 = opr::TypeCvt::make(
+            resize(mkvar("x2", {1, 8, 10, 1}), {13, 7}, IMode::LINEAR),
+            dtype::Float32());
+    y2 = opr::Dimshuffle::make(y2, {0, 3, 1, 2}) * 0.5f;
+
+    // the float image is read by two oprs and can not be fused
+    auto z = opr::TypeCvt::make(mkvar("x3", {1, 4, 4, 3}), dtype::Float32());
+    auto y3 = opr::Dimshuffle::make(z, {0, 3, 1, 2}), y4 = z * 2.f;
+
+    SymbolVar y0_opt, y1_opt, y2_opt, y3_opt, y4_opt;
+    unpack_vector(gopt::GraphOptimizer{}
+                          .add_pass<gopt::FuseImagePreprocessPass>()
+                          .add_pass<gopt::ParamFusePass>()
+                          .apply({{y0, y1, y2, y3, y4}})
+                          .endpoint_vars(),
+                  y0_opt, y1_opt, y2_opt, y3_opt, y4_opt);
+    for (auto&& y : {y0_opt, y1_opt, y2_opt}) {
+        ASSERT_EQ(1u, find_opr_num<opr::ImagePreprocess>(y));
+        ASSERT_EQ(0u, find_opr_num<opr::Elemwise>(y));
+        ASSERT_EQ(0u, find_opr_num<opr::Dimshuffle>(y));
+        ASSERT_EQ(0u, find_opr_num<opr::Resize>(y));
+        ASSERT_EQ(0u, find_opr_num<opr::CvtColor>(y));
+    }
+    ASSERT_EQ(opr::ImagePreprocess::Param::ColorMode::YUV2BGR_NV21,
+              find_opr<opr::ImagePreprocess>(y0_opt).param().color_mode);
+    ASSERT_EQ(dtype::QuantizedS8(0.1f), y1_opt.dtype());
+    ASSERT_EQ(0u, find_opr_num<opr::ImagePreprocess>(y3_opt));
+    ASSERT_EQ(0u, find_opr_num<opr::ImagePreprocess>(y4_opt));
+
+    auto to_float = [](SymbolVar x) {
+        return opr::TypeCvt::make(x, dtype::Float32());
+    };
+    HostTensorND host_y0, host_y0_opt, host_y1, host_y1_opt, host_y2,
+            host_y2_opt;
+    auto func = graph->compile({make_callback_copy(y0, host_y0),
+                                make_callback_copy(y0_opt, host_y0_opt),
+                                make_callback_copy(to_float(y1), host_y1),
+                                make_callback_copy(to_float(y1_opt),
+                                                   host_y1_opt),
+                                make_callback_copy(y2, host_y2),
+                                make_callback_copy(y2_opt, host_y2_opt)});
+    func->execute();
+    MGB_ASSERT_TENSOR_NEAR(host_y0, host_y0_opt, 1e-4);
+    MGB_ASSERT_TENSOR_NEAR(host_y1, host_y1_opt, 1e-4);
+    // the fixed point bilinear Resize on CPU may round the interpolated value
+    // differently by one
+    MGB_ASSERT_TENSOR_NEAR(host_y2, host_y2_opt, 0.51);
+}
+
 TEST(TestGoptInference, EnableTensorCore) {
     REQUIRE_GPU(1);
     auto cn = CompNode::load("gpu0");
@@ -2256,5 +2454,130 @@ TEST(TestGoptInference, ConvertFormatNCHW88) {
     MGB_ASSERT_TENSOR_NEAR(host_y, host_y_opt, 1e-1);
 }
 
+TEST(TestGoptInference, ConvertFormatNCHW88ByCost) {
+    HostTensorGenerator<> gen;
+    auto cn = CompNode::load("cpu0");
+    auto graph = ComputingGraph::make();
+    graph->options().graph_opt_level = 0;
+    auto mkcvar = [&](const char* name, const TensorShape& shp) {
+        return opr::SharedDeviceTensor::make(*graph, *gen(shp, cn))
+                .rename(name);
+    };
+
+    opr::ConvBias::Param param_conv_bias;
+    //! a tiny conv which is not worth the relayouts around it
+    auto host_x0 = gen({2, 8, 8, 8}, cn);
+    auto x0 = opr::Host2DeviceCopy::make(*graph, host_x0);
+    auto w0 = mkcvar("w0", {8, 8, 1, 1}), b0 = mkcvar("b0", {1, 8, 1, 1}),
+         y0 = opr::ConvBias::make(x0, w0, b0, param_conv_bias);
+
+    //! a chain of large convs which should be converted together
+    param_conv_bias.pad_h = param_conv_bias.pad_w = 1;
+    auto host_x1 = gen({1, 16, 32, 32}, cn);
+    auto x1 = opr::Host2DeviceCopy::make(*graph, host_x1);
+    auto w1 = mkcvar("w1", {32, 16, 3, 3}), b1 = mkcvar("b1", {1, 32, 1, 1}),
+         conv1 = opr::ConvBias::make(x1, w1, b1, param_conv_bias);
+    auto relu = opr::Elemwise::make({conv1}, opr::Elemwise::Param::Mode::RELU);
+    auto w2 = mkcvar("w2", {32, 32, 3, 3}), b2 = mkcvar("b2", {1, 32, 1, 1}),
+         y1 = opr::ConvBias::make(relu, w2, b2, param_conv_bias);
+
+    SymbolVar y0_opt, y1_opt;
+    unpack_vector(gopt::optimize_for_inference(
+                          {y0, y1}, gopt::OptimizeForInferenceOptions{}
+                                            .enable_use_nchw88()
+                                            .enable_select_nchw88_by_cost()),
+                  y0_opt, y1_opt);
+
+    ASSERT_EQ(opr::ConvBias::Param::Format::NCHW,
+              find_opr<opr::ConvBias>(y0_opt).param().format);
+    ASSERT_EQ(opr::ConvBias::Param::Format::NCHW88,
+              find_opr<opr::ConvBias>(y1_opt).param().format);
+    ASSERT_EQ(2u, find_opr_num<opr::ConvBias>(y1_opt));
+
+    HostTensorND host_y0, host_y0_opt, host_y1, host_y1_opt;
+    auto func = graph->compile({make_callback_copy(y0, host_y0),
+                                make_callback_copy(y0_opt, host_y0_opt),
+                                make_callback_copy(y1, host_y1),
+                                make_callback_copy(y1_opt, host_y1_opt)});
+    func->execute();
+    MGB_ASSERT_TENSOR_NEAR(host_y0, host_y0_opt, 1e-3);
+    //! meybe go to winograd in x86-32, so set error 1e-1
+    MGB_ASSERT_TENSOR_NEAR(host_y1, host_y1_opt, 1e-1);
+}
+
+TEST(TestGoptInference, ConvertFormatNCHW88ByProfiledCost) {
+    HostTensorGenerator<> gen;
+    auto cn = CompNode::load("cpu0");
+    auto graph = ComputingGraph::make();
+    graph->options().graph_opt_level = 0;
+    auto mkcvar = [&](const char* name, const TensorShape& shp) {
+        return opr::SharedDeviceTensor::make(*graph, *gen(shp, cn))
+                .rename(name);
+    };
+
+    //! a chain of large convs which the cost model would convert
+    opr::ConvBias::Param param_conv_bias;
+    param_conv_bias.pad_h = param_conv_bias.pad_w = 1;
+    auto host_x = gen({1, 16, 24, 24}, cn);
+    auto x = opr::Host2DeviceCopy::make(*graph, host_x);
+    auto w1 = mkcvar("w1", {32, 16, 3, 3}), b1 = mkcvar("b1", {1, 32, 1, 1}),
+         conv1 = opr::ConvBias::make(x, w1, b1, param_conv_bias);
+    auto relu = opr::Elemwise::make({conv1}, opr::Elemwise::Param::Mode::RELU);
+    auto w2 = mkcvar("w2", {32, 32, 3, 3}), b2 = mkcvar("b2", {1, 32, 1, 1}),
+         y = opr::ConvBias::make(relu, w2, b2, param_conv_bias);
+
+    //! profiled times saying that nchw88 is much slower take precedence
+    auto put_time = [](SymbolVar conv_out, bool nchwxx, double time) {
+        auto&& conv = conv_out.node()->owner_opr()->cast_final_safe<
+                opr::ConvBias>();
+        auto param = conv.param();
+        TensorShape src = conv.input(0)->shape(),
+                    filter = conv.input(1)->shape(),
+                    bias = conv.input(2)->shape(),
+                    dst = conv.output(0)->shape();
+        if (nchwxx) {
+            param.format = opr::ConvBias::Param::Format::NCHW88;
+            auto pack = [](const TensorShape& shp) {
+                return TensorShape{shp[0], shp[1] / 8, shp[2], shp[3], 8};
+            };
+            src = pack(src);
+            filter = {filter[0] / 8, filter[1] / 8, filter[2], filter[3], 8, 8};
+            bias = pack(bias);
+            dst = pack(dst);
+        }
+        DType dtype = dtype::Float32();
+        TensorLayoutArray layouts{{src, dtype},
+                                  {filter, dtype},
+                                  {bias, dtype},
+                                  {TensorShape{}, dtype},
+                                  {dst, dtype}};
+        AlgoChooserProfileCache::Key key{layouts.data(), layouts.size(),
+                                         &param, sizeof(param)};
+        AlgoChooserProfileCache::Result rst{{"fake", true, time, 0}};
+        conv.profile_cache().put(key, rst);
+    };
+    for (auto conv : {conv1, y}) {
+        put_time(conv, false, 1e-3);
+        put_time(conv, true, 1e-2);
+    }
+
+    SymbolVar y_opt;
+    unpack_vector(gopt::optimize_for_inference(
+                          {y}, gopt::OptimizeForInferenceOptions{}
+                                       .enable_use_nchw88()
+                                       .enable_select_nchw88_by_cost()),
+                  y_opt);
+
+    ASSERT_EQ(opr::ConvBias::Param::Format::NCHW,
+              find_opr<opr::ConvBias>(y_opt).param().format);
+    ASSERT_EQ(2u, find_opr_num<opr::ConvBias>(y_opt));
+
+    HostTensorND host_y, host_y_opt;
+    auto func = graph->compile({make_callback_copy(y, host_y),
+                                make_callback_copy(y_opt, host_y_opt)});
+    func->execute();
+    MGB_ASSERT_TENSOR_NEAR(host_y, host_y_opt, 1e-3);
+}
+
 
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
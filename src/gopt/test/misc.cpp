@@ -15,6 +15,7 @@
 #include "megbrain/gopt/misc.h"
 #include "megbrain/opr/basic_arith_wrapper.h"
 #include "megbrain/opr/cond.h"
+#include "megbrain/opr/nn_int.h"
 #include "megbrain/opr/tensor_manip.h"
 #include "megbrain/opr/utility.h"
 
@@ -404,4 +405,40 @@ TEST_PASS(RemoveRedundantTypeCvtPass, Basic) {
     check(x_q8_q8, x_q8_fp32_q8_);
 }
 
+TEST_PASS(QuantizedDTypePropagatePass, Basic) {
+    auto x = mkvar("x", {2, 3, 4, 4});
+    auto q = opr::TypeCvt::make(x, dtype::QuantizedS8(0.1f));
+    auto f = opr::TypeCvt::make(q, dtype::Float32());
+    auto y = opr::Elemwise::make(
+            {opr::Dimshuffle::make(f.reshape({2, 3, 16}), {0, 2, 1})},
+            opr::Elemwise::Mode::RELU);
+    auto y_q = opr::TypeCvt::make(y, dtype::QuantizedS8(0.2f));
+
+    auto expect = opr::ElemwiseMultiType::make(
+            {opr::Dimshuffle::make(q.reshape({2, 3, 16}), {0, 2, 1})},
+            {opr::ElemwiseMultiType::Param::Mode::QRELU},
+            OperatorNodeConfig{dtype::QuantizedS8(0.1f)});
+    check(opr::TypeCvt::make(expect, dtype::QuantizedS8(0.2f)), y_q);
+}
+
+TEST_PASS(QuantizedDTypePropagatePass, Concat) {
+    auto x0 = mkvar("x0", {2, 3}), x1 = mkvar("x1", {2, 5});
+    auto q0 = opr::TypeCvt::make(x0, dtype::QuantizedS8(0.1f)),
+         q1 = opr::TypeCvt::make(x1, dtype::QuantizedS8(0.1f)),
+         q2 = opr::TypeCvt::make(x1, dtype::QuantizedS8(0.3f));
+    auto f0 = opr::TypeCvt::make(q0, dtype::Float32()),
+         f1 = opr::TypeCvt::make(q1, dtype::Float32()),
+         f2 = opr::TypeCvt::make(q2, dtype::Float32());
+
+    // requantizing to the same dtype leaves the quantized concat only
+    auto y = opr::TypeCvt::make(opr::Concat::make({f0, f1}, 1),
+                                dtype::QuantizedS8(0.1f));
+    check(opr::Concat::make({q0, q1}, 1), y);
+
+    // inputs with different scales stay float
+    auto z = opr::TypeCvt::make(opr::Concat::make({f0, f2}, 1),
+                                dtype::QuantizedS8(0.1f));
+    check<false>(z, z);
+}
+
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -387,6 +387,7 @@ namespace opr {
 
     MGB_SEREG_OPR(Pooling, 1);
     MGB_SEREG_OPR(PoolingBackward, 3);
+    MGB_SEREG_OPR(ConvPooling, 3);
 
     MGB_SEREG_OPR(ROIPooling, 3);
     MGB_SEREG_OPR(ROIPoolingBackward, 4);
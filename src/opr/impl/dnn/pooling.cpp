@@ -29,5 +29,8 @@ MGB_IMPL_OPR_GRAD(PoolingForward) {
 MGB_DYN_TYPE_OBJ_FINAL_IMPL(PoolingBackward);
 MEGDNN_OPR_INIT3(PoolingBackward, "pooling_bwd", 0, true);
 
+MGB_DYN_TYPE_OBJ_FINAL_IMPL(ConvPoolingForward);
+MEGDNN_OPR_INIT3(ConvPoolingForward, "conv_pooling");
+
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
 
@@ -316,4 +316,14 @@ void WarpAffineForward::record_execute_deps(ExecDependencyArray &deps) {
     record_megdnn_opr(deps);
 }
 
+/* ======================= ImagePreprocess ======================= */
+
+MGB_DYN_TYPE_OBJ_FINAL_IMPL(ImagePreprocess);
+MEGDNN_OPR_INIT3(ImagePreprocess, "image_preprocess")
+
+void ImagePreprocess::init_output_dtype() {
+    DType output_dtype = config().output_dtype();
+    output(0)->dtype(output_dtype.valid() ? output_dtype : dtype::Float32());
+}
+
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
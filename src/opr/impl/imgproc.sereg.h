@@ -58,6 +58,8 @@ namespace opr {
     //! current resize version
     using ResizeV1 = opr::Resize;
     MGB_SEREG_OPR(ResizeV1, 2);
+
+    MGB_SEREG_OPR(ImagePreprocess, 3);
 } // namespace opr
 
 
@@ -1260,8 +1260,37 @@ void Concat::scn_do_execute() {
         if (real_axis < 0)
             real_axis += in.shape().ndim;
         end = begin + in.shape().shape[real_axis];
-        out.sub(Slice(begin, end).apply(out.layout(), real_axis)).
-            copy_from_fixlayout(in);
+        auto dest = out.sub(Slice(begin, end).apply(out.layout(), real_axis));
+        if (!in.empty() && in.raw_ptr() == dest.raw_ptr() &&
+            in.layout().eq_layout(dest.layout())) {
+            // already computed in place by set_fwd_out2in_subtensor()
+            continue;
+        }
+        dest.copy_from_fixlayout(in);
+    }
+}
+
+void Concat::mem_plan_fwd_in2out_readonly() {
+    // ask producers of the inputs to write into the output directly; this
+    // works when the slices are contiguous, i.e. all dims before the concat
+    // axis are 1
+    auto out = output(0);
+    if (!cg::is_static_var_storage(out) || !out->format().is_default())
+        return;
+    auto real_axis = m_axis;
+    if (real_axis < 0)
+        real_axis += out->shape().ndim;
+    size_t end = 0;
+    for (auto i : input()) {
+        auto begin = end;
+        end = begin + i->shape().shape[real_axis];
+        if (i->comp_node() != out->comp_node() || i->dtype() != out->dtype() ||
+            !i->shape().total_nr_elems()) {
+            continue;
+        }
+        bool succ = out->set_fwd_out2in_subtensor(
+                i, Slice(begin, end).apply(out->layout(), real_axis));
+        MGB_MARK_USED_VAR(succ);
     }
 }
 
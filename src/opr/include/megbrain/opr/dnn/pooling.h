@@ -39,6 +39,25 @@ MGB_DEFINE_OPR_CLASS(PoolingBackward,
                 const OperatorNodeConfig &config = {});
 };
 
+/*!
+ * \brief conv + bias + nonlinearity + pooling in a single opr
+ *
+ * Inputs are src, filter and a per-channel bias. CPU backends compute the
+ * pooled output without writing the full conv activation to memory; this
+ * opr is usually inserted by gopt::FuseConvBiasPoolingPass.
+ */
+MGB_DEFINE_OPR_CLASS(ConvPoolingForward,
+        intl::MegDNNOprWrapperFwd<megdnn::ConvPoolingForward>) // {
+
+    public:
+        ConvPoolingForward(VarNode *src, VarNode *filter, VarNode *bias,
+                const Param &param, const OperatorNodeConfig &config);
+        static SymbolVar make(SymbolVar src, SymbolVar filter, SymbolVar bias,
+                const Param &param,
+                const OperatorNodeConfig &config = {});
+};
+using ConvPooling = ConvPoolingForward;
+
 } // namespace opr
 } // namespace mgb
 
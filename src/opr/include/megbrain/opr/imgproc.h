@@ -216,6 +216,30 @@ MGB_DEFINE_OPR_CLASS(WarpAffineForward,
 };
 using WarpAffine = WarpAffineForward;
 
+/*!
+ * \brief color conversion, resize, per-channel affine transform and layout
+ *      conversion of batched uint8 NHWC images, fused into one pass
+ *
+ * Inputs are src, scale and bias; scale and bias are float32 vectors with
+ * one element per output channel. The output dtype is Float32 unless given
+ * by OperatorNodeConfig::output_dtype (QuantizedS8 is also supported).
+ *
+ * This opr is usually inserted by gopt::FuseImagePreprocessPass.
+ */
+MGB_DEFINE_OPR_CLASS(ImagePreprocess,
+        intl::MegDNNOprWrapperFwd<megdnn::ImagePreprocess>) // {
+    public:
+        ImagePreprocess(VarNode *src, VarNode *scale, VarNode *bias,
+                const Param &param, const OperatorNodeConfig &config);
+
+        static SymbolVar make(SymbolVar src, SymbolVar scale, SymbolVar bias,
+                const Param &param = {},
+                const OperatorNodeConfig &config = {});
+
+    private:
+        void init_output_dtype() override;
+};
+
 } // opr
 } // mgb
 
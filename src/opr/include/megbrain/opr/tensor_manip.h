@@ -526,6 +526,7 @@ MGB_DEFINE_OPR_CLASS(Concat, cg::SingleCNOutshapePureByInshapeOprBase) // {
         void init_output_static_infer_desc() override;
         void add_input_layout_constraint() override;
         void init_output_comp_node() override;
+        void mem_plan_fwd_in2out_readonly() override;
 
         void get_output_var_shape(
                 const TensorShapeArray &inp_shape,
@@ -1240,6 +1240,47 @@ TEST(TestTensorManip, ConcatEmpty2) {
     ASSERT_EQ(TensorShape({2, 0, 11}), host_z.shape());
 }
 
+TEST(TestTensorManip, ConcatInplace) {
+    HostTensorGenerator<> gen;
+    auto host_x = gen({1, 16, 8}), host_y = gen({1, 8, 8});
+    auto graph = ComputingGraph::make();
+    auto x = opr::Host2DeviceCopy::make(*graph, host_x),
+         y = opr::Host2DeviceCopy::make(*graph, host_y),
+         a = x * 2.f, b = y + 1.f, z = opr::Concat::make({a, b}, 1);
+    HostTensorND host_z;
+    auto func = graph->compile({make_callback_copy(z, host_z)});
+
+    auto check = [&]() {
+        size_t n = host_x->shape(0), cx = host_x->shape(1),
+               cy = host_y->shape(1), w = host_x->shape(2), c = cx + cy;
+        ASSERT_EQ(TensorShape({n, c, w}), host_z.shape());
+        auto px = host_x->ptr<float>(), py = host_y->ptr<float>(),
+             pz = host_z.ptr<float>();
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < c * w; ++j) {
+                float expect = j < cx * w ? px[i * cx * w + j] * 2.f
+                                          : py[i * cy * w + j - cx * w] + 1.f;
+                ASSERT_EQ(expect, pz[i * c * w + j]);
+            }
+        }
+    };
+
+    // producers of a and b write into the output directly
+    func->execute();
+    check();
+    ASSERT_EQ(prev_dev_ptr(a), prev_dev_ptr(z));
+    ASSERT_EQ(static_cast<const uint8_t*>(prev_dev_ptr(z)) +
+                      16 * 8 * sizeof(float),
+              prev_dev_ptr(b));
+
+    // slices are not contiguous with batch > 1, so the inputs are copied
+    *host_x = *gen({2, 16, 8});
+    *host_y = *gen({2, 8, 8});
+    func->execute();
+    check();
+    ASSERT_NE(prev_dev_ptr(a), prev_dev_ptr(z));
+}
+
 TEST(TestTensorManip, AxisAddRemove) {
     HostTensorGenerator<> gen;
     for (bool dyn_shape : {false, true}) {
@@ -29,21 +29,26 @@ using namespace mgb;
 namespace {
 
 template <class T>
-uint64_t opr_footprint_func(cg::OperatorNodeBase* opr);
+uint64_t opr_footprint_func(cg::OperatorNodeBase* opr,
+                            const TensorShapeArray& inp_shapes,
+                            const TensorShapeArray& out_shapes);
 
 // Elemwise
 template <>
-uint64_t opr_footprint_func<opr::Elemwise>(cg::OperatorNodeBase* opr) {
-    return opr->output()[0]->shape().total_nr_elems() *
-           (std::max<size_t>(opr->input().size(), 2) - 1);
+uint64_t opr_footprint_func<opr::Elemwise>(
+        cg::OperatorNodeBase* /*opr*/, const TensorShapeArray& inp_shapes,
+        const TensorShapeArray& out_shapes) {
+    return out_shapes[0].total_nr_elems() *
+           (std::max<size_t>(inp_shapes.size(), 2) - 1);
 }
 
 // AddUpdate
 template <>
-uint64_t opr_footprint_func<opr::AddUpdate>(cg::OperatorNodeBase* opr) {
-    mgb_assert(opr->input().size() == 2,
-               "AddUpdate opr should have two inputs");
-    auto&& out_shape = opr->output()[0]->shape();
+uint64_t opr_footprint_func<opr::AddUpdate>(
+        cg::OperatorNodeBase* /*opr*/, const TensorShapeArray& inp_shapes,
+        const TensorShapeArray& out_shapes) {
+    mgb_assert(inp_shapes.size() == 2, "AddUpdate opr should have two inputs");
+    auto&& out_shape = out_shapes[0];
     return out_shape.total_nr_elems() * 3;
 }
 
@@ -205,24 +210,26 @@ uint64_t eval_conv_computation(const TensorShape& src_shape,
 // ConvolutionForward
 template <>
 uint64_t opr_footprint_func<opr::ConvolutionForward>(
-        cg::OperatorNodeBase* opr) {
+        cg::OperatorNodeBase* opr, const TensorShapeArray& inp_shapes,
+        const TensorShapeArray& out_shapes) {
     mgb_assert(opr->input().size() == 2,
                "ConvolutionFwd opr should have two inputs");
-    auto&& out_shape = opr->output()[0]->shape();
-    auto&& src_shape = opr->input()[0]->shape();
-    auto&& filter_shape = opr->input()[1]->shape();
+    auto&& out_shape = out_shapes[0];
+    auto&& src_shape = inp_shapes[0];
+    auto&& filter_shape = inp_shapes[1];
     return eval_conv_computation<opr::ConvolutionForward>(
             src_shape, filter_shape, out_shape, opr);
 }
 template <>
 uint64_t opr_footprint_func<opr::ConvBiasForward>(
-        cg::OperatorNodeBase* opr) {
+        cg::OperatorNodeBase* opr, const TensorShapeArray& inp_shapes,
+        const TensorShapeArray& out_shapes) {
     mgb_assert(opr->input().size() == 2 || opr->input().size() == 3 ||
                        opr->input().size() == 4,
                "ConvBiasForward opr should have two/three/four inputs");
-    auto&& out_shape = opr->output()[0]->shape();
-    auto&& src_shape = opr->input()[0]->shape();
-    auto&& filter_shape = opr->input()[1]->shape();
+    auto&& out_shape = out_shapes[0];
+    auto&& src_shape = inp_shapes[0];
+    auto&& filter_shape = inp_shapes[1];
     uint64_t res = eval_conv_computation<opr::ConvBiasForward>(
             src_shape, filter_shape, out_shape, opr);
     if (opr->input().size() == 3) {
@@ -234,12 +241,13 @@ uint64_t opr_footprint_func<opr::ConvBiasForward>(
 // ConvolutionBackwardData
 template <>
 uint64_t opr_footprint_func<opr::ConvolutionBackwardData>(
-        cg::OperatorNodeBase* opr) {
+        cg::OperatorNodeBase* opr, const TensorShapeArray& inp_shapes,
+        const TensorShapeArray& out_shapes) {
     mgb_assert(opr->input().size() == 2 || opr->input().size() == 3,
                "ConvolutionBackwardData opr should have two or three inputs");
-    auto&& filter_shape = opr->input()[0]->shape();
-    auto&& diff_shape = opr->input()[1]->shape();
-    auto&& grad_shape = opr->output()[0]->shape();
+    auto&& filter_shape = inp_shapes[0];
+    auto&& diff_shape = inp_shapes[1];
+    auto&& grad_shape = out_shapes[0];
     return eval_conv_computation<opr::ConvolutionBackwardData>(
             grad_shape, filter_shape, diff_shape, opr);
 }
@@ -247,21 +255,24 @@ uint64_t opr_footprint_func<opr::ConvolutionBackwardData>(
 // ConvolutionBackwardFilter
 template <>
 uint64_t opr_footprint_func<opr::ConvolutionBackwardFilter>(
-        cg::OperatorNodeBase* opr) {
+        cg::OperatorNodeBase* opr, const TensorShapeArray& inp_shapes,
+        const TensorShapeArray& /*out_shapes*/) {
     mgb_assert(opr->input().size() == 3,
                "ConvolutionBackwardData opr should have three inputs");
-    auto&& filter_shape = opr->input()[2]->shape();
-    auto&& diff_shape = opr->input()[1]->shape();
-    auto&& src_shape = opr->input()[0]->shape();
+    auto&& filter_shape = inp_shapes[2];
+    auto&& diff_shape = inp_shapes[1];
+    auto&& src_shape = inp_shapes[0];
     return eval_conv_computation<opr::ConvolutionBackwardFilter>(
             src_shape, filter_shape, diff_shape, opr);
 }
 
 // MatrixMul
 template <>
-uint64_t opr_footprint_func<opr::MatrixMul>(cg::OperatorNodeBase* opr) {
+uint64_t opr_footprint_func<opr::MatrixMul>(
+        cg::OperatorNodeBase* opr, const TensorShapeArray& inp_shapes,
+        const TensorShapeArray& /*out_shapes*/) {
     auto&& mopr = opr->cast_final_safe<opr::MatrixMul>();
-    auto &&i0 = opr->input(0)->shape(), &&i1 = opr->input(1)->shape();
+    auto &&i0 = inp_shapes[0], &&i1 = inp_shapes[1];
     mgb_assert(i0.ndim == 2 && i1.ndim == 2);
     auto m = i0[0], k0 = i0[1], k1 = i1[0], n = i1[1];
     if (mopr.param().transposeA) {
@@ -276,12 +287,14 @@ uint64_t opr_footprint_func<opr::MatrixMul>(cg::OperatorNodeBase* opr) {
 }
 
 template <>
-uint64_t opr_footprint_func<opr::LocalShareForward>(cg::OperatorNodeBase* opr) {
+uint64_t opr_footprint_func<opr::LocalShareForward>(
+        cg::OperatorNodeBase* opr, const TensorShapeArray& inp_shapes,
+        const TensorShapeArray& out_shapes) {
     mgb_assert(opr->input().size() == 2,
                "LocalShare opr should have two inputs");
-    auto&& out_shape = opr->output()[0]->shape();
-    auto&& src_shape = opr->input()[0]->shape();
-    auto&& filter_shape = opr->input()[1]->shape();
+    auto&& out_shape = out_shapes[0];
+    auto&& src_shape = inp_shapes[0];
+    auto&& filter_shape = inp_shapes[1];
     using Param = opr::LocalShareForward::Param;
     auto&& param = opr->cast_final_safe<opr::LocalShareForward>().param();
     mgb_assert(param.format == Param::Format::NCHW);
@@ -297,12 +310,14 @@ uint64_t opr_footprint_func<opr::LocalShareForward>(cg::OperatorNodeBase* opr) {
 }
 
 template <>
-uint64_t opr_footprint_func<opr::LocalShareBackwardData>(cg::OperatorNodeBase* opr) {
+uint64_t opr_footprint_func<opr::LocalShareBackwardData>(
+        cg::OperatorNodeBase* opr, const TensorShapeArray& inp_shapes,
+        const TensorShapeArray& out_shapes) {
     mgb_assert(opr->input().size() == 3,
                "LocalShareBackwardData opr should have three inputs");
-    auto&& filter_shape = opr->input()[0]->shape();
-    auto&& diff_shape = opr->input()[1]->shape();
-    auto&& grad_shape = opr->output()[0]->shape();
+    auto&& filter_shape = inp_shapes[0];
+    auto&& diff_shape = inp_shapes[1];
+    auto&& grad_shape = out_shapes[0];
     using Param = opr::LocalShareForward::Param;
     auto&& param = opr->cast_final_safe<opr::LocalShareBackwardData>().param();
     mgb_assert(param.format == Param::Format::NCHW);
@@ -318,12 +333,14 @@ uint64_t opr_footprint_func<opr::LocalShareBackwardData>(cg::OperatorNodeBase* o
 }
 
 template <>
-uint64_t opr_footprint_func<opr::LocalShareBackwardFilter>(cg::OperatorNodeBase* opr) {
+uint64_t opr_footprint_func<opr::LocalShareBackwardFilter>(
+        cg::OperatorNodeBase* opr, const TensorShapeArray& inp_shapes,
+        const TensorShapeArray& out_shapes) {
     mgb_assert(opr->input().size() == 3,
                "LocalShareBackwardFilter opr should have three inputs");
-    auto&& src_shape = opr->input()[0]->shape();
-    auto&& diff_shape = opr->input()[1]->shape();
-    auto&& grad_shape = opr->output()[0]->shape();
+    auto&& src_shape = inp_shapes[0];
+    auto&& diff_shape = inp_shapes[1];
+    auto&& grad_shape = out_shapes[0];
     using Param = opr::LocalShareForward::Param;
     auto&& param = opr->cast_final_safe<opr::LocalShareBackwardFilter>().param();
     mgb_assert(param.format == Param::Format::NCHW);
@@ -340,11 +357,12 @@ uint64_t opr_footprint_func<opr::LocalShareBackwardFilter>(cg::OperatorNodeBase*
 
 template <>
 uint64_t opr_footprint_func<opr::DeformableConvForward>(
-        cg::OperatorNodeBase* opr) {
+        cg::OperatorNodeBase* opr, const TensorShapeArray& inp_shapes,
+        const TensorShapeArray& out_shapes) {
     mgb_assert(opr->input().size() == 4,
                "DeformableConvForward opr should have four inputs");
-    auto&& out_shape = opr->output()[0]->shape();
-    auto&& filter_shape = opr->input()[1]->shape();
+    auto&& out_shape = out_shapes[0];
+    auto&& filter_shape = inp_shapes[1];
     using Param = opr::DeformableConvForward::Param;
     auto&& param = opr->cast_final_safe<opr::Convolution>().param();
     size_t fh, fw, icpg;
@@ -362,11 +380,12 @@ uint64_t opr_footprint_func<opr::DeformableConvForward>(
 
 template <>
 uint64_t opr_footprint_func<opr::DeformableConvBackwardFilter>(
-        cg::OperatorNodeBase* opr) {
+        cg::OperatorNodeBase* opr, const TensorShapeArray& inp_shapes,
+        const TensorShapeArray& out_shapes) {
     mgb_assert(opr->input().size() == 5,
                "DeformableConvBackwardFilter opr should have four inputs");
-    auto&& out_shape = opr->output()[0]->shape();
-    auto&& filter_shape = opr->input()[1]->shape();
+    auto&& out_shape = out_shapes[0];
+    auto&& filter_shape = inp_shapes[1];
     using Param = opr::DeformableConvBackwardFilter::Param;
     auto&& param = opr->cast_final_safe<opr::Convolution>().param();
     size_t fh, fw, icpg;
@@ -385,11 +404,12 @@ uint64_t opr_footprint_func<opr::DeformableConvBackwardFilter>(
 
 template <>
 uint64_t opr_footprint_func<opr::DeformableConvBackwardData>(
-        cg::OperatorNodeBase* opr) {
+        cg::OperatorNodeBase* opr, const TensorShapeArray& inp_shapes,
+        const TensorShapeArray& out_shapes) {
     mgb_assert(opr->input().size() == 5,
                "DeformableConvBackwardData opr should have four inputs");
-    auto&& out_shape = opr->output()[0]->shape();
-    auto&& filter_shape = opr->input()[1]->shape();
+    auto&& out_shape = out_shapes[0];
+    auto&& filter_shape = inp_shapes[1];
     using Param = opr::DeformableConvForward::Param;
     auto&& param = opr->cast_final_safe<opr::Convolution>().param();
     size_t fh, fw, icpg;
@@ -408,13 +428,14 @@ uint64_t opr_footprint_func<opr::DeformableConvBackwardData>(
 
 template <>
 uint64_t opr_footprint_func<opr::BatchConvBiasForward>(
-        cg::OperatorNodeBase* opr) {
+        cg::OperatorNodeBase* opr, const TensorShapeArray& inp_shapes,
+        const TensorShapeArray& out_shapes) {
     mgb_assert(opr->input().size() == 2 || opr->input().size() == 3 ||
                        opr->input().size() == 4,
                "BatchConvBias opr should have two/three/four inputs");
-    auto&& out_shape = opr->output()[0]->shape();
-    auto&& src_shape = opr->input()[0]->shape();
-    auto&& filter_shape = opr->input()[1]->shape();
+    auto&& out_shape = out_shapes[0];
+    auto&& src_shape = inp_shapes[0];
+    auto&& filter_shape = inp_shapes[1];
     using Param = opr::BatchConvBiasForward::Param;
     auto&& param = opr->cast_final_safe<opr::BatchConvBiasForward>().param();
     mgb_assert(param.format == Param::Format::NCHW4);
@@ -428,36 +449,45 @@ uint64_t opr_footprint_func<opr::BatchConvBiasForward>(
 
 // Pooling
 template <>
-uint64_t opr_footprint_func<opr::PoolingForward>(cg::OperatorNodeBase* opr) {
+uint64_t opr_footprint_func<opr::PoolingForward>(
+        cg::OperatorNodeBase* opr, const TensorShapeArray& /*inp_shapes*/,
+        const TensorShapeArray& out_shapes) {
     auto&& param = opr->cast_final_safe<opr::PoolingForward>().param();
     auto area = param.window_h * param.window_w;
-    return opr->output(0)->shape().total_nr_elems() * area;
+    return out_shapes[0].total_nr_elems() * area;
 }
 
 // Concat
 template <>
-uint64_t opr_footprint_func<opr::Concat>(cg::OperatorNodeBase* opr) {
-    auto&& out_shape = opr->output()[0]->shape();
+uint64_t opr_footprint_func<opr::Concat>(
+        cg::OperatorNodeBase* /*opr*/, const TensorShapeArray& /*inp_shapes*/,
+        const TensorShapeArray& out_shapes) {
+    auto&& out_shape = out_shapes[0];
     return out_shape.total_nr_elems();
 }
 
 // Dimshuffle
 template <>
-uint64_t opr_footprint_func<opr::Dimshuffle>(cg::OperatorNodeBase* opr) {
-    auto&& out = opr->output()[0];
-    return out->shape().total_nr_elems();
+uint64_t opr_footprint_func<opr::Dimshuffle>(
+        cg::OperatorNodeBase* /*opr*/, const TensorShapeArray& /*inp_shapes*/,
+        const TensorShapeArray& out_shapes) {
+    return out_shapes[0].total_nr_elems();
 }
 
 // Reduce
 template <>
-uint64_t opr_footprint_func<opr::Reduce>(cg::OperatorNodeBase* opr) {
-    return opr->input()[0]->shape().total_nr_elems();
+uint64_t opr_footprint_func<opr::Reduce>(
+        cg::OperatorNodeBase* /*opr*/, const TensorShapeArray& inp_shapes,
+        const TensorShapeArray& /*out_shapes*/) {
+    return inp_shapes[0].total_nr_elems();
 }
 
 // Host2DeviceCopy
 template <>
-uint64_t opr_footprint_func<opr::Host2DeviceCopy>(cg::OperatorNodeBase* opr) {
-    auto&& out_shape = opr->output()[0]->shape();
+uint64_t opr_footprint_func<opr::Host2DeviceCopy>(
+        cg::OperatorNodeBase* /*opr*/, const TensorShapeArray& /*inp_shapes*/,
+        const TensorShapeArray& out_shapes) {
+    auto&& out_shape = out_shapes[0];
     return out_shape.total_nr_elems();
 }
 
@@ -603,9 +633,24 @@ OprFootprint::Result OprFootprint::calc_footprint(cg::OperatorNodeBase* opr) {
 }
 
 uint64_t OprFootprint::get_computation(cg::OperatorNodeBase* opr) {
+    TensorShapeArray inp_shapes, out_shapes;
+    for (auto i : opr->input()) {
+        inp_shapes.push_back(i->shape());
+    }
+    for (auto i : opr->output()) {
+        out_shapes.push_back(i->shape());
+    }
+    return get_computation(opr, inp_shapes, out_shapes);
+}
+
+uint64_t OprFootprint::get_computation(cg::OperatorNodeBase* opr,
+                                       const TensorShapeArray& inp_shapes,
+                                       const TensorShapeArray& out_shapes) {
+    mgb_assert(inp_shapes.size() == opr->input().size() &&
+               out_shapes.size() == opr->output().size());
     auto comp_trait = m_type2comp_footprint.find(opr->dyn_typeinfo());
     if (comp_trait != m_type2comp_footprint.end()) {
-        return (comp_trait->second)(opr);
+        return (comp_trait->second)(opr, inp_shapes, out_shapes);
     }
     return 0;
 }
@@ -12,10 +12,14 @@
 #include "megbrain/plugin/opr_io_dump.h"
 #include "megbrain/graph/event.h"
 #include "megbrain/utils/debug.h"
+#include "megbrain/utils/thread.h"
 
 #include "megdnn/tensor_iter.h"
 
 #include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <regex>
 
 using namespace mgb;
 
@@ -170,6 +174,9 @@ struct OprIODumpBase::VarRecorderLazySync {
 OprIODumpBase::OprIODumpBase(cg::ComputingGraph* graph) : PluginBase(graph) {
     using namespace cg::event;
     auto on_kern_finish = [this](const OprExecKernelEnd& event) {
+        if (!should_dump(event.opr)) {
+            return;
+        }
         for (VarNode* var : event.opr->output()) {
             if (!var->contain_flag(VarNode::Flag::VOLATILE_CONTENT)) {
                 auto run = [this, var]() {
@@ -451,4 +458,384 @@ BinaryOprIODump::~BinaryOprIODump() {
     flush_lazy();
 }
 
+/* =================== AsyncOprIODump =================== */
+
+namespace {
+namespace async_iodump {
+
+//! "MGBAIOD1" in little endian
+constexpr uint64_t MAGIC = 0x31444f494142474dULL;
+constexpr uint32_t VERSION = 1;
+
+struct FileHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t max_ndim;
+};
+
+/*!
+ * each record is a RecordHeader followed by var name, opr name and the
+ * contiguous tensor value
+ */
+struct RecordHeader {
+    uint64_t exec_id, var_id, opr_id, nr_bytes;
+    uint32_t dtype, ndim;
+    float scale;  //!< scale of quantized dtypes
+    uint32_t zero_point;
+    uint32_t var_name_len, opr_name_len;
+    uint64_t shape[TensorShape::MAX_NDIM];
+};
+
+//! written after the index, which contains offsets of all the records
+struct FileFooter {
+    uint64_t index_offset, nr_record, magic;
+};
+
+void get_dtype_param(DType dtype, float& scale, uint32_t& zero_point) {
+    scale = 0;
+    zero_point = 0;
+    switch (dtype.enumv()) {
+        case DTypeEnum::Quantized8Asymm: {
+            auto&& param = dtype.param<dtype::Quantized8Asymm>();
+            scale = param.scale;
+            zero_point = param.zero_point;
+            break;
+        }
+        case DTypeEnum::Quantized4Asymm: {
+            auto&& param = dtype.param<dtype::Quantized4Asymm>();
+            scale = param.scale;
+            zero_point = param.zero_point;
+            break;
+        }
+#define cb(_dt)                                  \
+    case DTypeEnum::_dt:                         \
+        scale = dtype.param<dtype::_dt>().scale; \
+        break;
+            cb(QuantizedS32) cb(QuantizedS8) cb(QuantizedS4) cb(QuantizedS16)
+#undef cb
+        default:
+            break;
+    }
+}
+
+DType make_dtype(uint32_t enumv, float scale, uint32_t zero_point) {
+    switch (static_cast<DTypeEnum>(enumv)) {
+        case DTypeEnum::Quantized8Asymm:
+            return dtype::Quantized8Asymm(scale,
+                                          static_cast<uint8_t>(zero_point));
+        case DTypeEnum::Quantized4Asymm:
+            return dtype::Quantized4Asymm(scale,
+                                          static_cast<uint8_t>(zero_point));
+#define cb(_dt)          \
+    case DTypeEnum::_dt: \
+        return dtype::_dt(scale);
+            cb(QuantizedS32) cb(QuantizedS8) cb(QuantizedS4) cb(QuantizedS16)
+#undef cb
+        default:
+            return DType::from_enum(static_cast<DTypeEnum>(enumv));
+    }
+}
+
+void read_exact(FILE* fin, void* dest, size_t size) {
+    auto nr = fread(dest, 1, size, fin);
+    mgb_throw_if(nr != size, SystemError,
+                 "failed to read async io dump: expect=%zu got=%zu", size, nr);
+}
+
+}  // namespace async_iodump
+}  // anonymous namespace
+
+class AsyncOprIODump::Impl {
+    //! a host buffer with the value and metadata of a var
+    struct Slot {
+        CompNode cn;
+        std::unique_ptr<CompNode::Event> event;
+        //! used for copying non-contiguous values
+        DeviceTensorND dv_contig;
+        HostTensorND val;
+        size_t exec_id, var_id, opr_id;
+        std::string var_name, opr_name;
+    };
+
+    class Writer final : public AsyncQueueSC<size_t, Writer> {
+        Impl* const m_par_impl;
+
+    public:
+        explicit Writer(Impl* impl) : m_par_impl{impl} {}
+
+        void process_one_task(size_t slot) { m_par_impl->write_slot(slot); }
+    };
+
+    const Options m_options;
+    std::shared_ptr<FILE> m_fout;
+    uint64_t m_file_size = 0;
+    //! offsets of written records; only accessed by the writer
+    std::vector<uint64_t> m_offsets;
+
+    std::vector<Slot> m_slots;
+    std::deque<size_t> m_free_slots;
+    std::mutex m_mtx;
+    std::condition_variable m_cv_slot_freed;
+
+    std::regex m_opr_filter;
+    ThinHashMap<cg::OperatorNodeBase*, bool> m_opr_filter_result;
+
+    size_t m_nr_exec = 0, m_cur_exec = 0;
+    bool m_cur_exec_sampled = false;
+
+    //! declared last so the worker stops before other members are destroyed
+    Writer m_writer{this};
+
+    void write(const void* data, size_t size) {
+        auto nr = fwrite(data, 1, size, m_fout.get());
+        mgb_throw_if(nr != size, SystemError,
+                     "failed to write async io dump: size=%zu written=%zu %s",
+                     size, nr, strerror(errno));
+        m_file_size += size;
+    }
+
+    void write_slot(size_t idx) {
+        auto release = [this, idx]() {
+            {
+                MGB_LOCK_GUARD(m_mtx);
+                m_free_slots.push_back(idx);
+            }
+            m_cv_slot_freed.notify_one();
+        };
+        MGB_TRY {
+            auto&& slot = m_slots[idx];
+            slot.event->host_wait();
+            auto&& layout = slot.val.layout();
+
+            async_iodump::RecordHeader header;
+            memset(&header, 0, sizeof(header));
+            header.exec_id = slot.exec_id;
+            header.var_id = slot.var_id;
+            header.opr_id = slot.opr_id;
+            header.nr_bytes = layout.span().dist_byte();
+            header.dtype = static_cast<uint32_t>(layout.dtype.enumv());
+            header.ndim = layout.ndim;
+            async_iodump::get_dtype_param(layout.dtype, header.scale,
+                                          header.zero_point);
+            header.var_name_len = slot.var_name.size();
+            header.opr_name_len = slot.opr_name.size();
+            for (size_t i = 0; i < layout.ndim; ++i) {
+                header.shape[i] = layout.shape[i];
+            }
+
+            m_offsets.push_back(m_file_size);
+            write(&header, sizeof(header));
+            write(slot.var_name.data(), slot.var_name.size());
+            write(slot.opr_name.data(), slot.opr_name.size());
+            write(slot.val.raw_ptr(), header.nr_bytes);
+        }
+        MGB_CATCH(..., {
+            release();
+            throw;
+        });
+        release();
+    }
+
+    size_t acquire_slot() {
+        std::unique_lock<std::mutex> lk{m_mtx};
+        m_cv_slot_freed.wait(lk, [this]() { return !m_free_slots.empty(); });
+        auto ret = m_free_slots.front();
+        m_free_slots.pop_front();
+        return ret;
+    }
+
+public:
+    Impl(const char* fpath, const Options& options)
+            : m_options{options}, m_slots(options.nr_buffer) {
+        mgb_assert(options.nr_buffer && options.exec_interval,
+                   "nr_buffer and exec_interval of AsyncOprIODump must be "
+                   "positive");
+        auto fout = fopen(fpath, "wb");
+        mgb_throw_if(!fout, SystemError, "failed to open %s: %s", fpath,
+                     strerror(errno));
+        m_fout.reset(fout, fclose);
+        for (size_t i = 0; i < m_slots.size(); ++i) {
+            m_free_slots.push_back(i);
+        }
+        if (!options.opr_filter.empty()) {
+            m_opr_filter = std::regex{options.opr_filter};
+        }
+
+        async_iodump::FileHeader header{async_iodump::MAGIC,
+                                        async_iodump::VERSION,
+                                        TensorShape::MAX_NDIM};
+        write(&header, sizeof(header));
+    }
+
+    ~Impl() {
+        m_writer.wait_task_queue_empty();
+        async_iodump::FileFooter footer{m_file_size, m_offsets.size(),
+                                        async_iodump::MAGIC};
+        write(m_offsets.data(), m_offsets.size() * sizeof(uint64_t));
+        write(&footer, sizeof(footer));
+    }
+
+    void on_exec_start() {
+        m_cur_exec = m_nr_exec++;
+        m_cur_exec_sampled = m_cur_exec % m_options.exec_interval == 0;
+    }
+
+    bool should_dump(cg::OperatorNodeBase* opr) {
+        if (!m_cur_exec_sampled) {
+            return false;
+        }
+        if (m_options.opr_filter.empty()) {
+            return true;
+        }
+        MGB_LOCK_GUARD(m_mtx);
+        auto ins = m_opr_filter_result.insert({opr, false});
+        if (ins.second) {
+            ins.first->second = std::regex_search(opr->name(), m_opr_filter);
+        }
+        return ins.first->second;
+    }
+
+    void record(VarNode* var) {
+        auto&& dv = var->dev_tensor();
+        auto&& slot = m_slots[acquire_slot()];
+        auto cn = var->comp_node();
+        if (slot.cn != cn) {
+            slot.cn = cn;
+            slot.event = cn.create_event();
+            slot.dv_contig = DeviceTensorND{cn};
+            slot.val = HostTensorND{cn};
+        }
+        slot.val.dtype(dv.dtype());
+        if (!dv.layout().is_contiguous()) {
+            slot.dv_contig.dtype(dv.dtype()).copy_from(dv);
+            slot.val.copy_from(slot.dv_contig);
+        } else {
+            slot.val.copy_from(dv);
+        }
+        slot.event->record();
+
+        auto opr = var->owner_opr();
+        slot.exec_id = m_cur_exec;
+        slot.var_id = var->id();
+        slot.opr_id = opr->id();
+        slot.var_name = var->name();
+        slot.opr_name = opr->name();
+        m_writer.add_task(&slot - m_slots.data());
+    }
+
+    void flush() {
+        m_writer.wait_all_task_finish();
+        fflush(m_fout.get());
+    }
+};
+
+AsyncOprIODump::AsyncOprIODump(cg::ComputingGraph* graph, const char* fpath,
+                               const Options& options)
+        : OprIODumpBase(graph), m_impl{std::make_unique<Impl>(fpath, options)} {
+    auto on_exec_start = [this](const cg::event::CompSeqExecBeforeStart&) {
+        m_impl->on_exec_start();
+    };
+    add_event_handler(
+            graph->event().register_receiver<cg::event::CompSeqExecBeforeStart>(
+                    on_exec_start));
+}
+
+AsyncOprIODump::~AsyncOprIODump() = default;
+
+bool AsyncOprIODump::should_dump(cg::OperatorNodeBase* opr) {
+    return m_impl->should_dump(opr);
+}
+
+void AsyncOprIODump::dump_var(VarNode* var, bool lazy_sync) {
+    mgb_throw_if(lazy_sync, MegBrainError,
+                 "AsyncOprIODump does not support comp_node_seq_record_level");
+    if (var->dev_tensor_valid()) {
+        m_impl->record(var);
+    }
+}
+
+void AsyncOprIODump::flush_lazy() {
+    m_impl->flush();
+}
+
+AsyncOprIODump::Reader::Reader(const char* fpath) {
+    using namespace async_iodump;
+    auto fin = fopen(fpath, "rb");
+    mgb_throw_if(!fin, SystemError, "failed to open %s: %s", fpath,
+                 strerror(errno));
+    m_fin.reset(fin, fclose);
+
+    FileHeader header;
+    read_exact(fin, &header, sizeof(header));
+    mgb_throw_if(header.magic != MAGIC || header.version != VERSION,
+                 SerializationError, "%s is not an async io dump file", fpath);
+    mgb_throw_if(header.max_ndim != TensorShape::MAX_NDIM, SerializationError,
+                 "MAX_NDIM mismatch in async io dump: file=%u expect=%zu",
+                 header.max_ndim, TensorShape::MAX_NDIM);
+
+    fseek(fin, 0, SEEK_END);
+    uint64_t file_size = ftell(fin);
+    if (file_size >= sizeof(FileHeader) + sizeof(FileFooter)) {
+        FileFooter footer;
+        fseek(fin, file_size - sizeof(FileFooter), SEEK_SET);
+        read_exact(fin, &footer, sizeof(footer));
+        if (footer.magic == MAGIC &&
+            footer.index_offset + footer.nr_record * sizeof(uint64_t) +
+                            sizeof(FileFooter) ==
+                    file_size) {
+            m_offsets.resize(footer.nr_record);
+            fseek(fin, footer.index_offset, SEEK_SET);
+            read_exact(fin, m_offsets.data(),
+                       m_offsets.size() * sizeof(uint64_t));
+            return;
+        }
+    }
+
+    // the writer did not finish; scan the complete records
+    uint64_t offset = sizeof(FileHeader);
+    while (offset + sizeof(RecordHeader) <= file_size) {
+        RecordHeader rec;
+        fseek(fin, offset, SEEK_SET);
+        read_exact(fin, &rec, sizeof(rec));
+        uint64_t end = offset + sizeof(rec) + rec.var_name_len +
+                       rec.opr_name_len + rec.nr_bytes;
+        if (end > file_size) {
+            break;
+        }
+        m_offsets.push_back(offset);
+        offset = end;
+    }
+}
+
+AsyncOprIODump::Reader::Record AsyncOprIODump::Reader::read(size_t idx) const {
+    using namespace async_iodump;
+    auto fin = m_fin.get();
+    fseek(fin, m_offsets.at(idx), SEEK_SET);
+    RecordHeader header;
+    read_exact(fin, &header, sizeof(header));
+    mgb_throw_if(header.ndim > TensorShape::MAX_NDIM, SerializationError,
+                 "bad ndim in async io dump: %u", header.ndim);
+
+    Record ret;
+    ret.exec_id = header.exec_id;
+    ret.var_id = header.var_id;
+    ret.opr_id = header.opr_id;
+    ret.var_name.resize(header.var_name_len);
+    ret.opr_name.resize(header.opr_name_len);
+    read_exact(fin, &ret.var_name[0], header.var_name_len);
+    read_exact(fin, &ret.opr_name[0], header.opr_name_len);
+
+    TensorShape shape;
+    shape.ndim = header.ndim;
+    for (size_t i = 0; i < shape.ndim; ++i) {
+        shape.shape[i] = header.shape[i];
+    }
+    ret.value = {CompNode::default_cpu(), shape,
+                 make_dtype(header.dtype, header.scale, header.zero_point)};
+    mgb_throw_if(ret.value.layout().span().dist_byte() != header.nr_bytes,
+                 SerializationError, "tensor size mismatch in async io dump");
+    read_exact(fin, ret.value.raw_ptr(), header.nr_bytes);
+    return ret;
+}
+
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -13,9 +13,17 @@
 #include "megbrain/plugin/opr_footprint.h"
 
 #if MGB_ENABLE_JSON
+#include "megbrain/comp_node_env.h"
 #include "megbrain/graph/event.h"
+#include "megbrain/opr/internal/megdnn_opr_wrapper.h"
 #include "megbrain/opr/io.h"
 #include "megbrain/system.h"
+#include "megbrain/utils/arith_helper.h"
+
+#include "megdnn/oprs.h"
+
+#include <cstring>
+#include <limits>
 
 using namespace mgb;
 using namespace cg;
@@ -219,6 +227,174 @@ std::shared_ptr<json::Object> GraphProfiler::to_json() const {
                          {"opr_internal_pf", opr_internal_pf}});
 }
 
+/* ===================== CompNodeRoofline ===================== */
+
+namespace {
+//! best time in seconds of running \p func on \p cn
+template <typename Func>
+double benchmark_on_comp_node(CompNode cn, Func&& func) {
+    constexpr int RUNS = 3;
+    auto start = cn.create_event(CompNode::Event::NEED_TIMER),
+         end = cn.create_event(CompNode::Event::NEED_TIMER);
+    // warm up
+    func();
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < RUNS; ++i) {
+        start->record();
+        func();
+        end->record();
+        end->host_wait();
+        best = std::min(best, start->elapsed_time_until(*end));
+    }
+    return best;
+}
+}  // anonymous namespace
+
+CompNodeRoofline CompNodeRoofline::measure(CompNode cn) {
+    bool is_cpu = cn.device_type() == CompNode::DeviceType::CPU ||
+                  cn.device_type() == CompNode::DeviceType::MULTITHREAD;
+    CompNodeRoofline ret;
+
+    // computation: n * n * n matmul
+    {
+        size_t n = is_cpu ? 1024 : 4096;
+        auto matmul = opr::intl::create_megdnn_opr<megdnn::MatrixMul>(cn);
+        DeviceTensorND a{cn, {n, n}, dtype::Float32()},
+                b{cn, {n, n}, dtype::Float32()},
+                c{cn, {n, n}, dtype::Float32()};
+        dev_tensor_memset(a, 0);
+        dev_tensor_memset(b, 0);
+        size_t ws_size = matmul->get_workspace_in_bytes(a.layout(), b.layout(),
+                                                        c.layout());
+        DeviceTensorStorage ws{cn};
+        ws.ensure_size(ws_size);
+        megdnn::Workspace workspace{ws.ptr(), ws_size};
+        auto time = benchmark_on_comp_node(cn, [&]() {
+            matmul->exec(a.as_megdnn(), b.as_megdnn(), c.as_megdnn(),
+                         workspace);
+        });
+        ret.gflops = 2.0 * n * n * n / time * 1e-9;
+    }
+
+    // memory bandwidth: copy a buffer much larger than the cache
+    {
+        size_t nr_elem = (is_cpu ? 64 : 256) << 20 >> 2;
+        DeviceTensorND src{cn, {nr_elem}, dtype::Float32()},
+                dst{cn, {nr_elem}, dtype::Float32()};
+        dev_tensor_memset(src, 0);
+        dev_tensor_memset(dst, 0);
+        thin_function<void()> copy;
+        if (is_cpu) {
+            // split the copy over all the threads of the comp node, as the
+            // matmul above does, so both peaks are measured with the same
+            // parallelism
+            auto&& env = CompNodeEnv::from_comp_node(cn).cpu_env();
+            size_t nr_threads = env.dispatcher->nr_threads(),
+                   size = nr_elem * sizeof(float),
+                   chunk = get_aligned_power2<size_t>(
+                           (size + nr_threads - 1) / nr_threads, 64);
+            auto sptr = src.raw_ptr(), dptr = dst.raw_ptr();
+            copy = [&env, nr_threads, size, chunk, sptr, dptr]() {
+                env.dispatch(
+                        [=](size_t index, size_t) {
+                            size_t begin = std::min(index * chunk, size),
+                                   end = std::min(begin + chunk, size);
+                            memcpy(dptr + begin, sptr + begin, end - begin);
+                        },
+                        nr_threads);
+            };
+        } else {
+            copy = [&]() { dst.copy_from_fixlayout(src); };
+        }
+        auto time = benchmark_on_comp_node(cn, copy);
+        ret.gbps = 2.0 * nr_elem * sizeof(float) / time * 1e-9;
+    }
+    return ret;
+}
+
+std::shared_ptr<json::Object> GraphProfiler::roofline_report(
+        const CompNode::UnorderedMap<CompNodeRoofline>& given_rooflines)
+        const {
+    using namespace json;
+    CompNode::UnorderedMap<CompNodeRoofline> rooflines;
+    struct Item {
+        OperatorNodeBase* opr;
+        CompNode cn;
+        double time, bound_time;
+    };
+    std::vector<Item> items;
+    for (auto&& kern_ev : m_kern_event) {
+        auto&& event = kern_ev.second;
+        if (!event.kern || !event.end) {
+            continue;
+        }
+        auto fp_iter = m_opr_fp_rst.find(kern_ev.first.first);
+        if (fp_iter == m_opr_fp_rst.end()) {
+            continue;
+        }
+        auto cn = kern_ev.first.second;
+        if (!rooflines.count(cn)) {
+            auto iter = given_rooflines.find(cn);
+            rooflines[cn] = iter != given_rooflines.end()
+                                    ? iter->second
+                                    : CompNodeRoofline::measure(cn);
+        }
+        auto&& roofline = rooflines.at(cn);
+        auto&& fp = fp_iter->second;
+        event.end->host_wait();
+        double time = event.kern->elapsed_time_until(*event.end),
+               bound = std::max(fp.computation / (roofline.gflops * 1e9),
+                                fp.memory / (roofline.gbps * 1e9));
+        items.push_back({kern_ev.first.first, cn, time, bound});
+    }
+    small_sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+        return a.time - a.bound_time > b.time - b.bound_time;
+    });
+
+    auto oprs = Array::make();
+    double tot_time = 0, tot_lost = 0;
+    for (auto&& i : items) {
+        auto&& fp = m_opr_fp_rst.at(i.opr);
+        auto&& roofline = rooflines.at(i.cn);
+        double lost = std::max(i.time - i.bound_time, 0.0);
+        tot_time += i.time;
+        tot_lost += lost;
+        bool compute_bound = fp.computation / roofline.gflops >
+                             fp.memory / roofline.gbps;
+        auto item = Object::make(
+                {{"id", String::make(i.opr->id_str())},
+                 {"name", String::make(i.opr->name())},
+                 {"type", String::make(i.opr->dyn_typeinfo()->name)},
+                 {"comp_node", String::make(i.cn.to_string())},
+                 {"time", Number::make(i.time)},
+                 {"computation", NumberInt::make(fp.computation)},
+                 {"memory", NumberInt::make(fp.memory)},
+                 {"gflops", Number::make(fp.computation / i.time * 1e-9)},
+                 {"gbps", Number::make(fp.memory / i.time * 1e-9)},
+                 {"arith_intensity",
+                  Number::make(fp.memory ? static_cast<double>(
+                                                   fp.computation) /
+                                                   fp.memory
+                                         : 0.0)},
+                 {"bound", String::make(compute_bound ? "compute" : "memory")},
+                 {"efficiency",
+                  Number::make(i.time > 0 ? i.bound_time / i.time : 1.0)},
+                 {"lost_time", Number::make(lost)}});
+        oprs->add(item);
+    }
+
+    auto rooflines_json = Object::make();
+    for (auto&& i : rooflines) {
+        (*rooflines_json)[i.first.to_string()] =
+                Object::make({{"gflops", Number::make(i.second.gflops)},
+                              {"gbps", Number::make(i.second.gbps)}});
+    }
+    return Object::make({{"rooflines", rooflines_json},
+                         {"total_time", Number::make(tot_time)},
+                         {"total_lost_time", Number::make(tot_lost)},
+                         {"oprs", oprs}});
+}
+
 #endif  // MGB_ENABLE_JSON
 
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
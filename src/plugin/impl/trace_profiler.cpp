@@ -0,0 +1,255 @@
+/**
+ * \file src/plugin/impl/trace_profiler.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "megbrain/plugin/trace_profiler.h"
+#include "megbrain/comp_node_env.h"
+#include "megbrain/graph/event.h"
+#include "megbrain/graph/helper.h"
+#include "megbrain/utils/debug.h"
+#include "megbrain/utils/trace_recorder.h"
+
+using namespace mgb;
+using namespace cg;
+
+namespace {
+
+using TR = TraceRecorder;
+
+void append_json_str(std::string& dest, const std::string& str) {
+    dest += '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            dest += '\\';
+            dest += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            dest += ssprintf("\\u%04x", c);
+        } else {
+            dest += c;
+        }
+    }
+    dest += '"';
+}
+
+const char* type_name(TR::Type type) {
+    switch (type) {
+        case TR::Type::OPR:
+            return "opr";
+        case TR::Type::KERN_DISPATCH:
+            return "kern_dispatch";
+        case TR::Type::KERN:
+            return "kern";
+        case TR::Type::THREAD_POOL_TASK:
+            return "thread_pool_task";
+        case TR::Type::ALLOC:
+            return "alloc";
+        case TR::Type::FREE:
+            return "free";
+    }
+    return "unknown";
+}
+
+bool is_cpu(CompNode cn) {
+    return cn.device_type() == CompNode::DeviceType::CPU ||
+           cn.device_type() == CompNode::DeviceType::MULTITHREAD;
+}
+
+}  // anonymous namespace
+
+TraceProfiler::TraceProfiler(cg::ComputingGraph* graph, size_t exec_interval)
+        : PluginBase(graph), m_exec_interval{exec_interval} {
+    mgb_assert(exec_interval, "exec_interval of TraceProfiler must be "
+                              "positive");
+    using namespace cg::event;
+
+    auto on_seq_order = [this](const CompSeqOrderDetermined& event) {
+        MGB_LOCK_GUARD(m_mtx);
+        event.exec->iter_opr_seq([this](OperatorNodeBase* opr) {
+            m_opr_names[opr->id()] =
+                    ssprintf("%s{%s}", opr->cname(), opr->dyn_typeinfo()->name);
+            return true;
+        });
+    };
+    auto on_seq_start = [this](const CompSeqExecBeforeStart&) {
+        m_cur_exec_sampled = m_nr_exec++ % m_exec_interval == 0;
+        m_unfinished_exec.push_back(m_cur_exec_sampled);
+        if (m_cur_exec_sampled) {
+            TR::inst().activate();
+        }
+    };
+    auto on_seq_finish = [this](const CompSeqExecFinished&) { on_exec_end(); };
+    auto on_seq_error = [this](const CompSeqExecError&) { on_exec_end(); };
+
+    auto on_opr_start = [this](const OprExecStart& event) {
+        if (!m_cur_exec_sampled)
+            return;
+        auto id = event.opr->id();
+        for (auto&& cn : get_opr_comp_node_set(event.opr)) {
+            auto runner = [id]() {
+                TR::record(TR::Type::OPR, TR::Phase::BEGIN, id);
+            };
+            event.env->dispatch_on_comp_node(cn, runner);
+        }
+    };
+    auto on_opr_finish = [this](const OprExecFinished& event) {
+        if (!m_cur_exec_sampled)
+            return;
+        auto id = event.opr->id();
+        for (auto&& cn : get_opr_comp_node_set(event.opr)) {
+            auto runner = [id]() {
+                TR::record(TR::Type::OPR, TR::Phase::END, id);
+            };
+            event.env->dispatch_on_comp_node(cn, runner);
+        }
+    };
+    auto on_before_kern = [this](const BeforeKernel& event) {
+        if (!m_cur_exec_sampled)
+            return;
+        auto id = event.opr->id();
+        TR::record(TR::Type::KERN_DISPATCH, TR::Phase::BEGIN, id);
+        if (is_cpu(event.comp_node)) {
+            CompNodeEnv::from_comp_node(event.comp_node)
+                    .cpu_env()
+                    .dispatch([id]() {
+                        TR::record(TR::Type::KERN, TR::Phase::BEGIN, id);
+                    });
+        }
+    };
+    auto on_after_kern = [this](const AfterKernel& event) {
+        if (!m_cur_exec_sampled)
+            return;
+        auto id = event.opr->id();
+        if (is_cpu(event.comp_node)) {
+            CompNodeEnv::from_comp_node(event.comp_node)
+                    .cpu_env()
+                    .dispatch([id]() {
+                        TR::record(TR::Type::KERN, TR::Phase::END, id);
+                    });
+        }
+        TR::record(TR::Type::KERN_DISPATCH, TR::Phase::END, id);
+    };
+
+    auto&& ev = graph->event();
+    add_event_handler(
+            ev.register_receiver<CompSeqOrderDetermined>(on_seq_order));
+    add_event_handler(
+            ev.register_receiver<CompSeqExecBeforeStart>(on_seq_start));
+    add_event_handler(ev.register_receiver<CompSeqExecFinished>(on_seq_finish));
+    add_event_handler(ev.register_receiver<CompSeqExecError>(on_seq_error));
+    add_event_handler(ev.register_receiver<OprExecStart>(on_opr_start));
+    add_event_handler(ev.register_receiver<OprExecFinished>(on_opr_finish));
+    add_event_handler(ev.register_receiver<BeforeKernel>(on_before_kern));
+    add_event_handler(ev.register_receiver<AfterKernel>(on_after_kern));
+}
+
+TraceProfiler::~TraceProfiler() {
+    for (bool sampled : m_unfinished_exec) {
+        if (sampled) {
+            TR::inst().deactivate();
+        }
+    }
+}
+
+void TraceProfiler::on_exec_end() {
+    if (m_unfinished_exec.empty()) {
+        return;
+    }
+    bool sampled = m_unfinished_exec.front();
+    m_unfinished_exec.pop_front();
+    if (sampled) {
+        TR::inst().deactivate();
+    }
+}
+
+std::string TraceProfiler::to_chrome_trace(bool clear) {
+    auto&& recorder = TR::inst();
+    auto all_records = recorder.collect(clear);
+    std::string ret = "{\"traceEvents\":[";
+    bool first = true;
+    auto begin_event = [&]() {
+        if (!first) {
+            ret += ",\n";
+        }
+        first = false;
+    };
+
+    bool has_record = false;
+    for (auto&& i : all_records) {
+        has_record |= !i.records.empty();
+    }
+    if (has_record) {
+        auto time_base = recorder.time_base();
+        MGB_LOCK_GUARD(m_mtx);
+        for (auto&& thread : all_records) {
+            if (thread.records.empty()) {
+                continue;
+            }
+            begin_event();
+            ret += ssprintf(
+                    "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+                    "\"tid\":%zu,\"args\":{\"name\":\"thread%zu\","
+                    "\"nr_dropped\":%zu}}",
+                    thread.tid, thread.tid, thread.nr_dropped);
+            for (auto&& rec : thread.records) {
+                begin_event();
+                ret += "{\"name\":";
+                switch (rec.type) {
+                    case TR::Type::OPR:
+                    case TR::Type::KERN_DISPATCH:
+                    case TR::Type::KERN: {
+                        auto iter = m_opr_names.find(rec.id);
+                        append_json_str(
+                                ret, iter != m_opr_names.end()
+                                             ? iter->second
+                                             : ssprintf("opr%zu",
+                                                        static_cast<size_t>(
+                                                                rec.id)));
+                        break;
+                    }
+                    case TR::Type::THREAD_POOL_TASK:
+                        ret += ssprintf("\"task%zu\"",
+                                        static_cast<size_t>(rec.id));
+                        break;
+                    default:
+                        ret += ssprintf("\"%s\"", type_name(rec.type));
+                }
+                const char* phase = rec.phase == TR::Phase::BEGIN
+                                            ? "B"
+                                            : (rec.phase == TR::Phase::END
+                                                       ? "E"
+                                                       : "i\",\"s\":\"t");
+                ret += ssprintf(
+                        ",\"cat\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,"
+                        "\"pid\":0,\"tid\":%zu",
+                        type_name(rec.type), phase,
+                        time_base.to_nsec(rec.tsc) * 1e-3, thread.tid);
+                if (rec.type == TR::Type::ALLOC ||
+                    rec.type == TR::Type::FREE) {
+                    ret += ssprintf(",\"args\":{\"ptr\":\"0x%zx\","
+                                    "\"size\":%zu}",
+                                    static_cast<size_t>(rec.id),
+                                    static_cast<size_t>(rec.arg));
+                } else if (rec.type == TR::Type::THREAD_POOL_TASK) {
+                    ret += ssprintf(",\"args\":{\"worker\":%zu}",
+                                    static_cast<size_t>(rec.arg));
+                }
+                ret += "}";
+            }
+        }
+    }
+    ret += "],\"displayTimeUnit\":\"ns\"}\n";
+    return ret;
+}
+
+void TraceProfiler::write_chrome_trace(const char* fpath, bool clear) {
+    debug::write_to_file(fpath, to_chrome_trace(clear));
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
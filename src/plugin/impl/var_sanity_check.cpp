@@ -21,7 +21,9 @@ using namespace mgb;
 
 #define LOG_DETAILS_ENV_VAR_NAME "MGB_DEBUG_VAR_SANITY_CHECK_LOG"
 
-VarSanityCheck::VarSanityCheck(cg::ComputingGraph* graph) : PluginBase(graph) {
+VarSanityCheck::VarSanityCheck(cg::ComputingGraph* graph)
+        : PluginBase(graph),
+          m_mem_fwd_only{graph->options().var_sanity_check_mem_fwd_only} {
     auto on_exec_start = [this](const cg::event::OprExecKernelStart& event) {
         setup_input_checker(true, event.opr, *event.env,
                             &VarSanityCheck::on_var_received);
@@ -41,8 +43,20 @@ VarSanityCheck::VarSanityCheck(cg::ComputingGraph* graph) : PluginBase(graph) {
                 var->contain_flag(VarNode::Flag::VOLATILE_CONTENT))
                 continue;
 
+            VarNode* mem_owner = nullptr;
+            if (m_mem_fwd_only) {
+                mem_owner = get_mem_fwd_owner(var);
+                if (!mem_owner)
+                    continue;
+            }
+
             m_debug_log.add_producer(var);
-            auto callback = [this, var]() { on_var_produced(var); };
+            auto callback = [this, var, mem_owner]() {
+                if (mem_owner) {
+                    on_mem_fwd_owner(mem_owner);
+                }
+                on_var_produced(var);
+            };
             event.env->dispatch_on_comp_node(var->comp_node(), callback);
         }
 
@@ -226,6 +240,26 @@ void VarSanityCheck::on_var_produced(VarNode* var) {
     }
 }
 
+VarNode* VarSanityCheck::get_mem_fwd_owner(VarNode* var) {
+    if (!var->mem_plan().valid() || var->mem_plan().is_invalid_cond_exec())
+        return nullptr;
+    auto owner = var->mem_plan().chunk().owner_var;
+    return owner == var ? nullptr : owner;
+}
+
+void VarSanityCheck::on_mem_fwd_owner(VarNode* owner) {
+    {
+        MGB_LOCK_GUARD(m_id2chksum_mtx);
+        if (m_var2chksum.count(owner))
+            return;
+    }
+    // the owner var is checked by its later receivers from now on; its
+    // content when produced is not known, since it was not checked then
+    auto checksum = calc_checksum(owner);
+    MGB_LOCK_GUARD(m_id2chksum_mtx);
+    m_var2chksum.emplace(owner, checksum);
+}
+
 void VarSanityCheck::on_var_received(cg::OperatorNodeBase* recv_opr,
                                      VarNode* var) {
     check_single_input(true, recv_opr, var);
@@ -247,6 +281,13 @@ void VarSanityCheck::check_single_input(bool add_debug_log,
     if (var->contain_flag(VarNode::Flag::DISALLOW_VAR_SANITY_CHECK))
         return;
 
+    if (m_mem_fwd_only) {
+        // vars not involved in memory forwarding are not recorded
+        MGB_LOCK_GUARD(m_id2chksum_mtx);
+        if (!m_var2chksum.count(var))
+            return;
+    }
+
     auto checksum = calc_checksum(var);
 
     ChecksumResult checksum_expect;
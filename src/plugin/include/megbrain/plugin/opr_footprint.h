@@ -19,7 +19,9 @@ namespace mgb {
  */
 class OprFootprint {
     //! function to calculate compution of a given operator
-    using CompFootprintTrait = thin_function<uint64_t(cg::OperatorNodeBase*)>;
+    using CompFootprintTrait = thin_function<uint64_t(
+            cg::OperatorNodeBase*, const TensorShapeArray&,
+            const TensorShapeArray&)>;
     ThinHashMap<Typeinfo*, CompFootprintTrait> m_type2comp_footprint;
 #if MGB_ENABLE_JSON
     using ParamJsonTrait =
@@ -77,6 +79,16 @@ public:
     Result calc_footprint(cg::OperatorNodeBase* opr);
     //! get computation of a given operator
     uint64_t get_computation(cg::OperatorNodeBase* opr);
+    /*!
+     * \brief get computation of a given operator with given shapes of all
+     *      its inputs and outputs
+     *
+     * This can be used before the shapes are set on the vars, e.g. with
+     * shapes from static inference during graph compiling.
+     */
+    uint64_t get_computation(cg::OperatorNodeBase* opr,
+                             const TensorShapeArray& inp_shapes,
+                             const TensorShapeArray& out_shapes);
 #if MGB_ENABLE_JSON
     std::shared_ptr<json::Value> get_param_json(cg::OperatorNodeBase* opr);
     //! get opr foot print and graph exec info
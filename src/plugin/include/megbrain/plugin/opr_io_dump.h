@@ -30,6 +30,15 @@ protected:
      */
     virtual void dump_var(VarNode* var, bool lazy_sync) = 0;
 
+    /*!
+     * \brief whether outputs of an opr should be dumped; it is called from
+     *      the kernel dispatching thread before dump_var() is dispatched
+     */
+    virtual bool should_dump(cg::OperatorNodeBase* opr) {
+        MGB_MARK_USED_VAR(opr);
+        return true;
+    }
+
     OprIODumpBase(cg::ComputingGraph* graph);
 
 public:
@@ -114,6 +123,77 @@ public:
     void flush_lazy() override;
 };
 
+/*!
+ * \brief dump opr output vars to a single indexed binary file without
+ *      synchronizing the computing nodes
+ *
+ * Output values are asynchronously copied into a fixed number of reusable
+ * host buffers, and written to file by a background thread after the copies
+ * finish; execution only blocks when all the buffers are waiting to be
+ * written. Outputs can be sampled by execution count and by opr name.
+ *
+ * The file can be read by AsyncOprIODump::Reader or the
+ * ``megbrain.plugin.load_async_io_dump`` python function. Note that
+ * comp_node_seq_record_level is not supported.
+ */
+class AsyncOprIODump final : public OprIODumpBase {
+public:
+    struct Options {
+        //! number of host buffers that hold values waiting to be written
+        size_t nr_buffer = 16;
+        //! only dump in one out of every so many executions
+        size_t exec_interval = 1;
+        //! if not empty, only dump oprs whose names match this regex
+        std::string opr_filter;
+    };
+
+    class Reader;
+
+    AsyncOprIODump(cg::ComputingGraph* graph, const char* fpath,
+                   const Options& options);
+    AsyncOprIODump(cg::ComputingGraph* graph, const char* fpath)
+            : AsyncOprIODump(graph, fpath, Options{}) {}
+    ~AsyncOprIODump();
+
+    //! wait for all the dispatched values to be written to file
+    void flush_lazy() override;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> m_impl;
+
+    void dump_var(VarNode* var, bool lazy_sync) override;
+    bool should_dump(cg::OperatorNodeBase* opr) override;
+};
+
+/*!
+ * \brief read the values dumped by AsyncOprIODump
+ *
+ * Files not properly closed by the writer (e.g. due to crash) can also be
+ * read, in which case records are found by scanning the file.
+ */
+class AsyncOprIODump::Reader : public NonCopyableObj {
+public:
+    struct Record {
+        //! index of the execution in which this value is produced
+        size_t exec_id;
+        size_t var_id, opr_id;
+        std::string var_name, opr_name;
+        HostTensorND value;
+    };
+
+    explicit Reader(const char* fpath);
+
+    //! number of records in the file
+    size_t size() const { return m_offsets.size(); }
+
+    Record read(size_t idx) const;
+
+private:
+    std::shared_ptr<FILE> m_fin;
+    std::vector<uint64_t> m_offsets;
+};
+
 }  // namespace mgb
 
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -36,6 +36,25 @@ public:
 }  // namespace opr_profile
 
 namespace mgb {
+/*!
+ * \brief peak computation throughput and memory bandwidth of a comp node,
+ *      used as the roofline to evaluate the efficiency of oprs
+ */
+struct CompNodeRoofline {
+    double gflops = 0;  //!< peak float32 throughput in GFLOPS
+    double gbps = 0;    //!< peak memory bandwidth in GB/s
+
+    /*!
+     * \brief measure by microbenchmarks on the comp node: a large float32
+     *      matrix multiplication for computation throughput, and a large
+     *      device-to-device copy for memory bandwidth
+     *
+     * On CPU comp nodes the copy is split over all the threads of the comp
+     * node, so both peaks are measured with the same parallelism.
+     */
+    static CompNodeRoofline measure(CompNode cn);
+};
+
 /*!
  * \brief graph profiler for operators
  */
@@ -93,6 +112,22 @@ public:
      */
     std::shared_ptr<json::Object> to_json() const;
 
+    /*!
+     * \brief evaluate the kernel time of each profiled opr against the
+     *      roofline of its comp node
+     *
+     * Achieved GFLOPS and GB/s are computed from the footprint and kernel
+     * time in the last execution, and oprs are ranked by the time lost
+     * compared to the roofline bound max(computation / peak_flops,
+     * memory / peak_bandwidth).
+     *
+     * \param rooflines roofline of each comp node; comp nodes not given
+     *      would be measured by CompNodeRoofline::measure()
+     */
+    std::shared_ptr<json::Object> roofline_report(
+            const CompNode::UnorderedMap<CompNodeRoofline>& rooflines = {})
+            const;
+
     /*!
      * \brief dump to visualizer format
      */
@@ -0,0 +1,66 @@
+/**
+ * \file src/plugin/include/megbrain/plugin/trace_profiler.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include "megbrain/graph.h"
+#include "megbrain/plugin/base.h"
+
+#include <deque>
+
+namespace mgb {
+
+/*!
+ * \brief low overhead profiler that records events by TraceRecorder and
+ *      exports them in chrome trace format
+ *
+ * Unlike GraphProfiler, no lock is taken and no comp node event is created
+ * on the execution path, so it can be left enabled on live traffic. Host
+ * side opr execution and kernel dispatching are recorded for all comp
+ * nodes, and kernel execution is recorded on CPU workers. Thread pool tasks
+ * and device memory allocation are recorded process-wide while a sampled
+ * execution is running.
+ *
+ * The result can be viewed in chrome://tracing or perfetto.
+ */
+class TraceProfiler final : public PluginBase {
+    const size_t m_exec_interval;
+    size_t m_nr_exec = 0;
+    bool m_cur_exec_sampled = false;
+    //! whether each of the unfinished executions is sampled
+    std::deque<bool> m_unfinished_exec;
+
+    std::mutex m_mtx;
+    //! opr id => opr name and type
+    ThinHashMap<size_t, std::string> m_opr_names;
+
+    void on_exec_end();
+
+public:
+    /*!
+     * \param exec_interval only record one out of every so many executions
+     */
+    explicit TraceProfiler(cg::ComputingGraph* graph, size_t exec_interval = 1);
+    ~TraceProfiler();
+
+    /*!
+     * \brief convert the events recorded so far to chrome trace json
+     * \param clear whether to clear the records after conversion
+     */
+    std::string to_chrome_trace(bool clear = true);
+
+    //! write the result of to_chrome_trace() to file
+    void write_chrome_trace(const char* fpath, bool clear = true);
+};
+
+}  // namespace mgb
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
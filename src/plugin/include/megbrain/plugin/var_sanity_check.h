@@ -55,6 +55,9 @@ class VarSanityCheck final : public PluginBase {
 
     DebugLog m_debug_log{this};
 
+    //! see ComputingGraph::Options::var_sanity_check_mem_fwd_only
+    const bool m_mem_fwd_only;
+
     //! map from caller thread to workspace map
     ThinHashMap<std::thread::id, WorkspaceCache> m_workspace;
     std::mutex m_workspace_mtx;
@@ -71,6 +74,16 @@ class VarSanityCheck final : public PluginBase {
                                                      VarNode*);
 
     void on_var_produced(VarNode* var);
+
+    /*!
+     * \brief get the owner var of the memory chunk if memory of \p var is
+     *      forwarded from another var; return nullptr otherwise
+     */
+    static VarNode* get_mem_fwd_owner(VarNode* var);
+
+    //! record checksum of a var whose memory is forwarded to other vars
+    void on_mem_fwd_owner(VarNode* owner);
+
     void on_var_received(cg::OperatorNodeBase* recv_opr, VarNode* var);
     //! check after opr exec that input is not modified
     void check_input_unmodified(cg::OperatorNodeBase* recv_opr, VarNode* var);
@@ -187,5 +187,46 @@ TEST(TestOprIODump, Binary) {
     run_test(make_plugin, []() {});
 }
 
+TEST(TestOprIODump, Async) {
+    auto fname = output_file("test_opr_iodump_async.bin");
+    HostTensorGenerator<> gen;
+    auto host_x = gen({2, 3}, CompNode::load("cpu0"));
+    auto graph = ComputingGraph::make();
+    graph->options().graph_opt_level = 0;
+    AsyncOprIODump::Options options;
+    options.nr_buffer = 2;
+    options.exec_interval = 2;
+    options.opr_filter = "^mul";
+    auto plug = std::make_unique<AsyncOprIODump>(graph.get(), fname.c_str(),
+                                                 options);
+
+    auto x = opr::Host2DeviceCopy::make(*graph, host_x, {"x"}),
+         y = opr::Elemwise::make({opr::relu(x), x.make_scalar(2.f)},
+                                 opr::Elemwise::Mode::MUL, {"mul"});
+    HostTensorND host_y;
+    auto func = graph->compile({make_callback_copy(y, host_y)});
+    std::vector<HostTensorND> expect;
+    for (int i = 0; i < 5; ++i) {
+        host_x->copy_from(*gen({2, 3}));
+        func->execute();
+        if (i % 2 == 0) {
+            expect.emplace_back();
+            expect.back().copy_from(host_y);
+        }
+    }
+    plug->flush_lazy();
+    plug.reset();
+
+    AsyncOprIODump::Reader reader{fname.c_str()};
+    ASSERT_EQ(expect.size(), reader.size());
+    for (size_t i = 0; i < reader.size(); ++i) {
+        auto rec = reader.read(i);
+        ASSERT_EQ(i * 2, rec.exec_id);
+        ASSERT_EQ(y.node()->id(), rec.var_id);
+        ASSERT_EQ("mul", rec.opr_name);
+        MGB_ASSERT_TENSOR_EQ(expect[i], rec.value);
+    }
+}
+
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
 
@@ -10,6 +10,7 @@
  */
 
 #include "megbrain/opr/basic_arith.h"
+#include "megbrain/opr/blas.h"
 #include "megbrain/opr/io.h"
 #include "megbrain/plugin/profiler.h"
 #include "megbrain/test/helper.h"
@@ -48,5 +49,45 @@ TEST(TestGraphProfiler, APlusBCPU) {
     run_test(CompNode::load("cpu0"), "test_profiler_cpu.json");
 }
 
+TEST(TestGraphProfiler, RooflineCPU) {
+    HostTensorGenerator<> gen;
+    auto cn = CompNode::load("cpu0");
+    auto host_x = gen({64, 128}, cn), host_y = gen({128, 32}, cn);
+    auto graph = ComputingGraph::make();
+    auto x = opr::Host2DeviceCopy::make(*graph, host_x).rename("x"),
+         y = opr::Host2DeviceCopy::make(*graph, host_y).rename("y"),
+         z = opr::MatrixMul::make(x, y).rename("z");
+
+    HostTensorND host_z;
+    auto func = graph->compile({make_callback_copy(z, host_z)});
+    auto profiler = std::make_shared<GraphProfiler>(graph.get());
+    func->execute().wait();
+
+    CompNode::UnorderedMap<CompNodeRoofline> rooflines;
+    rooflines[cn].gflops = 1;
+    rooflines[cn].gbps = 1;
+    auto report = profiler->roofline_report(rooflines);
+    auto&& oprs =
+            static_cast<json::Array*>((*report)["oprs"].get())->get_impl();
+    bool found = false;
+    for (auto&& i : oprs) {
+        auto&& opr = *static_cast<json::Object*>(i.get());
+        auto num = [&](const char* key) {
+            return static_cast<json::Number*>(opr[key].get())->get_impl();
+        };
+        if (static_cast<json::String*>(opr["name"].get())->get_impl() ==
+            "z") {
+            found = true;
+            ASSERT_GT(static_cast<json::NumberInt*>(opr["computation"].get())
+                              ->get_impl(),
+                      0u);
+            ASSERT_GT(num("time"), 0);
+            ASSERT_GE(num("lost_time"), 0);
+        }
+    }
+    ASSERT_TRUE(found);
+    report->writeto_fpath(output_file("test_profiler_roofline.json"));
+}
+
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
 
@@ -0,0 +1,70 @@
+/**
+ * \file src/plugin/test/trace_profiler.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "megbrain/opr/basic_arith.h"
+#include "megbrain/opr/io.h"
+#include "megbrain/plugin/trace_profiler.h"
+#include "megbrain/test/helper.h"
+#include "megbrain/utils/debug.h"
+#include "megbrain/utils/trace_recorder.h"
+
+using namespace mgb;
+
+namespace {
+size_t count_substr(const std::string& str, const std::string& sub) {
+    size_t ret = 0;
+    for (auto pos = str.find(sub); pos != std::string::npos;
+         pos = str.find(sub, pos + sub.size())) {
+        ++ret;
+    }
+    return ret;
+}
+}  // anonymous namespace
+
+TEST(TestTraceProfiler, APlusBCPU) {
+    TraceRecorder::inst().collect(true);
+    HostTensorGenerator<> gen;
+    auto cn = CompNode::load("cpu0");
+    auto host_x = gen({23}, cn), host_y = gen({23}, cn);
+    auto graph = ComputingGraph::make();
+    auto profiler = std::make_unique<TraceProfiler>(graph.get(), 2);
+    auto x = opr::Host2DeviceCopy::make(*graph, host_x).rename("x"),
+         y = opr::Host2DeviceCopy::make(*graph, host_y).rename("y"),
+         z = opr::Elemwise::make({x, y}, opr::Elemwise::Mode::ADD, {"z"});
+
+    HostTensorND host_z;
+    auto func = graph->compile({make_callback_copy(z, host_z)});
+    size_t nr_opr = 0;
+    func->iter_opr_seq([&](cg::OperatorNodeBase*) {
+        ++nr_opr;
+        return true;
+    });
+    for (int i = 0; i < 3; ++i) {
+        func->execute().wait();
+    }
+    auto trace = profiler->to_chrome_trace();
+    debug::write_to_file(output_file("test_trace_profiler.json").c_str(),
+                         trace);
+
+    // executions 0 and 2 are sampled
+    ASSERT_EQ(nr_opr * 2, count_substr(trace, "\"cat\":\"opr\",\"ph\":\"B\""));
+    ASSERT_EQ(nr_opr * 2, count_substr(trace, "\"cat\":\"opr\",\"ph\":\"E\""));
+    ASSERT_EQ(count_substr(trace, "\"cat\":\"kern\",\"ph\":\"B\""),
+              count_substr(trace, "\"cat\":\"kern\",\"ph\":\"E\""));
+    ASSERT_GT(count_substr(trace, "\"cat\":\"kern\",\"ph\":\"B\""), 0u);
+    ASSERT_NE(std::string::npos, trace.find("\"name\":\"z{Elemwise}\""));
+
+    // records have been cleared
+    ASSERT_EQ(0u, count_substr(profiler->to_chrome_trace(), "\"cat\":"));
+    ASSERT_FALSE(TraceRecorder::enabled());
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -58,6 +58,35 @@ TEST(TestVarSanityCheck, Simple) {
             VarSanityCheck::Error);
 }
 
+TEST(TestVarSanityCheck, MemFwdOnly) {
+    HostTensorGenerator<> gen;
+    auto host_x = gen({1024}), host_y = gen({1024});
+    auto graph = ComputingGraph::make();
+    graph->options().var_sanity_check_mem_fwd_only = true;
+    SymbolVar x = opr::Host2DeviceCopy::make(*graph, host_x),
+              y = opr::Host2DeviceCopy::make(*graph, host_y),
+              y1 = y.reshape({1024, 1}), z = x + y1.reshape({1024});
+
+    bool should_change = false;
+    ComputingGraph::OutputSpec out_spec = {
+            {y1,
+             [&](DeviceTensorND& v) {
+                 if (should_change) {
+                     HostTensorND hv;
+                     hv.copy_from(v).sync().ptr<float>()[123]++;
+                     v.copy_from(hv);
+                 }
+             }},
+            {z, {}}};
+    auto func = graph->compile(out_spec);
+    func->execute().wait();
+
+    // y1 shares memory with y, so it is still checked
+    should_change = true;
+    func = graph->compile(out_spec);
+    ASSERT_THROW(func->execute().wait(), VarSanityCheck::Error);
+}
+
 TEST(TestVarSanityCheck, InputModify) {
     HostTensorGenerator<> gen;
     auto host_x = gen({333});
@@ -18,49 +18,85 @@ namespace serialization {
 
 std::shared_ptr<DeviceTensorND> BatchedDeviceValueLoader::make(
         CompNode comp_node, HostTensorND value) {
-    auto&& tensor_list = m_cn2tensor_list[comp_node];
+    auto&& batch = m_cn2pending[comp_node];
     auto dev_tensor = std::make_shared<DeviceTensorND>();
     DeviceTensorStorage storage;
 
     auto size = value.layout().span().dist_byte();
     storage.reset(comp_node, size, nullptr);
     dev_tensor->reset(storage, value.layout());
-    tensor_list.tensors.emplace_back(std::move(value), dev_tensor);
+    batch.comp_node = comp_node;
+    batch.tensors.emplace_back(std::move(value), dev_tensor);
+    batch.size += size;
+    if (m_pool && batch.size >= m_batch_size) {
+        launch(batch);
+    }
     return dev_tensor;
 }
 
-void BatchedDeviceValueLoader::apply() {
-    for (auto&& item : m_cn2tensor_list) {
-        auto alignment = item.first.get_mem_addr_alignment();
-        size_t tot_size = 0;
-        for (auto&& i : item.second.tensors) {
-            tot_size = get_aligned_power2(tot_size, alignment) +
-                       i.second->layout().span().dist_byte();
+void BatchedDeviceValueLoader::launch(Batch& batch) {
+    m_launched.emplace_back(std::make_unique<Batch>(std::move(batch)));
+    batch = {};
+    auto ptr = m_launched.back().get();
+    if (m_pool) {
+        ptr->future = m_pool->launch([ptr]() { ptr->copy(); });
+    } else {
+        ptr->copy();
+    }
+}
+
+void BatchedDeviceValueLoader::Batch::copy() {
+    auto alignment = comp_node.get_mem_addr_alignment();
+    size_t tot_size = 0;
+    offsets.clear();
+    for (auto&& i : tensors) {
+        tot_size = get_aligned_power2(tot_size, alignment);
+        offsets.push_back(tot_size);
+        tot_size += i.second->layout().span().dist_byte();
+    }
+
+    HostTensorStorage host_storage{comp_node};
+    dev_storage = DeviceTensorStorage{comp_node};
+    host_storage.ensure_size(tot_size);
+    dev_storage.ensure_size(tot_size);
+    auto ptr_host = host_storage.ptr();
+    for (size_t idx = 0; idx < tensors.size(); ++idx) {
+        auto&& i = tensors[idx];
+        auto offset = offsets[idx];
+        auto size = i.second->layout().span().dist_byte();
+        if (i.second->layout().format.is_default()) {
+            mgb_assert(size == i.first.layout().span().dist_byte());
+            memcpy(ptr_host + offset, i.first.raw_ptr(), size);
+        } else {
+            HostTensorND host;
+            host.reset(host_storage.sub(offset), i.second->layout());
+            host.copy_from_fixlayout(i.first);
         }
+        // release the host value as soon as it is packed
+        i.first = {};
+    }
+    dev_storage.copy_from(host_storage, tot_size);
+    comp_node.sync();
+}
 
-        HostTensorStorage host_storage{item.first};
-        DeviceTensorStorage dev_storage{item.first};
-        host_storage.ensure_size(tot_size);
-        dev_storage.ensure_size(tot_size);
-        auto ptr_host = host_storage.ptr();
-        size_t offset = 0;
-        for (auto&& i : item.second.tensors) {
-            offset = get_aligned_power2(offset, alignment);
-            auto size = i.second->layout().span().dist_byte();
-            if (i.second->layout().format.is_default()) {
-                mgb_assert(size == i.first.layout().span().dist_byte());
-                memcpy(ptr_host + offset, i.first.raw_ptr(), size);
-            } else {
-                HostTensorND host;
-                host.reset(host_storage.sub(offset), i.second->layout());
-                host.copy_from_fixlayout(i.first);
-            }
-            i.second->reset(dev_storage.sub(offset), i.second->layout());
-            offset += size;
+void BatchedDeviceValueLoader::apply() {
+    for (auto&& i : m_cn2pending) {
+        if (!i.second.tensors.empty()) {
+            launch(i.second);
+        }
+    }
+    m_cn2pending.clear();
+    for (auto&& batch : m_launched) {
+        if (batch->future.valid()) {
+            batch->future.get();
+        }
+        for (size_t idx = 0; idx < batch->tensors.size(); ++idx) {
+            auto&& dev = batch->tensors[idx].second;
+            dev->reset(batch->dev_storage.sub(batch->offsets[idx]),
+                       dev->layout());
         }
-        dev_storage.copy_from(host_storage, tot_size);
-        item.first.sync();
     }
+    m_launched.clear();
 }
 
 }  // namespace serialization
@@ -13,6 +13,7 @@
 #include <vector>
 #include "megbrain/comp_node.h"
 #include "megbrain/tensor.h"
+#include "megbrain/utils/async_worker.h"
 
 namespace mgb {
 namespace serialization {
@@ -24,15 +25,47 @@ namespace serialization {
  * This class caches the host values and merge them and copy them to device in a
  * single transaction. Some devices (like hexagon) have long latency so batching
  * has great benifits.
+ *
+ * If a worker pool is set, the values of a comp node are copied on the pool
+ * whenever their total size reaches the batch size, so the copies overlap
+ * with loading the remaining values; the device tensors are only updated in
+ * apply().
  */
 class BatchedDeviceValueLoader {
-    struct TensorList {
-        std::vector<std::pair<HostTensorND, std::shared_ptr<DeviceTensorND>>>
-                tensors;
+    using TensorPair =
+            std::pair<HostTensorND, std::shared_ptr<DeviceTensorND>>;
+
+    struct Batch {
+        CompNode comp_node;
+        std::vector<TensorPair> tensors;
+        size_t size = 0;
+
+        //! device storage and offset of each tensor, filled by copy()
+        DeviceTensorStorage dev_storage;
+        std::vector<size_t> offsets;
+        FutureThreadPool<void>::Future future;
+
+        //! pack host values and copy them to dev_storage
+        void copy();
     };
-    CompNode::UnorderedMap<TensorList> m_cn2tensor_list;
+
+    FutureThreadPool<void>* m_pool = nullptr;
+    size_t m_batch_size = 0;
+    CompNode::UnorderedMap<Batch> m_cn2pending;
+    std::vector<std::unique_ptr<Batch>> m_launched;
+
+    void launch(Batch& batch);
 
 public:
+    /*!
+     * \brief copy values on the given pool in batches of given size; the
+     *      pool must be stopped before this loader is destructed
+     */
+    void set_async(FutureThreadPool<void>* pool, size_t batch_size) {
+        m_pool = pool;
+        m_batch_size = batch_size;
+    }
+
     /*!
      * \brief make a place holder device tensor that has correct dtype and comp
      *      node, but an empty pointer
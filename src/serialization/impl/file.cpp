@@ -11,6 +11,13 @@
 
 #include "megbrain/serialization/file.h"
 
+#if __linux__ || __unix__ || __APPLE__
+#include <unistd.h>
+#define MGB_HAVE_PREAD 1
+#else
+#define MGB_HAVE_PREAD 0
+#endif
+
 namespace mgb {
 namespace serialization {
 
@@ -23,6 +30,11 @@ void InputFile::read_into_tensor(HostTensorND& dest,
     read(dest.raw_ptr(), layout.span().high_byte);
 }
 
+void InputFile::read_into_tensor_at(size_t, HostTensorND&,
+                                    const TensorLayout&) {
+    mgb_throw(MegBrainError, "read_into_tensor_at() is not supported");
+}
+
 SharedBuffer InputFile::read_shared(size_t size) {
     std::shared_ptr<void> shptr{new uint8_t[size],
                                 [](uint8_t* p) { delete[] p; }};
@@ -57,6 +69,25 @@ public:
     }
 
     size_t tell() override { return std::ftell(m_fptr); }
+
+#if MGB_HAVE_PREAD
+    bool support_read_at() const override { return true; }
+
+    void read_into_tensor_at(size_t offset, HostTensorND& dest,
+                             const TensorLayout& layout) override {
+        dest.dtype(layout.dtype).resize(layout);
+        auto ptr = dest.raw_ptr();
+        auto fd = fileno(m_fptr);
+        for (size_t size = layout.span().high_byte; size;) {
+            auto nr = pread(fd, ptr, size, offset);
+            mgb_assert(nr > 0, "failed to read: %s",
+                       nr ? strerror(errno) : "unexpected end of file");
+            ptr += nr;
+            offset += nr;
+            size -= nr;
+        }
+    }
+#endif
 };
 
 std::unique_ptr<InputFile> InputFile::make_fs(const char* path) {
@@ -129,6 +160,16 @@ public:
     }
 
     size_t tell() override { return m_offset; }
+
+    bool support_read_at() const override { return true; }
+
+    void read_into_tensor_at(size_t offset, HostTensorND& dest,
+                             const TensorLayout& layout) override {
+        auto size = layout.span().high_byte;
+        mgb_assert(offset + size <= m_size);
+        dest.dtype(layout.dtype).resize(layout);
+        memcpy(dest.raw_ptr(), m_ptr + offset, size);
+    }
 };
 
 class InputFile::SharedMemProxyImpl final : public InputFile {
@@ -178,6 +219,13 @@ public:
     void read_into_tensor(HostTensorND& dest,
                           const TensorLayout& layout) override;
 
+    //! in writable mode, values are moved in the buffer for alignment, so
+    //! they must be read in order by read_into_tensor()
+    bool support_read_at() const override { return !m_writable; }
+
+    void read_into_tensor_at(size_t offset, HostTensorND& dest,
+                             const TensorLayout& layout) override;
+
     SharedBuffer read_shared(size_t size) override;
 };
 
@@ -222,6 +270,25 @@ void InputFile::SharedMemProxyImpl::read_into_tensor(
     m_offset += size;
 }
 
+void InputFile::SharedMemProxyImpl::read_into_tensor_at(
+        size_t offset, HostTensorND& dest, const TensorLayout& layout) {
+    mgb_assert(!m_writable);
+    auto size = layout.span().high_byte;
+    mgb_assert(offset + size <= m_size);
+    void* ptr = m_ptr + offset;
+    auto align = dest.comp_node().get_mem_addr_alignment();
+    if (!(reinterpret_cast<uintptr_t>(ptr) & (align - 1))) {
+        // aligned by chance, as in read_into_tensor()
+        HostTensorStorage storage;
+        storage.reset(dest.comp_node(), size,
+                      {m_refhold, static_cast<dt_byte*>(ptr)});
+        dest.reset(storage, layout);
+    } else {
+        dest.dtype(layout.dtype).resize(layout);
+        memcpy(dest.raw_ptr(), ptr, size);
+    }
+}
+
 SharedBuffer InputFile::SharedMemProxyImpl::read_shared(size_t size) {
     mgb_assert(m_offset + size <= m_size);
     auto ptr = m_ptr + m_offset;
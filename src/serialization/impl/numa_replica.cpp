@@ -0,0 +1,201 @@
+/**
+ * \file src/serialization/impl/numa_replica.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "megbrain/serialization/numa_replica.h"
+#include "megbrain/comp_node_env.h"
+#include "megbrain/system.h"
+
+#if MGB_HAVE_THREAD
+
+#include <thread>
+
+using namespace mgb;
+using namespace serialization;
+
+struct NumaReplicaRunner::Worker {
+    Replica replica;
+    std::unique_ptr<InputFile> file;
+    ReplicaCallback setup;
+    std::promise<void> ready;
+    std::atomic_size_t nr_finished{0};
+    std::thread thread;
+};
+
+NumaReplicaRunner::NumaReplicaRunner(FileMaker file_maker,
+                                     ReplicaCallback setup,
+                                     const Options& options) {
+    auto node_cpus = sys::get_numa_node_cpus();
+    auto nodes = options.nodes;
+    if (nodes.empty()) {
+        for (size_t i = 0; i < node_cpus.size(); ++i) {
+            if (!node_cpus[i].empty()) {
+                nodes.push_back(i);
+            }
+        }
+    }
+
+    if (options.bind_memory) {
+        m_orig_mem_policy = CompNode::set_cpu_mem_policy({});
+        auto policy = m_orig_mem_policy;
+        if (!policy.huge_page_threshold) {
+            policy.huge_page_threshold = 2_z << 20;
+        }
+        // workers allocate on their own threads bound to the nodes
+        policy.numa_node = CompNode::CpuMemPolicy::NUMA_NODE_AUTO;
+        CompNode::set_cpu_mem_policy(policy);
+        m_mem_policy_set = true;
+    }
+
+    for (int node : nodes) {
+        mgb_assert(node >= 0 && static_cast<size_t>(node) < node_cpus.size() &&
+                           !node_cpus[node].empty(),
+                   "numa node %d does not exist or has no CPU", node);
+        auto&& cpus = node_cpus[node];
+        m_workers.emplace_back(std::make_unique<Worker>());
+        auto&& worker = *m_workers.back();
+        auto&& replica = worker.replica;
+        replica.numa_node = node;
+        replica.cpus = cpus;
+
+        CompNode::Locator loc;
+        loc.type = CompNode::DeviceType::MULTITHREAD;
+        loc.device = node;
+        loc.stream = options.nr_thread ? options.nr_thread : cpus.size();
+        replica.comp_node = CompNode::load(loc);
+        CompNodeEnv::from_comp_node(replica.comp_node)
+                .cpu_env()
+                .set_affinity([cpus](size_t) { sys::set_cpu_affinity(cpus); });
+
+        replica.load_config.comp_graph = ComputingGraph::make();
+        replica.load_config.comp_node_mapper = [loc](CompNode::Locator& dest) {
+            dest = loc;
+        };
+        worker.file = file_maker();
+        worker.setup = setup;
+    }
+
+    for (auto&& i : m_workers) {
+        auto worker = i.get();
+        i->thread = std::thread{[this, worker]() { worker_loop(*worker); }};
+    }
+
+    MGB_TRY {
+        for (auto&& i : m_workers) {
+            i->ready.get_future().get();
+        }
+    }
+    MGB_CATCH(..., {
+        {
+            MGB_LOCK_GUARD(m_mtx);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for (auto&& i : m_workers) {
+            i->thread.join();
+        }
+        m_workers.clear();
+        if (m_mem_policy_set) {
+            CompNode::set_cpu_mem_policy(m_orig_mem_policy);
+        }
+        throw;
+    });
+}
+
+NumaReplicaRunner::~NumaReplicaRunner() {
+    {
+        MGB_LOCK_GUARD(m_mtx);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    for (auto&& i : m_workers) {
+        i->thread.join();
+    }
+    for (auto&& i : m_workers) {
+        i->replica.comp_node.sync();
+    }
+    m_workers.clear();
+    if (m_mem_policy_set) {
+        CompNode::set_cpu_mem_policy(m_orig_mem_policy);
+    }
+}
+
+void NumaReplicaRunner::worker_loop(Worker& worker) {
+    auto&& replica = worker.replica;
+    sys::set_thread_name(ssprintf("numa%d", replica.numa_node));
+    sys::set_cpu_affinity(replica.cpus);
+
+    MGB_TRY {
+        auto format = GraphLoader::identify_graph_dump_format(*worker.file);
+        mgb_assert(format.valid(), "unknown model format");
+        replica.loader =
+                GraphLoader::make(std::move(worker.file), format.val());
+        replica.load_result = replica.loader->load(replica.load_config, false);
+        if (worker.setup) {
+            worker.setup(replica);
+        }
+    }
+    MGB_CATCH(..., {
+        worker.ready.set_exception(std::current_exception());
+        return;
+    });
+    worker.ready.set_value();
+
+    for (;;) {
+        TaskItem item;
+        {
+            std::unique_lock<std::mutex> lock{m_mtx};
+            m_cv.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+            if (m_tasks.empty()) {
+                return;
+            }
+            item = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        MGB_TRY {
+            item.task(replica);
+            item.promise.set_value();
+        }
+        MGB_CATCH(..., {
+            item.promise.set_exception(std::current_exception());
+        });
+        worker.nr_finished.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::future<void> NumaReplicaRunner::submit(ReplicaCallback task) {
+    TaskItem item;
+    item.task = std::move(task);
+    auto ret = item.promise.get_future();
+    {
+        MGB_LOCK_GUARD(m_mtx);
+        mgb_assert(!m_stop);
+        m_tasks.emplace_back(std::move(item));
+    }
+    m_cv.notify_one();
+    return ret;
+}
+
+const NumaReplicaRunner::Replica& NumaReplicaRunner::replica(
+        size_t idx) const {
+    return m_workers.at(idx)->replica;
+}
+
+std::vector<size_t> NumaReplicaRunner::nr_finished_tasks() const {
+    std::vector<size_t> ret;
+    for (auto&& i : m_workers) {
+        ret.push_back(i->nr_finished.load(std::memory_order_relaxed));
+    }
+    return ret;
+}
+
+#endif  // MGB_HAVE_THREAD
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -31,11 +31,15 @@
 #include "megbrain/serialization/internal/schema_generated.h"
 #include "megbrain/serialization/opr_load_dump.h"
 #include "megbrain/serialization/serializer.h"
+#include "megbrain/utils/async_worker.h"
+#include "megbrain/utils/timer.h"
 #include "megbrain/version.h"
 
+#include <atomic>
 #include <cerrno>
 #include <cinttypes>
 #include <cstdio>
+#include <thread>
 
 using namespace mgb;
 using namespace mgb::serialization;
@@ -476,6 +480,50 @@ class GraphLoaderOSS::OprLoadContextImpl final
     size_t m_cur_opr_blob_cnt;
     size_t m_cur_opr_param_cnt;
 
+    /*!
+     * \brief a tensor in the graph, indexed before loading oprs in parallel
+     *      loading mode
+     */
+    struct TensorBlob {
+        CompNode comp_node;
+        TensorLayout layout;
+        std::string name;
+        //! whether there is a value in the file
+        bool has_value = false;
+        //! absolute offset of the value in the file
+        size_t offset = 0;
+        //! value read and checked by the workers
+        HostTensorND value;
+        FutureThreadPool<void>::Future future;
+    };
+
+    //! all the tensors of the oprs in order; only used in parallel mode
+    std::vector<TensorBlob> m_tensor_blobs;
+    //! index of the first tensor of each opr in m_tensor_blobs
+    std::vector<size_t> m_opr_tensor_begin;
+    size_t m_cur_opr_idx = 0;
+    //! whether values can be read by the workers through
+    //! InputFile::read_into_tensor_at(); otherwise they are read on the
+    //! loading thread in order, and only checked by the workers
+    bool m_read_at = false;
+    //! number of tensors whose reading has been launched, and the total
+    //! size of launched and consumed values
+    size_t m_nr_launched_tensor = 0, m_launched_bytes = 0,
+           m_consumed_bytes = 0;
+    //! end of the tensor values in the file
+    size_t m_tensor_end = 0;
+    std::thread::id m_loader_tid;
+    std::atomic_size_t m_nr_worker_tensor_value{0};
+    //! workers to read tensor values and copy them to devices in parallel
+    //! loading mode; declared after the states used by the tasks, so it is
+    //! stopped before they are destroyed
+    std::unique_ptr<FutureThreadPool<void>> m_worker_pool;
+
+    //! total size of tensor values copied to a device by a worker at once
+    static constexpr size_t DEVICE_VALUE_BATCH_SIZE = 16 * 1024 * 1024;
+    //! max total size of values read ahead of operator construction
+    static constexpr size_t TENSOR_READ_AHEAD_SIZE = 256 * 1024 * 1024;
+
     ComputingGraph& graph() override { return *m_graph; }
 
     const GraphLoadConfig& config() const override {
@@ -485,6 +533,28 @@ class GraphLoaderOSS::OprLoadContextImpl final
     void load_tensor_value(HostTensorND* dest, const TensorLayout& layout,
                            const fbs::Tensor* tensor);
 
+    //! record offsets of all the tensor values in the file
+    void index_tensor_blobs();
+
+    /*!
+     * \brief launch reading tensor values until at least \p min_nr tensors
+     *      and all tensors within TENSOR_READ_AHEAD_SIZE are launched
+     */
+    void launch_tensor_reads(size_t min_nr);
+
+    //! comp node of the tensor just taken from current opr
+    CompNode tensor_comp_node(const fbs::Tensor* tensor);
+
+    /*!
+     * \brief get value of the tensor just taken from current opr, either
+     *      from the workers or by load_tensor_value()
+     *
+     * \param dest tensor with the target comp node; nullptr to skip the
+     *      value
+     */
+    void read_tensor_value(HostTensorND* dest, const TensorLayout& layout,
+                           const fbs::Tensor* tensor);
+
     std::shared_ptr<HostTensorND> load_tensor() override;
 
     std::shared_ptr<DeviceTensorND> load_tensor_shared() override;
@@ -509,6 +579,9 @@ public:
     }
 
     ~OprLoadContextImpl() noexcept {
+        // join the workers before device values are released, in case
+        // loading is interrupted by an exception
+        m_worker_pool.reset();
         auto nr = m_graph->options().user_data.pop_user_data<OprLoadContext>();
         mgb_assert(nr == 1);
     }
@@ -580,6 +653,121 @@ TensorLayout load_tensor_layout(const fbs::Tensor* tensor) {
     return layout;
 }
 
+void GraphLoaderOSS::OprLoadContextImpl::index_tensor_blobs() {
+    auto&& file = m_loader->m_file;
+    size_t offset = file->tell();
+    const auto* oprs = m_loader->m_graph->oprs();
+    m_opr_tensor_begin.resize(oprs->size());
+    for (flatbuffers::uoffset_t i = 0; i < oprs->size(); ++i) {
+        m_opr_tensor_begin[i] = m_tensor_blobs.size();
+        auto tensors = oprs->Get(i)->tensors();
+        if (!tensors) {
+            continue;
+        }
+        for (auto tensor : *tensors) {
+            m_tensor_blobs.emplace_back();
+            auto&& blob = m_tensor_blobs.back();
+            blob.comp_node = load_comp_node(tensor->comp_node());
+            blob.layout = load_tensor_layout(tensor);
+            if (tensor->name()) {
+                blob.name = tensor->name()->str();
+            }
+            if (!tensor->data_size()) {
+                continue;
+            }
+            auto size = blob.layout.span().high_byte;
+            mgb_throw_if(tensor->offset() + size > tensor->data_size(),
+                         SerializationError,
+                         "tensor value out of range: offset %u, size %zu, "
+                         "has %u",
+                         tensor->offset(), size, tensor->data_size());
+            if (tensor->offset() + size < tensor->data_size()) {
+                mgb_log_warn(
+                        "Tensor value loader consumed less data than "
+                        "available: consumed %zu bytes, has %u bytes",
+                        tensor->offset() + size, tensor->data_size());
+            }
+            blob.has_value = true;
+            blob.offset = offset + tensor->offset();
+            offset += tensor->data_size();
+        }
+    }
+    m_tensor_end = offset;
+}
+
+void GraphLoaderOSS::OprLoadContextImpl::launch_tensor_reads(size_t min_nr) {
+    while (m_nr_launched_tensor < m_tensor_blobs.size()) {
+        if (m_nr_launched_tensor >= min_nr &&
+            m_launched_bytes - m_consumed_bytes >= TENSOR_READ_AHEAD_SIZE) {
+            break;
+        }
+        auto&& blob = m_tensor_blobs[m_nr_launched_tensor++];
+        if (!blob.has_value) {
+            continue;
+        }
+        // values on other devices are read to the host and then copied by
+        // m_device_value_loader
+        auto host_cn = blob.comp_node;
+        if (host_cn.mem_node() != CompNode::default_cpu().mem_node()) {
+            host_cn = CompNode::default_cpu();
+        }
+        blob.value = HostTensorND{host_cn};
+        if (!m_read_at) {
+            auto&& file = m_loader->m_file;
+            auto pos = file->tell();
+            mgb_assert(blob.offset >= pos);
+            file->skip(blob.offset - pos);
+            file->read_into_tensor(blob.value, blob.layout);
+        }
+        m_launched_bytes += blob.layout.span().high_byte;
+        blob.future = m_worker_pool->launch([this, &blob]() {
+            if (m_read_at) {
+                m_loader->m_file->read_into_tensor_at(blob.offset, blob.value,
+                                                      blob.layout);
+            }
+            check_tensor_value_valid(blob.name, blob.value);
+            if (std::this_thread::get_id() != m_loader_tid) {
+                ++m_nr_worker_tensor_value;
+            }
+        });
+    }
+}
+
+CompNode GraphLoaderOSS::OprLoadContextImpl::tensor_comp_node(
+        const fbs::Tensor* tensor) {
+    if (m_tensor_blobs.empty()) {
+        return load_comp_node(tensor->comp_node());
+    }
+    return m_tensor_blobs
+            .at(m_opr_tensor_begin[m_cur_opr_idx] + m_cur_opr_tensor_cnt - 1)
+            .comp_node;
+}
+
+void GraphLoaderOSS::OprLoadContextImpl::read_tensor_value(
+        HostTensorND* dest, const TensorLayout& layout,
+        const fbs::Tensor* tensor) {
+    if (m_tensor_blobs.empty()) {
+        load_tensor_value(dest, layout, tensor);
+        return;
+    }
+    auto idx = m_opr_tensor_begin[m_cur_opr_idx] + m_cur_opr_tensor_cnt - 1;
+    auto&& blob = m_tensor_blobs.at(idx);
+    mgb_assert(blob.has_value);
+    // keep the workers busy while waiting for this value
+    launch_tensor_reads(idx + 1);
+    blob.future.get();
+    m_consumed_bytes += blob.layout.span().high_byte;
+    launch_tensor_reads(0);
+    auto value = std::move(blob.value);
+    if (dest) {
+        if (value.comp_node() == dest->comp_node()) {
+            *dest = std::move(value);
+        } else {
+            dest->copy_from(value);
+        }
+    }
+}
+
 void GraphLoaderOSS::OprLoadContextImpl::load_tensor_value(
         HostTensorND* dest, const TensorLayout& layout,
         const fbs::Tensor* tensor) {
@@ -625,11 +813,11 @@ GraphLoaderOSS::OprLoadContextImpl::load_tensor() {
     mgb_assert(m_current_opr->tensors() &&
                m_cur_opr_tensor_cnt < m_current_opr->tensors()->size());
     auto tensor = m_current_opr->tensors()->Get(m_cur_opr_tensor_cnt++);
-    auto comp_node = load_comp_node(tensor->comp_node());
+    auto comp_node = tensor_comp_node(tensor);
     auto layout = load_tensor_layout(tensor);
     auto ret = std::make_shared<HostTensorND>(comp_node, layout);
     if (tensor->data_size()) {
-        load_tensor_value(ret.get(), layout, tensor);
+        read_tensor_value(ret.get(), layout, tensor);
     }
     if (tensor->name()) {
         m_tensor_map[tensor->name()->str()] = ret;
@@ -646,14 +834,14 @@ GraphLoaderOSS::OprLoadContextImpl::load_tensor_shared() {
     mgb_assert(m_current_opr->tensors() &&
                m_cur_opr_tensor_cnt < m_current_opr->tensors()->size());
     auto tensor = m_current_opr->tensors()->Get(m_cur_opr_tensor_cnt++);
-    auto comp_node = load_comp_node(tensor->comp_node());
+    auto comp_node = tensor_comp_node(tensor);
     auto layout = load_tensor_layout(tensor);
     mgb_assert(tensor->data_size());
     auto&& sh_reg = m_loader->m_shared_tensor_map.at(m_cur_shared_tensor_idx++);
     auto&& sh_ptr_ref = sh_reg.second[comp_node.mem_node()];
     if (sh_ptr_ref) {
         // cached tensor value is valid so we can reuse it
-        load_tensor_value(nullptr, layout, tensor);
+        read_tensor_value(nullptr, layout, tensor);
         if (sh_ptr_ref->comp_node() == comp_node)
             return sh_ptr_ref;
         // same mem node but different comp node, change comp node and share
@@ -669,13 +857,15 @@ GraphLoaderOSS::OprLoadContextImpl::load_tensor_shared() {
     if (comp_node.mem_node() == CompNode::default_cpu().mem_node()) {
         // directly forward CPU memory
         HostTensorND hv{comp_node};
-        load_tensor_value(&hv, layout, tensor);
+        read_tensor_value(&hv, layout, tensor);
         sh_ptr_ref = std::make_shared<DeviceTensorND>();
         *sh_ptr_ref = DeviceTensorND::make_proxy(hv);
     } else {
-        // use lazy load for non-CPU devices
+        // use lazy load for non-CPU devices; in parallel loading mode the
+        // values are copied by the workers while the remaining oprs are
+        // loaded
         HostTensorND hv{CompNode::default_cpu()};
-        load_tensor_value(&hv, layout, tensor);
+        read_tensor_value(&hv, layout, tensor);
         sh_ptr_ref = m_device_value_loader.make(comp_node, std::move(hv));
     }
     return sh_ptr_ref;
@@ -747,17 +937,45 @@ void GraphLoaderOSS::OprLoadContextImpl::load_single_opr(
 }
 
 GraphLoader::LoadResult GraphLoaderOSS::OprLoadContextImpl::load_oprs() {
+    LoadResult ret;
+    RealTimer timer;
+    if (auto nr_worker = config().nr_load_worker) {
+        m_worker_pool = std::make_unique<FutureThreadPool<void>>(
+                std::string{"load"});
+        m_worker_pool->start(nr_worker);
+        m_device_value_loader.set_async(m_worker_pool.get(),
+                                        DEVICE_VALUE_BATCH_SIZE);
+        // custom loaders read values from the file in order, so values can
+        // not be read ahead
+        if (!config().tensor_value_loader) {
+            m_loader_tid = std::this_thread::get_id();
+            m_read_at = m_loader->m_file->support_read_at();
+            index_tensor_blobs();
+            launch_tensor_reads(0);
+        }
+    }
+
     // load oprs
     const auto* oprs = m_loader->m_graph->oprs();
     for (flatbuffers::uoffset_t i = 0; i < oprs->size(); ++i) {
+        m_cur_opr_idx = i;
         m_current_opr = oprs->Get(i);
         load_single_opr(m_current_opr);
     }
+    ret.time_profile.load_opr = timer.get_secs_reset();
 
     // batched loading device values
     m_device_value_loader.apply();
+    m_worker_pool.reset();
+    if (!m_tensor_blobs.empty()) {
+        // values may be read without moving the read offset
+        auto&& file = m_loader->m_file;
+        mgb_assert(m_tensor_end >= file->tell());
+        file->skip(m_tensor_end - file->tell());
+    }
+    ret.time_profile.copy_device_value = timer.get_secs_reset();
+    ret.time_profile.nr_worker_tensor_value = m_nr_worker_tensor_value;
 
-    LoadResult ret;
     ret.graph = m_graph;
     ret.tensor_map = m_tensor_map;
 
@@ -778,6 +996,7 @@ GraphLoader::LoadResult GraphLoaderOSS::load(const LoadConfig& config,
                                                    bool rewind) {
     mgb_assert(m_file);
     m_cur_load_config = &config;
+    RealTimer timer;
     if (rewind) {
         m_file->rewind();
     }
@@ -843,8 +1062,10 @@ GraphLoader::LoadResult GraphLoaderOSS::load(const LoadConfig& config,
         mgb_assert(m_shared_tensor_map.size() == m_graph->nr_shared_tensor());
     }
 
+    auto read_graph_time = timer.get_secs();
     OprLoadContextImpl ctx{this, m_graph->mgb_version()};
     auto result = ctx.load_oprs();
+    result.time_profile.read_graph = read_graph_time;
 
     auto fbs_end = tensor_begin + offset_to_fbs + size;
     auto cur = m_file->tell();
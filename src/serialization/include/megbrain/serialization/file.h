@@ -62,6 +62,19 @@ public:
     virtual void read_into_tensor(HostTensorND& dest,
                                   const TensorLayout& layout);
 
+    //! whether read_into_tensor_at() is supported
+    virtual bool support_read_at() const { return false; }
+
+    /*!
+     * \brief read into a host tensor from given absolute offset, without
+     *      changing the current read offset
+     *
+     * It can be called concurrently from multiple threads, and only if
+     * support_read_at() returns true.
+     */
+    virtual void read_into_tensor_at(size_t offset, HostTensorND& dest,
+                                     const TensorLayout& layout);
+
     /*!
      * \brief read with sharing memory (i.e. use zero-copy if possible)
      *
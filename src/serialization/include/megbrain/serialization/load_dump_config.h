@@ -101,6 +101,24 @@ struct GraphLoadConfig {
     //! the shape
     bool const_var_shape = false;
 
+    /*!
+     * \brief number of worker threads to load tensor values concurrently
+     *      with operator construction
+     *
+     * If this is zero, tensor values are read in order while operators are
+     * constructed, and values on non-CPU devices are copied in one batch
+     * after all operators are loaded.
+     *
+     * Otherwise the offsets of all tensor values are indexed first, and the
+     * workers read the values (by InputFile::read_into_tensor_at()), check
+     * them and copy them to devices in batches, ahead of the operators
+     * that use them. Values are read on the loading thread in order if the
+     * file does not support concurrent reading (e.g. a writable memory
+     * proxy, so memory sharing still applies) or tensor_value_loader is
+     * given. Currently only used by the FLATBUFFERS format.
+     */
+    size_t nr_load_worker = 0;
+
     //! callback to modify loaded tensors before they are inserted into the
     //! graph
     TensorModifier tensor_modifier;
@@ -0,0 +1,116 @@
+/**
+ * \file src/serialization/include/megbrain/serialization/numa_replica.h
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include "megbrain/serialization/serializer.h"
+
+#if MGB_HAVE_THREAD
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+
+namespace mgb {
+namespace serialization {
+
+/*!
+ * \brief run a replica of a model on each NUMA node
+ *
+ * Each replica is loaded by its own GraphLoader on a dedicated thread that is
+ * bound to the CPUs of its node, and computes on its own multithread comp
+ * node whose workers are bound to the same CPUs. Therefore parameters, static
+ * memory and computation of a replica are all local to its node.
+ *
+ * Tasks are put in a shared queue and executed by the first idle replica.
+ */
+class NumaReplicaRunner final : public NonCopyableObj {
+public:
+    struct Options {
+        //! NUMA nodes to create replicas on; empty for all nodes with CPUs
+        std::vector<int> nodes;
+
+        //! number of threads of each replica; 0 for all CPUs of the node
+        size_t nr_thread = 0;
+
+        /*!
+         * whether to bind large memory allocations to the local node by
+         * CompNode::set_cpu_mem_policy(); the original policy is restored
+         * when the runner is destructed
+         */
+        bool bind_memory = true;
+    };
+
+    struct Replica {
+        int numa_node;
+        std::vector<int> cpus;
+        CompNode comp_node;
+        GraphLoader::LoadConfig load_config;
+        //! the loader, which can be used to load more graphs from the file
+        std::unique_ptr<GraphLoader> loader;
+        GraphLoader::LoadResult load_result;
+        //! function to be compiled by the setup callback
+        std::unique_ptr<cg::AsyncExecutable> func;
+    };
+
+    //! create the model file; called once for each replica
+    using FileMaker = thin_function<std::unique_ptr<InputFile>()>;
+
+    //! a callback invoked on the thread of a replica
+    using ReplicaCallback = thin_function<void(Replica&)>;
+
+    /*!
+     * \brief load the replicas and wait for them to be ready
+     * \param setup called after a replica is loaded, usually to compile
+     *      Replica::func
+     */
+    NumaReplicaRunner(FileMaker file_maker, ReplicaCallback setup,
+                      const Options& options);
+    ~NumaReplicaRunner();
+
+    /*!
+     * \brief submit a task to be executed by an idle replica
+     *
+     * Exceptions thrown by the task are propagated by the returned future.
+     */
+    std::future<void> submit(ReplicaCallback task);
+
+    size_t nr_replica() const { return m_workers.size(); }
+
+    const Replica& replica(size_t idx) const;
+
+    //! number of tasks finished by each replica
+    std::vector<size_t> nr_finished_tasks() const;
+
+private:
+    struct Worker;
+    struct TaskItem {
+        ReplicaCallback task;
+        std::promise<void> promise;
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    mutable std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::deque<TaskItem> m_tasks;
+    bool m_stop = false;
+    bool m_mem_policy_set = false;
+    CompNode::CpuMemPolicy m_orig_mem_policy;
+
+    void worker_loop(Worker& worker);
+};
+
+}  // namespace serialization
+}  // namespace mgb
+
+#endif  // MGB_HAVE_THREAD
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -51,6 +51,24 @@ namespace serialization {
                 //! GraphDumper::dump
                 SymbolVarArray output_var_list;
 
+                //! time spent in each loading stage, in seconds
+                struct TimeProfile {
+                    //! reading and verifying the flatbuffers graph
+                    double read_graph = 0;
+                    //! constructing operators and reading tensor values; in
+                    //! parallel mode this includes indexing the values and
+                    //! waiting for the workers to read them
+                    double load_opr = 0;
+                    //! copying tensor values to non-CPU devices after all
+                    //! operators have been constructed; in parallel mode
+                    //! this only includes waiting for unfinished copies
+                    double copy_device_value = 0;
+                    //! number of tensor values read and checked by the
+                    //! worker threads in parallel mode
+                    size_t nr_worker_tensor_value = 0;
+                };
+                TimeProfile time_profile;
+
                 /*!
                  * \brief call graph->compile() but also checks for comp seq rec
                  *
@@ -0,0 +1,93 @@
+/**
+ * \file src/serialization/test/numa_replica.cpp
+ * MegEngine is Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * Copyright (c) 2014-2020 Megvii Inc. All rights reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT ARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "megbrain/serialization/numa_replica.h"
+#include "megbrain/opr/basic_arith_wrapper.h"
+#include "megbrain/opr/io.h"
+#include "megbrain/test/helper.h"
+
+#if MGB_HAVE_THREAD
+
+using namespace mgb;
+using namespace serialization;
+
+TEST(TestNumaReplicaRunner, Basic) {
+    HostTensorGenerator<> gen;
+    auto host_x = gen({23}), host_param = gen({23});
+    std::vector<uint8_t> buf;
+    {
+        auto graph = ComputingGraph::make();
+        auto x = opr::Host2DeviceCopy::make(*graph, host_x, {"x"}),
+             p = opr::SharedDeviceTensor::make(*graph, *host_param),
+             y = x * p + 1;
+        GraphDumper::make(OutputFile::make_vector_proxy(&buf))->dump({y});
+    }
+    HostTensorND y_expect;
+    y_expect.copy_from(*host_x);
+    for (size_t i = 0; i < 23; ++i) {
+        y_expect.ptr<float>()[i] =
+                host_x->ptr<float>()[i] * host_param->ptr<float>()[i] + 1;
+    }
+
+    std::mutex mtx;
+    std::map<const NumaReplicaRunner::Replica*, HostTensorND> results;
+    auto file_maker = [&]() {
+        return InputFile::make_mem_proxy(buf.data(), buf.size());
+    };
+    auto setup = [&](NumaReplicaRunner::Replica& replica) {
+        auto&& load_ret = replica.load_result;
+        load_ret.tensor_map.at("x")->copy_from(*host_x);
+        HostTensorND* result;
+        {
+            MGB_LOCK_GUARD(mtx);
+            result = &results[&replica];
+        }
+        replica.func = load_ret.graph_compile(
+                {make_callback_copy(load_ret.output_var_list.at(0), *result)});
+    };
+    NumaReplicaRunner::Options options;
+    options.nr_thread = 2;
+    NumaReplicaRunner runner{file_maker, setup, options};
+    ASSERT_GE(runner.nr_replica(), 1u);
+    for (size_t i = 0; i < runner.nr_replica(); ++i) {
+        auto&& replica = runner.replica(i);
+        ASSERT_FALSE(replica.cpus.empty());
+        ASSERT_EQ(CompNode::DeviceType::MULTITHREAD,
+                  replica.comp_node.device_type());
+    }
+
+    constexpr size_t NR_RUN = 16;
+    std::vector<std::future<void>> futures;
+    for (size_t i = 0; i < NR_RUN; ++i) {
+        futures.emplace_back(
+                runner.submit([&](NumaReplicaRunner::Replica& replica) {
+                    replica.func->execute().wait();
+                    MGB_ASSERT_TENSOR_EQ(y_expect, results.at(&replica));
+                }));
+    }
+    for (auto&& i : futures) {
+        i.get();
+    }
+    size_t tot = 0;
+    for (auto i : runner.nr_finished_tasks()) {
+        tot += i;
+    }
+    ASSERT_EQ(NR_RUN, tot);
+
+    auto fut = runner.submit([](NumaReplicaRunner::Replica&) {
+        mgb_throw(MegBrainError, "expected error");
+    });
+    ASSERT_THROW(fut.get(), MegBrainError);
+}
+
+#endif  // MGB_HAVE_THREAD
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -651,6 +651,220 @@ TEST(TestSerializer2, MultipleParams) {
     load();
 }
 
+TEST(TestSerializer2, ParallelLoad) {
+    auto fname = GET_OUTPUT_FILE();
+    HostTensorGenerator<> gen;
+    std::vector<std::shared_ptr<HostTensorND>> tensors{
+            gen({2, 3}), gen({1}), gen({3, 2}), gen({1, 1}), gen({23, 45})};
+    auto host_x = gen({2, 3});
+
+    auto dump = [&](std::unique_ptr<OutputFile> file) {
+        auto graph = ComputingGraph::make();
+        auto x = opr::Host2DeviceCopy::make(*graph, host_x, {"x"});
+        SymbolVarArray outputs;
+        for (auto&& i : tensors) {
+            outputs.push_back(opr::SharedDeviceTensor::make(*graph, *i));
+        }
+        outputs.push_back(x + opr::ImmutableTensor::make(*graph, *tensors[0]));
+        GraphDumper::make(std::move(file), GraphDumpFormat::FLATBUFFERS)
+                ->dump(outputs);
+    };
+
+    //! load and get the values of all params, checked with the originals
+    auto load = [&](std::unique_ptr<InputFile> file, size_t nr_load_worker,
+                    std::vector<HostTensorND>& values) {
+        auto loader =
+                GraphLoader::make(std::move(file), GraphDumpFormat::FLATBUFFERS);
+        GraphLoader::LoadConfig config;
+        config.nr_load_worker = nr_load_worker;
+        auto rst = loader->load(config);
+        values.clear();
+        ASSERT_EQ(tensors.size() + 1, rst.output_var_list.size());
+        for (size_t i = 0; i < tensors.size(); ++i) {
+            HostTensorND got;
+            got.copy_from(rst.output_var_list[i]
+                                  .node()
+                                  ->owner_opr()
+                                  ->cast_final_safe<opr::SharedDeviceTensor>()
+                                  .get_dev_tensor())
+                    .sync();
+            MGB_ASSERT_TENSOR_EQ(*tensors[i], got);
+            values.emplace_back(std::move(got));
+        }
+
+        rst.tensor_map.at("x")->copy_from(*host_x);
+        HostTensorND host_y, host_y_expect;
+        host_y_expect.copy_from(*host_x);
+        for (size_t i = 0; i < 6; ++i) {
+            host_y_expect.ptr<float>()[i] += tensors[0]->ptr<float>()[i];
+        }
+        auto func = rst.graph_compile(
+                {make_callback_copy(rst.output_var_list.back(), host_y)});
+        func->execute();
+        MGB_ASSERT_TENSOR_EQ(host_y_expect, host_y);
+        values.emplace_back(std::move(host_y));
+
+        if (!nr_load_worker) {
+            EXPECT_EQ(0u, rst.time_profile.nr_worker_tensor_value);
+        } else {
+#if MGB_HAVE_THREAD
+            // all the params and the immutable tensor are read and checked
+            // by the workers
+            EXPECT_GE(rst.time_profile.nr_worker_tensor_value,
+                      tensors.size() + 1);
+#endif
+        }
+    };
+
+    std::vector<uint8_t> buf;
+    dump(OutputFile::make_fs(fname.c_str()));
+    dump(OutputFile::make_vector_proxy(&buf));
+    std::vector<HostTensorND> expect, got;
+    load(InputFile::make_fs(fname.c_str()), 0, expect);
+    auto check = [&]() {
+        ASSERT_EQ(expect.size(), got.size());
+        for (size_t i = 0; i < got.size(); ++i) {
+            MGB_ASSERT_TENSOR_EQ(expect[i], got[i]);
+        }
+    };
+    for (size_t nr_load_worker : {1, 4}) {
+        load(InputFile::make_fs(fname.c_str()), nr_load_worker, got);
+        check();
+        load(InputFile::make_mem_proxy(buf.data(), buf.size()), nr_load_worker,
+             got);
+        check();
+    }
+}
+
+TEST(TestSerializer2, ParallelLoadShareMem) {
+    HostTensorGenerator<> gen;
+    std::vector<std::shared_ptr<HostTensorND>> tensors{gen({23, 45}),
+                                                       gen({2, 3})};
+    std::vector<uint8_t> buf;
+    {
+        auto graph = ComputingGraph::make();
+        SymbolVarArray outputs;
+        for (auto&& i : tensors) {
+            outputs.push_back(opr::SharedDeviceTensor::make(*graph, *i));
+        }
+        GraphDumper::make(OutputFile::make_vector_proxy(&buf),
+                          GraphDumpFormat::FLATBUFFERS)
+                ->dump(outputs);
+    }
+
+    std::shared_ptr<uint8_t> shared_buf{new uint8_t[buf.size()],
+                                        [](uint8_t* p) { delete[] p; }};
+    memcpy(shared_buf.get(), buf.data(), buf.size());
+    auto in_buf = [&](const void* ptr) {
+        auto p = static_cast<const uint8_t*>(ptr);
+        return p >= shared_buf.get() && p < shared_buf.get() + buf.size();
+    };
+
+    //! load and get whether each param shares memory with the buffer
+    auto load = [&](size_t nr_load_worker, std::vector<bool>& shared) {
+        auto loader = GraphLoader::make(
+                InputFile::make_mem_proxy(shared_buf, buf.size(), false),
+                GraphDumpFormat::FLATBUFFERS);
+        GraphLoader::LoadConfig config;
+        config.nr_load_worker = nr_load_worker;
+        auto rst = loader->load(config);
+        shared.clear();
+        ASSERT_EQ(tensors.size(), rst.output_var_list.size());
+        for (size_t i = 0; i < tensors.size(); ++i) {
+            auto&& dv = rst.output_var_list[i]
+                                .node()
+                                ->owner_opr()
+                                ->cast_final_safe<opr::SharedDeviceTensor>()
+                                .get_dev_tensor();
+            HostTensorND got;
+            got.copy_from(dv).sync();
+            MGB_ASSERT_TENSOR_EQ(*tensors[i], got);
+            shared.push_back(in_buf(dv.raw_ptr()));
+        }
+    };
+
+    // param memory is shared in the same way with and without workers
+    std::vector<bool> expect, got;
+    load(0, expect);
+    load(2, got);
+    ASSERT_EQ(expect, got);
+
+    // values are read on the loading thread from a writable proxy; memory is
+    // still shared
+    auto load_writable = [&](size_t nr_load_worker, std::vector<bool>& shared) {
+        std::shared_ptr<uint8_t> wbuf{new uint8_t[buf.size()],
+                                      [](uint8_t* p) { delete[] p; }};
+        memcpy(wbuf.get(), buf.data(), buf.size());
+        auto loader = GraphLoader::make(
+                InputFile::make_mem_proxy(wbuf, buf.size(), true),
+                GraphDumpFormat::FLATBUFFERS);
+        GraphLoader::LoadConfig config;
+        config.nr_load_worker = nr_load_worker;
+        auto rst = loader->load(config);
+        shared.clear();
+        ASSERT_EQ(tensors.size(), rst.output_var_list.size());
+        for (size_t i = 0; i < tensors.size(); ++i) {
+            auto&& dv = rst.output_var_list[i]
+                                .node()
+                                ->owner_opr()
+                                ->cast_final_safe<opr::SharedDeviceTensor>()
+                                .get_dev_tensor();
+            HostTensorND got;
+            got.copy_from(dv).sync();
+            MGB_ASSERT_TENSOR_EQ(*tensors[i], got);
+            const void* p = dv.raw_ptr();
+            shared.push_back(p >= wbuf.get() && p < wbuf.get() + buf.size());
+        }
+    };
+    load_writable(0, expect);
+    load_writable(2, got);
+    ASSERT_EQ(expect, got);
+}
+
+TEST(TestSerializer2, ParallelLoadGPU) {
+    REQUIRE_GPU(1);
+    HostTensorGenerator<> gen;
+    // larger than the batch size, so values are copied in several batches
+    std::vector<std::shared_ptr<HostTensorND>> tensors{
+            gen({1024, 4096}), gen({2, 3}), gen({1024, 4096}), gen({1})};
+    std::vector<uint8_t> buf;
+    {
+        auto graph = ComputingGraph::make();
+        SymbolVarArray outputs;
+        for (auto&& i : tensors) {
+            outputs.push_back(opr::SharedDeviceTensor::make(*graph, *i));
+        }
+        GraphDumper::make(OutputFile::make_vector_proxy(&buf),
+                          GraphDumpFormat::FLATBUFFERS)
+                ->dump(outputs);
+    }
+
+    for (size_t nr_load_worker : {0, 1, 4}) {
+        auto loader = GraphLoader::make(
+                InputFile::make_mem_proxy(buf.data(), buf.size()),
+                GraphDumpFormat::FLATBUFFERS);
+        GraphLoader::LoadConfig config;
+        config.nr_load_worker = nr_load_worker;
+        config.comp_node_mapper = [](CompNode::Locator& loc) {
+            loc.type = CompNode::DeviceType::CUDA;
+        };
+        auto rst = loader->load(config);
+        ASSERT_EQ(tensors.size(), rst.output_var_list.size());
+        for (size_t i = 0; i < tensors.size(); ++i) {
+            auto&& dv = rst.output_var_list[i]
+                                .node()
+                                ->owner_opr()
+                                ->cast_final_safe<opr::SharedDeviceTensor>()
+                                .get_dev_tensor();
+            ASSERT_EQ(CompNode::DeviceType::CUDA,
+                      dv.comp_node().device_type());
+            HostTensorND got;
+            got.copy_from(dv).sync();
+            MGB_ASSERT_TENSOR_EQ(*tensors[i], got);
+        }
+    }
+}
+
 TEST(TestSerializer2, ParamerizedDType) {
     auto fname = GET_OUTPUT_FILE();
     TensorShape shape{2, 3, 3};